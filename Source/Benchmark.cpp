@@ -0,0 +1,281 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmark.cpp
+// ============
+// play a fixed camera path through the scene and report the frame times
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Benchmark.h"
+#include "Profiler.h"
+#include "StartupTimeline.h"
+#include "ViewManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// time step of a frame on the camera path, in seconds
+	const double FRAME_STEP = 1.0 / 60.0;
+	// frames rendered at the start of the path before the
+	// measuring starts, so shader and texture setup in the
+	// driver is not counted
+	const int WARMUP_FRAMES = 10;
+
+	// the camera circles the table once in this many seconds,
+	// moving in and out and up and down on the way
+	const double PATH_SECONDS = 20.0;
+	const glm::vec3 PATH_CENTER = glm::vec3(0.0f, 1.0f, 0.0f);
+	const float PATH_RADIUS = 11.0f;
+	const float PATH_RADIUS_CHANGE = 3.0f;
+	const float PATH_HEIGHT = 5.0f;
+	const float PATH_HEIGHT_CHANGE = 2.0f;
+	const float PATH_ZOOM = 80.0f;
+	const double PI = 3.14159265358979;
+
+	// names of the samples of a frame
+	const char* const g_FrameName = "frame";
+	const char* const g_CPUName = "cpu";
+	const char* const g_GPUName = "Frame";
+
+	/***********************************************************
+	 *  GetPeakMemory()
+	 *
+	 *  This function is used for getting the most memory the
+	 *  process has had resident, in KB.
+	 ***********************************************************/
+	double GetPeakMemory()
+	{
+#ifdef _WIN32
+		PROCESS_MEMORY_COUNTERS counters;
+		if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		{
+			return(counters.PeakWorkingSetSize / 1024.0);
+		}
+		return(0.0);
+#else
+		struct rusage usage;
+		if (getrusage(RUSAGE_SELF, &usage) == 0)
+		{
+			// in KB on Linux
+			return((double)usage.ru_maxrss);
+		}
+		return(0.0);
+#endif
+	}
+
+	/***********************************************************
+	 *  WriteSummary()
+	 *
+	 *  This function is used for writing the average and the
+	 *  percentiles of one timing as a JSON object.
+	 ***********************************************************/
+	void WriteSummary(std::ofstream& file, const char* key, const TimerStatistics& statistics, const char* name)
+	{
+		TimerStatistics::SUMMARY summary;
+		file << "  \"" << key << "\": ";
+		if (!statistics.GetSummary(name, summary))
+		{
+			file << "null";
+			return;
+		}
+		file << "{ \"average\": " << summary.average
+			<< ", \"p50\": " << summary.p50
+			<< ", \"p95\": " << summary.p95
+			<< ", \"p99\": " << summary.p99
+			<< ", \"samples\": " << summary.sampleCount << " }";
+	}
+}
+
+/***********************************************************
+ *  Benchmark()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+Benchmark::Benchmark()
+{
+	m_sceneName = "built in";
+	m_startupTime = 0.0;
+}
+
+/***********************************************************
+ *  GetPathCamera()
+ *
+ *  This method is used for getting the position and view
+ *  direction of the camera on the path, always looking at
+ *  the middle of the table.
+ ***********************************************************/
+void Benchmark::GetPathCamera(double time, glm::vec3& position, glm::vec3& front)
+{
+	double angle = 2.0 * PI * time / PATH_SECONDS;
+	float radius = PATH_RADIUS + PATH_RADIUS_CHANGE * (float)std::sin(angle * 2.0);
+	position = PATH_CENTER + glm::vec3(
+		radius * (float)std::sin(angle),
+		PATH_HEIGHT + PATH_HEIGHT_CHANGE * (float)std::sin(angle * 3.0),
+		radius * (float)std::cos(angle));
+	front = glm::normalize(PATH_CENTER - position);
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for rendering the frames of the
+ *  camera path.  The CPU time of a frame is the time until
+ *  the scene is submitted, the frame time also includes the
+ *  swap, and the GPU time comes from a timer around the
+ *  whole frame.  Vertical sync is turned off, so the swap
+ *  does not wait for the display.
+ ***********************************************************/
+bool Benchmark::Run(
+	GLFWwindow* pWindow,
+	GLRenderDevice* pDevice,
+	SceneManager* pSceneManager,
+	int frameCount,
+	const char* reportFilename)
+{
+	PROFILE_SCOPE("Benchmark::Run");
+	if (frameCount <= 0)
+	{
+		return(false);
+	}
+
+	glfwSwapInterval(0);
+	pDevice->EnableTimers(true, (size_t)frameCount);
+
+	TimerStatistics cpuStatistics((size_t)frameCount);
+	RenderCommandList frameCommands;
+	uint64_t firstDrawCount = 0;
+	// the main loop is skipped, so the first frame on the
+	// screen is the first warm up frame
+	StartupPhase firstFramePhase("FirstFrame");
+	for (int frame = -WARMUP_FRAMES; frame < frameCount; frame++)
+	{
+		if (frame == 0)
+		{
+			// drop what the warm up frames measured
+			pDevice->FlushTimers();
+			pDevice->EnableTimers(true, (size_t)frameCount);
+			firstDrawCount = pDevice->GetDrawCount();
+		}
+
+		glm::vec3 position;
+		glm::vec3 front;
+		GetPathCamera(std::max(frame, 0) * FRAME_STEP, position, front);
+		glm::mat4 view;
+		glm::mat4 projection;
+		ViewManager::GetCameraView(position, front, PATH_ZOOM, view, projection);
+
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		frameCommands.Reset();
+		frameCommands.BeginTimer(g_GPUName);
+		frameCommands.Clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+		ViewManager::PrepareView(frameCommands, view, projection, position);
+		pDevice->Submit(frameCommands);
+
+		pSceneManager->UpdateScenes();
+		pSceneManager->RenderScene();
+
+		frameCommands.Reset();
+		frameCommands.EndTimer();
+		pDevice->Submit(frameCommands);
+		std::chrono::duration<double, std::milli> cpuTime = std::chrono::steady_clock::now() - start;
+
+		glfwSwapBuffers(pWindow);
+		pDevice->EndFrame();
+		if (frame == -WARMUP_FRAMES)
+		{
+			firstFramePhase.Stop();
+			StartupTimeline::Finish();
+		}
+		glfwPollEvents();
+		Profiler::EndFrame();
+		std::chrono::duration<double, std::milli> frameTime = std::chrono::steady_clock::now() - start;
+
+		if (frame >= 0)
+		{
+			cpuStatistics.AddSample(g_CPUName, cpuTime.count());
+			cpuStatistics.AddSample(g_FrameName, frameTime.count());
+		}
+	}
+	pDevice->FlushTimers();
+
+	double drawsPerFrame = (double)(pDevice->GetDrawCount() - firstDrawCount) / frameCount;
+	double peakMemory = GetPeakMemory();
+	bool bWritten = WriteReport(reportFilename, frameCount,
+		cpuStatistics, pDevice->GetTimerStatistics(), drawsPerFrame, peakMemory);
+
+	cpuStatistics.Print("Benchmark CPU times");
+	pDevice->GetTimerStatistics().Print("Benchmark GPU times");
+	std::cout << "INFO: Benchmark of " << m_sceneName << ": " << frameCount << " frames, "
+		<< drawsPerFrame << " draws per frame, " << peakMemory << " KB peak memory, "
+		<< m_startupTime << " ms startup" << std::endl;
+
+	pDevice->EnableTimers(false);
+	glfwSwapInterval(1);
+
+	return(bWritten);
+}
+
+/***********************************************************
+ *  WriteReport()
+ *
+ *  This method is used for writing the measurements of the
+ *  run as JSON, with the times in milliseconds.
+ ***********************************************************/
+bool Benchmark::WriteReport(
+	const char* reportFilename,
+	int frameCount,
+	const TimerStatistics& cpuStatistics,
+	const TimerStatistics& gpuStatistics,
+	double drawsPerFrame,
+	double peakMemory) const
+{
+	std::ofstream reportFile(reportFilename, std::ios::trunc);
+	if (!reportFile.is_open())
+	{
+		std::cout << "Could not write benchmark report:" << reportFilename << std::endl;
+		return(false);
+	}
+
+	// the scene name is a file path, whose backslashes JSON
+	// needs escaped
+	std::string sceneName;
+	for (size_t i = 0; i < m_sceneName.size(); i++)
+	{
+		if ((m_sceneName[i] == '"') || (m_sceneName[i] == '\\'))
+		{
+			sceneName += '\\';
+		}
+		sceneName += m_sceneName[i];
+	}
+
+	reportFile << "{\n";
+	reportFile << "  \"scene\": \"" << sceneName << "\",\n";
+	reportFile << "  \"frames\": " << frameCount << ",\n";
+	reportFile << "  \"frame_step_ms\": " << FRAME_STEP * 1000.0 << ",\n";
+	reportFile << "  \"startup_ms\": " << m_startupTime << ",\n";
+	WriteSummary(reportFile, "frame_ms", cpuStatistics, g_FrameName);
+	reportFile << ",\n";
+	WriteSummary(reportFile, "cpu_ms", cpuStatistics, g_CPUName);
+	reportFile << ",\n";
+	WriteSummary(reportFile, "gpu_ms", gpuStatistics, g_GPUName);
+	reportFile << ",\n";
+	reportFile << "  \"draws_per_frame\": " << drawsPerFrame << ",\n";
+	reportFile << "  \"peak_memory_kb\": " << peakMemory << "\n";
+	reportFile << "}\n";
+
+	std::cout << "INFO: Wrote the benchmark report to " << reportFilename << std::endl;
+	return(true);
+}
@@ -0,0 +1,63 @@
+///////////////////////////////////////////////////////////////////////////////
+// benchmark.h
+// ============
+// play a fixed camera path through the scene and report the frame times
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GLRenderDevice.h"
+#include "SceneManager.h"
+
+#include "GLFW/glfw3.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+
+/***********************************************************
+ *  Benchmark
+ *
+ *  This class renders a number of frames in the window with
+ *  the camera on a fixed path, advanced by a fixed time step
+ *  instead of the clock, so every run draws the same frames.
+ *  The CPU and GPU frame times, draws and peak memory are
+ *  written to a JSON report, so builds can be compared and
+ *  tracked over time.
+ ***********************************************************/
+class Benchmark
+{
+public:
+	// constructor
+	Benchmark();
+
+	// time from the start of the application until the scene
+	// was ready, added to the report
+	void SetStartupTime(double milliseconds) { m_startupTime = milliseconds; }
+	// name of the scene in the report
+	void SetSceneName(const char* sceneName) { m_sceneName = sceneName; }
+
+	// render the frames of the camera path and write the report
+	bool Run(
+		GLFWwindow* pWindow,
+		GLRenderDevice* pDevice,
+		SceneManager* pSceneManager,
+		int frameCount,
+		const char* reportFilename);
+
+	// get the camera on the path at a time in seconds
+	static void GetPathCamera(double time, glm::vec3& position, glm::vec3& front);
+
+private:
+	std::string m_sceneName;
+	double m_startupTime;
+
+	// write the measurements as JSON
+	bool WriteReport(
+		const char* reportFilename,
+		int frameCount,
+		const TimerStatistics& cpuStatistics,
+		const TimerStatistics& gpuStatistics,
+		double drawsPerFrame,
+		double peakMemory) const;
+};
@@ -0,0 +1,345 @@
+///////////////////////////////////////////////////////////////////////////////
+// brdflut.cpp
+// ============
+// precompute the split-sum BRDF integration lookup table for PBR shading
+///////////////////////////////////////////////////////////////////////////////
+
+#include "BrdfLut.h"
+#include "Profiler.h"
+#include "ParallelFor.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define BRDF_LUT_USE_SSE
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// identifies the cache file, bump the version whenever
+	// the integration changes so stale caches are rebuilt
+	const char CACHE_MAGIC[4] = { 'B', 'L', 'U', 'T' };
+	const uint32_t CACHE_VERSION = 1;
+
+	struct CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		int32_t size;
+		int32_t sampleCount;
+	};
+
+	const float PI = 3.14159265358979f;
+
+	/***********************************************************
+	 *  RadicalInverse()
+	 *
+	 *  Van der Corput radical inverse used for the Hammersley
+	 *  low discrepancy sample sequence.
+	 ***********************************************************/
+	float RadicalInverse(uint32_t bits)
+	{
+		bits = (bits << 16u) | (bits >> 16u);
+		bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+		bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+		bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+		bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+		return(float(bits) * 2.3283064365386963e-10f);
+	}
+}
+
+/***********************************************************
+ *  BrdfLut()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+BrdfLut::BrdfLut()
+{
+	m_size = 0;
+	m_sampleCount = 0;
+	m_pDevice = NULL;
+	m_textureID = 0;
+}
+
+/***********************************************************
+ *  ~BrdfLut()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+BrdfLut::~BrdfLut()
+{
+	m_data.clear();
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for getting the table ready, either
+ *  from the cache file or by integrating it from scratch.
+ ***********************************************************/
+bool BrdfLut::Load(const char* cacheFilename, int size, int sampleCount)
+{
+	PROFILE_SCOPE("BrdfLut::Load");
+	m_size = size;
+	m_sampleCount = sampleCount;
+
+	if (ReadCache(cacheFilename))
+	{
+		std::cout << "Successfully loaded BRDF LUT cache:" << cacheFilename << std::endl;
+		return(true);
+	}
+
+	Integrate();
+
+	if (!WriteCache(cacheFilename))
+	{
+		std::cout << "Could not write BRDF LUT cache:" << cacheFilename << std::endl;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Integrate()
+ *
+ *  This method is used for integrating every row of the table,
+ *  with the rows spread over all of the CPU cores.
+ ***********************************************************/
+void BrdfLut::Integrate()
+{
+	m_data.assign((size_t)m_size * m_size * 2, 0.0f);
+
+	ParallelFor(m_size, [this](int row)
+	{
+		IntegrateRow(row);
+	});
+}
+
+/***********************************************************
+ *  IntegrateRow()
+ *
+ *  This method is used for integrating one row of the table.
+ *  All texels in a row share the same roughness, so the GGX
+ *  half vectors are generated once and four N dot V columns
+ *  are evaluated together with SSE.
+ ***********************************************************/
+void BrdfLut::IntegrateRow(int row)
+{
+	float roughness = (row + 0.5f) / m_size;
+	float alpha = roughness * roughness;
+	// Schlick-GGX geometry term remapping for image based lighting
+	float k = alpha / 2.0f;
+
+	// importance sample the GGX distribution around N = (0, 0, 1);
+	// V lies in the XZ plane, so only the x and z of H are needed
+	std::vector<float> halfX(m_sampleCount);
+	std::vector<float> halfZ(m_sampleCount);
+	for (int i = 0; i < m_sampleCount; i++)
+	{
+		float xi1 = float(i) / float(m_sampleCount);
+		float xi2 = RadicalInverse((uint32_t)i);
+		float phi = 2.0f * PI * xi1;
+		float cosTheta = std::sqrt((1.0f - xi2) / (1.0f + (alpha * alpha - 1.0f) * xi2));
+		float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+		halfX[i] = sinTheta * std::cos(phi);
+		halfZ[i] = cosTheta;
+	}
+
+	float* rowData = &m_data[(size_t)row * m_size * 2];
+	int column = 0;
+
+#ifdef BRDF_LUT_USE_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 one = _mm_set1_ps(1.0f);
+	const __m128 two = _mm_set1_ps(2.0f);
+	const __m128 kVector = _mm_set1_ps(k);
+	const __m128 oneMinusK = _mm_set1_ps(1.0f - k);
+
+	for (; column + 4 <= m_size; column += 4)
+	{
+		__m128 NdotV = _mm_set_ps(
+			(column + 3.5f) / m_size,
+			(column + 2.5f) / m_size,
+			(column + 1.5f) / m_size,
+			(column + 0.5f) / m_size);
+		__m128 viewX = _mm_sqrt_ps(_mm_sub_ps(one, _mm_mul_ps(NdotV, NdotV)));
+		__m128 viewZ = NdotV;
+		__m128 geometryV = _mm_div_ps(NdotV, _mm_add_ps(_mm_mul_ps(NdotV, oneMinusK), kVector));
+		__m128 scale = zero;
+		__m128 bias = zero;
+
+		for (int i = 0; i < m_sampleCount; i++)
+		{
+			__m128 hx = _mm_set1_ps(halfX[i]);
+			__m128 hz = _mm_set1_ps(halfZ[i]);
+
+			__m128 VdotH = _mm_max_ps(_mm_add_ps(_mm_mul_ps(viewX, hx), _mm_mul_ps(viewZ, hz)), zero);
+			// L = 2 * dot(V, H) * H - V
+			__m128 NdotL = _mm_sub_ps(_mm_mul_ps(_mm_mul_ps(two, VdotH), hz), viewZ);
+			__m128 valid = _mm_cmpgt_ps(NdotL, zero);
+			NdotL = _mm_max_ps(NdotL, zero);
+
+			__m128 geometryL = _mm_div_ps(NdotL, _mm_add_ps(_mm_mul_ps(NdotL, oneMinusK), kVector));
+			__m128 visibility = _mm_div_ps(
+				_mm_mul_ps(_mm_mul_ps(geometryV, geometryL), VdotH),
+				_mm_mul_ps(hz, NdotV));
+
+			// Fc = (1 - VdotH)^5 without calling pow()
+			__m128 oneMinusVdotH = _mm_sub_ps(one, VdotH);
+			__m128 squared = _mm_mul_ps(oneMinusVdotH, oneMinusVdotH);
+			__m128 fresnel = _mm_mul_ps(_mm_mul_ps(squared, squared), oneMinusVdotH);
+
+			visibility = _mm_and_ps(visibility, valid);
+			scale = _mm_add_ps(scale, _mm_mul_ps(_mm_sub_ps(one, fresnel), visibility));
+			bias = _mm_add_ps(bias, _mm_mul_ps(fresnel, visibility));
+		}
+
+		float scaleValues[4];
+		float biasValues[4];
+		_mm_storeu_ps(scaleValues, scale);
+		_mm_storeu_ps(biasValues, bias);
+		for (int lane = 0; lane < 4; lane++)
+		{
+			rowData[(column + lane) * 2 + 0] = scaleValues[lane] / m_sampleCount;
+			rowData[(column + lane) * 2 + 1] = biasValues[lane] / m_sampleCount;
+		}
+	}
+#endif
+
+	// remaining columns, or all of them without SSE
+	for (; column < m_size; column++)
+	{
+		float NdotV = (column + 0.5f) / m_size;
+		float viewX = std::sqrt(1.0f - NdotV * NdotV);
+		float viewZ = NdotV;
+		float geometryV = NdotV / (NdotV * (1.0f - k) + k);
+		float scale = 0.0f;
+		float bias = 0.0f;
+
+		for (int i = 0; i < m_sampleCount; i++)
+		{
+			float VdotH = std::fmax(viewX * halfX[i] + viewZ * halfZ[i], 0.0f);
+			float NdotL = 2.0f * VdotH * halfZ[i] - viewZ;
+			if (NdotL > 0.0f)
+			{
+				float geometryL = NdotL / (NdotL * (1.0f - k) + k);
+				float visibility = geometryV * geometryL * VdotH / (halfZ[i] * NdotV);
+				float oneMinusVdotH = 1.0f - VdotH;
+				float squared = oneMinusVdotH * oneMinusVdotH;
+				float fresnel = squared * squared * oneMinusVdotH;
+				scale += (1.0f - fresnel) * visibility;
+				bias += fresnel * visibility;
+			}
+		}
+
+		rowData[column * 2 + 0] = scale / m_sampleCount;
+		rowData[column * 2 + 1] = bias / m_sampleCount;
+	}
+}
+
+/***********************************************************
+ *  ReadCache()
+ *
+ *  This method is used for reading a previously integrated
+ *  table, as long as it matches the requested settings.
+ ***********************************************************/
+bool BrdfLut::ReadCache(const char* cacheFilename)
+{
+	std::ifstream cacheFile(cacheFilename, std::ios::binary);
+	if (!cacheFile.is_open())
+	{
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	cacheFile.read((char*)&header, sizeof(header));
+	if (!cacheFile ||
+		(memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) ||
+		(header.version != CACHE_VERSION) ||
+		(header.size != m_size) ||
+		(header.sampleCount != m_sampleCount))
+	{
+		return(false);
+	}
+
+	m_data.resize((size_t)m_size * m_size * 2);
+	cacheFile.read((char*)m_data.data(), m_data.size() * sizeof(float));
+	if (!cacheFile)
+	{
+		m_data.clear();
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteCache()
+ *
+ *  This method is used for saving the integrated table so
+ *  the following launches can skip the integration.
+ ***********************************************************/
+bool BrdfLut::WriteCache(const char* cacheFilename)
+{
+	std::ofstream cacheFile(cacheFilename, std::ios::binary | std::ios::trunc);
+	if (!cacheFile.is_open())
+	{
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.size = m_size;
+	header.sampleCount = m_sampleCount;
+
+	cacheFile.write((const char*)&header, sizeof(header));
+	cacheFile.write((const char*)m_data.data(), m_data.size() * sizeof(float));
+
+	return(cacheFile.good());
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for uploading the table into a
+ *  texture that is sampled with (N dot V, roughness).
+ ***********************************************************/
+RENDER_TEXTURE BrdfLut::CreateTexture(RenderDevice* pDevice)
+{
+	if ((NULL == pDevice) || m_data.empty())
+	{
+		return(0);
+	}
+
+	DestroyTexture();
+
+	// the table is addressed in [0, 1] so it must not wrap
+	RenderDevice::TEXTURE_DESC desc = RenderDevice::GetTextureDesc(RenderDevice::FORMAT_RG16F, m_size, m_size);
+	const void* levels[1] = { m_data.data() };
+
+	m_pDevice = pDevice;
+	m_textureID = m_pDevice->CreateTexture(desc, levels);
+
+	return(m_textureID);
+}
+
+/***********************************************************
+ *  DestroyTexture()
+ *
+ *  This method is used for freeing the texture.
+ ***********************************************************/
+void BrdfLut::DestroyTexture()
+{
+	if (m_textureID != 0)
+	{
+		m_pDevice->DestroyTexture(m_textureID);
+		m_textureID = 0;
+	}
+}
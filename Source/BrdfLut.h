@@ -0,0 +1,61 @@
+///////////////////////////////////////////////////////////////////////////////
+// brdflut.h
+// ============
+// precompute the split-sum BRDF integration lookup table for PBR shading
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+
+#include <vector>
+
+/***********************************************************
+ *  BrdfLut
+ *
+ *  This class integrates the GGX specular BRDF over the
+ *  hemisphere for every (N dot V, roughness) pair, giving the
+ *  scale and bias applied to F0 by the shader.  The table is
+ *  computed on all CPU cores and cached to disk, so at run
+ *  time it costs a single texture fetch per fragment.
+ ***********************************************************/
+class BrdfLut
+{
+public:
+	// constructor
+	BrdfLut();
+	// destructor
+	~BrdfLut();
+
+	// read the table from the cache file, or integrate it and
+	// write the cache file when it is missing or out of date
+	bool Load(const char* cacheFilename, int size = 128, int sampleCount = 1024);
+
+	// upload the table into a two channel texture
+	RENDER_TEXTURE CreateTexture(RenderDevice* pDevice);
+	// free the texture
+	void DestroyTexture();
+
+	// get the table dimension and the interleaved scale/bias data
+	int GetSize() const { return(m_size); }
+	const std::vector<float>& GetData() const { return(m_data); }
+
+private:
+	// width and height of the table in texels
+	int m_size;
+	// number of Monte Carlo samples used for each texel
+	int m_sampleCount;
+	// interleaved scale and bias values, one pair per texel
+	std::vector<float> m_data;
+	// texture holding the table, and the device it is on
+	RenderDevice* m_pDevice;
+	RENDER_TEXTURE m_textureID;
+
+	// integrate the table with importance sampled GGX
+	void Integrate();
+	// integrate a single row of the table (one roughness value)
+	void IntegrateRow(int row);
+	// read and write the cache file
+	bool ReadCache(const char* cacheFilename);
+	bool WriteCache(const char* cacheFilename);
+};
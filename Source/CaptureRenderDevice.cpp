@@ -0,0 +1,849 @@
+///////////////////////////////////////////////////////////////////////////////
+// capturerenderdevice.cpp
+// ============
+// record the render device calls of a range of frames into a capture file
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CaptureRenderDevice.h"
+#include "FrameArena.h"
+#include "Profiler.h"
+
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// bytes per pixel of the data each texture format is
+	// created from
+	const size_t g_TexturePixelSizes[] = {
+		1,
+		3,
+		4,
+		2 * sizeof(float),
+		3 * sizeof(float) };
+
+	const double NANOSECONDS_PER_MILLISECOND = 1000000.0;
+	const double BYTES_PER_MEGABYTE = 1024.0 * 1024.0;
+
+	// number of float values of the uniform commands
+	uint32_t GetUniformFloatCount(uint32_t commandType)
+	{
+		switch (commandType)
+		{
+		case RenderCommandList::COMMAND_SET_FLOAT:
+			return(1);
+		case RenderCommandList::COMMAND_SET_VEC2:
+			return(2);
+		case RenderCommandList::COMMAND_SET_VEC3:
+			return(3);
+		case RenderCommandList::COMMAND_SET_VEC4:
+			return(4);
+		case RenderCommandList::COMMAND_SET_MAT4:
+			return(16);
+		}
+		return(0);
+	}
+
+	// read a whole text file into a string
+	bool ReadTextFile(const char* filename, std::string& text)
+	{
+		std::ifstream file(filename, std::ios::binary);
+		if (!file.is_open())
+		{
+			std::cout << "Could not open the shader source " << filename << std::endl;
+			return(false);
+		}
+		std::stringstream contents;
+		contents << file.rdbuf();
+		text = contents.str();
+		return(true);
+	}
+}
+
+const char CaptureRenderDevice::CAPTURE_MAGIC[4] = { 'R', 'C', 'A', 'P' };
+
+/***********************************************************
+ *  CaptureRenderDevice()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CaptureRenderDevice::CaptureRenderDevice(RenderDevice* pDevice)
+{
+	m_pDevice = pDevice;
+	m_frameIndex = 0;
+	m_firstFrame = 0;
+	m_lastFrame = 0;
+	m_bKeepCopies = true;
+	m_frameStartTime = Profiler::GetTime();
+	m_captureBytes = 0;
+}
+
+/***********************************************************
+ *  ~CaptureRenderDevice()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CaptureRenderDevice::~CaptureRenderDevice()
+{
+	StopCapture();
+	delete m_pDevice;
+}
+
+/***********************************************************
+ *  SetShaderSources()
+ *
+ *  This method is used for reading the GLSL sources of the
+ *  shader program, which are written at the start of the
+ *  capture.  The GLSL files are read even when the program
+ *  was made from the SPIR-V modules, since any driver can
+ *  compile them.
+ ***********************************************************/
+bool CaptureRenderDevice::SetShaderSources(const char* vertexFilename, const char* fragmentFilename)
+{
+	return(ReadTextFile(vertexFilename, m_shaderSources[SHADER_VERTEX]) &&
+		ReadTextFile(fragmentFilename, m_shaderSources[SHADER_FRAGMENT]));
+}
+
+/***********************************************************
+ *  StartCapture()
+ *
+ *  This method is used for setting the range of frames that
+ *  is captured.  The capture file is opened when the first
+ *  frame of the range starts, right away if it already has.
+ ***********************************************************/
+bool CaptureRenderDevice::StartCapture(int firstFrame, int frameCount, const char* filename)
+{
+	if (!m_bKeepCopies || IsCapturing())
+	{
+		std::cout << "Only one capture can be made, from the start of the device" << std::endl;
+		return(false);
+	}
+	if ((firstFrame < 0) || (frameCount <= 0))
+	{
+		std::cout << "Captures need a first frame from 0 on and at least one frame" << std::endl;
+		return(false);
+	}
+
+	m_firstFrame = firstFrame;
+	m_lastFrame = firstFrame + frameCount;
+	m_captureFilename = filename;
+	if (m_frameIndex >= m_firstFrame)
+	{
+		return(BeginCapture());
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  StopCapture()
+ *
+ *  This method is used for finishing the capture file with
+ *  the frames captured so far, and dropping the copies of
+ *  the objects if it never started.
+ ***********************************************************/
+void CaptureRenderDevice::StopCapture()
+{
+	if (IsCapturing())
+	{
+		FinishCapture();
+	}
+	else if (m_bKeepCopies && !m_captureFilename.empty())
+	{
+		std::cout << "The capture did not start, only " << m_frameIndex << " frames were rendered" << std::endl;
+	}
+	m_bKeepCopies = false;
+	m_buffers.clear();
+	m_textures.clear();
+	m_renderTargets.clear();
+	m_pipelines.clear();
+}
+
+/***********************************************************
+ *  BeginCapture()
+ *
+ *  This method is used for opening the capture file and
+ *  writing the header, the shader sources and the objects
+ *  that exist, with the contents they have at this point.
+ *  The copies of the objects are not needed after this.
+ ***********************************************************/
+bool CaptureRenderDevice::BeginCapture()
+{
+	m_captureFile.open(m_captureFilename.c_str(), std::ios::binary | std::ios::trunc);
+	if (!m_captureFile.is_open())
+	{
+		std::cout << "Could not open the capture file " << m_captureFilename << std::endl;
+		m_captureFilename.clear();
+		StopCapture();
+		return(false);
+	}
+
+	CAPTURE_HEADER header;
+	memcpy(header.magic, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC));
+	header.version = CAPTURE_VERSION;
+	m_pDevice->GetWindowSize(header.windowWidth, header.windowHeight);
+	header.uniformBufferAlignment = (uint32_t)m_pDevice->GetUniformBufferAlignment();
+	header.frameCount = 0;
+	m_captureFile.write((const char*)&header, sizeof(header));
+	m_captureBytes = sizeof(header);
+
+	for (uint32_t stage = SHADER_VERTEX; stage <= SHADER_FRAGMENT; stage++)
+	{
+		uint32_t values[2] = { stage, (uint32_t)m_shaderSources[stage].size() };
+		CaptureByte(CAPTURE_SHADER);
+		CaptureValues(values, 2);
+		CaptureBytes(m_shaderSources[stage].data(), m_shaderSources[stage].size());
+	}
+
+	// write the copies out, dropping them as they are written
+	m_bKeepCopies = false;
+	for (std::map<RENDER_BUFFER, BUFFER_COPY>::iterator it = m_buffers.begin(); it != m_buffers.end(); ++it)
+	{
+		CaptureBuffer(it->first, it->second.desc, it->second.data.data());
+		FlushCapture();
+		std::vector<char>().swap(it->second.data);
+	}
+	for (std::map<RENDER_TEXTURE, TEXTURE_COPY>::iterator it = m_textures.begin(); it != m_textures.end(); ++it)
+	{
+		std::vector<const void*> images;
+		for (size_t i = 0; i < it->second.images.size(); i++)
+		{
+			images.push_back(it->second.images[i].empty() ? NULL : it->second.images[i].data());
+		}
+		CaptureTexture(it->first, it->second.desc, it->second.bHasData ? images.data() : NULL);
+		FlushCapture();
+		std::vector<std::vector<char> >().swap(it->second.images);
+	}
+	for (std::map<RENDER_TARGET, std::pair<int, int> >::iterator it = m_renderTargets.begin(); it != m_renderTargets.end(); ++it)
+	{
+		CaptureRenderTarget(it->first, it->second.first, it->second.second);
+	}
+	for (std::map<RENDER_PIPELINE, PIPELINE_COPY>::iterator it = m_pipelines.begin(); it != m_pipelines.end(); ++it)
+	{
+		PIPELINE_DESC desc = it->second.desc;
+		desc.uniformBlockName = it->second.uniformBlockName.empty() ? NULL : it->second.uniformBlockName.c_str();
+		CapturePipeline(it->first, desc);
+	}
+	m_buffers.clear();
+	m_textures.clear();
+	m_renderTargets.clear();
+	m_pipelines.clear();
+
+	CaptureByte(CAPTURE_BEGIN_FRAMES);
+	FlushCapture();
+	std::cout << "INFO: Capturing frames " << m_firstFrame << " to " << m_lastFrame - 1
+		<< " into " << m_captureFilename << std::endl;
+
+	m_frameStartTime = Profiler::GetTime();
+	return(m_captureFile.good());
+}
+
+/***********************************************************
+ *  FinishCapture()
+ *
+ *  This method is used for writing the remaining records and
+ *  the number of frames captured, and closing the file.
+ ***********************************************************/
+void CaptureRenderDevice::FinishCapture()
+{
+	FlushCapture();
+
+	uint32_t frameCount = (uint32_t)(m_frameIndex - m_firstFrame);
+	m_captureFile.seekp(offsetof(CAPTURE_HEADER, frameCount));
+	m_captureFile.write((const char*)&frameCount, sizeof(frameCount));
+	bool bWritten = m_captureFile.good();
+	m_captureFile.close();
+	m_captureNames.clear();
+
+	if (bWritten)
+	{
+		std::cout << "INFO: Captured " << frameCount << " frames into " << m_captureFilename << ", "
+			<< m_captureBytes / BYTES_PER_MEGABYTE << " MB" << std::endl;
+	}
+	else
+	{
+		std::cout << "Could not write the capture file " << m_captureFilename << std::endl;
+	}
+}
+
+/***********************************************************
+ *  GetImageSize()
+ *
+ *  This method is used for getting the bytes of pixel data
+ *  a level of a texture, or of one face of a cube map, is
+ *  created from.
+ ***********************************************************/
+size_t CaptureRenderDevice::GetImageSize(const TEXTURE_DESC& desc, int level)
+{
+	if (desc.format >= sizeof(g_TexturePixelSizes) / sizeof(g_TexturePixelSizes[0]))
+	{
+		return(0);
+	}
+
+	int width = (desc.width >> level) > 1 ? (desc.width >> level) : 1;
+	int height = (desc.height >> level) > 1 ? (desc.height >> level) : 1;
+	return((size_t)width * height * g_TexturePixelSizes[desc.format]);
+}
+
+/***********************************************************
+ *  CreateBuffer()
+ *
+ *  This method is used for creating a buffer.
+ ***********************************************************/
+RENDER_BUFFER CaptureRenderDevice::CreateBuffer(const BUFFER_DESC& desc, const void* data)
+{
+	RENDER_BUFFER buffer = m_pDevice->CreateBuffer(desc, data);
+	if (buffer == 0)
+	{
+		return(0);
+	}
+
+	if (IsCapturing())
+	{
+		CaptureBuffer(buffer, desc, data);
+	}
+	else if (m_bKeepCopies)
+	{
+		BUFFER_COPY& copy = m_buffers[buffer];
+		copy.desc = desc;
+		copy.data.assign(desc.size, 0);
+		if (NULL != data)
+		{
+			memcpy(copy.data.data(), data, desc.size);
+		}
+	}
+	return(buffer);
+}
+
+/***********************************************************
+ *  UpdateBuffer()
+ *
+ *  This method is used for overwriting a range of a buffer.
+ ***********************************************************/
+void CaptureRenderDevice::UpdateBuffer(RENDER_BUFFER buffer, size_t offset, size_t size, const void* data)
+{
+	m_pDevice->UpdateBuffer(buffer, offset, size, data);
+
+	if (IsCapturing())
+	{
+		uint32_t values[3] = { buffer, (uint32_t)offset, (uint32_t)size };
+		CaptureByte(CAPTURE_UPDATE_BUFFER);
+		CaptureValues(values, 3);
+		CaptureBytes(data, size);
+	}
+	else if (m_bKeepCopies)
+	{
+		std::map<RENDER_BUFFER, BUFFER_COPY>::iterator it = m_buffers.find(buffer);
+		if ((it != m_buffers.end()) && (offset + size <= it->second.data.size()))
+		{
+			memcpy(&it->second.data[offset], data, size);
+		}
+	}
+}
+
+/***********************************************************
+ *  CopyBuffer()
+ *
+ *  This method is used for copying the start of one buffer
+ *  into another.
+ ***********************************************************/
+void CaptureRenderDevice::CopyBuffer(RENDER_BUFFER source, RENDER_BUFFER destination, size_t size)
+{
+	m_pDevice->CopyBuffer(source, destination, size);
+
+	if (IsCapturing())
+	{
+		uint32_t values[3] = { source, destination, (uint32_t)size };
+		CaptureByte(CAPTURE_COPY_BUFFER);
+		CaptureValues(values, 3);
+	}
+	else if (m_bKeepCopies)
+	{
+		std::map<RENDER_BUFFER, BUFFER_COPY>::iterator from = m_buffers.find(source);
+		std::map<RENDER_BUFFER, BUFFER_COPY>::iterator to = m_buffers.find(destination);
+		if ((from != m_buffers.end()) && (to != m_buffers.end()) &&
+			(size <= from->second.data.size()) && (size <= to->second.data.size()))
+		{
+			memcpy(to->second.data.data(), from->second.data.data(), size);
+		}
+	}
+}
+
+/***********************************************************
+ *  DestroyBuffer()
+ *
+ *  This method is used for freeing a buffer.
+ ***********************************************************/
+void CaptureRenderDevice::DestroyBuffer(RENDER_BUFFER buffer)
+{
+	m_pDevice->DestroyBuffer(buffer);
+	CaptureDestroy(OBJECT_BUFFER, buffer);
+	m_buffers.erase(buffer);
+}
+
+/***********************************************************
+ *  GetUniformBufferAlignment()
+ *
+ *  This method is used for getting the alignment of uniform
+ *  buffer ranges.
+ ***********************************************************/
+size_t CaptureRenderDevice::GetUniformBufferAlignment() const
+{
+	return(m_pDevice->GetUniformBufferAlignment());
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for creating a texture.
+ ***********************************************************/
+RENDER_TEXTURE CaptureRenderDevice::CreateTexture(const TEXTURE_DESC& desc, const void* const* data)
+{
+	RENDER_TEXTURE texture = m_pDevice->CreateTexture(desc, data);
+	if (texture == 0)
+	{
+		return(0);
+	}
+
+	if (IsCapturing())
+	{
+		CaptureTexture(texture, desc, data);
+	}
+	else if (m_bKeepCopies)
+	{
+		TEXTURE_COPY& copy = m_textures[texture];
+		copy.desc = desc;
+		copy.bHasData = (NULL != data);
+		copy.images.clear();
+
+		int faceCount = (desc.type == TEXTURE_CUBE) ? 6 : 1;
+		int levelCount = (desc.mipLevels > 0) ? desc.mipLevels : 1;
+		for (int face = 0; (NULL != data) && (face < faceCount); face++)
+		{
+			for (int level = 0; level < levelCount; level++)
+			{
+				const char* image = (const char*)data[face * levelCount + level];
+				copy.images.push_back(std::vector<char>());
+				if (NULL != image)
+				{
+					copy.images.back().assign(image, image + GetImageSize(desc, level));
+				}
+			}
+		}
+	}
+	return(texture);
+}
+
+/***********************************************************
+ *  DestroyTexture()
+ *
+ *  This method is used for freeing a texture.
+ ***********************************************************/
+void CaptureRenderDevice::DestroyTexture(RENDER_TEXTURE texture)
+{
+	m_pDevice->DestroyTexture(texture);
+	CaptureDestroy(OBJECT_TEXTURE, texture);
+	m_textures.erase(texture);
+}
+
+/***********************************************************
+ *  CreateRenderTarget()
+ *
+ *  This method is used for creating an offscreen target.
+ ***********************************************************/
+RENDER_TARGET CaptureRenderDevice::CreateRenderTarget(int width, int height)
+{
+	RENDER_TARGET target = m_pDevice->CreateRenderTarget(width, height);
+	if (target == 0)
+	{
+		return(0);
+	}
+
+	if (IsCapturing())
+	{
+		CaptureRenderTarget(target, width, height);
+	}
+	else if (m_bKeepCopies)
+	{
+		m_renderTargets[target] = std::make_pair(width, height);
+	}
+	return(target);
+}
+
+/***********************************************************
+ *  ReadPixels()
+ *
+ *  This method is used for reading back a target.  Reading
+ *  does not change anything, so it is not captured.
+ ***********************************************************/
+bool CaptureRenderDevice::ReadPixels(RENDER_TARGET target, int width, int height, void* pixels)
+{
+	return(m_pDevice->ReadPixels(target, width, height, pixels));
+}
+
+/***********************************************************
+ *  DestroyRenderTarget()
+ *
+ *  This method is used for freeing an offscreen target.
+ ***********************************************************/
+void CaptureRenderDevice::DestroyRenderTarget(RENDER_TARGET target)
+{
+	m_pDevice->DestroyRenderTarget(target);
+	CaptureDestroy(OBJECT_RENDER_TARGET, target);
+	m_renderTargets.erase(target);
+}
+
+/***********************************************************
+ *  GetWindowSize()
+ *
+ *  This method is used for getting the size of the window.
+ ***********************************************************/
+void CaptureRenderDevice::GetWindowSize(int& width, int& height) const
+{
+	m_pDevice->GetWindowSize(width, height);
+}
+
+/***********************************************************
+ *  CreatePipeline()
+ *
+ *  This method is used for creating a pipeline.
+ ***********************************************************/
+RENDER_PIPELINE CaptureRenderDevice::CreatePipeline(const PIPELINE_DESC& desc)
+{
+	RENDER_PIPELINE pipeline = m_pDevice->CreatePipeline(desc);
+	if (pipeline == 0)
+	{
+		return(0);
+	}
+
+	if (IsCapturing())
+	{
+		CapturePipeline(pipeline, desc);
+	}
+	else if (m_bKeepCopies)
+	{
+		PIPELINE_COPY& copy = m_pipelines[pipeline];
+		copy.desc = desc;
+		copy.uniformBlockName = (NULL != desc.uniformBlockName) ? desc.uniformBlockName : "";
+	}
+	return(pipeline);
+}
+
+/***********************************************************
+ *  DestroyPipeline()
+ *
+ *  This method is used for freeing a pipeline.
+ ***********************************************************/
+void CaptureRenderDevice::DestroyPipeline(RENDER_PIPELINE pipeline)
+{
+	m_pDevice->DestroyPipeline(pipeline);
+	CaptureDestroy(OBJECT_PIPELINE, pipeline);
+	m_pipelines.erase(pipeline);
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for capturing the commands of a list
+ *  and running them on the device.
+ ***********************************************************/
+void CaptureRenderDevice::Submit(const RenderCommandList& commands)
+{
+	if (IsCapturing())
+	{
+		for (size_t i = 0; i < commands.GetCommandCount(); i++)
+		{
+			CaptureCommand(commands, commands.GetCommand(i));
+		}
+		uint32_t commandCount = (uint32_t)commands.GetCommandCount();
+		CaptureByte(CAPTURE_SUBMIT);
+		CaptureValues(&commandCount, 1);
+	}
+
+	m_pDevice->Submit(commands);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for ending a frame, which starts or
+ *  finishes the capture at the ends of its range.  The time
+ *  of a captured frame is taken before its records are
+ *  written to the file.
+ ***********************************************************/
+void CaptureRenderDevice::EndFrame()
+{
+	m_pDevice->EndFrame();
+
+	int64_t frameEndTime = Profiler::GetTime();
+	if (IsCapturing())
+	{
+		// new names and records grow the capture as it is written
+		FrameArena::ExpectAllocations();
+		float frameTime = (float)((frameEndTime - m_frameStartTime) / NANOSECONDS_PER_MILLISECOND);
+		CaptureByte(CAPTURE_END_FRAME);
+		CaptureValues(&frameTime, 1);
+		FlushCapture();
+	}
+	m_frameIndex++;
+
+	if (IsCapturing() && (m_frameIndex >= m_lastFrame))
+	{
+		StopCapture();
+	}
+	else if (m_bKeepCopies && !m_captureFilename.empty() && (m_frameIndex == m_firstFrame))
+	{
+		FrameArena::ExpectAllocations();
+		BeginCapture();
+	}
+	m_frameStartTime = Profiler::GetTime();
+}
+
+/***********************************************************
+ *  CaptureBuffer()
+ *
+ *  This method is used for appending the creation of a
+ *  buffer with its contents.
+ ***********************************************************/
+void CaptureRenderDevice::CaptureBuffer(RENDER_BUFFER buffer, const BUFFER_DESC& desc, const void* data)
+{
+	uint32_t flags = ((NULL != data) ? FLAG_DATA : 0) | (desc.bDynamic ? FLAG_DYNAMIC : 0);
+	uint32_t values[4] = { buffer, desc.type, (uint32_t)desc.size, flags };
+	CaptureByte(CAPTURE_CREATE_BUFFER);
+	CaptureValues(values, 4);
+	if (NULL != data)
+	{
+		CaptureBytes(data, desc.size);
+	}
+}
+
+/***********************************************************
+ *  CaptureTexture()
+ *
+ *  This method is used for appending the creation of a
+ *  texture, with the size and pixels of each image it is
+ *  created from, and a size of 0 for images passed as NULL.
+ ***********************************************************/
+void CaptureRenderDevice::CaptureTexture(RENDER_TEXTURE texture, const TEXTURE_DESC& desc, const void* const* data)
+{
+	uint32_t flags = ((NULL != data) ? FLAG_DATA : 0) |
+		(desc.bGenerateMipmaps ? FLAG_GENERATE_MIPMAPS : 0) |
+		(desc.bMipmapFiltering ? FLAG_MIPMAP_FILTERING : 0) |
+		(desc.bRepeat ? FLAG_REPEAT : 0);
+	uint32_t values[7] = {
+		texture,
+		desc.type,
+		desc.format,
+		(uint32_t)desc.width,
+		(uint32_t)desc.height,
+		(uint32_t)desc.mipLevels,
+		flags };
+	CaptureByte(CAPTURE_CREATE_TEXTURE);
+	CaptureValues(values, 7);
+
+	int faceCount = (desc.type == TEXTURE_CUBE) ? 6 : 1;
+	int levelCount = (desc.mipLevels > 0) ? desc.mipLevels : 1;
+	for (int face = 0; (NULL != data) && (face < faceCount); face++)
+	{
+		for (int level = 0; level < levelCount; level++)
+		{
+			const void* image = data[face * levelCount + level];
+			uint32_t size = (NULL != image) ? (uint32_t)GetImageSize(desc, level) : 0;
+			CaptureValues(&size, 1);
+			CaptureBytes(image, size);
+		}
+	}
+}
+
+/***********************************************************
+ *  CaptureRenderTarget()
+ *
+ *  This method is used for appending the creation of an
+ *  offscreen target.
+ ***********************************************************/
+void CaptureRenderDevice::CaptureRenderTarget(RENDER_TARGET target, int width, int height)
+{
+	uint32_t values[3] = { target, (uint32_t)width, (uint32_t)height };
+	CaptureByte(CAPTURE_CREATE_RENDER_TARGET);
+	CaptureValues(values, 3);
+}
+
+/***********************************************************
+ *  CapturePipeline()
+ *
+ *  This method is used for appending the creation of a
+ *  pipeline, followed by the length and characters of its
+ *  uniform block name - a length of 0 is no block.
+ ***********************************************************/
+void CaptureRenderDevice::CapturePipeline(RENDER_PIPELINE pipeline, const PIPELINE_DESC& desc)
+{
+	uint32_t flags = (desc.bDepthTest ? FLAG_DEPTH_TEST : 0) |
+		(desc.bDepthWrite ? FLAG_DEPTH_WRITE : 0) |
+		(desc.bPolygonOffset ? FLAG_POLYGON_OFFSET : 0);
+	uint32_t nameLength = (NULL != desc.uniformBlockName) ? (uint32_t)strlen(desc.uniformBlockName) : 0;
+	uint32_t values[5] = { pipeline, desc.blendMode, flags, desc.uniformBlockBinding, nameLength };
+	CaptureByte(CAPTURE_CREATE_PIPELINE);
+	CaptureValues(values, 5);
+	CaptureBytes(desc.uniformBlockName, nameLength);
+}
+
+/***********************************************************
+ *  CaptureDestroy()
+ *
+ *  This method is used for appending an object being freed.
+ ***********************************************************/
+void CaptureRenderDevice::CaptureDestroy(uint32_t objectType, uint32_t handle)
+{
+	if (!IsCapturing())
+	{
+		return;
+	}
+
+	CaptureByte(CAPTURE_DESTROY);
+	CaptureByte((uint8_t)objectType);
+	CaptureValues(&handle, 1);
+}
+
+/***********************************************************
+ *  CaptureCommand()
+ *
+ *  This method is used for appending a command of a list
+ *  with only the values its type uses.
+ ***********************************************************/
+void CaptureRenderDevice::CaptureCommand(const RenderCommandList& commands, const RenderCommandList::COMMAND& command)
+{
+	// uniform names are defined before the command using them
+	uint32_t nameIndex = 0;
+	if (((command.type >= RenderCommandList::COMMAND_SET_INT) &&
+		(command.type <= RenderCommandList::COMMAND_SET_MAT4)) ||
+		(command.type == RenderCommandList::COMMAND_BEGIN_TIMER))
+	{
+		nameIndex = CaptureName(commands.GetName(command));
+	}
+
+	CaptureByte((uint8_t)command.type);
+
+	switch (command.type)
+	{
+	case RenderCommandList::COMMAND_SET_RENDER_TARGET:
+		CaptureValues(&command.handle, 1);
+		CaptureValues(command.arguments, 2);
+		break;
+	case RenderCommandList::COMMAND_CLEAR:
+		CaptureValues(command.floatValues, 4);
+		break;
+	case RenderCommandList::COMMAND_SET_PIPELINE:
+		CaptureValues(&command.handle, 1);
+		break;
+	case RenderCommandList::COMMAND_BIND_TEXTURE:
+		CaptureValues(command.arguments, 1);
+		CaptureValues(&command.handle, 1);
+		break;
+	case RenderCommandList::COMMAND_BIND_UNIFORM_BUFFER:
+		CaptureValues(command.arguments, 1);
+		CaptureValues(&command.handle, 1);
+		CaptureValues(&command.arguments[1], 2);
+		break;
+	case RenderCommandList::COMMAND_SET_INT:
+		CaptureValues(&nameIndex, 1);
+		CaptureValues(&command.intValue, 1);
+		break;
+	case RenderCommandList::COMMAND_SET_FLOAT:
+	case RenderCommandList::COMMAND_SET_VEC2:
+	case RenderCommandList::COMMAND_SET_VEC3:
+	case RenderCommandList::COMMAND_SET_VEC4:
+	case RenderCommandList::COMMAND_SET_MAT4:
+		CaptureValues(&nameIndex, 1);
+		CaptureValues(command.floatValues, GetUniformFloatCount(command.type));
+		break;
+	case RenderCommandList::COMMAND_DRAW_SHAPE:
+		CaptureValues(command.arguments, 2);
+		break;
+	case RenderCommandList::COMMAND_DRAW:
+		CaptureValues(&command.handle, 1);
+		CaptureValues(command.arguments, 2);
+		break;
+	case RenderCommandList::COMMAND_BEGIN_TIMER:
+		CaptureValues(&nameIndex, 1);
+		break;
+	}
+}
+
+/***********************************************************
+ *  CaptureName()
+ *
+ *  This method is used for getting the index of a uniform
+ *  or timer name, writing its definition the first time
+ *  the name is used.
+ ***********************************************************/
+uint32_t CaptureRenderDevice::CaptureName(const char* name)
+{
+	std::unordered_map<std::string, uint32_t>::const_iterator it = m_captureNames.find(name);
+	if (it != m_captureNames.end())
+	{
+		return(it->second);
+	}
+
+	uint32_t nameIndex = (uint32_t)m_captureNames.size();
+	m_captureNames[name] = nameIndex;
+
+	uint16_t length = (uint16_t)strlen(name);
+	CaptureByte(CAPTURE_NAME);
+	CaptureBytes(&length, sizeof(length));
+	CaptureBytes(name, length);
+
+	return(nameIndex);
+}
+
+/***********************************************************
+ *  CaptureByte()
+ *
+ *  This method is used for appending a byte to the records.
+ ***********************************************************/
+void CaptureRenderDevice::CaptureByte(uint8_t value)
+{
+	m_captureData.push_back((char)value);
+}
+
+/***********************************************************
+ *  CaptureValues()
+ *
+ *  This method is used for appending 32 bit values to the
+ *  records.
+ ***********************************************************/
+void CaptureRenderDevice::CaptureValues(const void* values, size_t count)
+{
+	CaptureBytes(values, count * sizeof(uint32_t));
+}
+
+/***********************************************************
+ *  CaptureBytes()
+ *
+ *  This method is used for appending bytes to the records.
+ ***********************************************************/
+void CaptureRenderDevice::CaptureBytes(const void* bytes, size_t size)
+{
+	if (size > 0)
+	{
+		const char* first = (const char*)bytes;
+		m_captureData.insert(m_captureData.end(), first, first + size);
+	}
+}
+
+/***********************************************************
+ *  FlushCapture()
+ *
+ *  This method is used for writing the records made so far
+ *  to the capture file.
+ ***********************************************************/
+void CaptureRenderDevice::FlushCapture()
+{
+	if (!m_captureData.empty())
+	{
+		m_captureFile.write(m_captureData.data(), m_captureData.size());
+		m_captureBytes += m_captureData.size();
+		m_captureData.clear();
+	}
+}
@@ -0,0 +1,218 @@
+///////////////////////////////////////////////////////////////////////////////
+// capturerenderdevice.h
+// ============
+// record the render device calls of a range of frames into a capture file
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  CaptureRenderDevice
+ *
+ *  This class is a render device placed in front of another
+ *  one, passing every call on to it and writing the calls of
+ *  a range of frames into a capture file, with everything
+ *  needed to run them again without the scene code - the
+ *  shader sources, and the contents of the buffers and
+ *  textures.  CommandReplay plays a capture back.
+ *
+ *  A range can start after the scene is loaded, so until it
+ *  starts a copy of every buffer and texture is kept.  When
+ *  the first frame of the range starts, the objects that
+ *  exist are written as they are at that point, followed by
+ *  the calls of the frames as they are made:
+ *
+ *  - a CAPTURE_HEADER, the CAPTURE_SHADER records, then the
+ *    CAPTURE_CREATE_* records of the objects that exist
+ *  - CAPTURE_BEGIN_FRAMES, then the calls of each frame up
+ *    to its CAPTURE_END_FRAME, which has the milliseconds the
+ *    frame took when it was captured
+ *  - every record starts with a byte for its type, followed
+ *    by 32 bit values and the bytes uploaded, if any
+ *  - a RenderCommandList::COMMAND_TYPE is followed by the
+ *    values the command uses, like in the traces of
+ *    NullRenderDevice, and CAPTURE_SUBMIT with the command
+ *    count submits the commands before it - uniforms and
+ *    timers refer to their name by its index, which a
+ *    CAPTURE_NAME record defined before it
+ *  - the handles are the ones of the captured device
+ *
+ *  Frames are counted by EndFrame(), so frame 0 includes the
+ *  loading of the scene.
+ ***********************************************************/
+class CaptureRenderDevice : public RenderDevice
+{
+public:
+	// constructor - the calls are passed on to the device,
+	// which is deleted with it
+	CaptureRenderDevice(RenderDevice* pDevice);
+	// destructor
+	virtual ~CaptureRenderDevice();
+
+	enum CAPTURE_RECORD
+	{
+		CAPTURE_SHADER = 0x80,
+		CAPTURE_NAME,
+		CAPTURE_CREATE_BUFFER,
+		CAPTURE_UPDATE_BUFFER,
+		CAPTURE_COPY_BUFFER,
+		CAPTURE_CREATE_TEXTURE,
+		CAPTURE_CREATE_RENDER_TARGET,
+		CAPTURE_CREATE_PIPELINE,
+		CAPTURE_DESTROY,
+		CAPTURE_SUBMIT,
+		CAPTURE_BEGIN_FRAMES,
+		CAPTURE_END_FRAME
+	};
+
+	enum OBJECT_TYPE
+	{
+		OBJECT_BUFFER = 0,
+		OBJECT_TEXTURE,
+		OBJECT_RENDER_TARGET,
+		OBJECT_PIPELINE,
+		OBJECT_TYPE_COUNT
+	};
+
+	enum SHADER_STAGE
+	{
+		SHADER_VERTEX = 0,
+		SHADER_FRAGMENT
+	};
+
+	// flags of the create records
+	enum CREATE_FLAGS
+	{
+		FLAG_DATA = 0x01,
+		FLAG_DYNAMIC = 0x02,
+		FLAG_GENERATE_MIPMAPS = 0x04,
+		FLAG_MIPMAP_FILTERING = 0x08,
+		FLAG_REPEAT = 0x10,
+		FLAG_DEPTH_TEST = 0x20,
+		FLAG_DEPTH_WRITE = 0x40,
+		FLAG_POLYGON_OFFSET = 0x80
+	};
+
+	// start of a capture file - the frame count is written
+	// when the capture is finished
+	struct CAPTURE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		int32_t windowWidth;
+		int32_t windowHeight;
+		uint32_t uniformBufferAlignment;
+		uint32_t frameCount;
+	};
+
+	static const char CAPTURE_MAGIC[4];
+	static const uint32_t CAPTURE_VERSION = 1;
+
+	// read the GLSL files the shader program was built from,
+	// which the replay compiles
+	bool SetShaderSources(const char* vertexFilename, const char* fragmentFilename);
+	// capture the frames from the first one on into a file
+	bool StartCapture(int firstFrame, int frameCount, const char* filename);
+	// finish the capture file early, if one is written
+	void StopCapture();
+	bool IsCapturing() const { return(m_captureFile.is_open()); }
+
+	// bytes of image data a texture level is uploaded from
+	static size_t GetImageSize(const TEXTURE_DESC& desc, int level);
+
+	virtual RENDER_BUFFER CreateBuffer(const BUFFER_DESC& desc, const void* data);
+	virtual void UpdateBuffer(RENDER_BUFFER buffer, size_t offset, size_t size, const void* data);
+	virtual void CopyBuffer(RENDER_BUFFER source, RENDER_BUFFER destination, size_t size);
+	virtual void DestroyBuffer(RENDER_BUFFER buffer);
+	virtual size_t GetUniformBufferAlignment() const;
+
+	virtual RENDER_TEXTURE CreateTexture(const TEXTURE_DESC& desc, const void* const* data);
+	virtual void DestroyTexture(RENDER_TEXTURE texture);
+
+	virtual RENDER_TARGET CreateRenderTarget(int width, int height);
+	virtual bool ReadPixels(RENDER_TARGET target, int width, int height, void* pixels);
+	virtual void DestroyRenderTarget(RENDER_TARGET target);
+	virtual void GetWindowSize(int& width, int& height) const;
+
+	virtual RENDER_PIPELINE CreatePipeline(const PIPELINE_DESC& desc);
+	virtual void DestroyPipeline(RENDER_PIPELINE pipeline);
+
+	virtual void Submit(const RenderCommandList& commands);
+	virtual void EndFrame();
+
+private:
+	// copies of the objects kept until the capture starts
+	struct BUFFER_COPY
+	{
+		BUFFER_DESC desc;
+		std::vector<char> data;
+	};
+	struct TEXTURE_COPY
+	{
+		TEXTURE_DESC desc;
+		bool bHasData;
+		// the images of each face and level, like the data of
+		// CreateTexture(), empty for levels passed as NULL
+		std::vector<std::vector<char> > images;
+	};
+	struct PIPELINE_COPY
+	{
+		PIPELINE_DESC desc;
+		std::string uniformBlockName;
+	};
+
+	RenderDevice* m_pDevice;
+	std::string m_shaderSources[2];
+
+	// frames ended so far, and the range to capture
+	int m_frameIndex;
+	int m_firstFrame;
+	int m_lastFrame;
+	// the copies are only kept until the capture starts
+	bool m_bKeepCopies;
+	std::map<RENDER_BUFFER, BUFFER_COPY> m_buffers;
+	std::map<RENDER_TEXTURE, TEXTURE_COPY> m_textures;
+	std::map<RENDER_TARGET, std::pair<int, int> > m_renderTargets;
+	std::map<RENDER_PIPELINE, PIPELINE_COPY> m_pipelines;
+
+	// capture file, with the records not written yet and the
+	// indices of the uniform names written so far
+	std::string m_captureFilename;
+	std::ofstream m_captureFile;
+	std::vector<char> m_captureData;
+	std::unordered_map<std::string, uint32_t> m_captureNames;
+	// time the current frame started, in nanoseconds
+	int64_t m_frameStartTime;
+	uint64_t m_captureBytes;
+
+	// open the capture file and write the objects that exist
+	bool BeginCapture();
+	// write the frame count and close the capture file
+	void FinishCapture();
+
+	// append the records of the objects to the capture
+	void CaptureBuffer(RENDER_BUFFER buffer, const BUFFER_DESC& desc, const void* data);
+	void CaptureTexture(RENDER_TEXTURE texture, const TEXTURE_DESC& desc, const void* const* data);
+	void CaptureRenderTarget(RENDER_TARGET target, int width, int height);
+	void CapturePipeline(RENDER_PIPELINE pipeline, const PIPELINE_DESC& desc);
+	void CaptureDestroy(uint32_t objectType, uint32_t handle);
+	// append a command of a submitted list to the capture
+	void CaptureCommand(const RenderCommandList& commands, const RenderCommandList::COMMAND& command);
+	// get the index of a uniform name, defining new ones
+	uint32_t CaptureName(const char* name);
+	// append to the records
+	void CaptureByte(uint8_t value);
+	void CaptureValues(const void* values, size_t count);
+	void CaptureBytes(const void* bytes, size_t size);
+	// write the records made so far to the capture file
+	void FlushCapture();
+};
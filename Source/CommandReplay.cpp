@@ -0,0 +1,730 @@
+///////////////////////////////////////////////////////////////////////////////
+// commandreplay.cpp
+// ============
+// play the frames of a capture file back on a render device, with timing
+///////////////////////////////////////////////////////////////////////////////
+
+#include "CommandReplay.h"
+#include "TimerStatistics.h"
+
+#include <glm/glm.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// names of the timings of the report
+	const char* const g_CapturedName = "captured frame";
+	const char* const g_CPUName = "replayed cpu";
+	const char* const g_FrameName = "replayed frame";
+	const char* const g_GPUName = "Replay";
+
+	// number of float values of the uniform commands
+	uint32_t GetUniformFloatCount(uint32_t commandType)
+	{
+		switch (commandType)
+		{
+		case RenderCommandList::COMMAND_SET_FLOAT:
+			return(1);
+		case RenderCommandList::COMMAND_SET_VEC2:
+			return(2);
+		case RenderCommandList::COMMAND_SET_VEC3:
+			return(3);
+		case RenderCommandList::COMMAND_SET_VEC4:
+			return(4);
+		case RenderCommandList::COMMAND_SET_MAT4:
+			return(16);
+		}
+		return(0);
+	}
+
+	// compile a shader from its source
+	GLuint CompileShader(GLenum shaderType, const std::string& source)
+	{
+		const GLchar* text = source.c_str();
+		GLuint shaderID = glCreateShader(shaderType);
+		glShaderSource(shaderID, 1, &text, NULL);
+		glCompileShader(shaderID);
+
+		GLint success = 0;
+		glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+		if (!success)
+		{
+			char infoLog[512];
+			glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
+			std::cout << "ERROR::SHADER::REPLAY_COMPILATION_FAILED\n" << infoLog << std::endl;
+			glDeleteShader(shaderID);
+			return(0);
+		}
+		return(shaderID);
+	}
+}
+
+/***********************************************************
+ *  CommandReplay()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+CommandReplay::CommandReplay()
+{
+	memset(&m_header, 0, sizeof(m_header));
+	m_objectsOffset = 0;
+	m_position = 0;
+	m_bFailed = false;
+}
+
+/***********************************************************
+ *  ~CommandReplay()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+CommandReplay::~CommandReplay()
+{
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for reading a capture file and its
+ *  shader sources.  The whole file is kept in memory, so the
+ *  frames are not slowed down by reading it.
+ ***********************************************************/
+bool CommandReplay::Load(const char* filename)
+{
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		std::cout << "Could not open the capture file " << filename << std::endl;
+		return(false);
+	}
+	m_data.resize((size_t)file.tellg());
+	file.seekg(0);
+	file.read(m_data.data(), m_data.size());
+
+	m_position = 0;
+	m_bFailed = false;
+	if (!Read(&m_header, sizeof(m_header)) ||
+		(memcmp(m_header.magic, CaptureRenderDevice::CAPTURE_MAGIC, sizeof(m_header.magic)) != 0) ||
+		(m_header.version != CaptureRenderDevice::CAPTURE_VERSION))
+	{
+		std::cout << "Not a capture file of this version: " << filename << std::endl;
+		return(false);
+	}
+	if (m_header.frameCount == 0)
+	{
+		std::cout << "The capture file " << filename << " has no frames" << std::endl;
+		return(false);
+	}
+
+	for (int stage = CaptureRenderDevice::SHADER_VERTEX; stage <= CaptureRenderDevice::SHADER_FRAGMENT; stage++)
+	{
+		uint8_t record = 0;
+		Read(&record, 1);
+		uint32_t shaderStage = ReadValue();
+		uint32_t length = ReadValue();
+		const char* source = Skip(length);
+		if (m_bFailed || (record != CaptureRenderDevice::CAPTURE_SHADER) || (shaderStage != (uint32_t)stage))
+		{
+			std::cout << "The capture file " << filename << " has no shader sources" << std::endl;
+			return(false);
+		}
+		m_shaderSources[stage].assign(source, length);
+	}
+	m_objectsOffset = m_position;
+
+	std::cout << "INFO: Loaded capture " << filename << ": " << m_header.frameCount << " frames at "
+		<< m_header.windowWidth << "x" << m_header.windowHeight << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  CreateProgram()
+ *
+ *  This method is used for compiling and linking the shader
+ *  sources of the capture.
+ ***********************************************************/
+GLuint CommandReplay::CreateProgram() const
+{
+	GLuint vertexShader = CompileShader(GL_VERTEX_SHADER, m_shaderSources[CaptureRenderDevice::SHADER_VERTEX]);
+	GLuint fragmentShader = CompileShader(GL_FRAGMENT_SHADER, m_shaderSources[CaptureRenderDevice::SHADER_FRAGMENT]);
+	if ((vertexShader == 0) || (fragmentShader == 0))
+	{
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	glAttachShader(programID, vertexShader);
+	glAttachShader(programID, fragmentShader);
+	glLinkProgram(programID);
+
+	// the shader objects are no longer needed once linked
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	GLint success = 0;
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		char infoLog[512];
+		glGetProgramInfoLog(programID, 512, NULL, infoLog);
+		std::cout << "ERROR::PROGRAM::REPLAY_LINKING_FAILED\n" << infoLog << std::endl;
+		glDeleteProgram(programID);
+		return(0);
+	}
+	glUseProgram(programID);
+	return(programID);
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for playing the captured frames in
+ *  the window.  The CPU time of a frame is the time to play
+ *  its records, the frame time also includes the swap, and
+ *  the GPU time comes from a timer around the whole frame,
+ *  with the timers of the capture timed as well.  Vertical
+ *  sync is turned off, so the swap does not wait for the
+ *  display.  The renderer is printed with the times, to tell
+ *  the runs on different drivers apart.
+ ***********************************************************/
+bool CommandReplay::Run(GLFWwindow* pWindow, GLRenderDevice* pDevice, int loopCount)
+{
+	if (m_data.empty() || (loopCount <= 0))
+	{
+		return(false);
+	}
+
+	int width = 0;
+	int height = 0;
+	pDevice->GetWindowSize(width, height);
+	if ((width != m_header.windowWidth) || (height != m_header.windowHeight))
+	{
+		std::cout << "WARNING: Replaying at " << width << "x" << height << ", the capture was made at "
+			<< m_header.windowWidth << "x" << m_header.windowHeight << std::endl;
+	}
+	// the captured uniform buffer ranges are aligned for the
+	// captured device only
+	size_t alignment = pDevice->GetUniformBufferAlignment();
+	if ((alignment > 0) && ((m_header.uniformBufferAlignment % alignment) != 0))
+	{
+		std::cout << "WARNING: The uniform buffer alignment of " << m_header.uniformBufferAlignment
+			<< " of the capture does not suit this device, which needs " << alignment << std::endl;
+	}
+
+	size_t frameCount = (size_t)m_header.frameCount;
+	int warmupLoops = (loopCount > 1) ? 1 : 0;
+	size_t sampleCount = frameCount * (size_t)(loopCount - warmupLoops);
+	TimerStatistics cpuStatistics(sampleCount);
+	glfwSwapInterval(0);
+	pDevice->EnableTimers(true, sampleCount);
+
+	RenderCommandList frameCommands;
+	bool bPlayed = true;
+	for (int loop = 0; bPlayed && (loop < loopCount) && !glfwWindowShouldClose(pWindow); loop++)
+	{
+		if ((loop == warmupLoops) && (warmupLoops > 0))
+		{
+			// drop what the warm up loop measured
+			pDevice->FlushTimers();
+			pDevice->EnableTimers(true, sampleCount);
+		}
+
+		// create the objects the frames start with
+		m_position = m_objectsOffset;
+		m_bFailed = false;
+		m_names.clear();
+		m_commands.Reset();
+		bPlayed = (PlayRecords(pDevice, CaptureRenderDevice::CAPTURE_BEGIN_FRAMES) == CaptureRenderDevice::CAPTURE_BEGIN_FRAMES);
+
+		for (size_t frame = 0; bPlayed && (frame < frameCount); frame++)
+		{
+			std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			frameCommands.Reset();
+			frameCommands.BeginTimer(g_GPUName);
+			pDevice->Submit(frameCommands);
+
+			bPlayed = (PlayRecords(pDevice, CaptureRenderDevice::CAPTURE_END_FRAME) == CaptureRenderDevice::CAPTURE_END_FRAME);
+			float capturedTime = 0.0f;
+			Read(&capturedTime, sizeof(capturedTime));
+
+			frameCommands.Reset();
+			frameCommands.EndTimer();
+			pDevice->Submit(frameCommands);
+			std::chrono::duration<double, std::milli> cpuTime = std::chrono::steady_clock::now() - start;
+
+			glfwSwapBuffers(pWindow);
+			pDevice->EndFrame();
+			glfwPollEvents();
+			std::chrono::duration<double, std::milli> frameTime = std::chrono::steady_clock::now() - start;
+
+			if (bPlayed && (loop >= warmupLoops))
+			{
+				cpuStatistics.AddSample(g_CapturedName, capturedTime);
+				cpuStatistics.AddSample(g_CPUName, cpuTime.count());
+				cpuStatistics.AddSample(g_FrameName, frameTime.count());
+			}
+		}
+
+		DestroyObjects(pDevice);
+	}
+	pDevice->FlushTimers();
+
+	if (!bPlayed)
+	{
+		std::cout << "The capture is broken at byte " << m_position << std::endl;
+		return(false);
+	}
+
+	std::cout << "INFO: Replayed " << frameCount << " frames " << loopCount - warmupLoops << " times on "
+		<< glGetString(GL_RENDERER) << " (" << glGetString(GL_VENDOR) << ", " << glGetString(GL_VERSION) << ")" << std::endl;
+	cpuStatistics.Print("Replay CPU times");
+	pDevice->GetTimerStatistics().Print("Replay GPU timers");
+	return(true);
+}
+
+/***********************************************************
+ *  PlayRecords()
+ *
+ *  This method is used for playing the records from the read
+ *  position on, up to one of the type that ends the part
+ *  being played - the objects before the frames or a frame.
+ ***********************************************************/
+uint8_t CommandReplay::PlayRecords(RenderDevice* pDevice, uint8_t lastRecord)
+{
+	uint8_t record = 0;
+	while (!m_bFailed && Read(&record, 1))
+	{
+		if (record < RenderCommandList::COMMAND_TYPE_COUNT)
+		{
+			PlayCommand(record);
+			continue;
+		}
+
+		switch (record)
+		{
+		case CaptureRenderDevice::CAPTURE_NAME:
+		{
+			uint16_t length = 0;
+			Read(&length, sizeof(length));
+			const char* name = Skip(length);
+			if (!m_bFailed)
+			{
+				m_names.push_back(std::string(name, length));
+			}
+			break;
+		}
+		case CaptureRenderDevice::CAPTURE_CREATE_BUFFER:
+			PlayCreateBuffer(pDevice);
+			break;
+		case CaptureRenderDevice::CAPTURE_UPDATE_BUFFER:
+		{
+			uint32_t buffer = GetHandle(CaptureRenderDevice::OBJECT_BUFFER, ReadValue());
+			uint32_t offset = ReadValue();
+			uint32_t size = ReadValue();
+			const char* data = Skip(size);
+			if (!m_bFailed && (buffer != 0))
+			{
+				pDevice->UpdateBuffer(buffer, offset, size, data);
+			}
+			break;
+		}
+		case CaptureRenderDevice::CAPTURE_COPY_BUFFER:
+		{
+			uint32_t source = GetHandle(CaptureRenderDevice::OBJECT_BUFFER, ReadValue());
+			uint32_t destination = GetHandle(CaptureRenderDevice::OBJECT_BUFFER, ReadValue());
+			uint32_t size = ReadValue();
+			if (!m_bFailed && (source != 0) && (destination != 0))
+			{
+				pDevice->CopyBuffer(source, destination, size);
+			}
+			break;
+		}
+		case CaptureRenderDevice::CAPTURE_CREATE_TEXTURE:
+			PlayCreateTexture(pDevice);
+			break;
+		case CaptureRenderDevice::CAPTURE_CREATE_RENDER_TARGET:
+		{
+			uint32_t handle = ReadValue();
+			int width = (int)ReadValue();
+			int height = (int)ReadValue();
+			if (!m_bFailed)
+			{
+				m_handles[CaptureRenderDevice::OBJECT_RENDER_TARGET][handle] = pDevice->CreateRenderTarget(width, height);
+			}
+			break;
+		}
+		case CaptureRenderDevice::CAPTURE_CREATE_PIPELINE:
+			PlayCreatePipeline(pDevice);
+			break;
+		case CaptureRenderDevice::CAPTURE_DESTROY:
+			PlayDestroy(pDevice);
+			break;
+		case CaptureRenderDevice::CAPTURE_SUBMIT:
+			if ((ReadValue() == m_commands.GetCommandCount()) && !m_bFailed)
+			{
+				pDevice->Submit(m_commands);
+			}
+			else
+			{
+				m_bFailed = true;
+			}
+			m_commands.Reset();
+			break;
+		case CaptureRenderDevice::CAPTURE_BEGIN_FRAMES:
+		case CaptureRenderDevice::CAPTURE_END_FRAME:
+			if (record == lastRecord)
+			{
+				return(record);
+			}
+			m_bFailed = true;
+			break;
+		default:
+			m_bFailed = true;
+			break;
+		}
+	}
+	return(0);
+}
+
+/***********************************************************
+ *  PlayCreateBuffer()
+ *
+ *  This method is used for creating a captured buffer, with
+ *  its contents if it had any.
+ ***********************************************************/
+void CommandReplay::PlayCreateBuffer(RenderDevice* pDevice)
+{
+	uint32_t handle = ReadValue();
+	RenderDevice::BUFFER_DESC desc;
+	desc.type = ReadValue();
+	desc.size = ReadValue();
+	uint32_t flags = ReadValue();
+	desc.bDynamic = ((flags & CaptureRenderDevice::FLAG_DYNAMIC) != 0);
+	const char* data = ((flags & CaptureRenderDevice::FLAG_DATA) != 0) ? Skip(desc.size) : NULL;
+	if (!m_bFailed)
+	{
+		m_handles[CaptureRenderDevice::OBJECT_BUFFER][handle] = pDevice->CreateBuffer(desc, data);
+	}
+}
+
+/***********************************************************
+ *  PlayCreateTexture()
+ *
+ *  This method is used for creating a captured texture from
+ *  the images that follow its description.
+ ***********************************************************/
+void CommandReplay::PlayCreateTexture(RenderDevice* pDevice)
+{
+	uint32_t handle = ReadValue();
+	RenderDevice::TEXTURE_DESC desc;
+	desc.type = ReadValue();
+	desc.format = ReadValue();
+	desc.width = (int)ReadValue();
+	desc.height = (int)ReadValue();
+	desc.mipLevels = (int)ReadValue();
+	uint32_t flags = ReadValue();
+	desc.bGenerateMipmaps = ((flags & CaptureRenderDevice::FLAG_GENERATE_MIPMAPS) != 0);
+	desc.bMipmapFiltering = ((flags & CaptureRenderDevice::FLAG_MIPMAP_FILTERING) != 0);
+	desc.bRepeat = ((flags & CaptureRenderDevice::FLAG_REPEAT) != 0);
+
+	std::vector<const void*> images;
+	if ((flags & CaptureRenderDevice::FLAG_DATA) != 0)
+	{
+		int faceCount = (desc.type == RenderDevice::TEXTURE_CUBE) ? 6 : 1;
+		int levelCount = (desc.mipLevels > 0) ? desc.mipLevels : 1;
+		for (int i = 0; (i < faceCount * levelCount) && !m_bFailed; i++)
+		{
+			uint32_t size = ReadValue();
+			const char* image = Skip(size);
+			images.push_back((size > 0) ? image : NULL);
+		}
+	}
+	if (!m_bFailed)
+	{
+		m_handles[CaptureRenderDevice::OBJECT_TEXTURE][handle] =
+			pDevice->CreateTexture(desc, images.empty() ? NULL : images.data());
+	}
+}
+
+/***********************************************************
+ *  PlayCreatePipeline()
+ *
+ *  This method is used for creating a captured pipeline.
+ ***********************************************************/
+void CommandReplay::PlayCreatePipeline(RenderDevice* pDevice)
+{
+	uint32_t handle = ReadValue();
+	RenderDevice::PIPELINE_DESC desc;
+	desc.blendMode = ReadValue();
+	uint32_t flags = ReadValue();
+	desc.bDepthTest = ((flags & CaptureRenderDevice::FLAG_DEPTH_TEST) != 0);
+	desc.bDepthWrite = ((flags & CaptureRenderDevice::FLAG_DEPTH_WRITE) != 0);
+	desc.bPolygonOffset = ((flags & CaptureRenderDevice::FLAG_POLYGON_OFFSET) != 0);
+	desc.uniformBlockBinding = ReadValue();
+	uint32_t nameLength = ReadValue();
+	const char* name = Skip(nameLength);
+	std::string uniformBlockName = m_bFailed ? std::string() : std::string(name, nameLength);
+	desc.uniformBlockName = (nameLength > 0) ? uniformBlockName.c_str() : NULL;
+	if (!m_bFailed)
+	{
+		m_handles[CaptureRenderDevice::OBJECT_PIPELINE][handle] = pDevice->CreatePipeline(desc);
+	}
+}
+
+/***********************************************************
+ *  PlayDestroy()
+ *
+ *  This method is used for freeing a captured object.
+ ***********************************************************/
+void CommandReplay::PlayDestroy(RenderDevice* pDevice)
+{
+	uint8_t objectType = CaptureRenderDevice::OBJECT_TYPE_COUNT;
+	Read(&objectType, 1);
+	uint32_t handle = ReadValue();
+	if (m_bFailed || (objectType >= CaptureRenderDevice::OBJECT_TYPE_COUNT))
+	{
+		m_bFailed = true;
+		return;
+	}
+
+	std::unordered_map<uint32_t, uint32_t>::iterator it = m_handles[objectType].find(handle);
+	if (it == m_handles[objectType].end())
+	{
+		return;
+	}
+	switch (objectType)
+	{
+	case CaptureRenderDevice::OBJECT_BUFFER:
+		pDevice->DestroyBuffer(it->second);
+		break;
+	case CaptureRenderDevice::OBJECT_TEXTURE:
+		pDevice->DestroyTexture(it->second);
+		break;
+	case CaptureRenderDevice::OBJECT_RENDER_TARGET:
+		pDevice->DestroyRenderTarget(it->second);
+		break;
+	case CaptureRenderDevice::OBJECT_PIPELINE:
+		pDevice->DestroyPipeline(it->second);
+		break;
+	}
+	m_handles[objectType].erase(it);
+}
+
+/***********************************************************
+ *  PlayCommand()
+ *
+ *  This method is used for reading a captured command and
+ *  recording it into the list that the next CAPTURE_SUBMIT
+ *  submits, with the handles of the replayed objects.
+ ***********************************************************/
+void CommandReplay::PlayCommand(uint8_t commandType)
+{
+	switch (commandType)
+	{
+	case RenderCommandList::COMMAND_SET_RENDER_TARGET:
+	{
+		uint32_t target = GetHandle(CaptureRenderDevice::OBJECT_RENDER_TARGET, ReadValue());
+		int width = (int)ReadValue();
+		int height = (int)ReadValue();
+		m_commands.SetRenderTarget(target, width, height);
+		break;
+	}
+	case RenderCommandList::COMMAND_CLEAR:
+	{
+		float color[4] = { 0.0f };
+		Read(color, sizeof(color));
+		m_commands.Clear(glm::vec4(color[0], color[1], color[2], color[3]));
+		break;
+	}
+	case RenderCommandList::COMMAND_SET_PIPELINE:
+		m_commands.SetPipeline(GetHandle(CaptureRenderDevice::OBJECT_PIPELINE, ReadValue()));
+		break;
+	case RenderCommandList::COMMAND_BIND_TEXTURE:
+	{
+		int slot = (int)ReadValue();
+		m_commands.BindTexture(slot, GetHandle(CaptureRenderDevice::OBJECT_TEXTURE, ReadValue()));
+		break;
+	}
+	case RenderCommandList::COMMAND_BIND_UNIFORM_BUFFER:
+	{
+		uint32_t binding = ReadValue();
+		uint32_t buffer = GetHandle(CaptureRenderDevice::OBJECT_BUFFER, ReadValue());
+		uint32_t offset = ReadValue();
+		uint32_t size = ReadValue();
+		m_commands.BindUniformBuffer(binding, buffer, offset, size);
+		break;
+	}
+	case RenderCommandList::COMMAND_SET_INT:
+	{
+		const char* name = GetName(ReadValue());
+		m_commands.SetInt(name, (int)ReadValue());
+		break;
+	}
+	case RenderCommandList::COMMAND_SET_FLOAT:
+	case RenderCommandList::COMMAND_SET_VEC2:
+	case RenderCommandList::COMMAND_SET_VEC3:
+	case RenderCommandList::COMMAND_SET_VEC4:
+	case RenderCommandList::COMMAND_SET_MAT4:
+	{
+		const char* name = GetName(ReadValue());
+		float values[16] = { 0.0f };
+		Read(values, sizeof(float) * GetUniformFloatCount(commandType));
+		if (commandType == RenderCommandList::COMMAND_SET_FLOAT)
+		{
+			m_commands.SetFloat(name, values[0]);
+		}
+		else if (commandType == RenderCommandList::COMMAND_SET_VEC2)
+		{
+			m_commands.SetVec2(name, glm::vec2(values[0], values[1]));
+		}
+		else if (commandType == RenderCommandList::COMMAND_SET_VEC3)
+		{
+			m_commands.SetVec3(name, glm::vec3(values[0], values[1], values[2]));
+		}
+		else if (commandType == RenderCommandList::COMMAND_SET_VEC4)
+		{
+			m_commands.SetVec4(name, glm::vec4(values[0], values[1], values[2], values[3]));
+		}
+		else
+		{
+			m_commands.SetMat4(name, glm::make_mat4(values));
+		}
+		break;
+	}
+	case RenderCommandList::COMMAND_DRAW_SHAPE:
+	{
+		uint32_t meshType = ReadValue();
+		m_commands.DrawShape(meshType, ReadValue());
+		break;
+	}
+	case RenderCommandList::COMMAND_DRAW:
+	{
+		uint32_t buffer = GetHandle(CaptureRenderDevice::OBJECT_BUFFER, ReadValue());
+		uint32_t firstVertex = ReadValue();
+		m_commands.Draw(buffer, firstVertex, ReadValue());
+		break;
+	}
+	case RenderCommandList::COMMAND_BEGIN_TIMER:
+		m_commands.BeginTimer(GetName(ReadValue()));
+		break;
+	case RenderCommandList::COMMAND_END_TIMER:
+		m_commands.EndTimer();
+		break;
+	}
+}
+
+/***********************************************************
+ *  DestroyObjects()
+ *
+ *  This method is used for freeing the objects the replay
+ *  created that the capture did not free.
+ ***********************************************************/
+void CommandReplay::DestroyObjects(RenderDevice* pDevice)
+{
+	std::unordered_map<uint32_t, uint32_t>::iterator it;
+	for (it = m_handles[CaptureRenderDevice::OBJECT_BUFFER].begin(); it != m_handles[CaptureRenderDevice::OBJECT_BUFFER].end(); ++it)
+	{
+		pDevice->DestroyBuffer(it->second);
+	}
+	for (it = m_handles[CaptureRenderDevice::OBJECT_TEXTURE].begin(); it != m_handles[CaptureRenderDevice::OBJECT_TEXTURE].end(); ++it)
+	{
+		pDevice->DestroyTexture(it->second);
+	}
+	for (it = m_handles[CaptureRenderDevice::OBJECT_RENDER_TARGET].begin(); it != m_handles[CaptureRenderDevice::OBJECT_RENDER_TARGET].end(); ++it)
+	{
+		pDevice->DestroyRenderTarget(it->second);
+	}
+	for (it = m_handles[CaptureRenderDevice::OBJECT_PIPELINE].begin(); it != m_handles[CaptureRenderDevice::OBJECT_PIPELINE].end(); ++it)
+	{
+		pDevice->DestroyPipeline(it->second);
+	}
+	for (int objectType = 0; objectType < CaptureRenderDevice::OBJECT_TYPE_COUNT; objectType++)
+	{
+		m_handles[objectType].clear();
+	}
+}
+
+/***********************************************************
+ *  GetHandle()
+ *
+ *  This method is used for getting the handle the replay
+ *  created an object with, from the handle it was captured
+ *  with.  Handle 0, the window or no object, stays 0.
+ ***********************************************************/
+uint32_t CommandReplay::GetHandle(uint32_t objectType, uint32_t handle) const
+{
+	std::unordered_map<uint32_t, uint32_t>::const_iterator it = m_handles[objectType].find(handle);
+	return((it != m_handles[objectType].end()) ? it->second : 0);
+}
+
+/***********************************************************
+ *  GetName()
+ *
+ *  This method is used for getting a uniform or timer name
+ *  that was defined earlier in the capture.
+ ***********************************************************/
+const char* CommandReplay::GetName(uint32_t nameIndex)
+{
+	if (nameIndex >= m_names.size())
+	{
+		m_bFailed = true;
+		return("");
+	}
+	return(m_names[nameIndex].c_str());
+}
+
+/***********************************************************
+ *  Read()
+ *
+ *  This method is used for copying bytes from the read
+ *  position.  Reading past the end marks the capture as
+ *  broken, and everything read from then on is zero.
+ ***********************************************************/
+bool CommandReplay::Read(void* values, size_t size)
+{
+	const char* data = Skip(size);
+	if (m_bFailed)
+	{
+		memset(values, 0, size);
+		return(false);
+	}
+	memcpy(values, data, size);
+	return(true);
+}
+
+/***********************************************************
+ *  ReadValue()
+ *
+ *  This method is used for reading a 32 bit value.
+ ***********************************************************/
+uint32_t CommandReplay::ReadValue()
+{
+	uint32_t value = 0;
+	Read(&value, sizeof(value));
+	return(value);
+}
+
+/***********************************************************
+ *  Skip()
+ *
+ *  This method is used for getting the bytes at the read
+ *  position without copying them, and moving past them.
+ ***********************************************************/
+const char* CommandReplay::Skip(size_t size)
+{
+	if (m_bFailed || (size > m_data.size() - m_position))
+	{
+		m_bFailed = true;
+		return(NULL);
+	}
+	const char* data = m_data.data() + m_position;
+	m_position += size;
+	return(data);
+}
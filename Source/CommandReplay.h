@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// commandreplay.h
+// ============
+// play the frames of a capture file back on a render device, with timing
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "CaptureRenderDevice.h"
+#include "GLRenderDevice.h"
+
+#include "GLFW/glfw3.h"
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  CommandReplay
+ *
+ *  This class plays back a file written by
+ *  CaptureRenderDevice, without any of the scene code, so
+ *  the same frames can be timed on other drivers and
+ *  hardware.  Each loop creates the captured objects, runs
+ *  the captured frames one after the other, timed, and frees
+ *  the objects again, so every loop starts from the same
+ *  state.  The first loop warms up the driver and is not
+ *  counted when there is more than one.
+ ***********************************************************/
+class CommandReplay
+{
+public:
+	// constructor
+	CommandReplay();
+	// destructor
+	~CommandReplay();
+
+	// read a capture file into memory
+	bool Load(const char* filename);
+
+	int GetWindowWidth() const { return(m_header.windowWidth); }
+	int GetWindowHeight() const { return(m_header.windowHeight); }
+	int GetFrameCount() const { return((int)m_header.frameCount); }
+
+	// compile the captured shader sources into a program
+	GLuint CreateProgram() const;
+	// play the captured frames a number of times, and print
+	// the times they took then and now
+	bool Run(GLFWwindow* pWindow, GLRenderDevice* pDevice, int loopCount);
+
+private:
+	std::vector<char> m_data;
+	CaptureRenderDevice::CAPTURE_HEADER m_header;
+	std::string m_shaderSources[2];
+	// offset of the first object after the shader sources
+	size_t m_objectsOffset;
+
+	// read position in the data, and if a record was broken
+	size_t m_position;
+	bool m_bFailed;
+	// handles of the replayed objects for the captured ones,
+	// for each CaptureRenderDevice::OBJECT_TYPE
+	std::unordered_map<uint32_t, uint32_t> m_handles[CaptureRenderDevice::OBJECT_TYPE_COUNT];
+	std::vector<std::string> m_names;
+	RenderCommandList m_commands;
+
+	// play the records up to one of a type, which is returned,
+	// or 0 at the end of the data or a broken record
+	uint8_t PlayRecords(RenderDevice* pDevice, uint8_t lastRecord);
+	// play the records of an object being created or freed
+	void PlayCreateBuffer(RenderDevice* pDevice);
+	void PlayCreateTexture(RenderDevice* pDevice);
+	void PlayCreatePipeline(RenderDevice* pDevice);
+	void PlayDestroy(RenderDevice* pDevice);
+	// add a captured command to the list being recorded
+	void PlayCommand(uint8_t commandType);
+	// free the objects the replay created
+	void DestroyObjects(RenderDevice* pDevice);
+
+	// get the replayed handle of a captured one, 0 for none
+	uint32_t GetHandle(uint32_t objectType, uint32_t handle) const;
+	// get a captured uniform or timer name by its index
+	const char* GetName(uint32_t nameIndex);
+	// read from the data, failing past its end
+	bool Read(void* values, size_t size);
+	uint32_t ReadValue();
+	// get the data at the read position and skip over it
+	const char* Skip(size_t size);
+};
@@ -0,0 +1,799 @@
+///////////////////////////////////////////////////////////////////////////////
+// environmentmap.cpp
+// ============
+// prefilter an HDR environment panorama into cube maps for reflections
+///////////////////////////////////////////////////////////////////////////////
+
+#include "EnvironmentMap.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+#include "ParallelFor.h"
+
+#include "stb_image.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sys/stat.h>
+
+#if defined(_M_IX86) || defined(_M_X64) || defined(__SSE2__)
+#define ENVIRONMENT_MAP_USE_SSE
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	const char CACHE_MAGIC[4] = { 'E', 'N', 'V', 'C' };
+	const uint32_t CACHE_VERSION = 2;
+
+	// the panorama the cache was filtered from, and the sizes
+	// and sample count it was filtered with
+	struct CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		int64_t sourceSize;
+		int64_t sourceTime;
+		int32_t faceSize;
+		int32_t irradianceSize;
+		int32_t mipLevels;
+		int32_t sampleCount;
+	};
+
+	const float PI = 3.14159265358979f;
+	// the roughest reflection level is 8x8, smaller adds nothing
+	const int MAX_PREFILTER_LEVELS = 6;
+	// GGX samples taken for every prefiltered texel
+	const int PREFILTER_SAMPLE_COUNT = 128;
+
+	/***********************************************************
+	 *  FaceDirection()
+	 *
+	 *  Direction through texel coordinates sc, tc in [-1, 1] of
+	 *  a cube map face, following the OpenGL face layout.
+	 ***********************************************************/
+	glm::vec3 FaceDirection(int face, float sc, float tc)
+	{
+		switch (face)
+		{
+		case 0: return(glm::vec3(1.0f, -tc, -sc));
+		case 1: return(glm::vec3(-1.0f, -tc, sc));
+		case 2: return(glm::vec3(sc, 1.0f, tc));
+		case 3: return(glm::vec3(sc, -1.0f, -tc));
+		case 4: return(glm::vec3(sc, -tc, 1.0f));
+		default: return(glm::vec3(-sc, -tc, -1.0f));
+		}
+	}
+
+	/***********************************************************
+	 *  DirectionToFace()
+	 *
+	 *  Find the cube map face hit by a direction and the face
+	 *  coordinates s, t in [0, 1].
+	 ***********************************************************/
+	void DirectionToFace(const glm::vec3& direction, int& face, float& s, float& t)
+	{
+		float absX = std::fabs(direction.x);
+		float absY = std::fabs(direction.y);
+		float absZ = std::fabs(direction.z);
+		float major;
+		float sc;
+		float tc;
+
+		if ((absX >= absY) && (absX >= absZ))
+		{
+			major = absX;
+			face = (direction.x > 0.0f) ? 0 : 1;
+			sc = (direction.x > 0.0f) ? -direction.z : direction.z;
+			tc = -direction.y;
+		}
+		else if (absY >= absZ)
+		{
+			major = absY;
+			face = (direction.y > 0.0f) ? 2 : 3;
+			sc = direction.x;
+			tc = (direction.y > 0.0f) ? direction.z : -direction.z;
+		}
+		else
+		{
+			major = absZ;
+			face = (direction.z > 0.0f) ? 4 : 5;
+			sc = (direction.z > 0.0f) ? direction.x : -direction.x;
+			tc = -direction.y;
+		}
+
+		s = 0.5f * (sc / major + 1.0f);
+		t = 0.5f * (tc / major + 1.0f);
+	}
+
+	/***********************************************************
+	 *  SampleFace()
+	 *
+	 *  Bilinear lookup inside one face, clamped at its edges.
+	 ***********************************************************/
+	glm::vec3 SampleFace(const std::vector<float>& face, int size, float s, float t)
+	{
+		float x = std::min(std::max(s * size - 0.5f, 0.0f), (float)(size - 1));
+		float y = std::min(std::max(t * size - 0.5f, 0.0f), (float)(size - 1));
+		int x0 = (int)x;
+		int y0 = (int)y;
+		int x1 = std::min(x0 + 1, size - 1);
+		int y1 = std::min(y0 + 1, size - 1);
+		float fx = x - x0;
+		float fy = y - y0;
+
+		const float* p00 = &face[(y0 * size + x0) * 3];
+		const float* p10 = &face[(y0 * size + x1) * 3];
+		const float* p01 = &face[(y1 * size + x0) * 3];
+		const float* p11 = &face[(y1 * size + x1) * 3];
+
+		glm::vec3 color;
+		for (int c = 0; c < 3; c++)
+		{
+			float top = p00[c] + (p10[c] - p00[c]) * fx;
+			float bottom = p01[c] + (p11[c] - p01[c]) * fx;
+			color[c] = top + (bottom - top) * fy;
+		}
+		return(color);
+	}
+}
+
+/***********************************************************
+ *  EnvironmentMap()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+EnvironmentMap::EnvironmentMap()
+{
+	m_irradiance.size = 0;
+	m_pDevice = NULL;
+	m_prefilterTextureID = 0;
+	m_irradianceTextureID = 0;
+}
+
+/***********************************************************
+ *  ~EnvironmentMap()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+EnvironmentMap::~EnvironmentMap()
+{
+	m_prefilterMips.clear();
+	MemoryTracker::Free(MemoryTracker::CATEGORY_ENVIRONMENT_MAP, (uint64_t)(uintptr_t)this);
+}
+
+/***********************************************************
+ *  TrackMemory()
+ *
+ *  This method is used for recording the memory of the cube
+ *  maps kept for the CPU renderers.
+ ***********************************************************/
+void EnvironmentMap::TrackMemory(const char* hdrFilename)
+{
+	size_t size = 0;
+	for (int face = 0; face < 6; face++)
+	{
+		for (size_t level = 0; level < m_prefilterMips.size(); level++)
+		{
+			size += m_prefilterMips[level].faces[face].size() * sizeof(float);
+		}
+		size += m_irradiance.faces[face].size() * sizeof(float);
+	}
+	MemoryTracker::Allocate(MemoryTracker::CATEGORY_ENVIRONMENT_MAP, (uint64_t)(uintptr_t)this, size, hdrFilename);
+}
+
+/***********************************************************
+ *  SampleCube()
+ *
+ *  This method is used for a bilinear lookup of a cube map
+ *  in the passed in direction.
+ ***********************************************************/
+glm::vec3 EnvironmentMap::SampleCube(const CUBE_IMAGE& cube, glm::vec3 direction)
+{
+	int face = 0;
+	float s = 0.0f;
+	float t = 0.0f;
+	DirectionToFace(direction, face, s, t);
+	return(SampleFace(cube.faces[face], cube.size, s, t));
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for getting the prefiltered cube maps
+ *  ready, from the cache file when it matches the panorama or
+ *  by filtering the panorama on all of the CPU cores.
+ ***********************************************************/
+bool EnvironmentMap::Load(
+	const char* hdrFilename,
+	const char* cacheFilename,
+	int faceSize,
+	int irradianceSize)
+{
+	PROFILE_SCOPE("EnvironmentMap::Load");
+	// the size and modification time of the file are used to
+	// notice a replaced panorama
+	CACHE_SOURCE source;
+	source.size = -1;
+	source.time = -1;
+	struct stat fileStatus;
+	if (stat(hdrFilename, &fileStatus) == 0)
+	{
+		source.size = (long long)fileStatus.st_size;
+		source.time = (long long)fileStatus.st_mtime;
+	}
+	source.faceSize = faceSize;
+	source.irradianceSize = irradianceSize;
+
+	if (ReadCache(cacheFilename, source))
+	{
+		std::cout << "Successfully loaded environment cache:" << cacheFilename << std::endl;
+		TrackMemory(hdrFilename);
+		return(true);
+	}
+
+	int width = 0;
+	int height = 0;
+	int colorChannels = 0;
+
+	// panoramas are stored with the sky at the top row
+	stbi_set_flip_vertically_on_load(false);
+	float* panorama = stbi_loadf(hdrFilename, &width, &height, &colorChannels, 3);
+	if (NULL == panorama)
+	{
+		std::cout << "Could not load environment image:" << hdrFilename << std::endl;
+		return(false);
+	}
+	std::cout << "Successfully loaded environment image:" << hdrFilename << ", width:" << width << ", height:" << height << std::endl;
+
+	// full resolution cube map and its box filtered mip chain,
+	// used as the source for the filtered importance sampling
+	std::vector<CUBE_IMAGE> sourceMips(1);
+	ConvertPanorama(panorama, width, height, faceSize, sourceMips[0]);
+	stbi_image_free(panorama);
+
+	while (sourceMips.back().size > 1)
+	{
+		CUBE_IMAGE halfSize;
+		Downsample(sourceMips.back(), halfSize);
+		sourceMips.push_back(halfSize);
+	}
+
+	// level 0 is a perfect mirror, so it is the cube map itself
+	int levels = std::min(MAX_PREFILTER_LEVELS, (int)sourceMips.size());
+	m_prefilterMips.assign(levels, CUBE_IMAGE());
+	m_prefilterMips[0] = sourceMips[0];
+	for (int level = 1; level < levels; level++)
+	{
+		m_prefilterMips[level].size = sourceMips[level].size;
+		PrefilterLevel(
+			sourceMips,
+			(float)level / (float)(levels - 1),
+			PREFILTER_SAMPLE_COUNT,
+			m_prefilterMips[level]);
+	}
+
+	ComputeIrradiance(sourceMips[0], irradianceSize);
+
+	if (!WriteCache(cacheFilename, source))
+	{
+		std::cout << "Could not write environment cache:" << cacheFilename << std::endl;
+	}
+
+	TrackMemory(hdrFilename);
+	return(true);
+}
+
+/***********************************************************
+ *  ConvertPanorama()
+ *
+ *  This method is used for resampling the equirectangular
+ *  panorama into the six faces of a cube map.
+ ***********************************************************/
+void EnvironmentMap::ConvertPanorama(
+	const float* panorama,
+	int width,
+	int height,
+	int faceSize,
+	CUBE_IMAGE& cube)
+{
+	cube.size = faceSize;
+
+	for (int face = 0; face < 6; face++)
+	{
+		cube.faces[face].assign((size_t)cube.size * cube.size * 3, 0.0f);
+	}
+
+	ParallelFor(6 * cube.size, [&](int row)
+	{
+		int face = row / cube.size;
+		int y = row % cube.size;
+		float tc = 2.0f * (y + 0.5f) / cube.size - 1.0f;
+
+		for (int x = 0; x < cube.size; x++)
+		{
+			float sc = 2.0f * (x + 0.5f) / cube.size - 1.0f;
+			glm::vec3 direction = glm::normalize(FaceDirection(face, sc, tc));
+
+			// longitude wraps around, latitude is clamped at the poles
+			float u = std::atan2(direction.z, direction.x) / (2.0f * PI) + 0.5f;
+			float v = std::acos(std::min(std::max(direction.y, -1.0f), 1.0f)) / PI;
+			float px = u * width - 0.5f;
+			float py = std::min(std::max(v * height - 0.5f, 0.0f), (float)(height - 1));
+			int x0 = (int)std::floor(px);
+			int y0 = (int)py;
+			float fx = px - x0;
+			float fy = py - y0;
+			int x1 = (x0 + 1 + width) % width;
+			x0 = (x0 + width) % width;
+			int y1 = std::min(y0 + 1, height - 1);
+
+			float* texel = &cube.faces[face][(y * cube.size + x) * 3];
+			for (int c = 0; c < 3; c++)
+			{
+				float top = panorama[(y0 * width + x0) * 3 + c] * (1.0f - fx) + panorama[(y0 * width + x1) * 3 + c] * fx;
+				float bottom = panorama[(y1 * width + x0) * 3 + c] * (1.0f - fx) + panorama[(y1 * width + x1) * 3 + c] * fx;
+				texel[c] = top * (1.0f - fy) + bottom * fy;
+			}
+		}
+	});
+}
+
+/***********************************************************
+ *  Downsample()
+ *
+ *  This method is used for averaging 2x2 texel blocks into
+ *  the next smaller cube map level.
+ ***********************************************************/
+void EnvironmentMap::Downsample(const CUBE_IMAGE& source, CUBE_IMAGE& destination)
+{
+	destination.size = std::max(source.size / 2, 1);
+	for (int face = 0; face < 6; face++)
+	{
+		destination.faces[face].assign((size_t)destination.size * destination.size * 3, 0.0f);
+		for (int y = 0; y < destination.size; y++)
+		{
+			for (int x = 0; x < destination.size; x++)
+			{
+				for (int c = 0; c < 3; c++)
+				{
+					float sum =
+						source.faces[face][((2 * y) * source.size + 2 * x) * 3 + c] +
+						source.faces[face][((2 * y) * source.size + 2 * x + 1) * 3 + c] +
+						source.faces[face][((2 * y + 1) * source.size + 2 * x) * 3 + c] +
+						source.faces[face][((2 * y + 1) * source.size + 2 * x + 1) * 3 + c];
+					destination.faces[face][(y * destination.size + x) * 3 + c] = sum * 0.25f;
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  PrefilterLevel()
+ *
+ *  This method is used for convolving the environment with
+ *  the GGX lobe of one roughness value, assuming N = V = R.
+ *  The samples only depend on the roughness, so they are
+ *  generated once in tangent space; per texel they are
+ *  rotated into world space four at a time with SSE.  Each
+ *  sample reads the source mip whose texels match its solid
+ *  angle, which removes the noise of a low sample count.
+ ***********************************************************/
+void EnvironmentMap::PrefilterLevel(
+	const std::vector<CUBE_IMAGE>& sourceMips,
+	float roughness,
+	int sampleCount,
+	CUBE_IMAGE& destination)
+{
+	float alpha = roughness * roughness;
+	float alpha2 = alpha * alpha;
+	float texelSolidAngle = 4.0f * PI / (6.0f * sourceMips[0].size * sourceMips[0].size);
+
+	// with H = (hx, hy, hz) in tangent space and V = N, the
+	// reflected direction is L = a * T + b * B + c * N
+	std::vector<float> sampleA;
+	std::vector<float> sampleB;
+	std::vector<float> sampleC;
+	std::vector<float> sampleLod;
+	for (int i = 0; i < sampleCount; i++)
+	{
+		// Hammersley point set
+		uint32_t bits = (uint32_t)i;
+		bits = (bits << 16u) | (bits >> 16u);
+		bits = ((bits & 0x55555555u) << 1u) | ((bits & 0xAAAAAAAAu) >> 1u);
+		bits = ((bits & 0x33333333u) << 2u) | ((bits & 0xCCCCCCCCu) >> 2u);
+		bits = ((bits & 0x0F0F0F0Fu) << 4u) | ((bits & 0xF0F0F0F0u) >> 4u);
+		bits = ((bits & 0x00FF00FFu) << 8u) | ((bits & 0xFF00FF00u) >> 8u);
+		float xi1 = (float)i / (float)sampleCount;
+		float xi2 = float(bits) * 2.3283064365386963e-10f;
+
+		float phi = 2.0f * PI * xi1;
+		float cosTheta = std::sqrt((1.0f - xi2) / (1.0f + (alpha2 - 1.0f) * xi2));
+		float sinTheta = std::sqrt(1.0f - cosTheta * cosTheta);
+		float NdotL = 2.0f * cosTheta * cosTheta - 1.0f;
+		if (NdotL <= 0.0f)
+		{
+			continue;
+		}
+
+		// pick the source level from the sample's solid angle
+		float denominator = cosTheta * cosTheta * (alpha2 - 1.0f) + 1.0f;
+		float D = alpha2 / (PI * denominator * denominator);
+		float pdf = D / 4.0f;
+		float sampleSolidAngle = 1.0f / (sampleCount * pdf + 0.0001f);
+		float lod = std::max(0.5f * std::log2(sampleSolidAngle / texelSolidAngle) + 1.0f, 0.0f);
+
+		sampleA.push_back(2.0f * cosTheta * sinTheta * std::cos(phi));
+		sampleB.push_back(2.0f * cosTheta * sinTheta * std::sin(phi));
+		sampleC.push_back(NdotL);
+		sampleLod.push_back(std::min(lod, (float)(sourceMips.size() - 1)));
+	}
+
+	// pad to a multiple of four with zero weight samples
+	while ((sampleC.size() % 4) != 0)
+	{
+		sampleA.push_back(0.0f);
+		sampleB.push_back(0.0f);
+		sampleC.push_back(0.0f);
+		sampleLod.push_back(0.0f);
+	}
+	int paddedCount = (int)sampleC.size();
+
+	int size = destination.size;
+	for (int face = 0; face < 6; face++)
+	{
+		destination.faces[face].assign((size_t)size * size * 3, 0.0f);
+	}
+
+	ParallelFor(6 * size, [&](int row)
+	{
+		int face = row / size;
+		int y = row % size;
+		float tc = 2.0f * (y + 0.5f) / size - 1.0f;
+		float directions[4][3];
+
+		for (int x = 0; x < size; x++)
+		{
+			float sc = 2.0f * (x + 0.5f) / size - 1.0f;
+			glm::vec3 N = glm::normalize(FaceDirection(face, sc, tc));
+			glm::vec3 up = (std::fabs(N.z) < 0.999f) ? glm::vec3(0.0f, 0.0f, 1.0f) : glm::vec3(1.0f, 0.0f, 0.0f);
+			glm::vec3 T = glm::normalize(glm::cross(up, N));
+			glm::vec3 B = glm::cross(N, T);
+
+			glm::vec3 color(0.0f);
+			float totalWeight = 0.0f;
+
+			for (int i = 0; i < paddedCount; i += 4)
+			{
+#ifdef ENVIRONMENT_MAP_USE_SSE
+				__m128 a = _mm_loadu_ps(&sampleA[i]);
+				__m128 b = _mm_loadu_ps(&sampleB[i]);
+				__m128 c = _mm_loadu_ps(&sampleC[i]);
+				for (int axis = 0; axis < 3; axis++)
+				{
+					__m128 L = _mm_add_ps(
+						_mm_add_ps(_mm_mul_ps(a, _mm_set1_ps(T[axis])), _mm_mul_ps(b, _mm_set1_ps(B[axis]))),
+						_mm_mul_ps(c, _mm_set1_ps(N[axis])));
+					float lanes[4];
+					_mm_storeu_ps(lanes, L);
+					for (int lane = 0; lane < 4; lane++)
+					{
+						directions[lane][axis] = lanes[lane];
+					}
+				}
+#else
+				for (int lane = 0; lane < 4; lane++)
+				{
+					for (int axis = 0; axis < 3; axis++)
+					{
+						directions[lane][axis] = sampleA[i + lane] * T[axis] + sampleB[i + lane] * B[axis] + sampleC[i + lane] * N[axis];
+					}
+				}
+#endif
+				for (int lane = 0; lane < 4; lane++)
+				{
+					float weight = sampleC[i + lane];
+					if (weight <= 0.0f)
+					{
+						continue;
+					}
+
+					glm::vec3 L(directions[lane][0], directions[lane][1], directions[lane][2]);
+					float lod = sampleLod[i + lane];
+					int lod0 = (int)lod;
+					int lod1 = std::min(lod0 + 1, (int)sourceMips.size() - 1);
+					float blend = lod - lod0;
+					glm::vec3 sample = SampleCube(sourceMips[lod0], L) * (1.0f - blend) + SampleCube(sourceMips[lod1], L) * blend;
+
+					color += sample * weight;
+					totalWeight += weight;
+				}
+			}
+
+			if (totalWeight > 0.0f)
+			{
+				color = color / totalWeight;
+			}
+			float* texel = &destination.faces[face][(y * size + x) * 3];
+			texel[0] = color.r;
+			texel[1] = color.g;
+			texel[2] = color.b;
+		}
+	});
+}
+
+/***********************************************************
+ *  ComputeIrradiance()
+ *
+ *  This method is used for convolving the environment with a
+ *  cosine lobe.  The cube map is projected onto the first
+ *  nine spherical harmonics, which capture diffuse lighting
+ *  almost exactly, and the irradiance is evaluated from them.
+ ***********************************************************/
+void EnvironmentMap::ComputeIrradiance(const CUBE_IMAGE& source, int size)
+{
+	// per face projections, summed in face order afterwards so
+	// the result does not depend on the thread scheduling
+	glm::vec3 faceCoefficients[6][9];
+
+	ParallelFor(6, [&](int face)
+	{
+		for (int i = 0; i < 9; i++)
+		{
+			faceCoefficients[face][i] = glm::vec3(0.0f);
+		}
+
+		for (int y = 0; y < source.size; y++)
+		{
+			float tc = 2.0f * (y + 0.5f) / source.size - 1.0f;
+			for (int x = 0; x < source.size; x++)
+			{
+				float sc = 2.0f * (x + 0.5f) / source.size - 1.0f;
+				glm::vec3 direction = FaceDirection(face, sc, tc);
+				float lengthSquared = glm::dot(direction, direction);
+				// solid angle covered by this texel
+				float solidAngle = (4.0f / (source.size * source.size)) / (lengthSquared * std::sqrt(lengthSquared));
+				direction = direction / std::sqrt(lengthSquared);
+
+				const float* texel = &source.faces[face][(y * source.size + x) * 3];
+				glm::vec3 radiance = glm::vec3(texel[0], texel[1], texel[2]) * solidAngle;
+
+				float basis[9] = {
+					0.282095f,
+					0.488603f * direction.y,
+					0.488603f * direction.z,
+					0.488603f * direction.x,
+					1.092548f * direction.x * direction.y,
+					1.092548f * direction.y * direction.z,
+					0.315392f * (3.0f * direction.z * direction.z - 1.0f),
+					1.092548f * direction.x * direction.z,
+					0.546274f * (direction.x * direction.x - direction.y * direction.y) };
+				for (int i = 0; i < 9; i++)
+				{
+					faceCoefficients[face][i] += radiance * basis[i];
+				}
+			}
+		}
+	});
+
+	glm::vec3 coefficients[9];
+	for (int i = 0; i < 9; i++)
+	{
+		coefficients[i] = glm::vec3(0.0f);
+		for (int face = 0; face < 6; face++)
+		{
+			coefficients[i] += faceCoefficients[face][i];
+		}
+	}
+
+	// cosine lobe convolution per band, divided by pi so the
+	// shader can multiply the result by the diffuse color
+	const float bandScale[3] = { 1.0f, 2.0f / 3.0f, 0.25f };
+	m_irradiance.size = size;
+	for (int face = 0; face < 6; face++)
+	{
+		m_irradiance.faces[face].assign((size_t)size * size * 3, 0.0f);
+		for (int y = 0; y < size; y++)
+		{
+			float tc = 2.0f * (y + 0.5f) / size - 1.0f;
+			for (int x = 0; x < size; x++)
+			{
+				float sc = 2.0f * (x + 0.5f) / size - 1.0f;
+				glm::vec3 n = glm::normalize(FaceDirection(face, sc, tc));
+				float basis[9] = {
+					0.282095f,
+					0.488603f * n.y,
+					0.488603f * n.z,
+					0.488603f * n.x,
+					1.092548f * n.x * n.y,
+					1.092548f * n.y * n.z,
+					0.315392f * (3.0f * n.z * n.z - 1.0f),
+					1.092548f * n.x * n.z,
+					0.546274f * (n.x * n.x - n.y * n.y) };
+
+				glm::vec3 irradiance(0.0f);
+				for (int i = 0; i < 9; i++)
+				{
+					int band = (i == 0) ? 0 : ((i < 4) ? 1 : 2);
+					irradiance += coefficients[i] * (basis[i] * bandScale[band]);
+				}
+
+				float* texel = &m_irradiance.faces[face][(y * size + x) * 3];
+				texel[0] = std::max(irradiance.r, 0.0f);
+				texel[1] = std::max(irradiance.g, 0.0f);
+				texel[2] = std::max(irradiance.b, 0.0f);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ReadCache()
+ *
+ *  This method is used for reading previously prefiltered
+ *  cube maps, when they were filtered from the same panorama
+ *  with the same settings.  When the panorama is missing the
+ *  cache is used as long as the settings match.
+ ***********************************************************/
+bool EnvironmentMap::ReadCache(const char* cacheFilename, const CACHE_SOURCE& source)
+{
+	std::ifstream cacheFile(cacheFilename, std::ios::binary);
+	if (!cacheFile.is_open())
+	{
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	cacheFile.read((char*)&header, sizeof(header));
+	if (!cacheFile ||
+		(memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) ||
+		(header.version != CACHE_VERSION) ||
+		(header.sampleCount != PREFILTER_SAMPLE_COUNT) ||
+		(header.faceSize != source.faceSize) ||
+		(header.irradianceSize != source.irradianceSize) ||
+		((source.size >= 0) && ((header.sourceSize != source.size) || (header.sourceTime != source.time))) ||
+		(header.mipLevels <= 0) || (header.mipLevels > MAX_PREFILTER_LEVELS))
+	{
+		return(false);
+	}
+
+	m_prefilterMips.assign(header.mipLevels, CUBE_IMAGE());
+	int size = header.faceSize;
+	for (int level = 0; level < header.mipLevels; level++)
+	{
+		m_prefilterMips[level].size = size;
+		for (int face = 0; face < 6; face++)
+		{
+			m_prefilterMips[level].faces[face].resize((size_t)size * size * 3);
+			cacheFile.read((char*)m_prefilterMips[level].faces[face].data(), (size_t)size * size * 3 * sizeof(float));
+		}
+		size = std::max(size / 2, 1);
+	}
+
+	m_irradiance.size = header.irradianceSize;
+	for (int face = 0; face < 6; face++)
+	{
+		m_irradiance.faces[face].resize((size_t)m_irradiance.size * m_irradiance.size * 3);
+		cacheFile.read((char*)m_irradiance.faces[face].data(), m_irradiance.faces[face].size() * sizeof(float));
+	}
+
+	if (!cacheFile)
+	{
+		m_prefilterMips.clear();
+		m_irradiance.size = 0;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteCache()
+ *
+ *  This method is used for saving the prefiltered cube maps
+ *  so the following launches can skip the filtering.
+ ***********************************************************/
+bool EnvironmentMap::WriteCache(const char* cacheFilename, const CACHE_SOURCE& source)
+{
+	std::ofstream cacheFile(cacheFilename, std::ios::binary | std::ios::trunc);
+	if (!cacheFile.is_open())
+	{
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.sourceSize = source.size;
+	header.sourceTime = source.time;
+	header.faceSize = m_prefilterMips[0].size;
+	header.irradianceSize = m_irradiance.size;
+	header.mipLevels = (int32_t)m_prefilterMips.size();
+	header.sampleCount = PREFILTER_SAMPLE_COUNT;
+	cacheFile.write((const char*)&header, sizeof(header));
+
+	for (size_t level = 0; level < m_prefilterMips.size(); level++)
+	{
+		for (int face = 0; face < 6; face++)
+		{
+			cacheFile.write((const char*)m_prefilterMips[level].faces[face].data(), m_prefilterMips[level].faces[face].size() * sizeof(float));
+		}
+	}
+	for (int face = 0; face < 6; face++)
+	{
+		cacheFile.write((const char*)m_irradiance.faces[face].data(), m_irradiance.faces[face].size() * sizeof(float));
+	}
+
+	return(cacheFile.good());
+}
+
+/***********************************************************
+ *  CreateTextures()
+ *
+ *  This method is used for uploading the prefiltered levels
+ *  into the mip chain of one cube map texture, and the
+ *  irradiance into a second cube map texture.
+ ***********************************************************/
+void EnvironmentMap::CreateTextures(RenderDevice* pDevice)
+{
+	PROFILE_SCOPE("EnvironmentMap::CreateTextures");
+	if ((NULL == pDevice) || m_prefilterMips.empty())
+	{
+		return;
+	}
+
+	DestroyTextures();
+	m_pDevice = pDevice;
+
+	int levelCount = (int)m_prefilterMips.size();
+	std::vector<const void*> levels(6 * levelCount);
+	for (int face = 0; face < 6; face++)
+	{
+		for (int level = 0; level < levelCount; level++)
+		{
+			levels[face * levelCount + level] = m_prefilterMips[level].faces[face].data();
+		}
+	}
+
+	// the rough levels are the lower mips, so they are
+	// filtered between
+	RenderDevice::TEXTURE_DESC desc = RenderDevice::GetTextureDesc(
+		RenderDevice::FORMAT_RGB16F, m_prefilterMips[0].size, m_prefilterMips[0].size);
+	desc.type = RenderDevice::TEXTURE_CUBE;
+	desc.mipLevels = levelCount;
+	desc.bMipmapFiltering = true;
+	m_prefilterTextureID = m_pDevice->CreateTexture(desc, levels.data());
+
+	const void* irradianceFaces[6];
+	for (int face = 0; face < 6; face++)
+	{
+		irradianceFaces[face] = m_irradiance.faces[face].data();
+	}
+	desc = RenderDevice::GetTextureDesc(RenderDevice::FORMAT_RGB16F, m_irradiance.size, m_irradiance.size);
+	desc.type = RenderDevice::TEXTURE_CUBE;
+	m_irradianceTextureID = m_pDevice->CreateTexture(desc, irradianceFaces);
+}
+
+/***********************************************************
+ *  DestroyTextures()
+ *
+ *  This method is used for freeing the textures.
+ ***********************************************************/
+void EnvironmentMap::DestroyTextures()
+{
+	if (m_prefilterTextureID != 0)
+	{
+		m_pDevice->DestroyTexture(m_prefilterTextureID);
+		m_prefilterTextureID = 0;
+	}
+	if (m_irradianceTextureID != 0)
+	{
+		m_pDevice->DestroyTexture(m_irradianceTextureID);
+		m_irradianceTextureID = 0;
+	}
+}
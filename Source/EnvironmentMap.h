@@ -0,0 +1,110 @@
+///////////////////////////////////////////////////////////////////////////////
+// environmentmap.h
+// ============
+// prefilter an HDR environment panorama into cube maps for reflections
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  EnvironmentMap
+ *
+ *  This class loads an equirectangular HDR panorama, converts
+ *  it into a cube map and prefilters it on the CPU - a mip
+ *  chain of GGX filtered reflections, one level per roughness
+ *  step, plus a diffuse irradiance cube map.  The results are
+ *  cached to disk, so the renderer only samples prefiltered
+ *  cube maps at run time.
+ ***********************************************************/
+class EnvironmentMap
+{
+public:
+	// constructor
+	EnvironmentMap();
+	// destructor
+	~EnvironmentMap();
+
+	// RGB floating point cube map, faces in OpenGL order
+	struct CUBE_IMAGE
+	{
+		int size;
+		std::vector<float> faces[6];
+	};
+
+	// read the prefiltered cube maps from the cache file, or
+	// build them from the panorama and write the cache file
+	bool Load(
+		const char* hdrFilename,
+		const char* cacheFilename,
+		int faceSize = 256,
+		int irradianceSize = 32);
+
+	// upload the prefiltered cube maps into textures
+	void CreateTextures(RenderDevice* pDevice);
+	// free the textures
+	void DestroyTextures();
+
+	RENDER_TEXTURE GetPrefilterTextureID() const { return(m_prefilterTextureID); }
+	RENDER_TEXTURE GetIrradianceTextureID() const { return(m_irradianceTextureID); }
+	int GetPrefilterMipLevels() const { return((int)m_prefilterMips.size()); }
+
+	// the prefiltered levels and irradiance, for CPU renderers
+	const std::vector<CUBE_IMAGE>& GetPrefilterMips() const { return(m_prefilterMips); }
+	const CUBE_IMAGE& GetIrradiance() const { return(m_irradiance); }
+
+	// bilinear lookup of a cube map in the passed in direction
+	static glm::vec3 SampleCube(const CUBE_IMAGE& cube, glm::vec3 direction);
+
+private:
+	// specular reflections, level N filtered for roughness N / (levels - 1)
+	std::vector<CUBE_IMAGE> m_prefilterMips;
+	// cosine convolved diffuse irradiance, divided by pi
+	CUBE_IMAGE m_irradiance;
+	// cube map textures, and the device they are on
+	RenderDevice* m_pDevice;
+	RENDER_TEXTURE m_prefilterTextureID;
+	RENDER_TEXTURE m_irradianceTextureID;
+
+	// resample the panorama into a cube map
+	void ConvertPanorama(
+		const float* panorama,
+		int width,
+		int height,
+		int faceSize,
+		CUBE_IMAGE& cube);
+	// box filter a cube map down to half its size
+	void Downsample(const CUBE_IMAGE& source, CUBE_IMAGE& destination);
+	// GGX filter the source mip chain for one roughness level
+	void PrefilterLevel(
+		const std::vector<CUBE_IMAGE>& sourceMips,
+		float roughness,
+		int sampleCount,
+		CUBE_IMAGE& destination);
+	// project the cube map onto spherical harmonics and evaluate
+	// the irradiance for every texel of the irradiance cube map
+	void ComputeIrradiance(const CUBE_IMAGE& source, int size);
+
+	// what a cache file has to match to be used - the size and
+	// modification time of the panorama, -1 when it is missing,
+	// and the sizes of the cube maps
+	struct CACHE_SOURCE
+	{
+		long long size;
+		long long time;
+		int faceSize;
+		int irradianceSize;
+	};
+
+	// read and write the cache file
+	bool ReadCache(const char* cacheFilename, const CACHE_SOURCE& source);
+	bool WriteCache(const char* cacheFilename, const CACHE_SOURCE& source);
+	// record the memory the cube maps take
+	void TrackMemory(const char* hdrFilename);
+};
@@ -0,0 +1,351 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.cpp
+// ============
+// hand out memory for the data of one frame, freed all at once
+///////////////////////////////////////////////////////////////////////////////
+
+#include "FrameArena.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+
+// declaration of global variables
+namespace
+{
+	// frames after a start or a load that may still allocate,
+	// while caches and containers grow to their working size
+	const int WARMUP_FRAMES = 10;
+
+	std::mutex g_ArenaMutex;
+	std::vector<std::unique_ptr<FrameArena> > g_Arenas;
+	// arenas of threads that ended, handed to new threads -
+	// ParallelFor starts new workers for every call
+	std::vector<FrameArena*> g_FreeArenas;
+
+	// the arena of a thread, given back when the thread ends
+	struct THREAD_SLOT
+	{
+		FrameArena* pArena = NULL;
+		~THREAD_SLOT()
+		{
+			if (NULL != pArena)
+			{
+				std::lock_guard<std::mutex> lock(g_ArenaMutex);
+				g_FreeArenas.push_back(pArena);
+			}
+		}
+	};
+	thread_local THREAD_SLOT g_ThreadSlot;
+
+	// heap allocations made by each thread
+	thread_local uint64_t g_ThreadAllocations = 0;
+
+	// the allocation check of the thread calling EndFrame()
+	bool g_bCheckAllocations = false;
+	int g_WarmupFramesLeft = WARMUP_FRAMES;
+	uint64_t g_FrameStartAllocations = 0;
+	uint64_t g_CheckedFrames = 0;
+
+	// round an address or size up to a power of two
+	size_t AlignUp(size_t value, size_t alignment)
+	{
+		return((value + alignment - 1) & ~(alignment - 1));
+	}
+}
+
+#ifdef FRAME_ARENA_COUNT_ALLOCATIONS
+// the global operators are replaced to count the allocations,
+// passing them on to malloc() and free()
+void* operator new(size_t size)
+{
+	g_ThreadAllocations++;
+	void* pointer = malloc((size > 0) ? size : 1);
+	if (NULL == pointer)
+	{
+		throw std::bad_alloc();
+	}
+	return(pointer);
+}
+
+void* operator new[](size_t size)
+{
+	return(operator new(size));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+	g_ThreadAllocations++;
+	return(malloc((size > 0) ? size : 1));
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+	return(operator new(size, std::nothrow));
+}
+
+void operator delete(void* pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept
+{
+	free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept
+{
+	free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept
+{
+	free(pointer);
+}
+#endif
+
+/***********************************************************
+ *  FrameArena()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+FrameArena::FrameArena(size_t capacity)
+{
+	m_pMemory = NULL;
+	m_capacity = capacity;
+	m_usedBytes = 0;
+	m_peakBytes = 0;
+	m_overflowBytes = 0;
+}
+
+/***********************************************************
+ *  ~FrameArena()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+FrameArena::~FrameArena()
+{
+	Reset();
+	delete[] m_pMemory;
+	m_pMemory = NULL;
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for getting memory that stays valid
+ *  until the arena is reset.  The alignment must be a power
+ *  of two.  When the arena is full, the memory is taken from
+ *  the heap instead, so it never fails for being too small.
+ ***********************************************************/
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	if (size == 0)
+	{
+		size = 1;
+	}
+
+	if (NULL == m_pMemory)
+	{
+		m_pMemory = new char[m_capacity];
+	}
+
+	size_t start = AlignUp((size_t)m_pMemory + m_usedBytes, alignment) - (size_t)m_pMemory;
+	if (start + size <= m_capacity)
+	{
+		m_usedBytes = start + size;
+		return(m_pMemory + start);
+	}
+
+	// out of room, so take a block of its own - new[] only
+	// promises the alignment of the fundamental types
+	char* pBlock = new char[size + alignment];
+	m_overflowBlocks.push_back(pBlock);
+	m_overflowBytes += size + alignment;
+	return((void*)AlignUp((size_t)pBlock, alignment));
+}
+
+/***********************************************************
+ *  CopyString()
+ *
+ *  This method is used for copying a string into the arena,
+ *  such as a name put together for the current frame.
+ ***********************************************************/
+const char* FrameArena::CopyString(const char* text)
+{
+	size_t length = strlen(text);
+	char* copy = (char*)Allocate(length + 1, 1);
+	memcpy(copy, text, length + 1);
+	return(copy);
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for freeing everything allocated from
+ *  the arena at once.  If the memory ran out, the arena is
+ *  made big enough for the most that was used, so the next
+ *  frames fit.
+ ***********************************************************/
+void FrameArena::Reset()
+{
+	size_t usedBytes = m_usedBytes + m_overflowBytes;
+	if (usedBytes > m_peakBytes)
+	{
+		m_peakBytes = usedBytes;
+	}
+
+	if (!m_overflowBlocks.empty())
+	{
+		for (size_t i = 0; i < m_overflowBlocks.size(); i++)
+		{
+			delete[] m_overflowBlocks[i];
+		}
+		m_overflowBlocks.clear();
+
+		// grow by half again, so a frame slowly needing more
+		// does not reallocate every time
+		m_capacity = AlignUp(m_peakBytes + m_peakBytes / 2, DEFAULT_ALIGNMENT);
+		delete[] m_pMemory;
+		m_pMemory = NULL;
+	}
+
+	m_usedBytes = 0;
+	m_overflowBytes = 0;
+}
+
+/***********************************************************
+ *  GetThreadArena()
+ *
+ *  This method is used for getting the arena of the calling
+ *  thread.  A thread that ends gives its arena back for the
+ *  next thread started, so the workers of every ParallelFor()
+ *  call do not each allocate a new one.
+ ***********************************************************/
+FrameArena& FrameArena::GetThreadArena()
+{
+	if (NULL == g_ThreadSlot.pArena)
+	{
+		std::lock_guard<std::mutex> lock(g_ArenaMutex);
+		if (!g_FreeArenas.empty())
+		{
+			g_ThreadSlot.pArena = g_FreeArenas.back();
+			g_FreeArenas.pop_back();
+		}
+		else
+		{
+			g_Arenas.push_back(std::unique_ptr<FrameArena>(new FrameArena()));
+			g_ThreadSlot.pArena = g_Arenas.back().get();
+		}
+	}
+	return(*g_ThreadSlot.pArena);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for resetting the arenas of all of
+ *  the threads at the end of a frame, once the workers are
+ *  done.  When the allocation check is on, a frame past the
+ *  warm-up that made heap allocations on the calling thread
+ *  is reported and stops a debug build at the assert.
+ ***********************************************************/
+void FrameArena::EndFrame()
+{
+	{
+		std::lock_guard<std::mutex> lock(g_ArenaMutex);
+		for (size_t i = 0; i < g_Arenas.size(); i++)
+		{
+			g_Arenas[i]->Reset();
+		}
+	}
+
+	// growing the arenas above counts toward this frame
+	uint64_t allocations = g_ThreadAllocations;
+	uint64_t frameAllocations = allocations - g_FrameStartAllocations;
+	g_FrameStartAllocations = allocations;
+
+	if (!g_bCheckAllocations)
+	{
+		return;
+	}
+	if (g_WarmupFramesLeft > 0)
+	{
+		g_WarmupFramesLeft--;
+		return;
+	}
+
+	g_CheckedFrames++;
+	if (frameAllocations > 0)
+	{
+		std::cout << "ERROR: frame " << g_CheckedFrames << " after the warm-up made "
+			<< frameAllocations << " heap allocations" << std::endl;
+		assert(frameAllocations == 0);
+	}
+}
+
+/***********************************************************
+ *  EnableAllocationCheck()
+ *
+ *  This method is used for turning on the check that the
+ *  frames of the render loop make no heap allocations once
+ *  they are warmed up.  The allocations are only counted in
+ *  debug builds, so elsewhere it fails.
+ ***********************************************************/
+bool FrameArena::EnableAllocationCheck(bool bEnable)
+{
+#ifdef FRAME_ARENA_COUNT_ALLOCATIONS
+	g_bCheckAllocations = bEnable;
+	g_WarmupFramesLeft = WARMUP_FRAMES;
+	g_FrameStartAllocations = g_ThreadAllocations;
+	g_CheckedFrames = 0;
+	return(true);
+#else
+	if (bEnable)
+	{
+		std::cout << "The heap allocations are only counted in debug builds" << std::endl;
+		return(false);
+	}
+	return(true);
+#endif
+}
+
+/***********************************************************
+ *  ExpectAllocations()
+ *
+ *  This method is used for letting the current frame make
+ *  heap allocations, such as when a scene is loaded or a
+ *  report is printed, along with the frames of a warm-up
+ *  after it.
+ ***********************************************************/
+void FrameArena::ExpectAllocations()
+{
+	g_WarmupFramesLeft = WARMUP_FRAMES;
+}
+
+/***********************************************************
+ *  GetThreadAllocationCount()
+ *
+ *  This method is used for getting the number of heap
+ *  allocations the calling thread has made, which is always
+ *  0 when they are not counted.
+ ***********************************************************/
+uint64_t FrameArena::GetThreadAllocationCount()
+{
+	return(g_ThreadAllocations);
+}
@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////
+// framearena.h
+// ============
+// hand out memory for the data of one frame, freed all at once
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// count the heap allocations of every thread in debug builds,
+// for checking that the render loop does not allocate
+#ifdef _DEBUG
+#define FRAME_ARENA_COUNT_ALLOCATIONS
+#endif
+
+/***********************************************************
+ *  FrameArena
+ *
+ *  This class is a linear allocator for data that only lives
+ *  until the end of the frame, such as draw lists being
+ *  sorted or names put together while recording.  Allocating
+ *  moves a pointer forward, nothing is freed on its own, and
+ *  Reset() makes all of the memory free again.  When a frame
+ *  needs more than the arena has, the rest is taken from the
+ *  heap, and the next Reset() grows the arena to the most a
+ *  frame has needed, so after a few frames it stops touching
+ *  the heap.
+ *
+ *  Every thread has an arena of its own, so the workers of
+ *  ParallelFor() can allocate without locking, and EndFrame()
+ *  resets all of them - the workers must be done by then.
+ *  EndFrame() also checks that the frame made no heap
+ *  allocations on the render thread, when that is turned on
+ *  in a debug build.
+ ***********************************************************/
+class FrameArena
+{
+public:
+	// constructor - the memory is allocated on first use
+	FrameArena(size_t capacity = DEFAULT_CAPACITY);
+	// destructor
+	~FrameArena();
+
+	static const size_t DEFAULT_CAPACITY = 256 * 1024;
+	static const size_t DEFAULT_ALIGNMENT = 16;
+
+	// get memory that stays valid until the next Reset()
+	void* Allocate(size_t size, size_t alignment = DEFAULT_ALIGNMENT);
+	// get room for an array - the elements are not constructed
+	template <typename T>
+	T* AllocateArray(size_t count) { return((T*)Allocate(count * sizeof(T), alignof(T))); }
+	// copy a string into the arena
+	const char* CopyString(const char* text);
+	// free everything allocated, keeping the memory
+	void Reset();
+
+	size_t GetUsedBytes() const { return(m_usedBytes + m_overflowBytes); }
+	// most bytes used in one frame, and the size of the arena
+	size_t GetPeakBytes() const { return(m_peakBytes); }
+	size_t GetCapacity() const { return(m_capacity); }
+
+	// get the arena of the calling thread
+	static FrameArena& GetThreadArena();
+	// end the frame - reset the arenas of all threads, and
+	// check the heap allocations of the calling thread
+	static void EndFrame();
+	// check that the frames after the first few do not make
+	// heap allocations, false when not a debug build
+	static bool EnableAllocationCheck(bool bEnable);
+	// let the current frame and the few after it allocate,
+	// such as when a scene is loaded
+	static void ExpectAllocations();
+	// heap allocations made by the calling thread so far, 0
+	// when they are not counted
+	static uint64_t GetThreadAllocationCount();
+
+private:
+	char* m_pMemory;
+	size_t m_capacity;
+	size_t m_usedBytes;
+	size_t m_peakBytes;
+	// blocks taken from the heap when the memory ran out,
+	// and their total size
+	std::vector<char*> m_overflowBlocks;
+	size_t m_overflowBytes;
+
+	FrameArena(const FrameArena&) = delete;
+	FrameArena& operator=(const FrameArena&) = delete;
+};
+
+/***********************************************************
+ *  FrameAllocator
+ *
+ *  This class lets the standard containers allocate from a
+ *  frame arena, such as
+ *
+ *    std::vector<int, FrameAllocator<int> > items(
+ *        FrameAllocator<int>(FrameArena::GetThreadArena()));
+ *
+ *  Freeing does nothing, so a container that grows leaves
+ *  its old memory in the arena until the frame ends - reserve
+ *  the size needed up front when it is known.  Containers
+ *  using it must be gone before the arena is reset.
+ ***********************************************************/
+template <typename T>
+class FrameAllocator
+{
+public:
+	typedef T value_type;
+
+	FrameAllocator(FrameArena& arena) : m_pArena(&arena) {}
+	template <typename U>
+	FrameAllocator(const FrameAllocator<U>& other) : m_pArena(other.GetArena()) {}
+
+	T* allocate(size_t count) { return(m_pArena->AllocateArray<T>(count)); }
+	void deallocate(T* pointer, size_t count) {}
+
+	FrameArena* GetArena() const { return(m_pArena); }
+
+private:
+	FrameArena* m_pArena;
+};
+
+template <typename T, typename U>
+bool operator==(const FrameAllocator<T>& a, const FrameAllocator<U>& b)
+{
+	return(a.GetArena() == b.GetArena());
+}
+
+template <typename T, typename U>
+bool operator!=(const FrameAllocator<T>& a, const FrameAllocator<U>& b)
+{
+	return(a.GetArena() != b.GetArena());
+}
@@ -0,0 +1,1087 @@
+///////////////////////////////////////////////////////////////////////////////
+// glrenderdevice.cpp
+// ============
+// run the render device objects and command lists with OpenGL
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GLRenderDevice.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+#include "SceneFile.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// vertex layout of the basic shapes and text - position,
+	// normal and texture coordinate
+	const int FLOATS_PER_VERTEX = 8;
+
+	// frames the timer results are read after, enough for the
+	// GPU to have finished them on a typical queue depth
+	const size_t TIMER_LATENCY = 4;
+
+	// OpenGL formats of the texture formats
+	struct GL_TEXTURE_FORMAT
+	{
+		GLint internalFormat;
+		GLenum format;
+		GLenum type;
+	};
+	const GL_TEXTURE_FORMAT g_TextureFormats[] = {
+		{ GL_R8, GL_RED, GL_UNSIGNED_BYTE },
+		{ GL_RGB8, GL_RGB, GL_UNSIGNED_BYTE },
+		{ GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE },
+		{ GL_RG16F, GL_RG, GL_FLOAT },
+		{ GL_RGB16F, GL_RGB, GL_FLOAT } };
+}
+
+/***********************************************************
+ *  GLRenderDevice()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GLRenderDevice::GLRenderDevice(GLuint programID)
+{
+	m_programID = programID;
+	m_basicMeshes = NULL;
+	m_currentPipeline = 0;
+	m_uniformLocations.resize(1);
+	m_boundProgram = 0;
+	for (GLuint i = 0; i < MAX_TEXTURE_UNITS; i++)
+	{
+		m_boundTextures[i] = 0;
+	}
+	GLint activeTexture = GL_TEXTURE0;
+	glGetIntegerv(GL_ACTIVE_TEXTURE, &activeTexture);
+	m_activeTextureUnit = (GLuint)(activeTexture - GL_TEXTURE0);
+	m_drawCount = 0;
+	m_pStatistics = NULL;
+
+	m_bTimersEnabled = false;
+	m_timerFrames.resize(TIMER_LATENCY);
+	for (size_t i = 0; i < m_timerFrames.size(); i++)
+	{
+		m_timerFrames[i].usedCount = 0;
+	}
+	m_timerFrameIndex = 0;
+
+	GLint viewport[4] = { 0, 0, 0, 0 };
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	m_windowWidth = viewport[2];
+	m_windowHeight = viewport[3];
+
+	m_uniformBufferAlignment = 256;
+	glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &m_uniformBufferAlignment);
+
+	// filter across the cube face edges for the rough levels
+	// of the environment maps
+	glEnable(GL_TEXTURE_CUBE_MAP_SEAMLESS);
+	// the pixels passed in are tightly packed
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+}
+
+/***********************************************************
+ *  LoadBasicMeshes()
+ *
+ *  This method is used for generating the basic shapes and
+ *  uploading them into vertex buffers.  It is kept out of
+ *  the constructor so the startup timeline shows it as a
+ *  phase of its own.
+ ***********************************************************/
+void GLRenderDevice::LoadBasicMeshes()
+{
+	if (NULL != m_basicMeshes)
+	{
+		return;
+	}
+
+	m_basicMeshes = new ShapeMeshes();
+	glBindVertexArray(0);
+	m_basicMeshes->LoadBoxMesh();
+	TrackBasicMesh("box mesh");
+	m_basicMeshes->LoadPlaneMesh();
+	TrackBasicMesh("plane mesh");
+	m_basicMeshes->LoadCylinderMesh();
+	TrackBasicMesh("cylinder mesh");
+	m_basicMeshes->LoadConeMesh();
+	TrackBasicMesh("cone mesh");
+	m_basicMeshes->LoadPrismMesh();
+	TrackBasicMesh("prism mesh");
+	m_basicMeshes->LoadPyramid4Mesh();
+	TrackBasicMesh("pyramid mesh");
+	m_basicMeshes->LoadSphereMesh();
+	TrackBasicMesh("sphere mesh");
+	m_basicMeshes->LoadTaperedCylinderMesh();
+	TrackBasicMesh("tapered cylinder mesh");
+	m_basicMeshes->LoadTorusMesh();
+	TrackBasicMesh("torus mesh");
+}
+
+/***********************************************************
+ *  ~GLRenderDevice()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GLRenderDevice::~GLRenderDevice()
+{
+	delete m_basicMeshes;
+	m_basicMeshes = NULL;
+	for (size_t i = 0; i < m_basicMeshArrays.size(); i++)
+	{
+		MemoryTracker::Free(MemoryTracker::CATEGORY_SHAPE_MESH, m_basicMeshArrays[i]);
+	}
+	m_basicMeshArrays.clear();
+
+	for (size_t i = 0; i < m_timerFrames.size(); i++)
+	{
+		if (!m_timerFrames[i].queries.empty())
+		{
+			glDeleteQueries((GLsizei)m_timerFrames[i].queries.size(), &m_timerFrames[i].queries[0]);
+		}
+	}
+	m_timerFrames.clear();
+
+	// free whatever the users did not destroy themselves - the
+	// objects stay recorded, so the leak report lists them
+	std::unordered_map<GLuint, BUFFER_OBJECT>::iterator bufferIt;
+	for (bufferIt = m_buffers.begin(); bufferIt != m_buffers.end(); ++bufferIt)
+	{
+		if (bufferIt->second.vertexArrayID != 0)
+		{
+			glDeleteVertexArrays(1, &bufferIt->second.vertexArrayID);
+		}
+		glDeleteBuffers(1, &bufferIt->first);
+	}
+	m_buffers.clear();
+	std::unordered_map<GLuint, GLenum>::iterator textureIt;
+	for (textureIt = m_textureTargets.begin(); textureIt != m_textureTargets.end(); ++textureIt)
+	{
+		glDeleteTextures(1, &textureIt->first);
+	}
+	m_textureTargets.clear();
+	std::unordered_map<GLuint, TARGET_OBJECT>::iterator targetIt;
+	for (targetIt = m_renderTargets.begin(); targetIt != m_renderTargets.end(); ++targetIt)
+	{
+		glDeleteFramebuffers(1, &targetIt->first);
+		glDeleteRenderbuffers(1, &targetIt->second.colorBufferID);
+		glDeleteRenderbuffers(1, &targetIt->second.depthBufferID);
+	}
+	m_renderTargets.clear();
+	m_pipelines.clear();
+	m_uniformLocations.clear();
+	m_uniformLocations.resize(1);
+}
+
+/***********************************************************
+ *  CreateBuffer()
+ *
+ *  This method is used for creating a buffer.  A vertex
+ *  buffer also gets the vertex array with its attribute
+ *  layout, so it can be drawn without setting it up again.
+ ***********************************************************/
+RENDER_BUFFER GLRenderDevice::CreateBuffer(const BUFFER_DESC& desc, const void* data)
+{
+	BUFFER_OBJECT buffer;
+	buffer.target = (desc.type == BUFFER_VERTEX) ? GL_ARRAY_BUFFER : GL_UNIFORM_BUFFER;
+	buffer.size = desc.size;
+	buffer.vertexArrayID = 0;
+
+	GLuint bufferID = 0;
+	glGenBuffers(1, &bufferID);
+
+	if (desc.type == BUFFER_VERTEX)
+	{
+		glGenVertexArrays(1, &buffer.vertexArrayID);
+		glBindVertexArray(buffer.vertexArrayID);
+	}
+
+	glBindBuffer(buffer.target, bufferID);
+	glBufferData(buffer.target, (GLsizeiptr)desc.size, data, desc.bDynamic ? GL_DYNAMIC_DRAW : GL_STATIC_DRAW);
+
+	if (desc.type == BUFFER_VERTEX)
+	{
+		GLsizei stride = FLOATS_PER_VERTEX * sizeof(float);
+		glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, (void*)0);
+		glEnableVertexAttribArray(0);
+		glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, stride, (void*)(3 * sizeof(float)));
+		glEnableVertexAttribArray(1);
+		glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride, (void*)(6 * sizeof(float)));
+		glEnableVertexAttribArray(2);
+		glBindVertexArray(0);
+	}
+	glBindBuffer(buffer.target, 0);
+
+	if ((NULL != m_pStatistics) && (NULL != data))
+	{
+		m_pStatistics->GetCurrentFrame().bufferBytesUploaded += desc.size;
+	}
+	if (desc.type == BUFFER_VERTEX)
+	{
+		MemoryTracker::Allocate(MemoryTracker::CATEGORY_VERTEX_BUFFER, bufferID, desc.size, "vertex buffer " + std::to_string(bufferID));
+	}
+	else
+	{
+		MemoryTracker::Allocate(MemoryTracker::CATEGORY_UNIFORM_BUFFER, bufferID, desc.size, "uniform buffer " + std::to_string(bufferID));
+	}
+
+	m_buffers[bufferID] = buffer;
+	return(bufferID);
+}
+
+/***********************************************************
+ *  UpdateBuffer()
+ *
+ *  This method is used for overwriting a range of a buffer.
+ ***********************************************************/
+void GLRenderDevice::UpdateBuffer(RENDER_BUFFER buffer, size_t offset, size_t size, const void* data)
+{
+	std::unordered_map<GLuint, BUFFER_OBJECT>::const_iterator it = m_buffers.find(buffer);
+	if ((it == m_buffers.end()) || (offset + size > it->second.size))
+	{
+		return;
+	}
+
+	glBindBuffer(it->second.target, buffer);
+	glBufferSubData(it->second.target, (GLintptr)offset, (GLsizeiptr)size, data);
+	glBindBuffer(it->second.target, 0);
+
+	if (NULL != m_pStatistics)
+	{
+		m_pStatistics->GetCurrentFrame().bufferBytesUploaded += size;
+	}
+}
+
+/***********************************************************
+ *  CopyBuffer()
+ *
+ *  This method is used for copying the start of a buffer
+ *  into another one on the GPU.
+ ***********************************************************/
+void GLRenderDevice::CopyBuffer(RENDER_BUFFER source, RENDER_BUFFER destination, size_t size)
+{
+	glBindBuffer(GL_COPY_READ_BUFFER, source);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, destination);
+	glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, (GLsizeiptr)size);
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+/***********************************************************
+ *  DestroyBuffer()
+ *
+ *  This method is used for freeing a buffer.
+ ***********************************************************/
+void GLRenderDevice::DestroyBuffer(RENDER_BUFFER buffer)
+{
+	std::unordered_map<GLuint, BUFFER_OBJECT>::iterator it = m_buffers.find(buffer);
+	if (it == m_buffers.end())
+	{
+		return;
+	}
+
+	if (it->second.vertexArrayID != 0)
+	{
+		glDeleteVertexArrays(1, &it->second.vertexArrayID);
+	}
+	glDeleteBuffers(1, &buffer);
+	MemoryTracker::Free((it->second.target == GL_ARRAY_BUFFER) ? MemoryTracker::CATEGORY_VERTEX_BUFFER : MemoryTracker::CATEGORY_UNIFORM_BUFFER, buffer);
+	m_buffers.erase(it);
+}
+
+/***********************************************************
+ *  GetUniformBufferAlignment()
+ *
+ *  This method is used for getting the offset alignment of
+ *  uniform buffer ranges.
+ ***********************************************************/
+size_t GLRenderDevice::GetUniformBufferAlignment() const
+{
+	return((size_t)m_uniformBufferAlignment);
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for creating a texture, uploading the
+ *  passed in levels and setting up the sampling parameters.
+ ***********************************************************/
+RENDER_TEXTURE GLRenderDevice::CreateTexture(const TEXTURE_DESC& desc, const void* const* data)
+{
+	if (desc.format >= sizeof(g_TextureFormats) / sizeof(g_TextureFormats[0]))
+	{
+		std::cout << "Not implemented to handle texture format " << desc.format << std::endl;
+		return(0);
+	}
+
+	const GL_TEXTURE_FORMAT& format = g_TextureFormats[desc.format];
+	GLenum target = (desc.type == TEXTURE_CUBE) ? GL_TEXTURE_CUBE_MAP : GL_TEXTURE_2D;
+	int faceCount = (desc.type == TEXTURE_CUBE) ? 6 : 1;
+	int levelCount = (desc.mipLevels > 0) ? desc.mipLevels : 1;
+
+	GLuint textureID = 0;
+	glGenTextures(1, &textureID);
+	glBindTexture(target, textureID);
+	// the upload leaves nothing bound to the active unit
+	if (m_activeTextureUnit < MAX_TEXTURE_UNITS)
+	{
+		m_boundTextures[m_activeTextureUnit] = 0;
+	}
+
+	for (int face = 0; face < faceCount; face++)
+	{
+		GLenum faceTarget = (desc.type == TEXTURE_CUBE) ? GL_TEXTURE_CUBE_MAP_POSITIVE_X + face : GL_TEXTURE_2D;
+		for (int level = 0; level < levelCount; level++)
+		{
+			int width = (desc.width >> level) > 1 ? (desc.width >> level) : 1;
+			int height = (desc.height >> level) > 1 ? (desc.height >> level) : 1;
+			const void* pixels = (NULL != data) ? data[face * levelCount + level] : NULL;
+			glTexImage2D(faceTarget, level, format.internalFormat, width, height, 0, format.format, format.type, pixels);
+		}
+	}
+
+	GLint wrap = desc.bRepeat ? GL_REPEAT : GL_CLAMP_TO_EDGE;
+	glTexParameteri(target, GL_TEXTURE_WRAP_S, wrap);
+	glTexParameteri(target, GL_TEXTURE_WRAP_T, wrap);
+	if (desc.type == TEXTURE_CUBE)
+	{
+		glTexParameteri(target, GL_TEXTURE_WRAP_R, wrap);
+	}
+	glTexParameteri(target, GL_TEXTURE_MIN_FILTER, desc.bMipmapFiltering ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+	glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+	if (desc.bGenerateMipmaps)
+	{
+		glGenerateMipmap(target);
+	}
+	else if (desc.bMipmapFiltering)
+	{
+		// only sample the levels that were passed in
+		glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+	}
+	glBindTexture(target, 0);
+
+	m_textureTargets[textureID] = target;
+	MemoryTracker::Allocate(MemoryTracker::CATEGORY_TEXTURE, textureID, GetTextureSize(desc),
+		std::string((desc.type == TEXTURE_CUBE) ? "cube texture " : "texture ") +
+		std::to_string(desc.width) + "x" + std::to_string(desc.height));
+	return(textureID);
+}
+
+/***********************************************************
+ *  DestroyTexture()
+ *
+ *  This method is used for freeing a texture.
+ ***********************************************************/
+void GLRenderDevice::DestroyTexture(RENDER_TEXTURE texture)
+{
+	if (m_textureTargets.erase(texture) > 0)
+	{
+		// deleting unbinds it, and the name can be handed out again
+		for (GLuint i = 0; i < MAX_TEXTURE_UNITS; i++)
+		{
+			if (m_boundTextures[i] == texture)
+			{
+				m_boundTextures[i] = 0;
+			}
+		}
+		glDeleteTextures(1, &texture);
+		MemoryTracker::Free(MemoryTracker::CATEGORY_TEXTURE, texture);
+	}
+}
+
+/***********************************************************
+ *  CreateRenderTarget()
+ *
+ *  This method is used for creating a framebuffer with color
+ *  and depth renderbuffers.  Returns 0 if it is incomplete.
+ ***********************************************************/
+RENDER_TARGET GLRenderDevice::CreateRenderTarget(int width, int height)
+{
+	TARGET_OBJECT target;
+	GLuint framebufferID = 0;
+
+	glGenFramebuffers(1, &framebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebufferID);
+
+	glGenRenderbuffers(1, &target.colorBufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, target.colorBufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.colorBufferID);
+
+	glGenRenderbuffers(1, &target.depthBufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, target.depthBufferID);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, target.depthBufferID);
+	glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+	bool bComplete = (glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	m_renderTargets[framebufferID] = target;
+	// 8 bit RGBA color with a 24 bit depth and 8 bit stencil
+	MemoryTracker::Allocate(MemoryTracker::CATEGORY_RENDER_TARGET, framebufferID, (size_t)width * height * 8,
+		"render target " + std::to_string(width) + "x" + std::to_string(height));
+	if (!bComplete)
+	{
+		std::cout << "Could not create a " << width << "x" << height << " render target" << std::endl;
+		DestroyRenderTarget(framebufferID);
+		return(0);
+	}
+
+	return(framebufferID);
+}
+
+/***********************************************************
+ *  ReadPixels()
+ *
+ *  This method is used for reading back the color of a
+ *  render target.  BGRA, bottom row first, is what
+ *  glReadPixels returns, so no conversion is needed.
+ ***********************************************************/
+bool GLRenderDevice::ReadPixels(RENDER_TARGET target, int width, int height, void* pixels)
+{
+	if ((target != 0) && (m_renderTargets.find(target) == m_renderTargets.end()))
+	{
+		return(false);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, target);
+	glReadPixels(0, 0, width, height, GL_BGRA, GL_UNSIGNED_BYTE, pixels);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyRenderTarget()
+ *
+ *  This method is used for freeing a render target.
+ ***********************************************************/
+void GLRenderDevice::DestroyRenderTarget(RENDER_TARGET target)
+{
+	std::unordered_map<GLuint, TARGET_OBJECT>::iterator it = m_renderTargets.find(target);
+	if (it == m_renderTargets.end())
+	{
+		return;
+	}
+
+	glDeleteFramebuffers(1, &target);
+	glDeleteRenderbuffers(1, &it->second.colorBufferID);
+	glDeleteRenderbuffers(1, &it->second.depthBufferID);
+	MemoryTracker::Free(MemoryTracker::CATEGORY_RENDER_TARGET, target);
+	m_renderTargets.erase(it);
+}
+
+/***********************************************************
+ *  GetWindowSize()
+ *
+ *  This method is used for getting the size of the window.
+ ***********************************************************/
+void GLRenderDevice::GetWindowSize(int& width, int& height) const
+{
+	width = m_windowWidth;
+	height = m_windowHeight;
+}
+
+/***********************************************************
+ *  CreatePipeline()
+ *
+ *  This method is used for creating a pipeline.  OpenGL has
+ *  no pipeline object, so the state is kept and set when the
+ *  pipeline is used, except for the uniform block binding,
+ *  which belongs to the shader program.
+ ***********************************************************/
+RENDER_PIPELINE GLRenderDevice::CreatePipeline(const PIPELINE_DESC& desc)
+{
+	if (NULL != desc.uniformBlockName)
+	{
+		GLuint blockIndex = glGetUniformBlockIndex(m_programID, desc.uniformBlockName);
+		if (blockIndex != GL_INVALID_INDEX)
+		{
+			glUniformBlockBinding(m_programID, blockIndex, desc.uniformBlockBinding);
+		}
+	}
+
+	m_pipelines.push_back(desc);
+	// the name may not outlive the call
+	m_pipelines.back().uniformBlockName = NULL;
+	m_uniformLocations.resize(m_pipelines.size() + 1);
+	return((RENDER_PIPELINE)m_pipelines.size());
+}
+
+/***********************************************************
+ *  DestroyPipeline()
+ *
+ *  This method is used for freeing a pipeline.  There is
+ *  nothing to free in OpenGL but the uniform locations
+ *  looked up under it.
+ ***********************************************************/
+void GLRenderDevice::DestroyPipeline(RENDER_PIPELINE pipeline)
+{
+	if (m_currentPipeline == pipeline)
+	{
+		m_currentPipeline = 0;
+	}
+	if ((pipeline != 0) && (pipeline < m_uniformLocations.size()))
+	{
+		m_uniformLocations[pipeline].clear();
+	}
+}
+
+/***********************************************************
+ *  ApplyPipeline()
+ *
+ *  This method is used for setting the fixed function state
+ *  of a pipeline, unless it is set already.
+ ***********************************************************/
+void GLRenderDevice::ApplyPipeline(RENDER_PIPELINE pipeline)
+{
+	if ((pipeline == 0) || (pipeline > m_pipelines.size()) || (pipeline == m_currentPipeline))
+	{
+		return;
+	}
+
+	const PIPELINE_DESC& desc = m_pipelines[pipeline - 1];
+	if (desc.blendMode == BLEND_ALPHA)
+	{
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+	}
+	else
+	{
+		glDisable(GL_BLEND);
+	}
+
+	if (desc.bDepthTest)
+	{
+		glEnable(GL_DEPTH_TEST);
+	}
+	else
+	{
+		glDisable(GL_DEPTH_TEST);
+	}
+	glDepthMask(desc.bDepthWrite ? GL_TRUE : GL_FALSE);
+
+	if (desc.bPolygonOffset)
+	{
+		glEnable(GL_POLYGON_OFFSET_FILL);
+		glPolygonOffset(-1.0f, -1.0f);
+	}
+	else
+	{
+		glDisable(GL_POLYGON_OFFSET_FILL);
+	}
+
+	m_currentPipeline = pipeline;
+}
+
+/***********************************************************
+ *  GetUniformLocation()
+ *
+ *  This method is used for getting the location of a
+ *  uniform on the shader program.  It is only asked of the
+ *  program the first time the current pipeline sets the
+ *  uniform, and kept for the submits after it - also when
+ *  the program does not use the uniform.
+ ***********************************************************/
+GLint GLRenderDevice::GetUniformLocation(const char* name)
+{
+	RENDER_PIPELINE pipeline = m_currentPipeline;
+	if (pipeline >= m_uniformLocations.size())
+	{
+		pipeline = 0;
+	}
+
+	std::map<std::string, GLint, std::less<> >& locations = m_uniformLocations[pipeline];
+	std::map<std::string, GLint, std::less<> >::const_iterator it = locations.find(name);
+	if (it != locations.end())
+	{
+		return(it->second);
+	}
+
+	GLint location = glGetUniformLocation(m_programID, name);
+	locations.emplace(name, location);
+	return(location);
+}
+
+/***********************************************************
+ *  ApplyUniform()
+ *
+ *  This method is used for setting the value of a uniform
+ *  command on the shader program.
+ ***********************************************************/
+bool GLRenderDevice::ApplyUniform(const RenderCommandList& commands, const RenderCommandList::COMMAND& command)
+{
+	GLint location = GetUniformLocation(commands.GetName(command));
+	if (location < 0)
+	{
+		return(false);
+	}
+
+	switch (command.type)
+	{
+	case RenderCommandList::COMMAND_SET_INT:
+		glUniform1i(location, command.intValue);
+		break;
+	case RenderCommandList::COMMAND_SET_FLOAT:
+		glUniform1f(location, command.floatValues[0]);
+		break;
+	case RenderCommandList::COMMAND_SET_VEC2:
+		glUniform2fv(location, 1, command.floatValues);
+		break;
+	case RenderCommandList::COMMAND_SET_VEC3:
+		glUniform3fv(location, 1, command.floatValues);
+		break;
+	case RenderCommandList::COMMAND_SET_VEC4:
+		glUniform4fv(location, 1, command.floatValues);
+		break;
+	case RenderCommandList::COMMAND_SET_MAT4:
+		glUniformMatrix4fv(location, 1, GL_FALSE, command.floatValues);
+		break;
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  TrackBasicMesh()
+ *
+ *  This method is used for recording the GPU memory of the
+ *  basic shape loaded last.  ShapeMeshes keeps its buffers
+ *  to itself, so they are found through the vertex array the
+ *  load leaves bound, and measured with GL_BUFFER_SIZE.  A
+ *  load that leaves no vertex array bound is not recorded.
+ ***********************************************************/
+void GLRenderDevice::TrackBasicMesh(const char* name)
+{
+	GLint vertexArrayID = 0;
+	glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &vertexArrayID);
+	if (vertexArrayID == 0)
+	{
+		return;
+	}
+
+	// the index buffer and the buffers of the attributes,
+	// which may share one buffer
+	std::set<GLint> bufferIDs;
+	GLint bufferID = 0;
+	glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &bufferID);
+	if (bufferID != 0)
+	{
+		bufferIDs.insert(bufferID);
+	}
+	GLint attributeCount = 0;
+	glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &attributeCount);
+	for (GLint i = 0; i < attributeCount; i++)
+	{
+		bufferID = 0;
+		glGetVertexAttribiv((GLuint)i, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &bufferID);
+		if (bufferID != 0)
+		{
+			bufferIDs.insert(bufferID);
+		}
+	}
+
+	// measured through a binding the vertex array does not keep
+	size_t size = 0;
+	std::set<GLint>::const_iterator it;
+	for (it = bufferIDs.begin(); it != bufferIDs.end(); ++it)
+	{
+		GLint bufferSize = 0;
+		glBindBuffer(GL_COPY_READ_BUFFER, (GLuint)*it);
+		glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &bufferSize);
+		size += (size_t)bufferSize;
+	}
+	glBindBuffer(GL_COPY_READ_BUFFER, 0);
+	glBindVertexArray(0);
+
+	MemoryTracker::Allocate(MemoryTracker::CATEGORY_SHAPE_MESH, (uint64_t)vertexArrayID, size, name);
+	m_basicMeshArrays.push_back((GLuint)vertexArrayID);
+}
+
+/***********************************************************
+ *  DrawShape()
+ *
+ *  This method is used for drawing the parts of a basic
+ *  shape with the ShapeMeshes draw calls.
+ ***********************************************************/
+void GLRenderDevice::DrawShape(uint32_t meshType, uint32_t parts)
+{
+	if (NULL == m_basicMeshes)
+	{
+		return;
+	}
+
+	bool bTop = (parts == SceneFile::PART_ALL) || ((parts & SceneFile::PART_TOP) != 0);
+	bool bBottom = (parts == SceneFile::PART_ALL) || ((parts & SceneFile::PART_BOTTOM) != 0);
+	bool bSides = (parts == SceneFile::PART_ALL) || ((parts & SceneFile::PART_SIDES) != 0);
+
+	switch (meshType)
+	{
+	case SceneFile::MESH_BOX:
+		if (parts == SceneFile::PART_ALL)
+		{
+			m_basicMeshes->DrawBoxMesh();
+			break;
+		}
+		if (parts & SceneFile::PART_BACK) m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::back);
+		if (parts & SceneFile::PART_BOTTOM) m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::bottom);
+		if (parts & SceneFile::PART_LEFT) m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::left);
+		if (parts & SceneFile::PART_RIGHT) m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::right);
+		if (parts & SceneFile::PART_TOP) m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::top);
+		if (parts & SceneFile::PART_FRONT) m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::front);
+		break;
+	case SceneFile::MESH_PLANE:
+		m_basicMeshes->DrawPlaneMesh();
+		break;
+	case SceneFile::MESH_CYLINDER:
+		m_basicMeshes->DrawCylinderMesh(bTop, bBottom, bSides);
+		break;
+	case SceneFile::MESH_CONE:
+		m_basicMeshes->DrawConeMesh(bBottom);
+		break;
+	case SceneFile::MESH_PRISM:
+		m_basicMeshes->DrawPrismMesh();
+		break;
+	case SceneFile::MESH_PYRAMID4:
+		m_basicMeshes->DrawPyramid4Mesh();
+		break;
+	case SceneFile::MESH_SPHERE:
+		m_basicMeshes->DrawSphereMesh();
+		break;
+	case SceneFile::MESH_HALF_SPHERE:
+		m_basicMeshes->DrawHalfSphereMesh();
+		break;
+	case SceneFile::MESH_TAPERED_CYLINDER:
+		m_basicMeshes->DrawTaperedCylinderMesh(bTop, bBottom, bSides);
+		break;
+	case SceneFile::MESH_TORUS:
+		m_basicMeshes->DrawTorusMesh();
+		break;
+	case SceneFile::MESH_HALF_TORUS:
+		m_basicMeshes->DrawHalfTorusMesh();
+		break;
+	}
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for running the commands of a list
+ *  in the order they were recorded.
+ ***********************************************************/
+void GLRenderDevice::Submit(const RenderCommandList& commands)
+{
+	PROFILE_SCOPE("GLRenderDevice::Submit");
+
+	// counted into a local copy, written back at the end
+	RenderStatistics::FRAME_STATISTICS frame = RenderStatistics::FRAME_STATISTICS();
+	if (NULL != m_pStatistics)
+	{
+		frame = m_pStatistics->GetCurrentFrame();
+	}
+
+	// only the binds that change something are made and counted
+	if (m_boundProgram != m_programID)
+	{
+		glUseProgram(m_programID);
+		m_boundProgram = m_programID;
+		frame.programBinds++;
+	}
+
+	for (size_t i = 0; i < commands.GetCommandCount(); i++)
+	{
+		const RenderCommandList::COMMAND& command = commands.GetCommand(i);
+		switch (command.type)
+		{
+		case RenderCommandList::COMMAND_SET_RENDER_TARGET:
+		{
+			int width = (int)command.arguments[0];
+			int height = (int)command.arguments[1];
+			if ((width <= 0) || (height <= 0))
+			{
+				width = m_windowWidth;
+				height = m_windowHeight;
+			}
+			glBindFramebuffer(GL_FRAMEBUFFER, command.handle);
+			glViewport(0, 0, width, height);
+			break;
+		}
+		case RenderCommandList::COMMAND_CLEAR:
+			// the depth can only be cleared while it is written
+			glDepthMask(GL_TRUE);
+			m_currentPipeline = 0;
+			glClearColor(command.floatValues[0], command.floatValues[1], command.floatValues[2], command.floatValues[3]);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+			break;
+		case RenderCommandList::COMMAND_SET_PIPELINE:
+			ApplyPipeline(command.handle);
+			break;
+		case RenderCommandList::COMMAND_BIND_TEXTURE:
+		{
+			GLenum target = GL_TEXTURE_2D;
+			std::unordered_map<GLuint, GLenum>::const_iterator it = m_textureTargets.find(command.handle);
+			if (it != m_textureTargets.end())
+			{
+				target = it->second;
+			}
+			GLuint unit = command.arguments[0];
+			if ((unit < MAX_TEXTURE_UNITS) && (m_boundTextures[unit] == command.handle) && (command.handle != 0))
+			{
+				break;
+			}
+			if (unit != m_activeTextureUnit)
+			{
+				glActiveTexture(GL_TEXTURE0 + unit);
+				m_activeTextureUnit = unit;
+			}
+			glBindTexture(target, command.handle);
+			if (unit < MAX_TEXTURE_UNITS)
+			{
+				m_boundTextures[unit] = command.handle;
+			}
+			frame.textureBinds++;
+			break;
+		}
+		case RenderCommandList::COMMAND_BIND_UNIFORM_BUFFER:
+			glBindBufferRange(GL_UNIFORM_BUFFER, command.arguments[0], command.handle,
+				(GLintptr)command.arguments[1], (GLsizeiptr)command.arguments[2]);
+			break;
+		case RenderCommandList::COMMAND_SET_INT:
+		case RenderCommandList::COMMAND_SET_FLOAT:
+		case RenderCommandList::COMMAND_SET_VEC2:
+		case RenderCommandList::COMMAND_SET_VEC3:
+		case RenderCommandList::COMMAND_SET_VEC4:
+		case RenderCommandList::COMMAND_SET_MAT4:
+			if (ApplyUniform(commands, command))
+			{
+				frame.uniformUploads++;
+			}
+			break;
+		case RenderCommandList::COMMAND_DRAW_SHAPE:
+			DrawShape(command.arguments[0], command.arguments[1]);
+			m_drawCount++;
+			if (NULL != m_pStatistics)
+			{
+				// the basic shapes bind their own vertex arrays
+				frame.drawCalls++;
+				frame.instances++;
+				frame.vertexArrayBinds++;
+				frame.triangles += (uint32_t)m_shapeGeometry.GetMesh(command.arguments[0], command.arguments[1]).indices.size() / 3;
+			}
+			break;
+		case RenderCommandList::COMMAND_DRAW:
+		{
+			std::unordered_map<GLuint, BUFFER_OBJECT>::const_iterator it = m_buffers.find(command.handle);
+			if ((it != m_buffers.end()) && (it->second.vertexArrayID != 0))
+			{
+				glBindVertexArray(it->second.vertexArrayID);
+				glDrawArrays(GL_TRIANGLES, (GLint)command.arguments[0], (GLsizei)command.arguments[1]);
+				glBindVertexArray(0);
+				m_drawCount++;
+				frame.drawCalls++;
+				frame.instances++;
+				frame.vertexArrayBinds++;
+				frame.triangles += command.arguments[1] / 3;
+			}
+			break;
+		}
+		case RenderCommandList::COMMAND_BEGIN_TIMER:
+			BeginTimer(commands.GetName(command));
+			break;
+		case RenderCommandList::COMMAND_END_TIMER:
+			EndTimer();
+			break;
+		}
+	}
+
+	if (NULL != m_pStatistics)
+	{
+		m_pStatistics->GetCurrentFrame() = frame;
+	}
+}
+
+/***********************************************************
+ *  EnableTimers()
+ *
+ *  This method is used for turning the timer commands on or
+ *  off.  Turning them off drops the queries still waiting,
+ *  and turning them on starts the statistics over.
+ ***********************************************************/
+void GLRenderDevice::EnableTimers(bool bEnable, size_t sampleCount)
+{
+	m_bTimersEnabled = bEnable;
+	if (bEnable)
+	{
+		m_timerStatistics = TimerStatistics(sampleCount);
+	}
+	if (!bEnable)
+	{
+		for (size_t i = 0; i < m_timerFrames.size(); i++)
+		{
+			m_timerFrames[i].usedCount = 0;
+			m_timerFrames[i].zones.clear();
+		}
+		m_openZones.clear();
+	}
+}
+
+/***********************************************************
+ *  WriteTimestamp()
+ *
+ *  This method is used for writing the GPU time into the
+ *  next free query of the current frame, made the first
+ *  time a frame needs that many.
+ ***********************************************************/
+GLuint GLRenderDevice::WriteTimestamp()
+{
+	TIMER_FRAME& frame = m_timerFrames[m_timerFrameIndex];
+	if (frame.usedCount == frame.queries.size())
+	{
+		GLuint queryID = 0;
+		glGenQueries(1, &queryID);
+		frame.queries.push_back(queryID);
+	}
+
+	GLuint queryID = frame.queries[frame.usedCount++];
+	glQueryCounter(queryID, GL_TIMESTAMP);
+	return(queryID);
+}
+
+/***********************************************************
+ *  BeginTimer()
+ *
+ *  This method is used for starting a timed range.  The
+ *  ranges are timed with timestamps instead of elapsed time
+ *  queries, since those can not be nested.
+ ***********************************************************/
+void GLRenderDevice::BeginTimer(const char* name)
+{
+	if (!m_bTimersEnabled)
+	{
+		return;
+	}
+
+	TIMER_FRAME& frame = m_timerFrames[m_timerFrameIndex];
+	std::set<std::string, std::less<> >::const_iterator it = m_timerNames.find(name);
+	if (it == m_timerNames.end())
+	{
+		it = m_timerNames.insert(name).first;
+	}
+
+	TIMER_ZONE zone;
+	zone.pName = &*it;
+	zone.beginQuery = WriteTimestamp();
+	zone.endQuery = 0;
+	m_openZones.push_back(frame.zones.size());
+	frame.zones.push_back(zone);
+}
+
+/***********************************************************
+ *  EndTimer()
+ *
+ *  This method is used for ending the range started last.
+ ***********************************************************/
+void GLRenderDevice::EndTimer()
+{
+	if (!m_bTimersEnabled || m_openZones.empty())
+	{
+		return;
+	}
+
+	TIMER_FRAME& frame = m_timerFrames[m_timerFrameIndex];
+	frame.zones[m_openZones.back()].endQuery = WriteTimestamp();
+	m_openZones.pop_back();
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for finishing the timers of the frame
+ *  and reading the results of the oldest one.  Its results
+ *  are only read when the GPU has finished them - otherwise
+ *  the frame is dropped rather than waiting for them.
+ ***********************************************************/
+void GLRenderDevice::EndFrame()
+{
+	if (!m_bTimersEnabled)
+	{
+		return;
+	}
+
+	// ranges still open at the end of a frame are not timed
+	m_openZones.clear();
+
+	m_timerFrameIndex = (m_timerFrameIndex + 1) % m_timerFrames.size();
+	TIMER_FRAME& frame = m_timerFrames[m_timerFrameIndex];
+	if (frame.usedCount > 0)
+	{
+		// the queries finish in order, so the last one being
+		// done means every one of the frame is
+		GLuint available = GL_FALSE;
+		glGetQueryObjectuiv(frame.queries[frame.usedCount - 1], GL_QUERY_RESULT_AVAILABLE, &available);
+		if (available == GL_TRUE)
+		{
+			ReadTimerFrame(frame);
+		}
+	}
+
+	frame.usedCount = 0;
+	frame.zones.clear();
+}
+
+/***********************************************************
+ *  FlushTimers()
+ *
+ *  This method is used for reading the timers of the frames
+ *  still waiting, such as at the end of a benchmark.  It
+ *  waits for the GPU to finish them.
+ ***********************************************************/
+void GLRenderDevice::FlushTimers()
+{
+	if (!m_bTimersEnabled)
+	{
+		return;
+	}
+
+	glFinish();
+	m_openZones.clear();
+	for (size_t i = 0; i < m_timerFrames.size(); i++)
+	{
+		// oldest frame first, so the samples stay in order
+		m_timerFrameIndex = (m_timerFrameIndex + 1) % m_timerFrames.size();
+		TIMER_FRAME& frame = m_timerFrames[m_timerFrameIndex];
+		ReadTimerFrame(frame);
+		frame.usedCount = 0;
+		frame.zones.clear();
+	}
+}
+
+/***********************************************************
+ *  ReadTimerFrame()
+ *
+ *  This method is used for adding the time of every closed
+ *  range of a frame to the statistics.
+ ***********************************************************/
+void GLRenderDevice::ReadTimerFrame(TIMER_FRAME& frame)
+{
+	for (size_t i = 0; i < frame.zones.size(); i++)
+	{
+		const TIMER_ZONE& zone = frame.zones[i];
+		if (zone.endQuery == 0)
+		{
+			continue;
+		}
+
+		GLuint64 beginTime = 0;
+		GLuint64 endTime = 0;
+		glGetQueryObjectui64v(zone.beginQuery, GL_QUERY_RESULT, &beginTime);
+		glGetQueryObjectui64v(zone.endQuery, GL_QUERY_RESULT, &endTime);
+		if (endTime >= beginTime)
+		{
+			m_timerStatistics.AddSample(*zone.pName, (double)(endTime - beginTime) / 1000000.0);
+		}
+	}
+}
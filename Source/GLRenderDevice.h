@@ -0,0 +1,177 @@
+///////////////////////////////////////////////////////////////////////////////
+// glrenderdevice.h
+// ============
+// run the render device objects and command lists with OpenGL
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+#include "RenderStatistics.h"
+#include "ShapeGeometry.h"
+#include "ShapeMeshes.h"
+#include "TimerStatistics.h"
+
+#include <GL/glew.h>
+
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  GLRenderDevice
+ *
+ *  This class is the OpenGL render device.  The handles are
+ *  the OpenGL object names, so nothing has to be looked up
+ *  to use them, and the uniforms are set on the shader
+ *  program the device was created with.  The basic shapes
+ *  are drawn with the ShapeMeshes vertex buffers.
+ *
+ *  With the timers enabled, the timer commands write GPU
+ *  timestamps, which are read back a few frames later so
+ *  the CPU never waits on the GPU for them.
+ ***********************************************************/
+class GLRenderDevice : public RenderDevice
+{
+public:
+	// constructor - needs the current context and the linked
+	// shader program everything is drawn with
+	GLRenderDevice(GLuint programID);
+	// destructor
+	virtual ~GLRenderDevice();
+
+	virtual RENDER_BUFFER CreateBuffer(const BUFFER_DESC& desc, const void* data);
+	virtual void UpdateBuffer(RENDER_BUFFER buffer, size_t offset, size_t size, const void* data);
+	virtual void CopyBuffer(RENDER_BUFFER source, RENDER_BUFFER destination, size_t size);
+	virtual void DestroyBuffer(RENDER_BUFFER buffer);
+	virtual size_t GetUniformBufferAlignment() const;
+
+	virtual RENDER_TEXTURE CreateTexture(const TEXTURE_DESC& desc, const void* const* data);
+	virtual void DestroyTexture(RENDER_TEXTURE texture);
+
+	virtual RENDER_TARGET CreateRenderTarget(int width, int height);
+	virtual bool ReadPixels(RENDER_TARGET target, int width, int height, void* pixels);
+	virtual void DestroyRenderTarget(RENDER_TARGET target);
+	virtual void GetWindowSize(int& width, int& height) const;
+
+	virtual RENDER_PIPELINE CreatePipeline(const PIPELINE_DESC& desc);
+	virtual void DestroyPipeline(RENDER_PIPELINE pipeline);
+
+	virtual void Submit(const RenderCommandList& commands);
+	virtual void EndFrame();
+
+	// create the vertex buffers of the basic shapes, which has
+	// to be done before any shape is drawn
+	void LoadBasicMeshes();
+
+	// run the timer commands - they are skipped while disabled -
+	// keeping the given number of samples of each timer
+	void EnableTimers(bool bEnable, size_t sampleCount = 240);
+	// wait for the GPU and read the timers still waiting
+	void FlushTimers();
+	const TimerStatistics& GetTimerStatistics() const { return(m_timerStatistics); }
+	// draws submitted since the device was created
+	uint64_t GetDrawCount() const { return(m_drawCount); }
+	// count the draws and state changes into the current frame
+	// of the statistics, NULL to stop counting
+	void SetStatistics(RenderStatistics* pStatistics) { m_pStatistics = pStatistics; }
+
+private:
+	struct BUFFER_OBJECT
+	{
+		GLenum target;
+		size_t size;
+		// attribute layout of a vertex buffer
+		GLuint vertexArrayID;
+	};
+
+	struct TARGET_OBJECT
+	{
+		GLuint colorBufferID;
+		GLuint depthBufferID;
+	};
+
+	// a timed range and its timestamp queries - the name is
+	// one of m_timerNames, so recording it does not allocate
+	struct TIMER_ZONE
+	{
+		const std::string* pName;
+		GLuint beginQuery;
+		GLuint endQuery;
+	};
+
+	// timestamp queries of a frame, kept and reused once their
+	// results are read
+	struct TIMER_FRAME
+	{
+		std::vector<GLuint> queries;
+		size_t usedCount;
+		std::vector<TIMER_ZONE> zones;
+	};
+
+	// shader program and the basic shapes, with the vertex
+	// arrays of the shapes whose buffers were measured
+	GLuint m_programID;
+	ShapeMeshes* m_basicMeshes;
+	std::vector<GLuint> m_basicMeshArrays;
+	// created objects by handle
+	std::unordered_map<GLuint, BUFFER_OBJECT> m_buffers;
+	std::unordered_map<GLuint, GLenum> m_textureTargets;
+	std::unordered_map<GLuint, TARGET_OBJECT> m_renderTargets;
+	// pipelines by handle - 1, destroyed ones are kept unused
+	std::vector<PIPELINE_DESC> m_pipelines;
+	// uniform locations looked up under each pipeline by
+	// handle, and under no pipeline at 0 - keyed by name, as
+	// the command lists do not keep their names
+	std::vector<std::map<std::string, GLint, std::less<> > > m_uniformLocations;
+	// viewport of the window when the device was created
+	int m_windowWidth;
+	int m_windowHeight;
+	GLint m_uniformBufferAlignment;
+	// pipeline whose state is set at the moment
+	RENDER_PIPELINE m_currentPipeline;
+	// program and textures bound at the moment, so binding
+	// them again is skipped and not counted - 0 when unknown
+	static const GLuint MAX_TEXTURE_UNITS = 32;
+	GLuint m_boundProgram;
+	GLuint m_boundTextures[MAX_TEXTURE_UNITS];
+	GLuint m_activeTextureUnit;
+	uint64_t m_drawCount;
+	RenderStatistics* m_pStatistics;
+	// triangles of the basic shapes, counted from the same
+	// shapes built in memory, since ShapeMeshes does not tell -
+	// only built once statistics are collected
+	ShapeGeometry m_shapeGeometry;
+
+	// frames of timer queries waiting for their results, the
+	// current frame, and the zones it has open
+	bool m_bTimersEnabled;
+	std::vector<TIMER_FRAME> m_timerFrames;
+	size_t m_timerFrameIndex;
+	std::vector<size_t> m_openZones;
+	// every name timed so far
+	std::set<std::string, std::less<> > m_timerNames;
+	TimerStatistics m_timerStatistics;
+
+	// set the fixed function state of a pipeline
+	void ApplyPipeline(RENDER_PIPELINE pipeline);
+	// set a uniform command on the shader program, false when
+	// the program does not use it
+	bool ApplyUniform(const RenderCommandList& commands, const RenderCommandList::COMMAND& command);
+	// location of a uniform, looked up once for each pipeline
+	GLint GetUniformLocation(const char* name);
+	// draw the parts of a basic shape
+	void DrawShape(uint32_t meshType, uint32_t parts);
+	// record the size of the buffers of the basic shape loaded
+	// last with the memory tracker
+	void TrackBasicMesh(const char* name);
+	// write a timestamp query of the current frame
+	GLuint WriteTimestamp();
+	void BeginTimer(const char* name);
+	void EndTimer();
+	// add the results of a frame to the statistics
+	void ReadTimerFrame(TIMER_FRAME& frame);
+};
@@ -0,0 +1,952 @@
+///////////////////////////////////////////////////////////////////////////////
+// glyphatlas.cpp
+// ============
+// signed distance field glyphs of a TrueType font packed into one texture
+///////////////////////////////////////////////////////////////////////////////
+
+#include "GlyphAtlas.h"
+#include "Profiler.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+// declaration of global variables
+namespace
+{
+	// identifies the cache file, bump the version whenever
+	// the generation changes so stale caches are rebuilt
+	const char CACHE_MAGIC[4] = { 'S', 'D', 'F', 'A' };
+	const uint32_t CACHE_VERSION = 1;
+
+	struct CACHE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t fontHash;
+		int32_t glyphSize;
+		int32_t spread;
+		int32_t width;
+		int32_t height;
+		float ascender;
+		float lineHeight;
+	};
+
+	// width of the atlas, the height follows from the packing
+	const int ATLAS_WIDTH = 512;
+	// empty texels kept between the glyphs of the atlas
+	const int GLYPH_GAP = 1;
+	// number of lines each quadratic curve is split into
+	const int CURVE_STEPS = 8;
+	// deepest nesting of composite glyphs that is followed
+	const int MAX_COMPOSITE_DEPTH = 4;
+
+	// straight piece of a glyph outline, in font units
+	struct SEGMENT
+	{
+		float x0;
+		float y0;
+		float x1;
+		float y1;
+	};
+
+	struct OUTLINE_POINT
+	{
+		float x;
+		float y;
+		bool bOnCurve;
+	};
+
+	// outline and atlas placement of one glyph
+	struct GLYPH_OUTLINE
+	{
+		std::vector<SEGMENT> segments;
+		int advance;
+		// texel box around the outline, in texels from the pen
+		int originX;
+		int originY;
+		int width;
+		int height;
+		int atlasX;
+		int atlasY;
+	};
+
+	// offsets of the TrueType tables the outlines are read from
+	struct FONT_TABLES
+	{
+		const unsigned char* data;
+		uint32_t size;
+		uint32_t cmap;
+		uint32_t glyf;
+		uint32_t head;
+		uint32_t hhea;
+		uint32_t hmtx;
+		uint32_t loca;
+		uint32_t maxp;
+		int unitsPerEm;
+		int indexToLocFormat;
+		int glyphCount;
+		int horizontalMetricCount;
+	};
+
+	/***********************************************************
+	 *  ReadU8() / ReadU16() / ReadS16() / ReadU32()
+	 *
+	 *  Read big endian font values, reads past the end of the
+	 *  file return 0 so a broken font cannot crash the parser.
+	 ***********************************************************/
+	uint32_t ReadU8(const FONT_TABLES& font, uint32_t offset)
+	{
+		return((offset < font.size) ? font.data[offset] : 0);
+	}
+	uint32_t ReadU16(const FONT_TABLES& font, uint32_t offset)
+	{
+		return((ReadU8(font, offset) << 8) | ReadU8(font, offset + 1));
+	}
+	int ReadS16(const FONT_TABLES& font, uint32_t offset)
+	{
+		return((int)(int16_t)ReadU16(font, offset));
+	}
+	uint32_t ReadU32(const FONT_TABLES& font, uint32_t offset)
+	{
+		return((ReadU16(font, offset) << 16) | ReadU16(font, offset + 2));
+	}
+	// 2.14 fixed point, used by the composite glyph scales
+	float ReadF2Dot14(const FONT_TABLES& font, uint32_t offset)
+	{
+		return((float)ReadS16(font, offset) / 16384.0f);
+	}
+
+	/***********************************************************
+	 *  OpenFont()
+	 *
+	 *  Find the tables of a TrueType font.  Fonts with CFF
+	 *  outlines (.otf) are not handled.
+	 ***********************************************************/
+	bool OpenFont(const std::vector<unsigned char>& fontData, FONT_TABLES& font)
+	{
+		memset(&font, 0, sizeof(font));
+		font.data = fontData.data();
+		font.size = (uint32_t)fontData.size();
+
+		uint32_t version = ReadU32(font, 0);
+		if ((version != 0x00010000) && (version != 0x74727565))
+		{
+			return(false);
+		}
+
+		int tableCount = (int)ReadU16(font, 4);
+		for (int i = 0; i < tableCount; i++)
+		{
+			uint32_t record = 12 + i * 16;
+			if (record + 16 > font.size)
+			{
+				return(false);
+			}
+			uint32_t offset = ReadU32(font, record + 8);
+			if (memcmp(font.data + record, "cmap", 4) == 0) font.cmap = offset;
+			else if (memcmp(font.data + record, "glyf", 4) == 0) font.glyf = offset;
+			else if (memcmp(font.data + record, "head", 4) == 0) font.head = offset;
+			else if (memcmp(font.data + record, "hhea", 4) == 0) font.hhea = offset;
+			else if (memcmp(font.data + record, "hmtx", 4) == 0) font.hmtx = offset;
+			else if (memcmp(font.data + record, "loca", 4) == 0) font.loca = offset;
+			else if (memcmp(font.data + record, "maxp", 4) == 0) font.maxp = offset;
+		}
+
+		if ((font.cmap == 0) || (font.glyf == 0) || (font.head == 0) || (font.hhea == 0) ||
+			(font.hmtx == 0) || (font.loca == 0) || (font.maxp == 0))
+		{
+			return(false);
+		}
+
+		font.unitsPerEm = (int)ReadU16(font, font.head + 18);
+		font.indexToLocFormat = ReadS16(font, font.head + 50);
+		font.glyphCount = (int)ReadU16(font, font.maxp + 4);
+		font.horizontalMetricCount = (int)ReadU16(font, font.hhea + 34);
+
+		return((font.unitsPerEm > 0) && (font.horizontalMetricCount > 0));
+	}
+
+	/***********************************************************
+	 *  FindGlyphIndex()
+	 *
+	 *  Map a character to a glyph with the Unicode format 4
+	 *  character map, 0 is the font's missing glyph.
+	 ***********************************************************/
+	int FindGlyphIndex(const FONT_TABLES& font, uint32_t character)
+	{
+		int subtableCount = (int)ReadU16(font, font.cmap + 2);
+		for (int i = 0; i < subtableCount; i++)
+		{
+			uint32_t record = font.cmap + 4 + i * 8;
+			uint32_t platform = ReadU16(font, record);
+			uint32_t encoding = ReadU16(font, record + 2);
+			uint32_t subtable = font.cmap + ReadU32(font, record + 4);
+			bool bUnicode = (platform == 0) || ((platform == 3) && (encoding == 1));
+			if (!bUnicode || (ReadU16(font, subtable) != 4))
+			{
+				continue;
+			}
+
+			uint32_t segmentCountX2 = ReadU16(font, subtable + 6);
+			uint32_t endCodes = subtable + 14;
+			uint32_t startCodes = endCodes + segmentCountX2 + 2;
+			uint32_t deltas = startCodes + segmentCountX2;
+			uint32_t rangeOffsets = deltas + segmentCountX2;
+			for (uint32_t segment = 0; segment < segmentCountX2; segment += 2)
+			{
+				if (ReadU16(font, endCodes + segment) < character)
+				{
+					continue;
+				}
+				uint32_t startCode = ReadU16(font, startCodes + segment);
+				if (startCode > character)
+				{
+					break;
+				}
+
+				uint32_t delta = ReadU16(font, deltas + segment);
+				uint32_t rangeOffset = ReadU16(font, rangeOffsets + segment);
+				if (rangeOffset == 0)
+				{
+					return((int)((character + delta) & 0xFFFF));
+				}
+				uint32_t glyph = ReadU16(font, rangeOffsets + segment + rangeOffset + (character - startCode) * 2);
+				return((glyph == 0) ? 0 : (int)((glyph + delta) & 0xFFFF));
+			}
+		}
+
+		return(0);
+	}
+
+	/***********************************************************
+	 *  GetAdvance()
+	 *
+	 *  Get the horizontal advance of a glyph in font units.
+	 ***********************************************************/
+	int GetAdvance(const FONT_TABLES& font, int glyph)
+	{
+		// glyphs past the last metric share its advance
+		int metric = std::min(glyph, font.horizontalMetricCount - 1);
+		return((int)ReadU16(font, font.hmtx + metric * 4));
+	}
+
+	/***********************************************************
+	 *  AddCurve()
+	 *
+	 *  Split a quadratic curve into lines.
+	 ***********************************************************/
+	void AddCurve(const OUTLINE_POINT& start, const OUTLINE_POINT& control, const OUTLINE_POINT& end, std::vector<SEGMENT>& segments)
+	{
+		float previousX = start.x;
+		float previousY = start.y;
+		for (int step = 1; step <= CURVE_STEPS; step++)
+		{
+			float t = (float)step / CURVE_STEPS;
+			float s = 1.0f - t;
+			SEGMENT segment;
+			segment.x0 = previousX;
+			segment.y0 = previousY;
+			segment.x1 = s * s * start.x + 2.0f * s * t * control.x + t * t * end.x;
+			segment.y1 = s * s * start.y + 2.0f * s * t * control.y + t * t * end.y;
+			segments.push_back(segment);
+			previousX = segment.x1;
+			previousY = segment.y1;
+		}
+	}
+
+	/***********************************************************
+	 *  AddContour()
+	 *
+	 *  Turn one closed contour of on-curve and off-curve points
+	 *  into lines.  Two off-curve points in a row have an
+	 *  implied on-curve point halfway between them.
+	 ***********************************************************/
+	void AddContour(const std::vector<OUTLINE_POINT>& points, std::vector<SEGMENT>& segments)
+	{
+		int count = (int)points.size();
+		if (count < 2)
+		{
+			return;
+		}
+
+		// start on an on-curve point, or between the last and
+		// first point when all of them are off the curve
+		int first = -1;
+		for (int i = 0; (i < count) && (first < 0); i++)
+		{
+			if (points[i].bOnCurve)
+			{
+				first = i;
+			}
+		}
+
+		OUTLINE_POINT start;
+		int visitCount = count;
+		if (first >= 0)
+		{
+			start = points[first];
+			visitCount = count - 1;
+		}
+		else
+		{
+			start.x = (points[count - 1].x + points[0].x) * 0.5f;
+			start.y = (points[count - 1].y + points[0].y) * 0.5f;
+			start.bOnCurve = true;
+			first = -1;
+		}
+
+		OUTLINE_POINT current = start;
+		OUTLINE_POINT control = start;
+		bool bHasControl = false;
+		for (int k = 1; k <= visitCount; k++)
+		{
+			const OUTLINE_POINT& point = points[(first + k + count) % count];
+			if (point.bOnCurve)
+			{
+				if (bHasControl)
+				{
+					AddCurve(current, control, point, segments);
+				}
+				else
+				{
+					SEGMENT segment = { current.x, current.y, point.x, point.y };
+					segments.push_back(segment);
+				}
+				current = point;
+				bHasControl = false;
+			}
+			else
+			{
+				if (bHasControl)
+				{
+					OUTLINE_POINT middle;
+					middle.x = (control.x + point.x) * 0.5f;
+					middle.y = (control.y + point.y) * 0.5f;
+					middle.bOnCurve = true;
+					AddCurve(current, control, middle, segments);
+					current = middle;
+				}
+				control = point;
+				bHasControl = true;
+			}
+		}
+
+		// close the contour
+		if (bHasControl)
+		{
+			AddCurve(current, control, start, segments);
+		}
+		else if ((current.x != start.x) || (current.y != start.y))
+		{
+			SEGMENT segment = { current.x, current.y, start.x, start.y };
+			segments.push_back(segment);
+		}
+	}
+
+	/***********************************************************
+	 *  GetGlyphOutline()
+	 *
+	 *  Read the outline of a glyph as lines, transformed by
+	 *  x' = t0 x + t2 y + t4 and y' = t1 x + t3 y + t5.
+	 *  Composite glyphs add the outlines of their components.
+	 ***********************************************************/
+	bool GetGlyphOutline(const FONT_TABLES& font, int glyph, const float transform[6], int depth, std::vector<SEGMENT>& segments)
+	{
+		if ((glyph < 0) || (glyph >= font.glyphCount) || (depth > MAX_COMPOSITE_DEPTH))
+		{
+			return(false);
+		}
+
+		uint32_t start;
+		uint32_t end;
+		if (font.indexToLocFormat == 0)
+		{
+			start = ReadU16(font, font.loca + glyph * 2) * 2;
+			end = ReadU16(font, font.loca + glyph * 2 + 2) * 2;
+		}
+		else
+		{
+			start = ReadU32(font, font.loca + glyph * 4);
+			end = ReadU32(font, font.loca + glyph * 4 + 4);
+		}
+		// glyphs like the space have no outline at all
+		if (end <= start)
+		{
+			return(true);
+		}
+
+		uint32_t offset = font.glyf + start;
+		int contourCount = ReadS16(font, offset);
+
+		if (contourCount < 0)
+		{
+			uint32_t p = offset + 10;
+			uint32_t flags;
+			do
+			{
+				flags = ReadU16(font, p);
+				int component = (int)ReadU16(font, p + 2);
+				p += 4;
+
+				float dx;
+				float dy;
+				if (flags & 0x0001)
+				{
+					dx = (float)ReadS16(font, p);
+					dy = (float)ReadS16(font, p + 2);
+					p += 4;
+				}
+				else
+				{
+					dx = (float)(int8_t)ReadU8(font, p);
+					dy = (float)(int8_t)ReadU8(font, p + 1);
+					p += 2;
+				}
+				// components placed by matching points are drawn unmoved
+				if ((flags & 0x0002) == 0)
+				{
+					dx = 0.0f;
+					dy = 0.0f;
+				}
+
+				float a = 1.0f;
+				float b = 0.0f;
+				float c = 0.0f;
+				float d = 1.0f;
+				if (flags & 0x0008)
+				{
+					a = d = ReadF2Dot14(font, p);
+					p += 2;
+				}
+				else if (flags & 0x0040)
+				{
+					a = ReadF2Dot14(font, p);
+					d = ReadF2Dot14(font, p + 2);
+					p += 4;
+				}
+				else if (flags & 0x0080)
+				{
+					a = ReadF2Dot14(font, p);
+					b = ReadF2Dot14(font, p + 2);
+					c = ReadF2Dot14(font, p + 4);
+					d = ReadF2Dot14(font, p + 6);
+					p += 8;
+				}
+
+				// the component transform is applied before the parent one
+				float combined[6] = {
+					transform[0] * a + transform[2] * b,
+					transform[1] * a + transform[3] * b,
+					transform[0] * c + transform[2] * d,
+					transform[1] * c + transform[3] * d,
+					transform[0] * dx + transform[2] * dy + transform[4],
+					transform[1] * dx + transform[3] * dy + transform[5] };
+				if (!GetGlyphOutline(font, component, combined, depth + 1, segments))
+				{
+					return(false);
+				}
+			} while (flags & 0x0020);
+
+			return(true);
+		}
+
+		uint32_t p = offset + 10;
+		std::vector<int> endPoints(contourCount);
+		for (int i = 0; i < contourCount; i++)
+		{
+			endPoints[i] = (int)ReadU16(font, p);
+			p += 2;
+			if ((i > 0) && (endPoints[i] <= endPoints[i - 1]))
+			{
+				return(false);
+			}
+		}
+		int pointCount = (contourCount > 0) ? endPoints[contourCount - 1] + 1 : 0;
+		// skip the hinting instructions
+		p += 2 + ReadU16(font, p);
+
+		std::vector<unsigned char> pointFlags(pointCount);
+		for (int i = 0; i < pointCount; i++)
+		{
+			unsigned char flag = (unsigned char)ReadU8(font, p++);
+			pointFlags[i] = flag;
+			if (flag & 0x08)
+			{
+				int repeatCount = (int)ReadU8(font, p++);
+				while ((repeatCount-- > 0) && (i + 1 < pointCount))
+				{
+					pointFlags[++i] = flag;
+				}
+			}
+		}
+
+		// the coordinates are stored as deltas, short ones as a
+		// byte with the sign in the flags
+		std::vector<OUTLINE_POINT> points(pointCount);
+		int value = 0;
+		for (int i = 0; i < pointCount; i++)
+		{
+			if (pointFlags[i] & 0x02)
+			{
+				int delta = (int)ReadU8(font, p++);
+				value += (pointFlags[i] & 0x10) ? delta : -delta;
+			}
+			else if ((pointFlags[i] & 0x10) == 0)
+			{
+				value += ReadS16(font, p);
+				p += 2;
+			}
+			points[i].x = (float)value;
+			points[i].bOnCurve = (pointFlags[i] & 0x01) != 0;
+		}
+		value = 0;
+		for (int i = 0; i < pointCount; i++)
+		{
+			if (pointFlags[i] & 0x04)
+			{
+				int delta = (int)ReadU8(font, p++);
+				value += (pointFlags[i] & 0x20) ? delta : -delta;
+			}
+			else if ((pointFlags[i] & 0x20) == 0)
+			{
+				value += ReadS16(font, p);
+				p += 2;
+			}
+			points[i].y = (float)value;
+		}
+
+		for (int i = 0; i < pointCount; i++)
+		{
+			float x = points[i].x;
+			float y = points[i].y;
+			points[i].x = transform[0] * x + transform[2] * y + transform[4];
+			points[i].y = transform[1] * x + transform[3] * y + transform[5];
+		}
+
+		int contourStart = 0;
+		for (int i = 0; i < contourCount; i++)
+		{
+			std::vector<OUTLINE_POINT> contour(points.begin() + contourStart, points.begin() + endPoints[i] + 1);
+			AddContour(contour, segments);
+			contourStart = endPoints[i] + 1;
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  RenderGlyphField()
+	 *
+	 *  Fill the atlas texels of one glyph with the distance to
+	 *  the nearest outline segment, positive inside the glyph.
+	 *  Inside is decided with the nonzero winding rule, so the
+	 *  direction the font draws its contours does not matter.
+	 ***********************************************************/
+	void RenderGlyphField(const GLYPH_OUTLINE& glyph, float scale, int spread, int atlasWidth, unsigned char* pixels)
+	{
+		for (int row = 0; row < glyph.height; row++)
+		{
+			float y = (glyph.originY + row + 0.5f) / scale;
+			unsigned char* texel = pixels + (size_t)(glyph.atlasY + row) * atlasWidth + glyph.atlasX;
+
+			for (int column = 0; column < glyph.width; column++)
+			{
+				float x = (glyph.originX + column + 0.5f) / scale;
+				float nearest = 1e30f;
+				int winding = 0;
+
+				for (size_t i = 0; i < glyph.segments.size(); i++)
+				{
+					const SEGMENT& segment = glyph.segments[i];
+					float dx = segment.x1 - segment.x0;
+					float dy = segment.y1 - segment.y0;
+					float lengthSquared = dx * dx + dy * dy;
+					float t = 0.0f;
+					if (lengthSquared > 0.0f)
+					{
+						t = ((x - segment.x0) * dx + (y - segment.y0) * dy) / lengthSquared;
+						t = std::min(std::max(t, 0.0f), 1.0f);
+					}
+					float ex = segment.x0 + t * dx - x;
+					float ey = segment.y0 + t * dy - y;
+					nearest = std::min(nearest, ex * ex + ey * ey);
+
+					// crossings of a ray from the texel towards +x
+					if ((segment.y0 <= y) != (segment.y1 <= y))
+					{
+						float crossing = segment.x0 + (y - segment.y0) * dx / dy;
+						if (crossing > x)
+						{
+							winding += (dy > 0.0f) ? 1 : -1;
+						}
+					}
+				}
+
+				float distance = std::sqrt(nearest) * scale;
+				if (winding == 0)
+				{
+					distance = -distance;
+				}
+				float value = 0.5f + distance / (2.0f * spread);
+				value = std::min(std::max(value, 0.0f), 1.0f);
+				texel[column] = (unsigned char)(value * 255.0f + 0.5f);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  HashData()
+	 *
+	 *  FNV-1a hash of the font file, so a cache is rebuilt when
+	 *  another font is used.
+	 ***********************************************************/
+	uint32_t HashData(const std::vector<unsigned char>& data)
+	{
+		uint32_t hash = 2166136261u;
+		for (size_t i = 0; i < data.size(); i++)
+		{
+			hash = (hash ^ data[i]) * 16777619u;
+		}
+		return(hash);
+	}
+}
+
+/***********************************************************
+ *  GlyphAtlas()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+GlyphAtlas::GlyphAtlas()
+{
+	m_glyphSize = 0;
+	m_spread = 0;
+	m_fontHash = 0;
+	m_width = 0;
+	m_height = 0;
+	m_ascender = 0.0f;
+	m_lineHeight = 0.0f;
+	m_pDevice = NULL;
+	m_textureID = 0;
+	memset(m_glyphs, 0, sizeof(m_glyphs));
+}
+
+/***********************************************************
+ *  ~GlyphAtlas()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+GlyphAtlas::~GlyphAtlas()
+{
+	m_pixels.clear();
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for getting the atlas ready, either
+ *  from the cache file or by generating it from the font.
+ ***********************************************************/
+bool GlyphAtlas::Load(const char* fontFilename, const char* cacheFilename, int glyphSize, int spread)
+{
+	PROFILE_SCOPE("GlyphAtlas::Load");
+	m_glyphSize = glyphSize;
+	m_spread = spread;
+
+	std::ifstream fontFile(fontFilename, std::ios::binary);
+	if (!fontFile.is_open())
+	{
+		std::cout << "Could not open font file:" << fontFilename << std::endl;
+		return(false);
+	}
+	std::vector<unsigned char> fontData(
+		(std::istreambuf_iterator<char>(fontFile)),
+		std::istreambuf_iterator<char>());
+	m_fontHash = HashData(fontData);
+
+	if (ReadCache(cacheFilename))
+	{
+		std::cout << "Successfully loaded glyph atlas cache:" << cacheFilename << std::endl;
+		return(true);
+	}
+
+	if (!Generate(fontData))
+	{
+		std::cout << "Could not read the glyph outlines of font file:" << fontFilename << std::endl;
+		return(false);
+	}
+
+	if (!WriteCache(cacheFilename))
+	{
+		std::cout << "Could not write glyph atlas cache:" << cacheFilename << std::endl;
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Generate()
+ *
+ *  This method is used for reading the glyph outlines,
+ *  packing their boxes into rows of the atlas and then
+ *  computing the distance fields, one glyph per work item.
+ ***********************************************************/
+bool GlyphAtlas::Generate(const std::vector<unsigned char>& fontData)
+{
+	FONT_TABLES font;
+	if (!OpenFont(fontData, font))
+	{
+		return(false);
+	}
+
+	float scale = (float)m_glyphSize / font.unitsPerEm;
+	const float identity[6] = { 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f };
+	std::vector<GLYPH_OUTLINE> outlines(CHARACTER_COUNT);
+
+	for (int i = 0; i < CHARACTER_COUNT; i++)
+	{
+		GLYPH_OUTLINE& outline = outlines[i];
+		int glyph = FindGlyphIndex(font, (uint32_t)(FIRST_CHARACTER + i));
+		outline.advance = GetAdvance(font, glyph);
+		outline.originX = 0;
+		outline.originY = 0;
+		outline.width = 0;
+		outline.height = 0;
+		outline.atlasX = 0;
+		outline.atlasY = 0;
+		if (!GetGlyphOutline(font, glyph, identity, 0, outline.segments) || outline.segments.empty())
+		{
+			outline.segments.clear();
+			continue;
+		}
+
+		float xMin = outline.segments[0].x0;
+		float xMax = xMin;
+		float yMin = outline.segments[0].y0;
+		float yMax = yMin;
+		for (size_t s = 0; s < outline.segments.size(); s++)
+		{
+			xMin = std::min(xMin, outline.segments[s].x1);
+			xMax = std::max(xMax, outline.segments[s].x1);
+			yMin = std::min(yMin, outline.segments[s].y1);
+			yMax = std::max(yMax, outline.segments[s].y1);
+		}
+
+		// leave room for the field around the outline
+		int left = (int)std::floor(xMin * scale);
+		int bottom = (int)std::floor(yMin * scale);
+		outline.originX = left - m_spread;
+		outline.originY = bottom - m_spread;
+		outline.width = (int)std::ceil(xMax * scale) - left + 2 * m_spread;
+		outline.height = (int)std::ceil(yMax * scale) - bottom + 2 * m_spread;
+	}
+
+	// pack the tallest glyphs first, row by row
+	std::vector<int> order(CHARACTER_COUNT);
+	for (int i = 0; i < CHARACTER_COUNT; i++)
+	{
+		order[i] = i;
+	}
+	std::stable_sort(order.begin(), order.end(), [&outlines](int a, int b)
+	{
+		return(outlines[a].height > outlines[b].height);
+	});
+
+	int x = 0;
+	int y = 0;
+	int rowHeight = 0;
+	for (int i = 0; i < CHARACTER_COUNT; i++)
+	{
+		GLYPH_OUTLINE& outline = outlines[order[i]];
+		if (outline.width == 0)
+		{
+			continue;
+		}
+		if (outline.width > ATLAS_WIDTH)
+		{
+			return(false);
+		}
+		if (x + outline.width > ATLAS_WIDTH)
+		{
+			x = 0;
+			y += rowHeight + GLYPH_GAP;
+			rowHeight = 0;
+		}
+		outline.atlasX = x;
+		outline.atlasY = y;
+		x += outline.width + GLYPH_GAP;
+		rowHeight = std::max(rowHeight, outline.height);
+	}
+
+	m_width = ATLAS_WIDTH;
+	m_height = std::max((y + rowHeight + 3) & ~3, 4);
+	m_pixels.assign((size_t)m_width * m_height, 0);
+
+	// each glyph only writes its own box of the atlas
+	ParallelFor(CHARACTER_COUNT, [&](int i)
+	{
+		RenderGlyphField(outlines[i], scale, m_spread, m_width, m_pixels.data());
+	});
+
+	for (int i = 0; i < CHARACTER_COUNT; i++)
+	{
+		const GLYPH_OUTLINE& outline = outlines[i];
+		GLYPH& glyph = m_glyphs[i];
+		glyph.advance = (float)outline.advance / font.unitsPerEm;
+		glyph.left = (float)outline.originX / m_glyphSize;
+		glyph.bottom = (float)outline.originY / m_glyphSize;
+		glyph.right = (float)(outline.originX + outline.width) / m_glyphSize;
+		glyph.top = (float)(outline.originY + outline.height) / m_glyphSize;
+		glyph.u0 = (float)outline.atlasX / m_width;
+		glyph.v0 = (float)outline.atlasY / m_height;
+		glyph.u1 = (float)(outline.atlasX + outline.width) / m_width;
+		glyph.v1 = (float)(outline.atlasY + outline.height) / m_height;
+	}
+
+	float ascender = (float)ReadS16(font, font.hhea + 4);
+	float descender = (float)ReadS16(font, font.hhea + 6);
+	float lineGap = (float)ReadS16(font, font.hhea + 8);
+	m_ascender = ascender / font.unitsPerEm;
+	m_lineHeight = (ascender - descender + lineGap) / font.unitsPerEm;
+
+	return(true);
+}
+
+/***********************************************************
+ *  GetGlyph()
+ *
+ *  This method is used for getting the placement of the
+ *  glyph of a character.
+ ***********************************************************/
+const GlyphAtlas::GLYPH& GlyphAtlas::GetGlyph(char character) const
+{
+	int index = (int)(unsigned char)character - FIRST_CHARACTER;
+	if ((index < 0) || (index >= CHARACTER_COUNT))
+	{
+		index = '?' - FIRST_CHARACTER;
+	}
+	return(m_glyphs[index]);
+}
+
+/***********************************************************
+ *  ReadCache()
+ *
+ *  This method is used for reading a previously generated
+ *  atlas, as long as it was made from the same font file
+ *  with the same settings.
+ ***********************************************************/
+bool GlyphAtlas::ReadCache(const char* cacheFilename)
+{
+	std::ifstream cacheFile(cacheFilename, std::ios::binary);
+	if (!cacheFile.is_open())
+	{
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	cacheFile.read((char*)&header, sizeof(header));
+	if (!cacheFile ||
+		(memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0) ||
+		(header.version != CACHE_VERSION) ||
+		(header.fontHash != m_fontHash) ||
+		(header.glyphSize != m_glyphSize) ||
+		(header.spread != m_spread) ||
+		(header.width != ATLAS_WIDTH) ||
+		(header.height <= 0) || (header.height > 16384))
+	{
+		return(false);
+	}
+
+	cacheFile.read((char*)m_glyphs, sizeof(m_glyphs));
+	m_pixels.resize((size_t)header.width * header.height);
+	cacheFile.read((char*)m_pixels.data(), m_pixels.size());
+	if (!cacheFile)
+	{
+		m_pixels.clear();
+		return(false);
+	}
+
+	m_width = header.width;
+	m_height = header.height;
+	m_ascender = header.ascender;
+	m_lineHeight = header.lineHeight;
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteCache()
+ *
+ *  This method is used for saving the generated atlas so the
+ *  following launches can skip the generation.
+ ***********************************************************/
+bool GlyphAtlas::WriteCache(const char* cacheFilename)
+{
+	std::ofstream cacheFile(cacheFilename, std::ios::binary | std::ios::trunc);
+	if (!cacheFile.is_open())
+	{
+		return(false);
+	}
+
+	CACHE_HEADER header;
+	memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+	header.version = CACHE_VERSION;
+	header.fontHash = m_fontHash;
+	header.glyphSize = m_glyphSize;
+	header.spread = m_spread;
+	header.width = m_width;
+	header.height = m_height;
+	header.ascender = m_ascender;
+	header.lineHeight = m_lineHeight;
+
+	cacheFile.write((const char*)&header, sizeof(header));
+	cacheFile.write((const char*)m_glyphs, sizeof(m_glyphs));
+	cacheFile.write((const char*)m_pixels.data(), m_pixels.size());
+
+	return(cacheFile.good());
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for uploading the atlas into a single
+ *  channel texture.  The mipmaps keep small text from
+ *  shimmering, the field stays valid when it is averaged.
+ ***********************************************************/
+RENDER_TEXTURE GlyphAtlas::CreateTexture(RenderDevice* pDevice)
+{
+	if ((NULL == pDevice) || m_pixels.empty())
+	{
+		return(0);
+	}
+
+	DestroyTexture();
+
+	RenderDevice::TEXTURE_DESC desc = RenderDevice::GetTextureDesc(RenderDevice::FORMAT_R8, m_width, m_height);
+	desc.bGenerateMipmaps = true;
+	desc.bMipmapFiltering = true;
+	const void* levels[1] = { m_pixels.data() };
+
+	m_pDevice = pDevice;
+	m_textureID = m_pDevice->CreateTexture(desc, levels);
+
+	return(m_textureID);
+}
+
+/***********************************************************
+ *  DestroyTexture()
+ *
+ *  This method is used for freeing the texture.
+ ***********************************************************/
+void GlyphAtlas::DestroyTexture()
+{
+	if (m_textureID != 0)
+	{
+		m_pDevice->DestroyTexture(m_textureID);
+		m_textureID = 0;
+	}
+}
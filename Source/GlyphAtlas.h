@@ -0,0 +1,99 @@
+///////////////////////////////////////////////////////////////////////////////
+// glyphatlas.h
+// ============
+// signed distance field glyphs of a TrueType font packed into one texture
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  GlyphAtlas
+ *
+ *  This class turns the printable ASCII glyphs of a TrueType
+ *  font into signed distance fields, packed into a single
+ *  channel texture.  The distances are measured to the glyph
+ *  outlines themselves, on all CPU cores, and the atlas is
+ *  cached to disk so it is only generated once per font.
+ *  Text sampled from it stays sharp at any size.
+ ***********************************************************/
+class GlyphAtlas
+{
+public:
+	// constructor
+	GlyphAtlas();
+	// destructor
+	~GlyphAtlas();
+
+	// characters held in the atlas
+	static const int FIRST_CHARACTER = 32;
+	static const int LAST_CHARACTER = 126;
+	static const int CHARACTER_COUNT = LAST_CHARACTER - FIRST_CHARACTER + 1;
+
+	// placement of one glyph - all sizes are in em units, so
+	// they are scaled by the font size of the text
+	struct GLYPH
+	{
+		// horizontal distance to the next glyph
+		float advance;
+		// quad around the glyph, relative to the pen position
+		float left;
+		float bottom;
+		float right;
+		float top;
+		// texture coordinates of the quad
+		float u0;
+		float v0;
+		float u1;
+		float v1;
+	};
+
+	// read the atlas from the cache file, or generate it from
+	// the font and write the cache file when it is out of date
+	bool Load(const char* fontFilename, const char* cacheFilename, int glyphSize = 48, int spread = 6);
+
+	// upload the atlas into a single channel texture
+	RENDER_TEXTURE CreateTexture(RenderDevice* pDevice);
+	// free the texture
+	void DestroyTexture();
+	RENDER_TEXTURE GetTextureID() const { return(m_textureID); }
+
+	// get a glyph of the atlas, characters outside of it get
+	// the glyph of '?'
+	const GLYPH& GetGlyph(char character) const;
+	// font metrics in em units
+	float GetAscender() const { return(m_ascender); }
+	float GetLineHeight() const { return(m_lineHeight); }
+	// distance values, bottom row first
+	int GetWidth() const { return(m_width); }
+	int GetHeight() const { return(m_height); }
+	const unsigned char* GetPixels() const { return(m_pixels.data()); }
+
+private:
+	// pixels per em the glyphs are generated at, and the
+	// distance in pixels covered by the field around the edges
+	int m_glyphSize;
+	int m_spread;
+	// hash of the font file the atlas was generated from
+	uint32_t m_fontHash;
+	// atlas size and distance values, 128 on the outlines
+	int m_width;
+	int m_height;
+	std::vector<unsigned char> m_pixels;
+	GLYPH m_glyphs[CHARACTER_COUNT];
+	float m_ascender;
+	float m_lineHeight;
+	// texture holding the atlas, and the device it is on
+	RenderDevice* m_pDevice;
+	RENDER_TEXTURE m_textureID;
+
+	// generate every glyph of the font into the atlas
+	bool Generate(const std::vector<unsigned char>& fontData);
+	// read and write the cache file
+	bool ReadCache(const char* cacheFilename);
+	bool WriteCache(const char* cacheFilename);
+};
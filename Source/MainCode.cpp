@@ -9,6 +9,11 @@
 
 #include <iostream>         // error handling and output
 #include <cstdlib>          // EXIT_FAILURE
+#include <cstring>          // strcmp
+#include <string>           // generated scene file name
+#include <vector>           // scene file list
+#include <algorithm>        // std::max
+#include <chrono>           // software render timing
 
 #include <GL/glew.h>        // GLEW library
 #include "GLFW/glfw3.h"     // GLFW library
@@ -22,6 +27,26 @@
 #include "ViewManager.h"
 #include "ShapeMeshes.h"
 #include "ShaderManager.h"
+#include "GLRenderDevice.h"
+#include "SpirvShaderLoader.h"
+#include "SceneFile.h"
+#include "VariantBatch.h"
+#include "SoftwareRenderDevice.h"
+#include "PathTracer.h"
+#include "NullRenderDevice.h"
+#include "RegressionSuite.h"
+#include "Profiler.h"
+#include "VulkanRenderDevice.h"
+#include "Benchmark.h"
+#include "MicroBenchmark.h"
+#include "RenderStatistics.h"
+#include "MemoryTracker.h"
+#include "StartupTimeline.h"
+#include "PerformanceHud.h"
+#include "StressSceneGenerator.h"
+#include "CaptureRenderDevice.h"
+#include "CommandReplay.h"
+#include "FrameArena.h"
 
 // Namespace for declaring global variables
 namespace
@@ -30,6 +55,8 @@ namespace
 	const char* const WINDOW_TITLE = "7-1 FinalProject and Milestones"; 
 	// software version number
 	const char* const SW_VERSION = "20240902SMGA135";
+	// frames between the reports of the GPU timers
+	const int GPU_TIMER_REPORT_FRAMES = 300;
 
 	// Main GLFW window
 	GLFWwindow* g_Window = nullptr;
@@ -40,12 +67,31 @@ namespace
 	ShaderManager* g_ShaderManager = nullptr;
 	// view manager object for managing the 3D view setup and projection to 2D
 	ViewManager* g_ViewManager = nullptr;
+	// render device the scene is drawn with
+	RenderDevice* g_RenderDevice = nullptr;
+	// clear and view settings recorded every frame
+	RenderCommandList g_FrameCommands;
+	// loader for the precompiled SPIR-V shader program variants,
+	// which owns the programs it creates
+	SpirvShaderLoader* g_SpirvLoader = nullptr;
+	// program linked from the GLSL files when no SPIR-V program
+	// could be used - ShaderManager does not delete it
+	GLuint g_GlslProgramID = 0;
 }
 
 // Function declarations - all functions that are called manually
 // need to be pre-declared at the beginning of the source code.
 bool InitializeGLFW();
 bool InitializeGLEW();
+void DestroyShaders();
+bool RenderSoftwareFrame(SoftwareRenderDevice& device, SceneManager& sceneManager, const char* sceneFilename, bool bUsePBR);
+bool RenderSoftware(const char* sceneFilename, const char* imageFilename, bool bUsePBR);
+bool RenderPathTraced(const char* sceneFilename, const char* imageFilename, int sampleCount);
+bool RenderNullDevice(const char* sceneFilename, int frameCount, const char* traceFilename, bool bUsePBR);
+bool ReplayCapture(const char* captureFilename, int loopCount);
+#ifdef RENDER_DEVICE_VULKAN
+bool RenderVulkan(const char* sceneFilename, const char* imageFilename, int frameCount, bool bUsePBR);
+#endif
 
 
 /***********************************************************
@@ -56,6 +102,272 @@ bool InitializeGLEW();
  ***********************************************************/
 int main(int argc, char* argv[])
 {
+	// command line options
+	bool bUsePBR = false;
+	std::vector<const char*> sceneFilenames;
+	int stressObjects = 0;
+	std::string stressFilename;
+	const char* variantFilename = NULL;
+	const char* softwareImageFilename = NULL;
+	const char* pathTracedImageFilename = NULL;
+	int pathTracedSamples = 256;
+	int nullDeviceFrames = 0;
+	const char* traceFilename = NULL;
+	const char* regressionFilename = NULL;
+	bool bUpdateGoldens = false;
+#ifdef RENDER_DEVICE_VULKAN
+	const char* vulkanImageFilename = NULL;
+	int vulkanFrames = 100;
+#endif
+	int profileFrames = 0;
+	const char* profileFilename = NULL;
+	bool bGpuTimers = false;
+	bool bGpuObjectTimers = false;
+	int benchmarkFrames = 0;
+	bool bMicroBenchmark = false;
+	const char* statisticsFilename = NULL;
+	RenderStatistics renderStatistics;
+	RenderStatistics* pStatistics = NULL;
+	const char* microBenchmarkFilter = NULL;
+	const char* benchmarkFilename = NULL;
+	bool bBenchmarkWritten = true;
+	int captureFirstFrame = 0;
+	int captureFrames = 0;
+	const char* captureFilename = NULL;
+	const char* replayFilename = NULL;
+	int replayLoops = 3;
+	bool bCheckAllocations = false;
+	// start of the startup timeline, and of the startup time of
+	// the benchmark report
+	StartupTimeline::Start();
+	for (int i = 1; i < argc; i++)
+	{
+		// --pbr - use the metallic-roughness shading
+		if (strcmp(argv[i], "--pbr") == 0)
+		{
+			bUsePBR = true;
+		}
+		// --scene <file> - render the layout from a scene file, the
+		// option can be repeated to keep several scenes loaded
+		else if ((strcmp(argv[i], "--scene") == 0) && (i + 1 < argc))
+		{
+			sceneFilenames.push_back(argv[++i]);
+		}
+		// --variants <file> - render the variants listed in the
+		// file into image files and exit
+		else if ((strcmp(argv[i], "--variants") == 0) && (i + 1 < argc))
+		{
+			variantFilename = argv[++i];
+		}
+		// --software <image file> - render the first scene file, or
+		// the built in layout, on the CPU into an image file and
+		// exit without a window
+		else if ((strcmp(argv[i], "--software") == 0) && (i + 1 < argc))
+		{
+			softwareImageFilename = argv[++i];
+		}
+		// --pathtrace <image file> - path trace the first scene file,
+		// or the built in layout, into an image file and exit,
+		// --samples <count> sets the samples per pixel
+		else if ((strcmp(argv[i], "--pathtrace") == 0) && (i + 1 < argc))
+		{
+			pathTracedImageFilename = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--samples") == 0) && (i + 1 < argc))
+		{
+			pathTracedSamples = atoi(argv[++i]);
+		}
+		// --null-device <frame count> - render frames of the first
+		// scene file, or the built in layout, with a device that
+		// only counts the work, to measure the CPU cost of a frame
+		// without a window - --trace <file> also records the
+		// submitted commands
+		else if ((strcmp(argv[i], "--null-device") == 0) && (i + 1 < argc))
+		{
+			nullDeviceFrames = atoi(argv[++i]);
+		}
+		else if ((strcmp(argv[i], "--trace") == 0) && (i + 1 < argc))
+		{
+			traceFilename = argv[++i];
+		}
+		// --regression <file> - render the views listed in the file
+		// without a window, compare them to their golden images
+		// and budgets, and exit with a failure if any is off -
+		// --update-goldens writes the images as the golden images
+		else if ((strcmp(argv[i], "--regression") == 0) && (i + 1 < argc))
+		{
+			regressionFilename = argv[++i];
+		}
+		else if (strcmp(argv[i], "--update-goldens") == 0)
+		{
+			bUpdateGoldens = true;
+		}
+#ifdef RENDER_DEVICE_VULKAN
+		// --vulkan <image file> - render frames of the first scene
+		// file, or the built in layout, with the Vulkan device
+		// without a window and save the last one - --vulkan-frames
+		// <count> sets the number of frames
+		else if ((strcmp(argv[i], "--vulkan") == 0) && (i + 1 < argc))
+		{
+			vulkanImageFilename = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--vulkan-frames") == 0) && (i + 1 < argc))
+		{
+			vulkanFrames = std::max(atoi(argv[++i]), 1);
+		}
+#endif
+		// --profile <frame count> <file> - time the zones of the
+		// first frames and write them as a Chrome trace
+		else if ((strcmp(argv[i], "--profile") == 0) && (i + 2 < argc))
+		{
+			profileFrames = atoi(argv[++i]);
+			profileFilename = argv[++i];
+		}
+		// --gpu-timers - time the render passes on the GPU and
+		// report the averages and percentiles on the console -
+		// --gpu-timers-objects also times every object group
+		else if (strcmp(argv[i], "--gpu-timers") == 0)
+		{
+			bGpuTimers = true;
+		}
+		else if (strcmp(argv[i], "--gpu-timers-objects") == 0)
+		{
+			bGpuTimers = true;
+			bGpuObjectTimers = true;
+		}
+		// --benchmark <frame count> <file> - play a fixed camera
+		// path through the first scene file, or the built in
+		// layout, and write the frame times as a JSON report
+		else if ((strcmp(argv[i], "--benchmark") == 0) && (i + 2 < argc))
+		{
+			benchmarkFrames = atoi(argv[++i]);
+			benchmarkFilename = argv[++i];
+		}
+		// --microbench [filter] - time the hot scene functions on
+		// their own, only the cases whose names contain the
+		// filter if one is given, and exit
+		else if (strcmp(argv[i], "--microbench") == 0)
+		{
+			bMicroBenchmark = true;
+			if ((i + 1 < argc) && (strncmp(argv[i + 1], "--", 2) != 0))
+			{
+				microBenchmarkFilter = argv[++i];
+			}
+		}
+		// --stats-csv <file> - count the draws, binds, uploads and
+		// stage times of every frame and write them as CSV rows
+		else if ((strcmp(argv[i], "--stats-csv") == 0) && (i + 1 < argc))
+		{
+			statisticsFilename = argv[++i];
+		}
+		// --stress <object count> - generate a grid of copies of
+		// the wedding table with that many objects, and show it
+		// before the other scene files
+		else if ((strcmp(argv[i], "--stress") == 0) && (i + 1 < argc))
+		{
+			stressObjects = atoi(argv[++i]);
+		}
+		// --capture <first frame> <frame count> <file> - write the
+		// render device calls of the frames, and the shaders and
+		// data they use, into a capture file
+		else if ((strcmp(argv[i], "--capture") == 0) && (i + 3 < argc))
+		{
+			captureFirstFrame = atoi(argv[++i]);
+			captureFrames = atoi(argv[++i]);
+			captureFilename = argv[++i];
+		}
+		// --replay <file> - play the frames of a capture file in a
+		// window and time them, --replay-loops <count> sets how
+		// many times after a warm up loop
+		else if ((strcmp(argv[i], "--replay") == 0) && (i + 1 < argc))
+		{
+			replayFilename = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--replay-loops") == 0) && (i + 1 < argc))
+		{
+			replayLoops = std::max(atoi(argv[++i]), 1);
+		}
+		// --check-allocations - stop at an assert when a frame
+		// of the render loop allocates from the heap once it is
+		// warmed up, in debug builds
+		else if (strcmp(argv[i], "--check-allocations") == 0)
+		{
+			bCheckAllocations = true;
+		}
+		// --compile-scene <text file> <binary file> - convert a
+		// scene file offline and exit without opening a window
+		else if ((strcmp(argv[i], "--compile-scene") == 0) && (i + 2 < argc))
+		{
+			bool bCompiled = SceneFile::Compile(argv[i + 1], argv[i + 2]);
+			return(bCompiled ? EXIT_SUCCESS : EXIT_FAILURE);
+		}
+	}
+
+	if (stressObjects > 0)
+	{
+		StressSceneGenerator stressGenerator;
+		stressFilename = "scenes/stress_" + std::to_string(stressObjects) + ".sceneb";
+		if (!stressGenerator.LoadTemplate("scenes/wedding_table.scene") ||
+			!stressGenerator.Write((uint32_t)stressObjects, stressFilename.c_str()))
+		{
+			return(EXIT_FAILURE);
+		}
+		sceneFilenames.insert(sceneFilenames.begin(), stressFilename.c_str());
+	}
+
+	// the CPU renderers do not need OpenGL at all
+	if ((NULL != softwareImageFilename) || (NULL != pathTracedImageFilename))
+	{
+		const char* sceneFilename = sceneFilenames.empty() ? NULL : sceneFilenames[0];
+		bool bRendered = true;
+		if (NULL != softwareImageFilename)
+		{
+			bRendered = RenderSoftware(sceneFilename, softwareImageFilename, bUsePBR) && bRendered;
+		}
+		if (NULL != pathTracedImageFilename)
+		{
+			bRendered = RenderPathTraced(sceneFilename, pathTracedImageFilename, pathTracedSamples) && bRendered;
+		}
+		return(bRendered ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+	if (bMicroBenchmark)
+	{
+		MicroBenchmark microBenchmark;
+		return(microBenchmark.Run(microBenchmarkFilter) ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+	if (NULL != regressionFilename)
+	{
+		RegressionSuite regressionSuite;
+		bool bPassed = regressionSuite.Load(regressionFilename) && regressionSuite.Run(bUsePBR, bUpdateGoldens);
+		return(bPassed ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+	// start before the loading, so it is part of the first frame
+	Profiler::StartCapture(profileFrames, profileFilename);
+	if (bCheckAllocations && !FrameArena::EnableAllocationCheck(true))
+	{
+		return(EXIT_FAILURE);
+	}
+
+	if (nullDeviceFrames > 0)
+	{
+		const char* sceneFilename = sceneFilenames.empty() ? NULL : sceneFilenames[0];
+		bool bRendered = RenderNullDevice(sceneFilename, nullDeviceFrames, traceFilename, bUsePBR);
+		return(bRendered ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+#ifdef RENDER_DEVICE_VULKAN
+	if (NULL != vulkanImageFilename)
+	{
+		const char* sceneFilename = sceneFilenames.empty() ? NULL : sceneFilenames[0];
+		bool bRendered = RenderVulkan(sceneFilename, vulkanImageFilename, vulkanFrames, bUsePBR);
+		return(bRendered ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+#endif
+	if (NULL != replayFilename)
+	{
+		bool bReplayed = ReplayCapture(replayFilename, replayLoops);
+		return(bReplayed ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
 	// if GLFW fails initialization, then terminate the application
 	if (InitializeGLFW() == false)
 	{
@@ -65,11 +377,12 @@ int main(int argc, char* argv[])
 	// try to create a new shader manager object
 	g_ShaderManager = new ShaderManager();
 	// try to create a new view manager object
-	g_ViewManager = new ViewManager(
-		g_ShaderManager);
+	g_ViewManager = new ViewManager();
 
 	// try to create the main display window
+	StartupPhase windowPhase("CreateDisplayWindow");
 	g_Window = g_ViewManager->CreateDisplayWindow(WINDOW_TITLE);
+	windowPhase.Stop();
 	// print the version to the console
 	std::cout << std::endl << "Version: " << SW_VERSION << std::endl;
 
@@ -79,19 +392,123 @@ int main(int argc, char* argv[])
 		return(EXIT_FAILURE);
 	}
 
-	// load the shader code from the external GLSL files
-	g_ShaderManager->LoadShaders(
-		"shaders/vertexShader.glsl",
-		"shaders/fragmentShader.glsl");
-	g_ShaderManager->use();
+	// try the precompiled SPIR-V modules first, since specializing
+	// them at load time skips the driver's GLSL compile
+	StartupPhase shaderPhase("LoadShaders");
+	GLuint spirvProgram = 0;
+	g_SpirvLoader = new SpirvShaderLoader();
+	if (g_SpirvLoader->IsSupported())
+	{
+		SpirvShaderLoader::SPECIALIZATION_INFO specialization;
+		specialization.activePointLights = 5;
+		specialization.bTexturingEnabled = true;
+		specialization.bLightingEnabled = true;
 
-	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
-	g_SceneManager->PrepareScene();
+		spirvProgram = g_SpirvLoader->LoadProgram(
+			"shaders/spirv/vertexShader.spv",
+			"shaders/spirv/fragmentShader.spv",
+			specialization);
+	}
+
+	GLuint programID = spirvProgram;
+	if (spirvProgram != 0)
+	{
+		std::cout << "INFO: Using precompiled SPIR-V shaders\n";
+	}
+	else
+	{
+		// load the shader code from the external GLSL files
+		g_ShaderManager->LoadShaders(
+			"shaders/vertexShader.glsl",
+			"shaders/fragmentShader.glsl");
+		g_GlslProgramID = g_ShaderManager->m_programID;
+		programID = g_GlslProgramID;
+	}
+	shaderPhase.Stop();
+
+	// everything is drawn through the OpenGL render device,
+	// with the shader program that was just loaded
+	StartupPhase devicePhase("CreateRenderDevice");
+	GLRenderDevice* pGLDevice = new GLRenderDevice(programID);
+	devicePhase.Stop();
+	StartupPhase meshPhase("LoadBasicMeshes");
+	pGLDevice->LoadBasicMeshes();
+	meshPhase.Stop();
+	pGLDevice->EnableTimers(bGpuTimers);
+	g_RenderDevice = pGLDevice;
+	if (NULL != captureFilename)
+	{
+		// the capture device sees everything from the loading
+		// on, so it can start at any frame
+		CaptureRenderDevice* pCaptureDevice = new CaptureRenderDevice(pGLDevice);
+		g_RenderDevice = pCaptureDevice;
+		if (!pCaptureDevice->SetShaderSources("shaders/vertexShader.glsl", "shaders/fragmentShader.glsl") ||
+			!pCaptureDevice->StartCapture(captureFirstFrame, captureFrames, captureFilename))
+		{
+			delete g_RenderDevice;
+			delete g_ViewManager;
+			DestroyShaders();
+			glfwTerminate();
+			return(EXIT_FAILURE);
+		}
+	}
 
 	// try to create a new scene manager object and prepare the 3D scene
-	g_SceneManager = new SceneManager(g_ShaderManager);
+	g_SceneManager = new SceneManager(g_RenderDevice);
 	g_SceneManager->PrepareScene();
+	g_SceneManager->SetPBRShading(bUsePBR);
+	g_SceneManager->SetObjectGroupTimers(bGpuObjectTimers);
+	if ((NULL != statisticsFilename) && renderStatistics.OpenCSV(statisticsFilename))
+	{
+		pStatistics = &renderStatistics;
+		pGLDevice->SetStatistics(pStatistics);
+		g_SceneManager->SetStatistics(pStatistics);
+	}
+	if (NULL != variantFilename)
+	{
+		// the batch renders offscreen, the window is not needed
+		glfwHideWindow(g_Window);
+
+		VariantBatch variantBatch;
+		bool bRendered = variantBatch.Load(variantFilename) &&
+			variantBatch.Run(g_RenderDevice, g_SceneManager, g_ViewManager);
+
+		delete g_SceneManager;
+		delete g_ViewManager;
+		delete g_RenderDevice;
+		DestroyShaders();
+		glfwTerminate();
+		return(bRendered ? EXIT_SUCCESS : EXIT_FAILURE);
+	}
+
+	if (!sceneFilenames.empty())
+	{
+		// show the first scene right away, falling back to the
+		// built in layout if the file is unusable, and load the
+		// others in the background for switching with the number keys
+		StartupPhase sceneFilePhase("LoadSceneFile");
+		g_SceneManager->LoadSceneFile(sceneFilenames[0]);
+		sceneFilePhase.Stop();
+		for (size_t i = 1; i < sceneFilenames.size(); i++)
+		{
+			g_SceneManager->PreloadSceneFile(sceneFilenames[i]);
+		}
+	}
+
+	MemoryTracker::PrintSummary();
+
+	if (benchmarkFrames > 0)
+	{
+		Benchmark benchmark;
+		benchmark.SetStartupTime(StartupTimeline::GetElapsedTime());
+		if (!sceneFilenames.empty())
+		{
+			benchmark.SetSceneName(sceneFilenames[0]);
+		}
+		bBenchmarkWritten = benchmark.Run(g_Window, pGLDevice, g_SceneManager, benchmarkFrames, benchmarkFilename);
+		// skip the main loop
+		glfwSetWindowShouldClose(g_Window, GLFW_TRUE);
+	}
 
 	std::cout << "\n***** KEY FUNCTIONS: *****\n";
 	std::cout << "ESC - close the window and exit\n";
@@ -105,32 +522,114 @@ int main(int argc, char* argv[])
 	std::cout << "U - top orthographic view\n";
 	std::cout << "P - perspective view\n";
 	std::cout << "Mouse Wheel Scroll to Zoom In/Out\n";
+	std::cout << "0 - built in scene\t" << "1-9 - loaded scene files\n";
+	std::cout << "H - show/hide the performance HUD\n";
+
+	// frame time graph and counters drawn over the scene
+	PerformanceHud performanceHud;
+	if (performanceHud.Create(g_RenderDevice))
+	{
+		g_SceneManager->SetPerformanceHud(&performanceHud);
+	}
+	std::chrono::steady_clock::time_point lastFrameTime = std::chrono::steady_clock::now();
 
 
 	// loop will keep running until the application is closed 
 	// or until an error has occurred
+	int frameIndex = 0;
+	// the first frame is a phase of its own, since the driver
+	// finishes compiling the shaders on their first draws
+	StartupPhase firstFramePhase("FirstFrame");
 	while (!glfwWindowShouldClose(g_Window))
 	{
-		// Enable z-depth
-		glEnable(GL_DEPTH_TEST);
+		// the HUD shows the counters of the statistics, which
+		// are collected from the first time it is shown
+		performanceHud.SetVisible(g_ViewManager->IsHudVisible());
+		if (performanceHud.IsVisible() && (NULL == pStatistics))
+		{
+			FrameArena::ExpectAllocations();
+			pStatistics = &renderStatistics;
+			pGLDevice->SetStatistics(pStatistics);
+			g_SceneManager->SetStatistics(pStatistics);
+		}
 
+		StageTimer viewTimer(pStatistics, RenderStatistics::STAGE_VIEW);
 		// Clear the frame and z buffers
-		glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
-		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		g_FrameCommands.Reset();
+		g_FrameCommands.BeginTimer("Clear");
+		g_FrameCommands.Clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+		g_FrameCommands.EndTimer();
 
 		// convert from 3D object space to 2D view
-		g_ViewManager->PrepareSceneView();
+		g_ViewManager->PrepareSceneView(g_FrameCommands);
+		g_RenderDevice->Submit(g_FrameCommands);
+		viewTimer.Stop();
+
+		// switch scenes, finish background loads and pick up
+		// edits to the scene file being shown
+		int sceneRequest = g_ViewManager->TakeSceneRequest();
+		if (sceneRequest != ViewManager::NO_SCENE_REQUEST)
+		{
+			g_SceneManager->SwitchScene(sceneRequest);
+		}
+		g_SceneManager->UpdateScenes();
 
 		// refresh the 3D scene
 		g_SceneManager->RenderScene();
 
+		{
+			PROFILE_SCOPE("glfwSwapBuffers");
+			StageTimer presentTimer(pStatistics, RenderStatistics::STAGE_PRESENT);
+			// Flips the the back buffer with the front buffer every frame.
+			glfwSwapBuffers(g_Window);
+		}
+		g_RenderDevice->EndFrame();
+		if (frameIndex == 0)
+		{
+			firstFramePhase.Stop();
+			StartupTimeline::Finish();
+		}
+		if (NULL != pStatistics)
+		{
+			pStatistics->EndFrame();
+		}
+		std::chrono::steady_clock::time_point frameEndTime = std::chrono::steady_clock::now();
+		std::chrono::duration<double, std::milli> frameTime = frameEndTime - lastFrameTime;
+		lastFrameTime = frameEndTime;
+		performanceHud.AddFrame(frameTime.count(), (NULL != pStatistics) ? &pStatistics->GetLastFrame() : NULL);
 
-		// Flips the the back buffer with the front buffer every frame.
-		glfwSwapBuffers(g_Window);
+		{
+			PROFILE_SCOPE("glfwPollEvents");
+			// query the latest GLFW events
+			glfwPollEvents();
+		}
+		// the zones of a profile are kept until it is written
+		if (Profiler::IsCapturing())
+		{
+			FrameArena::ExpectAllocations();
+		}
+		Profiler::EndFrame();
 
-		// query the latest GLFW events
-		glfwPollEvents();
+		frameIndex++;
+		if (bGpuTimers && ((frameIndex % GPU_TIMER_REPORT_FRAMES) == 0))
+		{
+			FrameArena::ExpectAllocations();
+			pGLDevice->GetTimerStatistics().Print("GPU timers");
+		}
+		FrameArena::EndFrame();
 	}
+	// the window can close before the first frame is shown
+	firstFramePhase.Stop();
+	StartupTimeline::Finish();
+	if (bGpuTimers)
+	{
+		pGLDevice->GetTimerStatistics().Print("GPU timers");
+	}
+	MemoryTracker::PrintSummary();
+	// exit() skips the destructors of main()
+	renderStatistics.CloseCSV();
+	g_SceneManager->SetPerformanceHud(NULL);
+	performanceHud.Destroy();
 
 	// clear the allocated manager objects from memory
 	if (NULL != g_SceneManager)
@@ -143,14 +642,17 @@ int main(int argc, char* argv[])
 		delete g_ViewManager;
 		g_ViewManager = NULL;
 	}
-	if (NULL != g_ShaderManager)
+	if (NULL != g_RenderDevice)
 	{
-		delete g_ShaderManager;
-		g_ShaderManager = NULL;
+		delete g_RenderDevice;
+		g_RenderDevice = NULL;
 	}
+	DestroyShaders();
+	// everything recorded should have been freed by now
+	MemoryTracker::ReportLeaks();
 
 	// Terminates the program successfully
-	exit(EXIT_SUCCESS); 
+	exit(bBenchmarkWritten ? EXIT_SUCCESS : EXIT_FAILURE); 
 }
 
 /***********************************************************
@@ -160,6 +662,7 @@ int main(int argc, char* argv[])
  ***********************************************************/
 bool InitializeGLFW()
 {
+	STARTUP_PHASE("InitializeGLFW");
 	// GLFW: initialize and configure library
 	// --------------------------------------
 	glfwInit();
@@ -187,6 +690,7 @@ bool InitializeGLFW()
  ***********************************************************/
 bool InitializeGLEW()
 {
+	STARTUP_PHASE("InitializeGLEW");
 	// GLEW: initialize
 	// -----------------------------------------
 	GLenum GLEWInitResult = GLEW_OK;
@@ -206,3 +710,343 @@ bool InitializeGLEW()
 
 	return(true);
 }
+
+/***********************************************************
+ *	DestroyShaders()
+ *
+ *  This function is used to free the shader program the
+ *  scene was drawn with, once nothing uses it anymore.  The
+ *  SPIR-V loader frees the programs it created itself.
+ ***********************************************************/
+void DestroyShaders()
+{
+	if (g_GlslProgramID != 0)
+	{
+		glDeleteProgram(g_GlslProgramID);
+		g_GlslProgramID = 0;
+	}
+	if (NULL != g_ShaderManager)
+	{
+		delete g_ShaderManager;
+		g_ShaderManager = NULL;
+	}
+	if (NULL != g_SpirvLoader)
+	{
+		delete g_SpirvLoader;
+		g_SpirvLoader = NULL;
+	}
+}
+
+/***********************************************************
+ *	RenderSoftwareFrame()
+ *
+ *  This function is used to record one frame of a scene file,
+ *  or of the built in layout when there is none, from the
+ *  default camera on the software render device, the same
+ *  way the window records it on the OpenGL device.
+ ***********************************************************/
+bool RenderSoftwareFrame(SoftwareRenderDevice& device, SceneManager& sceneManager, const char* sceneFilename, bool bUsePBR)
+{
+	int width = 0;
+	int height = 0;
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 viewPosition;
+	ViewManager::GetDefaultView(width, height, view, projection, viewPosition);
+
+	sceneManager.PrepareScene();
+	sceneManager.SetPBRShading(bUsePBR);
+	if ((NULL != sceneFilename) && !sceneManager.LoadSceneFile(sceneFilename))
+	{
+		return(false);
+	}
+
+	RenderCommandList frameCommands;
+	frameCommands.Clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	ViewManager::PrepareView(frameCommands, view, projection, viewPosition);
+	device.Submit(frameCommands);
+	sceneManager.RenderScene();
+
+	return(true);
+}
+
+/***********************************************************
+ *	RenderSoftware()
+ *
+ *  This function is used to render a scene file, or the
+ *  built in layout, with the software render device from
+ *  the default camera, and save the image.  No window or
+ *  OpenGL context is created.
+ ***********************************************************/
+bool RenderSoftware(const char* sceneFilename, const char* imageFilename, bool bUsePBR)
+{
+	int width = 0;
+	int height = 0;
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 viewPosition;
+	ViewManager::GetDefaultView(width, height, view, projection, viewPosition);
+
+	SoftwareRenderDevice device(width, height);
+	SceneManager sceneManager(&device);
+	if (!RenderSoftwareFrame(device, sceneManager, sceneFilename, bUsePBR))
+	{
+		return(false);
+	}
+
+	// the draws are rasterized when the image is read
+	std::vector<unsigned char> pixels((size_t)width * height * 4);
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	device.ReadPixels(0, width, height, pixels.data());
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << "INFO: Software render of "
+		<< ((NULL != sceneFilename) ? sceneFilename : "the built in scene") << ": "
+		<< device.GetDrawCount() << " draws, "
+		<< device.GetTriangleCount() << " triangles in "
+		<< elapsed.count() << " ms" << std::endl;
+
+	return(VariantBatch::WriteTGA(imageFilename, width, height, pixels));
+}
+
+/***********************************************************
+ *	RenderPathTraced()
+ *
+ *  This function is used to path trace a scene file, or the
+ *  built in layout, from the default camera.  The frame is
+ *  recorded on the software render device, which hands its
+ *  draws to the path tracer.  The image is saved whenever
+ *  the sample count doubles, so it can be looked at while it
+ *  refines.
+ ***********************************************************/
+bool RenderPathTraced(const char* sceneFilename, const char* imageFilename, int sampleCount)
+{
+	int width = 0;
+	int height = 0;
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 viewPosition;
+	ViewManager::GetDefaultView(width, height, view, projection, viewPosition);
+
+	// the PBR shading records the materials of every draw
+	SoftwareRenderDevice device(width, height);
+	SceneManager sceneManager(&device);
+	if (!RenderSoftwareFrame(device, sceneManager, sceneFilename, true))
+	{
+		return(false);
+	}
+
+	PathTracer pathTracer;
+	pathTracer.SetTarget(width, height);
+
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	device.BuildPathTracerScene(pathTracer);
+	std::chrono::duration<double, std::milli> buildTime = std::chrono::steady_clock::now() - start;
+	std::cout << "INFO: Path tracer scene of "
+		<< ((NULL != sceneFilename) ? sceneFilename : "the built in scene") << ": "
+		<< pathTracer.GetTriangleCount() << " triangles, "
+		<< pathTracer.GetNodeCount() << " nodes in "
+		<< buildTime.count() << " ms" << std::endl;
+
+	std::vector<unsigned char> pixels;
+	sampleCount = std::max(sampleCount, 1);
+	start = std::chrono::steady_clock::now();
+	for (int sample = 1; sample <= sampleCount; sample++)
+	{
+		pathTracer.RenderPass();
+		if (((sample & (sample - 1)) == 0) || (sample == sampleCount))
+		{
+			pathTracer.ResolvePixels(pixels);
+			if (!VariantBatch::WriteTGA(imageFilename, width, height, pixels))
+			{
+				return(false);
+			}
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+			std::cout << "INFO: Path traced " << sample << " of " << sampleCount
+				<< " samples in " << elapsed.count() << " ms" << std::endl;
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *	RenderNullDevice()
+ *
+ *  This function is used to render frames of a scene file,
+ *  or of the built in layout when there is none, with the
+ *  null render device, and report the CPU time and the work
+ *  submitted per frame.  Loading is not part of the counts.
+ ***********************************************************/
+bool RenderNullDevice(const char* sceneFilename, int frameCount, const char* traceFilename, bool bUsePBR)
+{
+	int width = 0;
+	int height = 0;
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 viewPosition;
+	ViewManager::GetDefaultView(width, height, view, projection, viewPosition);
+
+	NullRenderDevice device(width, height);
+	if ((NULL != traceFilename) && !device.StartTrace(traceFilename))
+	{
+		return(false);
+	}
+
+	SceneManager sceneManager(&device);
+	sceneManager.PrepareScene();
+	sceneManager.SetPBRShading(bUsePBR);
+	if ((NULL != sceneFilename) && !sceneManager.LoadSceneFile(sceneFilename))
+	{
+		return(false);
+	}
+	device.ResetCounters();
+
+	RenderCommandList frameCommands;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		frameCommands.Reset();
+		frameCommands.Clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+		ViewManager::PrepareView(frameCommands, view, projection, viewPosition);
+		device.Submit(frameCommands);
+
+		sceneManager.UpdateScenes();
+		sceneManager.RenderScene();
+		if (Profiler::IsCapturing())
+		{
+			FrameArena::ExpectAllocations();
+		}
+		Profiler::EndFrame();
+		FrameArena::EndFrame();
+	}
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	const NullRenderDevice::COUNTERS& counters = device.GetCounters();
+	double frames = (double)frameCount;
+	std::cout << "INFO: Null device render of "
+		<< ((NULL != sceneFilename) ? sceneFilename : "the built in scene") << ": "
+		<< frameCount << " frames in " << elapsed.count() << " ms, "
+		<< elapsed.count() / frames << " ms per frame" << std::endl;
+	std::cout << "INFO: Per frame: "
+		<< counters.drawCount / frames << " draws, "
+		<< counters.stateChangeCount / frames << " state changes ("
+		<< counters.redundantStateCount / frames << " redundant), "
+		<< counters.uniformCount / frames << " uniforms, "
+		<< counters.commandCount / frames << " commands, "
+		<< counters.bytesUploaded / frames << " bytes uploaded" << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *	ReplayCapture()
+ *
+ *  This function is used to play a capture file back in a
+ *  window of the size it was captured at, with the shaders
+ *  of the capture and none of the scene code, and print how
+ *  long the frames took then and now.
+ ***********************************************************/
+bool ReplayCapture(const char* captureFilename, int loopCount)
+{
+	CommandReplay replay;
+	if (!replay.Load(captureFilename) || !InitializeGLFW())
+	{
+		return(false);
+	}
+
+	GLFWwindow* window = glfwCreateWindow(
+		replay.GetWindowWidth(),
+		replay.GetWindowHeight(),
+		WINDOW_TITLE,
+		NULL, NULL);
+	if (window == NULL)
+	{
+		std::cout << "Failed to create GLFW window" << std::endl;
+		glfwTerminate();
+		return(false);
+	}
+	glfwMakeContextCurrent(window);
+	if (!InitializeGLEW())
+	{
+		glfwTerminate();
+		return(false);
+	}
+
+	bool bReplayed = false;
+	GLuint programID = replay.CreateProgram();
+	if (programID != 0)
+	{
+		GLRenderDevice* pDevice = new GLRenderDevice(programID);
+		pDevice->LoadBasicMeshes();
+		bReplayed = replay.Run(window, pDevice, loopCount);
+		delete pDevice;
+		glDeleteProgram(programID);
+	}
+	glfwTerminate();
+	return(bReplayed);
+}
+
+#ifdef RENDER_DEVICE_VULKAN
+/***********************************************************
+ *	RenderVulkan()
+ *
+ *  This function is used to render frames of a scene file,
+ *  or of the built in layout when there is none, with the
+ *  Vulkan render device, report the CPU time of recording
+ *  and submitting a frame, and save the last frame into an
+ *  image file.  It runs on the lavapipe CPU driver as well.
+ ***********************************************************/
+bool RenderVulkan(const char* sceneFilename, const char* imageFilename, int frameCount, bool bUsePBR)
+{
+	int width = 0;
+	int height = 0;
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 viewPosition;
+	ViewManager::GetDefaultView(width, height, view, projection, viewPosition);
+
+	VulkanRenderDevice device(width, height);
+	if (!device.Create("shaders/vulkan/scene.vert.spv", "shaders/vulkan/scene.frag.spv"))
+	{
+		return(false);
+	}
+
+	// destroyed before the device, which owns what it created
+	SceneManager sceneManager(&device);
+	sceneManager.PrepareScene();
+	sceneManager.SetPBRShading(bUsePBR);
+	if ((NULL != sceneFilename) && !sceneManager.LoadSceneFile(sceneFilename))
+	{
+		return(false);
+	}
+
+	RenderCommandList frameCommands;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < frameCount; frame++)
+	{
+		frameCommands.Reset();
+		frameCommands.SetRenderTarget(0);
+		frameCommands.Clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+		ViewManager::PrepareView(frameCommands, view, projection, viewPosition);
+		device.Submit(frameCommands);
+
+		sceneManager.UpdateScenes();
+		sceneManager.RenderScene();
+		device.EndFrame();
+	}
+	std::chrono::duration<double, std::milli> submitted = std::chrono::steady_clock::now() - start;
+
+	// reading the pixels waits for the frames still in flight
+	std::vector<unsigned char> pixels((size_t)width * height * 4);
+	bool bRead = device.ReadPixels(0, width, height, pixels.data());
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	std::cout << "INFO: Vulkan render of "
+		<< ((NULL != sceneFilename) ? sceneFilename : "the built in scene") << ": "
+		<< frameCount << " frames in " << elapsed.count() << " ms, "
+		<< submitted.count() / frameCount << " ms per frame to record and submit" << std::endl;
+
+	return(bRead && VariantBatch::WriteTGA(imageFilename, width, height, pixels));
+}
+#endif
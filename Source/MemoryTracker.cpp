@@ -0,0 +1,246 @@
+///////////////////////////////////////////////////////////////////////////////
+// memorytracker.cpp
+// ============
+// account for the GPU and host memory of the resources by category
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MemoryTracker.h"
+
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <utility>
+
+// declaration of global variables
+namespace
+{
+	const char* const g_CategoryNames[MemoryTracker::CATEGORY_COUNT] = {
+		"textures",
+		"render targets",
+		"vertex buffers",
+		"uniform buffers",
+		"shape meshes",
+		"decoded images",
+		"scene files",
+		"environment maps" };
+
+	struct ALLOCATION
+	{
+		size_t size;
+		std::string name;
+	};
+
+	std::mutex g_Mutex;
+	// live allocations by category and key
+	std::map<std::pair<int, uint64_t>, ALLOCATION> g_Allocations;
+	MemoryTracker::CATEGORY_SUMMARY g_Summaries[MemoryTracker::CATEGORY_COUNT];
+
+	/***********************************************************
+	 *  PrintBytes()
+	 *
+	 *  This function is used for writing a byte count in KB or
+	 *  MB, whichever reads better.
+	 ***********************************************************/
+	void PrintBytes(uint64_t bytes)
+	{
+		if (bytes >= 1024 * 1024)
+		{
+			std::cout << std::setw(10) << bytes / (1024.0 * 1024.0) << " MB";
+		}
+		else
+		{
+			std::cout << std::setw(10) << bytes / 1024.0 << " KB";
+		}
+	}
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for recording an allocation.  One
+ *  recorded again under the same key replaces the old one.
+ ***********************************************************/
+void MemoryTracker::Allocate(CATEGORY category, uint64_t key, size_t size, const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(g_Mutex);
+	CATEGORY_SUMMARY& summary = g_Summaries[category];
+
+	ALLOCATION allocation;
+	allocation.size = size;
+	allocation.name = name;
+	std::pair<std::map<std::pair<int, uint64_t>, ALLOCATION>::iterator, bool> result =
+		g_Allocations.insert(std::make_pair(std::make_pair((int)category, key), allocation));
+	if (!result.second)
+	{
+		summary.bytes -= result.first->second.size;
+		summary.count--;
+		result.first->second = allocation;
+	}
+
+	summary.bytes += size;
+	summary.count++;
+	if (summary.bytes > summary.peakBytes)
+	{
+		summary.peakBytes = summary.bytes;
+	}
+}
+
+/***********************************************************
+ *  Free()
+ *
+ *  This method is used for forgetting an allocation.
+ ***********************************************************/
+void MemoryTracker::Free(CATEGORY category, uint64_t key)
+{
+	std::lock_guard<std::mutex> lock(g_Mutex);
+	std::map<std::pair<int, uint64_t>, ALLOCATION>::iterator it = g_Allocations.find(std::make_pair((int)category, key));
+	if (it == g_Allocations.end())
+	{
+		return;
+	}
+
+	g_Summaries[category].bytes -= it->second.size;
+	g_Summaries[category].count--;
+	g_Allocations.erase(it);
+}
+
+/***********************************************************
+ *  Rename()
+ *
+ *  This method is used for changing the name an allocation
+ *  is listed with.
+ ***********************************************************/
+void MemoryTracker::Rename(CATEGORY category, uint64_t key, const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(g_Mutex);
+	std::map<std::pair<int, uint64_t>, ALLOCATION>::iterator it = g_Allocations.find(std::make_pair((int)category, key));
+	if (it != g_Allocations.end())
+	{
+		it->second.name = name;
+	}
+}
+
+/***********************************************************
+ *  GetSummary()
+ *
+ *  This method is used for getting the totals of a category.
+ ***********************************************************/
+MemoryTracker::CATEGORY_SUMMARY MemoryTracker::GetSummary(CATEGORY category)
+{
+	std::lock_guard<std::mutex> lock(g_Mutex);
+	return(g_Summaries[category]);
+}
+
+/***********************************************************
+ *  GetDeviceBytes()
+ *
+ *  This method is used for getting the GPU memory in use.
+ ***********************************************************/
+uint64_t MemoryTracker::GetDeviceBytes()
+{
+	std::lock_guard<std::mutex> lock(g_Mutex);
+	uint64_t bytes = 0;
+	for (int i = 0; i < CATEGORY_COUNT; i++)
+	{
+		if (IsDeviceCategory((CATEGORY)i))
+		{
+			bytes += g_Summaries[i].bytes;
+		}
+	}
+	return(bytes);
+}
+
+/***********************************************************
+ *  GetHostBytes()
+ *
+ *  This method is used for getting the tracked host memory
+ *  in use.
+ ***********************************************************/
+uint64_t MemoryTracker::GetHostBytes()
+{
+	std::lock_guard<std::mutex> lock(g_Mutex);
+	uint64_t bytes = 0;
+	for (int i = 0; i < CATEGORY_COUNT; i++)
+	{
+		if (!IsDeviceCategory((CATEGORY)i))
+		{
+			bytes += g_Summaries[i].bytes;
+		}
+	}
+	return(bytes);
+}
+
+/***********************************************************
+ *  GetCategoryName()
+ *
+ *  This method is used for getting the name of a category.
+ ***********************************************************/
+const char* MemoryTracker::GetCategoryName(CATEGORY category)
+{
+	return(g_CategoryNames[category]);
+}
+
+/***********************************************************
+ *  PrintSummary()
+ *
+ *  This method is used for writing the current and peak
+ *  memory of every category to the console.
+ ***********************************************************/
+void MemoryTracker::PrintSummary()
+{
+	std::ios_base::fmtflags flags = std::cout.flags();
+	std::streamsize precision = std::cout.precision();
+	std::cout << std::fixed << std::setprecision(1);
+
+	std::cout << "Memory by category" << std::endl;
+	std::cout << std::left << std::setw(20) << "category" << std::right
+		<< std::setw(8) << "count" << std::setw(13) << "current"
+		<< std::setw(13) << "peak" << std::endl;
+	for (int i = 0; i < CATEGORY_COUNT; i++)
+	{
+		CATEGORY_SUMMARY summary = GetSummary((CATEGORY)i);
+		std::cout << std::left << std::setw(20) << g_CategoryNames[i] << std::right
+			<< std::setw(8) << summary.count;
+		PrintBytes(summary.bytes);
+		PrintBytes(summary.peakBytes);
+		std::cout << std::endl;
+	}
+	std::cout << std::left << std::setw(28) << "GPU total" << std::right;
+	PrintBytes(GetDeviceBytes());
+	std::cout << std::endl;
+	std::cout << std::left << std::setw(28) << "host total" << std::right;
+	PrintBytes(GetHostBytes());
+	std::cout << std::endl;
+
+	std::cout.flags(flags);
+	std::cout.precision(precision);
+}
+
+/***********************************************************
+ *  ReportLeaks()
+ *
+ *  This method is used for listing the allocations that are
+ *  still recorded, meant to be called after everything was
+ *  supposed to be freed.
+ ***********************************************************/
+bool MemoryTracker::ReportLeaks()
+{
+	std::lock_guard<std::mutex> lock(g_Mutex);
+	if (g_Allocations.empty())
+	{
+		std::cout << "INFO: No leaked resources" << std::endl;
+		return(true);
+	}
+
+	uint64_t leakedBytes = 0;
+	std::map<std::pair<int, uint64_t>, ALLOCATION>::const_iterator it;
+	for (it = g_Allocations.begin(); it != g_Allocations.end(); ++it)
+	{
+		std::cout << "LEAK: " << g_CategoryNames[it->first.first] << " " << it->second.name
+			<< ", " << it->second.size << " bytes" << std::endl;
+		leakedBytes += it->second.size;
+	}
+	std::cout << "LEAK: " << g_Allocations.size() << " resources, " << leakedBytes << " bytes were never freed" << std::endl;
+	return(false);
+}
@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// memorytracker.h
+// ============
+// account for the GPU and host memory of the resources by category
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/***********************************************************
+ *  MemoryTracker
+ *
+ *  This class records every GPU object and every large host
+ *  allocation of the loaders with its category and size,
+ *  from its creation until it is freed.  It keeps the
+ *  current and peak totals of each category for a summary,
+ *  and at shutdown lists whatever was never freed.  The
+ *  records are locked, since images are decoded and scene
+ *  files opened on background threads.
+ ***********************************************************/
+class MemoryTracker
+{
+public:
+	enum CATEGORY
+	{
+		// GPU memory
+		CATEGORY_TEXTURE = 0,
+		CATEGORY_RENDER_TARGET,
+		CATEGORY_VERTEX_BUFFER,
+		CATEGORY_UNIFORM_BUFFER,
+		CATEGORY_SHAPE_MESH,
+		// host memory
+		CATEGORY_DECODED_IMAGE,
+		CATEGORY_SCENE_FILE,
+		CATEGORY_ENVIRONMENT_MAP,
+		CATEGORY_COUNT
+	};
+
+	// totals of a category, in bytes
+	struct CATEGORY_SUMMARY
+	{
+		uint64_t bytes;
+		uint64_t peakBytes;
+		uint32_t count;
+	};
+
+	// record an allocation - the key tells it apart from the
+	// others of its category, such as an object name or an
+	// address, and the name is shown in the leak report
+	static void Allocate(CATEGORY category, uint64_t key, size_t size, const std::string& name);
+	// forget an allocation, unknown ones are ignored
+	static void Free(CATEGORY category, uint64_t key);
+	// give an allocation a better name, such as the file a
+	// texture was loaded from
+	static void Rename(CATEGORY category, uint64_t key, const std::string& name);
+
+	static CATEGORY_SUMMARY GetSummary(CATEGORY category);
+	// current totals of the GPU and the host categories
+	static uint64_t GetDeviceBytes();
+	static uint64_t GetHostBytes();
+	static const char* GetCategoryName(CATEGORY category);
+	static bool IsDeviceCategory(CATEGORY category) { return(category < CATEGORY_DECODED_IMAGE); }
+
+	// write the totals of every category to the console
+	static void PrintSummary();
+	// write the allocations that were never freed to the
+	// console, false if there are any
+	static bool ReportLeaks();
+};
@@ -0,0 +1,325 @@
+///////////////////////////////////////////////////////////////////////////////
+// microbenchmark.cpp
+// ============
+// time the small functions on the hot paths of the scene code in isolation
+///////////////////////////////////////////////////////////////////////////////
+
+#include "MicroBenchmark.h"
+#include "ResourceCache.h"
+#include "SceneFile.h"
+#include "ShapeGeometry.h"
+#include "ViewManager.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <random>
+
+// declaration of global variables
+namespace
+{
+	// shortest time a case is run for before it is reported
+	const double MIN_CASE_SECONDS = 0.25;
+	// most a case is grown by between two timed runs
+	const double MAX_GROWTH = 10.0;
+	const int64_t MAX_ITERATIONS = 1000000000;
+
+	// most objects transformed in one iteration
+	const int MAX_OBJECTS = 10000;
+	// image files decoded by the decode case
+	const char* const g_DecodeFilenames[] = {
+		"textures/marble.jpg",
+		"textures/wood.jpg" };
+
+	// results are written here, so the compiler can not drop
+	// the work of a case
+	volatile int g_Sink = 0;
+}
+
+/***********************************************************
+ *  MicroBenchmark()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+MicroBenchmark::MicroBenchmark()
+{
+	m_pDevice = NULL;
+	m_pSceneManager = NULL;
+}
+
+/***********************************************************
+ *  ~MicroBenchmark()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+MicroBenchmark::~MicroBenchmark()
+{
+	delete m_pSceneManager;
+	m_pSceneManager = NULL;
+	delete m_pDevice;
+	m_pDevice = NULL;
+}
+
+/***********************************************************
+ *  Prepare()
+ *
+ *  This method is used for loading the textures and materials
+ *  of the built in layout, and making the inputs of the
+ *  cases.  The inputs come from a fixed seed, so every run
+ *  times the same work.
+ ***********************************************************/
+void MicroBenchmark::Prepare()
+{
+	int width = 0;
+	int height = 0;
+	glm::mat4 view;
+	glm::mat4 projection;
+	glm::vec3 viewPosition;
+	ViewManager::GetDefaultView(width, height, view, projection, viewPosition);
+
+	m_pDevice = new NullRenderDevice(width, height);
+	m_pSceneManager = new SceneManager(m_pDevice);
+	m_pSceneManager->LoadSceneTextures();
+	m_pSceneManager->DefineObjectMaterials();
+
+	// every loaded tag, then one that is not loaded, which
+	// walks the whole list
+	for (int i = 0; i < m_pSceneManager->m_loadedTextures; i++)
+	{
+		m_textureTags.push_back(m_pSceneManager->m_textureIDs[i].tag);
+	}
+	m_textureTags.push_back("missing_texture");
+	for (size_t i = 0; i < m_pSceneManager->m_objectMaterials.size(); i++)
+	{
+		m_materialTags.push_back(m_pSceneManager->m_objectMaterials[i].tag);
+	}
+	m_materialTags.push_back("missing_material");
+
+	std::mt19937 random(330);
+	std::uniform_real_distribution<float> scale(0.1f, 5.0f);
+	std::uniform_real_distribution<float> angle(-180.0f, 180.0f);
+	std::uniform_real_distribution<float> position(-10.0f, 10.0f);
+	m_transforms.resize(MAX_OBJECTS);
+	for (size_t i = 0; i < m_transforms.size(); i++)
+	{
+		m_transforms[i].scale = glm::vec3(scale(random), scale(random), scale(random));
+		m_transforms[i].rotation = glm::vec3(angle(random), angle(random), angle(random));
+		m_transforms[i].position = glm::vec3(position(random), position(random), position(random));
+	}
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for running the cases and writing a
+ *  line for each one - the time of an iteration, the number
+ *  of iterations it was timed over and, for the cases over
+ *  a number of items, the items per second.
+ ***********************************************************/
+bool MicroBenchmark::Run(const char* filter)
+{
+	const BENCHMARK_CASE cases[] = {
+		{ "SetTransformations", &MicroBenchmark::SetTransformations, 1, true },
+		{ "SetTransformations", &MicroBenchmark::SetTransformations, 100, true },
+		{ "SetTransformations", &MicroBenchmark::SetTransformations, MAX_OBJECTS, true },
+		{ "FindTextureSlot", &MicroBenchmark::FindTextureSlot, 1, true },
+		{ "FindTextureSlot", &MicroBenchmark::FindTextureSlot, 1000, true },
+		{ "FindTextureID", &MicroBenchmark::FindTextureID, 1, true },
+		{ "FindTextureID", &MicroBenchmark::FindTextureID, 1000, true },
+		{ "FindMaterial", &MicroBenchmark::FindMaterial, 1, true },
+		{ "FindMaterial", &MicroBenchmark::FindMaterial, 1000, true },
+		{ "DecodeImage", &MicroBenchmark::DecodeImage, 0, false },
+		{ "DecodeImage", &MicroBenchmark::DecodeImage, 1, false },
+		{ "BuildMesh", &MicroBenchmark::BuildMesh, SceneFile::MESH_BOX, false },
+		{ "BuildMesh", &MicroBenchmark::BuildMesh, SceneFile::MESH_CYLINDER, false },
+		{ "BuildMesh", &MicroBenchmark::BuildMesh, SceneFile::MESH_SPHERE, false },
+		{ "BuildMesh", &MicroBenchmark::BuildMesh, SceneFile::MESH_TAPERED_CYLINDER, false },
+		{ "BuildMesh", &MicroBenchmark::BuildMesh, SceneFile::MESH_TORUS, false } };
+	const size_t caseCount = sizeof(cases) / sizeof(cases[0]);
+
+	Prepare();
+
+	std::cout << std::left << std::setw(32) << "Benchmark" << std::right
+		<< std::setw(16) << "Time" << std::setw(14) << "Iterations"
+		<< std::setw(16) << "Items/s" << std::endl;
+	std::cout << std::string(78, '-') << std::endl;
+
+	bool bMatched = false;
+	for (size_t i = 0; i < caseCount; i++)
+	{
+		if ((NULL == filter) || (NULL != strstr(cases[i].name, filter)))
+		{
+			RunCase(cases[i]);
+			bMatched = true;
+		}
+	}
+
+	if (!bMatched)
+	{
+		std::cout << "No microbenchmark matches:" << filter << std::endl;
+	}
+	return(bMatched);
+}
+
+/***********************************************************
+ *  RunCase()
+ *
+ *  This method is used for timing a case.  It is run once,
+ *  then with more iterations each time, guessed from the
+ *  time of the last run, until a run takes long enough.
+ ***********************************************************/
+void MicroBenchmark::RunCase(const BENCHMARK_CASE& benchmarkCase)
+{
+	int64_t iterations = 1;
+	double seconds = 0.0;
+	while (true)
+	{
+		std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		for (int64_t i = 0; i < iterations; i++)
+		{
+			(this->*benchmarkCase.function)(benchmarkCase.count);
+		}
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		seconds = elapsed.count();
+
+		if ((seconds >= MIN_CASE_SECONDS) || (iterations >= MAX_ITERATIONS))
+		{
+			break;
+		}
+
+		// aim a bit past the time, so one more run is enough
+		double growth = MAX_GROWTH;
+		if (seconds > 0.0)
+		{
+			growth = std::min(MIN_CASE_SECONDS * 1.4 / seconds, MAX_GROWTH);
+		}
+		iterations = std::min(std::max((int64_t)(iterations * growth), iterations + 1), MAX_ITERATIONS);
+	}
+
+	std::string name = std::string(benchmarkCase.name) + "/" + std::to_string(benchmarkCase.count);
+	double nanoseconds = seconds * 1.0e9 / (double)iterations;
+
+	std::ios_base::fmtflags flags = std::cout.flags();
+	std::streamsize precision = std::cout.precision();
+	std::cout << std::left << std::setw(32) << name << std::right
+		<< std::fixed << std::setprecision(0)
+		<< std::setw(13) << nanoseconds << " ns"
+		<< std::setw(14) << iterations;
+	if (benchmarkCase.bItems)
+	{
+		double itemsPerSecond = (double)benchmarkCase.count * (double)iterations / seconds;
+		std::cout << std::setw(16) << std::setprecision(3) << std::scientific << itemsPerSecond;
+	}
+	std::cout << std::endl;
+	std::cout.flags(flags);
+	std::cout.precision(precision);
+}
+
+/***********************************************************
+ *  SetTransformations()
+ *
+ *  This method is used for setting the transformations of a
+ *  number of objects, which records their model matrices
+ *  into the command list the way a frame does.
+ ***********************************************************/
+void MicroBenchmark::SetTransformations(int count)
+{
+	m_pSceneManager->m_commands.Reset();
+	for (int i = 0; i < count; i++)
+	{
+		const TRANSFORM& transform = m_transforms[i];
+		m_pSceneManager->SetTransformations(
+			transform.scale,
+			transform.rotation.x,
+			transform.rotation.y,
+			transform.rotation.z,
+			transform.position);
+	}
+	g_Sink = (int)m_pSceneManager->m_commands.GetCommandCount();
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for looking up a number of texture
+ *  slots by tag.  The tags are passed as C strings, like
+ *  the scene code passes literals.
+ ***********************************************************/
+void MicroBenchmark::FindTextureSlot(int count)
+{
+	int total = 0;
+	for (int i = 0; i < count; i++)
+	{
+		total += m_pSceneManager->FindTextureSlot(m_textureTags[i % m_textureTags.size()].c_str());
+	}
+	g_Sink = total;
+}
+
+/***********************************************************
+ *  FindTextureID()
+ *
+ *  This method is used for looking up a number of texture
+ *  IDs by tag.
+ ***********************************************************/
+void MicroBenchmark::FindTextureID(int count)
+{
+	int total = 0;
+	for (int i = 0; i < count; i++)
+	{
+		total += m_pSceneManager->FindTextureID(m_textureTags[i % m_textureTags.size()].c_str());
+	}
+	g_Sink = total;
+}
+
+/***********************************************************
+ *  FindMaterial()
+ *
+ *  This method is used for looking up a number of materials
+ *  by tag.
+ ***********************************************************/
+void MicroBenchmark::FindMaterial(int count)
+{
+	int total = 0;
+	SceneManager::OBJECT_MATERIAL material;
+	for (int i = 0; i < count; i++)
+	{
+		if (m_pSceneManager->FindMaterial(m_materialTags[i % m_materialTags.size()].c_str(), material))
+		{
+			total++;
+		}
+	}
+	g_Sink = total;
+}
+
+/***********************************************************
+ *  DecodeImage()
+ *
+ *  This method is used for decoding one of the image files,
+ *  the step of CreateGLTexture() that reads the image.
+ ***********************************************************/
+void MicroBenchmark::DecodeImage(int count)
+{
+	ResourceCache::DECODED_IMAGE image;
+	if (ResourceCache::DecodeImage(g_DecodeFilenames[count], image))
+	{
+		g_Sink = image.pixels[0];
+		ResourceCache::FreeImage(image);
+	}
+}
+
+/***********************************************************
+ *  BuildMesh()
+ *
+ *  This method is used for generating the triangles of one
+ *  basic mesh type.  ShapeMeshes uploads its meshes as they
+ *  are made, so ShapeGeometry, which builds the same shapes
+ *  in memory, stands in for it.
+ ***********************************************************/
+void MicroBenchmark::BuildMesh(int count)
+{
+	ShapeGeometry geometry;
+	const ShapeGeometry::MESH& mesh = geometry.GetMesh((uint32_t)count, SceneFile::PART_ALL);
+	g_Sink = (int)mesh.vertices.size();
+}
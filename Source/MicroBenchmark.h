@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// microbenchmark.h
+// ============
+// time the small functions on the hot paths of the scene code in isolation
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "NullRenderDevice.h"
+#include "SceneManager.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  MicroBenchmark
+ *
+ *  This class times the small functions the scene code runs
+ *  over and over, each one on its own and without a window,
+ *  so a change to one of them can be measured by itself.
+ *  Like Google Benchmark, each case is run for more and more
+ *  iterations until the run is long enough to time, and the
+ *  cases taking a count are run with several counts to show
+ *  how they scale.  The textures and materials are those of
+ *  the built in layout, loaded on the null render device.
+ ***********************************************************/
+class MicroBenchmark
+{
+public:
+	// constructor
+	MicroBenchmark();
+	// destructor
+	~MicroBenchmark();
+
+	// run the cases whose names contain the filter, or all of
+	// them with NULL - false when no case matched
+	bool Run(const char* filter);
+
+private:
+	// one iteration of a case, over the count it was given
+	typedef void (MicroBenchmark::*CASE_FUNCTION)(int count);
+
+	struct BENCHMARK_CASE
+	{
+		const char* name;
+		CASE_FUNCTION function;
+		int count;
+		// true when the count is a number of items, reported
+		// as items per second
+		bool bItems;
+	};
+
+	// values passed to SetTransformations() for an object
+	struct TRANSFORM
+	{
+		glm::vec3 scale;
+		glm::vec3 rotation;
+		glm::vec3 position;
+	};
+
+	NullRenderDevice* m_pDevice;
+	SceneManager* m_pSceneManager;
+	// tags that are looked up, with some that are not defined
+	std::vector<std::string> m_textureTags;
+	std::vector<std::string> m_materialTags;
+	std::vector<TRANSFORM> m_transforms;
+
+	// load the scene and make the inputs of the cases
+	void Prepare();
+	// time a case and write its line of the report
+	void RunCase(const BENCHMARK_CASE& benchmarkCase);
+
+	// the cases
+	void SetTransformations(int count);
+	void FindTextureSlot(int count);
+	void FindTextureID(int count);
+	void FindMaterial(int count);
+	void DecodeImage(int count);
+	void BuildMesh(int count);
+};
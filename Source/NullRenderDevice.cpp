@@ -0,0 +1,585 @@
+///////////////////////////////////////////////////////////////////////////////
+// nullrenderdevice.cpp
+// ============
+// accept and count the render device calls without drawing anything
+///////////////////////////////////////////////////////////////////////////////
+
+#include "NullRenderDevice.h"
+
+#include <iostream>
+#include <cstring>
+
+// declaration of global variables
+namespace
+{
+	// identifies a trace file, and the layout of its records
+	const char TRACE_MAGIC[4] = { 'R', 'C', 'M', 'D' };
+	const uint32_t TRACE_VERSION = 1;
+
+	struct TRACE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+	};
+
+	// bytes per pixel of the data each texture format is
+	// created from
+	const size_t g_TexturePixelSizes[] = {
+		1,
+		3,
+		4,
+		2 * sizeof(float),
+		3 * sizeof(float) };
+
+	// the uniform buffer alignment most drivers ask for
+	const size_t UNIFORM_BUFFER_ALIGNMENT = 256;
+
+	// number of float values of the uniform commands
+	uint32_t GetUniformFloatCount(uint32_t commandType)
+	{
+		switch (commandType)
+		{
+		case RenderCommandList::COMMAND_SET_FLOAT:
+			return(1);
+		case RenderCommandList::COMMAND_SET_VEC2:
+			return(2);
+		case RenderCommandList::COMMAND_SET_VEC3:
+			return(3);
+		case RenderCommandList::COMMAND_SET_VEC4:
+			return(4);
+		case RenderCommandList::COMMAND_SET_MAT4:
+			return(16);
+		}
+		return(0);
+	}
+}
+
+/***********************************************************
+ *  NullRenderDevice()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+NullRenderDevice::NullRenderDevice(int windowWidth, int windowHeight)
+{
+	m_windowWidth = windowWidth;
+	m_windowHeight = windowHeight;
+	m_nextHandle = 1;
+	m_currentTarget = 0;
+	m_currentPipeline = 0;
+	m_residentBytes = 0;
+	ResetCounters();
+}
+
+/***********************************************************
+ *  ~NullRenderDevice()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+NullRenderDevice::~NullRenderDevice()
+{
+	StopTrace();
+}
+
+/***********************************************************
+ *  StartTrace()
+ *
+ *  This method is used for opening the trace file that the
+ *  following objects and submitted commands are written to.
+ ***********************************************************/
+bool NullRenderDevice::StartTrace(const char* filename)
+{
+	StopTrace();
+
+	m_traceFile.open(filename, std::ios::binary | std::ios::trunc);
+	if (!m_traceFile.is_open())
+	{
+		std::cout << "Could not open the trace file " << filename << std::endl;
+		return(false);
+	}
+
+	TRACE_HEADER header;
+	memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+	header.version = TRACE_VERSION;
+	m_traceFile.write((const char*)&header, sizeof(header));
+
+	return(m_traceFile.good());
+}
+
+/***********************************************************
+ *  StopTrace()
+ *
+ *  This method is used for writing the remaining records and
+ *  closing the trace file.
+ ***********************************************************/
+void NullRenderDevice::StopTrace()
+{
+	if (!m_traceFile.is_open())
+	{
+		return;
+	}
+
+	FlushTrace();
+	m_traceFile.close();
+	m_traceNames.clear();
+}
+
+/***********************************************************
+ *  ResetCounters()
+ *
+ *  This method is used for starting the counting over, such
+ *  as after the scene has been loaded.
+ ***********************************************************/
+void NullRenderDevice::ResetCounters()
+{
+	memset(&m_counters, 0, sizeof(m_counters));
+}
+
+/***********************************************************
+ *  CreateBuffer()
+ *
+ *  This method is used for creating a buffer.
+ ***********************************************************/
+RENDER_BUFFER NullRenderDevice::CreateBuffer(const BUFFER_DESC& desc, const void* data)
+{
+	return(AddObject(OBJECT_BUFFER, desc.size, (NULL != data) ? desc.size : 0));
+}
+
+/***********************************************************
+ *  UpdateBuffer()
+ *
+ *  This method is used for overwriting a range of a buffer.
+ ***********************************************************/
+void NullRenderDevice::UpdateBuffer(RENDER_BUFFER buffer, size_t offset, size_t size, const void* /*data*/)
+{
+	m_counters.bytesUploaded += size;
+
+	if (m_traceFile.is_open())
+	{
+		uint32_t values[3] = { buffer, (uint32_t)offset, (uint32_t)size };
+		TraceByte(TRACE_UPDATE);
+		TraceValues(values, 3);
+	}
+}
+
+/***********************************************************
+ *  CopyBuffer()
+ *
+ *  This method is used for copying between buffers, which
+ *  stays on the GPU, so nothing is counted.
+ ***********************************************************/
+void NullRenderDevice::CopyBuffer(RENDER_BUFFER /*source*/, RENDER_BUFFER /*destination*/, size_t /*size*/)
+{
+}
+
+/***********************************************************
+ *  DestroyBuffer()
+ *
+ *  This method is used for freeing a buffer.
+ ***********************************************************/
+void NullRenderDevice::DestroyBuffer(RENDER_BUFFER buffer)
+{
+	RemoveObject(OBJECT_BUFFER, buffer);
+}
+
+/***********************************************************
+ *  GetUniformBufferAlignment()
+ *
+ *  This method is used for getting the alignment of uniform
+ *  buffer ranges.
+ ***********************************************************/
+size_t NullRenderDevice::GetUniformBufferAlignment() const
+{
+	return(UNIFORM_BUFFER_ALIGNMENT);
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for creating a texture, counting the
+ *  levels that are passed in, and the generated ones in the
+ *  memory it takes.
+ ***********************************************************/
+RENDER_TEXTURE NullRenderDevice::CreateTexture(const TEXTURE_DESC& desc, const void* const* data)
+{
+	if (desc.format >= sizeof(g_TexturePixelSizes) / sizeof(g_TexturePixelSizes[0]))
+	{
+		std::cout << "Not implemented to handle texture format " << desc.format << std::endl;
+		return(0);
+	}
+
+	int faceCount = (desc.type == TEXTURE_CUBE) ? 6 : 1;
+	int levelCount = (desc.mipLevels > 0) ? desc.mipLevels : 1;
+
+	size_t size = 0;
+	size_t bytesUploaded = 0;
+	for (int level = 0; ; level++)
+	{
+		int width = (desc.width >> level) > 1 ? (desc.width >> level) : 1;
+		int height = (desc.height >> level) > 1 ? (desc.height >> level) : 1;
+		size_t levelSize = (size_t)width * height * g_TexturePixelSizes[desc.format];
+		if ((level >= levelCount) && !desc.bGenerateMipmaps)
+		{
+			break;
+		}
+		size += levelSize * faceCount;
+
+		for (int face = 0; (NULL != data) && (level < levelCount) && (face < faceCount); face++)
+		{
+			if (NULL != data[face * levelCount + level])
+			{
+				bytesUploaded += levelSize;
+			}
+		}
+		if ((width == 1) && (height == 1))
+		{
+			break;
+		}
+	}
+
+	return(AddObject(OBJECT_TEXTURE, size, bytesUploaded));
+}
+
+/***********************************************************
+ *  DestroyTexture()
+ *
+ *  This method is used for freeing a texture.
+ ***********************************************************/
+void NullRenderDevice::DestroyTexture(RENDER_TEXTURE texture)
+{
+	RemoveObject(OBJECT_TEXTURE, texture);
+}
+
+/***********************************************************
+ *  CreateRenderTarget()
+ *
+ *  This method is used for creating an offscreen target.
+ ***********************************************************/
+RENDER_TARGET NullRenderDevice::CreateRenderTarget(int width, int height)
+{
+	// 8 bit RGBA color with a 32 bit depth and stencil
+	return(AddObject(OBJECT_RENDER_TARGET, (size_t)width * height * 8, 0));
+}
+
+/***********************************************************
+ *  ReadPixels()
+ *
+ *  This method is used for reading back a target.  Nothing
+ *  was drawn, so the pixels are black.
+ ***********************************************************/
+bool NullRenderDevice::ReadPixels(RENDER_TARGET /*target*/, int width, int height, void* pixels)
+{
+	memset(pixels, 0, (size_t)width * height * 4);
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyRenderTarget()
+ *
+ *  This method is used for freeing an offscreen target.
+ ***********************************************************/
+void NullRenderDevice::DestroyRenderTarget(RENDER_TARGET target)
+{
+	RemoveObject(OBJECT_RENDER_TARGET, target);
+}
+
+/***********************************************************
+ *  GetWindowSize()
+ *
+ *  This method is used for getting the size of the window
+ *  the device stands in for.
+ ***********************************************************/
+void NullRenderDevice::GetWindowSize(int& width, int& height) const
+{
+	width = m_windowWidth;
+	height = m_windowHeight;
+}
+
+/***********************************************************
+ *  CreatePipeline()
+ *
+ *  This method is used for creating a pipeline.
+ ***********************************************************/
+RENDER_PIPELINE NullRenderDevice::CreatePipeline(const PIPELINE_DESC& /*desc*/)
+{
+	return(AddObject(OBJECT_PIPELINE, 0, 0));
+}
+
+/***********************************************************
+ *  DestroyPipeline()
+ *
+ *  This method is used for freeing a pipeline.
+ ***********************************************************/
+void NullRenderDevice::DestroyPipeline(RENDER_PIPELINE pipeline)
+{
+	RemoveObject(OBJECT_PIPELINE, pipeline);
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for counting the commands of a list,
+ *  and tracing them when a trace file is open.
+ ***********************************************************/
+void NullRenderDevice::Submit(const RenderCommandList& commands)
+{
+	bool bTracing = m_traceFile.is_open();
+
+	m_counters.submitCount++;
+	m_counters.commandCount += commands.GetCommandCount();
+
+	for (size_t i = 0; i < commands.GetCommandCount(); i++)
+	{
+		const RenderCommandList::COMMAND& command = commands.GetCommand(i);
+
+		switch (command.type)
+		{
+		case RenderCommandList::COMMAND_SET_RENDER_TARGET:
+			CountStateChange(command.handle != m_currentTarget);
+			m_currentTarget = command.handle;
+			break;
+		case RenderCommandList::COMMAND_SET_PIPELINE:
+			CountStateChange(command.handle != m_currentPipeline);
+			m_currentPipeline = command.handle;
+			break;
+		case RenderCommandList::COMMAND_BIND_TEXTURE:
+		{
+			uint32_t slot = command.arguments[0];
+			if (slot >= m_boundTextures.size())
+			{
+				m_boundTextures.resize(slot + 1, 0);
+			}
+			CountStateChange(command.handle != m_boundTextures[slot]);
+			m_boundTextures[slot] = command.handle;
+			break;
+		}
+		case RenderCommandList::COMMAND_BIND_UNIFORM_BUFFER:
+			CountStateChange(true);
+			break;
+		case RenderCommandList::COMMAND_SET_INT:
+			CountStateChange(true);
+			m_counters.uniformCount++;
+			m_counters.bytesUploaded += sizeof(int);
+			break;
+		case RenderCommandList::COMMAND_SET_FLOAT:
+		case RenderCommandList::COMMAND_SET_VEC2:
+		case RenderCommandList::COMMAND_SET_VEC3:
+		case RenderCommandList::COMMAND_SET_VEC4:
+		case RenderCommandList::COMMAND_SET_MAT4:
+			CountStateChange(true);
+			m_counters.uniformCount++;
+			m_counters.bytesUploaded += GetUniformFloatCount(command.type) * sizeof(float);
+			break;
+		case RenderCommandList::COMMAND_DRAW_SHAPE:
+		case RenderCommandList::COMMAND_DRAW:
+			m_counters.drawCount++;
+			break;
+		}
+
+		if (bTracing)
+		{
+			TraceCommand(commands, command);
+		}
+	}
+
+	if (bTracing)
+	{
+		uint32_t commandCount = (uint32_t)commands.GetCommandCount();
+		TraceByte(TRACE_SUBMIT);
+		TraceValues(&commandCount, 1);
+		FlushTrace();
+	}
+}
+
+/***********************************************************
+ *  CountStateChange()
+ *
+ *  This method is used for counting a state change, and if
+ *  it set the state that was already set.
+ ***********************************************************/
+void NullRenderDevice::CountStateChange(bool bChanged)
+{
+	m_counters.stateChangeCount++;
+	if (!bChanged)
+	{
+		m_counters.redundantStateCount++;
+	}
+}
+
+/***********************************************************
+ *  AddObject()
+ *
+ *  This method is used for handing out the handle of a new
+ *  object, counting its memory and the data it was created
+ *  with.
+ ***********************************************************/
+uint32_t NullRenderDevice::AddObject(uint32_t objectType, size_t size, size_t bytesUploaded)
+{
+	uint32_t handle = m_nextHandle++;
+	m_counters.bytesUploaded += bytesUploaded;
+	m_objectSizes[handle] = size;
+	m_residentBytes += size;
+
+	if (m_traceFile.is_open())
+	{
+		uint32_t values[2] = { handle, (uint32_t)bytesUploaded };
+		TraceByte(TRACE_CREATE);
+		TraceByte((uint8_t)objectType);
+		TraceValues(values, 2);
+	}
+
+	return(handle);
+}
+
+/***********************************************************
+ *  RemoveObject()
+ *
+ *  This method is used for forgetting the memory of an object
+ *  being freed, and tracing it.
+ ***********************************************************/
+void NullRenderDevice::RemoveObject(uint32_t objectType, uint32_t handle)
+{
+	std::unordered_map<uint32_t, size_t>::iterator it = m_objectSizes.find(handle);
+	if (it == m_objectSizes.end())
+	{
+		return;
+	}
+	m_residentBytes -= it->second;
+	m_objectSizes.erase(it);
+
+	if (!m_traceFile.is_open())
+	{
+		return;
+	}
+
+	TraceByte(TRACE_DESTROY);
+	TraceByte((uint8_t)objectType);
+	TraceValues(&handle, 1);
+}
+
+/***********************************************************
+ *  TraceCommand()
+ *
+ *  This method is used for appending a command to the trace
+ *  with only the values its type uses.
+ ***********************************************************/
+void NullRenderDevice::TraceCommand(const RenderCommandList& commands, const RenderCommandList::COMMAND& command)
+{
+	// uniform names are defined before the command using them
+	uint32_t nameIndex = 0;
+	if (((command.type >= RenderCommandList::COMMAND_SET_INT) &&
+		(command.type <= RenderCommandList::COMMAND_SET_MAT4)) ||
+		(command.type == RenderCommandList::COMMAND_BEGIN_TIMER))
+	{
+		nameIndex = TraceName(commands.GetName(command));
+	}
+
+	TraceByte((uint8_t)command.type);
+
+	switch (command.type)
+	{
+	case RenderCommandList::COMMAND_SET_RENDER_TARGET:
+		TraceValues(&command.handle, 1);
+		TraceValues(command.arguments, 2);
+		break;
+	case RenderCommandList::COMMAND_CLEAR:
+		TraceValues(command.floatValues, 4);
+		break;
+	case RenderCommandList::COMMAND_SET_PIPELINE:
+		TraceValues(&command.handle, 1);
+		break;
+	case RenderCommandList::COMMAND_BIND_TEXTURE:
+		TraceValues(command.arguments, 1);
+		TraceValues(&command.handle, 1);
+		break;
+	case RenderCommandList::COMMAND_BIND_UNIFORM_BUFFER:
+		TraceValues(command.arguments, 1);
+		TraceValues(&command.handle, 1);
+		TraceValues(&command.arguments[1], 2);
+		break;
+	case RenderCommandList::COMMAND_SET_INT:
+		TraceValues(&nameIndex, 1);
+		TraceValues(&command.intValue, 1);
+		break;
+	case RenderCommandList::COMMAND_SET_FLOAT:
+	case RenderCommandList::COMMAND_SET_VEC2:
+	case RenderCommandList::COMMAND_SET_VEC3:
+	case RenderCommandList::COMMAND_SET_VEC4:
+	case RenderCommandList::COMMAND_SET_MAT4:
+		TraceValues(&nameIndex, 1);
+		TraceValues(command.floatValues, GetUniformFloatCount(command.type));
+		break;
+	case RenderCommandList::COMMAND_DRAW_SHAPE:
+		TraceValues(command.arguments, 2);
+		break;
+	case RenderCommandList::COMMAND_DRAW:
+		TraceValues(&command.handle, 1);
+		TraceValues(command.arguments, 2);
+		break;
+	case RenderCommandList::COMMAND_BEGIN_TIMER:
+		TraceValues(&nameIndex, 1);
+		break;
+	}
+}
+
+/***********************************************************
+ *  TraceName()
+ *
+ *  This method is used for getting the index of a uniform
+ *  name in the trace, writing its definition the first time
+ *  the name is used.
+ ***********************************************************/
+uint32_t NullRenderDevice::TraceName(const char* name)
+{
+	std::unordered_map<std::string, uint32_t>::const_iterator it = m_traceNames.find(name);
+	if (it != m_traceNames.end())
+	{
+		return(it->second);
+	}
+
+	uint32_t nameIndex = (uint32_t)m_traceNames.size();
+	m_traceNames[name] = nameIndex;
+
+	uint16_t length = (uint16_t)strlen(name);
+	TraceByte(TRACE_NAME);
+	m_traceData.insert(m_traceData.end(), (const char*)&length, (const char*)&length + sizeof(length));
+	m_traceData.insert(m_traceData.end(), name, name + length);
+
+	return(nameIndex);
+}
+
+/***********************************************************
+ *  TraceByte()
+ *
+ *  This method is used for appending a byte to the records.
+ ***********************************************************/
+void NullRenderDevice::TraceByte(uint8_t value)
+{
+	m_traceData.push_back((char)value);
+}
+
+/***********************************************************
+ *  TraceValues()
+ *
+ *  This method is used for appending 32 bit values to the
+ *  records.
+ ***********************************************************/
+void NullRenderDevice::TraceValues(const void* values, size_t count)
+{
+	const char* bytes = (const char*)values;
+	m_traceData.insert(m_traceData.end(), bytes, bytes + count * sizeof(uint32_t));
+}
+
+/***********************************************************
+ *  FlushTrace()
+ *
+ *  This method is used for writing the records made so far
+ *  to the trace file.
+ ***********************************************************/
+void NullRenderDevice::FlushTrace()
+{
+	if (!m_traceData.empty())
+	{
+		m_traceFile.write(m_traceData.data(), m_traceData.size());
+		m_traceData.clear();
+	}
+}
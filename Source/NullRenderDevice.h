@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////////
+// nullrenderdevice.h
+// ============
+// accept and count the render device calls without drawing anything
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  NullRenderDevice
+ *
+ *  This class is a render device that hands out handles and
+ *  counts the work submitted to it, but does not render, so
+ *  the CPU cost of the scene code can be measured without a
+ *  window or OpenGL context.  With StartTrace() the created
+ *  objects and submitted commands are also written to a
+ *  binary trace file:
+ *
+ *  - a TRACE_HEADER, then one record after the other, each
+ *    starting with a byte for its type
+ *  - a RenderCommandList::COMMAND_TYPE is followed by the
+ *    32 bit values the command uses (see TraceCommand()),
+ *    with uniforms and timers referring to their name by
+ *    its index
+ *  - TRACE_NAME defines the next name index - its length in
+ *    16 bits, then the characters
+ *  - TRACE_CREATE and TRACE_DESTROY have an OBJECT_TYPE byte
+ *    and the handle, TRACE_CREATE then the bytes uploaded
+ *  - TRACE_UPDATE has the buffer, offset and size
+ *  - TRACE_SUBMIT ends the commands of a submitted list
+ ***********************************************************/
+class NullRenderDevice : public RenderDevice
+{
+public:
+	// constructor - the size of the window it stands in for
+	NullRenderDevice(int windowWidth, int windowHeight);
+	// destructor
+	virtual ~NullRenderDevice();
+
+	// work submitted since the counters were reset
+	struct COUNTERS
+	{
+		uint64_t submitCount;
+		uint64_t commandCount;
+		// Draw() and DrawShape() commands
+		uint64_t drawCount;
+		// render target, pipeline and binding changes and the
+		// uniforms set
+		uint64_t stateChangeCount;
+		// the state changes that set what was already set
+		uint64_t redundantStateCount;
+		uint64_t uniformCount;
+		// buffer and texture data and uniform values
+		uint64_t bytesUploaded;
+	};
+
+	enum TRACE_RECORD
+	{
+		TRACE_NAME = 0x80,
+		TRACE_CREATE,
+		TRACE_DESTROY,
+		TRACE_UPDATE,
+		TRACE_SUBMIT
+	};
+
+	enum OBJECT_TYPE
+	{
+		OBJECT_BUFFER = 0,
+		OBJECT_TEXTURE,
+		OBJECT_RENDER_TARGET,
+		OBJECT_PIPELINE
+	};
+
+	// write everything that follows into a trace file
+	bool StartTrace(const char* filename);
+	// finish the trace file, if one is written
+	void StopTrace();
+
+	const COUNTERS& GetCounters() const { return(m_counters); }
+	void ResetCounters();
+	// memory the objects that exist would take on a GPU
+	size_t GetResidentBytes() const { return(m_residentBytes); }
+
+	virtual RENDER_BUFFER CreateBuffer(const BUFFER_DESC& desc, const void* data);
+	virtual void UpdateBuffer(RENDER_BUFFER buffer, size_t offset, size_t size, const void* data);
+	virtual void CopyBuffer(RENDER_BUFFER source, RENDER_BUFFER destination, size_t size);
+	virtual void DestroyBuffer(RENDER_BUFFER buffer);
+	virtual size_t GetUniformBufferAlignment() const;
+
+	virtual RENDER_TEXTURE CreateTexture(const TEXTURE_DESC& desc, const void* const* data);
+	virtual void DestroyTexture(RENDER_TEXTURE texture);
+
+	virtual RENDER_TARGET CreateRenderTarget(int width, int height);
+	virtual bool ReadPixels(RENDER_TARGET target, int width, int height, void* pixels);
+	virtual void DestroyRenderTarget(RENDER_TARGET target);
+	virtual void GetWindowSize(int& width, int& height) const;
+
+	virtual RENDER_PIPELINE CreatePipeline(const PIPELINE_DESC& desc);
+	virtual void DestroyPipeline(RENDER_PIPELINE pipeline);
+
+	virtual void Submit(const RenderCommandList& commands);
+
+private:
+	int m_windowWidth;
+	int m_windowHeight;
+	// handle of the next created object, of any type
+	uint32_t m_nextHandle;
+	COUNTERS m_counters;
+	// memory of each object that exists, and their total
+	std::unordered_map<uint32_t, size_t> m_objectSizes;
+	size_t m_residentBytes;
+	// bound state, for finding the redundant changes
+	RENDER_TARGET m_currentTarget;
+	RENDER_PIPELINE m_currentPipeline;
+	std::vector<RENDER_TEXTURE> m_boundTextures;
+	// trace file, with the records not written yet and the
+	// indices of the uniform names written so far
+	std::ofstream m_traceFile;
+	std::vector<char> m_traceData;
+	std::unordered_map<std::string, uint32_t> m_traceNames;
+
+	// count a state change, redundant when nothing changed
+	void CountStateChange(bool bChanged);
+	// count and trace an object being created or destroyed
+	uint32_t AddObject(uint32_t objectType, size_t size, size_t bytesUploaded);
+	void RemoveObject(uint32_t objectType, uint32_t handle);
+	// append a command of a submitted list to the trace
+	void TraceCommand(const RenderCommandList& commands, const RenderCommandList::COMMAND& command);
+	// get the index of a uniform name, defining new ones
+	uint32_t TraceName(const char* name);
+	// append values to the trace records
+	void TraceByte(uint8_t value);
+	void TraceValues(const void* values, size_t count);
+	// write the trace records to the file
+	void FlushTrace();
+};
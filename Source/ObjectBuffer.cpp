@@ -0,0 +1,178 @@
+///////////////////////////////////////////////////////////////////////////////
+// objectbuffer.cpp
+// ============
+// per-object shader values kept in a uniform buffer, updated one range at a time
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ObjectBuffer.h"
+
+/***********************************************************
+ *  ObjectBuffer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ObjectBuffer::ObjectBuffer()
+{
+	m_pDevice = NULL;
+	m_bufferID = 0;
+	m_bindingPoint = 0;
+	m_stride = 0;
+	m_capacity = 0;
+	m_usedSlots = 0;
+	m_uploadedBytes = 0;
+}
+
+/***********************************************************
+ *  ~ObjectBuffer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ObjectBuffer::~ObjectBuffer()
+{
+	Destroy();
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the uniform buffer.  The
+ *  slots are spaced by the uniform buffer offset alignment
+ *  so that each one can be bound on its own.
+ ***********************************************************/
+void ObjectBuffer::Create(RenderDevice* pDevice, uint32_t bindingPoint, int initialCapacity)
+{
+	Destroy();
+
+	m_pDevice = pDevice;
+	size_t alignment = m_pDevice->GetUniformBufferAlignment();
+	m_stride = sizeof(OBJECT_DATA);
+	m_stride = ((m_stride + alignment - 1) / alignment) * alignment;
+
+	m_bindingPoint = bindingPoint;
+	m_capacity = (initialCapacity > 0) ? initialCapacity : 1;
+
+	RenderDevice::BUFFER_DESC desc;
+	desc.type = RenderDevice::BUFFER_UNIFORM;
+	desc.size = m_stride * m_capacity;
+	desc.bDynamic = true;
+	m_bufferID = m_pDevice->CreateBuffer(desc, NULL);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the uniform buffer and
+ *  forgetting all the allocated slots.
+ ***********************************************************/
+void ObjectBuffer::Destroy()
+{
+	if (m_bufferID != 0)
+	{
+		m_pDevice->DestroyBuffer(m_bufferID);
+		m_bufferID = 0;
+	}
+	m_capacity = 0;
+	m_usedSlots = 0;
+	m_freeSlots.clear();
+}
+
+/***********************************************************
+ *  Grow()
+ *
+ *  This method is used for doubling the buffer capacity.  The
+ *  existing slots are copied on the GPU, so objects keep
+ *  their slots and nothing is uploaded again.
+ ***********************************************************/
+void ObjectBuffer::Grow()
+{
+	int newCapacity = m_capacity * 2;
+
+	RenderDevice::BUFFER_DESC desc;
+	desc.type = RenderDevice::BUFFER_UNIFORM;
+	desc.size = m_stride * newCapacity;
+	desc.bDynamic = true;
+	RENDER_BUFFER newBufferID = m_pDevice->CreateBuffer(desc, NULL);
+	m_pDevice->CopyBuffer(m_bufferID, newBufferID, m_stride * m_capacity);
+
+	m_pDevice->DestroyBuffer(m_bufferID);
+	m_bufferID = newBufferID;
+	m_capacity = newCapacity;
+}
+
+/***********************************************************
+ *  Allocate()
+ *
+ *  This method is used for reserving a slot for an object.
+ ***********************************************************/
+int ObjectBuffer::Allocate()
+{
+	if (!m_freeSlots.empty())
+	{
+		int slot = m_freeSlots.back();
+		m_freeSlots.pop_back();
+		return(slot);
+	}
+
+	if (m_usedSlots == m_capacity)
+	{
+		Grow();
+	}
+	return(m_usedSlots++);
+}
+
+/***********************************************************
+ *  Release()
+ *
+ *  This method is used for returning the slot of a removed
+ *  object.  The contents are left alone until it is reused.
+ ***********************************************************/
+void ObjectBuffer::Release(int slot)
+{
+	if ((slot >= 0) && (slot < m_usedSlots))
+	{
+		m_freeSlots.push_back(slot);
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for writing all the values of a slot.
+ ***********************************************************/
+void ObjectBuffer::Update(int slot, const OBJECT_DATA& data)
+{
+	UpdateRange(slot, 0, sizeof(OBJECT_DATA), &data);
+}
+
+/***********************************************************
+ *  UpdateRange()
+ *
+ *  This method is used for writing part of a slot, such as
+ *  only the model matrix of an object that was moved.
+ ***********************************************************/
+void ObjectBuffer::UpdateRange(int slot, size_t offset, size_t size, const void* data)
+{
+	if ((m_bufferID == 0) || (slot < 0) || (slot >= m_capacity) ||
+		(offset + size > sizeof(OBJECT_DATA)))
+	{
+		return;
+	}
+
+	m_pDevice->UpdateBuffer(m_bufferID, m_stride * slot + offset, size, data);
+
+	m_uploadedBytes += size;
+}
+
+/***********************************************************
+ *  Bind()
+ *
+ *  This method is used for binding the range of one slot to
+ *  the ObjectBlock binding point before a draw.
+ ***********************************************************/
+void ObjectBuffer::Bind(RenderCommandList& commands, int slot) const
+{
+	if ((m_bufferID != 0) && (slot >= 0) && (slot < m_capacity))
+	{
+		commands.BindUniformBuffer(m_bindingPoint, m_bufferID, m_stride * slot, sizeof(OBJECT_DATA));
+	}
+}
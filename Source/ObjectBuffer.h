@@ -0,0 +1,82 @@
+///////////////////////////////////////////////////////////////////////////////
+// objectbuffer.h
+// ============
+// per-object shader values kept in a uniform buffer, updated one range at a time
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  ObjectBuffer
+ *
+ *  This class keeps the model matrix, color and UV scale of
+ *  every scene object in one uniform buffer, matching the
+ *  std140 ObjectBlock declared in the shaders.  Each object
+ *  owns a slot, and a change to an object only rewrites the
+ *  bytes of its slot.
+ ***********************************************************/
+class ObjectBuffer
+{
+public:
+	// constructor
+	ObjectBuffer();
+	// destructor
+	~ObjectBuffer();
+
+	// std140 layout of the ObjectBlock uniform block
+	struct OBJECT_DATA
+	{
+		float model[16];
+		float color[4];
+		float uvScale[4];
+	};
+
+	// byte ranges inside a slot, for partial updates
+	static const size_t MODEL_OFFSET = 0;
+	static const size_t MODEL_SIZE = sizeof(float) * 16;
+	static const size_t APPEARANCE_OFFSET = MODEL_SIZE;
+	static const size_t APPEARANCE_SIZE = sizeof(float) * 8;
+
+	// create the uniform buffer for the passed in binding point
+	void Create(RenderDevice* pDevice, uint32_t bindingPoint, int initialCapacity = 64);
+	// free the uniform buffer
+	void Destroy();
+	bool IsCreated() const { return(m_bufferID != 0); }
+
+	// reserve a slot for an object and free it again
+	int Allocate();
+	void Release(int slot);
+
+	// write a whole slot, or only a range of it
+	void Update(int slot, const OBJECT_DATA& data);
+	void UpdateRange(int slot, size_t offset, size_t size, const void* data);
+
+	// bind the slot of the object about to be drawn
+	void Bind(RenderCommandList& commands, int slot) const;
+
+	// bytes sent to the device since the last reset
+	size_t GetUploadedBytes() const { return(m_uploadedBytes); }
+	void ResetUploadedBytes() { m_uploadedBytes = 0; }
+
+private:
+	// uniform buffer holding all the slots, and its device
+	RenderDevice* m_pDevice;
+	RENDER_BUFFER m_bufferID;
+	uint32_t m_bindingPoint;
+	// distance between slots, rounded up to the offset alignment
+	size_t m_stride;
+	int m_capacity;
+	// slots released by removed objects, reused first
+	std::vector<int> m_freeSlots;
+	int m_usedSlots;
+	size_t m_uploadedBytes;
+
+	// double the capacity, keeping the contents of the slots
+	void Grow();
+};
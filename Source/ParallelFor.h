@@ -0,0 +1,73 @@
+///////////////////////////////////////////////////////////////////////////////
+// parallelfor.h
+// ============
+// split independent work items across all of the available CPU cores
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+/***********************************************************
+ *  GetWorkerThreadCount()
+ *
+ *  This function returns the number of threads to use for
+ *  CPU work - one per hardware thread, and at least one.
+ ***********************************************************/
+inline int GetWorkerThreadCount()
+{
+	int threadCount = (int)std::thread::hardware_concurrency();
+	if (threadCount < 1)
+	{
+		threadCount = 1;
+	}
+	return(threadCount);
+}
+
+/***********************************************************
+ *  ParallelFor()
+ *
+ *  This function calls the passed in function once for every
+ *  index in [0, count), spread over the worker threads.  The
+ *  items are handed out one at a time, so each one must only
+ *  write its own output - the results are then the same no
+ *  matter how many threads are used.
+ ***********************************************************/
+template <typename Function>
+void ParallelFor(int count, Function function, int threadCount = 0)
+{
+	if (threadCount <= 0)
+	{
+		threadCount = GetWorkerThreadCount();
+	}
+	if (threadCount > count)
+	{
+		threadCount = count;
+	}
+
+	std::atomic<int> nextIndex(0);
+	auto worker = [&]()
+	{
+		int index = nextIndex.fetch_add(1);
+		while (index < count)
+		{
+			function(index);
+			index = nextIndex.fetch_add(1);
+		}
+	};
+
+	// the calling thread works on the items too
+	std::vector<std::thread> threads;
+	for (int i = 1; i < threadCount; i++)
+	{
+		threads.emplace_back(worker);
+	}
+	worker();
+
+	for (size_t i = 0; i < threads.size(); i++)
+	{
+		threads[i].join();
+	}
+}
@@ -0,0 +1,1384 @@
+///////////////////////////////////////////////////////////////////////////////
+// pathtracer.cpp
+// ============
+// render stills with global illumination and soft shadows on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PathTracer.h"
+#include "Profiler.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+// SSE2 is part of every x64 target, and the default for 32 bit builds
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define PATH_TRACER_SSE2
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	const float PI = 3.14159265358979f;
+	// tiles are square blocks of pixels traced by one thread,
+	// in quads of 2x2 rays that go through the hierarchy together
+	const int TILE_SIZE = 16;
+	// hierarchy build - split candidates per axis, triangles a
+	// leaf may keep when splitting does not pay off, and the
+	// depth limit that keeps the traversal stack bounded
+	const int BIN_COUNT = 16;
+	const uint32_t MAX_LEAF_TRIANGLES = 8;
+	const uint32_t MAX_TREE_DEPTH = 60;
+	const int TRAVERSAL_STACK_SIZE = 64;
+	// distances along the rays
+	const float NO_HIT = FLT_MAX;
+	const float FAR_DISTANCE = 1.0e30f;
+	const float MIN_HIT_DISTANCE = 1.0e-5f;
+	// rays leaving a surface start this far off of it
+	const float RAY_OFFSET = 0.0005f;
+	const float DETERMINANT_EPSILON = 1.0e-12f;
+	// size of the lights, which makes the shadow edges soft - the
+	// sun covers a small cone, the lamps are spheres
+	const float DIRECTIONAL_LIGHT_SPREAD = 0.03f;
+	const float POINT_LIGHT_RADIUS = 0.5f;
+	const float SPOT_LIGHT_RADIUS = 0.1f;
+	const int DEFAULT_MAX_BOUNCES = 4;
+	// paths are ended at random after this many bounces
+	const int ROULETTE_BOUNCE = 3;
+	// transparent surfaces and glyph gaps a path may go through
+	const int MAX_PASS_THROUGHS = 16;
+	// samples are clamped to keep rare bright paths from
+	// leaving single bright pixels
+	const float MAX_SAMPLE_RADIANCE = 4.0f;
+
+	/***********************************************************
+	 *  HashValue()
+	 *
+	 *  Scramble an integer, to seed the random numbers.
+	 ***********************************************************/
+	uint32_t HashValue(uint32_t value)
+	{
+		value ^= value >> 16;
+		value *= 0x7FEB352Du;
+		value ^= value >> 15;
+		value *= 0x846CA68Bu;
+		value ^= value >> 16;
+		return(value);
+	}
+
+	/***********************************************************
+	 *  NextRandom()
+	 *
+	 *  Step a PCG random number generator, and get a number in
+	 *  [0, 1) out of it.
+	 ***********************************************************/
+	float NextRandom(uint32_t& state)
+	{
+		state = state * 747796405u + 2891336453u;
+		uint32_t word = ((state >> ((state >> 28) + 4)) ^ state) * 277803737u;
+		word = (word >> 22) ^ word;
+		return((float)(word >> 8) * (1.0f / 16777216.0f));
+	}
+
+	/***********************************************************
+	 *  MakeBasis()
+	 *
+	 *  Get two directions that are at right angles to a normal
+	 *  and to each other.
+	 ***********************************************************/
+	void MakeBasis(const glm::vec3& normal, glm::vec3& tangent, glm::vec3& bitangent)
+	{
+		float sign = (normal.z >= 0.0f) ? 1.0f : -1.0f;
+		float a = -1.0f / (sign + normal.z);
+		float b = normal.x * normal.y * a;
+		tangent = glm::vec3(1.0f + sign * normal.x * normal.x * a, sign * b, -sign * normal.x);
+		bitangent = glm::vec3(b, sign + normal.y * normal.y * a, -normal.y);
+	}
+
+	/***********************************************************
+	 *  RandomOnSphere()
+	 *
+	 *  Get an evenly distributed point on the unit sphere.
+	 ***********************************************************/
+	glm::vec3 RandomOnSphere(uint32_t& randomState)
+	{
+		float z = 1.0f - 2.0f * NextRandom(randomState);
+		float radius = std::sqrt(std::max(0.0f, 1.0f - z * z));
+		float phi = 2.0f * PI * NextRandom(randomState);
+		return(glm::vec3(radius * std::cos(phi), radius * std::sin(phi), z));
+	}
+
+	/***********************************************************
+	 *  Luminance()
+	 *
+	 *  Get the brightness of a color.
+	 ***********************************************************/
+	float Luminance(const glm::vec3& color)
+	{
+		return(0.2126f * color.r + 0.7152f * color.g + 0.0722f * color.b);
+	}
+
+	/***********************************************************
+	 *  HalfArea()
+	 *
+	 *  Half of the surface area of a box, the cost measure of
+	 *  the hierarchy build.
+	 ***********************************************************/
+	float HalfArea(const glm::vec3& boundsMin, const glm::vec3& boundsMax)
+	{
+		glm::vec3 size = boundsMax - boundsMin;
+		return(size.x * size.y + size.y * size.z + size.z * size.x);
+	}
+
+	/***********************************************************
+	 *  IntersectBox()
+	 *
+	 *  Get the distance at which a ray enters a box, or NO_HIT
+	 *  when it misses the box or enters it too far away.
+	 ***********************************************************/
+	float IntersectBox(const glm::vec3& origin, const glm::vec3& inverseDirection, const float boundsMin[3], const float boundsMax[3], float maxDistance)
+	{
+		float nearDistance = 0.0f;
+		float farDistance = maxDistance;
+		for (int axis = 0; axis < 3; axis++)
+		{
+			float t1 = (boundsMin[axis] - origin[axis]) * inverseDirection[axis];
+			float t2 = (boundsMax[axis] - origin[axis]) * inverseDirection[axis];
+			nearDistance = std::max(nearDistance, std::min(t1, t2));
+			farDistance = std::min(farDistance, std::max(t1, t2));
+		}
+		return((nearDistance <= farDistance) ? nearDistance : NO_HIT);
+	}
+
+	/***********************************************************
+	 *  IntersectTriangle()
+	 *
+	 *  Moller-Trumbore test of a ray against a triangle, which
+	 *  gets the distance and the barycentric coordinates.
+	 ***********************************************************/
+	bool IntersectTriangle(const glm::vec3& origin, const glm::vec3& direction, const glm::vec3& vertex0, const glm::vec3& edge1, const glm::vec3& edge2, float maxDistance, float& distance, float& u, float& v)
+	{
+		glm::vec3 p = glm::cross(direction, edge2);
+		float determinant = glm::dot(edge1, p);
+		if (std::fabs(determinant) < DETERMINANT_EPSILON)
+		{
+			return(false);
+		}
+		float inverseDeterminant = 1.0f / determinant;
+		glm::vec3 toOrigin = origin - vertex0;
+		u = glm::dot(toOrigin, p) * inverseDeterminant;
+		if ((u < 0.0f) || (u > 1.0f))
+		{
+			return(false);
+		}
+		glm::vec3 q = glm::cross(toOrigin, edge1);
+		v = glm::dot(direction, q) * inverseDeterminant;
+		if ((v < 0.0f) || (u + v > 1.0f))
+		{
+			return(false);
+		}
+		distance = glm::dot(edge2, q) * inverseDeterminant;
+		return((distance > MIN_HIT_DISTANCE) && (distance < maxDistance));
+	}
+
+	// four floats that are computed on together - the comparisons
+	// give masks that MoveMask() turns into one bit per lane
+#ifdef PATH_TRACER_SSE2
+	struct FLOAT4
+	{
+		__m128 value;
+	};
+
+	inline FLOAT4 Make4(__m128 value) { FLOAT4 result; result.value = value; return(result); }
+	inline FLOAT4 Splat4(float value) { return(Make4(_mm_set1_ps(value))); }
+	inline FLOAT4 Set4(float a, float b, float c, float d) { return(Make4(_mm_setr_ps(a, b, c, d))); }
+	inline FLOAT4 operator+(FLOAT4 a, FLOAT4 b) { return(Make4(_mm_add_ps(a.value, b.value))); }
+	inline FLOAT4 operator-(FLOAT4 a, FLOAT4 b) { return(Make4(_mm_sub_ps(a.value, b.value))); }
+	inline FLOAT4 operator*(FLOAT4 a, FLOAT4 b) { return(Make4(_mm_mul_ps(a.value, b.value))); }
+	inline FLOAT4 operator/(FLOAT4 a, FLOAT4 b) { return(Make4(_mm_div_ps(a.value, b.value))); }
+	inline FLOAT4 Min4(FLOAT4 a, FLOAT4 b) { return(Make4(_mm_min_ps(a.value, b.value))); }
+	inline FLOAT4 Max4(FLOAT4 a, FLOAT4 b) { return(Make4(_mm_max_ps(a.value, b.value))); }
+	inline FLOAT4 Less4(FLOAT4 a, FLOAT4 b) { return(Make4(_mm_cmplt_ps(a.value, b.value))); }
+	inline FLOAT4 LessEqual4(FLOAT4 a, FLOAT4 b) { return(Make4(_mm_cmple_ps(a.value, b.value))); }
+	inline FLOAT4 And4(FLOAT4 a, FLOAT4 b) { return(Make4(_mm_and_ps(a.value, b.value))); }
+	inline FLOAT4 Or4(FLOAT4 a, FLOAT4 b) { return(Make4(_mm_or_ps(a.value, b.value))); }
+	inline FLOAT4 Select4(FLOAT4 mask, FLOAT4 a, FLOAT4 b) { return(Make4(_mm_or_ps(_mm_and_ps(mask.value, a.value), _mm_andnot_ps(mask.value, b.value)))); }
+	inline int MoveMask(FLOAT4 mask) { return(_mm_movemask_ps(mask.value)); }
+	inline void Store4(FLOAT4 a, float values[4]) { _mm_storeu_ps(values, a.value); }
+#else
+	struct FLOAT4
+	{
+		float value[4];
+	};
+
+	inline FLOAT4 Set4(float a, float b, float c, float d) { FLOAT4 result = { { a, b, c, d } }; return(result); }
+	inline FLOAT4 Splat4(float value) { return(Set4(value, value, value, value)); }
+#define PATH_TRACER_FLOAT4_OP(name, expression) \
+	inline FLOAT4 name(FLOAT4 a, FLOAT4 b) { FLOAT4 result; for (int i = 0; i < 4; i++) { float x = a.value[i]; float y = b.value[i]; result.value[i] = (expression); } return(result); }
+	PATH_TRACER_FLOAT4_OP(operator+, x + y)
+	PATH_TRACER_FLOAT4_OP(operator-, x - y)
+	PATH_TRACER_FLOAT4_OP(operator*, x * y)
+	PATH_TRACER_FLOAT4_OP(operator/, x / y)
+	PATH_TRACER_FLOAT4_OP(Min4, (y < x) ? y : x)
+	PATH_TRACER_FLOAT4_OP(Max4, (y > x) ? y : x)
+	PATH_TRACER_FLOAT4_OP(Less4, (x < y) ? 1.0f : 0.0f)
+	PATH_TRACER_FLOAT4_OP(LessEqual4, (x <= y) ? 1.0f : 0.0f)
+	PATH_TRACER_FLOAT4_OP(And4, ((x != 0.0f) && (y != 0.0f)) ? 1.0f : 0.0f)
+	PATH_TRACER_FLOAT4_OP(Or4, ((x != 0.0f) || (y != 0.0f)) ? 1.0f : 0.0f)
+#undef PATH_TRACER_FLOAT4_OP
+	inline FLOAT4 Select4(FLOAT4 mask, FLOAT4 a, FLOAT4 b) { FLOAT4 result; for (int i = 0; i < 4; i++) result.value[i] = (mask.value[i] != 0.0f) ? a.value[i] : b.value[i]; return(result); }
+	inline int MoveMask(FLOAT4 mask) { int bits = 0; for (int i = 0; i < 4; i++) if (mask.value[i] != 0.0f) bits |= 1 << i; return(bits); }
+	inline void Store4(FLOAT4 a, float values[4]) { for (int i = 0; i < 4; i++) values[i] = a.value[i]; }
+#endif
+}
+
+/***********************************************************
+ *  PathTracer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PathTracer::PathTracer()
+{
+	m_width = 0;
+	m_height = 0;
+	m_inverseViewProjection = glm::mat4(1.0f);
+	m_viewPosition = glm::vec3(0.0f);
+	m_lights = SCENE_LIGHTS();
+	m_skyColor = glm::vec3(0.0f);
+	m_maxBounces = DEFAULT_MAX_BOUNCES;
+	m_sampleCount = 0;
+}
+
+/***********************************************************
+ *  ~PathTracer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PathTracer::~PathTracer()
+{
+}
+
+/***********************************************************
+ *  SetTarget()
+ *
+ *  This method is used for setting the size of the rendered
+ *  image.  The samples gathered so far are dropped.
+ ***********************************************************/
+void PathTracer::SetTarget(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+	m_accumulation.assign((size_t)width * height, glm::vec3(0.0f));
+	m_sampleCount = 0;
+}
+
+/***********************************************************
+ *  SetCamera()
+ *
+ *  This method is used for setting the same view values
+ *  that ViewManager sets into the shader.  The samples
+ *  gathered so far are dropped.
+ ***********************************************************/
+void PathTracer::SetCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition)
+{
+	m_inverseViewProjection = glm::inverse(projection * view);
+	m_viewPosition = viewPosition;
+	m_accumulation.assign((size_t)m_width * m_height, glm::vec3(0.0f));
+	m_sampleCount = 0;
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  This method is used for setting the light sources.  The
+ *  ambient terms, which the shader adds to every surface,
+ *  become the light of the sky.
+ ***********************************************************/
+void PathTracer::SetLights(const SCENE_LIGHTS& lights)
+{
+	m_lights = lights;
+	m_skyColor = glm::vec3(0.0f);
+	if (lights.directionalLight.bActive)
+	{
+		m_skyColor += lights.directionalLight.ambient;
+	}
+	for (int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+	{
+		if (lights.pointLights[i].bActive)
+		{
+			m_skyColor += lights.pointLights[i].ambient;
+		}
+	}
+}
+
+/***********************************************************
+ *  SetMaxBounces()
+ *
+ *  This method is used for setting how many times a path may
+ *  bounce off of surfaces - 0 only gets the direct light.
+ ***********************************************************/
+void PathTracer::SetMaxBounces(int maxBounces)
+{
+	m_maxBounces = std::max(maxBounces, 0);
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for copying an image into a texture
+ *  and getting its index for the draws.  Single channel
+ *  images keep their value in red, like an R8 texture.
+ ***********************************************************/
+int PathTracer::AddTexture(int width, int height, int colorChannels, const unsigned char* pixels)
+{
+	TEXTURE texture;
+	texture.width = width;
+	texture.height = height;
+	texture.texels.resize((size_t)width * height);
+
+	for (size_t i = 0; i < texture.texels.size(); i++)
+	{
+		const unsigned char* pixel = pixels + i * colorChannels;
+		uint32_t red = pixel[0];
+		uint32_t green = (colorChannels >= 3) ? pixel[1] : 0;
+		uint32_t blue = (colorChannels >= 3) ? pixel[2] : 0;
+		uint32_t alpha = (colorChannels == 4) ? pixel[3] : 255;
+		texture.texels[i] = red | (green << 8) | (blue << 16) | (alpha << 24);
+	}
+
+	m_textures.push_back(texture);
+	return((int)m_textures.size() - 1);
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for queueing a draw.  Its triangles
+ *  are added to the scene by BuildScene().
+ ***********************************************************/
+void PathTracer::Submit(const DRAW_CALL& draw)
+{
+	m_draws.push_back(draw);
+}
+
+/***********************************************************
+ *  BuildScene()
+ *
+ *  This method is used for moving the triangles of all
+ *  queued draws into world space, and building the bounding
+ *  volume hierarchy over them.  The meshes of the draws are
+ *  not used after this.
+ ***********************************************************/
+void PathTracer::BuildScene()
+{
+	m_triangles.clear();
+	m_shading.clear();
+
+	for (size_t drawIndex = 0; drawIndex < m_draws.size(); drawIndex++)
+	{
+		const DRAW_CALL& draw = m_draws[drawIndex];
+		const ShapeGeometry::MESH& mesh = *draw.pMesh;
+		glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(draw.model)));
+
+		std::vector<glm::vec3> positions(mesh.vertices.size());
+		std::vector<glm::vec3> normals(mesh.vertices.size());
+		for (size_t i = 0; i < mesh.vertices.size(); i++)
+		{
+			positions[i] = glm::vec3(draw.model * glm::vec4(mesh.vertices[i].position, 1.0f));
+			normals[i] = normalMatrix * mesh.vertices[i].normal;
+		}
+
+		for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+		{
+			uint32_t corners[3] = { mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2] };
+
+			TRIANGLE triangle;
+			triangle.vertex0 = positions[corners[0]];
+			triangle.edge1 = positions[corners[1]] - triangle.vertex0;
+			triangle.edge2 = positions[corners[2]] - triangle.vertex0;
+			// triangles without an area can never be hit
+			if (glm::length(glm::cross(triangle.edge1, triangle.edge2)) <= 0.0f)
+			{
+				continue;
+			}
+
+			TRIANGLE_SHADING shading;
+			for (int k = 0; k < 3; k++)
+			{
+				shading.normals[k] = normals[corners[k]];
+				shading.uvs[k] = mesh.vertices[corners[k]].uv;
+			}
+			shading.drawIndex = (uint32_t)drawIndex;
+
+			m_triangles.push_back(triangle);
+			m_shading.push_back(shading);
+		}
+
+		m_draws[drawIndex].pMesh = NULL;
+	}
+
+	BuildHierarchy();
+
+	m_accumulation.assign((size_t)m_width * m_height, glm::vec3(0.0f));
+	m_sampleCount = 0;
+}
+
+/***********************************************************
+ *  BuildHierarchy()
+ *
+ *  This method is used for building the bounding volume
+ *  hierarchy top down.  Each node is split where the surface
+ *  area heuristic is lowest, checked at the borders of bins
+ *  along every axis, and becomes a leaf when splitting would
+ *  not make the rays cheaper.  The triangles are reordered
+ *  so each leaf holds a continuous range of them.
+ ***********************************************************/
+void PathTracer::BuildHierarchy()
+{
+	m_nodes.clear();
+	uint32_t triangleCount = (uint32_t)m_triangles.size();
+	if (triangleCount == 0)
+	{
+		return;
+	}
+
+	std::vector<glm::vec3> boundsMin(triangleCount);
+	std::vector<glm::vec3> boundsMax(triangleCount);
+	std::vector<glm::vec3> centroids(triangleCount);
+	std::vector<uint32_t> order(triangleCount);
+	for (uint32_t i = 0; i < triangleCount; i++)
+	{
+		const TRIANGLE& triangle = m_triangles[i];
+		glm::vec3 vertex1 = triangle.vertex0 + triangle.edge1;
+		glm::vec3 vertex2 = triangle.vertex0 + triangle.edge2;
+		boundsMin[i] = glm::min(triangle.vertex0, glm::min(vertex1, vertex2));
+		boundsMax[i] = glm::max(triangle.vertex0, glm::max(vertex1, vertex2));
+		centroids[i] = (boundsMin[i] + boundsMax[i]) * 0.5f;
+		order[i] = i;
+	}
+
+	// a binary tree over n leaves has less than 2n nodes, so the
+	// node references below stay valid
+	m_nodes.reserve((size_t)triangleCount * 2);
+	m_nodes.push_back(BVH_NODE());
+
+	struct BUILD_RANGE
+	{
+		uint32_t node;
+		uint32_t first;
+		uint32_t count;
+		uint32_t depth;
+	};
+	std::vector<BUILD_RANGE> ranges;
+	BUILD_RANGE root = { 0, 0, triangleCount, 0 };
+	ranges.push_back(root);
+
+	while (!ranges.empty())
+	{
+		BUILD_RANGE range = ranges.back();
+		ranges.pop_back();
+
+		glm::vec3 nodeMin(FLT_MAX);
+		glm::vec3 nodeMax(-FLT_MAX);
+		glm::vec3 centroidMin(FLT_MAX);
+		glm::vec3 centroidMax(-FLT_MAX);
+		for (uint32_t i = range.first; i < range.first + range.count; i++)
+		{
+			uint32_t index = order[i];
+			nodeMin = glm::min(nodeMin, boundsMin[index]);
+			nodeMax = glm::max(nodeMax, boundsMax[index]);
+			centroidMin = glm::min(centroidMin, centroids[index]);
+			centroidMax = glm::max(centroidMax, centroids[index]);
+		}
+
+		BVH_NODE& node = m_nodes[range.node];
+		for (int axis = 0; axis < 3; axis++)
+		{
+			node.boundsMin[axis] = nodeMin[axis];
+			node.boundsMax[axis] = nodeMax[axis];
+		}
+		node.leftFirst = range.first;
+		node.triangleCount = (uint16_t)range.count;
+		node.splitAxis = 0;
+
+		// find the cheapest split between the bins of any axis
+		float bestCost = FLT_MAX;
+		int bestAxis = -1;
+		int bestSplit = 0;
+		if ((range.count > 2) && (range.depth < MAX_TREE_DEPTH))
+		{
+			for (int axis = 0; axis < 3; axis++)
+			{
+				float extent = centroidMax[axis] - centroidMin[axis];
+				if (extent <= 0.0f)
+				{
+					continue;
+				}
+				float binScale = BIN_COUNT / extent;
+
+				glm::vec3 binMin[BIN_COUNT];
+				glm::vec3 binMax[BIN_COUNT];
+				uint32_t binCount[BIN_COUNT] = { 0 };
+				for (int bin = 0; bin < BIN_COUNT; bin++)
+				{
+					binMin[bin] = glm::vec3(FLT_MAX);
+					binMax[bin] = glm::vec3(-FLT_MAX);
+				}
+				for (uint32_t i = range.first; i < range.first + range.count; i++)
+				{
+					uint32_t index = order[i];
+					int bin = std::min(BIN_COUNT - 1, (int)((centroids[index][axis] - centroidMin[axis]) * binScale));
+					binMin[bin] = glm::min(binMin[bin], boundsMin[index]);
+					binMax[bin] = glm::max(binMax[bin], boundsMax[index]);
+					binCount[bin]++;
+				}
+
+				// sweep from the left, then price each split
+				// while sweeping back from the right
+				float leftArea[BIN_COUNT - 1];
+				uint32_t leftCount[BIN_COUNT - 1];
+				glm::vec3 sweepMin(FLT_MAX);
+				glm::vec3 sweepMax(-FLT_MAX);
+				uint32_t sweepCount = 0;
+				for (int split = 0; split < BIN_COUNT - 1; split++)
+				{
+					sweepCount += binCount[split];
+					if (binCount[split] > 0)
+					{
+						sweepMin = glm::min(sweepMin, binMin[split]);
+						sweepMax = glm::max(sweepMax, binMax[split]);
+					}
+					leftCount[split] = sweepCount;
+					leftArea[split] = (sweepCount > 0) ? HalfArea(sweepMin, sweepMax) : 0.0f;
+				}
+				sweepMin = glm::vec3(FLT_MAX);
+				sweepMax = glm::vec3(-FLT_MAX);
+				sweepCount = 0;
+				for (int split = BIN_COUNT - 2; split >= 0; split--)
+				{
+					sweepCount += binCount[split + 1];
+					if (binCount[split + 1] > 0)
+					{
+						sweepMin = glm::min(sweepMin, binMin[split + 1]);
+						sweepMax = glm::max(sweepMax, binMax[split + 1]);
+					}
+					if ((leftCount[split] == 0) || (sweepCount == 0))
+					{
+						continue;
+					}
+					float cost = leftCount[split] * leftArea[split] + sweepCount * HalfArea(sweepMin, sweepMax);
+					if (cost < bestCost)
+					{
+						bestCost = cost;
+						bestAxis = axis;
+						bestSplit = split;
+					}
+				}
+			}
+		}
+
+		float leafCost = range.count * HalfArea(nodeMin, nodeMax);
+		bool bLeaf = (bestAxis < 0) || ((bestCost >= leafCost) && (range.count <= MAX_LEAF_TRIANGLES));
+		if (bLeaf && (range.count <= 0xFFFF))
+		{
+			continue;
+		}
+
+		// split the range, by index when the centroids could not
+		// be told apart
+		uint32_t* pFirst = &order[range.first];
+		uint32_t* pLast = pFirst + range.count;
+		uint32_t* pMiddle = pFirst + range.count / 2;
+		if (bestAxis >= 0)
+		{
+			float binScale = BIN_COUNT / (centroidMax[bestAxis] - centroidMin[bestAxis]);
+			float splitMin = centroidMin[bestAxis];
+			pMiddle = std::partition(pFirst, pLast, [&](uint32_t index)
+			{
+				int bin = std::min(BIN_COUNT - 1, (int)((centroids[index][bestAxis] - splitMin) * binScale));
+				return(bin <= bestSplit);
+			});
+			if ((pMiddle == pFirst) || (pMiddle == pLast))
+			{
+				pMiddle = pFirst + range.count / 2;
+			}
+		}
+		uint32_t leftCount = (uint32_t)(pMiddle - pFirst);
+
+		uint32_t leftChild = (uint32_t)m_nodes.size();
+		node.leftFirst = leftChild;
+		node.triangleCount = 0;
+		node.splitAxis = (uint16_t)std::max(bestAxis, 0);
+		m_nodes.push_back(BVH_NODE());
+		m_nodes.push_back(BVH_NODE());
+
+		BUILD_RANGE left = { leftChild, range.first, leftCount, range.depth + 1 };
+		BUILD_RANGE right = { leftChild + 1, range.first + leftCount, range.count - leftCount, range.depth + 1 };
+		ranges.push_back(right);
+		ranges.push_back(left);
+	}
+
+	// put the triangles in the order of the leaves
+	std::vector<TRIANGLE> triangles(triangleCount);
+	std::vector<TRIANGLE_SHADING> shading(triangleCount);
+	for (uint32_t i = 0; i < triangleCount; i++)
+	{
+		triangles[i] = m_triangles[order[i]];
+		shading[i] = m_shading[order[i]];
+	}
+	m_triangles.swap(triangles);
+	m_shading.swap(shading);
+}
+
+/***********************************************************
+ *  MakeRay()
+ *
+ *  This method is used for making a ray, with the inverse of
+ *  its direction for the box tests.
+ ***********************************************************/
+PathTracer::RAY PathTracer::MakeRay(const glm::vec3& origin, const glm::vec3& direction)
+{
+	RAY ray;
+	ray.origin = origin;
+	ray.direction = direction;
+	ray.inverseDirection = glm::vec3(1.0f / direction.x, 1.0f / direction.y, 1.0f / direction.z);
+	return(ray);
+}
+
+/***********************************************************
+ *  Intersect()
+ *
+ *  This method is used for finding the closest triangle a
+ *  ray hits.  The nearer child of each node is visited
+ *  first, so farther boxes are mostly skipped.
+ ***********************************************************/
+bool PathTracer::Intersect(const RAY& ray, float maxDistance, HIT& hit) const
+{
+	hit.distance = maxDistance;
+	if (m_nodes.empty() ||
+		(IntersectBox(ray.origin, ray.inverseDirection, m_nodes[0].boundsMin, m_nodes[0].boundsMax, maxDistance) == NO_HIT))
+	{
+		return(false);
+	}
+
+	bool bHit = false;
+	uint32_t stack[TRAVERSAL_STACK_SIZE];
+	int stackSize = 0;
+	uint32_t nodeIndex = 0;
+	while (true)
+	{
+		const BVH_NODE& node = m_nodes[nodeIndex];
+		if (node.triangleCount > 0)
+		{
+			for (uint32_t i = node.leftFirst; i < node.leftFirst + node.triangleCount; i++)
+			{
+				const TRIANGLE& triangle = m_triangles[i];
+				float distance, u, v;
+				if (IntersectTriangle(ray.origin, ray.direction, triangle.vertex0, triangle.edge1, triangle.edge2, hit.distance, distance, u, v))
+				{
+					hit.distance = distance;
+					hit.triangle = i;
+					hit.u = u;
+					hit.v = v;
+					bHit = true;
+				}
+			}
+		}
+		else
+		{
+			uint32_t nearChild = node.leftFirst;
+			uint32_t farChild = node.leftFirst + 1;
+			float nearDistance = IntersectBox(ray.origin, ray.inverseDirection, m_nodes[nearChild].boundsMin, m_nodes[nearChild].boundsMax, hit.distance);
+			float farDistance = IntersectBox(ray.origin, ray.inverseDirection, m_nodes[farChild].boundsMin, m_nodes[farChild].boundsMax, hit.distance);
+			if (farDistance < nearDistance)
+			{
+				std::swap(nearChild, farChild);
+				std::swap(nearDistance, farDistance);
+			}
+			if (nearDistance != NO_HIT)
+			{
+				if (farDistance != NO_HIT)
+				{
+					stack[stackSize++] = farChild;
+				}
+				nodeIndex = nearChild;
+				continue;
+			}
+		}
+
+		if (stackSize == 0)
+		{
+			break;
+		}
+		nodeIndex = stack[--stackSize];
+	}
+
+	return(bHit);
+}
+
+/***********************************************************
+ *  IntersectPacket()
+ *
+ *  This method is used for finding the closest hits of four
+ *  rays that start close together, like the camera rays of
+ *  a 2x2 pixel quad.  The rays go through the hierarchy
+ *  together, and every box and triangle is tested against
+ *  all four of them at once with SIMD.
+ ***********************************************************/
+void PathTracer::IntersectPacket(const RAY rays[4], HIT hits[4], bool bHits[4]) const
+{
+	for (int lane = 0; lane < 4; lane++)
+	{
+		hits[lane].distance = FAR_DISTANCE;
+		bHits[lane] = false;
+	}
+	if (m_nodes.empty())
+	{
+		return;
+	}
+
+	FLOAT4 originX = Set4(rays[0].origin.x, rays[1].origin.x, rays[2].origin.x, rays[3].origin.x);
+	FLOAT4 originY = Set4(rays[0].origin.y, rays[1].origin.y, rays[2].origin.y, rays[3].origin.y);
+	FLOAT4 originZ = Set4(rays[0].origin.z, rays[1].origin.z, rays[2].origin.z, rays[3].origin.z);
+	FLOAT4 directionX = Set4(rays[0].direction.x, rays[1].direction.x, rays[2].direction.x, rays[3].direction.x);
+	FLOAT4 directionY = Set4(rays[0].direction.y, rays[1].direction.y, rays[2].direction.y, rays[3].direction.y);
+	FLOAT4 directionZ = Set4(rays[0].direction.z, rays[1].direction.z, rays[2].direction.z, rays[3].direction.z);
+	FLOAT4 inverseX = Set4(rays[0].inverseDirection.x, rays[1].inverseDirection.x, rays[2].inverseDirection.x, rays[3].inverseDirection.x);
+	FLOAT4 inverseY = Set4(rays[0].inverseDirection.y, rays[1].inverseDirection.y, rays[2].inverseDirection.y, rays[3].inverseDirection.y);
+	FLOAT4 inverseZ = Set4(rays[0].inverseDirection.z, rays[1].inverseDirection.z, rays[2].inverseDirection.z, rays[3].inverseDirection.z);
+	const FLOAT4 zero = Splat4(0.0f);
+	const FLOAT4 one = Splat4(1.0f);
+	FLOAT4 closest = Splat4(FAR_DISTANCE);
+
+	uint32_t stack[TRAVERSAL_STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const BVH_NODE& node = m_nodes[stack[--stackSize]];
+
+		// slab test of the node box against all four rays
+		FLOAT4 x1 = (Splat4(node.boundsMin[0]) - originX) * inverseX;
+		FLOAT4 x2 = (Splat4(node.boundsMax[0]) - originX) * inverseX;
+		FLOAT4 y1 = (Splat4(node.boundsMin[1]) - originY) * inverseY;
+		FLOAT4 y2 = (Splat4(node.boundsMax[1]) - originY) * inverseY;
+		FLOAT4 z1 = (Splat4(node.boundsMin[2]) - originZ) * inverseZ;
+		FLOAT4 z2 = (Splat4(node.boundsMax[2]) - originZ) * inverseZ;
+		FLOAT4 nearDistance = Max4(Max4(Min4(x1, x2), Min4(y1, y2)), Max4(Min4(z1, z2), zero));
+		FLOAT4 farDistance = Min4(Min4(Max4(x1, x2), Max4(y1, y2)), Min4(Max4(z1, z2), closest));
+		if (MoveMask(LessEqual4(nearDistance, farDistance)) == 0)
+		{
+			continue;
+		}
+
+		if (node.triangleCount == 0)
+		{
+			// visit the child on the side the rays come from first
+			uint32_t firstChild = node.leftFirst;
+			uint32_t secondChild = node.leftFirst + 1;
+			if (rays[0].direction[node.splitAxis] < 0.0f)
+			{
+				std::swap(firstChild, secondChild);
+			}
+			stack[stackSize++] = secondChild;
+			stack[stackSize++] = firstChild;
+			continue;
+		}
+
+		for (uint32_t i = node.leftFirst; i < node.leftFirst + node.triangleCount; i++)
+		{
+			const TRIANGLE& triangle = m_triangles[i];
+			FLOAT4 edge1X = Splat4(triangle.edge1.x);
+			FLOAT4 edge1Y = Splat4(triangle.edge1.y);
+			FLOAT4 edge1Z = Splat4(triangle.edge1.z);
+			FLOAT4 edge2X = Splat4(triangle.edge2.x);
+			FLOAT4 edge2Y = Splat4(triangle.edge2.y);
+			FLOAT4 edge2Z = Splat4(triangle.edge2.z);
+
+			FLOAT4 pX = directionY * edge2Z - directionZ * edge2Y;
+			FLOAT4 pY = directionZ * edge2X - directionX * edge2Z;
+			FLOAT4 pZ = directionX * edge2Y - directionY * edge2X;
+			FLOAT4 determinant = edge1X * pX + edge1Y * pY + edge1Z * pZ;
+			FLOAT4 inverseDeterminant = one / determinant;
+
+			FLOAT4 toOriginX = originX - Splat4(triangle.vertex0.x);
+			FLOAT4 toOriginY = originY - Splat4(triangle.vertex0.y);
+			FLOAT4 toOriginZ = originZ - Splat4(triangle.vertex0.z);
+			FLOAT4 u = (toOriginX * pX + toOriginY * pY + toOriginZ * pZ) * inverseDeterminant;
+
+			FLOAT4 qX = toOriginY * edge1Z - toOriginZ * edge1Y;
+			FLOAT4 qY = toOriginZ * edge1X - toOriginX * edge1Z;
+			FLOAT4 qZ = toOriginX * edge1Y - toOriginY * edge1X;
+			FLOAT4 v = (directionX * qX + directionY * qY + directionZ * qZ) * inverseDeterminant;
+			FLOAT4 distance = (edge2X * qX + edge2Y * qY + edge2Z * qZ) * inverseDeterminant;
+
+			FLOAT4 mask = Or4(Less4(Splat4(DETERMINANT_EPSILON), determinant), Less4(determinant, Splat4(-DETERMINANT_EPSILON)));
+			mask = And4(mask, And4(LessEqual4(zero, u), LessEqual4(zero, v)));
+			mask = And4(mask, LessEqual4(u + v, one));
+			mask = And4(mask, And4(Less4(Splat4(MIN_HIT_DISTANCE), distance), Less4(distance, closest)));
+			int bits = MoveMask(mask);
+			if (bits == 0)
+			{
+				continue;
+			}
+
+			closest = Select4(mask, distance, closest);
+			float distances[4];
+			float us[4];
+			float vs[4];
+			Store4(distance, distances);
+			Store4(u, us);
+			Store4(v, vs);
+			for (int lane = 0; lane < 4; lane++)
+			{
+				if (bits & (1 << lane))
+				{
+					hits[lane].distance = distances[lane];
+					hits[lane].triangle = i;
+					hits[lane].u = us[lane];
+					hits[lane].v = vs[lane];
+					bHits[lane] = true;
+				}
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  Transmittance()
+ *
+ *  This method is used for finding how much light gets
+ *  through along a shadow ray.  Opaque triangles block it,
+ *  see-through colors let part of it through, and text does
+ *  not cast shadows.  The order of the hits does not matter,
+ *  so the nodes are visited in any order.
+ ***********************************************************/
+float PathTracer::Transmittance(const RAY& ray, float maxDistance) const
+{
+	if (m_nodes.empty())
+	{
+		return(1.0f);
+	}
+
+	float transmittance = 1.0f;
+	uint32_t stack[TRAVERSAL_STACK_SIZE];
+	int stackSize = 0;
+	stack[stackSize++] = 0;
+	while (stackSize > 0)
+	{
+		const BVH_NODE& node = m_nodes[stack[--stackSize]];
+		if (IntersectBox(ray.origin, ray.inverseDirection, node.boundsMin, node.boundsMax, maxDistance) == NO_HIT)
+		{
+			continue;
+		}
+		if (node.triangleCount == 0)
+		{
+			stack[stackSize++] = node.leftFirst;
+			stack[stackSize++] = node.leftFirst + 1;
+			continue;
+		}
+
+		for (uint32_t i = node.leftFirst; i < node.leftFirst + node.triangleCount; i++)
+		{
+			const TRIANGLE& triangle = m_triangles[i];
+			float distance, u, v;
+			if (!IntersectTriangle(ray.origin, ray.direction, triangle.vertex0, triangle.edge1, triangle.edge2, maxDistance, distance, u, v))
+			{
+				continue;
+			}
+
+			const DRAW_CALL& draw = m_draws[m_shading[i].drawIndex];
+			if (draw.bTextSDF)
+			{
+				continue;
+			}
+			// the lit shader path takes the color of textured
+			// objects from the texture, which is opaque
+			float opacity = (draw.textureIndex >= 0) ? 1.0f : draw.color.a;
+			if (opacity >= 1.0f)
+			{
+				return(0.0f);
+			}
+			transmittance *= 1.0f - opacity;
+		}
+	}
+
+	return(transmittance);
+}
+
+/***********************************************************
+ *  RenderPass()
+ *
+ *  This method is used for adding one sample to every pixel.
+ *  The tiles are spread over the threads, and each tile only
+ *  writes its own pixels.
+ ***********************************************************/
+void PathTracer::RenderPass(int threadCount)
+{
+	PROFILE_SCOPE("PathTracer::RenderPass");
+	if ((m_width <= 0) || (m_height <= 0))
+	{
+		return;
+	}
+
+	int tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+	int tilesY = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+	ParallelFor(tilesX * tilesY, [&](int tileIndex)
+	{
+		RenderTile(tileIndex);
+	}, threadCount);
+
+	m_sampleCount++;
+}
+
+/***********************************************************
+ *  RenderTile()
+ *
+ *  This method is used for tracing one path through every
+ *  pixel of a tile.  The camera rays of each 2x2 quad are
+ *  jittered inside their pixels and traced as a packet, and
+ *  the paths then go on one by one.
+ ***********************************************************/
+void PathTracer::RenderTile(int tileIndex)
+{
+	int tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+	int tileX0 = (tileIndex % tilesX) * TILE_SIZE;
+	int tileY0 = (tileIndex / tilesX) * TILE_SIZE;
+	int tileX1 = std::min(tileX0 + TILE_SIZE, m_width);
+	int tileY1 = std::min(tileY0 + TILE_SIZE, m_height);
+	uint32_t sampleSeed = HashValue((uint32_t)m_sampleCount * 0x9E3779B9u + 1u);
+
+	for (int quadY = tileY0; quadY < tileY1; quadY += 2)
+	{
+		for (int quadX = tileX0; quadX < tileX1; quadX += 2)
+		{
+			RAY rays[4];
+			uint32_t randomStates[4];
+			for (int lane = 0; lane < 4; lane++)
+			{
+				// pixels past the image edge are traced but not kept
+				int x = std::min(quadX + (lane & 1), m_width - 1);
+				int y = std::min(quadY + (lane >> 1), m_height - 1);
+				randomStates[lane] = HashValue((uint32_t)(y * m_width + x) ^ sampleSeed);
+
+				float ndcX = (x + NextRandom(randomStates[lane])) / m_width * 2.0f - 1.0f;
+				float ndcY = (y + NextRandom(randomStates[lane])) / m_height * 2.0f - 1.0f;
+				glm::vec4 nearPoint = m_inverseViewProjection * glm::vec4(ndcX, ndcY, -1.0f, 1.0f);
+				glm::vec4 farPoint = m_inverseViewProjection * glm::vec4(ndcX, ndcY, 1.0f, 1.0f);
+				glm::vec3 origin = glm::vec3(nearPoint) / nearPoint.w;
+				glm::vec3 target = glm::vec3(farPoint) / farPoint.w;
+				rays[lane] = MakeRay(origin, glm::normalize(target - origin));
+			}
+
+			HIT hits[4];
+			bool bHits[4];
+			IntersectPacket(rays, hits, bHits);
+
+			for (int lane = 0; lane < 4; lane++)
+			{
+				int x = quadX + (lane & 1);
+				int y = quadY + (lane >> 1);
+				if ((x >= tileX1) || (y >= tileY1))
+				{
+					continue;
+				}
+				glm::vec3 radiance = TracePath(rays[lane], hits[lane], bHits[lane], randomStates[lane]);
+				m_accumulation[(size_t)y * m_width + x] += glm::min(radiance, glm::vec3(MAX_SAMPLE_RADIANCE));
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  TracePath()
+ *
+ *  This method is used for following a light path back from
+ *  the camera.  At every hit the lights are sampled directly,
+ *  then the BRDF picks where the path bounces to, until it
+ *  escapes to the sky or is ended.
+ ***********************************************************/
+glm::vec3 PathTracer::TracePath(RAY ray, HIT hit, bool bHit, uint32_t& randomState) const
+{
+	glm::vec3 radiance(0.0f);
+	glm::vec3 throughput(1.0f);
+	int bounce = 0;
+	int passThroughs = 0;
+
+	while (true)
+	{
+		if (!bHit)
+		{
+			// camera rays that miss show the black clear color
+			// of the window, bounced rays gather the sky
+			if (bounce > 0)
+			{
+				radiance += throughput * m_skyColor;
+			}
+			break;
+		}
+
+		SURFACE surface;
+		GetSurface(ray, hit, surface);
+
+		// go on through see-through colors and glyph gaps, as
+		// often as the surface lets light through
+		if (NextRandom(randomState) >= surface.baseColor.a)
+		{
+			if (++passThroughs > MAX_PASS_THROUGHS)
+			{
+				break;
+			}
+			ray = MakeRay(surface.position + ray.direction * RAY_OFFSET, ray.direction);
+			bHit = Intersect(ray, FAR_DISTANCE, hit);
+			continue;
+		}
+
+		glm::vec3 viewDir = -ray.direction;
+		radiance += throughput * SampleLights(surface, viewDir, randomState);
+		if (bounce >= m_maxBounces)
+		{
+			break;
+		}
+
+		glm::vec3 direction;
+		glm::vec3 weight;
+		if (!SampleBRDF(surface, viewDir, randomState, direction, weight))
+		{
+			break;
+		}
+		throughput *= weight;
+		bounce++;
+
+		// end dim paths at random, and make the ones that go on
+		// brighter so the average stays the same
+		if (bounce >= ROULETTE_BOUNCE)
+		{
+			float survival = std::min(std::max(throughput.r, std::max(throughput.g, throughput.b)), 0.95f);
+			if (NextRandom(randomState) >= survival)
+			{
+				break;
+			}
+			throughput /= survival;
+		}
+
+		float side = (glm::dot(direction, surface.geometricNormal) >= 0.0f) ? 1.0f : -1.0f;
+		ray = MakeRay(surface.position + surface.geometricNormal * (side * RAY_OFFSET), direction);
+		bHit = Intersect(ray, FAR_DISTANCE, hit);
+	}
+
+	return(radiance);
+}
+
+/***********************************************************
+ *  GetSurface()
+ *
+ *  This method is used for getting the position, normals,
+ *  color and material at a hit.  Both sides of a triangle
+ *  are drawn, so the normals are turned to face the ray.
+ ***********************************************************/
+void PathTracer::GetSurface(const RAY& ray, const HIT& hit, SURFACE& surface) const
+{
+	const TRIANGLE& triangle = m_triangles[hit.triangle];
+	const TRIANGLE_SHADING& shading = m_shading[hit.triangle];
+	const DRAW_CALL& draw = m_draws[shading.drawIndex];
+	float w = 1.0f - hit.u - hit.v;
+
+	surface.position = ray.origin + ray.direction * hit.distance;
+	surface.geometricNormal = glm::normalize(glm::cross(triangle.edge1, triangle.edge2));
+	if (glm::dot(surface.geometricNormal, ray.direction) > 0.0f)
+	{
+		surface.geometricNormal = -surface.geometricNormal;
+	}
+	surface.normal = shading.normals[0] * w + shading.normals[1] * hit.u + shading.normals[2] * hit.v;
+	float normalLength = glm::length(surface.normal);
+	surface.normal = (normalLength > 0.0f) ? surface.normal / normalLength : surface.geometricNormal;
+	if (glm::dot(surface.normal, surface.geometricNormal) < 0.0f)
+	{
+		surface.normal = -surface.normal;
+	}
+
+	surface.baseColor = draw.color;
+	surface.pMaterial = &draw.material;
+	if (draw.textureIndex >= 0)
+	{
+		glm::vec2 uv = shading.uvs[0] * w + shading.uvs[1] * hit.u + shading.uvs[2] * hit.v;
+		glm::vec4 texel = SampleTexture(m_textures[draw.textureIndex], uv.x, uv.y);
+		if (draw.bTextSDF)
+		{
+			// the many samples of each pixel smooth the glyph edges
+			if (texel.r < 0.5f)
+			{
+				surface.baseColor.a = 0.0f;
+			}
+		}
+		else
+		{
+			// the lit shader path does not apply the UV scale
+			surface.baseColor = texel;
+		}
+	}
+}
+
+/***********************************************************
+ *  SampleLights()
+ *
+ *  This method is used for adding up the light that reaches
+ *  a surface straight from the light sources.  A random
+ *  point of each light is picked for its shadow ray, which
+ *  makes the shadows soft.  The intensities are in the units
+ *  of the shader, which has the 1/PI of the diffuse term
+ *  folded into the light colors.
+ ***********************************************************/
+glm::vec3 PathTracer::SampleLights(const SURFACE& surface, const glm::vec3& viewDir, uint32_t& randomState) const
+{
+	glm::vec3 result(0.0f);
+	glm::vec3 shadowOrigin = surface.position + surface.geometricNormal * RAY_OFFSET;
+
+	auto addLight = [&](const glm::vec3& lightDir, const glm::vec3& lightColor, float maxDistance)
+	{
+		float NdotL = glm::dot(surface.normal, lightDir);
+		if ((NdotL <= 0.0f) || (glm::dot(surface.geometricNormal, lightDir) <= 0.0f))
+		{
+			return;
+		}
+		float visibility = Transmittance(MakeRay(shadowOrigin, lightDir), maxDistance);
+		if (visibility > 0.0f)
+		{
+			result += EvaluateBRDF(surface, viewDir, lightDir) * lightColor * (PI * NdotL * visibility);
+		}
+	};
+
+	const DIRECTIONAL_LIGHT& directional = m_lights.directionalLight;
+	if (directional.bActive)
+	{
+		glm::vec3 lightDir = glm::normalize(-directional.direction);
+		lightDir = glm::normalize(lightDir + RandomOnSphere(randomState) * DIRECTIONAL_LIGHT_SPREAD);
+		addLight(lightDir, directional.diffuse, FAR_DISTANCE);
+	}
+
+	for (int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+	{
+		const POINT_LIGHT& light = m_lights.pointLights[i];
+		if (!light.bActive)
+		{
+			continue;
+		}
+		glm::vec3 toLight = light.position + RandomOnSphere(randomState) * POINT_LIGHT_RADIUS - surface.position;
+		float distance = glm::length(toLight);
+		if (distance > RAY_OFFSET)
+		{
+			// the shader does not attenuate the point lights
+			addLight(toLight / distance, light.diffuse, distance - RAY_OFFSET);
+		}
+	}
+
+	const SPOT_LIGHT& spot = m_lights.spotLight;
+	if (spot.bActive)
+	{
+		glm::vec3 toLight = spot.position + RandomOnSphere(randomState) * SPOT_LIGHT_RADIUS - surface.position;
+		float distance = glm::length(toLight);
+		if (distance > RAY_OFFSET)
+		{
+			glm::vec3 lightDir = toLight / distance;
+			float attenuation = 1.0f / (spot.constant + spot.linear * distance + spot.quadratic * (distance * distance));
+			float theta = glm::dot(lightDir, glm::normalize(-spot.direction));
+			float intensity = std::min(std::max((theta - spot.outerCutOff) / (spot.cutOff - spot.outerCutOff), 0.0f), 1.0f);
+			if (intensity > 0.0f)
+			{
+				addLight(lightDir, spot.diffuse * (attenuation * intensity), distance - RAY_OFFSET);
+			}
+		}
+	}
+
+	return(result);
+}
+
+/***********************************************************
+ *  EvaluateBRDF()
+ *
+ *  This method is used for the metallic-roughness BRDF of
+ *  fragmentShader.glsl - lambert diffuse, GGX distribution,
+ *  height correlated Smith visibility and Schlick fresnel.
+ ***********************************************************/
+glm::vec3 PathTracer::EvaluateBRDF(const SURFACE& surface, const glm::vec3& viewDir, const glm::vec3& lightDir) const
+{
+	const MATERIAL& material = *surface.pMaterial;
+	float NdotL = glm::dot(surface.normal, lightDir);
+	if (NdotL <= 0.0f)
+	{
+		return(glm::vec3(0.0f));
+	}
+	float NdotV = std::max(glm::dot(surface.normal, viewDir), 0.0001f);
+
+	glm::vec3 baseColor(surface.baseColor);
+	float roughness = std::min(std::max(material.roughness, 0.04f), 1.0f);
+	float alpha = roughness * roughness;
+	glm::vec3 F0 = glm::mix(glm::vec3(0.04f), baseColor, material.metallic);
+	glm::vec3 diffuseColor = baseColor * (1.0f - material.metallic);
+
+	glm::vec3 halfway = glm::normalize(lightDir + viewDir);
+	float NdotH = std::max(glm::dot(surface.normal, halfway), 0.0f);
+	float VdotH = std::max(glm::dot(viewDir, halfway), 0.0f);
+
+	// GGX normal distribution
+	float alpha2 = alpha * alpha;
+	float denominator = NdotH * NdotH * (alpha2 - 1.0f) + 1.0f;
+	float D = alpha2 / (PI * denominator * denominator);
+	// height correlated Smith visibility
+	float visibilityV = NdotL * std::sqrt(NdotV * NdotV * (1.0f - alpha2) + alpha2);
+	float visibilityL = NdotV * std::sqrt(NdotL * NdotL * (1.0f - alpha2) + alpha2);
+	float V = 0.5f / std::max(visibilityV + visibilityL, 0.0001f);
+	// Schlick fresnel
+	float oneMinusVdotH = 1.0f - VdotH;
+	float squared = oneMinusVdotH * oneMinusVdotH;
+	glm::vec3 F = F0 + (glm::vec3(1.0f) - F0) * (squared * squared * oneMinusVdotH);
+
+	return(diffuseColor * (glm::vec3(1.0f) - F) * (1.0f / PI) + F * (D * V));
+}
+
+/***********************************************************
+ *  SampleBRDF()
+ *
+ *  This method is used for picking the direction a path
+ *  bounces to.  Either the diffuse lobe is sampled by the
+ *  cosine, or the specular lobe by the GGX distribution,
+ *  chosen by how much each one reflects.  The weight is the
+ *  BRDF times the cosine over the combined probability of
+ *  both lobes, so either choice gives the same average.
+ ***********************************************************/
+bool PathTracer::SampleBRDF(const SURFACE& surface, const glm::vec3& viewDir, uint32_t& randomState, glm::vec3& direction, glm::vec3& weight) const
+{
+	const MATERIAL& material = *surface.pMaterial;
+	const glm::vec3& normal = surface.normal;
+	float NdotV = std::max(glm::dot(normal, viewDir), 0.0001f);
+
+	glm::vec3 baseColor(surface.baseColor);
+	float roughness = std::min(std::max(material.roughness, 0.04f), 1.0f);
+	float alpha = roughness * roughness;
+	float alpha2 = alpha * alpha;
+	glm::vec3 F0 = glm::mix(glm::vec3(0.04f), baseColor, material.metallic);
+	float oneMinusNdotV = 1.0f - NdotV;
+	float fresnel = oneMinusNdotV * oneMinusNdotV * oneMinusNdotV * oneMinusNdotV * oneMinusNdotV;
+	float specularAmount = Luminance(F0 + (glm::vec3(1.0f) - F0) * fresnel);
+	float diffuseAmount = Luminance(baseColor * (1.0f - material.metallic)) * (1.0f - specularAmount);
+	float specularProbability = 1.0f;
+	if (diffuseAmount > 0.0f)
+	{
+		specularProbability = std::min(std::max(specularAmount / (specularAmount + diffuseAmount), 0.1f), 0.9f);
+	}
+
+	glm::vec3 tangent;
+	glm::vec3 bitangent;
+	MakeBasis(normal, tangent, bitangent);
+	float u1 = NextRandom(randomState);
+	float u2 = NextRandom(randomState);
+	float phi = 2.0f * PI * u2;
+	if (NextRandom(randomState) < specularProbability)
+	{
+		float cosTheta = std::sqrt((1.0f - u1) / (1.0f + (alpha2 - 1.0f) * u1));
+		float sinTheta = std::sqrt(std::max(0.0f, 1.0f - cosTheta * cosTheta));
+		glm::vec3 halfway = tangent * (sinTheta * std::cos(phi)) + bitangent * (sinTheta * std::sin(phi)) + normal * cosTheta;
+		direction = halfway * (2.0f * glm::dot(viewDir, halfway)) - viewDir;
+	}
+	else
+	{
+		float radius = std::sqrt(u1);
+		direction = tangent * (radius * std::cos(phi)) + bitangent * (radius * std::sin(phi)) + normal * std::sqrt(std::max(0.0f, 1.0f - u1));
+	}
+
+	float NdotL = glm::dot(normal, direction);
+	if ((NdotL <= 0.0f) || (glm::dot(surface.geometricNormal, direction) <= 0.0f))
+	{
+		return(false);
+	}
+
+	glm::vec3 halfway = glm::normalize(direction + viewDir);
+	float NdotH = std::max(glm::dot(normal, halfway), 0.0f);
+	float VdotH = std::max(glm::dot(viewDir, halfway), 0.0001f);
+	float denominator = NdotH * NdotH * (alpha2 - 1.0f) + 1.0f;
+	float D = alpha2 / (PI * denominator * denominator);
+	float probability = specularProbability * D * NdotH / (4.0f * VdotH) +
+		(1.0f - specularProbability) * NdotL / PI;
+	if (!(probability > 0.0f))
+	{
+		return(false);
+	}
+
+	weight = EvaluateBRDF(surface, viewDir, direction) * (NdotL / probability);
+	return(true);
+}
+
+/***********************************************************
+ *  ResolvePixels()
+ *
+ *  This method is used for averaging the samples of every
+ *  pixel into BGRA bytes, clamped like the framebuffer.
+ ***********************************************************/
+void PathTracer::ResolvePixels(std::vector<unsigned char>& pixels) const
+{
+	pixels.assign((size_t)m_width * m_height * 4, 0);
+	float scale = 1.0f / std::max(m_sampleCount, 1);
+	for (size_t i = 0; i < m_accumulation.size(); i++)
+	{
+		glm::vec3 color = m_accumulation[i] * scale;
+		for (int channel = 0; channel < 3; channel++)
+		{
+			float value = std::min(std::max(color[channel], 0.0f), 1.0f);
+			// BGRA - swap red and blue
+			pixels[i * 4 + 2 - channel] = (unsigned char)(value * 255.0f + 0.5f);
+		}
+		pixels[i * 4 + 3] = 255;
+	}
+}
+
+/***********************************************************
+ *  SampleTexture()
+ *
+ *  This method is used for a bilinear lookup with repeat
+ *  wrapping, like the GL_LINEAR and GL_REPEAT textures of
+ *  the scene.
+ ***********************************************************/
+glm::vec4 PathTracer::SampleTexture(const TEXTURE& texture, float u, float v)
+{
+	if (!std::isfinite(u) || !std::isfinite(v))
+	{
+		u = 0.0f;
+		v = 0.0f;
+	}
+
+	// texel centers are at half texel offsets
+	float x = (u - std::floor(u)) * texture.width - 0.5f;
+	float y = (v - std::floor(v)) * texture.height - 0.5f;
+	float floorX = std::floor(x);
+	float floorY = std::floor(y);
+	float fractionX = x - floorX;
+	float fractionY = y - floorY;
+
+	int x0 = (int)floorX;
+	int y0 = (int)floorY;
+	if (x0 < 0) x0 += texture.width;
+	if (y0 < 0) y0 += texture.height;
+	if (x0 >= texture.width) x0 -= texture.width;
+	if (y0 >= texture.height) y0 -= texture.height;
+	int x1 = (x0 + 1 < texture.width) ? x0 + 1 : 0;
+	int y1 = (y0 + 1 < texture.height) ? y0 + 1 : 0;
+
+	const uint32_t* row0 = &texture.texels[(size_t)y0 * texture.width];
+	const uint32_t* row1 = &texture.texels[(size_t)y1 * texture.width];
+	uint32_t texels[4] = { row0[x0], row0[x1], row1[x0], row1[x1] };
+
+	glm::vec4 corners[4];
+	for (int i = 0; i < 4; i++)
+	{
+		corners[i] = glm::vec4(
+			(float)(texels[i] & 0xFF),
+			(float)((texels[i] >> 8) & 0xFF),
+			(float)((texels[i] >> 16) & 0xFF),
+			(float)(texels[i] >> 24));
+	}
+	glm::vec4 top = corners[0] + (corners[1] - corners[0]) * fractionX;
+	glm::vec4 bottom = corners[2] + (corners[3] - corners[2]) * fractionX;
+	return((top + (bottom - top) * fractionY) * (1.0f / 255.0f));
+}
@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////////////////
+// pathtracer.h
+// ============
+// render stills with global illumination and soft shadows on the CPU
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneLights.h"
+#include "ShapeGeometry.h"
+#include "SoftwareRasterizer.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  PathTracer
+ *
+ *  This class renders the scene draws by tracing light paths
+ *  through a bounding volume hierarchy of all triangles.  The
+ *  materials become metallic-roughness BRDFs, the scene lights
+ *  get a size so their shadows are soft, and the ambient light
+ *  becomes a sky that the bounced light is gathered from.
+ *
+ *  Every RenderPass() adds one sample to each pixel, so the
+ *  image gets less noisy the longer it renders.  The random
+ *  numbers only depend on the pixel and the sample, so the
+ *  image does not depend on the number of threads.
+ ***********************************************************/
+class PathTracer
+{
+public:
+	// constructor
+	PathTracer();
+	// destructor
+	~PathTracer();
+
+	// the draws are described the same way as for the rasterizer
+	typedef SoftwareRasterizer::MATERIAL MATERIAL;
+	typedef SoftwareRasterizer::DRAW_CALL DRAW_CALL;
+
+	// set the image size, and restart the accumulation
+	void SetTarget(int width, int height);
+	// set the view, projection and camera position
+	void SetCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition);
+	// set the light sources
+	void SetLights(const SCENE_LIGHTS& lights);
+	// set how many times a path may bounce
+	void SetMaxBounces(int maxBounces);
+	// copy an image with 1, 3 or 4 channels, bottom row first
+	int AddTexture(int width, int height, int colorChannels, const unsigned char* pixels);
+	// queue a draw - the mesh has to stay valid until BuildScene()
+	void Submit(const DRAW_CALL& draw);
+	// build the hierarchy over the triangles of the queued draws
+	void BuildScene();
+	// add one sample to every pixel, on all cores when the
+	// thread count is 0
+	void RenderPass(int threadCount = 0);
+
+	// averaged samples as BGRA, bottom row first
+	void ResolvePixels(std::vector<unsigned char>& pixels) const;
+	int GetWidth() const { return(m_width); }
+	int GetHeight() const { return(m_height); }
+	int GetSampleCount() const { return(m_sampleCount); }
+	size_t GetTriangleCount() const { return(m_triangles.size()); }
+	size_t GetNodeCount() const { return(m_nodes.size()); }
+
+private:
+	struct TEXTURE
+	{
+		int width;
+		int height;
+		// RGBA, red in the lowest byte
+		std::vector<uint32_t> texels;
+	};
+
+	// world space triangle, laid out for the intersection test
+	struct TRIANGLE
+	{
+		glm::vec3 vertex0;
+		glm::vec3 edge1;
+		glm::vec3 edge2;
+	};
+
+	// values only needed once a triangle was hit
+	struct TRIANGLE_SHADING
+	{
+		glm::vec3 normals[3];
+		glm::vec2 uvs[3];
+		uint32_t drawIndex;
+	};
+
+	// bounding box node - the children of an inner node are
+	// next to each other at leftFirst, a leaf holds the
+	// triangles starting at leftFirst
+	struct BVH_NODE
+	{
+		float boundsMin[3];
+		uint32_t leftFirst;
+		float boundsMax[3];
+		uint16_t triangleCount;
+		uint16_t splitAxis;
+	};
+
+	struct RAY
+	{
+		glm::vec3 origin;
+		glm::vec3 direction;
+		glm::vec3 inverseDirection;
+	};
+
+	// closest triangle along a ray
+	struct HIT
+	{
+		float distance;
+		uint32_t triangle;
+		float u;
+		float v;
+	};
+
+	// shading values at a hit
+	struct SURFACE
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec3 geometricNormal;
+		glm::vec4 baseColor;
+		const MATERIAL* pMaterial;
+	};
+
+	// image and camera
+	int m_width;
+	int m_height;
+	glm::mat4 m_inverseViewProjection;
+	glm::vec3 m_viewPosition;
+	SCENE_LIGHTS m_lights;
+	// radiance coming from everywhere the paths escape to
+	glm::vec3 m_skyColor;
+	int m_maxBounces;
+	// textures and draws, and their triangles in the hierarchy
+	std::vector<TEXTURE> m_textures;
+	std::vector<DRAW_CALL> m_draws;
+	std::vector<TRIANGLE> m_triangles;
+	std::vector<TRIANGLE_SHADING> m_shading;
+	std::vector<BVH_NODE> m_nodes;
+	// summed samples of every pixel
+	std::vector<glm::vec3> m_accumulation;
+	int m_sampleCount;
+
+	// make a ray with the inverse direction for the box tests
+	static RAY MakeRay(const glm::vec3& origin, const glm::vec3& direction);
+	// build the hierarchy over the triangles in m_triangles
+	void BuildHierarchy();
+	// find the closest hit of a ray, closer than maxDistance
+	bool Intersect(const RAY& ray, float maxDistance, HIT& hit) const;
+	// find the closest hits of four rays at once
+	void IntersectPacket(const RAY rays[4], HIT hits[4], bool bHits[4]) const;
+	// light let through along a ray, 0 when it is blocked
+	float Transmittance(const RAY& ray, float maxDistance) const;
+	// add one sample to the pixels of a tile
+	void RenderTile(int tileIndex);
+	// follow a path from its first hit, and get its radiance
+	glm::vec3 TracePath(RAY ray, HIT hit, bool bHit, uint32_t& randomState) const;
+	// get the shading values at a hit
+	void GetSurface(const RAY& ray, const HIT& hit, SURFACE& surface) const;
+	// light arriving directly from the light sources
+	glm::vec3 SampleLights(const SURFACE& surface, const glm::vec3& viewDir, uint32_t& randomState) const;
+	// BRDF value for a pair of directions
+	glm::vec3 EvaluateBRDF(const SURFACE& surface, const glm::vec3& viewDir, const glm::vec3& lightDir) const;
+	// pick a bounce direction, and get the BRDF weight of it
+	bool SampleBRDF(const SURFACE& surface, const glm::vec3& viewDir, uint32_t& randomState, glm::vec3& direction, glm::vec3& weight) const;
+	// bilinear texture lookup with repeat wrapping
+	static glm::vec4 SampleTexture(const TEXTURE& texture, float u, float v);
+};
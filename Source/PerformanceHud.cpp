@@ -0,0 +1,352 @@
+///////////////////////////////////////////////////////////////////////////////
+// performancehud.cpp
+// ============
+// lay out the frame time graph and counters of the on-screen HUD
+///////////////////////////////////////////////////////////////////////////////
+
+#include "PerformanceHud.h"
+#include "MemoryTracker.h"
+
+#include <glm/gtc/matrix_transform.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// position, normal and texture coordinate - the layout
+	// of the text blocks
+	const int FLOATS_PER_VERTEX = 8;
+	const int VERTICES_PER_QUAD = 6;
+	// enough for the graph and full lines of text
+	const int MAX_VERTICES = 4096;
+
+	// sizes in pixels
+	const float MARGIN = 12.0f;
+	const float TEXT_SIZE = 18.0f;
+	const float GRAPH_GAP = 6.0f;
+	const float GRAPH_HEIGHT = 80.0f;
+	const float BAR_WIDTH = 2.0f;
+	// frame time at the top of the graph, and the 60 and 30
+	// FPS budgets marked across it, in milliseconds
+	const float GRAPH_MAX_TIME = 50.0f;
+	const float BUDGET_TIMES[] = { 1000.0f / 60.0f, 1000.0f / 30.0f };
+	// milliseconds of frames between updates of the text
+	const double TEXT_INTERVAL = 250.0;
+	const double BYTES_PER_MEGABYTE = 1024.0 * 1024.0;
+}
+
+/***********************************************************
+ *  PerformanceHud()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+PerformanceHud::PerformanceHud()
+{
+	m_pDevice = NULL;
+	m_pipeline = 0;
+	m_vertexBuffer = 0;
+	m_vertexCount = 0;
+	m_projection = glm::mat4(1.0f);
+	m_color = glm::vec4(1.0f, 0.85f, 0.2f, 1.0f);
+	m_bVisible = false;
+	m_bSolidTexelFound = false;
+	m_solidU = 0.0f;
+	m_solidV = 0.0f;
+	for (int i = 0; i < GRAPH_FRAMES; i++)
+	{
+		m_frameTimes[i] = 0.0f;
+	}
+	m_nextFrame = 0;
+	m_drawCalls = 0;
+	m_triangles = 0;
+	m_textFrames = 0;
+	m_textFrameTime = 0.0;
+	m_textMaxFrameTime = 0.0;
+	m_updateTime = 0.0;
+	for (int i = 0; i < LINE_COUNT; i++)
+	{
+		m_lines[i][0] = '\0';
+	}
+}
+
+/***********************************************************
+ *  ~PerformanceHud()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+PerformanceHud::~PerformanceHud()
+{
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the pipeline of the
+ *  overlay, which is drawn over everything, and its vertex
+ *  buffer, big enough for the whole overlay.
+ ***********************************************************/
+bool PerformanceHud::Create(RenderDevice* pDevice)
+{
+	m_pDevice = pDevice;
+	if (NULL == m_pDevice)
+	{
+		return(false);
+	}
+
+	RenderDevice::PIPELINE_DESC pipelineDesc = RenderDevice::GetPipelineDesc();
+	pipelineDesc.bDepthTest = false;
+	pipelineDesc.bDepthWrite = false;
+	m_pipeline = m_pDevice->CreatePipeline(pipelineDesc);
+
+	RenderDevice::BUFFER_DESC bufferDesc;
+	bufferDesc.type = RenderDevice::BUFFER_VERTEX;
+	bufferDesc.size = MAX_VERTICES * FLOATS_PER_VERTEX * sizeof(float);
+	bufferDesc.bDynamic = true;
+	m_vertexBuffer = m_pDevice->CreateBuffer(bufferDesc, NULL);
+	if (m_vertexBuffer == 0)
+	{
+		std::cout << "ERROR: Could not create the vertex buffer of the HUD" << std::endl;
+		Destroy();
+		return(false);
+	}
+
+	m_vertices.reserve(MAX_VERTICES * FLOATS_PER_VERTEX);
+	return(true);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the pipeline and vertex
+ *  buffer of the overlay.
+ ***********************************************************/
+void PerformanceHud::Destroy()
+{
+	if (NULL == m_pDevice)
+	{
+		return;
+	}
+	if (m_vertexBuffer != 0)
+	{
+		m_pDevice->DestroyBuffer(m_vertexBuffer);
+		m_vertexBuffer = 0;
+	}
+	if (m_pipeline != 0)
+	{
+		m_pDevice->DestroyPipeline(m_pipeline);
+		m_pipeline = 0;
+	}
+	m_vertexCount = 0;
+}
+
+/***********************************************************
+ *  AddFrame()
+ *
+ *  This method is used for adding a finished frame to the
+ *  graph, and writing the text again once enough frame time
+ *  has passed.
+ ***********************************************************/
+void PerformanceHud::AddFrame(double frameTime, const RenderStatistics::FRAME_STATISTICS* pFrame)
+{
+	m_frameTimes[m_nextFrame] = (float)frameTime;
+	m_nextFrame = (m_nextFrame + 1) % GRAPH_FRAMES;
+	if (NULL != pFrame)
+	{
+		m_drawCalls = pFrame->drawCalls;
+		m_triangles = pFrame->triangles;
+	}
+
+	m_textFrames++;
+	m_textFrameTime += frameTime;
+	m_textMaxFrameTime = std::max(m_textMaxFrameTime, frameTime);
+	if (m_textFrameTime >= TEXT_INTERVAL)
+	{
+		UpdateText();
+		m_textFrames = 0;
+		m_textFrameTime = 0.0;
+		m_textMaxFrameTime = 0.0;
+	}
+}
+
+/***********************************************************
+ *  UpdateText()
+ *
+ *  This method is used for writing the lines of the overlay
+ *  from the frames added since the last time.
+ ***********************************************************/
+void PerformanceHud::UpdateText()
+{
+	double averageTime = m_textFrameTime / std::max(m_textFrames, 1);
+	double framesPerSecond = (averageTime > 0.0) ? 1000.0 / averageTime : 0.0;
+
+	snprintf(m_lines[0], LINE_LENGTH, "%.1f FPS  %.2f ms  max %.2f ms",
+		framesPerSecond, averageTime, m_textMaxFrameTime);
+	snprintf(m_lines[1], LINE_LENGTH, "%u draws  %u triangles", m_drawCalls, m_triangles);
+	snprintf(m_lines[2], LINE_LENGTH, "GPU %.1f MB  host %.1f MB",
+		MemoryTracker::GetDeviceBytes() / BYTES_PER_MEGABYTE,
+		MemoryTracker::GetHostBytes() / BYTES_PER_MEGABYTE);
+	snprintf(m_lines[3], LINE_LENGTH, "HUD %.3f ms", m_updateTime);
+}
+
+/***********************************************************
+ *  FindSolidTexel()
+ *
+ *  This method is used for finding the texel of the atlas
+ *  that is furthest inside a glyph.  Its distance is well
+ *  above the edge of the text shader, so a quad sampling
+ *  only that texel is drawn solid.
+ ***********************************************************/
+void PerformanceHud::FindSolidTexel(const GlyphAtlas& atlas)
+{
+	const unsigned char* pixels = atlas.GetPixels();
+	int width = atlas.GetWidth();
+	int height = atlas.GetHeight();
+	int bestIndex = -1;
+	unsigned char bestDistance = 128;
+	for (int i = 0; i < width * height; i++)
+	{
+		if (pixels[i] > bestDistance)
+		{
+			bestDistance = pixels[i];
+			bestIndex = i;
+		}
+	}
+
+	m_bSolidTexelFound = (bestIndex >= 0);
+	if (m_bSolidTexelFound)
+	{
+		m_solidU = ((bestIndex % width) + 0.5f) / width;
+		m_solidV = ((bestIndex / width) + 0.5f) / height;
+	}
+}
+
+/***********************************************************
+ *  AddQuad()
+ *
+ *  This method is used for appending the two triangles of a
+ *  quad facing +Z.  Quads that do not fit into the vertex
+ *  buffer are left out.
+ ***********************************************************/
+void PerformanceHud::AddQuad(float left, float bottom, float right, float top, float u0, float v0, float u1, float v1)
+{
+	if (m_vertices.size() + VERTICES_PER_QUAD * FLOATS_PER_VERTEX > (size_t)(MAX_VERTICES * FLOATS_PER_VERTEX))
+	{
+		return;
+	}
+
+	const float quad[VERTICES_PER_QUAD][FLOATS_PER_VERTEX] = {
+		{ left, bottom, 0.0f, 0.0f, 0.0f, 1.0f, u0, v0 },
+		{ right, bottom, 0.0f, 0.0f, 0.0f, 1.0f, u1, v0 },
+		{ right, top, 0.0f, 0.0f, 0.0f, 1.0f, u1, v1 },
+		{ left, bottom, 0.0f, 0.0f, 0.0f, 1.0f, u0, v0 },
+		{ right, top, 0.0f, 0.0f, 0.0f, 1.0f, u1, v1 },
+		{ left, top, 0.0f, 0.0f, 0.0f, 1.0f, u0, v1 } };
+	m_vertices.insert(m_vertices.end(), &quad[0][0], &quad[0][0] + VERTICES_PER_QUAD * FLOATS_PER_VERTEX);
+}
+
+/***********************************************************
+ *  AddSolidQuad()
+ *
+ *  This method is used for appending a quad that is filled
+ *  in, through the solid texel of the atlas.
+ ***********************************************************/
+void PerformanceHud::AddSolidQuad(float left, float bottom, float right, float top)
+{
+	AddQuad(left, bottom, right, top, m_solidU, m_solidV, m_solidU, m_solidV);
+}
+
+/***********************************************************
+ *  AddLine()
+ *
+ *  This method is used for appending the glyph quads of a
+ *  line of text, left aligned at x.
+ ***********************************************************/
+void PerformanceHud::AddLine(const GlyphAtlas& atlas, const char* text, float x, float y, float size)
+{
+	for (const char* c = text; *c != '\0'; c++)
+	{
+		const GlyphAtlas::GLYPH& glyph = atlas.GetGlyph(*c);
+		// blank glyphs only move the pen
+		if (glyph.right > glyph.left)
+		{
+			AddQuad(
+				x + glyph.left * size, y + glyph.bottom * size,
+				x + glyph.right * size, y + glyph.top * size,
+				glyph.u0, glyph.v0, glyph.u1, glyph.v1);
+		}
+		x += glyph.advance * size;
+	}
+}
+
+/***********************************************************
+ *  Update()
+ *
+ *  This method is used for laying out the text lines and
+ *  the frame time graph below them, in window pixels, and
+ *  uploading them over the last frame's vertices.
+ ***********************************************************/
+void PerformanceHud::Update(const GlyphAtlas& atlas)
+{
+	if ((NULL == m_pDevice) || (m_vertexBuffer == 0))
+	{
+		return;
+	}
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	if (!m_bSolidTexelFound)
+	{
+		FindSolidTexel(atlas);
+	}
+
+	int width = 0;
+	int height = 0;
+	m_pDevice->GetWindowSize(width, height);
+	m_projection = glm::ortho(0.0f, (float)width, 0.0f, (float)height, -1.0f, 1.0f);
+
+	m_vertices.clear();
+	float lineHeight = atlas.GetLineHeight() * TEXT_SIZE;
+	float top = height - MARGIN;
+	float baseline = top - atlas.GetAscender() * TEXT_SIZE;
+	for (int i = 0; i < LINE_COUNT; i++)
+	{
+		AddLine(atlas, m_lines[i], MARGIN, baseline, TEXT_SIZE);
+		baseline -= lineHeight;
+	}
+
+	// the newest frame is on the right
+	if (m_bSolidTexelFound)
+	{
+		float graphBottom = top - LINE_COUNT * lineHeight - GRAPH_GAP - GRAPH_HEIGHT;
+		float graphRight = MARGIN + GRAPH_FRAMES * BAR_WIDTH;
+		for (int i = 0; i < GRAPH_FRAMES; i++)
+		{
+			float frameTime = m_frameTimes[(m_nextFrame + i) % GRAPH_FRAMES];
+			float barHeight = std::min(frameTime / GRAPH_MAX_TIME, 1.0f) * GRAPH_HEIGHT;
+			if (barHeight > 0.0f)
+			{
+				float left = MARGIN + i * BAR_WIDTH;
+				AddSolidQuad(left, graphBottom, left + BAR_WIDTH, graphBottom + barHeight);
+			}
+		}
+		// the axis, and the frame time budgets
+		AddSolidQuad(MARGIN, graphBottom - 1.0f, graphRight, graphBottom);
+		for (size_t i = 0; i < sizeof(BUDGET_TIMES) / sizeof(BUDGET_TIMES[0]); i++)
+		{
+			float y = graphBottom + BUDGET_TIMES[i] / GRAPH_MAX_TIME * GRAPH_HEIGHT;
+			AddSolidQuad(graphRight + 2.0f, y - 1.0f, graphRight + 10.0f, y + 1.0f);
+		}
+	}
+
+	m_vertexCount = (uint32_t)(m_vertices.size() / FLOATS_PER_VERTEX);
+	if (m_vertexCount > 0)
+	{
+		m_pDevice->UpdateBuffer(m_vertexBuffer, 0, m_vertices.size() * sizeof(float), m_vertices.data());
+	}
+
+	std::chrono::duration<double, std::milli> updateTime = std::chrono::steady_clock::now() - start;
+	m_updateTime = updateTime.count();
+}
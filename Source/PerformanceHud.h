@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+// performancehud.h
+// ============
+// lay out the frame time graph and counters of the on-screen HUD
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GlyphAtlas.h"
+#include "RenderDevice.h"
+#include "RenderStatistics.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  PerformanceHud
+ *
+ *  This class lays out an overlay in the top left corner of
+ *  the window - a graph of the recent frame times and lines
+ *  with the FPS, draw and triangle counts and the memory in
+ *  use.  The glyphs and the graph bars are written into one
+ *  dynamic vertex buffer, in the vertex layout of the text
+ *  blocks, so the whole overlay is a single draw with the
+ *  distance field text shader.  The bars sample the deepest
+ *  texel inside the glyphs of the atlas, which is solid at
+ *  any size.  Nothing is allocated once it is created, and
+ *  the text only changes a few times a second so it can be
+ *  read.
+ ***********************************************************/
+class PerformanceHud
+{
+public:
+	// constructor
+	PerformanceHud();
+	// destructor
+	~PerformanceHud();
+
+	// create the pipeline and vertex buffer of the overlay
+	bool Create(RenderDevice* pDevice);
+	// free the pipeline and vertex buffer
+	void Destroy();
+
+	void SetVisible(bool bVisible) { m_bVisible = bVisible; }
+	bool IsVisible() const { return(m_bVisible && (m_vertexBuffer != 0)); }
+
+	// add the time and counters of a finished frame - the
+	// counters are left as they were when pFrame is NULL
+	void AddFrame(double frameTime, const RenderStatistics::FRAME_STATISTICS* pFrame);
+	// lay out the overlay with the glyphs of the atlas and
+	// upload it, ready to be drawn
+	void Update(const GlyphAtlas& atlas);
+
+	RENDER_PIPELINE GetPipeline() const { return(m_pipeline); }
+	RENDER_BUFFER GetVertexBuffer() const { return(m_vertexBuffer); }
+	uint32_t GetVertexCount() const { return(m_vertexCount); }
+	// window space projection, in pixels from the bottom left
+	const glm::mat4& GetProjection() const { return(m_projection); }
+	const glm::vec4& GetColor() const { return(m_color); }
+
+private:
+	// frames shown in the graph, and lines of text
+	static const int GRAPH_FRAMES = 120;
+	static const int LINE_COUNT = 4;
+	static const int LINE_LENGTH = 64;
+
+	RenderDevice* m_pDevice;
+	RENDER_PIPELINE m_pipeline;
+	RENDER_BUFFER m_vertexBuffer;
+	uint32_t m_vertexCount;
+	// vertices laid out for the buffer, reserved once
+	std::vector<float> m_vertices;
+	glm::mat4 m_projection;
+	glm::vec4 m_color;
+	bool m_bVisible;
+
+	// atlas texture coordinates of the solid texel
+	bool m_bSolidTexelFound;
+	float m_solidU;
+	float m_solidV;
+
+	// milliseconds of the last frames, oldest first from the
+	// next one to be written
+	float m_frameTimes[GRAPH_FRAMES];
+	int m_nextFrame;
+	// counters of the last frame
+	uint32_t m_drawCalls;
+	uint32_t m_triangles;
+	// frames added since the text was last written
+	int m_textFrames;
+	double m_textFrameTime;
+	double m_textMaxFrameTime;
+	// milliseconds the last Update() took
+	double m_updateTime;
+	char m_lines[LINE_COUNT][LINE_LENGTH];
+
+	// find the texel furthest inside the glyphs
+	void FindSolidTexel(const GlyphAtlas& atlas);
+	// write the text lines from the frames since the last time
+	void UpdateText();
+	// append the two triangles of a quad, if they fit
+	void AddQuad(float left, float bottom, float right, float top, float u0, float v0, float u1, float v1);
+	void AddSolidQuad(float left, float bottom, float right, float top);
+	// lay out a line of text with its baseline at y
+	void AddLine(const GlyphAtlas& atlas, const char* text, float x, float y, float size);
+};
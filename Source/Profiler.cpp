@@ -0,0 +1,231 @@
+///////////////////////////////////////////////////////////////////////////////
+// profiler.cpp
+// ============
+// time scoped zones of the frame and write them out as a Chrome trace
+///////////////////////////////////////////////////////////////////////////////
+
+#include "Profiler.h"
+
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+std::atomic<bool> Profiler::m_bCapturing(false);
+
+// declaration of global variables
+namespace
+{
+	struct PROFILE_ZONE
+	{
+		const char* name;
+		int64_t start;
+		int64_t end;
+	};
+
+	// zones of one thread - the lock is only taken against
+	// the writer, so it is never waited on during a capture
+	struct THREAD_BUFFER
+	{
+		int threadIndex;
+		std::mutex mutex;
+		std::vector<PROFILE_ZONE> zones;
+	};
+
+	std::mutex g_BufferMutex;
+	std::vector<std::unique_ptr<THREAD_BUFFER> > g_Buffers;
+	// buffers of threads that ended, handed to new threads -
+	// ParallelFor starts new workers for every call
+	std::vector<THREAD_BUFFER*> g_FreeBuffers;
+
+	// the buffer of a thread, given back when the thread ends
+	struct THREAD_SLOT
+	{
+		THREAD_BUFFER* pBuffer = NULL;
+		~THREAD_SLOT()
+		{
+			if (NULL != pBuffer)
+			{
+				std::lock_guard<std::mutex> lock(g_BufferMutex);
+				g_FreeBuffers.push_back(pBuffer);
+			}
+		}
+	};
+	thread_local THREAD_SLOT g_ThreadSlot;
+
+	// the capture in progress
+	std::string g_TraceFilename;
+	int g_FramesLeft = 0;
+	int g_FrameNumber = 0;
+	int64_t g_CaptureStart = 0;
+	int64_t g_FrameStart = 0;
+
+	// get the buffer of the calling thread
+	THREAD_BUFFER* GetThreadBuffer()
+	{
+		if (NULL == g_ThreadSlot.pBuffer)
+		{
+			std::lock_guard<std::mutex> lock(g_BufferMutex);
+			if (!g_FreeBuffers.empty())
+			{
+				g_ThreadSlot.pBuffer = g_FreeBuffers.back();
+				g_FreeBuffers.pop_back();
+			}
+			else
+			{
+				g_Buffers.push_back(std::unique_ptr<THREAD_BUFFER>(new THREAD_BUFFER()));
+				g_ThreadSlot.pBuffer = g_Buffers.back().get();
+				g_ThreadSlot.pBuffer->threadIndex = (int)g_Buffers.size() - 1;
+			}
+		}
+		return(g_ThreadSlot.pBuffer);
+	}
+
+	// write a zone name as a JSON string
+	void WriteJSONString(std::ofstream& file, const char* text)
+	{
+		file << '"';
+		for (const char* p = text; *p != 0; p++)
+		{
+			if ((*p == '"') || (*p == '\\'))
+			{
+				file << '\\';
+			}
+			file << *p;
+		}
+		file << '"';
+	}
+}
+
+/***********************************************************
+ *  StartCapture()
+ *
+ *  This method is used for starting to record the zones of
+ *  the next frames.  The frames are counted by EndFrame().
+ ***********************************************************/
+void Profiler::StartCapture(int frameCount, const char* filename)
+{
+	if ((frameCount <= 0) || (NULL == filename))
+	{
+		return;
+	}
+	g_TraceFilename = filename;
+	g_FramesLeft = frameCount;
+	g_FrameNumber = 0;
+	g_CaptureStart = GetTime();
+	g_FrameStart = g_CaptureStart;
+
+	// the capturing thread is the first lane of the trace
+	GetThreadBuffer();
+	m_bCapturing.store(true);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for closing the zone of the frame
+ *  that ends, and writing the trace after the last one.
+ ***********************************************************/
+void Profiler::EndFrame()
+{
+	if (!IsCapturing())
+	{
+		return;
+	}
+
+	int64_t now = GetTime();
+	AddZone("Frame", g_FrameStart, now);
+	g_FrameStart = now;
+	g_FrameNumber++;
+
+	g_FramesLeft--;
+	if (g_FramesLeft <= 0)
+	{
+		m_bCapturing.store(false);
+		if (WriteTrace())
+		{
+			std::cout << "INFO: Wrote the profile of " << g_FrameNumber << " frames to " << g_TraceFilename << std::endl;
+		}
+	}
+}
+
+/***********************************************************
+ *  GetTime()
+ *
+ *  This method is used for reading the steady clock the
+ *  zones are timed with.
+ ***********************************************************/
+int64_t Profiler::GetTime()
+{
+	return((int64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/***********************************************************
+ *  AddZone()
+ *
+ *  This method is used for adding a finished zone to the
+ *  buffer of the calling thread.  Zones that end after the
+ *  capture stopped are dropped.
+ ***********************************************************/
+void Profiler::AddZone(const char* name, int64_t start, int64_t end)
+{
+	if (!IsCapturing())
+	{
+		return;
+	}
+	THREAD_BUFFER* pBuffer = GetThreadBuffer();
+	PROFILE_ZONE zone = { name, start, end };
+	std::lock_guard<std::mutex> lock(pBuffer->mutex);
+	pBuffer->zones.push_back(zone);
+}
+
+/***********************************************************
+ *  WriteTrace()
+ *
+ *  This method is used for writing the recorded zones as
+ *  complete events of the Chrome trace format, with the
+ *  times in microseconds from the start of the capture.
+ *  Each thread buffer is a lane named after its thread.
+ ***********************************************************/
+bool Profiler::WriteTrace()
+{
+	std::ofstream traceFile(g_TraceFilename.c_str(), std::ios::trunc);
+	if (!traceFile.is_open())
+	{
+		std::cout << "Could not write profile trace:" << g_TraceFilename << std::endl;
+		return(false);
+	}
+
+	traceFile << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+	bool bFirst = true;
+	std::lock_guard<std::mutex> bufferLock(g_BufferMutex);
+	for (size_t i = 0; i < g_Buffers.size(); i++)
+	{
+		THREAD_BUFFER& buffer = *g_Buffers[i];
+		std::lock_guard<std::mutex> lock(buffer.mutex);
+
+		traceFile << (bFirst ? "\n" : ",\n");
+		bFirst = false;
+		traceFile << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.threadIndex
+			<< ",\"args\":{\"name\":\"" << ((buffer.threadIndex == 0) ? "Main" : "Worker ")
+			<< ((buffer.threadIndex == 0) ? std::string() : std::to_string(buffer.threadIndex)) << "\"}}";
+
+		for (size_t j = 0; j < buffer.zones.size(); j++)
+		{
+			const PROFILE_ZONE& zone = buffer.zones[j];
+			traceFile << ",\n{\"name\":";
+			WriteJSONString(traceFile, zone.name);
+			traceFile << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.threadIndex
+				<< ",\"ts\":" << (zone.start - g_CaptureStart) / 1000.0
+				<< ",\"dur\":" << (zone.end - zone.start) / 1000.0 << "}";
+		}
+		buffer.zones.clear();
+		buffer.zones.shrink_to_fit();
+	}
+	traceFile << "\n]}\n";
+	return(true);
+}
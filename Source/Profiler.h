@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// profiler.h
+// ============
+// time scoped zones of the frame and write them out as a Chrome trace
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+/***********************************************************
+ *  Profiler
+ *
+ *  This class collects the zones timed by PROFILE_SCOPE for
+ *  a number of frames and writes them as a Chrome trace JSON
+ *  file, which chrome://tracing or ui.perfetto.dev open.
+ *  Every thread records into its own buffer, so zones on
+ *  different threads never wait for each other.  While no
+ *  capture is running a zone only reads a flag.
+ ***********************************************************/
+class Profiler
+{
+public:
+	// start recording the zones of the next frames, written
+	// to the file after the last one
+	static void StartCapture(int frameCount, const char* filename);
+	// mark the end of a frame, called once per frame outside
+	// of any zone
+	static void EndFrame();
+
+	static bool IsCapturing() { return(m_bCapturing.load(std::memory_order_relaxed)); }
+	// nanoseconds on a steady clock
+	static int64_t GetTime();
+	// add a finished zone to the buffer of the calling thread
+	static void AddZone(const char* name, int64_t start, int64_t end);
+
+private:
+	static std::atomic<bool> m_bCapturing;
+
+	// write the recorded zones and free the buffers
+	static bool WriteTrace();
+};
+
+/***********************************************************
+ *  ProfileZone
+ *
+ *  This class times the scope it is declared in, from its
+ *  constructor to its destructor.  The name has to outlive
+ *  the capture, so it is meant for string literals.
+ ***********************************************************/
+class ProfileZone
+{
+public:
+	explicit ProfileZone(const char* name)
+	{
+		m_name = name;
+		m_start = Profiler::IsCapturing() ? Profiler::GetTime() : -1;
+	}
+	~ProfileZone()
+	{
+		if (m_start >= 0)
+		{
+			Profiler::AddZone(m_name, m_start, Profiler::GetTime());
+		}
+	}
+
+private:
+	const char* m_name;
+	int64_t m_start;
+};
+
+// time the rest of the scope as a zone - defining
+// DISABLE_PROFILER removes the zones from the build
+#ifdef DISABLE_PROFILER
+#define PROFILE_SCOPE(name)
+#else
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#endif
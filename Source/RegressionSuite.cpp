@@ -0,0 +1,445 @@
+///////////////////////////////////////////////////////////////////////////////
+// regressionsuite.cpp
+// ============
+// render camera views headless and check them against golden images and budgets
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RegressionSuite.h"
+#include "NullRenderDevice.h"
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "VariantBatch.h"
+#include "SoftwareRenderDevice.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// names of the metrics in the regression file and output
+	const char* const g_MetricNames[RegressionSuite::METRIC_COUNT] = {
+		"draws",
+		"memory_kb",
+		"triangles",
+		"fragments" };
+
+	// largest squared YIQ difference of two colors
+	const float MAX_COLOR_DELTA = 35215.0f;
+
+	// write a measurement or budget in whole units - the
+	// fragments are too many for the default precision
+	std::string FormatMetric(double value)
+	{
+		std::ostringstream text;
+		text << std::fixed << std::setprecision(0) << value;
+		return(text.str());
+	}
+
+	// create a folder and the folders it is in
+	void CreateFolder(const std::string& folder)
+	{
+		for (size_t i = 1; i <= folder.size(); i++)
+		{
+			if ((i == folder.size()) || (folder[i] == '/') || (folder[i] == '\\'))
+			{
+#ifdef _WIN32
+				_mkdir(folder.substr(0, i).c_str());
+#else
+				mkdir(folder.substr(0, i).c_str(), 0755);
+#endif
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  RegressionSuite()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RegressionSuite::RegressionSuite()
+{
+	m_goldenFolder = "regression/golden";
+	m_outputFolder = "regression/failed";
+	m_colorThreshold = 0.1f;
+	m_pixelTolerance = 0.001f;
+	m_budgetMargin = 0.1;
+}
+
+/***********************************************************
+ *  ~RegressionSuite()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RegressionSuite::~RegressionSuite()
+{
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for reading a regression file.  It
+ *  names the scene, the folders, the tolerances and the
+ *  views, each followed by its budgets.
+ ***********************************************************/
+bool RegressionSuite::Load(const char* filename)
+{
+	std::ifstream regressionFile(filename);
+	if (!regressionFile.is_open())
+	{
+		std::cout << "Could not open regression file:" << filename << std::endl;
+		return(false);
+	}
+
+	m_views.clear();
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(regressionFile, line))
+	{
+		lineNumber++;
+
+		// strip comments
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+		{
+			line.erase(comment);
+		}
+
+		std::istringstream tokens(line);
+		std::string keyword;
+		if (!(tokens >> keyword))
+		{
+			continue;
+		}
+
+		bool bValid = true;
+		if (keyword == "scene")
+		{
+			bValid = (bool)(tokens >> m_sceneFilename);
+		}
+		else if (keyword == "golden")
+		{
+			bValid = (bool)(tokens >> m_goldenFolder);
+		}
+		else if (keyword == "output")
+		{
+			bValid = (bool)(tokens >> m_outputFolder);
+		}
+		else if (keyword == "threshold")
+		{
+			bValid = (bool)(tokens >> m_colorThreshold);
+		}
+		else if (keyword == "tolerance")
+		{
+			bValid = (bool)(tokens >> m_pixelTolerance);
+		}
+		else if (keyword == "margin")
+		{
+			bValid = (bool)(tokens >> m_budgetMargin);
+		}
+		else if (keyword == "view")
+		{
+			VIEW view;
+			view.bDefaultCamera = true;
+			view.zoom = 0.0f;
+			std::fill(view.budgets, view.budgets + METRIC_COUNT, 0.0);
+			bValid = (bool)(tokens >> view.name);
+
+			// without a camera the view starts where the window does
+			if (bValid && (tokens >> view.position.x))
+			{
+				view.bDefaultCamera = false;
+				bValid = (bool)(tokens >> view.position.y >> view.position.z >>
+					view.front.x >> view.front.y >> view.front.z >> view.zoom);
+			}
+			m_views.push_back(view);
+		}
+		else if ((keyword == "budget") && !m_views.empty())
+		{
+			std::string metricName;
+			double budget = 0.0;
+			bValid = (bool)(tokens >> metricName >> budget);
+
+			int metric = 0;
+			while ((metric < METRIC_COUNT) && (metricName != g_MetricNames[metric]))
+			{
+				metric++;
+			}
+			bValid = bValid && (metric < METRIC_COUNT);
+			if (bValid)
+			{
+				m_views.back().budgets[metric] = budget;
+			}
+		}
+		else
+		{
+			bValid = false;
+		}
+
+		if (bValid == false)
+		{
+			std::cout << filename << "(" << lineNumber << "): invalid regression line: " << line << std::endl;
+			return(false);
+		}
+	}
+
+	if (m_sceneFilename.empty() || m_views.empty())
+	{
+		std::cout << "Regression file needs a scene and at least one view:" << filename << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for rendering and checking every view.
+ *  The scene is loaded once on the null render device, which
+ *  gives the memory it takes, then for each view a frame is
+ *  counted on the device, and the image is rendered from the
+ *  same commands on the software render device and compared,
+ *  with the triangles and fragments it took.  Nothing is
+ *  timed, so a run passes or fails the same way on every
+ *  machine.  When the goldens are updated, the images
+ *  are written as the new golden images instead.
+ ***********************************************************/
+bool RegressionSuite::Run(bool bUsePBR, bool bUpdateGoldens)
+{
+	int width = 0;
+	int height = 0;
+	glm::mat4 defaultView;
+	glm::mat4 defaultProjection;
+	glm::vec3 defaultPosition;
+	ViewManager::GetDefaultView(width, height, defaultView, defaultProjection, defaultPosition);
+
+	NullRenderDevice device(width, height);
+	SceneManager deviceScene(&device);
+	deviceScene.PrepareScene();
+	deviceScene.SetPBRShading(bUsePBR);
+	if (!deviceScene.LoadSceneFile(m_sceneFilename.c_str()))
+	{
+		return(false);
+	}
+	double memory = device.GetResidentBytes() / 1024.0;
+
+	SoftwareRenderDevice softwareDevice(width, height);
+	SceneManager softwareScene(&softwareDevice);
+	softwareScene.PrepareScene();
+	softwareScene.SetPBRShading(bUsePBR);
+	if (!softwareScene.LoadSceneFile(m_sceneFilename.c_str()))
+	{
+		return(false);
+	}
+	std::vector<unsigned char> pixels(width * height * 4);
+
+	CreateFolder(m_goldenFolder);
+	CreateFolder(m_outputFolder);
+
+	RenderCommandList frameCommands;
+	int failedCount = 0;
+	for (size_t i = 0; i < m_views.size(); i++)
+	{
+		const VIEW& view = m_views[i];
+
+		glm::mat4 viewMatrix = defaultView;
+		glm::mat4 projection = defaultProjection;
+		glm::vec3 viewPosition = defaultPosition;
+		if (!view.bDefaultCamera)
+		{
+			ViewManager::GetCameraView(view.position, view.front, view.zoom, viewMatrix, projection);
+			viewPosition = view.position;
+		}
+
+		double measurements[METRIC_COUNT];
+
+		device.ResetCounters();
+		frameCommands.Reset();
+		frameCommands.Clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+		ViewManager::PrepareView(frameCommands, viewMatrix, projection, viewPosition);
+		device.Submit(frameCommands);
+		deviceScene.RenderScene();
+		measurements[METRIC_DRAWS] = (double)device.GetCounters().drawCount;
+		measurements[METRIC_MEMORY] = memory;
+
+		frameCommands.Reset();
+		frameCommands.Clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+		ViewManager::PrepareView(frameCommands, viewMatrix, projection, viewPosition);
+		softwareDevice.Submit(frameCommands);
+		softwareScene.RenderScene();
+		if (!softwareDevice.ReadPixels(0, width, height, &pixels[0]))
+		{
+			return(false);
+		}
+		measurements[METRIC_TRIANGLES] = (double)softwareDevice.GetTriangleCount();
+		measurements[METRIC_FRAGMENTS] = (double)softwareDevice.GetFragmentCount();
+		if (bUpdateGoldens)
+		{
+			std::string goldenFilename = m_goldenFolder + "/" + view.name + ".tga";
+			if (!VariantBatch::WriteTGA(goldenFilename, width, height, pixels))
+			{
+				return(false);
+			}
+			std::cout << "INFO: Updated golden image " << goldenFilename << std::endl;
+		}
+
+		// check both, so a failure reports everything that is off
+		bool bImagePassed = CheckImage(view, width, height, pixels);
+		bool bBudgetsPassed = CheckBudgets(view, measurements);
+
+		std::cout << ((bImagePassed && bBudgetsPassed) ? "PASS " : "FAIL ") << view.name << ":";
+		for (int metric = 0; metric < METRIC_COUNT; metric++)
+		{
+			std::cout << " " << g_MetricNames[metric] << " " << FormatMetric(measurements[metric]);
+		}
+		std::cout << std::endl;
+
+		if (!bImagePassed || !bBudgetsPassed)
+		{
+			failedCount++;
+		}
+	}
+
+	std::cout << "INFO: Regression of " << m_sceneFilename << ": "
+		<< m_views.size() - failedCount << " of " << m_views.size() << " views passed" << std::endl;
+
+	return(failedCount == 0);
+}
+
+/***********************************************************
+ *  CheckImage()
+ *
+ *  This method is used for comparing the image of a view with
+ *  its golden image.  A missing golden image fails the view,
+ *  the goldens have to be updated on purpose to create it.
+ *  When the images differ, the image and the marked
+ *  differences are written to the output folder.
+ ***********************************************************/
+bool RegressionSuite::CheckImage(const VIEW& view, int width, int height, const std::vector<unsigned char>& pixels)
+{
+	std::string goldenFilename = m_goldenFolder + "/" + view.name + ".tga";
+
+	int goldenWidth = 0;
+	int goldenHeight = 0;
+	std::vector<unsigned char> golden;
+	if (!VariantBatch::ReadTGA(goldenFilename, goldenWidth, goldenHeight, golden))
+	{
+		std::cout << view.name << ": no golden image " << goldenFilename
+			<< ", run with --update-goldens to create it" << std::endl;
+		VariantBatch::WriteTGA(m_outputFolder + "/" + view.name + ".tga", width, height, pixels);
+		return(false);
+	}
+
+	if ((goldenWidth != width) || (goldenHeight != height))
+	{
+		std::cout << "Golden image " << goldenFilename << " is " << goldenWidth << "x" << goldenHeight
+			<< ", the view is " << width << "x" << height << std::endl;
+		return(false);
+	}
+
+	std::vector<unsigned char> difference;
+	int differentCount = CompareImages(golden, pixels, m_colorThreshold, difference);
+	float differentPart = (float)differentCount / ((float)width * height);
+	if (differentPart <= m_pixelTolerance)
+	{
+		return(true);
+	}
+
+	std::cout << view.name << ": " << differentPart * 100.0f << "% of the pixels differ from "
+		<< goldenFilename << ", " << m_pixelTolerance * 100.0f << "% may" << std::endl;
+	VariantBatch::WriteTGA(m_outputFolder + "/" + view.name + ".tga", width, height, pixels);
+	VariantBatch::WriteTGA(m_outputFolder + "/" + view.name + "_difference.tga", width, height, difference);
+
+	return(false);
+}
+
+/***********************************************************
+ *  CheckBudgets()
+ *
+ *  This method is used for checking each measurement of a
+ *  view against its budget, with the margin added.
+ ***********************************************************/
+bool RegressionSuite::CheckBudgets(const VIEW& view, const double* measurements)
+{
+	bool bPassed = true;
+	for (int metric = 0; metric < METRIC_COUNT; metric++)
+	{
+		double budget = view.budgets[metric];
+		if ((budget > 0.0) && (measurements[metric] > budget * (1.0 + m_budgetMargin)))
+		{
+			std::cout << view.name << ": " << g_MetricNames[metric] << " " << FormatMetric(measurements[metric])
+				<< " is over the budget of " << FormatMetric(budget) << std::endl;
+			bPassed = false;
+		}
+	}
+
+	return(bPassed);
+}
+
+/***********************************************************
+ *  CompareImages()
+ *
+ *  This method is used for counting the pixels of two BGRA
+ *  images that look different.  The colors are compared in
+ *  YIQ space, weighted by how sensitive the eye is to each
+ *  channel, so the threshold means about the same in dark
+ *  and bright areas.  The difference image is the expected
+ *  one faded to gray, with the differing pixels in red.
+ ***********************************************************/
+int RegressionSuite::CompareImages(
+	const std::vector<unsigned char>& expected,
+	const std::vector<unsigned char>& actual,
+	float threshold,
+	std::vector<unsigned char>& difference)
+{
+	float maxDelta = MAX_COLOR_DELTA * threshold * threshold;
+	size_t pixelCount = std::min(expected.size(), actual.size()) / 4;
+	difference.resize(pixelCount * 4);
+
+	int differentCount = 0;
+	for (size_t i = 0; i < pixelCount; i++)
+	{
+		const unsigned char* a = &expected[i * 4];
+		const unsigned char* b = &actual[i * 4];
+		float blue = (float)a[0] - (float)b[0];
+		float green = (float)a[1] - (float)b[1];
+		float red = (float)a[2] - (float)b[2];
+
+		float y = 0.29889531f * red + 0.58662247f * green + 0.11448223f * blue;
+		float in = 0.59597799f * red - 0.27417610f * green - 0.32180189f * blue;
+		float q = 0.21147017f * red - 0.52261711f * green + 0.31114694f * blue;
+		float delta = 0.5053f * y * y + 0.299f * in * in + 0.1957f * q * q;
+
+		unsigned char* pixel = &difference[i * 4];
+		if (delta > maxDelta)
+		{
+			differentCount++;
+			pixel[0] = 0;
+			pixel[1] = 0;
+			pixel[2] = 255;
+		}
+		else
+		{
+			float gray = 0.29889531f * a[2] + 0.58662247f * a[1] + 0.11448223f * a[0];
+			unsigned char faded = (unsigned char)(255.0f - (255.0f - gray) * 0.1f);
+			pixel[0] = faded;
+			pixel[1] = faded;
+			pixel[2] = faded;
+		}
+		pixel[3] = 255;
+	}
+
+	return(differentCount);
+}
@@ -0,0 +1,93 @@
+///////////////////////////////////////////////////////////////////////////////
+// regressionsuite.h
+// ============
+// render camera views headless and check them against golden images and budgets
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  RegressionSuite
+ *
+ *  This class renders predefined camera views of a scene
+ *  file without a window and compares each image with its
+ *  golden image.  The software render device makes the
+ *  images from the commands of the scene and counts the
+ *  triangles and fragments it rasterized, and the null
+ *  render device counts the draws and memory of a frame,
+ *  which are all checked against the budgets of the view
+ *  (see scenes/example.regression).  Times depend on the
+ *  machine, so they are not budgeted - see --null-device for
+ *  those.
+ ***********************************************************/
+class RegressionSuite
+{
+public:
+	// constructor
+	RegressionSuite();
+	// destructor
+	~RegressionSuite();
+
+	// values measured for each view, and checked against its
+	// budgets
+	enum METRIC
+	{
+		METRIC_DRAWS = 0,
+		METRIC_MEMORY,
+		METRIC_TRIANGLES,
+		METRIC_FRAGMENTS,
+		METRIC_COUNT
+	};
+
+	struct VIEW
+	{
+		std::string name;
+		// the camera when the application starts, or the one
+		// given by the position, direction and zoom
+		bool bDefaultCamera;
+		glm::vec3 position;
+		glm::vec3 front;
+		float zoom;
+		// most a metric may reach, 0 when it is not checked
+		double budgets[METRIC_COUNT];
+	};
+
+	// read a regression file
+	bool Load(const char* filename);
+	// render and check every view, true when all of them pass -
+	// or write their images as the new golden images
+	bool Run(bool bUsePBR, bool bUpdateGoldens);
+
+	// count the pixels whose colors differ by more than the
+	// threshold, 0 to 1 - the differing pixels are marked in
+	// the difference image
+	static int CompareImages(
+		const std::vector<unsigned char>& expected,
+		const std::vector<unsigned char>& actual,
+		float threshold,
+		std::vector<unsigned char>& difference);
+
+private:
+	std::string m_sceneFilename;
+	// folder of the golden images, and the one the images of
+	// the failed views are written to
+	std::string m_goldenFolder;
+	std::string m_outputFolder;
+	// color difference of a pixel that counts, and the part
+	// of the pixels that may differ
+	float m_colorThreshold;
+	float m_pixelTolerance;
+	// part a budget may be exceeded by before a view fails
+	double m_budgetMargin;
+	std::vector<VIEW> m_views;
+
+	// compare the image of a view with its golden image
+	bool CheckImage(const VIEW& view, int width, int height, const std::vector<unsigned char>& pixels);
+	// check the measurements of a view against its budgets
+	bool CheckBudgets(const VIEW& view, const double* measurements);
+};
@@ -0,0 +1,317 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderdevice.cpp
+// ============
+// graphics API independent buffers, textures, pipelines and command lists
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderDevice.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+
+/***********************************************************
+ *  RenderCommandList()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderCommandList::RenderCommandList()
+{
+}
+
+/***********************************************************
+ *  ~RenderCommandList()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RenderCommandList::~RenderCommandList()
+{
+}
+
+/***********************************************************
+ *  AddCommand()
+ *
+ *  This method is used for appending a command with all of
+ *  its values zeroed.
+ ***********************************************************/
+RenderCommandList::COMMAND& RenderCommandList::AddCommand(uint32_t type)
+{
+	m_commands.push_back(COMMAND());
+	m_commands.back().type = type;
+	return(m_commands.back());
+}
+
+/***********************************************************
+ *  AddUniform()
+ *
+ *  This method is used for appending a uniform or timer
+ *  command.  The name is copied, since names made at run
+ *  time do not live until the list is submitted.
+ ***********************************************************/
+RenderCommandList::COMMAND& RenderCommandList::AddUniform(uint32_t type, const char* name)
+{
+	COMMAND& command = AddCommand(type);
+	command.nameOffset = (uint32_t)m_names.size();
+	m_names.insert(m_names.end(), name, name + strlen(name) + 1);
+	return(command);
+}
+
+/***********************************************************
+ *  SetRenderTarget()
+ *
+ *  This method is used for recording a switch of the target
+ *  the following draws go into.
+ ***********************************************************/
+void RenderCommandList::SetRenderTarget(RENDER_TARGET target, int width, int height)
+{
+	COMMAND& command = AddCommand(COMMAND_SET_RENDER_TARGET);
+	command.handle = target;
+	command.arguments[0] = (uint32_t)width;
+	command.arguments[1] = (uint32_t)height;
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for recording a clear of the color and
+ *  depth of the render target.
+ ***********************************************************/
+void RenderCommandList::Clear(const glm::vec4& color)
+{
+	COMMAND& command = AddCommand(COMMAND_CLEAR);
+	memcpy(command.floatValues, glm::value_ptr(color), sizeof(float) * 4);
+}
+
+/***********************************************************
+ *  SetPipeline()
+ *
+ *  This method is used for recording a pipeline switch.
+ ***********************************************************/
+void RenderCommandList::SetPipeline(RENDER_PIPELINE pipeline)
+{
+	AddCommand(COMMAND_SET_PIPELINE).handle = pipeline;
+}
+
+/***********************************************************
+ *  BindTexture()
+ *
+ *  This method is used for recording a texture binding.
+ ***********************************************************/
+void RenderCommandList::BindTexture(int slot, RENDER_TEXTURE texture)
+{
+	COMMAND& command = AddCommand(COMMAND_BIND_TEXTURE);
+	command.handle = texture;
+	command.arguments[0] = (uint32_t)slot;
+}
+
+/***********************************************************
+ *  BindUniformBuffer()
+ *
+ *  This method is used for recording a uniform buffer range
+ *  binding.
+ ***********************************************************/
+void RenderCommandList::BindUniformBuffer(uint32_t binding, RENDER_BUFFER buffer, size_t offset, size_t size)
+{
+	COMMAND& command = AddCommand(COMMAND_BIND_UNIFORM_BUFFER);
+	command.handle = buffer;
+	command.arguments[0] = binding;
+	command.arguments[1] = (uint32_t)offset;
+	command.arguments[2] = (uint32_t)size;
+}
+
+/***********************************************************
+ *  SetInt()
+ *
+ *  This method is used for recording an int, bool or sampler
+ *  uniform.
+ ***********************************************************/
+void RenderCommandList::SetInt(const char* name, int value)
+{
+	AddUniform(COMMAND_SET_INT, name).intValue = value;
+}
+
+/***********************************************************
+ *  SetFloat()
+ *
+ *  This method is used for recording a float uniform.
+ ***********************************************************/
+void RenderCommandList::SetFloat(const char* name, float value)
+{
+	AddUniform(COMMAND_SET_FLOAT, name).floatValues[0] = value;
+}
+
+/***********************************************************
+ *  SetVec2()
+ *
+ *  This method is used for recording a vec2 uniform.
+ ***********************************************************/
+void RenderCommandList::SetVec2(const char* name, const glm::vec2& value)
+{
+	memcpy(AddUniform(COMMAND_SET_VEC2, name).floatValues, glm::value_ptr(value), sizeof(float) * 2);
+}
+
+/***********************************************************
+ *  SetVec3()
+ *
+ *  This method is used for recording a vec3 uniform.
+ ***********************************************************/
+void RenderCommandList::SetVec3(const char* name, const glm::vec3& value)
+{
+	memcpy(AddUniform(COMMAND_SET_VEC3, name).floatValues, glm::value_ptr(value), sizeof(float) * 3);
+}
+
+/***********************************************************
+ *  SetVec4()
+ *
+ *  This method is used for recording a vec4 uniform.
+ ***********************************************************/
+void RenderCommandList::SetVec4(const char* name, const glm::vec4& value)
+{
+	memcpy(AddUniform(COMMAND_SET_VEC4, name).floatValues, glm::value_ptr(value), sizeof(float) * 4);
+}
+
+/***********************************************************
+ *  SetMat4()
+ *
+ *  This method is used for recording a mat4 uniform.
+ ***********************************************************/
+void RenderCommandList::SetMat4(const char* name, const glm::mat4& value)
+{
+	memcpy(AddUniform(COMMAND_SET_MAT4, name).floatValues, glm::value_ptr(value), sizeof(float) * 16);
+}
+
+/***********************************************************
+ *  DrawShape()
+ *
+ *  This method is used for recording a draw of a basic shape.
+ ***********************************************************/
+void RenderCommandList::DrawShape(uint32_t meshType, uint32_t parts)
+{
+	COMMAND& command = AddCommand(COMMAND_DRAW_SHAPE);
+	command.arguments[0] = meshType;
+	command.arguments[1] = parts;
+}
+
+/***********************************************************
+ *  Draw()
+ *
+ *  This method is used for recording a draw of the triangles
+ *  in a vertex buffer.
+ ***********************************************************/
+void RenderCommandList::Draw(RENDER_BUFFER vertexBuffer, uint32_t firstVertex, uint32_t vertexCount)
+{
+	if (vertexCount == 0)
+	{
+		return;
+	}
+
+	COMMAND& command = AddCommand(COMMAND_DRAW);
+	command.handle = vertexBuffer;
+	command.arguments[0] = firstVertex;
+	command.arguments[1] = vertexCount;
+}
+
+/***********************************************************
+ *  BeginTimer()
+ *
+ *  This method is used for recording the start of a timed
+ *  range of GPU work.
+ ***********************************************************/
+void RenderCommandList::BeginTimer(const char* name)
+{
+	AddUniform(COMMAND_BEGIN_TIMER, name);
+}
+
+/***********************************************************
+ *  EndTimer()
+ *
+ *  This method is used for recording the end of the timed
+ *  range that was started last.
+ ***********************************************************/
+void RenderCommandList::EndTimer()
+{
+	AddCommand(COMMAND_END_TIMER);
+}
+
+/***********************************************************
+ *  Reset()
+ *
+ *  This method is used for starting a new recording.
+ ***********************************************************/
+void RenderCommandList::Reset()
+{
+	m_commands.clear();
+	m_names.clear();
+}
+
+/***********************************************************
+ *  GetTextureDesc()
+ *
+ *  This method is used for getting the description of a 2D
+ *  texture with one level, clamped and linearly filtered.
+ ***********************************************************/
+RenderDevice::TEXTURE_DESC RenderDevice::GetTextureDesc(uint32_t format, int width, int height)
+{
+	TEXTURE_DESC desc;
+	desc.type = TEXTURE_2D;
+	desc.format = format;
+	desc.width = width;
+	desc.height = height;
+	desc.mipLevels = 1;
+	desc.bGenerateMipmaps = false;
+	desc.bMipmapFiltering = false;
+	desc.bRepeat = false;
+	return(desc);
+}
+
+/***********************************************************
+ *  GetTextureSize()
+ *
+ *  This method is used for getting the memory a texture
+ *  takes on the GPU, the generated mipmaps included.  Drivers
+ *  store three channel formats with a fourth channel, so
+ *  those are counted with four.
+ ***********************************************************/
+size_t RenderDevice::GetTextureSize(const TEXTURE_DESC& desc)
+{
+	// bytes per texel of each TEXTURE_FORMAT on the GPU
+	const size_t texelSizes[] = { 1, 4, 4, 4, 8 };
+	if (desc.format >= sizeof(texelSizes) / sizeof(texelSizes[0]))
+	{
+		return(0);
+	}
+
+	int faceCount = (desc.type == TEXTURE_CUBE) ? 6 : 1;
+	int levelCount = (desc.mipLevels > 0) ? desc.mipLevels : 1;
+	size_t size = 0;
+	for (int level = 0; (level < levelCount) || desc.bGenerateMipmaps; level++)
+	{
+		int width = (desc.width >> level) > 1 ? (desc.width >> level) : 1;
+		int height = (desc.height >> level) > 1 ? (desc.height >> level) : 1;
+		size += (size_t)width * height * texelSizes[desc.format] * faceCount;
+		if ((width == 1) && (height == 1))
+		{
+			break;
+		}
+	}
+	return(size);
+}
+
+/***********************************************************
+ *  GetPipelineDesc()
+ *
+ *  This method is used for getting the description of the
+ *  pipeline most draws use - depth tested and written, with
+ *  alpha blending for the transparent textures.
+ ***********************************************************/
+RenderDevice::PIPELINE_DESC RenderDevice::GetPipelineDesc()
+{
+	PIPELINE_DESC desc;
+	desc.blendMode = BLEND_ALPHA;
+	desc.bDepthTest = true;
+	desc.bDepthWrite = true;
+	desc.bPolygonOffset = false;
+	desc.uniformBlockName = NULL;
+	desc.uniformBlockBinding = 0;
+	return(desc);
+}
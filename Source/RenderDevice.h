@@ -0,0 +1,249 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderdevice.h
+// ============
+// graphics API independent buffers, textures, pipelines and command lists
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// handles of the objects a render device creates, 0 is no
+// object - the render target 0 is the window
+typedef uint32_t RENDER_BUFFER;
+typedef uint32_t RENDER_TEXTURE;
+typedef uint32_t RENDER_TARGET;
+typedef uint32_t RENDER_PIPELINE;
+
+/***********************************************************
+ *  RenderCommandList
+ *
+ *  This class records the state changes and draws of a pass
+ *  in the order they are made, for a render device to run
+ *  with Submit().  The scene code only records, so it does
+ *  not depend on the graphics API the commands end up in.
+ *  Reset() keeps the memory of the list, so recording the
+ *  next frame does not allocate.
+ ***********************************************************/
+class RenderCommandList
+{
+public:
+	// constructor
+	RenderCommandList();
+	// destructor
+	~RenderCommandList();
+
+	enum COMMAND_TYPE
+	{
+		COMMAND_SET_RENDER_TARGET = 0,
+		COMMAND_CLEAR,
+		COMMAND_SET_PIPELINE,
+		COMMAND_BIND_TEXTURE,
+		COMMAND_BIND_UNIFORM_BUFFER,
+		COMMAND_SET_INT,
+		COMMAND_SET_FLOAT,
+		COMMAND_SET_VEC2,
+		COMMAND_SET_VEC3,
+		COMMAND_SET_VEC4,
+		COMMAND_SET_MAT4,
+		COMMAND_DRAW_SHAPE,
+		COMMAND_DRAW,
+		COMMAND_BEGIN_TIMER,
+		COMMAND_END_TIMER,
+		COMMAND_TYPE_COUNT
+	};
+
+	// one recorded command - the meaning of the arguments
+	// depends on the type, see the recording methods
+	struct COMMAND
+	{
+		uint32_t type;
+		// object the command uses
+		uint32_t handle;
+		uint32_t arguments[3];
+		// offset of the uniform or timer name in the name storage
+		uint32_t nameOffset;
+		// uniform, clear color or integer values
+		union
+		{
+			float floatValues[16];
+			int intValue;
+		};
+	};
+
+	// draw into a render target, or into the window with 0 -
+	// a size of 0 uses the size of the window
+	void SetRenderTarget(RENDER_TARGET target, int width = 0, int height = 0);
+	// clear the color and depth of the render target
+	void Clear(const glm::vec4& color);
+	// switch the shader and fixed function state
+	void SetPipeline(RENDER_PIPELINE pipeline);
+	// bind a texture to a texture unit
+	void BindTexture(int slot, RENDER_TEXTURE texture);
+	// bind a range of a uniform buffer to a binding point
+	void BindUniformBuffer(uint32_t binding, RENDER_BUFFER buffer, size_t offset, size_t size);
+
+	// set shader uniforms by name
+	void SetInt(const char* name, int value);
+	void SetFloat(const char* name, float value);
+	void SetVec2(const char* name, const glm::vec2& value);
+	void SetVec3(const char* name, const glm::vec3& value);
+	void SetVec4(const char* name, const glm::vec4& value);
+	void SetMat4(const char* name, const glm::mat4& value);
+
+	// draw the parts of a basic shape - a SceneFile::MESH_TYPE
+	// with SceneFile::MESH_PART flags
+	void DrawShape(uint32_t meshType, uint32_t parts);
+	// draw triangles from a vertex buffer with the layout of
+	// the basic shapes - position, normal and UV
+	void Draw(RENDER_BUFFER vertexBuffer, uint32_t firstVertex, uint32_t vertexCount);
+
+	// time the GPU work of the commands up to the matching
+	// EndTimer(), which may be in a later list - timers nest
+	void BeginTimer(const char* name);
+	void EndTimer();
+
+	// forget the recorded commands, keeping the memory
+	void Reset();
+
+	size_t GetCommandCount() const { return(m_commands.size()); }
+	const COMMAND& GetCommand(size_t index) const { return(m_commands[index]); }
+	// name of a COMMAND_SET_* or COMMAND_BEGIN_TIMER command
+	const char* GetName(const COMMAND& command) const { return(&m_names[command.nameOffset]); }
+
+private:
+	std::vector<COMMAND> m_commands;
+	// the uniform names, each one followed by a 0
+	std::vector<char> m_names;
+
+	// add a command of a type with everything else zeroed
+	COMMAND& AddCommand(uint32_t type);
+	// add a uniform or timer command, copying its name
+	COMMAND& AddUniform(uint32_t type, const char* name);
+};
+
+/***********************************************************
+ *  RenderDevice
+ *
+ *  This class is the interface the scene code renders with.
+ *  Objects are created and updated right away, and the draws
+ *  are made by submitting command lists.  GLRenderDevice runs
+ *  everything with OpenGL; other backends, like the CPU
+ *  renderers or devices that only count or record the
+ *  commands, can be put in its place.
+ ***********************************************************/
+class RenderDevice
+{
+public:
+	// destructor
+	virtual ~RenderDevice() {}
+
+	enum BUFFER_TYPE
+	{
+		BUFFER_VERTEX = 0,
+		BUFFER_UNIFORM
+	};
+
+	struct BUFFER_DESC
+	{
+		uint32_t type;
+		size_t size;
+		// the contents are updated often
+		bool bDynamic;
+	};
+
+	enum TEXTURE_TYPE
+	{
+		TEXTURE_2D = 0,
+		TEXTURE_CUBE
+	};
+
+	// the 8 bit formats are uploaded from bytes and the 16 bit
+	// float formats from 32 bit floats
+	enum TEXTURE_FORMAT
+	{
+		FORMAT_R8 = 0,
+		FORMAT_RGB8,
+		FORMAT_RGBA8,
+		FORMAT_RG16F,
+		FORMAT_RGB16F
+	};
+
+	struct TEXTURE_DESC
+	{
+		uint32_t type;
+		uint32_t format;
+		int width;
+		int height;
+		// levels passed in, the rest is generated when asked for
+		int mipLevels;
+		bool bGenerateMipmaps;
+		// filter between the mip levels when minifying
+		bool bMipmapFiltering;
+		// repeat the texture, instead of clamping to the edge
+		bool bRepeat;
+	};
+
+	enum BLEND_MODE
+	{
+		BLEND_NONE = 0,
+		BLEND_ALPHA
+	};
+
+	// fixed function state drawn with, the shader program is
+	// the one the device was created with
+	struct PIPELINE_DESC
+	{
+		uint32_t blendMode;
+		bool bDepthTest;
+		bool bDepthWrite;
+		// pull the depth towards the camera, for decals
+		bool bPolygonOffset;
+		// uniform block connected to a binding point, or NULL
+		const char* uniformBlockName;
+		uint32_t uniformBlockBinding;
+	};
+
+	// create a buffer, with its contents when data is not NULL
+	virtual RENDER_BUFFER CreateBuffer(const BUFFER_DESC& desc, const void* data) = 0;
+	// overwrite a range of a buffer
+	virtual void UpdateBuffer(RENDER_BUFFER buffer, size_t offset, size_t size, const void* data) = 0;
+	// copy the start of one buffer into another
+	virtual void CopyBuffer(RENDER_BUFFER source, RENDER_BUFFER destination, size_t size) = 0;
+	virtual void DestroyBuffer(RENDER_BUFFER buffer) = 0;
+	// distance uniform buffer ranges have to be aligned to
+	virtual size_t GetUniformBufferAlignment() const = 0;
+
+	// create a texture - data holds the pixels of each mip
+	// level, one face after the other for cube maps
+	virtual RENDER_TEXTURE CreateTexture(const TEXTURE_DESC& desc, const void* const* data) = 0;
+	virtual void DestroyTexture(RENDER_TEXTURE texture) = 0;
+
+	// create an offscreen color and depth target
+	virtual RENDER_TARGET CreateRenderTarget(int width, int height) = 0;
+	// read back the color of a target as BGRA, bottom row first
+	virtual bool ReadPixels(RENDER_TARGET target, int width, int height, void* pixels) = 0;
+	virtual void DestroyRenderTarget(RENDER_TARGET target) = 0;
+	// size of the window the device draws into
+	virtual void GetWindowSize(int& width, int& height) const = 0;
+
+	virtual RENDER_PIPELINE CreatePipeline(const PIPELINE_DESC& desc) = 0;
+	virtual void DestroyPipeline(RENDER_PIPELINE pipeline) = 0;
+
+	// run the recorded commands of a list
+	virtual void Submit(const RenderCommandList& commands) = 0;
+	// mark the end of a frame, for devices that keep work of
+	// the last frames around
+	virtual void EndFrame() {}
+
+	// get a texture description with the usual settings
+	static TEXTURE_DESC GetTextureDesc(uint32_t format, int width, int height);
+	// get the GPU memory of a texture with all of its levels
+	static size_t GetTextureSize(const TEXTURE_DESC& desc);
+	// get a pipeline description for opaque depth tested draws
+	static PIPELINE_DESC GetPipelineDesc();
+};
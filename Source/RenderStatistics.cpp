@@ -0,0 +1,146 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderstatistics.cpp
+// ============
+// count the rendering work of every frame and write it out as CSV
+///////////////////////////////////////////////////////////////////////////////
+
+#include "RenderStatistics.h"
+
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// names of the stages in the CSV header
+	const char* const g_StageNames[RenderStatistics::STAGE_COUNT] = {
+		"view",
+		"update",
+		"record",
+		"submit",
+		"present" };
+}
+
+/***********************************************************
+ *  RenderStatistics()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+RenderStatistics::RenderStatistics()
+{
+	ResetFrame(m_currentFrame, 0);
+	ResetFrame(m_lastFrame, 0);
+}
+
+/***********************************************************
+ *  ~RenderStatistics()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+RenderStatistics::~RenderStatistics()
+{
+	CloseCSV();
+}
+
+/***********************************************************
+ *  ResetFrame()
+ *
+ *  This method is used for clearing the counters of a frame.
+ ***********************************************************/
+void RenderStatistics::ResetFrame(FRAME_STATISTICS& frame, uint64_t frameIndex)
+{
+	frame.frameIndex = frameIndex;
+	frame.drawCalls = 0;
+	frame.instances = 0;
+	frame.triangles = 0;
+	frame.programBinds = 0;
+	frame.textureBinds = 0;
+	frame.vertexArrayBinds = 0;
+	frame.uniformUploads = 0;
+	frame.bufferBytesUploaded = 0;
+	for (int i = 0; i < STAGE_COUNT; i++)
+	{
+		frame.stageTimes[i] = 0.0;
+	}
+}
+
+/***********************************************************
+ *  OpenCSV()
+ *
+ *  This method is used for opening the CSV file the frames
+ *  are written to, and writing its header.
+ ***********************************************************/
+bool RenderStatistics::OpenCSV(const char* filename)
+{
+	CloseCSV();
+	m_csvFile.open(filename, std::ios::trunc);
+	if (!m_csvFile.is_open())
+	{
+		std::cout << "Could not write statistics file:" << filename << std::endl;
+		return(false);
+	}
+
+	m_csvFile << "frame,draw_calls,instances,triangles,program_binds,texture_binds,"
+		<< "vertex_array_binds,uniform_uploads,buffer_bytes";
+	for (int i = 0; i < STAGE_COUNT; i++)
+	{
+		m_csvFile << "," << g_StageNames[i] << "_ms";
+	}
+	m_csvFile << "\n";
+	return(true);
+}
+
+/***********************************************************
+ *  CloseCSV()
+ *
+ *  This method is used for closing the CSV file.
+ ***********************************************************/
+void RenderStatistics::CloseCSV()
+{
+	if (m_csvFile.is_open())
+	{
+		m_csvFile.close();
+	}
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for finishing the frame being
+ *  collected.  It becomes the last frame, is written to the
+ *  CSV file, and the counting starts over for the next one.
+ ***********************************************************/
+void RenderStatistics::EndFrame()
+{
+	m_lastFrame = m_currentFrame;
+
+	if (m_csvFile.is_open())
+	{
+		const FRAME_STATISTICS& frame = m_lastFrame;
+		m_csvFile << frame.frameIndex << ","
+			<< frame.drawCalls << ","
+			<< frame.instances << ","
+			<< frame.triangles << ","
+			<< frame.programBinds << ","
+			<< frame.textureBinds << ","
+			<< frame.vertexArrayBinds << ","
+			<< frame.uniformUploads << ","
+			<< frame.bufferBytesUploaded;
+		for (int i = 0; i < STAGE_COUNT; i++)
+		{
+			m_csvFile << "," << frame.stageTimes[i];
+		}
+		m_csvFile << "\n";
+	}
+
+	ResetFrame(m_currentFrame, m_lastFrame.frameIndex + 1);
+}
+
+/***********************************************************
+ *  GetStageName()
+ *
+ *  This method is used for getting the name of a stage.
+ ***********************************************************/
+const char* RenderStatistics::GetStageName(STAGE stage)
+{
+	return(g_StageNames[stage]);
+}
@@ -0,0 +1,128 @@
+///////////////////////////////////////////////////////////////////////////////
+// renderstatistics.h
+// ============
+// count the rendering work of every frame and write it out as CSV
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+/***********************************************************
+ *  RenderStatistics
+ *
+ *  This class collects what a frame did - the draws and
+ *  state changes the render device ran, and the CPU time of
+ *  each stage of the frame.  The frame being collected is
+ *  finished by EndFrame(), which keeps it for querying and
+ *  writes it as a CSV row when a CSV file is open, so frame
+ *  spikes can be lined up with the state changes behind
+ *  them.  Counting is only done by users that were given a
+ *  statistics object, so it costs nothing otherwise.
+ ***********************************************************/
+class RenderStatistics
+{
+public:
+	// constructor
+	RenderStatistics();
+	// destructor
+	~RenderStatistics();
+
+	// stages of a frame whose CPU time is measured
+	enum STAGE
+	{
+		STAGE_VIEW = 0,
+		STAGE_UPDATE,
+		STAGE_RECORD,
+		STAGE_SUBMIT,
+		STAGE_PRESENT,
+		STAGE_COUNT
+	};
+
+	struct FRAME_STATISTICS
+	{
+		uint64_t frameIndex;
+		uint32_t drawCalls;
+		// objects drawn - every draw is one instance, since
+		// nothing is drawn instanced
+		uint32_t instances;
+		uint32_t triangles;
+		// binds that changed what was bound - asking for the
+		// bound object again is not counted
+		uint32_t programBinds;
+		uint32_t textureBinds;
+		uint32_t vertexArrayBinds;
+		uint32_t uniformUploads;
+		uint64_t bufferBytesUploaded;
+		// CPU milliseconds of each STAGE
+		double stageTimes[STAGE_COUNT];
+	};
+
+	// counters of the frame being collected, added to by the
+	// device and the scene
+	FRAME_STATISTICS& GetCurrentFrame() { return(m_currentFrame); }
+	// counters of the last finished frame
+	const FRAME_STATISTICS& GetLastFrame() const { return(m_lastFrame); }
+	// add CPU time to a stage of the frame being collected
+	void AddStageTime(STAGE stage, double milliseconds) { m_currentFrame.stageTimes[stage] += milliseconds; }
+
+	// write every finished frame as a row of a CSV file
+	bool OpenCSV(const char* filename);
+	void CloseCSV();
+	// finish the frame being collected and start the next one
+	void EndFrame();
+
+	static const char* GetStageName(STAGE stage);
+
+private:
+	FRAME_STATISTICS m_currentFrame;
+	FRAME_STATISTICS m_lastFrame;
+	std::ofstream m_csvFile;
+
+	// clear the counters of a frame
+	static void ResetFrame(FRAME_STATISTICS& frame, uint64_t frameIndex);
+};
+
+/***********************************************************
+ *  StageTimer
+ *
+ *  This class adds the time of the scope it is declared in,
+ *  or until Stop(), to a stage of the frame.  It does nothing
+ *  without a statistics object.
+ ***********************************************************/
+class StageTimer
+{
+public:
+	StageTimer(RenderStatistics* pStatistics, RenderStatistics::STAGE stage)
+	{
+		m_pStatistics = pStatistics;
+		m_stage = stage;
+		if (NULL != m_pStatistics)
+		{
+			m_start = std::chrono::steady_clock::now();
+		}
+	}
+	~StageTimer()
+	{
+		Stop();
+	}
+
+	void Stop()
+	{
+		if (NULL != m_pStatistics)
+		{
+			std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - m_start;
+			m_pStatistics->AddStageTime(m_stage, elapsed.count());
+			m_pStatistics = NULL;
+		}
+	}
+
+private:
+	RenderStatistics* m_pStatistics;
+	RenderStatistics::STAGE m_stage;
+	std::chrono::steady_clock::time_point m_start;
+};
@@ -0,0 +1,666 @@
+///////////////////////////////////////////////////////////////////////////////
+// residentscene.cpp
+// ============
+// one scene file held in memory, ready to be rendered or switched to
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ResidentScene.h"
+#include "FrameArena.h"
+#include "Profiler.h"
+#include "SceneDiff.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <cstring>
+#include <iostream>
+#include <sys/stat.h>
+
+// declaration of global variables
+namespace
+{
+	const std::string g_TextSceneExtension = ".scene";
+
+	/***********************************************************
+	 *  IsTextSceneFile()
+	 *
+	 *  Text scene files are compiled next to themselves, other
+	 *  files are mapped as binary scene files.
+	 ***********************************************************/
+	bool IsTextSceneFile(const std::string& filename)
+	{
+		return((filename.size() > g_TextSceneExtension.size()) &&
+			(filename.compare(filename.size() - g_TextSceneExtension.size(), g_TextSceneExtension.size(), g_TextSceneExtension) == 0));
+	}
+}
+
+/***********************************************************
+ *  ResidentScene()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ResidentScene::ResidentScene(RenderDevice* pDevice, ResourceCache* pResourceCache, TextRenderer* pTextRenderer, uint32_t objectBlockBinding)
+{
+	m_pDevice = pDevice;
+	m_pResourceCache = pResourceCache;
+	m_pTextRenderer = pTextRenderer;
+	m_objectBlockBinding = objectBlockBinding;
+	m_fileTime = -1;
+}
+
+/***********************************************************
+ *  ~ResidentScene()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ResidentScene::~ResidentScene()
+{
+	Clear();
+	m_objectBuffer.Destroy();
+}
+
+/***********************************************************
+ *  GetFileTime()
+ *
+ *  This method is used for getting the modification time of
+ *  a file, or -1 when it cannot be read.
+ ***********************************************************/
+long long ResidentScene::GetFileTime(const std::string& filename)
+{
+	struct stat fileStatus;
+	if (stat(filename.c_str(), &fileStatus) != 0)
+	{
+		return(-1);
+	}
+	return((long long)fileStatus.st_mtime);
+}
+
+/***********************************************************
+ *  Preload()
+ *
+ *  This method is used for doing the slow part of loading a
+ *  scene without the render device - parsing the scene file and decoding
+ *  the images that no loaded scene uses yet.
+ ***********************************************************/
+void ResidentScene::Preload(
+	const std::string& filename,
+	const std::set<std::string>& residentTextures,
+	PRELOAD_DATA& data)
+{
+	data.sourceFilename = filename;
+	data.fileTime = GetFileTime(filename);
+	data.images.clear();
+
+	if (IsTextSceneFile(filename))
+	{
+		data.bLoaded = SceneFile::ParseText(filename.c_str(), data.description);
+	}
+	else
+	{
+		SceneFile binaryFile;
+		data.bLoaded = binaryFile.Open(filename.c_str());
+		binaryFile.GetDescription(data.description);
+	}
+
+	if (!data.bLoaded)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < data.description.textures.size(); i++)
+	{
+		const std::string& imageFilename = data.description.textures[i].path;
+		if (residentTextures.find(imageFilename) != residentTextures.end())
+		{
+			continue;
+		}
+
+		ResourceCache::DECODED_IMAGE image;
+		if (ResourceCache::DecodeImage(imageFilename, image))
+		{
+			data.images.push_back(image);
+		}
+	}
+}
+
+/***********************************************************
+ *  FreePreloadData()
+ *
+ *  This method is used for freeing decoded images that were
+ *  not handed to the resource cache.
+ ***********************************************************/
+void ResidentScene::FreePreloadData(PRELOAD_DATA& data)
+{
+	for (size_t i = 0; i < data.images.size(); i++)
+	{
+		ResourceCache::FreeImage(data.images[i]);
+	}
+	data.images.clear();
+}
+
+/***********************************************************
+ *  Reload()
+ *
+ *  This method is used for picking up edits to the scene
+ *  file.  It is cheap to call every frame, since only the
+ *  modification time is checked until the file changes.
+ ***********************************************************/
+bool ResidentScene::Reload()
+{
+	PROFILE_SCOPE("ResidentScene::Reload");
+	if (GetFileTime(m_sourceFilename) == m_fileTime)
+	{
+		return(false);
+	}
+
+	// reading the edit allocates, even when it has errors
+	FrameArena::ExpectAllocations();
+	PRELOAD_DATA data;
+	Preload(m_sourceFilename, m_pResourceCache->GetResidentTextures(), data);
+	m_fileTime = data.fileTime;
+
+	// keep showing the loaded scene while the edit has errors
+	if (!data.bLoaded)
+	{
+		return(false);
+	}
+
+	return(Apply(data));
+}
+
+/***********************************************************
+ *  Apply()
+ *
+ *  This method is used for mapping the preloaded scene and
+ *  bringing the GPU state up to date with it.  The scene is
+ *  compared with the loaded one, and only the textures,
+ *  object buffer slots and text blocks that differ are
+ *  uploaded.
+ ***********************************************************/
+bool ResidentScene::Apply(PRELOAD_DATA& data)
+{
+	PROFILE_SCOPE("ResidentScene::Apply");
+	m_sourceFilename = data.sourceFilename;
+	m_fileTime = data.fileTime;
+
+	if (data.bLoaded)
+	{
+		if (IsTextSceneFile(m_sourceFilename))
+		{
+			// the mapping has to be closed before its file is rewritten
+			std::string binaryFilename = m_sourceFilename + "b";
+			m_sceneFile.Close();
+			if (SceneFile::WriteBinary(data.description, binaryFilename.c_str()))
+			{
+				m_sceneFile.Open(binaryFilename.c_str());
+			}
+		}
+		else
+		{
+			m_sceneFile.Open(m_sourceFilename.c_str());
+		}
+	}
+
+	if (!m_sceneFile.IsOpen())
+	{
+		// treat everything as new if the file becomes usable again
+		FreePreloadData(data);
+		Clear();
+		return(false);
+	}
+
+	if (!m_objectBuffer.IsCreated())
+	{
+		m_objectBuffer.Create(m_pDevice, m_objectBlockBinding, (int)data.description.objects.size());
+	}
+
+	// edits are compared with the scene file values, not the overrides
+	ApplyOverrides(OVERRIDES());
+
+	SceneDiff::RESULT diff;
+	SceneDiff::Compute(m_description, data.description, diff);
+	m_objectBuffer.ResetUploadedBytes();
+
+	UpdateTextures(data);
+
+	std::map<uint32_t, const SceneFile::OBJECT_DESC*> objectsByID;
+	for (size_t i = 0; i < data.description.objects.size(); i++)
+	{
+		objectsByID[data.description.objects[i].id] = &data.description.objects[i];
+	}
+
+	for (size_t i = 0; i < diff.removedObjects.size(); i++)
+	{
+		m_objectBuffer.Release(m_objectSlots[diff.removedObjects[i]]);
+		m_objectSlots.erase(diff.removedObjects[i]);
+	}
+
+	ObjectBuffer::OBJECT_DATA objectData;
+	for (size_t i = 0; i < diff.addedObjects.size(); i++)
+	{
+		int slot = m_objectBuffer.Allocate();
+		m_objectSlots[diff.addedObjects[i]] = slot;
+		GetObjectData(*objectsByID[diff.addedObjects[i]], objectData);
+		m_objectBuffer.Update(slot, objectData);
+	}
+
+	// only the ranges of the changed properties are written,
+	// mesh and texture changes are picked up at draw time
+	for (size_t i = 0; i < diff.changedObjects.size(); i++)
+	{
+		const SceneDiff::OBJECT_CHANGE& change = diff.changedObjects[i];
+		int slot = m_objectSlots[change.id];
+		GetObjectData(*objectsByID[change.id], objectData);
+
+		if (change.flags & SceneDiff::CHANGE_TRANSFORM)
+		{
+			m_objectBuffer.UpdateRange(slot, ObjectBuffer::MODEL_OFFSET, ObjectBuffer::MODEL_SIZE, objectData.model);
+		}
+		if (change.flags & SceneDiff::CHANGE_APPEARANCE)
+		{
+			m_objectBuffer.UpdateRange(slot, ObjectBuffer::APPEARANCE_OFFSET, ObjectBuffer::APPEARANCE_SIZE, objectData.color);
+		}
+	}
+
+	// the draw order follows the new file
+	const SceneFile::OBJECT* objects = m_sceneFile.GetObjects();
+	m_objectSlotsByIndex.resize(m_sceneFile.GetObjectCount());
+	for (uint32_t i = 0; i < m_sceneFile.GetObjectCount(); i++)
+	{
+		m_objectSlotsByIndex[i] = m_objectSlots[objects[i].id];
+	}
+	m_description = data.description;
+
+	// text blocks are only laid out again when their layout
+	// changed, moving or recoloring them costs nothing
+	for (size_t i = 0; i < diff.removedTexts.size(); i++)
+	{
+		m_pTextRenderer->DestroyBlock(m_textBlocks[diff.removedTexts[i]]);
+		m_textBlocks.erase(diff.removedTexts[i]);
+	}
+	std::vector<uint32_t> textIDs = diff.addedTexts;
+	textIDs.insert(textIDs.end(), diff.changedTexts.begin(), diff.changedTexts.end());
+	for (size_t i = 0; i < textIDs.size(); i++)
+	{
+		const SceneFile::TEXT_DESC* pText = FindText(textIDs[i]);
+		if (NULL != pText)
+		{
+			BuildTextBlock(*pText, pText->text);
+		}
+	}
+
+	std::cout << "Loaded scene file:" << m_sourceFilename
+		<< ", objects:" << m_sceneFile.GetObjectCount()
+		<< ", added:" << diff.addedObjects.size()
+		<< ", removed:" << diff.removedObjects.size()
+		<< ", changed:" << diff.changedObjects.size()
+		<< ", textures changed:" << diff.changedTextures.size()
+		<< ", texts laid out:" << textIDs.size()
+		<< ", bytes uploaded:" << m_objectBuffer.GetUploadedBytes() << std::endl;
+
+	return(true);
+}
+
+/***********************************************************
+ *  UpdateTextures()
+ *
+ *  This method is used for building the texture table of the
+ *  new scene.  Textures the scene already had are kept, new
+ *  ones are acquired from the cache - from the preloaded
+ *  pixels when there are some - and the ones no longer used
+ *  are released afterwards, so shared textures never reload.
+ ***********************************************************/
+void ResidentScene::UpdateTextures(PRELOAD_DATA& data)
+{
+	std::vector<TEXTURE_SLOT> textures;
+	const std::vector<SceneFile::TEXTURE_DESC>& updated = data.description.textures;
+
+	for (size_t i = 0; i < updated.size(); i++)
+	{
+		if ((int)textures.size() >= MAX_SCENE_TEXTURES)
+		{
+			std::cout << "No free texture slot for scene texture:" << updated[i].tag << std::endl;
+			break;
+		}
+
+		TEXTURE_SLOT texture;
+		texture.tag = updated[i].tag;
+		texture.sceneFilename = updated[i].path;
+		texture.filename = updated[i].path;
+		texture.ID = 0;
+
+		for (size_t j = 0; j < data.images.size(); j++)
+		{
+			if ((data.images[j].filename == texture.filename) && (NULL != data.images[j].pixels))
+			{
+				texture.ID = m_pResourceCache->AcquireTexture(data.images[j]);
+			}
+		}
+		if (texture.ID == 0)
+		{
+			texture.ID = m_pResourceCache->AcquireTexture(texture.filename);
+		}
+		textures.push_back(texture);
+	}
+
+	// release after acquiring, so unchanged textures stay loaded
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		m_pResourceCache->ReleaseTexture(m_textures[i].filename);
+	}
+	m_textures = textures;
+
+	FreePreloadData(data);
+}
+
+/***********************************************************
+ *  ApplyOverrides()
+ *
+ *  This method is used for switching from the overrides in
+ *  use to another set.  Each texture tag, object color and
+ *  text is compared with what is loaded now, so rendering
+ *  variants back to back only uploads what they change.
+ ***********************************************************/
+int ResidentScene::ApplyOverrides(const OVERRIDES& overrides)
+{
+	int uploadCount = 0;
+
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		TEXTURE_SLOT& texture = m_textures[i];
+		std::string filename = texture.sceneFilename;
+		std::map<std::string, std::string>::const_iterator it = overrides.textures.find(texture.tag);
+		if (it != overrides.textures.end())
+		{
+			filename = it->second;
+		}
+		if (filename == texture.filename)
+		{
+			continue;
+		}
+
+		// keep the loaded image if the replacement cannot be read
+		RENDER_TEXTURE textureID = m_pResourceCache->AcquireTexture(filename);
+		if (textureID == 0)
+		{
+			continue;
+		}
+		m_pResourceCache->ReleaseTexture(texture.filename);
+		texture.filename = filename;
+		texture.ID = textureID;
+		uploadCount++;
+	}
+
+	// the objects whose color is overridden now or was before
+	std::set<uint32_t> objectIDs;
+	std::map<uint32_t, glm::vec4>::const_iterator color;
+	for (color = m_overrides.colors.begin(); color != m_overrides.colors.end(); color++)
+	{
+		objectIDs.insert(color->first);
+	}
+	for (color = overrides.colors.begin(); color != overrides.colors.end(); color++)
+	{
+		objectIDs.insert(color->first);
+	}
+
+	std::set<uint32_t>::iterator id;
+	for (id = objectIDs.begin(); id != objectIDs.end(); id++)
+	{
+		const SceneFile::OBJECT_DESC* pObject = FindObject(*id);
+		std::map<uint32_t, int>::iterator slot = m_objectSlots.find(*id);
+		if ((NULL == pObject) || (slot == m_objectSlots.end()))
+		{
+			continue;
+		}
+
+		glm::vec4 currentColor = pObject->color;
+		glm::vec4 newColor = pObject->color;
+		color = m_overrides.colors.find(*id);
+		if (color != m_overrides.colors.end())
+		{
+			currentColor = color->second;
+		}
+		color = overrides.colors.find(*id);
+		if (color != overrides.colors.end())
+		{
+			newColor = color->second;
+		}
+		if (newColor == currentColor)
+		{
+			continue;
+		}
+
+		ObjectBuffer::OBJECT_DATA objectData;
+		GetObjectData(*pObject, objectData);
+		for (int c = 0; c < 4; c++)
+		{
+			objectData.color[c] = newColor[c];
+		}
+		m_objectBuffer.UpdateRange(slot->second, ObjectBuffer::APPEARANCE_OFFSET, ObjectBuffer::APPEARANCE_SIZE, objectData.color);
+		uploadCount++;
+	}
+
+	// the text blocks whose text is overridden now or was before
+	std::set<uint32_t> textIDs;
+	std::map<uint32_t, std::string>::const_iterator text;
+	for (text = m_overrides.texts.begin(); text != m_overrides.texts.end(); text++)
+	{
+		textIDs.insert(text->first);
+	}
+	for (text = overrides.texts.begin(); text != overrides.texts.end(); text++)
+	{
+		textIDs.insert(text->first);
+	}
+
+	for (id = textIDs.begin(); id != textIDs.end(); id++)
+	{
+		const SceneFile::TEXT_DESC* pText = FindText(*id);
+		if (NULL == pText)
+		{
+			continue;
+		}
+
+		std::string currentText = pText->text;
+		std::string newText = pText->text;
+		text = m_overrides.texts.find(*id);
+		if (text != m_overrides.texts.end())
+		{
+			currentText = text->second;
+		}
+		text = overrides.texts.find(*id);
+		if (text != overrides.texts.end())
+		{
+			newText = text->second;
+		}
+		if (newText == currentText)
+		{
+			continue;
+		}
+
+		BuildTextBlock(*pText, newText);
+		uploadCount++;
+	}
+
+	m_overrides = overrides;
+
+	return(uploadCount);
+}
+
+/***********************************************************
+ *  FindObject()
+ *
+ *  This method is used for finding an object of the scene
+ *  description by its ID, or NULL.
+ ***********************************************************/
+const SceneFile::OBJECT_DESC* ResidentScene::FindObject(uint32_t id) const
+{
+	for (size_t i = 0; i < m_description.objects.size(); i++)
+	{
+		if (m_description.objects[i].id == id)
+		{
+			return(&m_description.objects[i]);
+		}
+	}
+	return(NULL);
+}
+
+/***********************************************************
+ *  FindText()
+ *
+ *  This method is used for finding a text block of the scene
+ *  description by its ID, or NULL.
+ ***********************************************************/
+const SceneFile::TEXT_DESC* ResidentScene::FindText(uint32_t id) const
+{
+	for (size_t i = 0; i < m_description.texts.size(); i++)
+	{
+		if (m_description.texts[i].id == id)
+		{
+			return(&m_description.texts[i]);
+		}
+	}
+	return(NULL);
+}
+
+/***********************************************************
+ *  BuildTextBlock()
+ *
+ *  This method is used for laying out a text block of the
+ *  scene into its vertex buffer.  Without a font the blocks
+ *  are left empty and nothing is drawn for them.
+ ***********************************************************/
+void ResidentScene::BuildTextBlock(const SceneFile::TEXT_DESC& text, const std::string& value)
+{
+	if ((NULL == m_pTextRenderer) || !m_pTextRenderer->IsReady())
+	{
+		return;
+	}
+
+	std::map<uint32_t, TextRenderer::TEXT_BLOCK>::iterator it = m_textBlocks.find(text.id);
+	if (it == m_textBlocks.end())
+	{
+		it = m_textBlocks.insert(std::make_pair(text.id, TextRenderer::GetEmptyBlock())).first;
+	}
+
+	TextRenderer::TEXT_LAYOUT layout;
+	layout.size = text.size;
+	layout.maxWidth = text.maxWidth;
+	layout.lineSpacing = text.lineSpacing;
+	layout.alignment = text.alignment;
+	m_pTextRenderer->BuildBlock(it->second, value, layout);
+}
+
+/***********************************************************
+ *  GetTextBlock()
+ *
+ *  This method is used for getting the vertex buffer of a
+ *  text block, or NULL when it was not laid out.
+ ***********************************************************/
+const TextRenderer::TEXT_BLOCK* ResidentScene::GetTextBlock(uint32_t id) const
+{
+	std::map<uint32_t, TextRenderer::TEXT_BLOCK>::const_iterator it = m_textBlocks.find(id);
+	if (it == m_textBlocks.end())
+	{
+		return(NULL);
+	}
+	return(&it->second);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for releasing the textures, object
+ *  buffer slots and text blocks and unmapping the scene file.
+ ***********************************************************/
+void ResidentScene::Clear()
+{
+	std::map<uint32_t, TextRenderer::TEXT_BLOCK>::iterator block;
+	for (block = m_textBlocks.begin(); block != m_textBlocks.end(); block++)
+	{
+		m_pTextRenderer->DestroyBlock(block->second);
+	}
+	m_textBlocks.clear();
+
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		m_pResourceCache->ReleaseTexture(m_textures[i].filename);
+	}
+	m_textures.clear();
+
+	std::map<uint32_t, int>::iterator it;
+	for (it = m_objectSlots.begin(); it != m_objectSlots.end(); it++)
+	{
+		m_objectBuffer.Release(it->second);
+	}
+	m_objectSlots.clear();
+	m_objectSlotsByIndex.clear();
+	m_overrides = OVERRIDES();
+	m_description = SceneFile::DESCRIPTION();
+	m_sceneFile.Close();
+}
+
+/***********************************************************
+ *  GetObjectData()
+ *
+ *  This method is used for filling the object buffer values
+ *  of a scene object.
+ ***********************************************************/
+void ResidentScene::GetObjectData(const SceneFile::OBJECT_DESC& object, ObjectBuffer::OBJECT_DATA& data)
+{
+	glm::mat4 modelView = SceneFile::ComputeModelMatrix(object.scale, object.rotation, object.position);
+	memcpy(data.model, glm::value_ptr(modelView), sizeof(data.model));
+
+	for (int c = 0; c < 4; c++)
+	{
+		data.color[c] = object.color[c];
+	}
+	data.uvScale[0] = object.uvScale.x;
+	data.uvScale[1] = object.uvScale.y;
+	data.uvScale[2] = 0.0f;
+	data.uvScale[3] = 0.0f;
+}
+
+/***********************************************************
+ *  BindTextures()
+ *
+ *  This method is used for binding the scene textures to the
+ *  texture units, which is all switching scenes costs.
+ ***********************************************************/
+void ResidentScene::BindTextures(RenderCommandList& commands) const
+{
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		commands.BindTexture((int)i, m_textures[i].ID);
+	}
+}
+
+/***********************************************************
+ *  FindTextureSlot()
+ *
+ *  This method is used for getting the texture unit of the
+ *  texture with the passed in tag, or -1.
+ ***********************************************************/
+int ResidentScene::FindTextureSlot(const char* tag) const
+{
+	for (size_t i = 0; i < m_textures.size(); i++)
+	{
+		if (m_textures[i].tag.compare(tag) == 0)
+		{
+			return((int)i);
+		}
+	}
+	return(-1);
+}
+
+/***********************************************************
+ *  BindObject()
+ *
+ *  This method is used for binding the object buffer slot of
+ *  a mapped object before it is drawn.
+ ***********************************************************/
+void ResidentScene::BindObject(RenderCommandList& commands, uint32_t objectIndex) const
+{
+	if (objectIndex < m_objectSlotsByIndex.size())
+	{
+		m_objectBuffer.Bind(commands, m_objectSlotsByIndex[objectIndex]);
+	}
+}
@@ -0,0 +1,137 @@
+///////////////////////////////////////////////////////////////////////////////
+// residentscene.h
+// ============
+// one scene file held in memory, ready to be rendered or switched to
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneFile.h"
+#include "ObjectBuffer.h"
+#include "ResourceCache.h"
+#include "TextRenderer.h"
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  ResidentScene
+ *
+ *  This class holds everything one scene file needs on the
+ *  GPU - the mapped scene, its object buffer, the vertex
+ *  buffers of its text blocks and references to its textures
+ *  in the shared resource cache.  Several of
+ *  them can be loaded at the same time, and edits to the
+ *  scene file are applied incrementally.
+ ***********************************************************/
+class ResidentScene
+{
+public:
+	// constructor
+	ResidentScene(RenderDevice* pDevice, ResourceCache* pResourceCache, TextRenderer* pTextRenderer, uint32_t objectBlockBinding);
+	// destructor
+	~ResidentScene();
+
+	// the scene file contents prepared without the render device
+	struct PRELOAD_DATA
+	{
+		std::string sourceFilename;
+		long long fileTime;
+		bool bLoaded;
+		SceneFile::DESCRIPTION description;
+		std::vector<ResourceCache::DECODED_IMAGE> images;
+	};
+
+	// per-variant replacements applied on top of the scene file
+	struct OVERRIDES
+	{
+		// image file to use for a texture tag
+		std::map<std::string, std::string> textures;
+		// color to use for an object ID
+		std::map<uint32_t, glm::vec4> colors;
+		// text to show in a text block ID
+		std::map<uint32_t, std::string> texts;
+	};
+
+	// most textures one scene can bind, the last texture units
+	// are reserved for the glyph atlas and the PBR lookups
+	static const int MAX_SCENE_TEXTURES = 12;
+
+	// parse the scene file and decode the images that are not
+	// in the passed in set - safe on a background thread
+	static void Preload(
+		const std::string& filename,
+		const std::set<std::string>& residentTextures,
+		PRELOAD_DATA& data);
+	// free the decoded images of preload data that was not applied
+	static void FreePreloadData(PRELOAD_DATA& data);
+	// get the modification time of a file, or -1
+	static long long GetFileTime(const std::string& filename);
+
+	// map the preloaded scene and update the GPU state for it
+	bool Apply(PRELOAD_DATA& data);
+	// apply the edits made to the scene file since it was loaded
+	bool Reload();
+	// switch to another set of overrides, uploading only the
+	// textures and objects that differ - returns the upload count
+	int ApplyOverrides(const OVERRIDES& overrides);
+
+	// bind the scene textures to the texture units
+	void BindTextures(RenderCommandList& commands) const;
+	// find the texture unit used for a texture tag
+	int FindTextureSlot(const char* tag) const;
+
+	const std::string& GetSourceFilename() const { return(m_sourceFilename); }
+	const SceneFile& GetSceneFile() const { return(m_sceneFile); }
+	// bind the object buffer slot of a mapped object
+	void BindObject(RenderCommandList& commands, uint32_t objectIndex) const;
+	// get the laid out text block with an ID, or NULL
+	const TextRenderer::TEXT_BLOCK* GetTextBlock(uint32_t id) const;
+
+private:
+	struct TEXTURE_SLOT
+	{
+		std::string tag;
+		// image named by the scene file, and the one loaded now
+		std::string sceneFilename;
+		std::string filename;
+		RENDER_TEXTURE ID;
+	};
+
+	// device, shared textures and glyph atlas
+	RenderDevice* m_pDevice;
+	ResourceCache* m_pResourceCache;
+	TextRenderer* m_pTextRenderer;
+	uint32_t m_objectBlockBinding;
+	// scene file and the modification time it was loaded at
+	std::string m_sourceFilename;
+	long long m_fileTime;
+	// mapped binary scene and its editable copy
+	SceneFile m_sceneFile;
+	SceneFile::DESCRIPTION m_description;
+	// textures by texture unit
+	std::vector<TEXTURE_SLOT> m_textures;
+	// per-object values of the objects
+	ObjectBuffer m_objectBuffer;
+	// object buffer slot of each object ID, and of each mapped object
+	std::map<uint32_t, int> m_objectSlots;
+	std::vector<int> m_objectSlotsByIndex;
+	// vertex buffers of the text blocks by ID
+	std::map<uint32_t, TextRenderer::TEXT_BLOCK> m_textBlocks;
+	// overrides applied at the moment
+	OVERRIDES m_overrides;
+
+	// replace the texture table with the one of the new scene
+	void UpdateTextures(PRELOAD_DATA& data);
+	// find an object of the scene description by ID
+	const SceneFile::OBJECT_DESC* FindObject(uint32_t id) const;
+	const SceneFile::TEXT_DESC* FindText(uint32_t id) const;
+	// lay out a text block of the scene with the passed in text
+	void BuildTextBlock(const SceneFile::TEXT_DESC& text, const std::string& value);
+	// free everything when the scene file became unusable
+	void Clear();
+	// fill the object buffer values of a scene object
+	static void GetObjectData(const SceneFile::OBJECT_DESC& object, ObjectBuffer::OBJECT_DATA& data);
+};
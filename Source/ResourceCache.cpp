@@ -0,0 +1,222 @@
+///////////////////////////////////////////////////////////////////////////////
+// resourcecache.cpp
+// ============
+// reference counted textures shared between the loaded scenes
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ResourceCache.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+
+#include "stb_image.h"
+
+#include <iostream>
+
+/***********************************************************
+ *  ResourceCache()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ResourceCache::ResourceCache(RenderDevice* pDevice)
+{
+	m_pDevice = pDevice;
+}
+
+/***********************************************************
+ *  ~ResourceCache()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ResourceCache::~ResourceCache()
+{
+	std::map<std::string, TEXTURE_ENTRY>::iterator it;
+	for (it = m_textures.begin(); it != m_textures.end(); it++)
+	{
+		m_pDevice->DestroyTexture(it->second.ID);
+	}
+	m_textures.clear();
+}
+
+/***********************************************************
+ *  DecodeImage()
+ *
+ *  This method is used for reading an image file into memory.
+ *  It does not use the device, so scenes can be preloaded on a
+ *  background thread.
+ ***********************************************************/
+bool ResourceCache::DecodeImage(const std::string& filename, DECODED_IMAGE& image)
+{
+	PROFILE_SCOPE("ResourceCache::DecodeImage");
+	image.filename = filename;
+	image.width = 0;
+	image.height = 0;
+	image.colorChannels = 0;
+
+	// indicate to always flip images vertically when loaded
+	stbi_set_flip_vertically_on_load(true);
+
+	image.pixels = stbi_load(
+		filename.c_str(),
+		&image.width,
+		&image.height,
+		&image.colorChannels,
+		0);
+
+	if (NULL == image.pixels)
+	{
+		return(false);
+	}
+	MemoryTracker::Allocate(MemoryTracker::CATEGORY_DECODED_IMAGE, (uint64_t)(uintptr_t)image.pixels,
+		(size_t)image.width * image.height * image.colorChannels, filename);
+	return(true);
+}
+
+/***********************************************************
+ *  FreeImage()
+ *
+ *  This method is used for freeing the pixels of a decoded
+ *  image.
+ ***********************************************************/
+void ResourceCache::FreeImage(DECODED_IMAGE& image)
+{
+	if (NULL != image.pixels)
+	{
+		MemoryTracker::Free(MemoryTracker::CATEGORY_DECODED_IMAGE, (uint64_t)(uintptr_t)image.pixels);
+		stbi_image_free(image.pixels);
+		image.pixels = NULL;
+	}
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for uploading a decoded image into a
+ *  repeating texture and generating the mipmaps.
+ ***********************************************************/
+RENDER_TEXTURE ResourceCache::CreateTexture(const DECODED_IMAGE& image)
+{
+	PROFILE_SCOPE("ResourceCache::CreateTexture");
+	if (NULL == m_pDevice)
+	{
+		return(0);
+	}
+
+	// only RGB and RGBA images are handled
+	if ((image.colorChannels != 3) && (image.colorChannels != 4))
+	{
+		std::cout << "Not implemented to handle image with " << image.colorChannels << " channels" << std::endl;
+		return(0);
+	}
+
+	std::cout << "Successfully loaded image:" << image.filename << ", width:" << image.width << ", height:" << image.height << ", channels:" << image.colorChannels << std::endl;
+
+	// RGBA images support transparency
+	RenderDevice::TEXTURE_DESC desc = RenderDevice::GetTextureDesc(
+		(image.colorChannels == 3) ? RenderDevice::FORMAT_RGB8 : RenderDevice::FORMAT_RGBA8,
+		image.width,
+		image.height);
+	desc.bRepeat = true;
+	// generate the texture mipmaps for mapping textures to lower resolutions
+	desc.bGenerateMipmaps = true;
+	const void* levels[1] = { image.pixels };
+
+	return(m_pDevice->CreateTexture(desc, levels));
+}
+
+/***********************************************************
+ *  AcquireTexture()
+ *
+ *  This method is used for getting the texture of an image
+ *  file.  The image is only read and uploaded the first time
+ *  it is acquired.  Returns 0 if the image cannot be loaded.
+ ***********************************************************/
+RENDER_TEXTURE ResourceCache::AcquireTexture(const std::string& filename)
+{
+	std::map<std::string, TEXTURE_ENTRY>::iterator it = m_textures.find(filename);
+	if (it != m_textures.end())
+	{
+		it->second.refCount++;
+		return(it->second.ID);
+	}
+
+	DECODED_IMAGE image;
+	if (!DecodeImage(filename, image))
+	{
+		std::cout << "Could not load image:" << filename << std::endl;
+		return(0);
+	}
+
+	return(AcquireTexture(image));
+}
+
+/***********************************************************
+ *  AcquireTexture()
+ *
+ *  This method is used for getting the texture of an image
+ *  that was decoded ahead of time.  The pixels are freed
+ *  whether or not they were needed.
+ ***********************************************************/
+RENDER_TEXTURE ResourceCache::AcquireTexture(DECODED_IMAGE& image)
+{
+	std::map<std::string, TEXTURE_ENTRY>::iterator it = m_textures.find(image.filename);
+	if (it != m_textures.end())
+	{
+		FreeImage(image);
+		it->second.refCount++;
+		return(it->second.ID);
+	}
+
+	RENDER_TEXTURE textureID = CreateTexture(image);
+	FreeImage(image);
+	if (textureID == 0)
+	{
+		return(0);
+	}
+
+	TEXTURE_ENTRY entry;
+	entry.ID = textureID;
+	entry.refCount = 1;
+	m_textures[image.filename] = entry;
+	MemoryTracker::Rename(MemoryTracker::CATEGORY_TEXTURE, textureID, image.filename);
+
+	return(textureID);
+}
+
+/***********************************************************
+ *  ReleaseTexture()
+ *
+ *  This method is used for giving up a reference to the
+ *  texture of an image file, freeing it after the last one.
+ ***********************************************************/
+void ResourceCache::ReleaseTexture(const std::string& filename)
+{
+	std::map<std::string, TEXTURE_ENTRY>::iterator it = m_textures.find(filename);
+	if (it == m_textures.end())
+	{
+		return;
+	}
+
+	it->second.refCount--;
+	if (it->second.refCount <= 0)
+	{
+		m_pDevice->DestroyTexture(it->second.ID);
+		m_textures.erase(it);
+	}
+}
+
+/***********************************************************
+ *  GetResidentTextures()
+ *
+ *  This method is used for listing the image files that are
+ *  already loaded, so a preload can skip decoding them.
+ ***********************************************************/
+std::set<std::string> ResourceCache::GetResidentTextures() const
+{
+	std::set<std::string> filenames;
+	std::map<std::string, TEXTURE_ENTRY>::const_iterator it;
+	for (it = m_textures.begin(); it != m_textures.end(); it++)
+	{
+		filenames.insert(it->first);
+	}
+	return(filenames);
+}
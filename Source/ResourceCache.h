@@ -0,0 +1,72 @@
+///////////////////////////////////////////////////////////////////////////////
+// resourcecache.h
+// ============
+// reference counted textures shared between the loaded scenes
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+
+#include <map>
+#include <set>
+#include <string>
+
+/***********************************************************
+ *  ResourceCache
+ *
+ *  This class keeps one device texture per image file, no
+ *  matter how many scenes use it.  Every user acquires the
+ *  texture and releases it when done, and the texture is
+ *  freed when the last user releases it.  Image decoding is
+ *  separate from the upload, so that it can be done ahead of
+ *  time on a background thread.
+ ***********************************************************/
+class ResourceCache
+{
+public:
+	// constructor
+	ResourceCache(RenderDevice* pDevice);
+	// destructor
+	~ResourceCache();
+
+	// image pixels read from a file, not yet uploaded
+	struct DECODED_IMAGE
+	{
+		std::string filename;
+		int width;
+		int height;
+		int colorChannels;
+		unsigned char* pixels;
+	};
+
+	// read an image file into memory - safe on any thread
+	static bool DecodeImage(const std::string& filename, DECODED_IMAGE& image);
+	// free the pixels of a decoded image
+	static void FreeImage(DECODED_IMAGE& image);
+
+	// get the texture for an image file, loading it if needed
+	RENDER_TEXTURE AcquireTexture(const std::string& filename);
+	// get the texture for an already decoded image
+	RENDER_TEXTURE AcquireTexture(DECODED_IMAGE& image);
+	// give up one reference to the texture of an image file
+	void ReleaseTexture(const std::string& filename);
+
+	// image files that currently have a texture
+	std::set<std::string> GetResidentTextures() const;
+	int GetTextureCount() const { return((int)m_textures.size()); }
+
+private:
+	struct TEXTURE_ENTRY
+	{
+		RENDER_TEXTURE ID;
+		int refCount;
+	};
+	// device the textures are created on
+	RenderDevice* m_pDevice;
+	// loaded textures by image file name
+	std::map<std::string, TEXTURE_ENTRY> m_textures;
+
+	// create the texture for a decoded image
+	RENDER_TEXTURE CreateTexture(const DECODED_IMAGE& image);
+};
@@ -0,0 +1,159 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenediff.cpp
+// ============
+// compare two scene descriptions by their stable object IDs
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneDiff.h"
+
+#include <map>
+#include <string>
+
+/***********************************************************
+ *  CompareObjects()
+ *
+ *  This method is used for finding which properties differ
+ *  between two versions of the same object.
+ ***********************************************************/
+uint32_t SceneDiff::CompareObjects(
+	const SceneFile::OBJECT_DESC& loaded,
+	const SceneFile::OBJECT_DESC& updated)
+{
+	uint32_t flags = 0;
+
+	if ((loaded.scale != updated.scale) ||
+		(loaded.rotation != updated.rotation) ||
+		(loaded.position != updated.position))
+	{
+		flags |= CHANGE_TRANSFORM;
+	}
+	if ((loaded.meshType != updated.meshType) || (loaded.parts != updated.parts))
+	{
+		flags |= CHANGE_MESH;
+	}
+	if ((loaded.color != updated.color) || (loaded.uvScale != updated.uvScale))
+	{
+		flags |= CHANGE_APPEARANCE;
+	}
+	if ((loaded.bUseTexture != updated.bUseTexture) ||
+		(loaded.textureTag != updated.textureTag) ||
+		(loaded.materialTag != updated.materialTag))
+	{
+		flags |= CHANGE_TEXTURE;
+	}
+
+	return(flags);
+}
+
+/***********************************************************
+ *  TextLayoutChanged()
+ *
+ *  This method is used for checking whether a text block
+ *  would be laid out differently.
+ ***********************************************************/
+bool SceneDiff::TextLayoutChanged(
+	const SceneFile::TEXT_DESC& loaded,
+	const SceneFile::TEXT_DESC& updated)
+{
+	return((loaded.text != updated.text) ||
+		(loaded.size != updated.size) ||
+		(loaded.maxWidth != updated.maxWidth) ||
+		(loaded.lineSpacing != updated.lineSpacing) ||
+		(loaded.alignment != updated.alignment));
+}
+
+/***********************************************************
+ *  Compute()
+ *
+ *  This method is used for comparing the loaded scene with
+ *  the updated one.  Objects are matched by ID, so reordering
+ *  the lines of a scene file does not count as a change.
+ ***********************************************************/
+void SceneDiff::Compute(
+	const SceneFile::DESCRIPTION& loaded,
+	const SceneFile::DESCRIPTION& updated,
+	RESULT& result)
+{
+	result.addedObjects.clear();
+	result.removedObjects.clear();
+	result.changedObjects.clear();
+	result.changedTextures.clear();
+	result.addedTexts.clear();
+	result.removedTexts.clear();
+	result.changedTexts.clear();
+
+	std::map<uint32_t, const SceneFile::OBJECT_DESC*> loadedObjects;
+	for (size_t i = 0; i < loaded.objects.size(); i++)
+	{
+		loadedObjects[loaded.objects[i].id] = &loaded.objects[i];
+	}
+
+	for (size_t i = 0; i < updated.objects.size(); i++)
+	{
+		const SceneFile::OBJECT_DESC& object = updated.objects[i];
+		std::map<uint32_t, const SceneFile::OBJECT_DESC*>::iterator it = loadedObjects.find(object.id);
+		if (it == loadedObjects.end())
+		{
+			result.addedObjects.push_back(object.id);
+			continue;
+		}
+
+		OBJECT_CHANGE change;
+		change.id = object.id;
+		change.flags = CompareObjects(*it->second, object);
+		if (change.flags != 0)
+		{
+			result.changedObjects.push_back(change);
+		}
+
+		// whatever is left over afterwards was removed
+		loadedObjects.erase(it);
+	}
+
+	std::map<uint32_t, const SceneFile::OBJECT_DESC*>::iterator removed;
+	for (removed = loadedObjects.begin(); removed != loadedObjects.end(); removed++)
+	{
+		result.removedObjects.push_back(removed->first);
+	}
+
+	std::map<std::string, std::string> loadedTextures;
+	for (size_t i = 0; i < loaded.textures.size(); i++)
+	{
+		loadedTextures[loaded.textures[i].tag] = loaded.textures[i].path;
+	}
+	for (size_t i = 0; i < updated.textures.size(); i++)
+	{
+		std::map<std::string, std::string>::iterator it = loadedTextures.find(updated.textures[i].tag);
+		if ((it == loadedTextures.end()) || (it->second != updated.textures[i].path))
+		{
+			result.changedTextures.push_back(updated.textures[i]);
+		}
+	}
+
+	std::map<uint32_t, const SceneFile::TEXT_DESC*> loadedTexts;
+	for (size_t i = 0; i < loaded.texts.size(); i++)
+	{
+		loadedTexts[loaded.texts[i].id] = &loaded.texts[i];
+	}
+	for (size_t i = 0; i < updated.texts.size(); i++)
+	{
+		const SceneFile::TEXT_DESC& text = updated.texts[i];
+		std::map<uint32_t, const SceneFile::TEXT_DESC*>::iterator it = loadedTexts.find(text.id);
+		if (it == loadedTexts.end())
+		{
+			result.addedTexts.push_back(text.id);
+			continue;
+		}
+		if (TextLayoutChanged(*it->second, text))
+		{
+			result.changedTexts.push_back(text.id);
+		}
+		loadedTexts.erase(it);
+	}
+
+	std::map<uint32_t, const SceneFile::TEXT_DESC*>::iterator removedText;
+	for (removedText = loadedTexts.begin(); removedText != loadedTexts.end(); removedText++)
+	{
+		result.removedTexts.push_back(removedText->first);
+	}
+}
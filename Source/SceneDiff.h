@@ -0,0 +1,79 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenediff.h
+// ============
+// compare two scene descriptions by their stable object IDs
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneFile.h"
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  SceneDiff
+ *
+ *  This class finds what changed between the loaded scene and
+ *  an edited copy of it - objects added, removed or changed,
+ *  matched by their IDs rather than their order in the file,
+ *  textures that are new or point at another image, and text
+ *  blocks that need a new layout.
+ ***********************************************************/
+class SceneDiff
+{
+public:
+	// which properties of an object changed
+	enum CHANGE_FLAGS
+	{
+		CHANGE_TRANSFORM = 1 << 0,
+		CHANGE_MESH = 1 << 1,
+		// color and UV scale, kept in the object buffer
+		CHANGE_APPEARANCE = 1 << 2,
+		// texture or material tag, set when the object is drawn
+		CHANGE_TEXTURE = 1 << 3
+	};
+
+	struct OBJECT_CHANGE
+	{
+		uint32_t id;
+		uint32_t flags;
+	};
+
+	struct RESULT
+	{
+		std::vector<uint32_t> addedObjects;
+		std::vector<uint32_t> removedObjects;
+		std::vector<OBJECT_CHANGE> changedObjects;
+		// textures whose tag is new or whose file changed
+		std::vector<SceneFile::TEXTURE_DESC> changedTextures;
+		// text blocks by ID - only blocks whose layout changed
+		// count as changed, their transform and color are read
+		// from the mapped file when they are drawn
+		std::vector<uint32_t> addedTexts;
+		std::vector<uint32_t> removedTexts;
+		std::vector<uint32_t> changedTexts;
+
+		bool IsEmpty() const
+		{
+			return(addedObjects.empty() && removedObjects.empty() &&
+				changedObjects.empty() && changedTextures.empty() &&
+				addedTexts.empty() && removedTexts.empty() && changedTexts.empty());
+		}
+	};
+
+	// compare the loaded scene with its updated description
+	static void Compute(
+		const SceneFile::DESCRIPTION& loaded,
+		const SceneFile::DESCRIPTION& updated,
+		RESULT& result);
+
+	// compare the properties of two versions of an object
+	static uint32_t CompareObjects(
+		const SceneFile::OBJECT_DESC& loaded,
+		const SceneFile::OBJECT_DESC& updated);
+	// check whether a text block has to be laid out again
+	static bool TextLayoutChanged(
+		const SceneFile::TEXT_DESC& loaded,
+		const SceneFile::TEXT_DESC& updated);
+};
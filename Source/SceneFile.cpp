@@ -0,0 +1,928 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.cpp
+// ============
+// scene layout files - text authoring form and memory mapped binary form
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SceneFile.h"
+#include "MemoryTracker.h"
+#include "Profiler.h"
+
+#include <glm/gtx/transform.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	const char FILE_MAGIC[4] = { 'W', 'S', 'C', 'N' };
+	const uint32_t FILE_VERSION = 2;
+	// every array in the binary file starts on this boundary
+	const uint32_t ARRAY_ALIGNMENT = 16;
+
+	// names used for the meshes in the text form, by MESH_TYPE
+	const char* g_MeshNames[SceneFile::MESH_TYPE_COUNT] = {
+		"box",
+		"plane",
+		"cylinder",
+		"cone",
+		"prism",
+		"pyramid4",
+		"sphere",
+		"half_sphere",
+		"tapered_cylinder",
+		"torus",
+		"half_torus" };
+
+	// names used for the text alignments in the text form
+	const char* g_AlignmentNames[] = {
+		"left",
+		"center",
+		"right" };
+	const uint32_t ALIGNMENT_COUNT = sizeof(g_AlignmentNames) / sizeof(g_AlignmentNames[0]);
+
+	struct PART_NAME
+	{
+		const char* name;
+		uint32_t flag;
+	};
+	const PART_NAME g_PartNames[] = {
+		{ "top", SceneFile::PART_TOP },
+		{ "bottom", SceneFile::PART_BOTTOM },
+		{ "sides", SceneFile::PART_SIDES },
+		{ "left", SceneFile::PART_LEFT },
+		{ "right", SceneFile::PART_RIGHT },
+		{ "back", SceneFile::PART_BACK },
+		{ "front", SceneFile::PART_FRONT } };
+
+	/***********************************************************
+	 *  ParseMesh()
+	 *
+	 *  Parse a "mesh[:part+part]" token from the text form.
+	 ***********************************************************/
+	bool ParseMesh(const std::string& token, uint32_t& meshType, uint32_t& parts)
+	{
+		std::string meshName = token;
+		std::string partNames;
+		size_t separator = token.find(':');
+		if (separator != std::string::npos)
+		{
+			meshName = token.substr(0, separator);
+			partNames = token.substr(separator + 1);
+		}
+
+		meshType = SceneFile::MESH_TYPE_COUNT;
+		for (uint32_t i = 0; i < SceneFile::MESH_TYPE_COUNT; i++)
+		{
+			if (meshName == g_MeshNames[i])
+			{
+				meshType = i;
+			}
+		}
+		if (meshType == SceneFile::MESH_TYPE_COUNT)
+		{
+			return(false);
+		}
+
+		parts = SceneFile::PART_ALL;
+		std::stringstream partStream(partNames);
+		std::string partName;
+		while (std::getline(partStream, partName, '+'))
+		{
+			bool bFound = false;
+			for (size_t i = 0; i < sizeof(g_PartNames) / sizeof(g_PartNames[0]); i++)
+			{
+				if (partName == g_PartNames[i].name)
+				{
+					parts |= g_PartNames[i].flag;
+					bFound = true;
+				}
+			}
+			if (bFound == false)
+			{
+				return(false);
+			}
+		}
+
+		return(true);
+	}
+
+	/***********************************************************
+	 *  AlignOffset()
+	 *
+	 *  Round an offset up to the array alignment.
+	 ***********************************************************/
+	uint32_t AlignOffset(uint32_t offset)
+	{
+		return((offset + ARRAY_ALIGNMENT - 1) & ~(ARRAY_ALIGNMENT - 1));
+	}
+
+	/***********************************************************
+	 *  RangeIsValid()
+	 *
+	 *  Check that an array is aligned and inside the file.
+	 ***********************************************************/
+	bool RangeIsValid(const SceneFile::ARRAY_RANGE& range, size_t elementSize, size_t fileSize)
+	{
+		if (((range.offset % ARRAY_ALIGNMENT) != 0) || (range.offset > fileSize))
+		{
+			return(false);
+		}
+		return(range.count <= (fileSize - range.offset) / elementSize);
+	}
+}
+
+/***********************************************************
+ *  SceneFile()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SceneFile::SceneFile()
+{
+	m_pData = NULL;
+	m_pHeader = NULL;
+	m_mappedSize = 0;
+	m_fileHandle = NULL;
+	m_mappingHandle = NULL;
+}
+
+/***********************************************************
+ *  ~SceneFile()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SceneFile::~SceneFile()
+{
+	Close();
+}
+
+/***********************************************************
+ *  ComputeModelMatrix()
+ *
+ *  This method is used for building a model matrix from the
+ *  scale, rotation and position, in the same order as
+ *  SceneManager::SetTransformations().
+ ***********************************************************/
+glm::mat4 SceneFile::ComputeModelMatrix(
+	const glm::vec3& scale,
+	const glm::vec3& rotation,
+	const glm::vec3& position)
+{
+	glm::mat4 rotationX = glm::rotate(glm::radians(rotation.x), glm::vec3(1.0f, 0.0f, 0.0f));
+	glm::mat4 rotationY = glm::rotate(glm::radians(rotation.y), glm::vec3(0.0f, 1.0f, 0.0f));
+	glm::mat4 rotationZ = glm::rotate(glm::radians(rotation.z), glm::vec3(0.0f, 0.0f, 1.0f));
+
+	return(glm::translate(position) * rotationZ * rotationY * rotationX * glm::scale(scale));
+}
+
+/***********************************************************
+ *  ParseTextString()
+ *
+ *  This method is used for getting the text after the ':'
+ *  of a text line, with the surrounding blanks removed and
+ *  "\n" turned into line breaks.
+ ***********************************************************/
+std::string SceneFile::ParseTextString(const std::string& value)
+{
+	size_t first = value.find_first_not_of(" \t\r");
+	size_t last = value.find_last_not_of(" \t\r");
+	if (first == std::string::npos)
+	{
+		return("");
+	}
+
+	std::string text;
+	for (size_t i = first; i <= last; i++)
+	{
+		if ((value[i] == '\\') && (i < last) && (value[i + 1] == 'n'))
+		{
+			text.push_back('\n');
+			i++;
+		}
+		else
+		{
+			text.push_back(value[i]);
+		}
+	}
+	return(text);
+}
+
+/***********************************************************
+ *  ParseText()
+ *
+ *  This method is used for reading the text form of a scene.
+ *  Errors are reported with their line number.
+ ***********************************************************/
+bool SceneFile::ParseText(const char* textFilename, DESCRIPTION& description)
+{
+	PROFILE_SCOPE("SceneFile::ParseText");
+	std::ifstream textFile(textFilename);
+	if (!textFile.is_open())
+	{
+		std::cout << "Could not open scene file:" << textFilename << std::endl;
+		return(false);
+	}
+
+	description.textures.clear();
+	description.objects.clear();
+	description.texts.clear();
+
+	// object IDs have to stay unique, they identify objects
+	// when an edited scene is compared with the loaded one
+	std::set<uint32_t> objectIDs;
+	std::set<uint32_t> textIDs;
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(textFile, line))
+	{
+		lineNumber++;
+
+		// strip comments
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+		{
+			line.erase(comment);
+		}
+
+		std::istringstream tokens(line);
+		std::string keyword;
+		if (!(tokens >> keyword))
+		{
+			continue;
+		}
+
+		bool bValid = true;
+		if (keyword == "texture")
+		{
+			TEXTURE_DESC texture;
+			bValid = (bool)(tokens >> texture.tag >> texture.path);
+			description.textures.push_back(texture);
+		}
+		else if (keyword == "object")
+		{
+			OBJECT_DESC object;
+			std::string meshToken;
+			object.scale = glm::vec3(1.0f);
+			object.rotation = glm::vec3(0.0f);
+			object.position = glm::vec3(0.0f);
+			object.bUseTexture = false;
+			object.color = glm::vec4(1.0f);
+			object.uvScale = glm::vec2(1.0f, 1.0f);
+
+			bValid = (bool)(tokens >> object.id >> meshToken) &&
+				ParseMesh(meshToken, object.meshType, object.parts);
+			if (bValid && !objectIDs.insert(object.id).second)
+			{
+				std::cout << textFilename << "(" << lineNumber << "): object ID " << object.id << " is used twice" << std::endl;
+				bValid = false;
+			}
+
+			std::string property;
+			while (bValid && (tokens >> property))
+			{
+				if (property == "scale")
+				{
+					bValid = (bool)(tokens >> object.scale.x >> object.scale.y >> object.scale.z);
+				}
+				else if (property == "rotate")
+				{
+					bValid = (bool)(tokens >> object.rotation.x >> object.rotation.y >> object.rotation.z);
+				}
+				else if (property == "position")
+				{
+					bValid = (bool)(tokens >> object.position.x >> object.position.y >> object.position.z);
+				}
+				else if (property == "texture")
+				{
+					object.bUseTexture = true;
+					bValid = (bool)(tokens >> object.textureTag);
+				}
+				else if (property == "color")
+				{
+					bValid = (bool)(tokens >> object.color.r >> object.color.g >> object.color.b >> object.color.a);
+				}
+				else if (property == "uvscale")
+				{
+					bValid = (bool)(tokens >> object.uvScale.x >> object.uvScale.y);
+				}
+				else if (property == "material")
+				{
+					bValid = (bool)(tokens >> object.materialTag);
+				}
+				else
+				{
+					bValid = false;
+				}
+			}
+
+			// the materials are defined with the texture tags
+			if (object.materialTag.empty())
+			{
+				object.materialTag = object.bUseTexture ? object.textureTag : "default";
+			}
+			description.objects.push_back(object);
+		}
+		else if (keyword == "text")
+		{
+			TEXT_DESC text;
+			text.rotation = glm::vec3(0.0f);
+			text.position = glm::vec3(0.0f);
+			text.color = glm::vec4(0.0f, 0.0f, 0.0f, 1.0f);
+			text.size = 1.0f;
+			text.maxWidth = 0.0f;
+			text.lineSpacing = 1.0f;
+			text.alignment = 0;
+
+			// everything after the first ':' is the text itself
+			size_t separator = line.find(':');
+			bValid = (separator != std::string::npos);
+			std::istringstream properties(bValid ? line.substr(0, separator) : "");
+			properties >> keyword;
+			bValid = bValid && (properties >> text.id);
+			if (bValid && !textIDs.insert(text.id).second)
+			{
+				std::cout << textFilename << "(" << lineNumber << "): text ID " << text.id << " is used twice" << std::endl;
+				bValid = false;
+			}
+
+			std::string property;
+			while (bValid && (properties >> property))
+			{
+				if (property == "rotate")
+				{
+					bValid = (bool)(properties >> text.rotation.x >> text.rotation.y >> text.rotation.z);
+				}
+				else if (property == "position")
+				{
+					bValid = (bool)(properties >> text.position.x >> text.position.y >> text.position.z);
+				}
+				else if (property == "color")
+				{
+					bValid = (bool)(properties >> text.color.r >> text.color.g >> text.color.b >> text.color.a);
+				}
+				else if (property == "size")
+				{
+					bValid = (bool)(properties >> text.size) && (text.size > 0.0f);
+				}
+				else if (property == "width")
+				{
+					bValid = (bool)(properties >> text.maxWidth);
+				}
+				else if (property == "spacing")
+				{
+					bValid = (bool)(properties >> text.lineSpacing);
+				}
+				else if (property == "align")
+				{
+					std::string alignmentName;
+					bValid = (bool)(properties >> alignmentName);
+					text.alignment = ALIGNMENT_COUNT;
+					for (uint32_t i = 0; i < ALIGNMENT_COUNT; i++)
+					{
+						if (alignmentName == g_AlignmentNames[i])
+						{
+							text.alignment = i;
+						}
+					}
+					bValid = bValid && (text.alignment < ALIGNMENT_COUNT);
+				}
+				else
+				{
+					bValid = false;
+				}
+			}
+
+			if (bValid)
+			{
+				text.text = ParseTextString(line.substr(separator + 1));
+			}
+			description.texts.push_back(text);
+		}
+		else
+		{
+			bValid = false;
+		}
+
+		if (bValid == false)
+		{
+			std::cout << textFilename << "(" << lineNumber << "): invalid scene line: " << line << std::endl;
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  WriteBinary()
+ *
+ *  This method is used for laying the scene out into the
+ *  flat arrays of the binary form.  Meshes, materials and
+ *  strings shared by several objects are stored once.
+ ***********************************************************/
+bool SceneFile::WriteBinary(const DESCRIPTION& description, const char* binaryFilename)
+{
+	std::vector<OBJECT> objects;
+	std::vector<TRANSFORM> transforms;
+	std::vector<MESH_REF> meshes;
+	std::vector<MATERIAL_REF> materials;
+	std::vector<TEXTURE_REF> textures;
+	std::vector<TEXT_REF> texts;
+	std::vector<char> strings;
+
+	std::map<std::string, uint32_t> stringOffsets;
+	std::map<std::string, int32_t> textureIndices;
+	std::map<uint64_t, uint32_t> meshIndices;
+	// materials are found again by their bytes, so large
+	// scenes do not search every material for each object
+	std::map<std::string, uint32_t> materialIndices;
+
+	// adds a string once and returns its offset
+	auto addString = [&](const std::string& value) -> uint32_t
+	{
+		std::map<std::string, uint32_t>::iterator it = stringOffsets.find(value);
+		if (it != stringOffsets.end())
+		{
+			return(it->second);
+		}
+		uint32_t offset = (uint32_t)strings.size();
+		strings.insert(strings.end(), value.begin(), value.end());
+		strings.push_back('\0');
+		stringOffsets[value] = offset;
+		return(offset);
+	};
+
+	for (size_t i = 0; i < description.textures.size(); i++)
+	{
+		TEXTURE_REF texture;
+		texture.tagOffset = addString(description.textures[i].tag);
+		texture.pathOffset = addString(description.textures[i].path);
+		textureIndices[description.textures[i].tag] = (int32_t)textures.size();
+		textures.push_back(texture);
+	}
+
+	for (size_t i = 0; i < description.objects.size(); i++)
+	{
+		const OBJECT_DESC& desc = description.objects[i];
+		OBJECT object;
+		object.id = desc.id;
+
+		TRANSFORM transform;
+		glm::mat4 model = ComputeModelMatrix(desc.scale, desc.rotation, desc.position);
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				transform.model[column * 4 + row] = model[column][row];
+			}
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			transform.scale[axis] = desc.scale[axis];
+			transform.rotation[axis] = desc.rotation[axis];
+			transform.position[axis] = desc.position[axis];
+			transform.padding[axis] = 0.0f;
+		}
+		object.transformIndex = (uint32_t)transforms.size();
+		transforms.push_back(transform);
+
+		uint64_t meshKey = ((uint64_t)desc.meshType << 32) | desc.parts;
+		std::map<uint64_t, uint32_t>::iterator meshIt = meshIndices.find(meshKey);
+		if (meshIt == meshIndices.end())
+		{
+			MESH_REF mesh;
+			mesh.meshType = desc.meshType;
+			mesh.parts = desc.parts;
+			meshIt = meshIndices.insert(std::make_pair(meshKey, (uint32_t)meshes.size())).first;
+			meshes.push_back(mesh);
+		}
+		object.meshIndex = meshIt->second;
+
+		MATERIAL_REF material;
+		for (int c = 0; c < 4; c++)
+		{
+			material.color[c] = desc.color[c];
+		}
+		material.uvScale[0] = desc.uvScale.x;
+		material.uvScale[1] = desc.uvScale.y;
+		material.textureIndex = -1;
+		if (desc.bUseTexture)
+		{
+			std::map<std::string, int32_t>::iterator textureIt = textureIndices.find(desc.textureTag);
+			if (textureIt == textureIndices.end())
+			{
+				std::cout << "Scene object " << desc.id << " uses the undeclared texture " << desc.textureTag << std::endl;
+				return(false);
+			}
+			material.textureIndex = textureIt->second;
+		}
+		material.materialTagOffset = addString(desc.materialTag);
+
+		// most objects share a handful of materials
+		std::string materialKey((const char*)&material, sizeof(MATERIAL_REF));
+		std::map<std::string, uint32_t>::iterator materialIt = materialIndices.find(materialKey);
+		if (materialIt == materialIndices.end())
+		{
+			materialIt = materialIndices.insert(std::make_pair(materialKey, (uint32_t)materials.size())).first;
+			materials.push_back(material);
+		}
+		object.materialIndex = materialIt->second;
+
+		objects.push_back(object);
+	}
+
+	// text blocks keep their transform with the objects ones
+	for (size_t i = 0; i < description.texts.size(); i++)
+	{
+		const TEXT_DESC& desc = description.texts[i];
+		TEXT_REF text;
+		memset(&text, 0, sizeof(text));
+		text.id = desc.id;
+
+		TRANSFORM transform;
+		glm::mat4 model = ComputeModelMatrix(glm::vec3(1.0f), desc.rotation, desc.position);
+		for (int column = 0; column < 4; column++)
+		{
+			for (int row = 0; row < 4; row++)
+			{
+				transform.model[column * 4 + row] = model[column][row];
+			}
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			transform.scale[axis] = 1.0f;
+			transform.rotation[axis] = desc.rotation[axis];
+			transform.position[axis] = desc.position[axis];
+			transform.padding[axis] = 0.0f;
+		}
+		text.transformIndex = (uint32_t)transforms.size();
+		transforms.push_back(transform);
+
+		text.stringOffset = addString(desc.text);
+		text.alignment = desc.alignment;
+		for (int c = 0; c < 4; c++)
+		{
+			text.color[c] = desc.color[c];
+		}
+		text.size = desc.size;
+		text.maxWidth = desc.maxWidth;
+		text.lineSpacing = desc.lineSpacing;
+		texts.push_back(text);
+	}
+
+	// lay the arrays out one after another on aligned offsets
+	FILE_HEADER header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, FILE_MAGIC, sizeof(FILE_MAGIC));
+	header.version = FILE_VERSION;
+
+	uint32_t offset = AlignOffset(sizeof(FILE_HEADER));
+	header.objects.offset = offset;
+	header.objects.count = (uint32_t)objects.size();
+	offset = AlignOffset(offset + (uint32_t)(objects.size() * sizeof(OBJECT)));
+	header.transforms.offset = offset;
+	header.transforms.count = (uint32_t)transforms.size();
+	offset = AlignOffset(offset + (uint32_t)(transforms.size() * sizeof(TRANSFORM)));
+	header.meshes.offset = offset;
+	header.meshes.count = (uint32_t)meshes.size();
+	offset = AlignOffset(offset + (uint32_t)(meshes.size() * sizeof(MESH_REF)));
+	header.materials.offset = offset;
+	header.materials.count = (uint32_t)materials.size();
+	offset = AlignOffset(offset + (uint32_t)(materials.size() * sizeof(MATERIAL_REF)));
+	header.textures.offset = offset;
+	header.textures.count = (uint32_t)textures.size();
+	offset = AlignOffset(offset + (uint32_t)(textures.size() * sizeof(TEXTURE_REF)));
+	header.texts.offset = offset;
+	header.texts.count = (uint32_t)texts.size();
+	offset = AlignOffset(offset + (uint32_t)(texts.size() * sizeof(TEXT_REF)));
+	header.strings.offset = offset;
+	header.strings.count = (uint32_t)strings.size();
+	header.fileSize = AlignOffset(offset + (uint32_t)strings.size());
+
+	std::vector<unsigned char> fileData(header.fileSize, 0);
+	memcpy(&fileData[0], &header, sizeof(header));
+	if (!objects.empty()) memcpy(&fileData[header.objects.offset], objects.data(), objects.size() * sizeof(OBJECT));
+	if (!transforms.empty()) memcpy(&fileData[header.transforms.offset], transforms.data(), transforms.size() * sizeof(TRANSFORM));
+	if (!meshes.empty()) memcpy(&fileData[header.meshes.offset], meshes.data(), meshes.size() * sizeof(MESH_REF));
+	if (!materials.empty()) memcpy(&fileData[header.materials.offset], materials.data(), materials.size() * sizeof(MATERIAL_REF));
+	if (!textures.empty()) memcpy(&fileData[header.textures.offset], textures.data(), textures.size() * sizeof(TEXTURE_REF));
+	if (!texts.empty()) memcpy(&fileData[header.texts.offset], texts.data(), texts.size() * sizeof(TEXT_REF));
+	if (!strings.empty()) memcpy(&fileData[header.strings.offset], strings.data(), strings.size());
+
+	std::ofstream binaryFile(binaryFilename, std::ios::binary | std::ios::trunc);
+	if (!binaryFile.is_open())
+	{
+		std::cout << "Could not write scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+	binaryFile.write((const char*)fileData.data(), fileData.size());
+
+	return(binaryFile.good());
+}
+
+/***********************************************************
+ *  Compile()
+ *
+ *  This method is used for converting the text form of a
+ *  scene into the binary form.
+ ***********************************************************/
+bool SceneFile::Compile(const char* textFilename, const char* binaryFilename)
+{
+	DESCRIPTION description;
+	if (!ParseText(textFilename, description))
+	{
+		return(false);
+	}
+	if (!WriteBinary(description, binaryFilename))
+	{
+		return(false);
+	}
+
+	std::cout << "Compiled scene " << textFilename << " into " << binaryFilename
+		<< " (" << description.objects.size() << " objects, "
+		<< description.texts.size() << " texts)" << std::endl;
+	return(true);
+}
+
+/***********************************************************
+ *  Open()
+ *
+ *  This method is used for mapping a binary scene file into
+ *  memory.  The arrays are used in place afterwards, so the
+ *  file is validated completely before it is accepted.
+ ***********************************************************/
+bool SceneFile::Open(const char* binaryFilename)
+{
+	PROFILE_SCOPE("SceneFile::Open");
+	Close();
+
+#ifdef _WIN32
+	HANDLE fileHandle = CreateFileA(binaryFilename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		std::cout << "Could not open scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+	LARGE_INTEGER fileSize;
+	GetFileSizeEx(fileHandle, &fileSize);
+	HANDLE mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	if (NULL == mappingHandle)
+	{
+		CloseHandle(fileHandle);
+		std::cout << "Could not map scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+	m_pData = (const unsigned char*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	m_mappedSize = (size_t)fileSize.QuadPart;
+	m_fileHandle = fileHandle;
+	m_mappingHandle = mappingHandle;
+#else
+	int fileDescriptor = open(binaryFilename, O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		std::cout << "Could not open scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+	struct stat fileStatus;
+	fstat(fileDescriptor, &fileStatus);
+	m_mappedSize = (size_t)fileStatus.st_size;
+	void* mapping = (m_mappedSize > 0) ? mmap(NULL, m_mappedSize, PROT_READ, MAP_PRIVATE, fileDescriptor, 0) : MAP_FAILED;
+	// the mapping stays valid after the descriptor is closed
+	close(fileDescriptor);
+	m_pData = (mapping == MAP_FAILED) ? NULL : (const unsigned char*)mapping;
+#endif
+
+	if (NULL == m_pData)
+	{
+		Close();
+		std::cout << "Could not map scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+
+	m_pHeader = (const FILE_HEADER*)m_pData;
+	if (!Validate())
+	{
+		Close();
+		std::cout << "Invalid scene file:" << binaryFilename << std::endl;
+		return(false);
+	}
+
+	MemoryTracker::Allocate(MemoryTracker::CATEGORY_SCENE_FILE, (uint64_t)(uintptr_t)m_pData, m_mappedSize, binaryFilename);
+	return(true);
+}
+
+/***********************************************************
+ *  Validate()
+ *
+ *  This method is used for checking the mapped file before
+ *  anything reads from it - the header, the array ranges,
+ *  the string offsets and all cross references, and that the
+ *  object and text IDs are unique, since the reloads match
+ *  the objects by them.
+ ***********************************************************/
+bool SceneFile::Validate() const
+{
+	if ((m_mappedSize < sizeof(FILE_HEADER)) ||
+		(memcmp(m_pHeader->magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0) ||
+		(m_pHeader->version != FILE_VERSION) ||
+		(m_pHeader->fileSize != m_mappedSize))
+	{
+		return(false);
+	}
+
+	if (!RangeIsValid(m_pHeader->objects, sizeof(OBJECT), m_mappedSize) ||
+		!RangeIsValid(m_pHeader->transforms, sizeof(TRANSFORM), m_mappedSize) ||
+		!RangeIsValid(m_pHeader->meshes, sizeof(MESH_REF), m_mappedSize) ||
+		!RangeIsValid(m_pHeader->materials, sizeof(MATERIAL_REF), m_mappedSize) ||
+		!RangeIsValid(m_pHeader->textures, sizeof(TEXTURE_REF), m_mappedSize) ||
+		!RangeIsValid(m_pHeader->texts, sizeof(TEXT_REF), m_mappedSize) ||
+		!RangeIsValid(m_pHeader->strings, 1, m_mappedSize))
+	{
+		return(false);
+	}
+
+	// every string must be terminated inside the string array
+	uint32_t stringsSize = m_pHeader->strings.count;
+	if ((stringsSize > 0) && (GetString(0)[stringsSize - 1] != '\0'))
+	{
+		return(false);
+	}
+
+	const TEXTURE_REF* textures = GetTextures();
+	for (uint32_t i = 0; i < m_pHeader->textures.count; i++)
+	{
+		if ((textures[i].tagOffset >= stringsSize) || (textures[i].pathOffset >= stringsSize))
+		{
+			return(false);
+		}
+	}
+
+	const MATERIAL_REF* materials = GetMaterials();
+	for (uint32_t i = 0; i < m_pHeader->materials.count; i++)
+	{
+		if ((materials[i].textureIndex < -1) ||
+			(materials[i].textureIndex >= (int32_t)m_pHeader->textures.count) ||
+			(materials[i].materialTagOffset >= stringsSize))
+		{
+			return(false);
+		}
+	}
+
+	const MESH_REF* meshes = GetMeshes();
+	for (uint32_t i = 0; i < m_pHeader->meshes.count; i++)
+	{
+		if (meshes[i].meshType >= MESH_TYPE_COUNT)
+		{
+			return(false);
+		}
+	}
+
+	const OBJECT* objects = GetObjects();
+	std::set<uint32_t> objectIDs;
+	for (uint32_t i = 0; i < m_pHeader->objects.count; i++)
+	{
+		if ((objects[i].transformIndex >= m_pHeader->transforms.count) ||
+			(objects[i].meshIndex >= m_pHeader->meshes.count) ||
+			(objects[i].materialIndex >= m_pHeader->materials.count) ||
+			!objectIDs.insert(objects[i].id).second)
+		{
+			return(false);
+		}
+	}
+
+	const TEXT_REF* texts = GetTexts();
+	std::set<uint32_t> textIDs;
+	for (uint32_t i = 0; i < m_pHeader->texts.count; i++)
+	{
+		if ((texts[i].transformIndex >= m_pHeader->transforms.count) ||
+			(texts[i].stringOffset >= stringsSize) ||
+			(texts[i].alignment >= ALIGNMENT_COUNT) ||
+			!textIDs.insert(texts[i].id).second)
+		{
+			return(false);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Close()
+ *
+ *  This method is used for unmapping the binary scene file.
+ ***********************************************************/
+void SceneFile::Close()
+{
+	if (NULL != m_pData)
+	{
+		MemoryTracker::Free(MemoryTracker::CATEGORY_SCENE_FILE, (uint64_t)(uintptr_t)m_pData);
+	}
+
+#ifdef _WIN32
+	if (NULL != m_pData)
+	{
+		UnmapViewOfFile(m_pData);
+	}
+	if (NULL != m_mappingHandle)
+	{
+		CloseHandle((HANDLE)m_mappingHandle);
+	}
+	if (NULL != m_fileHandle)
+	{
+		CloseHandle((HANDLE)m_fileHandle);
+	}
+#else
+	if (NULL != m_pData)
+	{
+		munmap((void*)m_pData, m_mappedSize);
+	}
+#endif
+
+	m_pData = NULL;
+	m_pHeader = NULL;
+	m_mappedSize = 0;
+	m_fileHandle = NULL;
+	m_mappingHandle = NULL;
+}
+
+/***********************************************************
+ *  GetDescription()
+ *
+ *  This method is used for reading the mapped scene back into
+ *  the editable form, for tools that modify or compare it.
+ ***********************************************************/
+void SceneFile::GetDescription(DESCRIPTION& description) const
+{
+	description.textures.clear();
+	description.objects.clear();
+	description.texts.clear();
+	if (!IsOpen())
+	{
+		return;
+	}
+
+	const TEXTURE_REF* textures = GetTextures();
+	for (uint32_t i = 0; i < GetTextureCount(); i++)
+	{
+		TEXTURE_DESC texture;
+		texture.tag = GetString(textures[i].tagOffset);
+		texture.path = GetString(textures[i].pathOffset);
+		description.textures.push_back(texture);
+	}
+
+	const OBJECT* objects = GetObjects();
+	description.objects.resize(GetObjectCount());
+	for (uint32_t i = 0; i < GetObjectCount(); i++)
+	{
+		const TRANSFORM& transform = GetTransforms()[objects[i].transformIndex];
+		const MESH_REF& mesh = GetMeshes()[objects[i].meshIndex];
+		const MATERIAL_REF& material = GetMaterials()[objects[i].materialIndex];
+		OBJECT_DESC& object = description.objects[i];
+
+		object.id = objects[i].id;
+		object.meshType = mesh.meshType;
+		object.parts = mesh.parts;
+		object.scale = glm::vec3(transform.scale[0], transform.scale[1], transform.scale[2]);
+		object.rotation = glm::vec3(transform.rotation[0], transform.rotation[1], transform.rotation[2]);
+		object.position = glm::vec3(transform.position[0], transform.position[1], transform.position[2]);
+		object.bUseTexture = (material.textureIndex >= 0);
+		object.textureTag = object.bUseTexture ? GetString(textures[material.textureIndex].tagOffset) : "";
+		object.color = glm::vec4(material.color[0], material.color[1], material.color[2], material.color[3]);
+		object.uvScale = glm::vec2(material.uvScale[0], material.uvScale[1]);
+		object.materialTag = GetString(material.materialTagOffset);
+	}
+
+	const TEXT_REF* texts = GetTexts();
+	description.texts.resize(GetTextCount());
+	for (uint32_t i = 0; i < GetTextCount(); i++)
+	{
+		const TRANSFORM& transform = GetTransforms()[texts[i].transformIndex];
+		TEXT_DESC& text = description.texts[i];
+
+		text.id = texts[i].id;
+		text.rotation = glm::vec3(transform.rotation[0], transform.rotation[1], transform.rotation[2]);
+		text.position = glm::vec3(transform.position[0], transform.position[1], transform.position[2]);
+		text.color = glm::vec4(texts[i].color[0], texts[i].color[1], texts[i].color[2], texts[i].color[3]);
+		text.size = texts[i].size;
+		text.maxWidth = texts[i].maxWidth;
+		text.lineSpacing = texts[i].lineSpacing;
+		text.alignment = texts[i].alignment;
+		text.text = GetString(texts[i].stringOffset);
+	}
+}
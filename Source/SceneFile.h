@@ -0,0 +1,234 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenefile.h
+// ============
+// scene layout files - text authoring form and memory mapped binary form
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SceneFile
+ *
+ *  This class describes the objects of a 3D scene outside of
+ *  the code.  Scenes are written in a line based text form
+ *  (see scenes/wedding_table.scene) and compiled into a
+ *  binary form made of flat, 16 byte aligned arrays.  The
+ *  binary form is memory mapped and used in place - opening
+ *  it only validates the header, offsets and indices.
+ ***********************************************************/
+class SceneFile
+{
+public:
+	// constructor
+	SceneFile();
+	// destructor
+	~SceneFile();
+
+	// basic shape meshes an object can reference
+	enum MESH_TYPE
+	{
+		MESH_BOX = 0,
+		MESH_PLANE,
+		MESH_CYLINDER,
+		MESH_CONE,
+		MESH_PRISM,
+		MESH_PYRAMID4,
+		MESH_SPHERE,
+		MESH_HALF_SPHERE,
+		MESH_TAPERED_CYLINDER,
+		MESH_TORUS,
+		MESH_HALF_TORUS,
+		MESH_TYPE_COUNT
+	};
+
+	// parts of a mesh to draw - no flags draws the whole mesh
+	enum MESH_PART
+	{
+		PART_ALL = 0,
+		PART_TOP = 1 << 0,
+		PART_BOTTOM = 1 << 1,
+		PART_SIDES = 1 << 2,
+		PART_LEFT = 1 << 3,
+		PART_RIGHT = 1 << 4,
+		PART_BACK = 1 << 5,
+		PART_FRONT = 1 << 6
+	};
+
+	// location of one array inside the binary file
+	struct ARRAY_RANGE
+	{
+		uint32_t offset;
+		uint32_t count;
+	};
+
+	// binary file header - all arrays start on 16 byte boundaries
+	struct FILE_HEADER
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t fileSize;
+		uint32_t reserved;
+		ARRAY_RANGE objects;
+		ARRAY_RANGE transforms;
+		ARRAY_RANGE meshes;
+		ARRAY_RANGE materials;
+		ARRAY_RANGE textures;
+		ARRAY_RANGE texts;
+		ARRAY_RANGE strings;
+	};
+
+	// one drawn object, referencing the other arrays by index
+	struct OBJECT
+	{
+		uint32_t id;
+		uint32_t transformIndex;
+		uint32_t meshIndex;
+		uint32_t materialIndex;
+	};
+
+	// the model matrix is precomputed, the source values are
+	// kept for editing and for diffing scenes
+	struct TRANSFORM
+	{
+		float model[16];
+		float scale[3];
+		float rotation[3];
+		float position[3];
+		float padding[3];
+	};
+
+	struct MESH_REF
+	{
+		uint32_t meshType;
+		uint32_t parts;
+	};
+
+	// textureIndex is -1 for objects drawn with a plain color
+	struct MATERIAL_REF
+	{
+		float color[4];
+		float uvScale[2];
+		int32_t textureIndex;
+		uint32_t materialTagOffset;
+	};
+
+	// offsets into the string array
+	struct TEXTURE_REF
+	{
+		uint32_t tagOffset;
+		uint32_t pathOffset;
+	};
+
+	// a block of text, laid out when the scene is loaded - the
+	// alignment is a TextRenderer::TEXT_ALIGNMENT value
+	struct TEXT_REF
+	{
+		uint32_t id;
+		uint32_t transformIndex;
+		uint32_t stringOffset;
+		uint32_t alignment;
+		float color[4];
+		float size;
+		float maxWidth;
+		float lineSpacing;
+		float padding;
+	};
+
+	// editable form of an object, as read from the text file
+	struct OBJECT_DESC
+	{
+		uint32_t id;
+		uint32_t meshType;
+		uint32_t parts;
+		glm::vec3 scale;
+		glm::vec3 rotation;
+		glm::vec3 position;
+		bool bUseTexture;
+		std::string textureTag;
+		glm::vec4 color;
+		glm::vec2 uvScale;
+		std::string materialTag;
+	};
+
+	struct TEXTURE_DESC
+	{
+		std::string tag;
+		std::string path;
+	};
+
+	// editable form of a text block, the text may hold '\n'
+	struct TEXT_DESC
+	{
+		uint32_t id;
+		glm::vec3 rotation;
+		glm::vec3 position;
+		glm::vec4 color;
+		float size;
+		float maxWidth;
+		float lineSpacing;
+		uint32_t alignment;
+		std::string text;
+	};
+
+	// editable form of a whole scene
+	struct DESCRIPTION
+	{
+		std::vector<TEXTURE_DESC> textures;
+		std::vector<OBJECT_DESC> objects;
+		std::vector<TEXT_DESC> texts;
+	};
+
+	// parse the text form of a scene
+	static bool ParseText(const char* textFilename, DESCRIPTION& description);
+	// get the text of a text line, with "\n" as line breaks
+	static std::string ParseTextString(const std::string& value);
+	// write a scene description in the binary form
+	static bool WriteBinary(const DESCRIPTION& description, const char* binaryFilename);
+	// convert a text scene file into a binary scene file
+	static bool Compile(const char* textFilename, const char* binaryFilename);
+	// compute the model matrix the same way as SceneManager
+	static glm::mat4 ComputeModelMatrix(
+		const glm::vec3& scale,
+		const glm::vec3& rotation,
+		const glm::vec3& position);
+
+	// map a binary scene file into memory and validate it
+	bool Open(const char* binaryFilename);
+	// unmap the binary scene file
+	void Close();
+	bool IsOpen() const { return(NULL != m_pHeader); }
+
+	// read back the mapped scene as an editable description
+	void GetDescription(DESCRIPTION& description) const;
+
+	// direct access to the mapped arrays
+	uint32_t GetObjectCount() const { return(m_pHeader->objects.count); }
+	uint32_t GetTextureCount() const { return(m_pHeader->textures.count); }
+	uint32_t GetTextCount() const { return(m_pHeader->texts.count); }
+	const OBJECT* GetObjects() const { return((const OBJECT*)(m_pData + m_pHeader->objects.offset)); }
+	const TRANSFORM* GetTransforms() const { return((const TRANSFORM*)(m_pData + m_pHeader->transforms.offset)); }
+	const MESH_REF* GetMeshes() const { return((const MESH_REF*)(m_pData + m_pHeader->meshes.offset)); }
+	const MATERIAL_REF* GetMaterials() const { return((const MATERIAL_REF*)(m_pData + m_pHeader->materials.offset)); }
+	const TEXTURE_REF* GetTextures() const { return((const TEXTURE_REF*)(m_pData + m_pHeader->textures.offset)); }
+	const TEXT_REF* GetTexts() const { return((const TEXT_REF*)(m_pData + m_pHeader->texts.offset)); }
+	const char* GetString(uint32_t offset) const { return((const char*)(m_pData + m_pHeader->strings.offset + offset)); }
+
+private:
+	// start of the mapped file
+	const unsigned char* m_pData;
+	const FILE_HEADER* m_pHeader;
+	size_t m_mappedSize;
+	// operating system handles for the mapping
+	void* m_fileHandle;
+	void* m_mappingHandle;
+
+	// check that every offset and index stays inside the file
+	bool Validate() const;
+};
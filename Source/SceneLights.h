@@ -0,0 +1,59 @@
+///////////////////////////////////////////////////////////////////////////////
+// scenelights.h
+// ============
+// light sources of a 3D scene, laid out like the fragment shader uniforms
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+// number of point lights in fragmentShader.glsl
+const int TOTAL_POINT_LIGHTS = 5;
+
+struct DIRECTIONAL_LIGHT
+{
+	glm::vec3 direction;
+	glm::vec3 ambient;
+	glm::vec3 diffuse;
+	glm::vec3 specular;
+	bool bActive;
+};
+
+struct POINT_LIGHT
+{
+	glm::vec3 position;
+	glm::vec3 ambient;
+	glm::vec3 diffuse;
+	glm::vec3 specular;
+	bool bActive;
+};
+
+struct SPOT_LIGHT
+{
+	glm::vec3 position;
+	glm::vec3 direction;
+	float cutOff;
+	float outerCutOff;
+	float constant;
+	float linear;
+	float quadratic;
+	glm::vec3 ambient;
+	glm::vec3 diffuse;
+	glm::vec3 specular;
+	bool bActive;
+};
+
+/***********************************************************
+ *  SCENE_LIGHTS
+ *
+ *  All of the light sources of a scene.  SceneManager sets
+ *  them into the shader, and the CPU renderers shade with
+ *  the same values.
+ ***********************************************************/
+struct SCENE_LIGHTS
+{
+	DIRECTIONAL_LIGHT directionalLight;
+	POINT_LIGHT pointLights[TOTAL_POINT_LIGHTS];
+	SPOT_LIGHT spotLight;
+};
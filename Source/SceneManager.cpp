@@ -8,6 +8,9 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "SceneManager.h"
+#include "FrameArena.h"
+#include "Profiler.h"
+#include "StartupTimeline.h"
 
 #ifndef STB_IMAGE_IMPLEMENTATION
 #define STB_IMAGE_IMPLEMENTATION
@@ -15,6 +18,12 @@
 #endif
 
 #include <glm/gtx/transform.hpp>
+#include <glm/gtc/type_ptr.hpp>
+
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <iostream>
 
 // declaration of global variables
 namespace
@@ -24,6 +33,41 @@ namespace
 	const char* g_TextureValueName = "objectTexture";
 	const char* g_UseTextureName = "bUseTexture";
 	const char* g_UseLightingName = "bUseLighting";
+	const char* g_UsePBRName = "bUsePBR";
+	const char* g_BrdfLutName = "brdfLUT";
+
+	const char* g_UseEnvironmentMapName = "bUseEnvironmentMap";
+	const char* g_IrradianceMapName = "irradianceMap";
+	const char* g_PrefilterMapName = "prefilterMap";
+	const char* g_PrefilterMipLevelsName = "prefilterMipLevels";
+
+	const char* g_UseObjectBlockName = "bUseObjectBlock";
+	const char* g_ObjectBlockName = "ObjectBlock";
+	// uniform buffer binding point of the scene file objects
+	const uint32_t OBJECT_BLOCK_BINDING = 1;
+
+	const char* g_UseTextSDFName = "bUseTextSDF";
+	// fonts tried in order for the itinerary and place card text
+	const char* g_FontFiles[] = {
+		"fonts/itinerary.ttf",
+		"C:/Windows/Fonts/georgia.ttf",
+		"C:/Windows/Fonts/times.ttf",
+		"C:/Windows/Fonts/arial.ttf",
+		"/usr/share/fonts/truetype/dejavu/DejaVuSerif.ttf" };
+	// glyph atlas cache, rebuilt when missing or made from another font
+	const char* g_GlyphAtlasCacheFile = "textures/glyph_atlas.bin";
+
+	// the last texture slots are reserved for the glyph atlas
+	// and the PBR lookups
+	const int TEXT_ATLAS_TEXTURE_SLOT = 12;
+	const int IRRADIANCE_MAP_TEXTURE_SLOT = 13;
+	const int PREFILTER_MAP_TEXTURE_SLOT = 14;
+	const int BRDF_LUT_TEXTURE_SLOT = 15;
+	// BRDF lookup table cache, rebuilt when missing
+	const char* g_BrdfLutCacheFile = "textures/brdf_lut.bin";
+	// optional environment panorama and its prefiltered cache
+	const char* g_EnvironmentFile = "textures/environment.hdr";
+	const char* g_EnvironmentCacheFile = "textures/environment.bin";
 }
 
 /***********************************************************
@@ -31,10 +75,33 @@ namespace
  *
  *  The constructor for the class
  ***********************************************************/
-SceneManager::SceneManager(ShaderManager* pShaderManager)
+SceneManager::SceneManager(RenderDevice* pDevice) :
+	m_resourceCache(pDevice)
 {
-	m_pShaderManager = pShaderManager;
-	m_basicMeshes = new ShapeMeshes();
+	m_pDevice = pDevice;
+	m_scenePipeline = 0;
+	m_textPipeline = 0;
+	if (NULL != m_pDevice)
+	{
+		// the object block of the shader is tied to its binding
+		// point once, every resident scene binds its own buffer there
+		RenderDevice::PIPELINE_DESC desc = RenderDevice::GetPipelineDesc();
+		desc.uniformBlockName = g_ObjectBlockName;
+		desc.uniformBlockBinding = OBJECT_BLOCK_BINDING;
+		m_scenePipeline = m_pDevice->CreatePipeline(desc);
+
+		// pipeline of the text, see BeginTextDrawing()
+		desc = RenderDevice::GetPipelineDesc();
+		desc.bDepthWrite = false;
+		desc.bPolygonOffset = true;
+		m_textPipeline = m_pDevice->CreatePipeline(desc);
+	}
+	m_loadedTextures = 0;
+	m_bUsePBR = false;
+	m_bTimeObjectGroups = false;
+	m_pStatistics = NULL;
+	m_pPerformanceHud = NULL;
+	m_pActiveScene = NULL;
 }
 
 /***********************************************************
@@ -44,98 +111,87 @@ SceneManager::SceneManager(ShaderManager* pShaderManager)
  ***********************************************************/
 SceneManager::~SceneManager()
 {
-	m_pShaderManager = NULL;
-	delete m_basicMeshes;
-	m_basicMeshes = NULL;
+	m_brdfLut.DestroyTexture();
+	m_environmentMap.DestroyTextures();
+	for (size_t i = 0; i < m_itineraryTexts.size(); i++)
+	{
+		m_textRenderer.DestroyBlock(m_itineraryTexts[i].block);
+	}
+	m_itineraryTexts.clear();
+
+	// the workers only write into their own preload data
+	for (size_t i = 0; i < m_pendingScenes.size(); i++)
+	{
+		m_pendingScenes[i].result.wait();
+		ResidentScene::FreePreloadData(*m_pendingScenes[i].pData);
+	}
+	m_pendingScenes.clear();
+
+	m_pActiveScene = NULL;
+	for (size_t i = 0; i < m_scenes.size(); i++)
+	{
+		delete m_scenes[i];
+	}
+	m_scenes.clear();
+	m_textRenderer.Destroy();
+
+	if (NULL != m_pDevice)
+	{
+		m_pDevice->DestroyPipeline(m_scenePipeline);
+		m_pDevice->DestroyPipeline(m_textPipeline);
+	}
+	m_pDevice = NULL;
 }
 
 /***********************************************************
  *  CreateGLTexture()
  *
- *  This method is used for loading textures from image files,
- *  configuring the texture mapping parameters in OpenGL,
- *  generating the mipmaps, and loading the read texture into
+ *  This method is used for loading textures from image files
+ *  through the resource cache, and loading the texture into
  *  the next available texture slot in memory.
  ***********************************************************/
 bool SceneManager::CreateGLTexture(const char* filename, std::string tag)
 {
-	int width = 0;
-	int height = 0;
-	int colorChannels = 0;
-	GLuint textureID = 0;
-
-	// indicate to always flip images vertically when loaded
-	stbi_set_flip_vertically_on_load(true);
-
-	// try to parse the image data from the specified image file
-	unsigned char* image = stbi_load(
-		filename,
-		&width,
-		&height,
-		&colorChannels,
-		0);
-
-	// if the image was successfully read from the image file
-	if (image)
-	{
-		std::cout << "Successfully loaded image:" << filename << ", width:" << width << ", height:" << height << ", channels:" << colorChannels << std::endl;
-
-		glGenTextures(1, &textureID);
-		glBindTexture(GL_TEXTURE_2D, textureID);
-
-		// set the texture wrapping parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-		// set texture filtering parameters
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-		// if the loaded image is in RGB format
-		if (colorChannels == 3)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB8, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, image);
-		// if the loaded image is in RGBA format - it supports transparency
-		else if (colorChannels == 4)
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image);
-		else
-		{
-			std::cout << "Not implemented to handle image with " << colorChannels << " channels" << std::endl;
-			return false;
-		}
-
-		// generate the texture mipmaps for mapping textures to lower resolutions
-		glGenerateMipmap(GL_TEXTURE_2D);
-
-		// free the image data from local memory
-		stbi_image_free(image);
-		glBindTexture(GL_TEXTURE_2D, 0); // Unbind the texture
-
-		// register the loaded texture and associate it with the special tag string
-		m_textureIDs[m_loadedTextures].ID = textureID;
-		m_textureIDs[m_loadedTextures].tag = tag;
-		m_loadedTextures++;
+	// the image is only read and uploaded if no scene has it yet
+	RENDER_TEXTURE textureID = m_resourceCache.AcquireTexture(filename);
+	if (textureID == 0)
+	{
+		// Error loading the image
+		return false;
+	}
 
+	// a texture loaded again for the same tag replaces the old
+	// one in its slot, so the slot numbers stay the same
+	int textureSlot = FindTextureSlot(tag.c_str());
+	if (textureSlot >= 0)
+	{
+		m_resourceCache.ReleaseTexture(m_textureIDs[textureSlot].filename);
+		m_textureIDs[textureSlot].ID = textureID;
+		m_textureIDs[textureSlot].filename = filename;
 		return true;
 	}
 
-	std::cout << "Could not load image:" << filename << std::endl;
+	// register the loaded texture and associate it with the special tag string
+	m_textureIDs[m_loadedTextures].ID = textureID;
+	m_textureIDs[m_loadedTextures].tag = tag;
+	m_textureIDs[m_loadedTextures].filename = filename;
+	m_loadedTextures++;
 
-	// Error loading the image
-	return false;
+	return true;
 }
 
 /***********************************************************
  *  BindGLTextures()
  *
  *  This method is used for binding the loaded textures to
- *  OpenGL texture memory slots.  There are up to 16 slots.
+ *  texture memory slots.  There are up to 16 slots.
  ***********************************************************/
 void SceneManager::BindGLTextures()
 {
 	for (int i = 0; i < m_loadedTextures; i++)
 	{
 		// bind textures on corresponding texture units
-		glActiveTexture(GL_TEXTURE0 + i);
-		glBindTexture(GL_TEXTURE_2D, m_textureIDs[i].ID);
+		m_commands.BindTexture(i, m_textureIDs[i].ID);
 	}
 }
 
@@ -149,7 +205,8 @@ void SceneManager::DestroyGLTextures()
 {
 	for (int i = 0; i < m_loadedTextures; i++)
 	{
-		glGenTextures(1, &m_textureIDs[i].ID);
+		m_resourceCache.ReleaseTexture(m_textureIDs[i].filename);
+		m_textureIDs[i].ID = 0;
 	}
 }
 
@@ -159,7 +216,7 @@ void SceneManager::DestroyGLTextures()
  *  This method is used for getting an ID for the previously
  *  loaded texture bitmap associated with the passed in tag.
  ***********************************************************/
-int SceneManager::FindTextureID(std::string tag)
+int SceneManager::FindTextureID(const char* tag)
 {
 	int textureID = -1;
 	int index = 0;
@@ -185,7 +242,7 @@ int SceneManager::FindTextureID(std::string tag)
  *  This method is used for getting a slot index for the previously
  *  loaded texture bitmap associated with the passed in tag.
  ***********************************************************/
-int SceneManager::FindTextureSlot(std::string tag)
+int SceneManager::FindTextureSlot(const char* tag)
 {
 	int textureSlot = -1;
 	int index = 0;
@@ -211,7 +268,7 @@ int SceneManager::FindTextureSlot(std::string tag)
  *  This method is used for getting a material from the previously
  *  defined materials list that is associated with the passed in tag.
  ***********************************************************/
-bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
+bool SceneManager::FindMaterial(const char* tag, OBJECT_MATERIAL& material)
 {
 	if (m_objectMaterials.size() == 0)
 	{
@@ -228,6 +285,8 @@ bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
 			material.diffuseColor = m_objectMaterials[index].diffuseColor;
 			material.specularColor = m_objectMaterials[index].specularColor;
 			material.shininess = m_objectMaterials[index].shininess;
+			material.metallic = m_objectMaterials[index].metallic;
+			material.roughness = m_objectMaterials[index].roughness;
 		}
 		else
 		{
@@ -235,7 +294,7 @@ bool SceneManager::FindMaterial(std::string tag, OBJECT_MATERIAL& material)
 		}
 	}
 
-	return(true);
+	return(bFound);
 }
 
 /***********************************************************
@@ -270,9 +329,9 @@ void SceneManager::SetTransformations(
 
 	modelView = translation * rotationZ * rotationY * rotationX * scale;
 
-	if (NULL != m_pShaderManager)
+	if (NULL != m_pDevice)
 	{
-		m_pShaderManager->setMat4Value(g_ModelName, modelView);
+		m_commands.SetMat4(g_ModelName, modelView);
 	}
 }
 
@@ -296,10 +355,16 @@ void SceneManager::SetShaderColor(
 	currentColor.b = blueColorValue;
 	currentColor.a = alphaValue;
 
-	if (NULL != m_pShaderManager)
+	if (NULL != m_pDevice)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, false);
-		m_pShaderManager->setVec4Value(g_ColorValueName, currentColor);
+		m_commands.SetInt(g_UseTextureName, false);
+		m_commands.SetVec4(g_ColorValueName, currentColor);
+	}
+
+	// plain colored objects use the generic material for PBR
+	if (m_bUsePBR == true)
+	{
+		SetShaderMaterial("default");
 	}
 }
 
@@ -310,15 +375,21 @@ void SceneManager::SetShaderColor(
  *  associated with the passed in ID into the shader.
  ***********************************************************/
 void SceneManager::SetShaderTexture(
-	std::string textureTag)
+	const char* textureTag)
 {
-	if (NULL != m_pShaderManager)
+	if (NULL != m_pDevice)
 	{
-		m_pShaderManager->setIntValue(g_UseTextureName, true);
+		m_commands.SetInt(g_UseTextureName, true);
 
 		int textureID = -1;
 		textureID = FindTextureSlot(textureTag);
-		m_pShaderManager->setSampler2DValue(g_TextureValueName, textureID);
+		m_commands.SetInt(g_TextureValueName, textureID);
+	}
+
+	// the PBR materials are defined with the same tags as the textures
+	if (m_bUsePBR == true)
+	{
+		SetShaderMaterial(textureTag);
 	}
 }
 
@@ -330,9 +401,9 @@ void SceneManager::SetShaderTexture(
  ***********************************************************/
 void SceneManager::SetTextureUVScale(float u, float v)
 {
-	if (NULL != m_pShaderManager)
+	if (NULL != m_pDevice)
 	{
-		m_pShaderManager->setVec2Value("UVscale", glm::vec2(u, v));
+		m_commands.SetVec2("UVscale", glm::vec2(u, v));
 	}
 }
 
@@ -345,6 +416,8 @@ void SceneManager::SetTextureUVScale(float u, float v)
  ***********************************************************/
 void SceneManager::LoadSceneTextures()
 {
+	PROFILE_SCOPE("SceneManager::LoadSceneTextures");
+	STARTUP_PHASE("LoadSceneTextures");
 	bool bReturn = false;
 
 	bReturn = CreateGLTexture(
@@ -399,7 +472,7 @@ void SceneManager::LoadSceneTextures()
  *  into the shader.
  ***********************************************************/
 void SceneManager::SetShaderMaterial(
-	std::string materialTag)
+	const char* materialTag)
 {
 	if (m_objectMaterials.size() > 0)
 	{
@@ -409,13 +482,33 @@ void SceneManager::SetShaderMaterial(
 		bReturn = FindMaterial(materialTag, material);
 		if (bReturn == true)
 		{
-			m_pShaderManager->setVec3Value("material.diffuseColor", material.diffuseColor);
-			m_pShaderManager->setVec3Value("material.specularColor", material.specularColor);
-			m_pShaderManager->setFloatValue("material.shininess", material.shininess);
+			m_commands.SetVec3("material.diffuseColor", material.diffuseColor);
+			m_commands.SetVec3("material.specularColor", material.specularColor);
+			m_commands.SetFloat("material.shininess", material.shininess);
+			m_commands.SetFloat("material.metallic", material.metallic);
+			m_commands.SetFloat("material.roughness", material.roughness);
 		}
 	}
 }
 
+/***********************************************************
+ *  SetPBRShading()
+ *
+ *  This method is used for switching the scene between the
+ *  default shading and the metallic-roughness PBR shading.
+ ***********************************************************/
+void SceneManager::SetPBRShading(bool bEnabled)
+{
+	m_bUsePBR = bEnabled;
+
+	if (NULL != m_pDevice)
+	{
+		// PBR shading is only evaluated on the lighting path
+		m_commands.SetInt(g_UseLightingName, bEnabled);
+		m_commands.SetInt(g_UsePBRName, bEnabled);
+	}
+}
+
 /**************************************************************/
 /*** STUDENTS CAN MODIFY the code in the methods BELOW for  ***/
 /*** preparing and rendering their own 3D replicated scenes.***/
@@ -423,6 +516,167 @@ void SceneManager::SetShaderMaterial(
 /*** for assistance.                                        ***/
 /**************************************************************/
 
+/***********************************************************
+ *  DefineObjectMaterials()
+ *
+ *  This method is used for configuring the various material
+ *  settings for all of the objects within the 3D scene.  The
+ *  tags match the texture tags so textured objects pick up
+ *  their material automatically.
+ ***********************************************************/
+void SceneManager::DefineObjectMaterials()
+{
+	OBJECT_MATERIAL marbleMaterial;
+	marbleMaterial.diffuseColor = glm::vec3(0.8f, 0.8f, 0.8f);
+	marbleMaterial.specularColor = glm::vec3(0.4f, 0.4f, 0.4f);
+	marbleMaterial.shininess = 32.0f;
+	marbleMaterial.metallic = 0.0f;
+	marbleMaterial.roughness = 0.25f;
+	marbleMaterial.tag = "marble";
+	m_objectMaterials.push_back(marbleMaterial);
+
+	OBJECT_MATERIAL goldMaterial;
+	goldMaterial.diffuseColor = glm::vec3(0.8f, 0.8f, 0.8f);
+	goldMaterial.specularColor = glm::vec3(0.9f, 0.8f, 0.5f);
+	goldMaterial.shininess = 64.0f;
+	goldMaterial.metallic = 1.0f;
+	goldMaterial.roughness = 0.3f;
+	goldMaterial.tag = "gold";
+	m_objectMaterials.push_back(goldMaterial);
+
+	OBJECT_MATERIAL versaceMaterial;
+	versaceMaterial.diffuseColor = glm::vec3(0.8f, 0.8f, 0.8f);
+	versaceMaterial.specularColor = glm::vec3(0.9f, 0.8f, 0.5f);
+	versaceMaterial.shininess = 64.0f;
+	versaceMaterial.metallic = 1.0f;
+	versaceMaterial.roughness = 0.35f;
+	versaceMaterial.tag = "versace";
+	m_objectMaterials.push_back(versaceMaterial);
+
+	OBJECT_MATERIAL glassMaterial;
+	glassMaterial.diffuseColor = glm::vec3(0.6f, 0.6f, 0.7f);
+	glassMaterial.specularColor = glm::vec3(1.0f, 1.0f, 1.0f);
+	glassMaterial.shininess = 96.0f;
+	glassMaterial.metallic = 0.0f;
+	glassMaterial.roughness = 0.05f;
+	glassMaterial.tag = "blue_glass";
+	m_objectMaterials.push_back(glassMaterial);
+
+	OBJECT_MATERIAL perfumeMaterial;
+	perfumeMaterial.diffuseColor = glm::vec3(0.8f, 0.8f, 0.8f);
+	perfumeMaterial.specularColor = glm::vec3(0.9f, 0.8f, 0.5f);
+	perfumeMaterial.shininess = 64.0f;
+	perfumeMaterial.metallic = 0.9f;
+	perfumeMaterial.roughness = 0.3f;
+	perfumeMaterial.tag = "perfume";
+	m_objectMaterials.push_back(perfumeMaterial);
+
+	OBJECT_MATERIAL feltMaterial;
+	feltMaterial.diffuseColor = glm::vec3(0.9f, 0.9f, 0.9f);
+	feltMaterial.specularColor = glm::vec3(0.05f, 0.05f, 0.05f);
+	feltMaterial.shininess = 2.0f;
+	feltMaterial.metallic = 0.0f;
+	feltMaterial.roughness = 0.95f;
+	feltMaterial.tag = "gray_felt";
+	m_objectMaterials.push_back(feltMaterial);
+	feltMaterial.tag = "black_felt";
+	m_objectMaterials.push_back(feltMaterial);
+	feltMaterial.tag = "green_felt";
+	m_objectMaterials.push_back(feltMaterial);
+
+	OBJECT_MATERIAL leatherMaterial;
+	leatherMaterial.diffuseColor = glm::vec3(0.85f, 0.85f, 0.85f);
+	leatherMaterial.specularColor = glm::vec3(0.3f, 0.3f, 0.3f);
+	leatherMaterial.shininess = 16.0f;
+	leatherMaterial.metallic = 0.0f;
+	leatherMaterial.roughness = 0.55f;
+	leatherMaterial.tag = "white_leather";
+	m_objectMaterials.push_back(leatherMaterial);
+	leatherMaterial.tag = "brown_leather";
+	m_objectMaterials.push_back(leatherMaterial);
+
+	// used for the objects drawn with a plain color
+	OBJECT_MATERIAL defaultMaterial;
+	defaultMaterial.diffuseColor = glm::vec3(0.9f, 0.9f, 0.9f);
+	defaultMaterial.specularColor = glm::vec3(0.2f, 0.2f, 0.2f);
+	defaultMaterial.shininess = 8.0f;
+	defaultMaterial.metallic = 0.0f;
+	defaultMaterial.roughness = 0.6f;
+	defaultMaterial.tag = "default";
+	m_objectMaterials.push_back(defaultMaterial);
+}
+
+/***********************************************************
+ *  SetupSceneLights()
+ *
+ *  This method is called to add and configure the light
+ *  sources for the 3D scene.  The lights are only used when
+ *  lighting is enabled in the shader.
+ ***********************************************************/
+void SceneManager::SetupSceneLights()
+{
+	if (NULL == m_pDevice)
+	{
+		return;
+	}
+
+	SCENE_LIGHTS lights;
+	GetSceneLights(lights);
+
+	const DIRECTIONAL_LIGHT& directional = lights.directionalLight;
+	m_commands.SetVec3("directionalLight.direction", directional.direction);
+	m_commands.SetVec3("directionalLight.ambient", directional.ambient);
+	m_commands.SetVec3("directionalLight.diffuse", directional.diffuse);
+	m_commands.SetVec3("directionalLight.specular", directional.specular);
+	m_commands.SetInt("directionalLight.bActive", directional.bActive);
+
+	for (int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+	{
+		const POINT_LIGHT& light = lights.pointLights[i];
+		std::string name = "pointLights[" + std::to_string(i) + "].";
+		m_commands.SetVec3((name + "position").c_str(), light.position);
+		m_commands.SetVec3((name + "ambient").c_str(), light.ambient);
+		m_commands.SetVec3((name + "diffuse").c_str(), light.diffuse);
+		m_commands.SetVec3((name + "specular").c_str(), light.specular);
+		m_commands.SetInt((name + "bActive").c_str(), light.bActive);
+	}
+
+	m_commands.SetInt("spotLight.bActive", lights.spotLight.bActive);
+}
+
+/***********************************************************
+ *  GetSceneLights()
+ *
+ *  This method is used for defining the light sources of the
+ *  3D scene that are set into the shader.
+ ***********************************************************/
+void SceneManager::GetSceneLights(SCENE_LIGHTS& lights) const
+{
+	lights = SCENE_LIGHTS();
+
+	// overhead light coming in from the front of the table
+	lights.directionalLight.direction = glm::vec3(-0.3f, -1.0f, -0.4f);
+	lights.directionalLight.ambient = glm::vec3(0.15f, 0.15f, 0.15f);
+	lights.directionalLight.diffuse = glm::vec3(0.7f, 0.7f, 0.65f);
+	lights.directionalLight.specular = glm::vec3(0.3f, 0.3f, 0.3f);
+	lights.directionalLight.bActive = true;
+
+	// warm key lights above both sides of the table
+	lights.pointLights[0].position = glm::vec3(-12.0f, 12.0f, 6.0f);
+	lights.pointLights[0].ambient = glm::vec3(0.05f, 0.05f, 0.05f);
+	lights.pointLights[0].diffuse = glm::vec3(0.5f, 0.45f, 0.4f);
+	lights.pointLights[0].specular = glm::vec3(0.4f, 0.4f, 0.4f);
+	lights.pointLights[0].bActive = true;
+
+	lights.pointLights[1].position = glm::vec3(12.0f, 12.0f, 6.0f);
+	lights.pointLights[1].ambient = glm::vec3(0.05f, 0.05f, 0.05f);
+	lights.pointLights[1].diffuse = glm::vec3(0.5f, 0.45f, 0.4f);
+	lights.pointLights[1].specular = glm::vec3(0.4f, 0.4f, 0.4f);
+	lights.pointLights[1].bActive = true;
+
+	// the remaining point lights and the spot light stay off
+}
+
 /***********************************************************
  *  PrepareScene()
  *
@@ -432,44 +686,385 @@ void SceneManager::SetShaderMaterial(
  ***********************************************************/
 void SceneManager::PrepareScene()
 {
+	PROFILE_SCOPE("SceneManager::PrepareScene");
+	STARTUP_PHASE("PrepareScene");
 	// load the textures for the 3D scene
 	LoadSceneTextures();
 
-	// only one instance of a particular mesh needs to be
-	// loaded in memory no matter how many times it is drawn
-	// in the rendered 3D scene
+	// define the materials and lights used when lighting is on
+	DefineObjectMaterials();
+	SetupSceneLights();
 
-	m_basicMeshes->LoadBoxMesh();
-	m_basicMeshes->LoadPlaneMesh();
-	m_basicMeshes->LoadCylinderMesh();
-	m_basicMeshes->LoadConeMesh();
-	m_basicMeshes->LoadPrismMesh();
-	m_basicMeshes->LoadPyramid4Mesh();
-	m_basicMeshes->LoadSphereMesh();
-	m_basicMeshes->LoadTaperedCylinderMesh();
-	m_basicMeshes->LoadTorusMesh();
+	// the BRDF lookup table is read from its cache file, and only
+	// integrated on the CPU when the cache is missing
+	StartupPhase brdfLutPhase("LoadBrdfLut");
+	if (m_brdfLut.Load(g_BrdfLutCacheFile))
+	{
+		m_commands.BindTexture(BRDF_LUT_TEXTURE_SLOT, m_brdfLut.CreateTexture(m_pDevice));
+		m_commands.SetInt(g_BrdfLutName, BRDF_LUT_TEXTURE_SLOT);
+	}
+	brdfLutPhase.Stop();
+
+	// the cube map samplers always need their own slots, since a
+	// sampler2D and a samplerCube may not share a texture unit
+	m_commands.SetInt(g_IrradianceMapName, IRRADIANCE_MAP_TEXTURE_SLOT);
+	m_commands.SetInt(g_PrefilterMapName, PREFILTER_MAP_TEXTURE_SLOT);
+
+	// reflections are only available when a panorama (or its
+	// prefiltered cache) is present next to the textures
+	StartupPhase environmentPhase("LoadEnvironmentMap");
+	bool bEnvironmentLoaded = m_environmentMap.Load(g_EnvironmentFile, g_EnvironmentCacheFile);
+	if (bEnvironmentLoaded)
+	{
+		m_environmentMap.CreateTextures(m_pDevice);
+		m_commands.BindTexture(IRRADIANCE_MAP_TEXTURE_SLOT, m_environmentMap.GetIrradianceTextureID());
+		m_commands.BindTexture(PREFILTER_MAP_TEXTURE_SLOT, m_environmentMap.GetPrefilterTextureID());
+		m_commands.SetFloat(g_PrefilterMipLevelsName, (float)m_environmentMap.GetPrefilterMipLevels());
+	}
+	else
+	{
+		std::cout << "No environment map, the PBR shading falls back to the scene lights without reflections" << std::endl;
+	}
+	m_commands.SetInt(g_UseEnvironmentMapName, bEnvironmentLoaded);
+	environmentPhase.Stop();
+
+	// the glyph atlas is read from its cache file, and only
+	// generated from the font when the cache is missing
+	LoadSceneFont();
 
+	// the basic shape meshes are loaded once by the render
+	// device, no matter how many times they are drawn
 }
 
 /***********************************************************
  *  RenderScene()
  *
  *  This method is used for rendering the 3D scene by
- *  transforming and drawing the basic 3D shapes
+ *  transforming and drawing the basic 3D shapes.  The draws
+ *  are recorded after the state changes made since the last
+ *  frame, and the whole list is submitted to the device.
+ *  The scene, and each object group if enabled, is wrapped
+ *  in a GPU timer, which devices without timers skip.
  ***********************************************************/
 void SceneManager::RenderScene()
 {
-	RenderTable();
-	RenderCologneBottle();
-	RenderPerfumeBottle();
-	RenderItinerary();
-	RenderNecklaceBox();
-	RenderRingBox();
-	RenderWhiteVowBook();
-	RenderBrownVowBook();
+	PROFILE_SCOPE("SceneManager::RenderScene");
+	if (NULL == m_pDevice)
+	{
+		return;
+	}
+
+	// object groups of the built in layout
+	struct OBJECT_GROUP
+	{
+		const char* name;
+		void (SceneManager::*render)();
+	};
+	static const OBJECT_GROUP objectGroups[] = {
+		{ "Table", &SceneManager::RenderTable },
+		{ "CologneBottle", &SceneManager::RenderCologneBottle },
+		{ "PerfumeBottle", &SceneManager::RenderPerfumeBottle },
+		{ "Itinerary", &SceneManager::RenderItinerary },
+		{ "NecklaceBox", &SceneManager::RenderNecklaceBox },
+		{ "RingBox", &SceneManager::RenderRingBox },
+		{ "WhiteVowBook", &SceneManager::RenderWhiteVowBook },
+		{ "BrownVowBook", &SceneManager::RenderBrownVowBook } };
+
+	StageTimer recordTimer(m_pStatistics, RenderStatistics::STAGE_RECORD);
+	m_commands.BeginTimer("Scene");
+	m_commands.SetPipeline(m_scenePipeline);
+
+	// a loaded scene file replaces the hard-coded layout
+	if (NULL != m_pActiveScene)
+	{
+		// the objects of a scene file are timed as one group
+		if (m_bTimeObjectGroups)
+		{
+			m_commands.BeginTimer("SceneFile");
+		}
+		RenderSceneFile();
+		if (m_bTimeObjectGroups)
+		{
+			m_commands.EndTimer();
+		}
+	}
+	else
+	{
+		for (size_t i = 0; i < sizeof(objectGroups) / sizeof(objectGroups[0]); i++)
+		{
+			if (m_bTimeObjectGroups)
+			{
+				m_commands.BeginTimer(objectGroups[i].name);
+			}
+			(this->*objectGroups[i].render)();
+			if (m_bTimeObjectGroups)
+			{
+				m_commands.EndTimer();
+			}
+		}
+	}
+	m_commands.EndTimer();
+	if ((NULL != m_pPerformanceHud) && m_pPerformanceHud->IsVisible())
+	{
+		RenderPerformanceHud();
+	}
+	recordTimer.Stop();
+
+	StageTimer submitTimer(m_pStatistics, RenderStatistics::STAGE_SUBMIT);
+	m_pDevice->Submit(m_commands);
+	m_commands.Reset();
+}
+
+/***********************************************************
+ *  LoadSceneFile()
+ *
+ *  This method is used for loading a scene file and showing
+ *  it.  A scene that is already loaded is switched to.
+ ***********************************************************/
+bool SceneManager::LoadSceneFile(const char* filename)
+{
+	PROFILE_SCOPE("SceneManager::LoadSceneFile");
+	for (size_t i = 0; i < m_scenes.size(); i++)
+	{
+		if (m_scenes[i]->GetSourceFilename() == filename)
+		{
+			return(SwitchScene((int)i));
+		}
+	}
+
+	ResidentScene::PRELOAD_DATA data;
+	ResidentScene::Preload(filename, m_resourceCache.GetResidentTextures(), data);
+
+	return(AddScene(data, true));
+}
+
+/***********************************************************
+ *  PreloadSceneFile()
+ *
+ *  This method is used for loading a scene file in the
+ *  background while the current scene keeps rendering.  The
+ *  file is parsed and its images decoded on a worker thread,
+ *  and UpdateScenes() uploads the result once it is ready.
+ ***********************************************************/
+void SceneManager::PreloadSceneFile(const char* filename)
+{
+	FrameArena::ExpectAllocations();
+	PENDING_SCENE pending;
+	pending.pData = std::make_shared<ResidentScene::PRELOAD_DATA>();
+
+	std::shared_ptr<ResidentScene::PRELOAD_DATA> pData = pending.pData;
+	std::string sceneFilename = filename;
+	// the worker only gets a copy of the loaded image names,
+	// the cache itself is only used on this thread
+	std::set<std::string> residentTextures = m_resourceCache.GetResidentTextures();
+	pending.result = std::async(std::launch::async, [pData, sceneFilename, residentTextures]()
+	{
+		ResidentScene::Preload(sceneFilename, residentTextures, *pData);
+	});
+
+	m_pendingScenes.push_back(std::move(pending));
+}
+
+/***********************************************************
+ *  AddScene()
+ *
+ *  This method is used for creating a resident scene from
+ *  preloaded data, and optionally switching to it.
+ ***********************************************************/
+bool SceneManager::AddScene(ResidentScene::PRELOAD_DATA& data, bool bActivate)
+{
+	if (!data.bLoaded)
+	{
+		ResidentScene::FreePreloadData(data);
+		return(false);
+	}
+
+	// uploading the scene allocates, and so do the first
+	// frames drawing it
+	FrameArena::ExpectAllocations();
+	ResidentScene* pScene = new ResidentScene(m_pDevice, &m_resourceCache, &m_textRenderer, OBJECT_BLOCK_BINDING);
+	if (!pScene->Apply(data))
+	{
+		delete pScene;
+		return(false);
+	}
+	m_scenes.push_back(pScene);
+
+	if (bActivate)
+	{
+		return(SwitchScene((int)m_scenes.size() - 1));
+	}
+
+	// the upload may have changed the texture unit bindings
+	if (NULL != m_pActiveScene)
+	{
+		m_pActiveScene->BindTextures(m_commands);
+	}
+	else
+	{
+		BindGLTextures();
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  SwitchScene()
+ *
+ *  This method is used for changing the shown scene to one
+ *  of the resident scenes, or to the built in layout with
+ *  -1.  Everything is already on the GPU, so only the active
+ *  scene pointer and the texture unit bindings change.
+ ***********************************************************/
+bool SceneManager::SwitchScene(int sceneIndex)
+{
+	PROFILE_SCOPE("SceneManager::SwitchScene");
+	if (sceneIndex >= (int)m_scenes.size())
+	{
+		return(false);
+	}
+	FrameArena::ExpectAllocations();
+
+	if (sceneIndex < 0)
+	{
+		m_pActiveScene = NULL;
+		BindGLTextures();
+		return(true);
+	}
+
+	m_pActiveScene = m_scenes[sceneIndex];
+	m_pActiveScene->BindTextures(m_commands);
+
+	return(true);
 }
 
+/***********************************************************
+ *  UpdateScenes()
+ *
+ *  This method is used for finishing the background preloads
+ *  that are ready and for applying the edits made to the
+ *  file of the active scene.  It is called once per frame.
+ ***********************************************************/
+void SceneManager::UpdateScenes()
+{
+	PROFILE_SCOPE("SceneManager::UpdateScenes");
+	StageTimer updateTimer(m_pStatistics, RenderStatistics::STAGE_UPDATE);
+	for (size_t i = 0; i < m_pendingScenes.size();)
+	{
+		if (m_pendingScenes[i].result.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		{
+			i++;
+			continue;
+		}
+
+		m_pendingScenes[i].result.get();
+		AddScene(*m_pendingScenes[i].pData, false);
+		m_pendingScenes.erase(m_pendingScenes.begin() + i);
+	}
 
+	if ((NULL != m_pActiveScene) && m_pActiveScene->Reload())
+	{
+		// edited textures may have been loaded into new textures
+		m_pActiveScene->BindTextures(m_commands);
+	}
+}
+
+/***********************************************************
+ *  ApplySceneOverrides()
+ *
+ *  This method is used for replacing textures and colors of
+ *  the shown scene file, such as for one variant of a batch.
+ *  Returns the number of textures and objects uploaded.
+ ***********************************************************/
+int SceneManager::ApplySceneOverrides(const ResidentScene::OVERRIDES& overrides)
+{
+	if (NULL == m_pActiveScene)
+	{
+		return(0);
+	}
+
+	int uploadCount = m_pActiveScene->ApplyOverrides(overrides);
+	m_pActiveScene->BindTextures(m_commands);
+
+	return(uploadCount);
+}
+
+/***********************************************************
+ *  RenderSceneFile()
+ *
+ *  This method is used for rendering the objects of the
+ *  active scene file.  The model matrix, color and UV scale
+ *  of each object are already in the scene's object buffer,
+ *  so only its slot is bound before drawing.
+ ***********************************************************/
+void SceneManager::RenderSceneFile()
+{
+	PROFILE_SCOPE("SceneManager::RenderSceneFile");
+	const SceneFile& sceneFile = m_pActiveScene->GetSceneFile();
+	const SceneFile::OBJECT* objects = sceneFile.GetObjects();
+	const SceneFile::MESH_REF* meshes = sceneFile.GetMeshes();
+	const SceneFile::MATERIAL_REF* materials = sceneFile.GetMaterials();
+	const SceneFile::TEXTURE_REF* textures = sceneFile.GetTextures();
+
+	m_commands.SetInt(g_UseObjectBlockName, true);
+
+	for (uint32_t i = 0; i < sceneFile.GetObjectCount(); i++)
+	{
+		const SceneFile::MATERIAL_REF& material = materials[objects[i].materialIndex];
+
+		m_pActiveScene->BindObject(m_commands, i);
+
+		if (material.textureIndex >= 0)
+		{
+			const char* textureTag = sceneFile.GetString(textures[material.textureIndex].tagOffset);
+			m_commands.SetInt(g_UseTextureName, true);
+			m_commands.SetInt(g_TextureValueName, m_pActiveScene->FindTextureSlot(textureTag));
+		}
+		else
+		{
+			m_commands.SetInt(g_UseTextureName, false);
+		}
+		if (m_bUsePBR == true)
+		{
+			SetShaderMaterial(sceneFile.GetString(material.materialTagOffset));
+		}
+
+		DrawSceneMesh(meshes[objects[i].meshIndex].meshType, meshes[objects[i].meshIndex].parts);
+	}
+
+	m_commands.SetInt(g_UseObjectBlockName, false);
+
+	// text blocks are drawn after the cards they lie on, their
+	// transform and color are read from the mapped file
+	if ((sceneFile.GetTextCount() > 0) && BeginTextDrawing())
+	{
+		const SceneFile::TEXT_REF* texts = sceneFile.GetTexts();
+		const SceneFile::TRANSFORM* transforms = sceneFile.GetTransforms();
+		for (uint32_t i = 0; i < sceneFile.GetTextCount(); i++)
+		{
+			const TextRenderer::TEXT_BLOCK* pBlock = m_pActiveScene->GetTextBlock(texts[i].id);
+			if (NULL != pBlock)
+			{
+				DrawTextBlock(
+					*pBlock,
+					glm::make_mat4(transforms[texts[i].transformIndex].model),
+					glm::make_vec4(texts[i].color));
+			}
+		}
+		EndTextDrawing();
+	}
+}
+
+/***********************************************************
+ *  DrawSceneMesh()
+ *
+ *  This method is used for drawing the parts of a basic mesh
+ *  that a scene file object references.
+ ***********************************************************/
+void SceneManager::DrawSceneMesh(uint32_t meshType, uint32_t parts)
+{
+	m_commands.DrawShape(meshType, parts);
+}
 
 /***********************************************************
  *  RenderTable()
@@ -513,7 +1108,7 @@ void SceneManager::RenderTable()
 	SetShaderTexture("marble");
 
 	// draw the mesh with transformation values
-	m_basicMeshes->DrawPlaneMesh();
+	DrawSceneMesh(SceneFile::MESH_PLANE, SceneFile::PART_ALL);
 	/****************************************************************/
 }
 
@@ -542,7 +1137,7 @@ void SceneManager::RenderCologneBottle()
 	positionXYZ = glm::vec3(-15.0f, 0.75f, -15.0f);  // Base position remains the same
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("blue_glass");
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Gold Sphere (Center of the Blue Box) ---
 	scaleXYZ = glm::vec3(0.75f, 0.75f, 0.3f);  // Scaled up by 1.5
@@ -552,7 +1147,7 @@ void SceneManager::RenderCologneBottle()
 	positionXYZ = glm::vec3(-15.0f, 1.875f, -15.0f);  // Adjusted position (0.75 * 1.5 = 1.125; 0.75 + 1.125 = 1.875)
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("versace");
-	m_basicMeshes->DrawSphereMesh();
+	DrawSceneMesh(SceneFile::MESH_SPHERE, SceneFile::PART_ALL);
 #pragma endregion
 
 #pragma region CologneCap
@@ -564,7 +1159,7 @@ void SceneManager::RenderCologneBottle()
 	positionXYZ = glm::vec3(-15.0f, 0.75f, -19.95f);  // Adjusted position (-3.3 * 1.5 = -4.95; -15.0 + (-4.95) = -19.95)
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("gold");
-	m_basicMeshes->DrawCylinderMesh();
+	DrawSceneMesh(SceneFile::MESH_CYLINDER, SceneFile::PART_ALL);
 
 	// --- Larger Cylinder (Top of the Cap) ---
 	scaleXYZ = glm::vec3(1.5f, 1.5f, 1.5f);  // Scaled up by 1.5
@@ -574,9 +1169,9 @@ void SceneManager::RenderCologneBottle()
 	positionXYZ = glm::vec3(-15.0f, 0.75f, -19.95f);  // Same adjusted position as the smaller cylinder
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("gold");
-	m_basicMeshes->DrawCylinderMesh(false, true, true);
+	DrawSceneMesh(SceneFile::MESH_CYLINDER, SceneFile::PART_BOTTOM | SceneFile::PART_SIDES);
 	SetShaderTexture("versace");
-	m_basicMeshes->DrawCylinderMesh(true, false, false);  // Using different texture for the top of the cylinder
+	DrawSceneMesh(SceneFile::MESH_CYLINDER, SceneFile::PART_TOP);  // Using different texture for the top of the cylinder
 #pragma endregion
 
 }
@@ -606,7 +1201,7 @@ void SceneManager::RenderPerfumeBottle()
 	positionXYZ = glm::vec3(-21.0f, 0.875f, 2.0f);  // Base position remains the same
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("perfume");
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 #pragma endregion
 
 #pragma region RedLabel
@@ -619,7 +1214,7 @@ void SceneManager::RenderPerfumeBottle()
 	positionXYZ = glm::vec3(-21.0f, 2.725f, 2.0f);  // Adjusted Y position
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderColor(1.0f, 0.0f, 0.0f, 1.0f);  // Red color
-	m_basicMeshes->DrawPlaneMesh();
+	DrawSceneMesh(SceneFile::MESH_PLANE, SceneFile::PART_ALL);
 #pragma endregion
 
 #pragma region PerfumeCapBase
@@ -632,7 +1227,7 @@ void SceneManager::RenderPerfumeBottle()
 	positionXYZ = glm::vec3(-21.0f, 0.875f, -3.0f);  // Adjusted Z position
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("gold");
-	m_basicMeshes->DrawCylinderMesh();
+	DrawSceneMesh(SceneFile::MESH_CYLINDER, SceneFile::PART_ALL);
 #pragma endregion
 
 #pragma region PerfumeCap
@@ -646,15 +1241,15 @@ void SceneManager::RenderPerfumeBottle()
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("gold");
 	// Draw the sides of the cap
-	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::bottom);
-	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::right);
-	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::left);
-	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::back);
-	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::front);
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_BOTTOM);
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_RIGHT);
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_LEFT);
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_BACK);
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_FRONT);
 
 	// Draw the top with a different texture
 	SetShaderTexture("versace");
-	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::top);  // Different texture for top of cap
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_TOP);  // Different texture for top of cap
 #pragma endregion
 
 
@@ -684,7 +1279,7 @@ void SceneManager::RenderItinerary()
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderColor(1.0f, 1.0f, 1.0f, 1.0f);  // white color
 	//SetShaderTexture("");
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Green Torus ---
 	scaleXYZ = glm::vec3(1.5f, 1.5f, 0.75f);
@@ -695,7 +1290,7 @@ void SceneManager::RenderItinerary()
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderColor(0.12f, 0.21f, 0.18f, 1.0f);  // Dark green color
 	//SetShaderTexture("");
-	m_basicMeshes->DrawTorusMesh();
+	DrawSceneMesh(SceneFile::MESH_TORUS, SceneFile::PART_ALL);
 
 	// --- leaf motif ---
 	scaleXYZ = glm::vec3(1.6f, 0.3f, 1.6f);
@@ -706,8 +1301,19 @@ void SceneManager::RenderItinerary()
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderColor(0.12f, 0.21f, 0.18f, 1.0f);  // Dark green color
 	//SetShaderTexture("leaf");
-	m_basicMeshes->DrawHalfSphereMesh();
+	DrawSceneMesh(SceneFile::MESH_HALF_SPHERE, SceneFile::PART_ALL);
 
+	// --- names, date and schedule ---
+	if (BeginTextDrawing())
+	{
+		for (size_t i = 0; i < m_itineraryTexts.size(); i++)
+		{
+			const SCENE_TEXT& text = m_itineraryTexts[i];
+			glm::mat4 model = SceneFile::ComputeModelMatrix(glm::vec3(1.0f), text.rotationXYZ, text.positionXYZ);
+			DrawTextBlock(text.block, model, text.color);
+		}
+		EndTextDrawing();
+	}
 }
 
 /***********************************************************
@@ -734,15 +1340,15 @@ void SceneManager::RenderNecklaceBox()
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("green_felt");
 	// Draw the sides of the cap
-	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::bottom);
-	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::right);
-	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::left);
-	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::back);
-	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::front);
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_BOTTOM);
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_RIGHT);
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_LEFT);
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_BACK);
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_FRONT);
 
 	// Draw the top with a different texture
 	SetShaderTexture("black_felt");
-	m_basicMeshes->DrawBoxMeshSide(ShapeMeshes::BoxSide::top);
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_TOP);
 
 	// --- Necklace Platform ---
 	scaleXYZ = glm::vec3(5.0f, 0.2f, 5.0f);
@@ -752,7 +1358,7 @@ void SceneManager::RenderNecklaceBox()
 	positionXYZ = glm::vec3(-5.0f, 2.1f, -15.0f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("black_felt");
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 
 	// --- Ring Box Top ---
@@ -763,7 +1369,7 @@ void SceneManager::RenderNecklaceBox()
 	positionXYZ = glm::vec3(-6.3f, 4.5f, -19.8f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("green_felt");
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Necklace Platform ---
 	scaleXYZ = glm::vec3(5.0f, 0.2f, 5.0f);
@@ -773,7 +1379,7 @@ void SceneManager::RenderNecklaceBox()
 	positionXYZ = glm::vec3(-6.0f, 4.75f, -18.75f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("black_felt");
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 }
 
 /***********************************************************
@@ -816,7 +1422,7 @@ void SceneManager::RenderWhiteVowBook()
 	positionXYZ = glm::vec3(-3.0f, 0.25f, 1.0f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("gray_felt");
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Bottom Vow Cover ---
 	scaleXYZ = glm::vec3(10.0f, 0.2f, 14.0f);
@@ -826,7 +1432,7 @@ void SceneManager::RenderWhiteVowBook()
 	positionXYZ = glm::vec3(-3.0f, .6f, 1.0f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("white_leather");
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Top Vow Cover ---
 	scaleXYZ = glm::vec3(10.0f, 0.2f, 14.0f);
@@ -836,7 +1442,7 @@ void SceneManager::RenderWhiteVowBook()
 	positionXYZ = glm::vec3(-3.0f, 1.0f, 1.0f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("white_leather");
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Paper Inside Vow ---
 	scaleXYZ = glm::vec3(8.0, 0.05f, 14.0f);
@@ -846,7 +1452,7 @@ void SceneManager::RenderWhiteVowBook()
 	positionXYZ = glm::vec3(-2.25f, .8f, .75f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderColor(1, 1, 1, 1);
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Paper Inside Vow ---
 	scaleXYZ = glm::vec3(8.0, 0.05f, 14.0f);
@@ -856,7 +1462,7 @@ void SceneManager::RenderWhiteVowBook()
 	positionXYZ = glm::vec3(-2.25f, .8f, .75f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderColor(1, 1, 1, 1);
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Paper Inside Vow ---
 	scaleXYZ = glm::vec3(8.0, 0.05f, 14.0f);
@@ -866,7 +1472,7 @@ void SceneManager::RenderWhiteVowBook()
 	positionXYZ = glm::vec3(-2.25f, .8f, .75f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderColor(1, 1, 1, 1);
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Paper Inside Vow ---
 	scaleXYZ = glm::vec3(8.0, 0.05f, 14.0f);
@@ -876,7 +1482,7 @@ void SceneManager::RenderWhiteVowBook()
 	positionXYZ = glm::vec3(-2.25f, .8f, .75f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderColor(1, 1, 1, 1);  
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 }
 
@@ -903,7 +1509,7 @@ void SceneManager::RenderBrownVowBook()
 	positionXYZ = glm::vec3(15.0f, 0.25f, 1.0f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("gray_felt");
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Bottom Vow Cover ---
 	scaleXYZ = glm::vec3(10.0f, 0.2f, 14.0f);
@@ -913,7 +1519,7 @@ void SceneManager::RenderBrownVowBook()
 	positionXYZ = glm::vec3(15.0f, 0.6f, 1.0f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("brown_leather");
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Top Vow Cover ---
 	scaleXYZ = glm::vec3(10.0f, 0.2f, 14.0f);
@@ -923,7 +1529,7 @@ void SceneManager::RenderBrownVowBook()
 	positionXYZ = glm::vec3(15.0f, 1.0f, 1.0f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderTexture("brown_leather");
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Paper Inside Vow ---
 	scaleXYZ = glm::vec3(8.0, 0.05f, 14.0f);
@@ -933,7 +1539,7 @@ void SceneManager::RenderBrownVowBook()
 	positionXYZ = glm::vec3(15.75f, 0.8f, 1.0f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderColor(1, 1, 1, 1);
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Paper Inside Vow ---
 	scaleXYZ = glm::vec3(8.0, 0.05f, 14.0f);
@@ -943,7 +1549,7 @@ void SceneManager::RenderBrownVowBook()
 	positionXYZ = glm::vec3(15.75f, .8f, 1.0f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderColor(1, 1, 1, 1);
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Paper Inside Vow ---
 	scaleXYZ = glm::vec3(8.0, 0.05f, 14.0f);
@@ -953,7 +1559,7 @@ void SceneManager::RenderBrownVowBook()
 	positionXYZ = glm::vec3(15.75f, .8f, 1.0f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderColor(1, 1, 1, 1);
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
 
 	// --- Paper Inside Vow ---
 	scaleXYZ = glm::vec3(8.0, 0.05f, 14.0f);
@@ -963,6 +1569,191 @@ void SceneManager::RenderBrownVowBook()
 	positionXYZ = glm::vec3(15.75f, .8f, 1.0f);
 	SetTransformations(scaleXYZ, XrotationDegrees, YrotationDegrees, ZrotationDegrees, positionXYZ);
 	SetShaderColor(1, 1, 1, 1);
-	m_basicMeshes->DrawBoxMesh();
+	DrawSceneMesh(SceneFile::MESH_BOX, SceneFile::PART_ALL);
+
+}
+
+/***********************************************************
+ *  LoadSceneFont()
+ *
+ *  This method is used for getting the glyph atlas of the
+ *  first installed font and laying out the text of the built
+ *  in layout.  Without a font the text is left out.
+ ***********************************************************/
+void SceneManager::LoadSceneFont()
+{
+	STARTUP_PHASE("LoadSceneFont");
+	if (!LoadFontAtlas() || !m_textRenderer.CreateTexture(m_pDevice))
+	{
+		std::cout << "No font file found, the itinerary text is not drawn" << std::endl;
+		return;
+	}
+
+	// the itinerary card reads along its short side, from the
+	// ring motif at the far end towards the camera
+	glm::vec3 rotationXYZ = glm::vec3(-90.0f, 30.0f, 0.0f);
+	glm::vec4 inkColor = glm::vec4(0.12f, 0.21f, 0.18f, 1.0f);  // Dark green color
+	TextRenderer::TEXT_LAYOUT layout = TextRenderer::GetDefaultLayout(1.1f);
+	layout.alignment = TextRenderer::ALIGN_CENTER;
+
+	// --- names ---
+	AddItineraryText("Emma & James", layout, rotationXYZ, glm::vec3(-22.4f, 0.16f, -15.02f), inkColor);
+
+	// --- date ---
+	layout.size = 0.6f;
+	AddItineraryText("Saturday, June 14, 2025", layout, rotationXYZ, glm::vec3(-21.5f, 0.16f, -13.46f), inkColor);
+
+	// --- schedule ---
+	layout.lineSpacing = 1.2f;
+	AddItineraryText(
+		"3:00 PM  Ceremony\n"
+		"4:30 PM  Cocktail Hour\n"
+		"6:00 PM  Dinner\n"
+		"8:00 PM  First Dance\n"
+		"9:30 PM  Cake Cutting",
+		layout, rotationXYZ, glm::vec3(-20.7f, 0.16f, -12.08f), glm::vec4(0.2f, 0.2f, 0.2f, 1.0f));
+
+	// --- closing line, wrapped to the card ---
+	layout.size = 0.5f;
+	layout.maxWidth = 9.0f;
+	layout.lineSpacing = 1.0f;
+	AddItineraryText(
+		"Reception to follow in the Garden Terrace. Dancing until midnight.",
+		layout, rotationXYZ, glm::vec3(-17.8f, 0.16f, -7.06f), inkColor);
+}
+
+/***********************************************************
+ *  LoadFontAtlas()
+ *
+ *  This method is used for loading the glyph atlas of the
+ *  first installed font, without uploading it.
+ ***********************************************************/
+bool SceneManager::LoadFontAtlas()
+{
+	PROFILE_SCOPE("SceneManager::LoadFontAtlas");
+	bool bLoaded = false;
+	for (size_t i = 0; (i < sizeof(g_FontFiles) / sizeof(g_FontFiles[0])) && !bLoaded; i++)
+	{
+		std::ifstream fontFile(g_FontFiles[i]);
+		if (fontFile.is_open())
+		{
+			fontFile.close();
+			bLoaded = m_textRenderer.LoadAtlas(g_FontFiles[i], g_GlyphAtlasCacheFile);
+		}
+	}
+
+	return(bLoaded);
+}
+
+/***********************************************************
+ *  AddItineraryText()
+ *
+ *  This method is used for laying out one text block of the
+ *  built in itinerary card into its vertex buffer.
+ ***********************************************************/
+void SceneManager::AddItineraryText(
+	const std::string& text,
+	const TextRenderer::TEXT_LAYOUT& layout,
+	glm::vec3 rotationXYZ,
+	glm::vec3 positionXYZ,
+	glm::vec4 color)
+{
+	SCENE_TEXT sceneText;
+	sceneText.block = TextRenderer::GetEmptyBlock();
+	sceneText.rotationXYZ = rotationXYZ;
+	sceneText.positionXYZ = positionXYZ;
+	sceneText.color = color;
+
+	m_textRenderer.BuildBlock(sceneText.block, text, layout);
+	m_itineraryTexts.push_back(sceneText);
+}
 
-}
\ No newline at end of file
+/***********************************************************
+ *  BeginTextDrawing()
+ *
+ *  This method is used for binding the glyph atlas and
+ *  switching the shader to distance field text.  Returns
+ *  false when no font was loaded.
+ ***********************************************************/
+bool SceneManager::BeginTextDrawing()
+{
+	if (!m_textRenderer.IsReady())
+	{
+		return(false);
+	}
+
+	m_commands.BindTexture(TEXT_ATLAS_TEXTURE_SLOT, m_textRenderer.GetAtlasTextureID());
+	m_commands.SetInt(g_TextureValueName, TEXT_ATLAS_TEXTURE_SLOT);
+	m_commands.SetInt(g_UseTextSDFName, true);
+
+	// the glyphs lie on the card surfaces, so they are pulled
+	// towards the camera instead of fighting over the depth,
+	// and leave the depth alone so neighboring quads blend
+	m_commands.SetPipeline(m_textPipeline);
+
+	return(true);
+}
+
+/***********************************************************
+ *  EndTextDrawing()
+ *
+ *  This method is used for going back to drawing objects.
+ ***********************************************************/
+void SceneManager::EndTextDrawing()
+{
+	m_commands.SetPipeline(m_scenePipeline);
+	m_commands.SetInt(g_UseTextSDFName, false);
+}
+
+/***********************************************************
+ *  RenderPerformanceHud()
+ *
+ *  This method is used for drawing the performance HUD over
+ *  the scene, with the glyph atlas of the scene text, in one
+ *  draw call.  The view is replaced by window pixels until
+ *  the next frame sets it again, and the lighting and text
+ *  switches are put back for the scene.
+ ***********************************************************/
+void SceneManager::RenderPerformanceHud()
+{
+	if (!m_textRenderer.IsReady())
+	{
+		return;
+	}
+
+	m_commands.BeginTimer("Hud");
+	m_pPerformanceHud->Update(m_textRenderer.GetAtlas());
+	m_commands.SetPipeline(m_pPerformanceHud->GetPipeline());
+	m_commands.BindTexture(TEXT_ATLAS_TEXTURE_SLOT, m_textRenderer.GetAtlasTextureID());
+	m_commands.SetInt(g_TextureValueName, TEXT_ATLAS_TEXTURE_SLOT);
+	m_commands.SetInt(g_UseTextureName, false);
+	m_commands.SetInt(g_UseTextSDFName, true);
+	m_commands.SetInt(g_UseLightingName, false);
+	m_commands.SetInt(g_UseObjectBlockName, false);
+	m_commands.SetMat4("view", glm::mat4(1.0f));
+	m_commands.SetMat4("projection", m_pPerformanceHud->GetProjection());
+	m_commands.SetMat4(g_ModelName, glm::mat4(1.0f));
+	m_commands.SetVec4(g_ColorValueName, m_pPerformanceHud->GetColor());
+	m_commands.Draw(m_pPerformanceHud->GetVertexBuffer(), 0, m_pPerformanceHud->GetVertexCount());
+
+	m_commands.SetInt(g_UseTextSDFName, false);
+	m_commands.SetInt(g_UseLightingName, m_bUsePBR);
+	m_commands.SetPipeline(m_scenePipeline);
+	m_commands.EndTimer();
+}
+
+/***********************************************************
+ *  DrawTextBlock()
+ *
+ *  This method is used for drawing a laid out text block in
+ *  one color, with a single draw call.
+ ***********************************************************/
+void SceneManager::DrawTextBlock(
+	const TextRenderer::TEXT_BLOCK& block,
+	const glm::mat4& model,
+	const glm::vec4& color)
+{
+	m_commands.SetMat4(g_ModelName, model);
+	SetShaderColor(color.r, color.g, color.b, color.a);
+	TextRenderer::DrawBlock(m_commands, block);
+}
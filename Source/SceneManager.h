@@ -9,9 +9,18 @@
 
 #pragma once
 
-#include "ShaderManager.h"
-#include "ShapeMeshes.h"
-
+#include "RenderDevice.h"
+#include "RenderStatistics.h"
+#include "PerformanceHud.h"
+#include "BrdfLut.h"
+#include "EnvironmentMap.h"
+#include "ResidentScene.h"
+#include "ResourceCache.h"
+#include "SceneLights.h"
+#include "TextRenderer.h"
+
+#include <future>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -19,13 +28,15 @@
  *  SceneManager
  *
  *  This class contains the code for preparing and rendering
- *  3D scenes, including the shader settings.
+ *  3D scenes, including the shader settings.  The shader
+ *  settings and draws are recorded into a command list that
+ *  is submitted to the render device once per frame.
  ***********************************************************/
 class SceneManager
 {
 public:
 	// constructor
-	SceneManager(ShaderManager *pShaderManager);
+	SceneManager(RenderDevice* pDevice);
 	// destructor
 	~SceneManager();
 
@@ -33,6 +44,8 @@ public:
 	{
 		std::string tag;
 		uint32_t ID;
+		// image file the texture was loaded from
+		std::string filename;
 	};
 
 	struct OBJECT_MATERIAL
@@ -40,20 +53,67 @@ public:
 		glm::vec3 diffuseColor;
 		glm::vec3 specularColor;
 		float shininess;
+		// metallic-roughness values used by the PBR shading
+		float metallic;
+		float roughness;
 		std::string tag;
 	};
 
 private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
-	// pointer to basic shapes object
-	ShapeMeshes* m_basicMeshes;
+	// times the lookups and transformations on their own
+	friend class MicroBenchmark;
+
+	// device the scene is drawn with
+	RenderDevice* m_pDevice;
+	// shader settings and draws recorded for the next submit
+	RenderCommandList m_commands;
+	// state of the objects, and of the text drawn onto them
+	RENDER_PIPELINE m_scenePipeline;
+	RENDER_PIPELINE m_textPipeline;
 	// total number of loaded textures
 	int m_loadedTextures;
 	// loaded textures info
 	TEXTURE_INFO m_textureIDs[16];
 	// defined object materials
 	std::vector<OBJECT_MATERIAL> m_objectMaterials;
+	// precomputed split-sum lookup table for PBR shading
+	BrdfLut m_brdfLut;
+	// prefiltered environment cube maps for PBR reflections
+	EnvironmentMap m_environmentMap;
+	// true when the metallic-roughness shading is used
+	bool m_bUsePBR;
+	// true when every object group is timed on the GPU
+	bool m_bTimeObjectGroups;
+	// stage times of the frame, NULL when not collected
+	RenderStatistics* m_pStatistics;
+	// overlay drawn over the scene when visible, or NULL
+	PerformanceHud* m_pPerformanceHud;
+	// textures shared by the built in layout and the scene files
+	ResourceCache m_resourceCache;
+	// loaded scene files, and the one shown instead of the
+	// built in layout (NULL for the built in layout)
+	std::vector<ResidentScene*> m_scenes;
+	ResidentScene* m_pActiveScene;
+
+	// scene file being loaded on a worker thread
+	struct PENDING_SCENE
+	{
+		std::shared_ptr<ResidentScene::PRELOAD_DATA> pData;
+		std::future<void> result;
+	};
+	std::vector<PENDING_SCENE> m_pendingScenes;
+	// glyph atlas shared by the text of all scenes
+	TextRenderer m_textRenderer;
+
+	// text block of the built in layout
+	struct SCENE_TEXT
+	{
+		TextRenderer::TEXT_BLOCK block;
+		glm::vec3 rotationXYZ;
+		glm::vec3 positionXYZ;
+		glm::vec4 color;
+	};
+	std::vector<SCENE_TEXT> m_itineraryTexts;
 
 	// load texture images and convert to OpenGL texture data
 	bool CreateGLTexture(const char* filename, std::string tag);
@@ -62,10 +122,10 @@ private:
 	// free the loaded OpenGL textures
 	void DestroyGLTextures();
 	// find a loaded texture by tag
-	int FindTextureID(std::string tag);
-	int FindTextureSlot(std::string tag);
+	int FindTextureID(const char* tag);
+	int FindTextureSlot(const char* tag);
 	// find a defined material by tag
-	bool FindMaterial(std::string tag, OBJECT_MATERIAL& material);
+	bool FindMaterial(const char* tag, OBJECT_MATERIAL& material);
 
 	// set the transformation values 
 	// into the transform buffer
@@ -85,7 +145,7 @@ private:
 
 	// set the texture data into the shader
 	void SetShaderTexture(
-		std::string textureTag);
+		const char* textureTag);
 
 	// set the UV scale for the texture mapping
 	void SetTextureUVScale(
@@ -93,7 +153,35 @@ private:
 
 	// set the object material into the shader
 	void SetShaderMaterial(
-		std::string materialTag);
+		const char* materialTag);
+
+	// make a resident scene out of preloaded scene data
+	bool AddScene(ResidentScene::PRELOAD_DATA& data, bool bActivate);
+	// render the objects of the active scene file
+	void RenderSceneFile();
+	// draw the parts of a basic mesh referenced by a scene file
+	void DrawSceneMesh(uint32_t meshType, uint32_t parts);
+
+	// lay out a text block of the built in layout
+	void AddItineraryText(
+		const std::string& text,
+		const TextRenderer::TEXT_LAYOUT& layout,
+		glm::vec3 rotationXYZ,
+		glm::vec3 positionXYZ,
+		glm::vec4 color);
+	// load the glyph atlas of the first installed font
+	bool LoadFontAtlas();
+
+	// set up the shader and depth state for drawing text
+	bool BeginTextDrawing();
+	void EndTextDrawing();
+	// draw a laid out text block
+	void DrawTextBlock(
+		const TextRenderer::TEXT_BLOCK& block,
+		const glm::mat4& model,
+		const glm::vec4& color);
+	// draw the performance HUD over the finished scene
+	void RenderPerformanceHud();
 
 public:
 
@@ -101,15 +189,40 @@ public:
 	void PrepareScene();
 	// render the objects in the 3D scene
 	void RenderScene();
+	// switch between the default shading and PBR shading
+	void SetPBRShading(bool bEnabled);
+	// time each object group on the GPU, not only the scene
+	void SetObjectGroupTimers(bool bEnabled) { m_bTimeObjectGroups = bEnabled; }
+	// add the CPU time of the update, record and submit stages
+	// to the statistics, NULL to stop
+	void SetStatistics(RenderStatistics* pStatistics) { m_pStatistics = pStatistics; }
+	// draw the HUD over the scene while it is visible, NULL
+	// to stop
+	void SetPerformanceHud(PerformanceHud* pPerformanceHud) { m_pPerformanceHud = pPerformanceHud; }
+	// load a text or binary scene file and show it
+	bool LoadSceneFile(const char* filename);
+	// load a scene file in the background, to switch to later
+	void PreloadSceneFile(const char* filename);
+	// show a loaded scene file, or the built in layout with -1
+	bool SwitchScene(int sceneIndex);
+	int GetSceneCount() const { return((int)m_scenes.size()); }
+	// finish background loads and apply edits to the shown scene
+	void UpdateScenes();
+	// replace textures and colors of the shown scene file
+	int ApplySceneOverrides(const ResidentScene::OVERRIDES& overrides);
 
 	
 
 	// load all of the needed textures before rendering
 	void LoadSceneTextures();
+	// load the font and lay out the text before rendering
+	void LoadSceneFont();
 	// define all the object materials before rendering
 	void DefineObjectMaterials();
 	// add and define the light sources before rendering
 	void SetupSceneLights();
+	// get the light sources of the scene
+	void GetSceneLights(SCENE_LIGHTS& lights) const;
 
 	void RenderTable();
 	void RenderCologneBottle();
@@ -0,0 +1,372 @@
+///////////////////////////////////////////////////////////////////////////////
+// shapegeometry.cpp
+// ============
+// CPU side triangle lists of the basic shape meshes, for the CPU renderers
+///////////////////////////////////////////////////////////////////////////////
+
+#include "ShapeGeometry.h"
+#include "SceneFile.h"
+
+#include <cmath>
+
+// declaration of global variables
+namespace
+{
+	const float PI = 3.14159265359f;
+	// segments around the round shapes
+	const int ROUND_SEGMENTS = 36;
+	// segments from pole to pole of the sphere, and around the
+	// tube of the torus
+	const int SPHERE_STACKS = 18;
+	const int TORUS_TUBE_SEGMENTS = 18;
+	// radii of the torus, as loaded by ShapeMeshes by default
+	const float TORUS_MAIN_RADIUS = 1.0f;
+	const float TORUS_TUBE_RADIUS = 0.1f;
+	// top radius of the tapered cylinder, the bottom radius is 1
+	const float TAPERED_TOP_RADIUS = 0.5f;
+
+	typedef ShapeGeometry::MESH MESH;
+
+	/***********************************************************
+	 *  AddVertex()
+	 *
+	 *  Append one vertex and return its index.
+	 ***********************************************************/
+	uint32_t AddVertex(MESH& mesh, glm::vec3 position, glm::vec3 normal, glm::vec2 uv)
+	{
+		ShapeGeometry::VERTEX vertex;
+		vertex.position = position;
+		vertex.normal = normal;
+		vertex.uv = uv;
+		mesh.vertices.push_back(vertex);
+		return((uint32_t)mesh.vertices.size() - 1);
+	}
+
+	/***********************************************************
+	 *  AddTriangle()
+	 *
+	 *  Append the indices of one triangle.
+	 ***********************************************************/
+	void AddTriangle(MESH& mesh, uint32_t a, uint32_t b, uint32_t c)
+	{
+		mesh.indices.push_back(a);
+		mesh.indices.push_back(b);
+		mesh.indices.push_back(c);
+	}
+
+	/***********************************************************
+	 *  AddQuad()
+	 *
+	 *  Append a flat quad from its four corners, in counter
+	 *  clockwise order seen from the front.
+	 ***********************************************************/
+	void AddQuad(MESH& mesh, glm::vec3 p0, glm::vec3 p1, glm::vec3 p2, glm::vec3 p3, glm::vec3 normal)
+	{
+		uint32_t a = AddVertex(mesh, p0, normal, glm::vec2(0.0f, 0.0f));
+		uint32_t b = AddVertex(mesh, p1, normal, glm::vec2(1.0f, 0.0f));
+		uint32_t c = AddVertex(mesh, p2, normal, glm::vec2(1.0f, 1.0f));
+		uint32_t d = AddVertex(mesh, p3, normal, glm::vec2(0.0f, 1.0f));
+		AddTriangle(mesh, a, b, c);
+		AddTriangle(mesh, a, c, d);
+	}
+
+	/***********************************************************
+	 *  AddDisk()
+	 *
+	 *  Append a flat round cap in the XZ plane, facing up or
+	 *  down, covering the passed in angle.
+	 ***********************************************************/
+	void AddDisk(MESH& mesh, float radius, float y, bool bFacingUp, float angle = 2.0f * PI)
+	{
+		glm::vec3 normal(0.0f, bFacingUp ? 1.0f : -1.0f, 0.0f);
+		uint32_t center = AddVertex(mesh, glm::vec3(0.0f, y, 0.0f), normal, glm::vec2(0.5f, 0.5f));
+		uint32_t first = (uint32_t)mesh.vertices.size();
+		for (int i = 0; i <= ROUND_SEGMENTS; i++)
+		{
+			float theta = angle * i / ROUND_SEGMENTS;
+			float x = cosf(theta);
+			float z = sinf(theta);
+			AddVertex(mesh, glm::vec3(x * radius, y, z * radius), normal, glm::vec2(0.5f + 0.5f * x, 0.5f + 0.5f * z));
+		}
+		for (uint32_t i = 0; i < (uint32_t)ROUND_SEGMENTS; i++)
+		{
+			if (bFacingUp)
+			{
+				AddTriangle(mesh, center, first + i + 1, first + i);
+			}
+			else
+			{
+				AddTriangle(mesh, center, first + i, first + i + 1);
+			}
+		}
+	}
+
+	/***********************************************************
+	 *  AddLatheSide()
+	 *
+	 *  Append the side of a shape of revolution around the Y
+	 *  axis, between a bottom ring and a top ring - a cylinder,
+	 *  a tapered cylinder or, with a top radius of 0, a cone.
+	 ***********************************************************/
+	void AddLatheSide(MESH& mesh, float bottomRadius, float topRadius, float height)
+	{
+		// the side normal leans up by how much the radius shrinks
+		float slope = (bottomRadius - topRadius) / height;
+		uint32_t first = (uint32_t)mesh.vertices.size();
+		for (int i = 0; i <= ROUND_SEGMENTS; i++)
+		{
+			float u = (float)i / ROUND_SEGMENTS;
+			float theta = 2.0f * PI * u;
+			float x = cosf(theta);
+			float z = sinf(theta);
+			glm::vec3 normal = glm::normalize(glm::vec3(x, slope, z));
+			AddVertex(mesh, glm::vec3(x * bottomRadius, 0.0f, z * bottomRadius), normal, glm::vec2(u, 0.0f));
+			AddVertex(mesh, glm::vec3(x * topRadius, height, z * topRadius), normal, glm::vec2(u, 1.0f));
+		}
+		for (uint32_t i = 0; i < (uint32_t)ROUND_SEGMENTS; i++)
+		{
+			uint32_t bottom = first + i * 2;
+			AddTriangle(mesh, bottom, bottom + 1, bottom + 3);
+			AddTriangle(mesh, bottom, bottom + 3, bottom + 2);
+		}
+	}
+
+	/***********************************************************
+	 *  AddSphere()
+	 *
+	 *  Append a unit sphere, or only its upper half.
+	 ***********************************************************/
+	void AddSphere(MESH& mesh, bool bUpperHalf)
+	{
+		int stacks = bUpperHalf ? SPHERE_STACKS / 2 : SPHERE_STACKS;
+		uint32_t first = (uint32_t)mesh.vertices.size();
+		for (int stack = 0; stack <= stacks; stack++)
+		{
+			// from the top pole down
+			float phi = PI * stack / SPHERE_STACKS;
+			for (int i = 0; i <= ROUND_SEGMENTS; i++)
+			{
+				float theta = 2.0f * PI * i / ROUND_SEGMENTS;
+				glm::vec3 normal(sinf(phi) * cosf(theta), cosf(phi), sinf(phi) * sinf(theta));
+				AddVertex(mesh, normal, normal, glm::vec2((float)i / ROUND_SEGMENTS, 1.0f - (float)stack / SPHERE_STACKS));
+			}
+		}
+
+		uint32_t rowLength = ROUND_SEGMENTS + 1;
+		for (uint32_t stack = 0; stack < (uint32_t)stacks; stack++)
+		{
+			for (uint32_t i = 0; i < (uint32_t)ROUND_SEGMENTS; i++)
+			{
+				uint32_t top = first + stack * rowLength + i;
+				uint32_t bottom = top + rowLength;
+				AddTriangle(mesh, top, top + 1, bottom + 1);
+				AddTriangle(mesh, top, bottom + 1, bottom);
+			}
+		}
+
+		if (bUpperHalf)
+		{
+			AddDisk(mesh, 1.0f, 0.0f, false);
+		}
+	}
+
+	/***********************************************************
+	 *  AddTorus()
+	 *
+	 *  Append a torus lying in the XY plane, or the half of it
+	 *  above the X axis.
+	 ***********************************************************/
+	void AddTorus(MESH& mesh, bool bHalf)
+	{
+		float mainAngle = bHalf ? PI : 2.0f * PI;
+		uint32_t first = (uint32_t)mesh.vertices.size();
+		for (int i = 0; i <= ROUND_SEGMENTS; i++)
+		{
+			float theta = mainAngle * i / ROUND_SEGMENTS;
+			glm::vec3 ringDirection(cosf(theta), sinf(theta), 0.0f);
+			for (int j = 0; j <= TORUS_TUBE_SEGMENTS; j++)
+			{
+				float phi = 2.0f * PI * j / TORUS_TUBE_SEGMENTS;
+				glm::vec3 normal = ringDirection * cosf(phi) + glm::vec3(0.0f, 0.0f, sinf(phi));
+				glm::vec3 position = ringDirection * TORUS_MAIN_RADIUS + normal * TORUS_TUBE_RADIUS;
+				AddVertex(mesh, position, normal, glm::vec2((float)i / ROUND_SEGMENTS, (float)j / TORUS_TUBE_SEGMENTS));
+			}
+		}
+
+		uint32_t rowLength = TORUS_TUBE_SEGMENTS + 1;
+		for (uint32_t i = 0; i < (uint32_t)ROUND_SEGMENTS; i++)
+		{
+			for (uint32_t j = 0; j < (uint32_t)TORUS_TUBE_SEGMENTS; j++)
+			{
+				uint32_t a = first + i * rowLength + j;
+				uint32_t b = a + rowLength;
+				AddTriangle(mesh, a, b, b + 1);
+				AddTriangle(mesh, a, b + 1, a + 1);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ShapeGeometry()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+ShapeGeometry::ShapeGeometry()
+{
+}
+
+/***********************************************************
+ *  ~ShapeGeometry()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+ShapeGeometry::~ShapeGeometry()
+{
+}
+
+/***********************************************************
+ *  GetMesh()
+ *
+ *  This method is used for getting the triangles of a basic
+ *  mesh, building them the first time they are asked for.
+ *  It is not safe to call from several threads at once.
+ ***********************************************************/
+const ShapeGeometry::MESH& ShapeGeometry::GetMesh(uint32_t meshType, uint32_t parts)
+{
+	uint32_t key = (meshType << 16) | (parts & 0xFFFF);
+	std::map<uint32_t, MESH>::iterator it = m_meshes.find(key);
+	if (it == m_meshes.end())
+	{
+		it = m_meshes.insert(std::make_pair(key, MESH())).first;
+		BuildMesh(meshType, parts, it->second);
+	}
+	return(it->second);
+}
+
+/***********************************************************
+ *  BuildMesh()
+ *
+ *  This method is used for building the triangles of a mesh
+ *  type, with the same parts SceneManager draws for it.
+ ***********************************************************/
+void ShapeGeometry::BuildMesh(uint32_t meshType, uint32_t parts, MESH& mesh)
+{
+	bool bAll = (parts == SceneFile::PART_ALL);
+	bool bTop = bAll || ((parts & SceneFile::PART_TOP) != 0);
+	bool bBottom = bAll || ((parts & SceneFile::PART_BOTTOM) != 0);
+	bool bSides = bAll || ((parts & SceneFile::PART_SIDES) != 0);
+
+	switch (meshType)
+	{
+	case SceneFile::MESH_BOX:
+		// unit cube centered on the origin
+		if (bAll || (parts & SceneFile::PART_BACK))
+		{
+			AddQuad(mesh, glm::vec3(0.5f, -0.5f, -0.5f), glm::vec3(-0.5f, -0.5f, -0.5f),
+				glm::vec3(-0.5f, 0.5f, -0.5f), glm::vec3(0.5f, 0.5f, -0.5f), glm::vec3(0.0f, 0.0f, -1.0f));
+		}
+		if (bAll || (parts & SceneFile::PART_BOTTOM))
+		{
+			AddQuad(mesh, glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(0.5f, -0.5f, -0.5f),
+				glm::vec3(0.5f, -0.5f, 0.5f), glm::vec3(-0.5f, -0.5f, 0.5f), glm::vec3(0.0f, -1.0f, 0.0f));
+		}
+		if (bAll || (parts & SceneFile::PART_LEFT))
+		{
+			AddQuad(mesh, glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(-0.5f, -0.5f, 0.5f),
+				glm::vec3(-0.5f, 0.5f, 0.5f), glm::vec3(-0.5f, 0.5f, -0.5f), glm::vec3(-1.0f, 0.0f, 0.0f));
+		}
+		if (bAll || (parts & SceneFile::PART_RIGHT))
+		{
+			AddQuad(mesh, glm::vec3(0.5f, -0.5f, 0.5f), glm::vec3(0.5f, -0.5f, -0.5f),
+				glm::vec3(0.5f, 0.5f, -0.5f), glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3(1.0f, 0.0f, 0.0f));
+		}
+		if (bAll || (parts & SceneFile::PART_TOP))
+		{
+			AddQuad(mesh, glm::vec3(-0.5f, 0.5f, 0.5f), glm::vec3(0.5f, 0.5f, 0.5f),
+				glm::vec3(0.5f, 0.5f, -0.5f), glm::vec3(-0.5f, 0.5f, -0.5f), glm::vec3(0.0f, 1.0f, 0.0f));
+		}
+		if (bAll || (parts & SceneFile::PART_FRONT))
+		{
+			AddQuad(mesh, glm::vec3(-0.5f, -0.5f, 0.5f), glm::vec3(0.5f, -0.5f, 0.5f),
+				glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3(-0.5f, 0.5f, 0.5f), glm::vec3(0.0f, 0.0f, 1.0f));
+		}
+		break;
+	case SceneFile::MESH_PLANE:
+		// 2 x 2 in the XZ plane, facing up
+		AddQuad(mesh, glm::vec3(-1.0f, 0.0f, 1.0f), glm::vec3(1.0f, 0.0f, 1.0f),
+			glm::vec3(1.0f, 0.0f, -1.0f), glm::vec3(-1.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		break;
+	case SceneFile::MESH_CYLINDER:
+		// radius 1, from y = 0 up to y = 1
+		if (bBottom) AddDisk(mesh, 1.0f, 0.0f, false);
+		if (bTop) AddDisk(mesh, 1.0f, 1.0f, true);
+		if (bSides) AddLatheSide(mesh, 1.0f, 1.0f, 1.0f);
+		break;
+	case SceneFile::MESH_CONE:
+		// the sides are always drawn, only the base is optional
+		if (bBottom) AddDisk(mesh, 1.0f, 0.0f, false);
+		AddLatheSide(mesh, 1.0f, 0.0f, 1.0f);
+		break;
+	case SceneFile::MESH_PRISM:
+	{
+		// triangular ends facing +Z and -Z
+		glm::vec3 left(-0.5f, -0.5f, 0.0f);
+		glm::vec3 right(0.5f, -0.5f, 0.0f);
+		glm::vec3 apex(0.0f, 0.5f, 0.0f);
+		glm::vec3 front(0.0f, 0.0f, 0.5f);
+		glm::vec3 back(0.0f, 0.0f, -0.5f);
+		uint32_t a = AddVertex(mesh, left + front, glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.0f, 0.0f));
+		uint32_t b = AddVertex(mesh, right + front, glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(1.0f, 0.0f));
+		uint32_t c = AddVertex(mesh, apex + front, glm::vec3(0.0f, 0.0f, 1.0f), glm::vec2(0.5f, 1.0f));
+		AddTriangle(mesh, a, b, c);
+		a = AddVertex(mesh, right + back, glm::vec3(0.0f, 0.0f, -1.0f), glm::vec2(0.0f, 0.0f));
+		b = AddVertex(mesh, left + back, glm::vec3(0.0f, 0.0f, -1.0f), glm::vec2(1.0f, 0.0f));
+		c = AddVertex(mesh, apex + back, glm::vec3(0.0f, 0.0f, -1.0f), glm::vec2(0.5f, 1.0f));
+		AddTriangle(mesh, a, b, c);
+		AddQuad(mesh, left + back, right + back, right + front, left + front, glm::vec3(0.0f, -1.0f, 0.0f));
+		AddQuad(mesh, right + front, right + back, apex + back, apex + front, glm::normalize(glm::vec3(2.0f, 1.0f, 0.0f)));
+		AddQuad(mesh, left + back, left + front, apex + front, apex + back, glm::normalize(glm::vec3(-2.0f, 1.0f, 0.0f)));
+		break;
+	}
+	case SceneFile::MESH_PYRAMID4:
+	{
+		// square base at y = -0.5, apex at y = 0.5
+		glm::vec3 apex(0.0f, 0.5f, 0.0f);
+		glm::vec3 corners[4] = {
+			glm::vec3(-0.5f, -0.5f, 0.5f),
+			glm::vec3(0.5f, -0.5f, 0.5f),
+			glm::vec3(0.5f, -0.5f, -0.5f),
+			glm::vec3(-0.5f, -0.5f, -0.5f) };
+		for (int i = 0; i < 4; i++)
+		{
+			glm::vec3 p0 = corners[i];
+			glm::vec3 p1 = corners[(i + 1) % 4];
+			glm::vec3 normal = glm::normalize(glm::cross(p1 - p0, apex - p0));
+			uint32_t a = AddVertex(mesh, p0, normal, glm::vec2(0.0f, 0.0f));
+			uint32_t b = AddVertex(mesh, p1, normal, glm::vec2(1.0f, 0.0f));
+			uint32_t c = AddVertex(mesh, apex, normal, glm::vec2(0.5f, 1.0f));
+			AddTriangle(mesh, a, b, c);
+		}
+		AddQuad(mesh, corners[3], corners[2], corners[1], corners[0], glm::vec3(0.0f, -1.0f, 0.0f));
+		break;
+	}
+	case SceneFile::MESH_SPHERE:
+		AddSphere(mesh, false);
+		break;
+	case SceneFile::MESH_HALF_SPHERE:
+		AddSphere(mesh, true);
+		break;
+	case SceneFile::MESH_TAPERED_CYLINDER:
+		if (bBottom) AddDisk(mesh, 1.0f, 0.0f, false);
+		if (bTop) AddDisk(mesh, TAPERED_TOP_RADIUS, 1.0f, true);
+		if (bSides) AddLatheSide(mesh, 1.0f, TAPERED_TOP_RADIUS, 1.0f);
+		break;
+	case SceneFile::MESH_TORUS:
+		AddTorus(mesh, false);
+		break;
+	case SceneFile::MESH_HALF_TORUS:
+		AddTorus(mesh, true);
+		break;
+	}
+}
@@ -0,0 +1,57 @@
+///////////////////////////////////////////////////////////////////////////////
+// shapegeometry.h
+// ============
+// CPU side triangle lists of the basic shape meshes, for the CPU renderers
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+/***********************************************************
+ *  ShapeGeometry
+ *
+ *  This class builds the basic shapes of ShapeMeshes in main
+ *  memory - same unit sizes, orientations and parts - since
+ *  the ShapeMeshes vertices only live in OpenGL buffers.  The
+ *  meshes are indexed by the SceneFile mesh types and parts,
+ *  and each one is built the first time it is asked for.
+ ***********************************************************/
+class ShapeGeometry
+{
+public:
+	// constructor
+	ShapeGeometry();
+	// destructor
+	~ShapeGeometry();
+
+	// same layout as the vertex attributes of the shader
+	struct VERTEX
+	{
+		glm::vec3 position;
+		glm::vec3 normal;
+		glm::vec2 uv;
+	};
+
+	// indexed triangle list
+	struct MESH
+	{
+		std::vector<VERTEX> vertices;
+		std::vector<uint32_t> indices;
+	};
+
+	// get the triangles of the parts of a basic mesh - a
+	// SceneFile::MESH_TYPE with SceneFile::MESH_PART flags
+	const MESH& GetMesh(uint32_t meshType, uint32_t parts);
+
+private:
+	// built meshes by mesh type and parts
+	std::map<uint32_t, MESH> m_meshes;
+
+	// build the triangles of a mesh type
+	static void BuildMesh(uint32_t meshType, uint32_t parts, MESH& mesh);
+};
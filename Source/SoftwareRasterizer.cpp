@@ -0,0 +1,918 @@
+///////////////////////////////////////////////////////////////////////////////
+// softwarerasterizer.cpp
+// ============
+// render the scene draws on the CPU, in screen tiles spread over all cores
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SoftwareRasterizer.h"
+#include "Profiler.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+// SSE2 is part of every x64 target, and the default for 32 bit builds
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define SOFTWARE_RASTERIZER_SSE2
+#include <emmintrin.h>
+#endif
+
+// declaration of global variables
+namespace
+{
+	// tiles are square blocks of pixels shaded by one thread
+	const int TILE_SIZE = 32;
+	// triangles are binned in chunks of at least this size, and
+	// at most this many chunks - both only depend on the
+	// triangle count, never on the thread count
+	const size_t MIN_BIN_CHUNK_TRIANGLES = 4096;
+	const size_t MAX_BIN_CHUNKS = 64;
+	// triangles are clipped to this multiple of the viewport,
+	// which keeps the edge functions precise
+	const float GUARD_BAND = 4.0f;
+	// depth pull of the text towards the camera, like the
+	// polygon offset used for it on the GPU
+	const float TEXT_DEPTH_BIAS = 0.00002f;
+
+	/***********************************************************
+	 *  Smoothstep()
+	 *
+	 *  Hermite interpolation between two edges, as in GLSL.
+	 ***********************************************************/
+	float Smoothstep(float edge0, float edge1, float x)
+	{
+		float t = std::min(std::max((x - edge0) / (edge1 - edge0), 0.0f), 1.0f);
+		return(t * t * (3.0f - 2.0f * t));
+	}
+
+	/***********************************************************
+	 *  Reflect()
+	 *
+	 *  Reflect a direction about a normal, as in GLSL.
+	 ***********************************************************/
+	glm::vec3 Reflect(glm::vec3 incident, glm::vec3 normal)
+	{
+		return(incident - 2.0f * glm::dot(normal, incident) * normal);
+	}
+
+	/***********************************************************
+	 *  ClipDistance()
+	 *
+	 *  Signed distance of a clip space position to one of the
+	 *  clipping planes, positive on the kept side - plane 0 is
+	 *  the near plane, 1 to 4 the sides of the guard band.
+	 ***********************************************************/
+	float ClipDistance(const glm::vec4& position, int plane)
+	{
+		switch (plane)
+		{
+		case 0: return(position.z + position.w);
+		case 1: return(GUARD_BAND * position.w - position.x);
+		case 2: return(GUARD_BAND * position.w + position.x);
+		case 3: return(GUARD_BAND * position.w - position.y);
+		default: return(GUARD_BAND * position.w + position.y);
+		}
+	}
+}
+
+/***********************************************************
+ *  SoftwareRasterizer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SoftwareRasterizer::SoftwareRasterizer()
+{
+	m_width = 0;
+	m_height = 0;
+	m_viewProjection = glm::mat4(1.0f);
+	m_viewPosition = glm::vec3(0.0f);
+	m_lights = SCENE_LIGHTS();
+	m_tilesX = 0;
+	m_tilesY = 0;
+	m_triangleCount = 0;
+	m_fragmentCount = 0;
+}
+
+/***********************************************************
+ *  ~SoftwareRasterizer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SoftwareRasterizer::~SoftwareRasterizer()
+{
+}
+
+/***********************************************************
+ *  SetTarget()
+ *
+ *  This method is used for setting the size of the rendered
+ *  image.  The queued draws are cleared.
+ ***********************************************************/
+void SoftwareRasterizer::SetTarget(int width, int height)
+{
+	m_width = width;
+	m_height = height;
+	m_tilesX = (width + TILE_SIZE - 1) / TILE_SIZE;
+	m_tilesY = (height + TILE_SIZE - 1) / TILE_SIZE;
+	m_pixels.assign((size_t)width * height * 4, 0);
+	ClearDraws();
+}
+
+/***********************************************************
+ *  SetCamera()
+ *
+ *  This method is used for setting the same view values
+ *  that ViewManager sets into the shader.
+ ***********************************************************/
+void SoftwareRasterizer::SetCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition)
+{
+	m_viewProjection = projection * view;
+	m_viewPosition = viewPosition;
+}
+
+/***********************************************************
+ *  SetLights()
+ *
+ *  This method is used for setting the light sources.  The
+ *  draws without lighting are drawn in their colors and
+ *  textures as they are.
+ ***********************************************************/
+void SoftwareRasterizer::SetLights(const SCENE_LIGHTS& lights)
+{
+	m_lights = lights;
+}
+
+/***********************************************************
+ *  AddTexture()
+ *
+ *  This method is used for copying an image into a texture
+ *  and getting its index for the draws.  Single channel
+ *  images keep their value in red, like an R8 texture.
+ ***********************************************************/
+int SoftwareRasterizer::AddTexture(int width, int height, int colorChannels, const unsigned char* pixels)
+{
+	TEXTURE texture;
+	texture.width = width;
+	texture.height = height;
+	texture.texels.resize((size_t)width * height);
+
+	for (size_t i = 0; i < texture.texels.size(); i++)
+	{
+		const unsigned char* pixel = pixels + i * colorChannels;
+		uint32_t red = pixel[0];
+		uint32_t green = (colorChannels >= 3) ? pixel[1] : 0;
+		uint32_t blue = (colorChannels >= 3) ? pixel[2] : 0;
+		uint32_t alpha = (colorChannels == 4) ? pixel[3] : 255;
+		texture.texels[i] = red | (green << 8) | (blue << 16) | (alpha << 24);
+	}
+
+	m_textures.push_back(texture);
+	return((int)m_textures.size() - 1);
+}
+
+/***********************************************************
+ *  RemoveTexture()
+ *
+ *  This method is used for freeing the texels of a texture
+ *  that is not drawn with anymore.  The indices of the other
+ *  textures stay the same.
+ ***********************************************************/
+void SoftwareRasterizer::RemoveTexture(int textureIndex)
+{
+	if ((textureIndex >= 0) && (textureIndex < (int)m_textures.size()))
+	{
+		m_textures[textureIndex].width = 0;
+		m_textures[textureIndex].height = 0;
+		std::vector<uint32_t>().swap(m_textures[textureIndex].texels);
+	}
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for queueing a draw.  Nothing is done
+ *  with it until Render() is called.
+ ***********************************************************/
+void SoftwareRasterizer::Submit(const DRAW_CALL& draw)
+{
+	m_draws.push_back(draw);
+}
+
+/***********************************************************
+ *  ClearDraws()
+ *
+ *  This method is used for forgetting the queued draws, to
+ *  start on another image with the same textures.
+ ***********************************************************/
+void SoftwareRasterizer::ClearDraws()
+{
+	m_draws.clear();
+	m_triangles.clear();
+	m_chunkBins.clear();
+}
+
+/***********************************************************
+ *  Render()
+ *
+ *  This method is used for drawing the queued draws.  The
+ *  draws are transformed and set up in parallel, then the
+ *  triangles are binned into the tiles they touch, and last
+ *  the tiles are rasterized in parallel.
+ ***********************************************************/
+void SoftwareRasterizer::Render(int threadCount)
+{
+	if ((m_width <= 0) || (m_height <= 0))
+	{
+		return;
+	}
+
+	// vertex stage and triangle setup, one draw per work item
+	std::vector<std::vector<TRIANGLE> > drawTriangles(m_draws.size());
+	ParallelFor((int)m_draws.size(), [&](int index)
+	{
+		ProcessDraw((uint32_t)index, drawTriangles[index]);
+	}, threadCount);
+
+	// keep the triangles in submission order
+	size_t triangleCount = 0;
+	for (size_t i = 0; i < drawTriangles.size(); i++)
+	{
+		triangleCount += drawTriangles[i].size();
+	}
+	m_triangles.clear();
+	m_triangles.reserve(triangleCount);
+	for (size_t i = 0; i < drawTriangles.size(); i++)
+	{
+		m_triangles.insert(m_triangles.end(), drawTriangles[i].begin(), drawTriangles[i].end());
+	}
+	drawTriangles.clear();
+	m_triangleCount = triangleCount;
+
+	// bin the triangles into the tiles, each chunk of triangles
+	// into its own bins so the chunks can be done in parallel
+	size_t chunkSize = std::max(MIN_BIN_CHUNK_TRIANGLES, (triangleCount + MAX_BIN_CHUNKS - 1) / MAX_BIN_CHUNKS);
+	int chunkCount = (int)((triangleCount + chunkSize - 1) / chunkSize);
+	int tileCount = m_tilesX * m_tilesY;
+	m_chunkBins.assign(chunkCount, std::vector<std::vector<uint32_t> >(tileCount));
+	ParallelFor(chunkCount, [&](int chunk)
+	{
+		std::vector<std::vector<uint32_t> >& bins = m_chunkBins[chunk];
+		size_t last = std::min(triangleCount, (chunk + 1) * chunkSize);
+		for (size_t i = chunk * chunkSize; i < last; i++)
+		{
+			const TRIANGLE& triangle = m_triangles[i];
+			for (int tileY = triangle.minY / TILE_SIZE; tileY <= triangle.maxY / TILE_SIZE; tileY++)
+			{
+				for (int tileX = triangle.minX / TILE_SIZE; tileX <= triangle.maxX / TILE_SIZE; tileX++)
+				{
+					bins[tileY * m_tilesX + tileX].push_back((uint32_t)i);
+				}
+			}
+		}
+	}, threadCount);
+
+	// every tile writes only its own pixels
+	m_tileFragments.assign(tileCount, 0);
+	ParallelFor(tileCount, [&](int tileIndex)
+	{
+		RenderTile(tileIndex);
+	}, threadCount);
+
+	m_fragmentCount = 0;
+	for (int i = 0; i < tileCount; i++)
+	{
+		m_fragmentCount += m_tileFragments[i];
+	}
+}
+
+/***********************************************************
+ *  ProcessDraw()
+ *
+ *  This method is used for running the vertex stage of
+ *  vertexShader.glsl on a draw, and clipping and setting up
+ *  its triangles.
+ ***********************************************************/
+void SoftwareRasterizer::ProcessDraw(uint32_t drawIndex, std::vector<TRIANGLE>& triangles) const
+{
+	const DRAW_CALL& draw = m_draws[drawIndex];
+	const ShapeGeometry::MESH& mesh = *draw.pMesh;
+
+	glm::mat4 modelViewProjection = m_viewProjection * draw.model;
+	glm::mat3 normalMatrix = glm::mat3(glm::transpose(glm::inverse(draw.model)));
+
+	std::vector<CLIP_VERTEX> vertices(mesh.vertices.size());
+	for (size_t i = 0; i < mesh.vertices.size(); i++)
+	{
+		const ShapeGeometry::VERTEX& input = mesh.vertices[i];
+		CLIP_VERTEX& output = vertices[i];
+		glm::vec4 position(input.position, 1.0f);
+		glm::vec3 world = glm::vec3(draw.model * position);
+		glm::vec3 normal = normalMatrix * input.normal;
+
+		output.position = modelViewProjection * position;
+		output.attributes[0] = world.x;
+		output.attributes[1] = world.y;
+		output.attributes[2] = world.z;
+		output.attributes[3] = normal.x;
+		output.attributes[4] = normal.y;
+		output.attributes[5] = normal.z;
+		output.attributes[6] = input.uv.x;
+		output.attributes[7] = input.uv.y;
+	}
+
+	triangles.reserve(mesh.indices.size() / 3);
+	for (size_t i = 0; i + 2 < mesh.indices.size(); i += 3)
+	{
+		CLIP_VERTEX corners[3] = {
+			vertices[mesh.indices[i]],
+			vertices[mesh.indices[i + 1]],
+			vertices[mesh.indices[i + 2]] };
+
+		// triangles fully outside of one side of the view are
+		// dropped before any clipping
+		bool bOutside = false;
+		for (int axis = 0; (axis < 3) && !bOutside; axis++)
+		{
+			bool bBelow = true;
+			bool bAbove = true;
+			for (int c = 0; c < 3; c++)
+			{
+				bBelow = bBelow && (corners[c].position[axis] < -corners[c].position.w);
+				bAbove = bAbove && (corners[c].position[axis] > corners[c].position.w);
+			}
+			bOutside = bBelow || bAbove;
+		}
+		if (bOutside)
+		{
+			continue;
+		}
+
+		CLIP_VERTEX polygon[9];
+		int polygonCount = ClipTriangle(corners, polygon);
+		for (int p = 1; p + 1 < polygonCount; p++)
+		{
+			TRIANGLE triangle;
+			if (SetupTriangle(polygon[0], polygon[p], polygon[p + 1], drawIndex, triangle))
+			{
+				triangles.push_back(triangle);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  ClipTriangle()
+ *
+ *  This method is used for clipping a triangle against the
+ *  near plane and the guard band, one plane at a time.  It
+ *  returns the number of corners of the clipped polygon.
+ ***********************************************************/
+int SoftwareRasterizer::ClipTriangle(const CLIP_VERTEX input[3], CLIP_VERTEX output[9])
+{
+	// nearly every triangle is inside all of the planes
+	bool bInside = true;
+	for (int plane = 0; (plane < 5) && bInside; plane++)
+	{
+		for (int c = 0; c < 3; c++)
+		{
+			bInside = bInside && (ClipDistance(input[c].position, plane) >= 0.0f);
+		}
+	}
+	if (bInside)
+	{
+		output[0] = input[0];
+		output[1] = input[1];
+		output[2] = input[2];
+		return(3);
+	}
+
+	CLIP_VERTEX buffers[2][9];
+	int count = 3;
+	buffers[0][0] = input[0];
+	buffers[0][1] = input[1];
+	buffers[0][2] = input[2];
+
+	int current = 0;
+	for (int plane = 0; (plane < 5) && (count > 0); plane++)
+	{
+		const CLIP_VERTEX* source = buffers[current];
+		CLIP_VERTEX* target = buffers[1 - current];
+		int targetCount = 0;
+
+		for (int i = 0; i < count; i++)
+		{
+			const CLIP_VERTEX& a = source[i];
+			const CLIP_VERTEX& b = source[(i + 1) % count];
+			float distanceA = ClipDistance(a.position, plane);
+			float distanceB = ClipDistance(b.position, plane);
+
+			if (distanceA >= 0.0f)
+			{
+				target[targetCount++] = a;
+			}
+			if ((distanceA >= 0.0f) != (distanceB >= 0.0f))
+			{
+				float t = distanceA / (distanceA - distanceB);
+				CLIP_VERTEX& split = target[targetCount++];
+				split.position = a.position + (b.position - a.position) * t;
+				for (int k = 0; k < ATTRIBUTE_COUNT; k++)
+				{
+					split.attributes[k] = a.attributes[k] + (b.attributes[k] - a.attributes[k]) * t;
+				}
+			}
+		}
+
+		count = targetCount;
+		current = 1 - current;
+	}
+
+	for (int i = 0; i < count; i++)
+	{
+		output[i] = buffers[current][i];
+	}
+	return(count);
+}
+
+/***********************************************************
+ *  SetupTriangle()
+ *
+ *  This method is used for projecting a clipped triangle to
+ *  pixels and computing its edge functions.  Triangles are
+ *  drawn from both sides, so clockwise ones are flipped, and
+ *  empty or off screen triangles are dropped.
+ ***********************************************************/
+bool SoftwareRasterizer::SetupTriangle(
+	const CLIP_VERTEX& v0,
+	const CLIP_VERTEX& v1,
+	const CLIP_VERTEX& v2,
+	uint32_t drawIndex,
+	TRIANGLE& triangle) const
+{
+	const CLIP_VERTEX* corners[3] = { &v0, &v1, &v2 };
+	double x[3];
+	double y[3];
+	for (int i = 0; i < 3; i++)
+	{
+		const glm::vec4& position = corners[i]->position;
+		float inverseW = 1.0f / position.w;
+		x[i] = ((double)position.x * inverseW * 0.5 + 0.5) * m_width;
+		y[i] = ((double)position.y * inverseW * 0.5 + 0.5) * m_height;
+		triangle.depth[i] = position.z * inverseW * 0.5f + 0.5f;
+		triangle.inverseW[i] = inverseW;
+		for (int k = 0; k < ATTRIBUTE_COUNT; k++)
+		{
+			triangle.attributes[i][k] = corners[i]->attributes[k] * inverseW;
+		}
+	}
+
+	double area = (x[1] - x[0]) * (y[2] - y[0]) - (y[1] - y[0]) * (x[2] - x[0]);
+	if (area == 0.0)
+	{
+		return(false);
+	}
+	if (area < 0.0)
+	{
+		std::swap(x[1], x[2]);
+		std::swap(y[1], y[2]);
+		std::swap(triangle.depth[1], triangle.depth[2]);
+		std::swap(triangle.inverseW[1], triangle.inverseW[2]);
+		for (int k = 0; k < ATTRIBUTE_COUNT; k++)
+		{
+			std::swap(triangle.attributes[1][k], triangle.attributes[2][k]);
+		}
+		area = -area;
+	}
+
+	double minX = std::min(x[0], std::min(x[1], x[2]));
+	double maxX = std::max(x[0], std::max(x[1], x[2]));
+	double minY = std::min(y[0], std::min(y[1], y[2]));
+	double maxY = std::max(y[0], std::max(y[1], y[2]));
+	triangle.minX = std::max((int)std::floor(minX), 0);
+	triangle.minY = std::max((int)std::floor(minY), 0);
+	triangle.maxX = std::min((int)std::floor(maxX), m_width - 1);
+	triangle.maxY = std::min((int)std::floor(maxY), m_height - 1);
+	if ((triangle.minX > triangle.maxX) || (triangle.minY > triangle.maxY))
+	{
+		return(false);
+	}
+
+	// counter clockwise with y up - edges going down are left
+	// edges, and the top edge goes right to left
+	for (int i = 0; i < 3; i++)
+	{
+		int a = (i + 1) % 3;
+		int b = (i + 2) % 3;
+		double dx = x[b] - x[a];
+		double dy = y[b] - y[a];
+		triangle.edgeA[i] = (float)(-dy);
+		triangle.edgeB[i] = (float)dx;
+		triangle.edgeC[i] = (float)(dy * x[a] - dx * y[a]);
+		triangle.bTopLeft[i] = (dy < 0.0) || ((dy == 0.0) && (dx < 0.0));
+	}
+
+	triangle.inverseArea = (float)(1.0 / area);
+	triangle.drawIndex = drawIndex;
+	return(true);
+}
+
+/***********************************************************
+ *  RenderTile()
+ *
+ *  This method is used for rasterizing the triangles binned
+ *  into one tile, in submission order, into a local color
+ *  and depth buffer that is copied out at the end.  The edge
+ *  functions are evaluated for four pixels at a time.
+ ***********************************************************/
+void SoftwareRasterizer::RenderTile(int tileIndex)
+{
+	PROFILE_SCOPE("SoftwareRasterizer::RenderTile");
+	int tileX0 = (tileIndex % m_tilesX) * TILE_SIZE;
+	int tileY0 = (tileIndex / m_tilesX) * TILE_SIZE;
+	int tileX1 = std::min(tileX0 + TILE_SIZE, m_width) - 1;
+	int tileY1 = std::min(tileY0 + TILE_SIZE, m_height) - 1;
+
+	// cleared to opaque black and the far plane
+	float colors[TILE_SIZE * TILE_SIZE * 4];
+	float depths[TILE_SIZE * TILE_SIZE];
+	for (int i = 0; i < TILE_SIZE * TILE_SIZE; i++)
+	{
+		colors[i * 4 + 0] = 0.0f;
+		colors[i * 4 + 1] = 0.0f;
+		colors[i * 4 + 2] = 0.0f;
+		colors[i * 4 + 3] = 1.0f;
+		depths[i] = 1.0f;
+	}
+	size_t fragmentCount = 0;
+
+	for (size_t chunk = 0; chunk < m_chunkBins.size(); chunk++)
+	{
+		const std::vector<uint32_t>& bin = m_chunkBins[chunk][tileIndex];
+		for (size_t t = 0; t < bin.size(); t++)
+		{
+			const TRIANGLE& triangle = m_triangles[bin[t]];
+			int x0 = std::max(triangle.minX, tileX0);
+			int x1 = std::min(triangle.maxX, tileX1);
+			int y0 = std::max(triangle.minY, tileY0);
+			int y1 = std::min(triangle.maxY, tileY1);
+
+#ifdef SOFTWARE_RASTERIZER_SSE2
+			const __m128 zero = _mm_setzero_ps();
+			const __m128 laneCenters = _mm_setr_ps(0.5f, 1.5f, 2.5f, 3.5f);
+			__m128 edgeA[3];
+			__m128 topLeft[3];
+			for (int i = 0; i < 3; i++)
+			{
+				edgeA[i] = _mm_set1_ps(triangle.edgeA[i]);
+				topLeft[i] = _mm_castsi128_ps(_mm_set1_epi32(triangle.bTopLeft[i] ? -1 : 0));
+			}
+
+			for (int y = y0; y <= y1; y++)
+			{
+				float centerY = y + 0.5f;
+				__m128 rowStart[3];
+				for (int i = 0; i < 3; i++)
+				{
+					rowStart[i] = _mm_set1_ps(triangle.edgeB[i] * centerY + triangle.edgeC[i]);
+				}
+
+				for (int x = x0; x <= x1; x += 4)
+				{
+					__m128 centerX = _mm_add_ps(_mm_set1_ps((float)x), laneCenters);
+					__m128 edges[3];
+					__m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+					for (int i = 0; i < 3; i++)
+					{
+						edges[i] = _mm_add_ps(_mm_mul_ps(edgeA[i], centerX), rowStart[i]);
+						// pixels on an edge belong to top and left edges only
+						__m128 covered = _mm_or_ps(
+							_mm_cmpgt_ps(edges[i], zero),
+							_mm_and_ps(_mm_cmpeq_ps(edges[i], zero), topLeft[i]));
+						inside = _mm_and_ps(inside, covered);
+					}
+
+					int mask = _mm_movemask_ps(inside);
+					// lanes past the end of the span
+					if (x1 - x < 3)
+					{
+						mask &= (1 << (x1 - x + 1)) - 1;
+					}
+					if (mask == 0)
+					{
+						continue;
+					}
+
+					float laneEdges[3][4];
+					for (int i = 0; i < 3; i++)
+					{
+						_mm_storeu_ps(laneEdges[i], edges[i]);
+					}
+					for (int lane = 0; lane < 4; lane++)
+					{
+						if (mask & (1 << lane))
+						{
+							float pixelEdges[3] = { laneEdges[0][lane], laneEdges[1][lane], laneEdges[2][lane] };
+							int pixel = (y - tileY0) * TILE_SIZE + (x + lane - tileX0);
+							if (ShadePixel(triangle, pixelEdges, &colors[pixel * 4], &depths[pixel]))
+							{
+								fragmentCount++;
+							}
+						}
+					}
+				}
+			}
+#else
+			for (int y = y0; y <= y1; y++)
+			{
+				float centerY = y + 0.5f;
+				for (int x = x0; x <= x1; x++)
+				{
+					float centerX = x + 0.5f;
+					float pixelEdges[3];
+					bool bInside = true;
+					for (int i = 0; i < 3; i++)
+					{
+						pixelEdges[i] = triangle.edgeA[i] * centerX + (triangle.edgeB[i] * centerY + triangle.edgeC[i]);
+						bInside = bInside && ((pixelEdges[i] > 0.0f) || ((pixelEdges[i] == 0.0f) && triangle.bTopLeft[i]));
+					}
+					if (bInside)
+					{
+						int pixel = (y - tileY0) * TILE_SIZE + (x - tileX0);
+						if (ShadePixel(triangle, pixelEdges, &colors[pixel * 4], &depths[pixel]))
+						{
+							fragmentCount++;
+						}
+					}
+				}
+			}
+#endif
+		}
+	}
+	m_tileFragments[tileIndex] = fragmentCount;
+
+	// copy the tile out as BGRA
+	for (int y = tileY0; y <= tileY1; y++)
+	{
+		for (int x = tileX0; x <= tileX1; x++)
+		{
+			const float* color = &colors[((y - tileY0) * TILE_SIZE + (x - tileX0)) * 4];
+			unsigned char* output = &m_pixels[((size_t)y * m_width + x) * 4];
+			for (int channel = 0; channel < 4; channel++)
+			{
+				float value = std::min(std::max(color[channel], 0.0f), 1.0f);
+				// BGRA - swap red and blue
+				int target = (channel == 3) ? 3 : 2 - channel;
+				output[target] = (unsigned char)(value * 255.0f + 0.5f);
+			}
+		}
+	}
+}
+
+/***********************************************************
+ *  Interpolate()
+ *
+ *  This method is used for getting the perspective correct
+ *  attributes at a point of a triangle from its screen
+ *  space barycentric weights.
+ ***********************************************************/
+void SoftwareRasterizer::Interpolate(const TRIANGLE& triangle, const float weights[3], float attributes[ATTRIBUTE_COUNT])
+{
+	float inverseW = weights[0] * triangle.inverseW[0] + weights[1] * triangle.inverseW[1] + weights[2] * triangle.inverseW[2];
+	float w = 1.0f / inverseW;
+	for (int k = 0; k < ATTRIBUTE_COUNT; k++)
+	{
+		attributes[k] = (weights[0] * triangle.attributes[0][k] +
+			weights[1] * triangle.attributes[1][k] +
+			weights[2] * triangle.attributes[2][k]) * w;
+	}
+}
+
+/***********************************************************
+ *  ShadePixel()
+ *
+ *  This method is used for running fragmentShader.glsl for
+ *  one covered pixel - depth test, shading and blending with
+ *  the source alpha, like the GL state of the scene.  It is
+ *  false when nothing was drawn.
+ ***********************************************************/
+bool SoftwareRasterizer::ShadePixel(const TRIANGLE& triangle, const float edges[3], float* pColor, float* pDepth) const
+{
+	const DRAW_CALL& draw = m_draws[triangle.drawIndex];
+
+	float weights[3];
+	for (int i = 0; i < 3; i++)
+	{
+		weights[i] = edges[i] * triangle.inverseArea;
+	}
+
+	float depth = weights[0] * triangle.depth[0] + weights[1] * triangle.depth[1] + weights[2] * triangle.depth[2];
+	if (draw.bTextSDF)
+	{
+		depth -= TEXT_DEPTH_BIAS;
+	}
+	if ((depth < 0.0f) || (depth > 1.0f) || (depth >= *pDepth))
+	{
+		return(false);
+	}
+
+	float attributes[ATTRIBUTE_COUNT];
+	Interpolate(triangle, weights, attributes);
+	glm::vec3 position(attributes[0], attributes[1], attributes[2]);
+	glm::vec3 normal(attributes[3], attributes[4], attributes[5]);
+	float u = attributes[6];
+	float v = attributes[7];
+
+	const TEXTURE* pTexture = (draw.textureIndex >= 0) ? &m_textures[draw.textureIndex] : NULL;
+	bool bUseTexture = (NULL != pTexture) && !draw.bTextSDF;
+	glm::vec4 baseObjectColor = draw.color;
+
+	// the glyph edge is where the distance field crosses 0.5,
+	// blended over the distance change to the next pixels
+	if (draw.bTextSDF && (NULL != pTexture))
+	{
+		float distance = SampleTexture(*pTexture, u, v).r - 0.5f;
+
+		float stepWeights[3];
+		float stepAttributes[ATTRIBUTE_COUNT];
+		for (int i = 0; i < 3; i++)
+		{
+			stepWeights[i] = weights[i] + triangle.edgeA[i] * triangle.inverseArea;
+		}
+		Interpolate(triangle, stepWeights, stepAttributes);
+		float distanceX = SampleTexture(*pTexture, stepAttributes[6], stepAttributes[7]).r - 0.5f;
+		for (int i = 0; i < 3; i++)
+		{
+			stepWeights[i] = weights[i] + triangle.edgeB[i] * triangle.inverseArea;
+		}
+		Interpolate(triangle, stepWeights, stepAttributes);
+		float distanceY = SampleTexture(*pTexture, stepAttributes[6], stepAttributes[7]).r - 0.5f;
+
+		float edgeWidth = std::max(std::fabs(distanceX - distance) + std::fabs(distanceY - distance), 0.0001f);
+		baseObjectColor.a *= Smoothstep(-edgeWidth, edgeWidth, distance);
+		if (baseObjectColor.a < 0.01f)
+		{
+			return(false);
+		}
+	}
+
+	glm::vec4 color;
+	if (draw.bUseLighting)
+	{
+		// the lit path of the shader does not apply the UV scale
+		glm::vec4 baseColor = bUseTexture ? SampleTexture(*pTexture, u, v) : baseObjectColor;
+		color = glm::vec4(CalcPhongLighting(draw.material, normal, position, glm::vec3(baseColor)), baseColor.a);
+	}
+	else if (bUseTexture)
+	{
+		color = SampleTexture(*pTexture, u * draw.uvScale.x, v * draw.uvScale.y);
+	}
+	else
+	{
+		color = baseObjectColor;
+	}
+
+	// GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA on all four channels
+	float alpha = color.a;
+	pColor[0] = color.r * alpha + pColor[0] * (1.0f - alpha);
+	pColor[1] = color.g * alpha + pColor[1] * (1.0f - alpha);
+	pColor[2] = color.b * alpha + pColor[2] * (1.0f - alpha);
+	pColor[3] = color.a * alpha + pColor[3] * (1.0f - alpha);
+
+	// text does not write the depth, so neighboring glyphs blend
+	if (!draw.bTextSDF)
+	{
+		*pDepth = depth;
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  SampleTexture()
+ *
+ *  This method is used for a bilinear lookup with repeat
+ *  wrapping, like the GL_LINEAR and GL_REPEAT textures of
+ *  the scene.  The four texels are blended as vectors.
+ ***********************************************************/
+glm::vec4 SoftwareRasterizer::SampleTexture(const TEXTURE& texture, float u, float v)
+{
+	if (!std::isfinite(u) || !std::isfinite(v))
+	{
+		u = 0.0f;
+		v = 0.0f;
+	}
+
+	// texel centers are at half texel offsets
+	float x = (u - std::floor(u)) * texture.width - 0.5f;
+	float y = (v - std::floor(v)) * texture.height - 0.5f;
+	float floorX = std::floor(x);
+	float floorY = std::floor(y);
+	float fractionX = x - floorX;
+	float fractionY = y - floorY;
+
+	int x0 = (int)floorX;
+	int y0 = (int)floorY;
+	if (x0 < 0) x0 += texture.width;
+	if (y0 < 0) y0 += texture.height;
+	if (x0 >= texture.width) x0 -= texture.width;
+	if (y0 >= texture.height) y0 -= texture.height;
+	int x1 = (x0 + 1 < texture.width) ? x0 + 1 : 0;
+	int y1 = (y0 + 1 < texture.height) ? y0 + 1 : 0;
+
+	const uint32_t* row0 = &texture.texels[(size_t)y0 * texture.width];
+	const uint32_t* row1 = &texture.texels[(size_t)y1 * texture.width];
+	uint32_t texels[4] = { row0[x0], row0[x1], row1[x0], row1[x1] };
+
+#ifdef SOFTWARE_RASTERIZER_SSE2
+	const __m128i zero = _mm_setzero_si128();
+	__m128 corners[4];
+	for (int i = 0; i < 4; i++)
+	{
+		__m128i bytes = _mm_cvtsi32_si128((int)texels[i]);
+		corners[i] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(_mm_unpacklo_epi8(bytes, zero), zero));
+	}
+	__m128 weightX = _mm_set1_ps(fractionX);
+	__m128 top = _mm_add_ps(corners[0], _mm_mul_ps(_mm_sub_ps(corners[1], corners[0]), weightX));
+	__m128 bottom = _mm_add_ps(corners[2], _mm_mul_ps(_mm_sub_ps(corners[3], corners[2]), weightX));
+	__m128 blended = _mm_add_ps(top, _mm_mul_ps(_mm_sub_ps(bottom, top), _mm_set1_ps(fractionY)));
+	blended = _mm_mul_ps(blended, _mm_set1_ps(1.0f / 255.0f));
+
+	float result[4];
+	_mm_storeu_ps(result, blended);
+	return(glm::vec4(result[0], result[1], result[2], result[3]));
+#else
+	glm::vec4 corners[4];
+	for (int i = 0; i < 4; i++)
+	{
+		corners[i] = glm::vec4(
+			(float)(texels[i] & 0xFF),
+			(float)((texels[i] >> 8) & 0xFF),
+			(float)((texels[i] >> 16) & 0xFF),
+			(float)(texels[i] >> 24));
+	}
+	glm::vec4 top = corners[0] + (corners[1] - corners[0]) * fractionX;
+	glm::vec4 bottom = corners[2] + (corners[3] - corners[2]) * fractionX;
+	return((top + (bottom - top) * fractionY) * (1.0f / 255.0f));
+#endif
+}
+
+/***********************************************************
+ *  CalcPhongLighting()
+ *
+ *  This method is used for the directional, point and spot
+ *  light terms of fragmentShader.glsl, summed up.
+ ***********************************************************/
+glm::vec3 SoftwareRasterizer::CalcPhongLighting(const MATERIAL& material, glm::vec3 normal, glm::vec3 position, glm::vec3 baseColor) const
+{
+	glm::vec3 result(0.0f);
+	glm::vec3 norm = glm::normalize(normal);
+	glm::vec3 viewDir = glm::normalize(m_viewPosition - position);
+
+	const DIRECTIONAL_LIGHT& directional = m_lights.directionalLight;
+	if (directional.bActive)
+	{
+		glm::vec3 lightDirection = glm::normalize(-directional.direction);
+		float diff = std::max(glm::dot(norm, lightDirection), 0.0f);
+		glm::vec3 reflectDir = Reflect(-lightDirection, norm);
+		float spec = std::pow(std::max(glm::dot(viewDir, reflectDir), 0.0f), material.shininess);
+		result += directional.ambient * baseColor;
+		result += directional.diffuse * diff * material.diffuseColor * baseColor;
+		result += directional.specular * spec * material.specularColor * baseColor;
+	}
+
+	for (int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+	{
+		const POINT_LIGHT& light = m_lights.pointLights[i];
+		if (!light.bActive)
+		{
+			continue;
+		}
+		glm::vec3 lightDir = glm::normalize(light.position - position);
+		float diff = std::max(glm::dot(norm, lightDir), 0.0f);
+		glm::vec3 reflectDir = Reflect(-lightDir, norm);
+		float spec = std::pow(std::max(glm::dot(viewDir, reflectDir), 0.0f), material.shininess);
+		// the point light highlight is not tinted by the base color
+		result += light.ambient * baseColor;
+		result += light.diffuse * diff * material.diffuseColor * baseColor;
+		result += light.specular * spec * material.specularColor;
+	}
+
+	const SPOT_LIGHT& spot = m_lights.spotLight;
+	if (spot.bActive)
+	{
+		glm::vec3 lightDir = glm::normalize(spot.position - position);
+		float diff = std::max(glm::dot(norm, lightDir), 0.0f);
+		glm::vec3 reflectDir = Reflect(-lightDir, norm);
+		float spec = std::pow(std::max(glm::dot(viewDir, reflectDir), 0.0f), material.shininess);
+		float distance = glm::length(spot.position - position);
+		float attenuation = 1.0f / (spot.constant + spot.linear * distance + spot.quadratic * (distance * distance));
+		float theta = glm::dot(lightDir, glm::normalize(-spot.direction));
+		float epsilon = spot.cutOff - spot.outerCutOff;
+		float intensity = std::min(std::max((theta - spot.outerCutOff) / epsilon, 0.0f), 1.0f);
+		glm::vec3 spotColor = spot.ambient * baseColor +
+			spot.diffuse * diff * material.diffuseColor * baseColor +
+			spot.specular * spec * material.specularColor * baseColor;
+		result += spotColor * (attenuation * intensity);
+	}
+
+	return(result);
+}
@@ -0,0 +1,171 @@
+///////////////////////////////////////////////////////////////////////////////
+// softwarerasterizer.h
+// ============
+// render the scene draws on the CPU, in screen tiles spread over all cores
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneLights.h"
+#include "ShapeGeometry.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+/***********************************************************
+ *  SoftwareRasterizer
+ *
+ *  This class renders the draws SceneManager makes without
+ *  a GPU.  Every draw is transformed and clipped, then its
+ *  triangles are sorted into screen tiles, and the tiles are
+ *  rasterized and shaded independently on all CPU cores -
+ *  the shading follows fragmentShader.glsl.  Within a tile
+ *  the triangles are always drawn in submission order, so
+ *  the image does not depend on the number of threads.
+ ***********************************************************/
+class SoftwareRasterizer
+{
+public:
+	// constructor
+	SoftwareRasterizer();
+	// destructor
+	~SoftwareRasterizer();
+
+	// material values of fragmentShader.glsl
+	struct MATERIAL
+	{
+		glm::vec3 diffuseColor;
+		glm::vec3 specularColor;
+		float shininess;
+		// metallic-roughness values, used by the path tracer
+		float metallic;
+		float roughness;
+	};
+
+	// one mesh drawn with the shader settings for it
+	struct DRAW_CALL
+	{
+		const ShapeGeometry::MESH* pMesh;
+		glm::mat4 model;
+		glm::vec4 color;
+		// texture returned by AddTexture(), -1 for the color
+		int textureIndex;
+		glm::vec2 uvScale;
+		MATERIAL material;
+		// shade with the lights, or draw the color as it is
+		bool bUseLighting;
+		// the texture is a glyph distance field, the text is
+		// drawn in the color and does not write the depth
+		bool bTextSDF;
+	};
+
+	// set the image size, and clear the draws
+	void SetTarget(int width, int height);
+	// set the view, projection and camera position
+	void SetCamera(const glm::mat4& view, const glm::mat4& projection, const glm::vec3& viewPosition);
+	// set the lights of the draws using lighting
+	void SetLights(const SCENE_LIGHTS& lights);
+	// copy an image with 1, 3 or 4 channels, bottom row first
+	int AddTexture(int width, int height, int colorChannels, const unsigned char* pixels);
+	// free the copy of an image - the index is not reused
+	void RemoveTexture(int textureIndex);
+	// queue a draw - the mesh has to stay valid until Render()
+	void Submit(const DRAW_CALL& draw);
+	// draw everything that was submitted, on all cores when
+	// the thread count is 0
+	void Render(int threadCount = 0);
+	// forget the submitted draws, keeping the textures
+	void ClearDraws();
+
+	// rendered image as BGRA, bottom row first
+	const std::vector<unsigned char>& GetPixels() const { return(m_pixels); }
+	int GetWidth() const { return(m_width); }
+	int GetHeight() const { return(m_height); }
+	// triangles that reached the tiles in the last Render()
+	size_t GetTriangleCount() const { return(m_triangleCount); }
+	// fragments that passed the depth test and were shaded in
+	// the last Render() - the same for every thread count
+	size_t GetFragmentCount() const { return(m_fragmentCount); }
+
+private:
+	// position, normal and texture coordinate of a vertex
+	static const int ATTRIBUTE_COUNT = 8;
+
+	struct TEXTURE
+	{
+		int width;
+		int height;
+		// RGBA, red in the lowest byte
+		std::vector<uint32_t> texels;
+	};
+
+	// vertex after the vertex stage
+	struct CLIP_VERTEX
+	{
+		glm::vec4 position;
+		float attributes[ATTRIBUTE_COUNT];
+	};
+
+	// triangle set up for rasterizing - edge i is the one
+	// across from vertex i, positive inside the triangle
+	struct TRIANGLE
+	{
+		float edgeA[3];
+		float edgeB[3];
+		float edgeC[3];
+		bool bTopLeft[3];
+		float inverseArea;
+		float depth[3];
+		float inverseW[3];
+		// attributes divided by w, for perspective correction
+		float attributes[3][ATTRIBUTE_COUNT];
+		// covered pixels
+		int minX;
+		int minY;
+		int maxX;
+		int maxY;
+		uint32_t drawIndex;
+	};
+
+	// image and camera
+	int m_width;
+	int m_height;
+	glm::mat4 m_viewProjection;
+	glm::vec3 m_viewPosition;
+	SCENE_LIGHTS m_lights;
+	// textures and the draws queued for the next image
+	std::vector<TEXTURE> m_textures;
+	std::vector<DRAW_CALL> m_draws;
+	// set up triangles of the last image, and the triangle
+	// indices of each tile, binned in fixed size chunks
+	std::vector<TRIANGLE> m_triangles;
+	int m_tilesX;
+	int m_tilesY;
+	std::vector<std::vector<std::vector<uint32_t> > > m_chunkBins;
+	size_t m_triangleCount;
+	// fragments shaded by each tile, and all of them
+	std::vector<size_t> m_tileFragments;
+	size_t m_fragmentCount;
+	// BGRA output
+	std::vector<unsigned char> m_pixels;
+
+	// transform, clip and set up the triangles of one draw
+	void ProcessDraw(uint32_t drawIndex, std::vector<TRIANGLE>& triangles) const;
+	// clip a triangle to the near plane and the guard band
+	static int ClipTriangle(const CLIP_VERTEX input[3], CLIP_VERTEX output[9]);
+	// set up the edge functions of a triangle in pixels
+	bool SetupTriangle(const CLIP_VERTEX& v0, const CLIP_VERTEX& v1, const CLIP_VERTEX& v2, uint32_t drawIndex, TRIANGLE& triangle) const;
+	// rasterize every triangle binned into one tile
+	void RenderTile(int tileIndex);
+	// shade a covered pixel and blend it into the tile, false
+	// when it fails the depth test or is discarded
+	bool ShadePixel(const TRIANGLE& triangle, const float edges[3], float* pColor, float* pDepth) const;
+	// interpolate the attributes at the barycentric coordinates
+	static void Interpolate(const TRIANGLE& triangle, const float weights[3], float attributes[ATTRIBUTE_COUNT]);
+	// bilinear texture lookup with repeat wrapping
+	static glm::vec4 SampleTexture(const TEXTURE& texture, float u, float v);
+	// lighting of fragmentShader.glsl
+	glm::vec3 CalcPhongLighting(const MATERIAL& material, glm::vec3 normal, glm::vec3 position, glm::vec3 baseColor) const;
+};
@@ -0,0 +1,751 @@
+///////////////////////////////////////////////////////////////////////////////
+// softwarerenderdevice.cpp
+// ============
+// run the submitted command lists on the CPU with the software rasterizer
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SoftwareRenderDevice.h"
+#include "ObjectBuffer.h"
+#include "PathTracer.h"
+#include "Profiler.h"
+
+#include <glm/gtc/type_ptr.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+// declaration of global variables
+namespace
+{
+	// the alignment the OpenGL device usually reports, so the
+	// object buffers are laid out the same way
+	const size_t UNIFORM_BUFFER_ALIGNMENT = 256;
+	// floats of a vertex in a vertex buffer - position, normal
+	// and texture coordinate
+	const size_t VERTEX_FLOATS = 8;
+	// name of the uniform block holding the object values
+	const char* g_ObjectBlockName = "ObjectBlock";
+}
+
+/***********************************************************
+ *  SoftwareRenderDevice()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SoftwareRenderDevice::SoftwareRenderDevice(int windowWidth, int windowHeight)
+{
+	m_windowWidth = windowWidth;
+	m_windowHeight = windowHeight;
+	m_nextHandle = 1;
+	m_objectBlockBinding = 0;
+
+	// the defaults of the shader uniforms
+	m_state.model = glm::mat4(1.0f);
+	m_state.view = glm::mat4(1.0f);
+	m_state.projection = glm::mat4(1.0f);
+	m_state.viewPosition = glm::vec3(0.0f);
+	m_state.objectColor = glm::vec4(1.0f);
+	m_state.uvScale = glm::vec2(1.0f);
+	m_state.material.diffuseColor = glm::vec3(0.0f);
+	m_state.material.specularColor = glm::vec3(0.0f);
+	m_state.material.shininess = 0.0f;
+	m_state.material.metallic = 0.0f;
+	m_state.material.roughness = 0.0f;
+	m_state.textureSlot = 0;
+	m_state.bUseTexture = false;
+	m_state.bUseLighting = false;
+	m_state.bUseObjectBlock = false;
+	m_state.bUseTextSDF = false;
+	m_lights = SCENE_LIGHTS();
+
+	m_currentTarget = 0;
+	m_targetWidth = windowWidth;
+	m_targetHeight = windowHeight;
+	m_imageTarget = 0;
+	m_bImageStarted = false;
+	m_bImageRendered = false;
+	m_bCameraSet = false;
+	m_imageView = glm::mat4(1.0f);
+	m_imageProjection = glm::mat4(1.0f);
+	m_imageViewPosition = glm::vec3(0.0f);
+}
+
+/***********************************************************
+ *  ~SoftwareRenderDevice()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SoftwareRenderDevice::~SoftwareRenderDevice()
+{
+}
+
+/***********************************************************
+ *  CreateBuffer()
+ *
+ *  This method is used for creating a buffer in main memory.
+ ***********************************************************/
+RENDER_BUFFER SoftwareRenderDevice::CreateBuffer(const BUFFER_DESC& desc, const void* data)
+{
+	uint32_t handle = m_nextHandle++;
+	std::vector<unsigned char>& buffer = m_buffers[handle];
+	buffer.assign(desc.size, 0);
+	if ((NULL != data) && (desc.size > 0))
+	{
+		memcpy(buffer.data(), data, desc.size);
+	}
+
+	return(handle);
+}
+
+/***********************************************************
+ *  UpdateBuffer()
+ *
+ *  This method is used for overwriting a range of a buffer.
+ ***********************************************************/
+void SoftwareRenderDevice::UpdateBuffer(RENDER_BUFFER buffer, size_t offset, size_t size, const void* data)
+{
+	std::unordered_map<uint32_t, std::vector<unsigned char> >::iterator it = m_buffers.find(buffer);
+	if ((it == m_buffers.end()) || (offset + size > it->second.size()))
+	{
+		return;
+	}
+
+	memcpy(it->second.data() + offset, data, size);
+}
+
+/***********************************************************
+ *  CopyBuffer()
+ *
+ *  This method is used for copying the start of one buffer
+ *  into another.
+ ***********************************************************/
+void SoftwareRenderDevice::CopyBuffer(RENDER_BUFFER source, RENDER_BUFFER destination, size_t size)
+{
+	std::unordered_map<uint32_t, std::vector<unsigned char> >::iterator sourceIt = m_buffers.find(source);
+	std::unordered_map<uint32_t, std::vector<unsigned char> >::iterator destinationIt = m_buffers.find(destination);
+	if ((sourceIt == m_buffers.end()) || (destinationIt == m_buffers.end()))
+	{
+		return;
+	}
+
+	size = std::min(size, std::min(sourceIt->second.size(), destinationIt->second.size()));
+	memcpy(destinationIt->second.data(), sourceIt->second.data(), size);
+}
+
+/***********************************************************
+ *  DestroyBuffer()
+ *
+ *  This method is used for freeing a buffer.
+ ***********************************************************/
+void SoftwareRenderDevice::DestroyBuffer(RENDER_BUFFER buffer)
+{
+	m_buffers.erase(buffer);
+}
+
+/***********************************************************
+ *  GetUniformBufferAlignment()
+ *
+ *  This method is used for getting the alignment of uniform
+ *  buffer ranges.
+ ***********************************************************/
+size_t SoftwareRenderDevice::GetUniformBufferAlignment() const
+{
+	return(UNIFORM_BUFFER_ALIGNMENT);
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for creating a texture.  The 8 bit 2D
+ *  textures are copied into the rasterizer; the float and
+ *  cube map textures of the PBR lookups only get a handle,
+ *  since the CPU renderers do not sample them.
+ ***********************************************************/
+RENDER_TEXTURE SoftwareRenderDevice::CreateTexture(const TEXTURE_DESC& desc, const void* const* data)
+{
+	uint32_t handle = m_nextHandle++;
+	TEXTURE_OBJECT& texture = m_textures[handle];
+	texture.width = desc.width;
+	texture.height = desc.height;
+	texture.colorChannels = 0;
+	texture.rasterizerIndex = -1;
+
+	if (desc.type == TEXTURE_2D)
+	{
+		switch (desc.format)
+		{
+		case FORMAT_R8:
+			texture.colorChannels = 1;
+			break;
+		case FORMAT_RGB8:
+			texture.colorChannels = 3;
+			break;
+		case FORMAT_RGBA8:
+			texture.colorChannels = 4;
+			break;
+		}
+	}
+
+	// the first level of the first face is the full image
+	if ((texture.colorChannels > 0) && (NULL != data) && (NULL != data[0]))
+	{
+		const unsigned char* pixels = (const unsigned char*)data[0];
+		texture.pixels.assign(pixels, pixels + (size_t)desc.width * desc.height * texture.colorChannels);
+		texture.rasterizerIndex = m_rasterizer.AddTexture(desc.width, desc.height, texture.colorChannels, pixels);
+	}
+
+	return(handle);
+}
+
+/***********************************************************
+ *  DestroyTexture()
+ *
+ *  This method is used for freeing a texture.
+ ***********************************************************/
+void SoftwareRenderDevice::DestroyTexture(RENDER_TEXTURE texture)
+{
+	std::unordered_map<uint32_t, TEXTURE_OBJECT>::iterator it = m_textures.find(texture);
+	if (it == m_textures.end())
+	{
+		return;
+	}
+
+	m_rasterizer.RemoveTexture(it->second.rasterizerIndex);
+	m_textures.erase(it);
+}
+
+/***********************************************************
+ *  CreateRenderTarget()
+ *
+ *  This method is used for creating an offscreen target.
+ ***********************************************************/
+RENDER_TARGET SoftwareRenderDevice::CreateRenderTarget(int width, int height)
+{
+	uint32_t handle = m_nextHandle++;
+	m_renderTargets[handle] = glm::ivec2(width, height);
+	return(handle);
+}
+
+/***********************************************************
+ *  ReadPixels()
+ *
+ *  This method is used for reading back the image of a
+ *  target, rendering it first if its draws are not done yet.
+ *  A target that was not drawn into is black.
+ ***********************************************************/
+bool SoftwareRenderDevice::ReadPixels(RENDER_TARGET target, int width, int height, void* pixels)
+{
+	if ((target != 0) && (m_renderTargets.find(target) == m_renderTargets.end()))
+	{
+		return(false);
+	}
+
+	memset(pixels, 0, (size_t)width * height * 4);
+	if (!m_bImageStarted || (target != m_imageTarget))
+	{
+		return(true);
+	}
+
+	RenderImage();
+
+	// BGRA, bottom row first, like glReadPixels
+	const std::vector<unsigned char>& image = m_rasterizer.GetPixels();
+	int rowWidth = std::min(width, m_rasterizer.GetWidth());
+	int rowCount = std::min(height, m_rasterizer.GetHeight());
+	for (int y = 0; y < rowCount; y++)
+	{
+		memcpy((unsigned char*)pixels + (size_t)y * width * 4,
+			&image[(size_t)y * m_rasterizer.GetWidth() * 4],
+			(size_t)rowWidth * 4);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyRenderTarget()
+ *
+ *  This method is used for freeing an offscreen target.
+ ***********************************************************/
+void SoftwareRenderDevice::DestroyRenderTarget(RENDER_TARGET target)
+{
+	m_renderTargets.erase(target);
+}
+
+/***********************************************************
+ *  GetWindowSize()
+ *
+ *  This method is used for getting the size of the window
+ *  the device stands in for.
+ ***********************************************************/
+void SoftwareRenderDevice::GetWindowSize(int& width, int& height) const
+{
+	width = m_windowWidth;
+	height = m_windowHeight;
+}
+
+/***********************************************************
+ *  CreatePipeline()
+ *
+ *  This method is used for creating a pipeline.  The
+ *  rasterizer always blends, and text is told apart by the
+ *  shader switch, so only the object block binding is kept.
+ ***********************************************************/
+RENDER_PIPELINE SoftwareRenderDevice::CreatePipeline(const PIPELINE_DESC& desc)
+{
+	if ((NULL != desc.uniformBlockName) && (strcmp(desc.uniformBlockName, g_ObjectBlockName) == 0))
+	{
+		m_objectBlockBinding = desc.uniformBlockBinding;
+	}
+
+	return(m_nextHandle++);
+}
+
+/***********************************************************
+ *  DestroyPipeline()
+ *
+ *  This method is used for freeing a pipeline.
+ ***********************************************************/
+void SoftwareRenderDevice::DestroyPipeline(RENDER_PIPELINE /*pipeline*/)
+{
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for running the commands of a list in
+ *  the order they were recorded.  The draws are collected
+ *  into the image, and rendered when it is read.
+ ***********************************************************/
+void SoftwareRenderDevice::Submit(const RenderCommandList& commands)
+{
+	PROFILE_SCOPE("SoftwareRenderDevice::Submit");
+
+	for (size_t i = 0; i < commands.GetCommandCount(); i++)
+	{
+		const RenderCommandList::COMMAND& command = commands.GetCommand(i);
+		switch (command.type)
+		{
+		case RenderCommandList::COMMAND_SET_RENDER_TARGET:
+		{
+			m_currentTarget = command.handle;
+			m_targetWidth = (int)command.arguments[0];
+			m_targetHeight = (int)command.arguments[1];
+			if ((m_targetWidth <= 0) || (m_targetHeight <= 0))
+			{
+				m_targetWidth = m_windowWidth;
+				m_targetHeight = m_windowHeight;
+			}
+			break;
+		}
+		case RenderCommandList::COMMAND_CLEAR:
+			BeginImage();
+			break;
+		case RenderCommandList::COMMAND_BIND_TEXTURE:
+		{
+			uint32_t slot = command.arguments[0];
+			if (slot >= m_boundTextures.size())
+			{
+				m_boundTextures.resize(slot + 1, 0);
+			}
+			m_boundTextures[slot] = command.handle;
+			break;
+		}
+		case RenderCommandList::COMMAND_BIND_UNIFORM_BUFFER:
+		{
+			uint32_t binding = command.arguments[0];
+			if (binding >= m_uniformBindings.size())
+			{
+				UNIFORM_BINDING unbound = { 0, 0 };
+				m_uniformBindings.resize(binding + 1, unbound);
+			}
+			m_uniformBindings[binding].buffer = command.handle;
+			m_uniformBindings[binding].offset = command.arguments[1];
+			break;
+		}
+		case RenderCommandList::COMMAND_SET_INT:
+		case RenderCommandList::COMMAND_SET_FLOAT:
+		case RenderCommandList::COMMAND_SET_VEC2:
+		case RenderCommandList::COMMAND_SET_VEC3:
+		case RenderCommandList::COMMAND_SET_VEC4:
+		case RenderCommandList::COMMAND_SET_MAT4:
+			SetUniform(commands, command);
+			break;
+		case RenderCommandList::COMMAND_DRAW_SHAPE:
+			AddDraw(&m_geometry.GetMesh(command.arguments[0], command.arguments[1]));
+			break;
+		case RenderCommandList::COMMAND_DRAW:
+		{
+			// the vertices are copied, since the buffer may be
+			// updated before the image is rendered
+			std::unordered_map<uint32_t, std::vector<unsigned char> >::const_iterator it = m_buffers.find(command.handle);
+			size_t firstVertex = command.arguments[0];
+			size_t vertexCount = command.arguments[1];
+			if ((it == m_buffers.end()) ||
+				((firstVertex + vertexCount) * VERTEX_FLOATS * sizeof(float) > it->second.size()))
+			{
+				break;
+			}
+
+			m_bufferMeshes.push_back(ShapeGeometry::MESH());
+			ShapeGeometry::MESH& mesh = m_bufferMeshes.back();
+			const float* vertices = (const float*)it->second.data() + firstVertex * VERTEX_FLOATS;
+			mesh.vertices.resize(vertexCount);
+			mesh.indices.resize(vertexCount);
+			for (size_t v = 0; v < vertexCount; v++)
+			{
+				const float* vertex = vertices + v * VERTEX_FLOATS;
+				mesh.vertices[v].position = glm::vec3(vertex[0], vertex[1], vertex[2]);
+				mesh.vertices[v].normal = glm::vec3(vertex[3], vertex[4], vertex[5]);
+				mesh.vertices[v].uv = glm::vec2(vertex[6], vertex[7]);
+				mesh.indices[v] = (uint32_t)v;
+			}
+			AddDraw(&mesh);
+			break;
+		}
+		}
+	}
+}
+
+/***********************************************************
+ *  BuildPathTracerScene()
+ *
+ *  This method is used for handing the last image to the
+ *  path tracer - its camera, lights, draws and the textures
+ *  they use - and building the hierarchy.  The size of the
+ *  path traced image has to be set first.
+ ***********************************************************/
+void SoftwareRenderDevice::BuildPathTracerScene(PathTracer& pathTracer)
+{
+	pathTracer.SetCamera(m_imageView, m_imageProjection, m_imageViewPosition);
+	pathTracer.SetLights(m_lights);
+
+	// the textures are added in the order they are first used
+	std::map<int, int> textureIndices;
+	for (size_t i = 0; i < m_draws.size(); i++)
+	{
+		PathTracer::DRAW_CALL draw = m_draws[i];
+		if (draw.textureIndex >= 0)
+		{
+			std::map<int, int>::const_iterator it = textureIndices.find(draw.textureIndex);
+			if (it == textureIndices.end())
+			{
+				std::unordered_map<uint32_t, TEXTURE_OBJECT>::const_iterator textureIt = m_textures.begin();
+				while ((textureIt != m_textures.end()) && (textureIt->second.rasterizerIndex != draw.textureIndex))
+				{
+					textureIt++;
+				}
+				int pathTracerIndex = -1;
+				if (textureIt != m_textures.end())
+				{
+					const TEXTURE_OBJECT& texture = textureIt->second;
+					pathTracerIndex = pathTracer.AddTexture(texture.width, texture.height, texture.colorChannels, texture.pixels.data());
+				}
+				it = textureIndices.insert(std::make_pair(draw.textureIndex, pathTracerIndex)).first;
+			}
+			draw.textureIndex = it->second;
+		}
+		pathTracer.Submit(draw);
+	}
+
+	pathTracer.BuildScene();
+}
+
+/***********************************************************
+ *  BeginImage()
+ *
+ *  This method is used for starting a new image in the
+ *  current render target, forgetting the draws of the last.
+ ***********************************************************/
+void SoftwareRenderDevice::BeginImage()
+{
+	m_imageTarget = m_currentTarget;
+	m_bImageStarted = true;
+	m_bImageRendered = false;
+	m_bCameraSet = false;
+	m_draws.clear();
+	m_bufferMeshes.clear();
+	m_rasterizer.SetTarget(m_targetWidth, m_targetHeight);
+}
+
+/***********************************************************
+ *  SetUniform()
+ *
+ *  This method is used for keeping the value of a uniform
+ *  that changes how the draws look.  The names are the ones
+ *  of the shaders; the PBR lookups are left out.
+ ***********************************************************/
+void SoftwareRenderDevice::SetUniform(const RenderCommandList& commands, const RenderCommandList::COMMAND& command)
+{
+	const char* name = commands.GetName(command);
+	const float* values = command.floatValues;
+	bool bValue = (command.intValue != 0);
+
+	if (strcmp(name, "model") == 0)
+	{
+		m_state.model = glm::make_mat4(values);
+	}
+	else if (strcmp(name, "view") == 0)
+	{
+		m_state.view = glm::make_mat4(values);
+	}
+	else if (strcmp(name, "projection") == 0)
+	{
+		m_state.projection = glm::make_mat4(values);
+	}
+	else if (strcmp(name, "viewPosition") == 0)
+	{
+		m_state.viewPosition = glm::make_vec3(values);
+	}
+	else if (strcmp(name, "objectColor") == 0)
+	{
+		m_state.objectColor = glm::make_vec4(values);
+	}
+	else if (strcmp(name, "UVscale") == 0)
+	{
+		m_state.uvScale = glm::make_vec2(values);
+	}
+	else if (strcmp(name, "objectTexture") == 0)
+	{
+		m_state.textureSlot = command.intValue;
+	}
+	else if (strcmp(name, "bUseTexture") == 0)
+	{
+		m_state.bUseTexture = bValue;
+	}
+	else if (strcmp(name, "bUseLighting") == 0)
+	{
+		m_state.bUseLighting = bValue;
+	}
+	else if (strcmp(name, "bUseObjectBlock") == 0)
+	{
+		m_state.bUseObjectBlock = bValue;
+	}
+	else if (strcmp(name, "bUseTextSDF") == 0)
+	{
+		m_state.bUseTextSDF = bValue;
+	}
+	else if (strcmp(name, "material.diffuseColor") == 0)
+	{
+		m_state.material.diffuseColor = glm::make_vec3(values);
+	}
+	else if (strcmp(name, "material.specularColor") == 0)
+	{
+		m_state.material.specularColor = glm::make_vec3(values);
+	}
+	else if (strcmp(name, "material.shininess") == 0)
+	{
+		m_state.material.shininess = values[0];
+	}
+	else if (strcmp(name, "material.metallic") == 0)
+	{
+		m_state.material.metallic = values[0];
+	}
+	else if (strcmp(name, "material.roughness") == 0)
+	{
+		m_state.material.roughness = values[0];
+	}
+	else
+	{
+		SetLightUniform(name, command);
+	}
+}
+
+/***********************************************************
+ *  SetLightUniform()
+ *
+ *  This method is used for keeping the value of a member of
+ *  the directionalLight, pointLights[] or spotLight uniforms.
+ ***********************************************************/
+void SoftwareRenderDevice::SetLightUniform(const char* name, const RenderCommandList::COMMAND& command)
+{
+	const char* member = strchr(name, '.');
+	if (NULL == member)
+	{
+		return;
+	}
+	member++;
+
+	// the members the three kinds of lights have in common
+	glm::vec3* pPosition = NULL;
+	glm::vec3* pDirection = NULL;
+	glm::vec3* pAmbient = NULL;
+	glm::vec3* pDiffuse = NULL;
+	glm::vec3* pSpecular = NULL;
+	bool* pActive = NULL;
+	SPOT_LIGHT* pSpotLight = NULL;
+
+	if (strncmp(name, "directionalLight.", 17) == 0)
+	{
+		DIRECTIONAL_LIGHT& light = m_lights.directionalLight;
+		pDirection = &light.direction;
+		pAmbient = &light.ambient;
+		pDiffuse = &light.diffuse;
+		pSpecular = &light.specular;
+		pActive = &light.bActive;
+	}
+	else if (strncmp(name, "pointLights[", 12) == 0)
+	{
+		int index = atoi(name + 12);
+		if ((index < 0) || (index >= TOTAL_POINT_LIGHTS))
+		{
+			return;
+		}
+		POINT_LIGHT& light = m_lights.pointLights[index];
+		pPosition = &light.position;
+		pAmbient = &light.ambient;
+		pDiffuse = &light.diffuse;
+		pSpecular = &light.specular;
+		pActive = &light.bActive;
+	}
+	else if (strncmp(name, "spotLight.", 10) == 0)
+	{
+		pSpotLight = &m_lights.spotLight;
+		pPosition = &pSpotLight->position;
+		pDirection = &pSpotLight->direction;
+		pAmbient = &pSpotLight->ambient;
+		pDiffuse = &pSpotLight->diffuse;
+		pSpecular = &pSpotLight->specular;
+		pActive = &pSpotLight->bActive;
+	}
+	else
+	{
+		return;
+	}
+
+	glm::vec3 vector = glm::make_vec3(command.floatValues);
+	float value = command.floatValues[0];
+	if ((strcmp(member, "position") == 0) && (NULL != pPosition))
+	{
+		*pPosition = vector;
+	}
+	else if ((strcmp(member, "direction") == 0) && (NULL != pDirection))
+	{
+		*pDirection = vector;
+	}
+	else if (strcmp(member, "ambient") == 0)
+	{
+		*pAmbient = vector;
+	}
+	else if (strcmp(member, "diffuse") == 0)
+	{
+		*pDiffuse = vector;
+	}
+	else if (strcmp(member, "specular") == 0)
+	{
+		*pSpecular = vector;
+	}
+	else if (strcmp(member, "bActive") == 0)
+	{
+		*pActive = (command.intValue != 0);
+	}
+	else if (NULL != pSpotLight)
+	{
+		// the cone and falloff of the spot light
+		if (strcmp(member, "cutOff") == 0)
+		{
+			pSpotLight->cutOff = value;
+		}
+		else if (strcmp(member, "outerCutOff") == 0)
+		{
+			pSpotLight->outerCutOff = value;
+		}
+		else if (strcmp(member, "constant") == 0)
+		{
+			pSpotLight->constant = value;
+		}
+		else if (strcmp(member, "linear") == 0)
+		{
+			pSpotLight->linear = value;
+		}
+		else if (strcmp(member, "quadratic") == 0)
+		{
+			pSpotLight->quadratic = value;
+		}
+	}
+}
+
+/***********************************************************
+ *  AddDraw()
+ *
+ *  This method is used for adding a draw of a mesh to the
+ *  image, with the values the shaders would use for it.
+ ***********************************************************/
+void SoftwareRenderDevice::AddDraw(const ShapeGeometry::MESH* pMesh)
+{
+	if (!m_bImageStarted)
+	{
+		BeginImage();
+	}
+	if (!m_bCameraSet)
+	{
+		m_imageView = m_state.view;
+		m_imageProjection = m_state.projection;
+		m_imageViewPosition = m_state.viewPosition;
+		m_bCameraSet = true;
+	}
+
+	SoftwareRasterizer::DRAW_CALL draw;
+	draw.pMesh = pMesh;
+	draw.model = m_state.model;
+	draw.color = m_state.objectColor;
+	draw.uvScale = m_state.uvScale;
+	draw.material = m_state.material;
+	draw.bUseLighting = m_state.bUseLighting;
+	draw.bTextSDF = m_state.bUseTextSDF;
+
+	// scene file objects keep their values in the object block
+	if (m_state.bUseObjectBlock && (m_objectBlockBinding < m_uniformBindings.size()))
+	{
+		const UNIFORM_BINDING& binding = m_uniformBindings[m_objectBlockBinding];
+		std::unordered_map<uint32_t, std::vector<unsigned char> >::const_iterator it = m_buffers.find(binding.buffer);
+		if ((it != m_buffers.end()) && (binding.offset + sizeof(ObjectBuffer::OBJECT_DATA) <= it->second.size()))
+		{
+			const ObjectBuffer::OBJECT_DATA* pObject = (const ObjectBuffer::OBJECT_DATA*)&it->second[binding.offset];
+			draw.model = glm::make_mat4(pObject->model);
+			draw.color = glm::make_vec4(pObject->color);
+			draw.uvScale = glm::make_vec2(pObject->uvScale);
+		}
+	}
+
+	draw.textureIndex = -1;
+	if ((m_state.bUseTexture || m_state.bUseTextSDF) &&
+		(m_state.textureSlot >= 0) && (m_state.textureSlot < (int)m_boundTextures.size()))
+	{
+		std::unordered_map<uint32_t, TEXTURE_OBJECT>::const_iterator it = m_textures.find(m_boundTextures[m_state.textureSlot]);
+		if (it != m_textures.end())
+		{
+			draw.textureIndex = it->second.rasterizerIndex;
+		}
+	}
+
+	m_draws.push_back(draw);
+	m_bImageRendered = false;
+}
+
+/***********************************************************
+ *  RenderImage()
+ *
+ *  This method is used for rendering the draws of the image
+ *  on all cores, when they changed since the last time.
+ ***********************************************************/
+void SoftwareRenderDevice::RenderImage()
+{
+	if (m_bImageRendered)
+	{
+		return;
+	}
+
+	PROFILE_SCOPE("SoftwareRenderDevice::RenderImage");
+	m_rasterizer.SetCamera(m_imageView, m_imageProjection, m_imageViewPosition);
+	m_rasterizer.SetLights(m_lights);
+	m_rasterizer.ClearDraws();
+	for (size_t i = 0; i < m_draws.size(); i++)
+	{
+		m_rasterizer.Submit(m_draws[i]);
+	}
+	m_rasterizer.Render();
+	m_bImageRendered = true;
+}
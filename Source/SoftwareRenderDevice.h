@@ -0,0 +1,157 @@
+///////////////////////////////////////////////////////////////////////////////
+// softwarerenderdevice.h
+// ============
+// run the submitted command lists on the CPU with the software rasterizer
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "RenderDevice.h"
+#include "SceneLights.h"
+#include "ShapeGeometry.h"
+#include "SoftwareRasterizer.h"
+
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+class PathTracer;
+
+/***********************************************************
+ *  SoftwareRenderDevice
+ *
+ *  This class is a render device that draws without a GPU.
+ *  The submitted commands are run against the uniforms of
+ *  vertexShader.glsl and fragmentShader.glsl - every draw
+ *  takes the model matrix, color, texture, material and
+ *  lighting switches set before it, or the values of the
+ *  bound object block - and become draws of the software
+ *  rasterizer, so the scene code renders the same way it
+ *  does on the OpenGL device, built in layout included.
+ *
+ *  A Clear() starts a new image in the current render
+ *  target, and it is rendered when its pixels are read.  The
+ *  whole image is drawn from the camera of its first draw,
+ *  and always cleared to black.  The draws of the last image
+ *  can also be handed to the path tracer.
+ ***********************************************************/
+class SoftwareRenderDevice : public RenderDevice
+{
+public:
+	// constructor - the size of the window it stands in for
+	SoftwareRenderDevice(int windowWidth, int windowHeight);
+	// destructor
+	virtual ~SoftwareRenderDevice();
+
+	virtual RENDER_BUFFER CreateBuffer(const BUFFER_DESC& desc, const void* data);
+	virtual void UpdateBuffer(RENDER_BUFFER buffer, size_t offset, size_t size, const void* data);
+	virtual void CopyBuffer(RENDER_BUFFER source, RENDER_BUFFER destination, size_t size);
+	virtual void DestroyBuffer(RENDER_BUFFER buffer);
+	virtual size_t GetUniformBufferAlignment() const;
+
+	virtual RENDER_TEXTURE CreateTexture(const TEXTURE_DESC& desc, const void* const* data);
+	virtual void DestroyTexture(RENDER_TEXTURE texture);
+
+	virtual RENDER_TARGET CreateRenderTarget(int width, int height);
+	virtual bool ReadPixels(RENDER_TARGET target, int width, int height, void* pixels);
+	virtual void DestroyRenderTarget(RENDER_TARGET target);
+	virtual void GetWindowSize(int& width, int& height) const;
+
+	virtual RENDER_PIPELINE CreatePipeline(const PIPELINE_DESC& desc);
+	virtual void DestroyPipeline(RENDER_PIPELINE pipeline);
+
+	virtual void Submit(const RenderCommandList& commands);
+
+	// hand the draws, textures and lights of the last image to
+	// the path tracer and build its hierarchy
+	void BuildPathTracerScene(PathTracer& pathTracer);
+	// draws, triangles and shaded fragments of the last image
+	// rendered
+	size_t GetDrawCount() const { return(m_draws.size()); }
+	size_t GetTriangleCount() const { return(m_rasterizer.GetTriangleCount()); }
+	size_t GetFragmentCount() const { return(m_rasterizer.GetFragmentCount()); }
+
+private:
+	// texture with the image it was created from, for the
+	// path tracer - only the 8 bit 2D formats can be drawn
+	struct TEXTURE_OBJECT
+	{
+		int width;
+		int height;
+		int colorChannels;
+		std::vector<unsigned char> pixels;
+		// index in the rasterizer, -1 when it is not drawn
+		int rasterizerIndex;
+	};
+
+	// range of a uniform buffer bound to a binding point
+	struct UNIFORM_BINDING
+	{
+		RENDER_BUFFER buffer;
+		size_t offset;
+	};
+
+	// the uniforms of the shaders that change how a draw looks
+	struct SHADER_STATE
+	{
+		glm::mat4 model;
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec3 viewPosition;
+		glm::vec4 objectColor;
+		glm::vec2 uvScale;
+		SoftwareRasterizer::MATERIAL material;
+		int textureSlot;
+		bool bUseTexture;
+		bool bUseLighting;
+		bool bUseObjectBlock;
+		bool bUseTextSDF;
+	};
+
+	int m_windowWidth;
+	int m_windowHeight;
+	// handle of the next created object, of any type
+	uint32_t m_nextHandle;
+	std::unordered_map<uint32_t, std::vector<unsigned char> > m_buffers;
+	std::unordered_map<uint32_t, TEXTURE_OBJECT> m_textures;
+	// size of each offscreen target
+	std::unordered_map<uint32_t, glm::ivec2> m_renderTargets;
+	// binding point of the object block, set by the pipeline
+	// that connects it
+	uint32_t m_objectBlockBinding;
+
+	// state set by the commands
+	SHADER_STATE m_state;
+	SCENE_LIGHTS m_lights;
+	std::vector<RENDER_TEXTURE> m_boundTextures;
+	std::vector<UNIFORM_BINDING> m_uniformBindings;
+	RENDER_TARGET m_currentTarget;
+	int m_targetWidth;
+	int m_targetHeight;
+
+	// the image being drawn - its target, camera and draws,
+	// and the triangles of the vertex buffer draws
+	RENDER_TARGET m_imageTarget;
+	bool m_bImageStarted;
+	bool m_bImageRendered;
+	bool m_bCameraSet;
+	glm::mat4 m_imageView;
+	glm::mat4 m_imageProjection;
+	glm::vec3 m_imageViewPosition;
+	std::vector<SoftwareRasterizer::DRAW_CALL> m_draws;
+	std::deque<ShapeGeometry::MESH> m_bufferMeshes;
+	ShapeGeometry m_geometry;
+	SoftwareRasterizer m_rasterizer;
+
+	// start a new image in the current render target
+	void BeginImage();
+	// keep the value of a uniform the shading depends on
+	void SetUniform(const RenderCommandList& commands, const RenderCommandList::COMMAND& command);
+	// keep the value of a light uniform
+	void SetLightUniform(const char* name, const RenderCommandList::COMMAND& command);
+	// add a draw of a mesh with the current state
+	void AddDraw(const ShapeGeometry::MESH* pMesh);
+	// render the image, if it was not since its last draw
+	void RenderImage();
+};
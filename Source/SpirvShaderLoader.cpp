@@ -0,0 +1,271 @@
+///////////////////////////////////////////////////////////////////////////////
+// spirvshaderloader.cpp
+// ============
+// load precompiled SPIR-V shader modules and specialize them into programs
+///////////////////////////////////////////////////////////////////////////////
+
+#include "SpirvShaderLoader.h"
+#include "Profiler.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// indices of the specialization constants in the fragment module
+	const GLuint ACTIVE_POINT_LIGHTS_ID = 0;
+	const GLuint TEXTURING_ENABLED_ID = 1;
+	const GLuint LIGHTING_ENABLED_ID = 2;
+
+	// explicit uniform locations from shaders/spirv/fragmentShader.frag
+	const GLint OBJECT_COLOR_LOCATION = 5;
+	const GLint UV_SCALE_LOCATION = 8;
+}
+
+/***********************************************************
+ *  SpirvShaderLoader()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+SpirvShaderLoader::SpirvShaderLoader()
+{
+}
+
+/***********************************************************
+ *  ~SpirvShaderLoader()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+SpirvShaderLoader::~SpirvShaderLoader()
+{
+	DestroyPrograms();
+}
+
+/***********************************************************
+ *  IsSupported()
+ *
+ *  This method is used for checking whether the current
+ *  OpenGL context can accept SPIR-V shader binaries.
+ ***********************************************************/
+bool SpirvShaderLoader::IsSupported()
+{
+	if ((GLEW_VERSION_4_6 == GL_FALSE) && (GLEW_ARB_gl_spirv == GL_FALSE))
+	{
+		return(false);
+	}
+
+	// the driver also has to list SPIR-V as a shader binary format
+	GLint formatCount = 0;
+	glGetIntegerv(GL_NUM_SHADER_BINARY_FORMATS, &formatCount);
+	if (formatCount <= 0)
+	{
+		return(false);
+	}
+
+	std::vector<GLint> formats(formatCount);
+	glGetIntegerv(GL_SHADER_BINARY_FORMATS, formats.data());
+	for (int i = 0; i < formatCount; i++)
+	{
+		if (formats[i] == GL_SHADER_BINARY_FORMAT_SPIR_V)
+		{
+			return(true);
+		}
+	}
+
+	return(false);
+}
+
+/***********************************************************
+ *  ReadModule()
+ *
+ *  This method is used for reading a SPIR-V module from disk.
+ *  Each file is only read once, no matter how many program
+ *  variants are specialized from it.
+ ***********************************************************/
+const std::vector<char>* SpirvShaderLoader::ReadModule(const char* filename)
+{
+	std::map<std::string, std::vector<char>>::iterator it = m_modules.find(filename);
+	if (it != m_modules.end())
+	{
+		return(&it->second);
+	}
+
+	std::ifstream moduleFile(filename, std::ios::binary | std::ios::ate);
+	if (!moduleFile.is_open())
+	{
+		return(NULL);
+	}
+
+	std::streamsize moduleSize = moduleFile.tellg();
+	// a SPIR-V module is a stream of 32-bit words
+	if ((moduleSize <= 0) || ((moduleSize % 4) != 0))
+	{
+		std::cout << "Invalid SPIR-V module:" << filename << std::endl;
+		return(NULL);
+	}
+
+	std::vector<char> moduleData((size_t)moduleSize);
+	moduleFile.seekg(0, std::ios::beg);
+	moduleFile.read(moduleData.data(), moduleSize);
+
+	return(&(m_modules[filename] = moduleData));
+}
+
+/***********************************************************
+ *  CreateSpecializedShader()
+ *
+ *  This method is used for creating a shader object from a
+ *  SPIR-V module and setting its specialization constants.
+ ***********************************************************/
+GLuint SpirvShaderLoader::CreateSpecializedShader(
+	GLenum shaderType,
+	const std::vector<char>& moduleData,
+	const SPECIALIZATION_INFO& specialization)
+{
+	GLuint shaderID = glCreateShader(shaderType);
+	glShaderBinary(
+		1,
+		&shaderID,
+		GL_SHADER_BINARY_FORMAT_SPIR_V,
+		moduleData.data(),
+		(GLsizei)moduleData.size());
+
+	// only the fragment module declares specialization constants,
+	// and naming a constant the module lacks fails specialization
+	GLuint constantIndices[3] = { ACTIVE_POINT_LIGHTS_ID, TEXTURING_ENABLED_ID, LIGHTING_ENABLED_ID };
+	GLuint constantValues[3] = {
+		specialization.activePointLights,
+		specialization.bTexturingEnabled ? 1u : 0u,
+		specialization.bLightingEnabled ? 1u : 0u };
+	GLuint constantCount = (shaderType == GL_FRAGMENT_SHADER) ? 3 : 0;
+
+	if (GLEW_VERSION_4_6 != GL_FALSE)
+	{
+		glSpecializeShader(shaderID, "main", constantCount, constantIndices, constantValues);
+	}
+	else
+	{
+		glSpecializeShaderARB(shaderID, "main", constantCount, constantIndices, constantValues);
+	}
+
+	GLint success = 0;
+	glGetShaderiv(shaderID, GL_COMPILE_STATUS, &success);
+	if (!success)
+	{
+		char infoLog[512];
+		glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
+		std::cout << "ERROR::SHADER::SPECIALIZATION_FAILED\n" << infoLog << std::endl;
+		glDeleteShader(shaderID);
+		return(0);
+	}
+
+	return(shaderID);
+}
+
+/***********************************************************
+ *  SetUniformDefaults()
+ *
+ *  This method is used for setting the uniform values that
+ *  are initialized in the GLSL source, since SPIR-V does not
+ *  allow uniform initializers.
+ ***********************************************************/
+void SpirvShaderLoader::SetUniformDefaults(GLuint programID)
+{
+	glProgramUniform4f(programID, OBJECT_COLOR_LOCATION, 1.0f, 1.0f, 1.0f, 1.0f);
+	glProgramUniform2f(programID, UV_SCALE_LOCATION, 1.0f, 1.0f);
+}
+
+/***********************************************************
+ *  LoadProgram()
+ *
+ *  This method is used for creating a linked shader program
+ *  from the SPIR-V modules with the passed in specialization.
+ *  Variants that were already created are returned directly.
+ ***********************************************************/
+GLuint SpirvShaderLoader::LoadProgram(
+	const char* vertexModulePath,
+	const char* fragmentModulePath,
+	const SPECIALIZATION_INFO& specialization)
+{
+	PROFILE_SCOPE("SpirvShaderLoader::LoadProgram");
+	std::ostringstream variantKey;
+	variantKey << vertexModulePath << "|" << fragmentModulePath << "|"
+		<< specialization.activePointLights << "|"
+		<< specialization.bTexturingEnabled << "|"
+		<< specialization.bLightingEnabled;
+
+	std::map<std::string, GLuint>::iterator it = m_programs.find(variantKey.str());
+	if (it != m_programs.end())
+	{
+		return(it->second);
+	}
+
+	const std::vector<char>* vertexModule = ReadModule(vertexModulePath);
+	const std::vector<char>* fragmentModule = ReadModule(fragmentModulePath);
+	if ((NULL == vertexModule) || (NULL == fragmentModule))
+	{
+		return(0);
+	}
+
+	GLuint vertexShader = CreateSpecializedShader(GL_VERTEX_SHADER, *vertexModule, specialization);
+	GLuint fragmentShader = CreateSpecializedShader(GL_FRAGMENT_SHADER, *fragmentModule, specialization);
+	if ((vertexShader == 0) || (fragmentShader == 0))
+	{
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		return(0);
+	}
+
+	GLuint programID = glCreateProgram();
+	glAttachShader(programID, vertexShader);
+	glAttachShader(programID, fragmentShader);
+	glLinkProgram(programID);
+
+	// the shader objects are no longer needed once linked
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+
+	GLint success = 0;
+	glGetProgramiv(programID, GL_LINK_STATUS, &success);
+	if (!success)
+	{
+		char infoLog[512];
+		glGetProgramInfoLog(programID, 512, NULL, infoLog);
+		std::cout << "ERROR::PROGRAM::SPIRV_LINKING_FAILED\n" << infoLog << std::endl;
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	// the rest of the code sets uniforms by name, which only works
+	// when the driver keeps the OpName debug info from the modules
+	if (glGetUniformLocation(programID, "model") == -1)
+	{
+		std::cout << "SPIR-V program does not expose uniform names, it will not be used" << std::endl;
+		glDeleteProgram(programID);
+		return(0);
+	}
+
+	SetUniformDefaults(programID);
+	m_programs[variantKey.str()] = programID;
+
+	return(programID);
+}
+
+/***********************************************************
+ *  DestroyPrograms()
+ *
+ *  This method is used for freeing all the created program
+ *  variants and the cached module binaries.
+ ***********************************************************/
+void SpirvShaderLoader::DestroyPrograms()
+{
+	std::map<std::string, GLuint>::iterator it;
+	for (it = m_programs.begin(); it != m_programs.end(); it++)
+	{
+		glDeleteProgram(it->second);
+	}
+	m_programs.clear();
+	m_modules.clear();
+}
@@ -0,0 +1,67 @@
+///////////////////////////////////////////////////////////////////////////////
+// spirvshaderloader.h
+// ============
+// load precompiled SPIR-V shader modules and specialize them into programs
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <GL/glew.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  SpirvShaderLoader
+ *
+ *  This class loads precompiled SPIR-V modules once and
+ *  creates shader program variants from them by setting the
+ *  specialization constants, so no GLSL is parsed at load.
+ ***********************************************************/
+class SpirvShaderLoader
+{
+public:
+	// constructor
+	SpirvShaderLoader();
+	// destructor
+	~SpirvShaderLoader();
+
+	// values for the specialization constants declared in
+	// shaders/spirv/fragmentShader.frag (constant_id 0 - 2)
+	struct SPECIALIZATION_INFO
+	{
+		GLuint activePointLights;
+		bool bTexturingEnabled;
+		bool bLightingEnabled;
+	};
+
+	// check whether the OpenGL context can consume SPIR-V
+	bool IsSupported();
+
+	// load the modules and return a linked program for the
+	// passed in specialization, or 0 if it could not be created
+	GLuint LoadProgram(
+		const char* vertexModulePath,
+		const char* fragmentModulePath,
+		const SPECIALIZATION_INFO& specialization);
+
+	// free all the program variants created by this loader
+	void DestroyPrograms();
+
+private:
+	// SPIR-V module binaries, read from disk once per file
+	std::map<std::string, std::vector<char>> m_modules;
+	// linked program variants, keyed by modules and constants
+	std::map<std::string, GLuint> m_programs;
+
+	// read a SPIR-V module from disk into the module cache
+	const std::vector<char>* ReadModule(const char* filename);
+	// create a shader object and specialize the module into it
+	GLuint CreateSpecializedShader(
+		GLenum shaderType,
+		const std::vector<char>& moduleData,
+		const SPECIALIZATION_INFO& specialization);
+	// set the uniform values that GLSL would have initialized
+	void SetUniformDefaults(GLuint programID);
+};
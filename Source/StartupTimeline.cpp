@@ -0,0 +1,170 @@
+///////////////////////////////////////////////////////////////////////////////
+// startuptimeline.cpp
+// ============
+// time the phases of the startup up to the first frame
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StartupTimeline.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	struct STARTUP_PHASE_RECORD
+	{
+		// the names of the phases it is in, and its own
+		std::string path;
+		int64_t start;
+		int64_t end;
+		// time of the phases directly inside it
+		int64_t childTime;
+	};
+
+	int64_t g_StartTime = 0;
+	bool g_bFinished = false;
+	std::vector<STARTUP_PHASE_RECORD> g_Phases;
+	// indices of the phases still open, innermost last
+	std::vector<size_t> g_OpenPhases;
+
+	const double NANOSECONDS_PER_MILLISECOND = 1000000.0;
+
+	bool CompareOwnTime(const STARTUP_PHASE_RECORD* a, const STARTUP_PHASE_RECORD* b)
+	{
+		return((a->end - a->start - a->childTime) > (b->end - b->start - b->childTime));
+	}
+}
+
+/***********************************************************
+ *  Start()
+ *
+ *  This method is used for marking the start of the process,
+ *  which the time to the first frame is measured from.
+ ***********************************************************/
+void StartupTimeline::Start()
+{
+	g_StartTime = Profiler::GetTime();
+}
+
+/***********************************************************
+ *  GetElapsedTime()
+ *
+ *  This method is used for getting the milliseconds since
+ *  the start of the process.
+ ***********************************************************/
+double StartupTimeline::GetElapsedTime()
+{
+	return((Profiler::GetTime() - g_StartTime) / NANOSECONDS_PER_MILLISECOND);
+}
+
+/***********************************************************
+ *  BeginPhase()
+ *
+ *  This method is used for opening a phase inside the phase
+ *  that is open, if any.
+ ***********************************************************/
+size_t StartupTimeline::BeginPhase(const char* name)
+{
+	if (g_bFinished)
+	{
+		return(NO_PHASE);
+	}
+
+	STARTUP_PHASE_RECORD phase;
+	phase.path = g_OpenPhases.empty() ? name : g_Phases[g_OpenPhases.back()].path + "/" + name;
+	phase.start = Profiler::GetTime();
+	phase.end = phase.start;
+	phase.childTime = 0;
+	g_Phases.push_back(phase);
+	g_OpenPhases.push_back(g_Phases.size() - 1);
+	return(g_Phases.size() - 1);
+}
+
+/***********************************************************
+ *  EndPhase()
+ *
+ *  This method is used for closing the innermost phase, and
+ *  adding its time to the phase it is in.
+ ***********************************************************/
+void StartupTimeline::EndPhase(size_t phase)
+{
+	if (g_bFinished)
+	{
+		return;
+	}
+	if (g_OpenPhases.empty() || (g_OpenPhases.back() != phase))
+	{
+		std::cout << "ERROR: Startup phase closed out of order" << std::endl;
+		return;
+	}
+
+	g_Phases[phase].end = Profiler::GetTime();
+	g_OpenPhases.pop_back();
+	if (!g_OpenPhases.empty())
+	{
+		g_Phases[g_OpenPhases.back()].childTime += g_Phases[phase].end - g_Phases[phase].start;
+	}
+}
+
+/***********************************************************
+ *  Finish()
+ *
+ *  This method is used for ending the timeline on the first
+ *  frame and printing each phase, sorted by the time spent
+ *  in the phase itself, with the time of the phases inside
+ *  it left out.  Time not in any phase is printed as a line
+ *  of its own.
+ ***********************************************************/
+void StartupTimeline::Finish()
+{
+	if (g_bFinished)
+	{
+		return;
+	}
+	g_bFinished = true;
+
+	double firstFrameTime = GetElapsedTime();
+	int64_t phaseTime = 0;
+	std::vector<const STARTUP_PHASE_RECORD*> sorted;
+	for (size_t i = 0; i < g_Phases.size(); i++)
+	{
+		if (g_Phases[i].path.find('/') == std::string::npos)
+		{
+			phaseTime += g_Phases[i].end - g_Phases[i].start;
+		}
+		sorted.push_back(&g_Phases[i]);
+	}
+	std::stable_sort(sorted.begin(), sorted.end(), CompareOwnTime);
+
+	std::ios_base::fmtflags flags = std::cout.flags();
+	std::streamsize precision = std::cout.precision();
+	std::cout << std::fixed << std::setprecision(3);
+	std::cout << "Startup timeline (ms), " << firstFrameTime << " to the first frame" << std::endl;
+	std::cout << std::left << std::setw(48) << "phase" << std::right
+		<< std::setw(10) << "own" << std::setw(10) << "total"
+		<< std::setw(10) << "start" << std::setw(8) << "%" << std::endl;
+	for (size_t i = 0; i < sorted.size(); i++)
+	{
+		const STARTUP_PHASE_RECORD& phase = *sorted[i];
+		double ownTime = (phase.end - phase.start - phase.childTime) / NANOSECONDS_PER_MILLISECOND;
+		std::cout << std::left << std::setw(48) << phase.path << std::right
+			<< std::setw(10) << ownTime
+			<< std::setw(10) << (phase.end - phase.start) / NANOSECONDS_PER_MILLISECOND
+			<< std::setw(10) << (phase.start - g_StartTime) / NANOSECONDS_PER_MILLISECOND
+			<< std::setw(8) << std::setprecision(1) << 100.0 * ownTime / std::max(firstFrameTime, 0.001)
+			<< std::setprecision(3) << std::endl;
+	}
+	std::cout << std::left << std::setw(48) << "(outside of phases)" << std::right
+		<< std::setw(10) << firstFrameTime - phaseTime / NANOSECONDS_PER_MILLISECOND << std::endl;
+	std::cout.flags(flags);
+	std::cout.precision(precision);
+
+	g_Phases.clear();
+	g_OpenPhases.clear();
+}
@@ -0,0 +1,81 @@
+///////////////////////////////////////////////////////////////////////////////
+// startuptimeline.h
+// ============
+// time the phases of the startup up to the first frame
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <cstddef>
+
+/***********************************************************
+ *  StartupTimeline
+ *
+ *  This class records the phases of the startup timed by
+ *  STARTUP_PHASE, from the start of main() to the first
+ *  frame on the screen.  Phases nest, so every phase keeps
+ *  its own time apart from the time of the phases inside
+ *  it.  Finish() prints the phases sorted by their own time,
+ *  which puts the one worth attacking first.  Phases are
+ *  only timed on the main thread, and after Finish() they
+ *  are not recorded anymore.
+ ***********************************************************/
+class StartupTimeline
+{
+public:
+	// phase returned once the timeline is finished
+	static const size_t NO_PHASE = (size_t)-1;
+
+	// mark the start of the process, called first in main()
+	static void Start();
+	// milliseconds since Start()
+	static double GetElapsedTime();
+
+	// open a phase inside the innermost open phase, and close
+	// it again - phases have to close in reverse order
+	static size_t BeginPhase(const char* name);
+	static void EndPhase(size_t phase);
+
+	// stop recording and print the breakdown, with the time
+	// since Start() as the time to the first frame - only the
+	// first call does anything
+	static void Finish();
+};
+
+/***********************************************************
+ *  StartupPhase
+ *
+ *  This class times the scope it is declared in as a phase
+ *  of the startup, unless Stop() ends it earlier.  The name
+ *  has to outlive the timeline, so it is meant for string
+ *  literals.
+ ***********************************************************/
+class StartupPhase
+{
+public:
+	explicit StartupPhase(const char* name)
+	{
+		m_phase = StartupTimeline::BeginPhase(name);
+	}
+	~StartupPhase()
+	{
+		Stop();
+	}
+
+	void Stop()
+	{
+		if (m_phase != StartupTimeline::NO_PHASE)
+		{
+			StartupTimeline::EndPhase(m_phase);
+			m_phase = StartupTimeline::NO_PHASE;
+		}
+	}
+
+private:
+	size_t m_phase;
+};
+
+// time the rest of the scope as a phase of the startup
+#define STARTUP_PHASE_CONCAT_INNER(a, b) a##b
+#define STARTUP_PHASE_CONCAT(a, b) STARTUP_PHASE_CONCAT_INNER(a, b)
+#define STARTUP_PHASE(name) StartupPhase STARTUP_PHASE_CONCAT(startupPhase, __LINE__)(name)
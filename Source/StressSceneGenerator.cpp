@@ -0,0 +1,199 @@
+///////////////////////////////////////////////////////////////////////////////
+// stressscenegenerator.cpp
+// ============
+// replicate the table props over a grid of tables for scaling tests
+///////////////////////////////////////////////////////////////////////////////
+
+#include "StressSceneGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <vector>
+
+// declaration of global variables
+namespace
+{
+	// range of the scale of a table, and the space between
+	// neighboring tables
+	const float MIN_TABLE_SCALE = 0.85f;
+	const float MAX_TABLE_SCALE = 1.15f;
+	const float TABLE_GAP = 4.0f;
+	// range the plain colors are multiplied with, in a few
+	// steps so the copies still share materials
+	const float MIN_COLOR_SCALE = 0.8f;
+	const float MAX_COLOR_SCALE = 1.2f;
+	const int COLOR_SCALE_STEPS = 8;
+}
+
+/***********************************************************
+ *  StressSceneGenerator()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+StressSceneGenerator::StressSceneGenerator()
+{
+	m_tableExtent = 0.0f;
+	m_seed = 1;
+}
+
+/***********************************************************
+ *  ~StressSceneGenerator()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+StressSceneGenerator::~StressSceneGenerator()
+{
+}
+
+/***********************************************************
+ *  LoadTemplate()
+ *
+ *  This method is used for reading the scene that is copied
+ *  onto every table, and measuring how much floor it covers.
+ *  The extent is rough - it only looks at the positions and
+ *  the largest side of each object - and leaves the tables
+ *  a little further apart than they need to be.
+ ***********************************************************/
+bool StressSceneGenerator::LoadTemplate(const char* textFilename)
+{
+	m_template = SceneFile::DESCRIPTION();
+	if (!SceneFile::ParseText(textFilename, m_template) || m_template.objects.empty())
+	{
+		std::cout << "Could not load the stress scene template:" << textFilename << std::endl;
+		return(false);
+	}
+
+	m_tableExtent = 0.0f;
+	for (size_t i = 0; i < m_template.objects.size(); i++)
+	{
+		const SceneFile::OBJECT_DESC& object = m_template.objects[i];
+		float size = std::max(std::max(object.scale.x, object.scale.y), object.scale.z);
+		float extent = std::max(std::fabs(object.position.x), std::fabs(object.position.z)) + size;
+		m_tableExtent = std::max(m_tableExtent, extent);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  Generate()
+ *
+ *  This method is used for copying the template objects
+ *  onto a grid of tables centered on the origin.  A table
+ *  is turned around by rotating it 180 degrees about the Y
+ *  axis, which keeps the X, Y, Z rotation order of the
+ *  objects - their Z rotation flips and their Y rotation
+ *  turns with the table.
+ ***********************************************************/
+bool StressSceneGenerator::Generate(uint32_t objectCount, SceneFile::DESCRIPTION& description) const
+{
+	if (m_template.objects.empty())
+	{
+		std::cout << "No stress scene template is loaded" << std::endl;
+		return(false);
+	}
+	if ((objectCount < MIN_OBJECTS) || (objectCount > MAX_OBJECTS))
+	{
+		std::cout << "Stress scenes have from " << MIN_OBJECTS << " to " << MAX_OBJECTS << " objects" << std::endl;
+		return(false);
+	}
+
+	description = SceneFile::DESCRIPTION();
+	description.textures = m_template.textures;
+	description.objects.reserve(objectCount);
+
+	uint32_t objectsPerTable = (uint32_t)m_template.objects.size();
+	uint32_t tableCount = (objectCount + objectsPerTable - 1) / objectsPerTable;
+	uint32_t columns = (uint32_t)std::ceil(std::sqrt((double)tableCount));
+	uint32_t rows = (tableCount + columns - 1) / columns;
+	float spacing = 2.0f * m_tableExtent * MAX_TABLE_SCALE + TABLE_GAP;
+
+	std::mt19937 random(m_seed);
+	std::uniform_real_distribution<float> tableScales(MIN_TABLE_SCALE, MAX_TABLE_SCALE);
+	std::uniform_int_distribution<int> colorScales(0, COLOR_SCALE_STEPS - 1);
+
+	// every table maps the texture tags onto a shuffled order
+	std::vector<size_t> textureOrder(description.textures.size());
+	for (uint32_t table = 0; table < tableCount; table++)
+	{
+		glm::vec3 center(
+			((float)(table % columns) - (columns - 1) * 0.5f) * spacing,
+			0.0f,
+			((float)(table / columns) - (rows - 1) * 0.5f) * spacing);
+		bool bTurned = ((random() & 1) != 0);
+		float tableScale = tableScales(random);
+		for (size_t i = 0; i < textureOrder.size(); i++)
+		{
+			textureOrder[i] = i;
+		}
+		std::shuffle(textureOrder.begin(), textureOrder.end(), random);
+
+		for (uint32_t i = 0; (i < objectsPerTable) && (description.objects.size() < objectCount); i++)
+		{
+			SceneFile::OBJECT_DESC object = m_template.objects[i];
+			object.id = (uint32_t)description.objects.size() + 1;
+
+			if (bTurned)
+			{
+				object.position.x = -object.position.x;
+				object.position.z = -object.position.z;
+				object.rotation.y += 180.0f;
+				object.rotation.z = -object.rotation.z;
+			}
+			object.position = object.position * tableScale + center;
+			object.scale *= tableScale;
+
+			if (object.bUseTexture)
+			{
+				for (size_t t = 0; t < description.textures.size(); t++)
+				{
+					if (description.textures[t].tag == object.textureTag)
+					{
+						// the PBR materials share the tags of the textures
+						const std::string& textureTag = description.textures[textureOrder[t]].tag;
+						if (object.materialTag == object.textureTag)
+						{
+							object.materialTag = textureTag;
+						}
+						object.textureTag = textureTag;
+						break;
+					}
+				}
+			}
+			else
+			{
+				float colorScale = MIN_COLOR_SCALE +
+					(MAX_COLOR_SCALE - MIN_COLOR_SCALE) * colorScales(random) / (COLOR_SCALE_STEPS - 1);
+				for (int c = 0; c < 3; c++)
+				{
+					object.color[c] = std::min(object.color[c] * colorScale, 1.0f);
+				}
+			}
+
+			description.objects.push_back(object);
+		}
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  Write()
+ *
+ *  This method is used for generating a scene and writing
+ *  it as a binary scene file.
+ ***********************************************************/
+bool StressSceneGenerator::Write(uint32_t objectCount, const char* binaryFilename) const
+{
+	SceneFile::DESCRIPTION description;
+	if (!Generate(objectCount, description) || !SceneFile::WriteBinary(description, binaryFilename))
+	{
+		return(false);
+	}
+
+	uint32_t objectsPerTable = (uint32_t)m_template.objects.size();
+	std::cout << "INFO: Generated stress scene " << binaryFilename << ": " << objectCount << " objects on "
+		<< (objectCount + objectsPerTable - 1) / objectsPerTable << " tables" << std::endl;
+	return(true);
+}
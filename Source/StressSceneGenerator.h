@@ -0,0 +1,55 @@
+///////////////////////////////////////////////////////////////////////////////
+// stressscenegenerator.h
+// ============
+// replicate the table props over a grid of tables for scaling tests
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneFile.h"
+
+#include <cstdint>
+
+/***********************************************************
+ *  StressSceneGenerator
+ *
+ *  This class makes scenes of any size out of a template
+ *  scene file, the wedding table by default - the table and
+ *  the bottles, boxes and vow books on it.  The template is
+ *  copied onto a square grid of tables until the requested
+ *  number of objects is reached, the last table only
+ *  partly filled.  Every table is turned around or not,
+ *  scaled a little, and gets its textures shuffled and its
+ *  colors varied, all from a seeded generator so the same
+ *  settings always make the same scene.  The text of the
+ *  template is left out.  The result is written as a binary
+ *  scene file, which every mode can load.
+ ***********************************************************/
+class StressSceneGenerator
+{
+public:
+	// constructor
+	StressSceneGenerator();
+	// destructor
+	~StressSceneGenerator();
+
+	// range of the object count of a generated scene
+	static const uint32_t MIN_OBJECTS = 10;
+	static const uint32_t MAX_OBJECTS = 1000000;
+
+	// read the scene the tables are copied from
+	bool LoadTemplate(const char* textFilename);
+	void SetSeed(uint32_t seed) { m_seed = seed; }
+
+	// lay out the objects of the tables into a description
+	bool Generate(uint32_t objectCount, SceneFile::DESCRIPTION& description) const;
+	// generate a scene and write it as a binary scene file
+	bool Write(uint32_t objectCount, const char* binaryFilename) const;
+
+private:
+	SceneFile::DESCRIPTION m_template;
+	// distance from the template origin to the furthest edge
+	// of its objects on the floor plane
+	float m_tableExtent;
+	uint32_t m_seed;
+};
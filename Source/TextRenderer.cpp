@@ -0,0 +1,298 @@
+///////////////////////////////////////////////////////////////////////////////
+// textrenderer.cpp
+// ============
+// lay out text blocks into vertex buffers of signed distance field glyphs
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TextRenderer.h"
+
+#include <sstream>
+
+// declaration of global variables
+namespace
+{
+	// position, normal and texture coordinate - the same
+	// layout as the basic shape meshes
+	const int FLOATS_PER_VERTEX = 8;
+	const int VERTICES_PER_GLYPH = 6;
+	const float DEFAULT_LINE_SPACING = 1.0f;
+
+	/***********************************************************
+	 *  AddVertex()
+	 *
+	 *  Append one vertex of a glyph quad, facing +Z.
+	 ***********************************************************/
+	void AddVertex(std::vector<float>& vertices, float x, float y, float u, float v)
+	{
+		const float vertex[FLOATS_PER_VERTEX] = { x, y, 0.0f, 0.0f, 0.0f, 1.0f, u, v };
+		vertices.insert(vertices.end(), vertex, vertex + FLOATS_PER_VERTEX);
+	}
+}
+
+/***********************************************************
+ *  TextRenderer()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TextRenderer::TextRenderer()
+{
+	m_pDevice = NULL;
+}
+
+/***********************************************************
+ *  ~TextRenderer()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+TextRenderer::~TextRenderer()
+{
+}
+
+/***********************************************************
+ *  LoadAtlas()
+ *
+ *  This method is used for getting the glyph atlas of a font
+ *  ready - from its cache file when the font is unchanged.
+ *  It does not need a render device, so text can be laid out
+ *  for the CPU renderers.
+ ***********************************************************/
+bool TextRenderer::LoadAtlas(const char* fontFilename, const char* cacheFilename)
+{
+	return(m_atlas.Load(fontFilename, cacheFilename));
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for uploading the loaded glyph atlas
+ *  into a texture on the device the blocks are drawn with.
+ ***********************************************************/
+bool TextRenderer::CreateTexture(RenderDevice* pDevice)
+{
+	m_pDevice = pDevice;
+	return(m_atlas.CreateTexture(pDevice) != 0);
+}
+
+/***********************************************************
+ *  Destroy()
+ *
+ *  This method is used for freeing the atlas texture.
+ ***********************************************************/
+void TextRenderer::Destroy()
+{
+	m_atlas.DestroyTexture();
+}
+
+/***********************************************************
+ *  GetDefaultLayout()
+ *
+ *  This method is used for getting a left aligned layout of
+ *  the passed in size that only breaks lines at '\n'.
+ ***********************************************************/
+TextRenderer::TEXT_LAYOUT TextRenderer::GetDefaultLayout(float size)
+{
+	TEXT_LAYOUT layout;
+	layout.size = size;
+	layout.maxWidth = 0.0f;
+	layout.lineSpacing = DEFAULT_LINE_SPACING;
+	layout.alignment = ALIGN_LEFT;
+	return(layout);
+}
+
+/***********************************************************
+ *  GetEmptyBlock()
+ *
+ *  This method is used for getting a block with no vertex
+ *  buffer, ready to be built.
+ ***********************************************************/
+TextRenderer::TEXT_BLOCK TextRenderer::GetEmptyBlock()
+{
+	TEXT_BLOCK block;
+	block.vertexBuffer = 0;
+	block.bufferSize = 0;
+	block.vertexCount = 0;
+	return(block);
+}
+
+/***********************************************************
+ *  MeasureLine()
+ *
+ *  This method is used for adding up the advances of the
+ *  glyphs of one line.
+ ***********************************************************/
+float TextRenderer::MeasureLine(const std::string& line) const
+{
+	float width = 0.0f;
+	for (size_t i = 0; i < line.size(); i++)
+	{
+		width += m_atlas.GetGlyph(line[i]).advance;
+	}
+	return(width);
+}
+
+/***********************************************************
+ *  WrapLines()
+ *
+ *  This method is used for splitting the text into the lines
+ *  that are drawn.  With a maximum width, words are moved to
+ *  the next line as soon as they would not fit - a single
+ *  word wider than the block keeps a line of its own.
+ ***********************************************************/
+void TextRenderer::WrapLines(const std::string& text, const TEXT_LAYOUT& layout, std::vector<std::string>& lines) const
+{
+	lines.clear();
+
+	std::istringstream paragraphs(text);
+	std::string paragraph;
+	while (std::getline(paragraphs, paragraph))
+	{
+		if (layout.maxWidth <= 0.0f)
+		{
+			lines.push_back(paragraph);
+			continue;
+		}
+
+		float maxWidth = layout.maxWidth / layout.size;
+		std::istringstream words(paragraph);
+		std::string word;
+		std::string line;
+		while (words >> word)
+		{
+			std::string candidate = line.empty() ? word : line + " " + word;
+			if (!line.empty() && (MeasureLine(candidate) > maxWidth))
+			{
+				lines.push_back(line);
+				line = word;
+			}
+			else
+			{
+				line = candidate;
+			}
+		}
+		lines.push_back(line);
+	}
+}
+
+/***********************************************************
+ *  LayoutText()
+ *
+ *  This method is used for laying out text into two
+ *  triangles per visible glyph.  The text lies in its XY
+ *  plane, facing +Z, with the first line hanging below the
+ *  origin.
+ ***********************************************************/
+void TextRenderer::LayoutText(const std::string& text, const TEXT_LAYOUT& layout, std::vector<float>& vertices) const
+{
+	std::vector<std::string> lines;
+	WrapLines(text, layout, lines);
+
+	vertices.clear();
+	vertices.reserve(text.size() * VERTICES_PER_GLYPH * FLOATS_PER_VERTEX);
+
+	float size = layout.size;
+	float baseline = -m_atlas.GetAscender() * size;
+	for (size_t i = 0; i < lines.size(); i++)
+	{
+		const std::string& line = lines[i];
+		float width = MeasureLine(line) * size;
+		float x = 0.0f;
+		if (layout.alignment == ALIGN_CENTER)
+		{
+			x = -width * 0.5f;
+		}
+		else if (layout.alignment == ALIGN_RIGHT)
+		{
+			x = -width;
+		}
+
+		for (size_t c = 0; c < line.size(); c++)
+		{
+			const GlyphAtlas::GLYPH& glyph = m_atlas.GetGlyph(line[c]);
+			// blank glyphs only move the pen
+			if (glyph.right > glyph.left)
+			{
+				float left = x + glyph.left * size;
+				float right = x + glyph.right * size;
+				float bottom = baseline + glyph.bottom * size;
+				float top = baseline + glyph.top * size;
+
+				AddVertex(vertices, left, bottom, glyph.u0, glyph.v0);
+				AddVertex(vertices, right, bottom, glyph.u1, glyph.v0);
+				AddVertex(vertices, right, top, glyph.u1, glyph.v1);
+				AddVertex(vertices, left, bottom, glyph.u0, glyph.v0);
+				AddVertex(vertices, right, top, glyph.u1, glyph.v1);
+				AddVertex(vertices, left, top, glyph.u0, glyph.v1);
+			}
+			x += glyph.advance * size;
+		}
+
+		baseline -= m_atlas.GetLineHeight() * layout.lineSpacing * size;
+	}
+}
+
+/***********************************************************
+ *  BuildBlock()
+ *
+ *  This method is used for laying out the text of a block
+ *  into its vertex buffer.  The buffer is only made again
+ *  when the new text does not fit into it.
+ ***********************************************************/
+void TextRenderer::BuildBlock(TEXT_BLOCK& block, const std::string& text, const TEXT_LAYOUT& layout) const
+{
+	if (NULL == m_pDevice)
+	{
+		return;
+	}
+
+	std::vector<float> vertices;
+	LayoutText(text, layout, vertices);
+	size_t size = vertices.size() * sizeof(float);
+
+	if ((block.vertexBuffer != 0) && (size > block.bufferSize))
+	{
+		DestroyBlock(block);
+	}
+
+	if (block.vertexBuffer == 0)
+	{
+		RenderDevice::BUFFER_DESC desc;
+		desc.type = RenderDevice::BUFFER_VERTEX;
+		// an empty block still gets a buffer to reuse later
+		desc.size = (size > 0) ? size : FLOATS_PER_VERTEX * VERTICES_PER_GLYPH * sizeof(float);
+		desc.bDynamic = false;
+		block.vertexBuffer = m_pDevice->CreateBuffer(desc, (size > 0) ? vertices.data() : NULL);
+		block.bufferSize = desc.size;
+	}
+	else if (size > 0)
+	{
+		m_pDevice->UpdateBuffer(block.vertexBuffer, 0, size, vertices.data());
+	}
+
+	block.vertexCount = (uint32_t)(vertices.size() / FLOATS_PER_VERTEX);
+}
+
+/***********************************************************
+ *  DestroyBlock()
+ *
+ *  This method is used for freeing the vertex buffer of a
+ *  block.
+ ***********************************************************/
+void TextRenderer::DestroyBlock(TEXT_BLOCK& block) const
+{
+	if ((block.vertexBuffer != 0) && (NULL != m_pDevice))
+	{
+		m_pDevice->DestroyBuffer(block.vertexBuffer);
+	}
+	block = GetEmptyBlock();
+}
+
+/***********************************************************
+ *  DrawBlock()
+ *
+ *  This method is used for drawing every glyph of a block
+ *  with one draw call.
+ ***********************************************************/
+void TextRenderer::DrawBlock(RenderCommandList& commands, const TEXT_BLOCK& block)
+{
+	commands.Draw(block.vertexBuffer, 0, block.vertexCount);
+}
@@ -0,0 +1,100 @@
+///////////////////////////////////////////////////////////////////////////////
+// textrenderer.h
+// ============
+// lay out text blocks into vertex buffers of signed distance field glyphs
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "GlyphAtlas.h"
+#include "RenderDevice.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TextRenderer
+ *
+ *  This class lays out blocks of text with the glyphs of a
+ *  GlyphAtlas.  Each block gets one vertex buffer holding a
+ *  quad per glyph, in the vertex layout of the basic shape
+ *  meshes, so a whole block is drawn with a single call by
+ *  the scene shader.  Blocks are only laid out again when
+ *  their text changes, and their buffers are on the device
+ *  the atlas texture was created on.
+ ***********************************************************/
+class TextRenderer
+{
+public:
+	// constructor
+	TextRenderer();
+	// destructor
+	~TextRenderer();
+
+	enum TEXT_ALIGNMENT
+	{
+		ALIGN_LEFT = 0,
+		ALIGN_CENTER,
+		ALIGN_RIGHT
+	};
+
+	// how the text of a block is laid out - the block origin
+	// is the top of the first line, at the aligned edge
+	struct TEXT_LAYOUT
+	{
+		// height of an em in world units
+		float size;
+		// lines are wrapped between words at this width, 0
+		// only breaks lines at '\n'
+		float maxWidth;
+		// distance between lines, relative to the font
+		float lineSpacing;
+		uint32_t alignment;
+	};
+
+	// vertex buffer of one laid out block
+	struct TEXT_BLOCK
+	{
+		RENDER_BUFFER vertexBuffer;
+		// bytes the buffer holds, it is reused for text that fits
+		size_t bufferSize;
+		uint32_t vertexCount;
+	};
+
+	// load the glyph atlas of a font, without a render device
+	bool LoadAtlas(const char* fontFilename, const char* cacheFilename);
+	// upload the loaded atlas into a texture
+	bool CreateTexture(RenderDevice* pDevice);
+	// free the atlas texture
+	void Destroy();
+	bool IsReady() const { return(m_atlas.GetTextureID() != 0); }
+	RENDER_TEXTURE GetAtlasTextureID() const { return(m_atlas.GetTextureID()); }
+	const GlyphAtlas& GetAtlas() const { return(m_atlas); }
+
+	// lay out text into glyph quads, 8 floats per vertex
+	void LayoutText(const std::string& text, const TEXT_LAYOUT& layout, std::vector<float>& vertices) const;
+	// lay out text into the vertex buffer of a block, creating
+	// the buffer the first time
+	void BuildBlock(TEXT_BLOCK& block, const std::string& text, const TEXT_LAYOUT& layout) const;
+	// free the vertex buffer of a block
+	void DestroyBlock(TEXT_BLOCK& block) const;
+	// draw all glyphs of a block - the atlas has to be bound
+	static void DrawBlock(RenderCommandList& commands, const TEXT_BLOCK& block);
+
+	// get a layout with the default spacing and alignment
+	static TEXT_LAYOUT GetDefaultLayout(float size);
+	// get a block that has no vertex buffer yet
+	static TEXT_BLOCK GetEmptyBlock();
+
+private:
+	// signed distance field glyphs of the font
+	GlyphAtlas m_atlas;
+	// device of the atlas texture and the block buffers
+	RenderDevice* m_pDevice;
+
+	// width of a line of text in em units
+	float MeasureLine(const std::string& line) const;
+	// split text into lines at '\n' and wrap long lines
+	void WrapLines(const std::string& text, const TEXT_LAYOUT& layout, std::vector<std::string>& lines) const;
+};
@@ -0,0 +1,176 @@
+///////////////////////////////////////////////////////////////////////////////
+// timerstatistics.cpp
+// ============
+// keep rolling averages and percentiles of named timings
+///////////////////////////////////////////////////////////////////////////////
+
+#include "TimerStatistics.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	/***********************************************************
+	 *  GetPercentile()
+	 *
+	 *  This function is used for getting the sample below
+	 *  which the given fraction of the samples fall.  The
+	 *  samples are reordered.
+	 ***********************************************************/
+	double GetPercentile(std::vector<double>& samples, double fraction)
+	{
+		size_t index = (size_t)(fraction * (double)(samples.size() - 1) + 0.5);
+		std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+		return(samples[index]);
+	}
+}
+
+/***********************************************************
+ *  TimerStatistics()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+TimerStatistics::TimerStatistics(size_t windowSize)
+{
+	m_windowSize = std::max(windowSize, (size_t)1);
+}
+
+/***********************************************************
+ *  AddSample()
+ *
+ *  This method is used for adding a sample of a name, which
+ *  replaces the oldest one once the window is full.
+ ***********************************************************/
+void TimerStatistics::AddSample(const std::string& name, double milliseconds)
+{
+	SAMPLE_WINDOW& window = m_windows[name];
+	if (window.samples.size() < m_windowSize)
+	{
+		// the whole window at once, so filling it does not
+		// reallocate during the frames
+		if (window.samples.empty())
+		{
+			window.samples.reserve(m_windowSize);
+		}
+		window.samples.push_back(milliseconds);
+		window.nextIndex = window.samples.size() % m_windowSize;
+	}
+	else
+	{
+		window.samples[window.nextIndex] = milliseconds;
+		window.nextIndex = (window.nextIndex + 1) % m_windowSize;
+	}
+}
+
+/***********************************************************
+ *  GetSummaries()
+ *
+ *  This method is used for summing up the samples of every
+ *  name.
+ ***********************************************************/
+std::vector<TimerStatistics::SUMMARY> TimerStatistics::GetSummaries() const
+{
+	std::vector<SUMMARY> summaries;
+
+	std::map<std::string, SAMPLE_WINDOW>::const_iterator it;
+	for (it = m_windows.begin(); it != m_windows.end(); ++it)
+	{
+		if (!it->second.samples.empty())
+		{
+			SUMMARY summary;
+			Summarize(it->first, it->second, summary);
+			summaries.push_back(summary);
+		}
+	}
+
+	return(summaries);
+}
+
+/***********************************************************
+ *  GetSummary()
+ *
+ *  This method is used for summing up the samples of one
+ *  name.
+ ***********************************************************/
+bool TimerStatistics::GetSummary(const std::string& name, SUMMARY& summary) const
+{
+	std::map<std::string, SAMPLE_WINDOW>::const_iterator it = m_windows.find(name);
+	if ((it == m_windows.end()) || it->second.samples.empty())
+	{
+		return(false);
+	}
+
+	Summarize(name, it->second, summary);
+	return(true);
+}
+
+/***********************************************************
+ *  Summarize()
+ *
+ *  This method is used for getting the average and the
+ *  percentiles of the samples of a window.
+ ***********************************************************/
+void TimerStatistics::Summarize(const std::string& name, const SAMPLE_WINDOW& window, SUMMARY& summary)
+{
+	std::vector<double> samples = window.samples;
+	double total = 0.0;
+	for (size_t i = 0; i < samples.size(); i++)
+	{
+		total += samples[i];
+	}
+
+	summary.name = name;
+	summary.sampleCount = samples.size();
+	summary.average = total / (double)samples.size();
+	summary.p50 = GetPercentile(samples, 0.50);
+	summary.p95 = GetPercentile(samples, 0.95);
+	summary.p99 = GetPercentile(samples, 0.99);
+}
+
+/***********************************************************
+ *  Print()
+ *
+ *  This method is used for writing the summaries to the
+ *  console, one line for each name.
+ ***********************************************************/
+void TimerStatistics::Print(const char* title) const
+{
+	std::vector<SUMMARY> summaries = GetSummaries();
+	if (summaries.empty())
+	{
+		return;
+	}
+
+	std::cout << title << " (ms)" << std::endl;
+	std::cout << std::left << std::setw(24) << "name" << std::right
+		<< std::setw(10) << "average" << std::setw(10) << "p50"
+		<< std::setw(10) << "p95" << std::setw(10) << "p99"
+		<< std::setw(10) << "samples" << std::endl;
+
+	std::ios_base::fmtflags flags = std::cout.flags();
+	std::streamsize precision = std::cout.precision();
+	std::cout << std::fixed << std::setprecision(3);
+	for (size_t i = 0; i < summaries.size(); i++)
+	{
+		const SUMMARY& summary = summaries[i];
+		std::cout << std::left << std::setw(24) << summary.name << std::right
+			<< std::setw(10) << summary.average << std::setw(10) << summary.p50
+			<< std::setw(10) << summary.p95 << std::setw(10) << summary.p99
+			<< std::setw(10) << summary.sampleCount << std::endl;
+	}
+	std::cout.flags(flags);
+	std::cout.precision(precision);
+}
+
+/***********************************************************
+ *  Clear()
+ *
+ *  This method is used for dropping every sample.
+ ***********************************************************/
+void TimerStatistics::Clear()
+{
+	m_windows.clear();
+}
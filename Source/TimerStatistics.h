@@ -0,0 +1,62 @@
+///////////////////////////////////////////////////////////////////////////////
+// timerstatistics.h
+// ============
+// keep rolling averages and percentiles of named timings
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  TimerStatistics
+ *
+ *  This class keeps the last samples of every named timing,
+ *  such as the GPU time of a render pass, and sums them up
+ *  as an average and percentiles.  Only a window of recent
+ *  samples is kept, so the numbers follow what the scene is
+ *  doing at the moment.
+ ***********************************************************/
+class TimerStatistics
+{
+public:
+	// timings of one name, in milliseconds
+	struct SUMMARY
+	{
+		std::string name;
+		double average;
+		double p50;
+		double p95;
+		double p99;
+		size_t sampleCount;
+	};
+
+	// constructor - the number of samples kept for each name
+	TimerStatistics(size_t windowSize = 240);
+
+	// add a sample in milliseconds
+	void AddSample(const std::string& name, double milliseconds);
+	// sum up the samples of every name, sorted by name
+	std::vector<SUMMARY> GetSummaries() const;
+	// sum up the samples of one name, false if it has none
+	bool GetSummary(const std::string& name, SUMMARY& summary) const;
+	// write the summaries as a table to the console
+	void Print(const char* title) const;
+	void Clear();
+
+private:
+	// ring of the last samples of a name
+	struct SAMPLE_WINDOW
+	{
+		std::vector<double> samples;
+		size_t nextIndex;
+	};
+
+	size_t m_windowSize;
+	std::map<std::string, SAMPLE_WINDOW> m_windows;
+
+	// sum up the samples of a window
+	static void Summarize(const std::string& name, const SAMPLE_WINDOW& window, SUMMARY& summary);
+};
@@ -0,0 +1,309 @@
+///////////////////////////////////////////////////////////////////////////////
+// variantbatch.cpp
+// ============
+// render personalized variants of a scene file back to back into image files
+///////////////////////////////////////////////////////////////////////////////
+
+#include "VariantBatch.h"
+
+#include "GLFW/glfw3.h"
+
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+/***********************************************************
+ *  VariantBatch()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+VariantBatch::VariantBatch()
+{
+	m_outputFolder = "renders";
+	m_pDevice = NULL;
+	m_renderTarget = 0;
+}
+
+/***********************************************************
+ *  ~VariantBatch()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+VariantBatch::~VariantBatch()
+{
+	DestroyRenderTarget();
+}
+
+/***********************************************************
+ *  Load()
+ *
+ *  This method is used for reading a variant list file.  It
+ *  names the base scene, the output folder and the variants,
+ *  each followed by its texture, color and text overrides.
+ ***********************************************************/
+bool VariantBatch::Load(const char* filename)
+{
+	std::ifstream batchFile(filename);
+	if (!batchFile.is_open())
+	{
+		std::cout << "Could not open variant file:" << filename << std::endl;
+		return(false);
+	}
+
+	m_variants.clear();
+
+	std::string line;
+	int lineNumber = 0;
+	while (std::getline(batchFile, line))
+	{
+		lineNumber++;
+
+		// strip comments
+		size_t comment = line.find('#');
+		if (comment != std::string::npos)
+		{
+			line.erase(comment);
+		}
+
+		std::istringstream tokens(line);
+		std::string keyword;
+		if (!(tokens >> keyword))
+		{
+			continue;
+		}
+
+		bool bValid = true;
+		if (keyword == "scene")
+		{
+			bValid = (bool)(tokens >> m_sceneFilename);
+		}
+		else if (keyword == "output")
+		{
+			bValid = (bool)(tokens >> m_outputFolder);
+		}
+		else if (keyword == "variant")
+		{
+			VARIANT variant;
+			bValid = (bool)(tokens >> variant.name);
+			m_variants.push_back(variant);
+		}
+		else if ((keyword == "texture") && !m_variants.empty())
+		{
+			std::string tag;
+			std::string imageFilename;
+			bValid = (bool)(tokens >> tag >> imageFilename);
+			m_variants.back().overrides.textures[tag] = imageFilename;
+		}
+		else if ((keyword == "color") && !m_variants.empty())
+		{
+			uint32_t objectID = 0;
+			glm::vec4 color;
+			bValid = (bool)(tokens >> objectID >> color.r >> color.g >> color.b >> color.a);
+			m_variants.back().overrides.colors[objectID] = color;
+		}
+		else if ((keyword == "text") && !m_variants.empty())
+		{
+			// everything after the first ':' is the text itself
+			uint32_t textID = 0;
+			size_t separator = line.find(':');
+			bValid = (separator != std::string::npos) && (bool)(tokens >> textID);
+			if (bValid)
+			{
+				m_variants.back().overrides.texts[textID] = SceneFile::ParseTextString(line.substr(separator + 1));
+			}
+		}
+		else
+		{
+			bValid = false;
+		}
+
+		if (bValid == false)
+		{
+			std::cout << filename << "(" << lineNumber << "): invalid variant line: " << line << std::endl;
+			return(false);
+		}
+	}
+
+	if (m_sceneFilename.empty() || m_variants.empty())
+	{
+		std::cout << "Variant file needs a scene and at least one variant:" << filename << std::endl;
+		return(false);
+	}
+
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyRenderTarget()
+ *
+ *  This method is used for freeing the offscreen render
+ *  target.
+ ***********************************************************/
+void VariantBatch::DestroyRenderTarget()
+{
+	if (m_renderTarget != 0)
+	{
+		m_pDevice->DestroyRenderTarget(m_renderTarget);
+		m_renderTarget = 0;
+	}
+}
+
+/***********************************************************
+ *  WriteTGA()
+ *
+ *  This method is used for saving a rendered image.  TGA
+ *  stores the bottom row first in BGRA order, which is what
+ *  the render devices read back, so no conversion is needed.
+ ***********************************************************/
+bool VariantBatch::WriteTGA(const std::string& filename, int width, int height, const std::vector<unsigned char>& pixels)
+{
+	std::ofstream imageFile(filename.c_str(), std::ios::binary | std::ios::trunc);
+	if (!imageFile.is_open())
+	{
+		std::cout << "Could not write image:" << filename << std::endl;
+		return(false);
+	}
+
+	unsigned char header[18] = { 0 };
+	// uncompressed true color
+	header[2] = 2;
+	header[12] = (unsigned char)(width & 0xFF);
+	header[13] = (unsigned char)((width >> 8) & 0xFF);
+	header[14] = (unsigned char)(height & 0xFF);
+	header[15] = (unsigned char)((height >> 8) & 0xFF);
+	header[16] = 32;
+	// 8 alpha bits, origin in the lower left corner
+	header[17] = 8;
+
+	imageFile.write((const char*)header, sizeof(header));
+	imageFile.write((const char*)pixels.data(), pixels.size());
+
+	return(imageFile.good());
+}
+
+/***********************************************************
+ *  ReadTGA()
+ *
+ *  This method is used for loading an image saved with
+ *  WriteTGA(), such as a golden image of a regression run.
+ *  Only uncompressed 32 bit images with the bottom row first
+ *  are read.
+ ***********************************************************/
+bool VariantBatch::ReadTGA(const std::string& filename, int& width, int& height, std::vector<unsigned char>& pixels)
+{
+	std::ifstream imageFile(filename.c_str(), std::ios::binary);
+	if (!imageFile.is_open())
+	{
+		return(false);
+	}
+
+	unsigned char header[18] = { 0 };
+	if (!imageFile.read((char*)header, sizeof(header)) ||
+		(header[2] != 2) || (header[16] != 32) || ((header[17] & 0x20) != 0))
+	{
+		std::cout << "Not implemented to handle the format of image:" << filename << std::endl;
+		return(false);
+	}
+
+	// skip the image ID, if there is one
+	imageFile.ignore(header[0]);
+
+	width = header[12] | (header[13] << 8);
+	height = header[14] | (header[15] << 8);
+	pixels.resize((size_t)width * height * 4);
+
+	return((bool)imageFile.read((char*)pixels.data(), pixels.size()));
+}
+
+/***********************************************************
+ *  Run()
+ *
+ *  This method is used for rendering every variant.  The base
+ *  scene is loaded once, then for each variant the overrides
+ *  are applied - which only uploads the textures and objects
+ *  that differ from the previous variant - and the scene is
+ *  drawn offscreen and saved.
+ ***********************************************************/
+bool VariantBatch::Run(RenderDevice* pDevice, SceneManager* pSceneManager, ViewManager* pViewManager)
+{
+	if (!pSceneManager->LoadSceneFile(m_sceneFilename.c_str()))
+	{
+		return(false);
+	}
+
+	// render at the size of the window, which the projection
+	// aspect ratio is set up for
+	int width = 0;
+	int height = 0;
+	pDevice->GetWindowSize(width, height);
+	if ((width <= 0) || (height <= 0))
+	{
+		return(false);
+	}
+
+	DestroyRenderTarget();
+	m_pDevice = pDevice;
+	m_renderTarget = m_pDevice->CreateRenderTarget(width, height);
+	if (m_renderTarget == 0)
+	{
+		std::cout << "Could not create the variant render target" << std::endl;
+		return(false);
+	}
+
+	// the output folder is created when it does not exist yet
+#ifdef _WIN32
+	_mkdir(m_outputFolder.c_str());
+#else
+	mkdir(m_outputFolder.c_str(), 0755);
+#endif
+
+	std::vector<unsigned char> pixels((size_t)width * height * 4);
+	RenderCommandList commands;
+	int failedCount = 0;
+
+	for (size_t i = 0; i < m_variants.size(); i++)
+	{
+		double startTime = glfwGetTime();
+		int uploadCount = pSceneManager->ApplySceneOverrides(m_variants[i].overrides);
+
+		commands.Reset();
+		commands.SetRenderTarget(m_renderTarget, width, height);
+		commands.Clear(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+		pViewManager->PrepareSceneView(commands);
+		m_pDevice->Submit(commands);
+		pSceneManager->RenderScene();
+
+		bool bRead = m_pDevice->ReadPixels(m_renderTarget, width, height, pixels.data());
+		commands.Reset();
+		commands.SetRenderTarget(0);
+		m_pDevice->Submit(commands);
+		if (!bRead)
+		{
+			failedCount++;
+			continue;
+		}
+
+		std::string imageFilename = m_outputFolder + "/" + m_variants[i].name + ".tga";
+		if (!WriteTGA(imageFilename, width, height, pixels))
+		{
+			failedCount++;
+			continue;
+		}
+
+		std::cout << "Rendered variant " << m_variants[i].name << " into " << imageFilename
+			<< " (" << uploadCount << " uploads, "
+			<< (int)((glfwGetTime() - startTime) * 1000.0) << " ms)" << std::endl;
+	}
+
+	// leave the scene as the scene file describes it
+	pSceneManager->ApplySceneOverrides(ResidentScene::OVERRIDES());
+	DestroyRenderTarget();
+
+	return(failedCount == 0);
+}
@@ -0,0 +1,60 @@
+///////////////////////////////////////////////////////////////////////////////
+// variantbatch.h
+// ============
+// render personalized variants of a scene file back to back into image files
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+#include "SceneManager.h"
+#include "ViewManager.h"
+#include "ResidentScene.h"
+
+#include <string>
+#include <vector>
+
+/***********************************************************
+ *  VariantBatch
+ *
+ *  This class renders one base scene file several times with
+ *  different texture, color and text overrides, one image
+ *  per variant.  The base scene stays loaded for the whole
+ *  batch and each variant only uploads what differs from the
+ *  one rendered before it (see scenes/example.variants).
+ ***********************************************************/
+class VariantBatch
+{
+public:
+	// constructor
+	VariantBatch();
+	// destructor
+	~VariantBatch();
+
+	struct VARIANT
+	{
+		std::string name;
+		ResidentScene::OVERRIDES overrides;
+	};
+
+	// read a variant list file
+	bool Load(const char* filename);
+	// render every variant into the output folder
+	bool Run(RenderDevice* pDevice, SceneManager* pSceneManager, ViewManager* pViewManager);
+
+	// write BGRA pixels, bottom row first, as a TGA image
+	static bool WriteTGA(const std::string& filename, int width, int height, const std::vector<unsigned char>& pixels);
+	// read a TGA image written by WriteTGA()
+	static bool ReadTGA(const std::string& filename, int& width, int& height, std::vector<unsigned char>& pixels);
+
+private:
+	// base scene file and the folder the images are written to
+	std::string m_sceneFilename;
+	std::string m_outputFolder;
+	std::vector<VARIANT> m_variants;
+	// offscreen render target and the device it is on
+	RenderDevice* m_pDevice;
+	RENDER_TARGET m_renderTarget;
+
+	// free the offscreen render target
+	void DestroyRenderTarget();
+};
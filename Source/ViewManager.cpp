@@ -8,18 +8,29 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "ViewManager.h"
+#include "Profiler.h"
 
 // GLM Math Header inclusions
 #include <glm/glm.hpp>
 #include <glm/gtx/transform.hpp>
 #include <glm/gtc/type_ptr.hpp>    
 
+#include <iostream>
+
 // declaration of the global variables and defines
 namespace
 {
 	// Variables for window width and height
 	const int WINDOW_WIDTH = 1000;
 	const int WINDOW_HEIGHT = 800;
+	// view of the camera when the application starts
+	const glm::vec3 DEFAULT_CAMERA_POSITION = glm::vec3(0.0f, 5.0f, 12.0f);
+	const glm::vec3 DEFAULT_CAMERA_FRONT = glm::vec3(0.0f, -0.5f, -2.0f);
+	const glm::vec3 DEFAULT_CAMERA_UP = glm::vec3(0.0f, 1.0f, 0.0f);
+	const float DEFAULT_CAMERA_ZOOM = 80.0f;
+	// near and far planes of the perspective projection
+	const float NEAR_PLANE = 0.1f;
+	const float FAR_PLANE = 100.0f;
 	const char* g_ViewName = "view";
 	const char* g_ProjectionName = "projection";
 
@@ -46,18 +57,23 @@ namespace
  *
  *  The constructor for the class
  ***********************************************************/
-ViewManager::ViewManager(
-	ShaderManager *pShaderManager)
+ViewManager::ViewManager()
 {
 	// initialize the member variables
-	m_pShaderManager = pShaderManager;
 	m_pWindow = NULL;
+	m_sceneRequest = NO_SCENE_REQUEST;
+	for (int key = 0; key <= 9; key++)
+	{
+		m_bSceneKeysDown[key] = false;
+	}
+	m_bHudVisible = false;
+	m_bHudKeyDown = false;
 	g_pCamera = new Camera();
 	// default camera view parameters
-	g_pCamera->Position = glm::vec3(0.0f, 5.0f, 12.0f);
-	g_pCamera->Front = glm::vec3(0.0f, -0.5f, -2.0f);
-	g_pCamera->Up = glm::vec3(0.0f, 1.0f, 0.0f);
-	g_pCamera->Zoom = 80;
+	g_pCamera->Position = DEFAULT_CAMERA_POSITION;
+	g_pCamera->Front = DEFAULT_CAMERA_FRONT;
+	g_pCamera->Up = DEFAULT_CAMERA_UP;
+	g_pCamera->Zoom = DEFAULT_CAMERA_ZOOM;
 	g_pCamera->MovementSpeed = 20;
 }
 
@@ -69,7 +85,6 @@ ViewManager::ViewManager(
 ViewManager::~ViewManager()
 {
 	// free up allocated memory
-	m_pShaderManager = NULL;
 	m_pWindow = NULL;
 	if (NULL != g_pCamera)
 	{
@@ -85,6 +100,7 @@ ViewManager::~ViewManager()
  ***********************************************************/
 GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 {
+	PROFILE_SCOPE("ViewManager::CreateDisplayWindow");
 	GLFWwindow* window = nullptr;
 
 	// try to create the displayed OpenGL window
@@ -110,10 +126,6 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
 	// this callback is used to receive mouse scroll wheel events
 	glfwSetScrollCallback(window, &ViewManager::Mouse_Scroll_Wheel_Callback);
 
-	// enable blending for supporting tranparent rendering
-	glEnable(GL_BLEND);
-	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
 	m_pWindow = window;
 
 	return(window);
@@ -125,7 +137,7 @@ GLFWwindow* ViewManager::CreateDisplayWindow(const char* windowTitle)
  *  This method is automatically called from GLFW whenever
  *  the mouse is moved within the active GLFW display window.
  ***********************************************************/
-void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos, double yMousePos)
+void ViewManager::Mouse_Position_Callback(GLFWwindow* /*window*/, double xMousePos, double yMousePos)
 {
 	// when the first mouse move event is received, this needs to be recorded so that
 	// all subsequent mouse moves can correctly calculate the X position offset and Y
@@ -155,7 +167,7 @@ void ViewManager::Mouse_Position_Callback(GLFWwindow* window, double xMousePos,
  *  This method is automatically called from GLFW whenever
  *  the mouse wheel is scrolled within the active GLFW display window.
  ***********************************************************/
-void ViewManager::Mouse_Scroll_Wheel_Callback(GLFWwindow* window, double x, double yScrollDistance)
+void ViewManager::Mouse_Scroll_Wheel_Callback(GLFWwindow* /*window*/, double /*x*/, double yScrollDistance)
 {
 	// Call the camera method to handle the mouse wheel scrolling
 	g_pCamera->ProcessMouseScroll(yScrollDistance);
@@ -170,12 +182,21 @@ void ViewManager::Mouse_Scroll_Wheel_Callback(GLFWwindow* window, double x, doub
  ***********************************************************/
 void ViewManager::ProcessKeyboardEvents()
 {
+	PROFILE_SCOPE("ViewManager::ProcessKeyboardEvents");
 	// close the window if the escape key has been pressed
 	if (glfwGetKey(m_pWindow, GLFW_KEY_ESCAPE) == GLFW_PRESS)
 	{
 		glfwSetWindowShouldClose(m_pWindow, true);
 	}
 
+	// show or hide the performance HUD once per press of H
+	bool bHudKeyDown = (glfwGetKey(m_pWindow, GLFW_KEY_H) == GLFW_PRESS);
+	if (bHudKeyDown && !m_bHudKeyDown)
+	{
+		m_bHudVisible = !m_bHudVisible;
+	}
+	m_bHudKeyDown = bHudKeyDown;
+
 	// if the camera object is null, then exit this method
 	if (NULL == g_pCamera)
 	{
@@ -244,6 +265,19 @@ void ViewManager::ProcessKeyboardEvents()
 		g_pCamera->Front = glm::vec3(0.0f, -1.0f, 0.0f);
 	}
 
+	// switch between the loaded scenes - 0 shows the built in
+	// layout, 1 through 9 the scene files in loading order,
+	// once per press like the HUD toggle
+	for (int key = 0; key <= 9; key++)
+	{
+		bool bKeyDown = (glfwGetKey(m_pWindow, GLFW_KEY_0 + key) == GLFW_PRESS);
+		if (bKeyDown && !m_bSceneKeysDown[key])
+		{
+			m_sceneRequest = key - 1;
+		}
+		m_bSceneKeysDown[key] = bKeyDown;
+	}
+
 	if (glfwGetKey(m_pWindow, GLFW_KEY_P) == GLFW_PRESS && bOrthographicProjection)
 	{
 		// Only change to perspective projection if currently in orthographic mode
@@ -261,8 +295,9 @@ void ViewManager::ProcessKeyboardEvents()
  *  the shapes, textures in memory to support the 3D scene 
  *  rendering
  ***********************************************************/
-void ViewManager::PrepareSceneView()
+void ViewManager::PrepareSceneView(RenderCommandList& commands)
 {
+	PROFILE_SCOPE("ViewManager::PrepareSceneView");
 	glm::mat4 view;
 	glm::mat4 projection;
 
@@ -279,16 +314,80 @@ void ViewManager::PrepareSceneView()
 	view = g_pCamera->GetViewMatrix();
 
 	// define the current projection matrix
-	projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, 0.1f, 100.0f);
+	projection = glm::perspective(glm::radians(g_pCamera->Zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, NEAR_PLANE, FAR_PLANE);
+
+	// set the view matrix into the shader for proper rendering
+	commands.SetMat4(g_ViewName, view);
+	// set the view matrix into the shader for proper rendering
+	commands.SetMat4(g_ProjectionName, projection);
+	// set the view position of the camera into the shader for proper rendering
+	commands.SetVec3("viewPosition", g_pCamera->Position);
+}
 
-	// if the shader manager object is valid
-	if (NULL != m_pShaderManager)
-	{
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ViewName, view);
-		// set the view matrix into the shader for proper rendering
-		m_pShaderManager->setMat4Value(g_ProjectionName, projection);
-		// set the view position of the camera into the shader for proper rendering
-		m_pShaderManager->setVec3Value("viewPosition", g_pCamera->Position);
-	}
-}
\ No newline at end of file
+/***********************************************************
+ *  TakeSceneRequest()
+ *
+ *  This method is used for getting the scene selected with
+ *  the number keys, and clearing the request.
+ ***********************************************************/
+int ViewManager::TakeSceneRequest()
+{
+	int sceneRequest = m_sceneRequest;
+	m_sceneRequest = NO_SCENE_REQUEST;
+	return(sceneRequest);
+}
+
+/***********************************************************
+ *  GetDefaultView()
+ *
+ *  This method is used for getting the window size and the
+ *  view of the camera when the application starts, for
+ *  rendering the scene without a window.
+ ***********************************************************/
+void ViewManager::GetDefaultView(
+	int& width,
+	int& height,
+	glm::mat4& view,
+	glm::mat4& projection,
+	glm::vec3& viewPosition)
+{
+	width = WINDOW_WIDTH;
+	height = WINDOW_HEIGHT;
+	GetCameraView(DEFAULT_CAMERA_POSITION, DEFAULT_CAMERA_FRONT, DEFAULT_CAMERA_ZOOM, view, projection);
+	viewPosition = DEFAULT_CAMERA_POSITION;
+}
+
+/***********************************************************
+ *  GetCameraView()
+ *
+ *  This method is used for getting the view and projection
+ *  of a camera looking along a direction, such as the views
+ *  of the regression runs.
+ ***********************************************************/
+void ViewManager::GetCameraView(
+	const glm::vec3& position,
+	const glm::vec3& front,
+	float zoom,
+	glm::mat4& view,
+	glm::mat4& projection)
+{
+	view = glm::lookAt(position, position + front, DEFAULT_CAMERA_UP);
+	projection = glm::perspective(glm::radians(zoom), (GLfloat)WINDOW_WIDTH / (GLfloat)WINDOW_HEIGHT, NEAR_PLANE, FAR_PLANE);
+}
+
+/***********************************************************
+ *  PrepareView()
+ *
+ *  This method is used for recording a camera view the way
+ *  PrepareSceneView() records the view of the window.
+ ***********************************************************/
+void ViewManager::PrepareView(
+	RenderCommandList& commands,
+	const glm::mat4& view,
+	const glm::mat4& projection,
+	const glm::vec3& viewPosition)
+{
+	commands.SetMat4(g_ViewName, view);
+	commands.SetMat4(g_ProjectionName, projection);
+	commands.SetVec3("viewPosition", viewPosition);
+}
@@ -9,18 +9,18 @@
 
 #pragma once
 
-#include "ShaderManager.h"
+#include "RenderDevice.h"
 #include "camera.h"
 
-// GLFW library
+// GLEW and GLFW libraries
+#include <GL/glew.h>
 #include "GLFW/glfw3.h" 
 
 class ViewManager
 {
 public:
 	// constructor
-	ViewManager(
-		ShaderManager* pShaderManager);
+	ViewManager();
 	// destructor
 	~ViewManager();
 
@@ -31,10 +31,15 @@ public:
 	static void Mouse_Scroll_Wheel_Callback(GLFWwindow* window, double x, double yScrollDistance);
 
 private:
-	// pointer to shader manager object
-	ShaderManager* m_pShaderManager;
 	// active OpenGL display window
 	GLFWwindow* m_pWindow;
+	// scene selected with the number keys, not yet handled,
+	// and the number keys held down
+	int m_sceneRequest;
+	bool m_bSceneKeysDown[10];
+	// performance HUD shown, and the toggle key held down
+	bool m_bHudVisible;
+	bool m_bHudKeyDown;
 
 	// process keyboard events for interaction with the 3D scene
 	void ProcessKeyboardEvents();
@@ -44,5 +49,34 @@ public:
 	GLFWwindow* CreateDisplayWindow(const char* windowTitle);
 	
 	// prepare the conversion from 3D object display to 2D scene display
-	void PrepareSceneView();
+	void PrepareSceneView(RenderCommandList& commands);
+
+	// value of TakeSceneRequest() when no number key was pressed
+	static const int NO_SCENE_REQUEST = -2;
+	// get the scene index selected with the number keys since
+	// the last call, -1 for the built in layout
+	int TakeSceneRequest();
+	// true while the performance HUD is switched on
+	bool IsHudVisible() const { return(m_bHudVisible); }
+
+	// get the window size and the starting camera view
+	static void GetDefaultView(
+		int& width,
+		int& height,
+		glm::mat4& view,
+		glm::mat4& projection,
+		glm::vec3& viewPosition);
+	// get the view of a camera, with the projection of the window
+	static void GetCameraView(
+		const glm::vec3& position,
+		const glm::vec3& front,
+		float zoom,
+		glm::mat4& view,
+		glm::mat4& projection);
+	// record a camera view, for rendering without a window
+	static void PrepareView(
+		RenderCommandList& commands,
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		const glm::vec3& viewPosition);
 };
\ No newline at end of file
@@ -0,0 +1,2237 @@
+///////////////////////////////////////////////////////////////////////////////
+// vulkanrenderdevice.cpp
+// ============
+// run the render device objects and command lists with Vulkan
+///////////////////////////////////////////////////////////////////////////////
+
+#ifdef RENDER_DEVICE_VULKAN
+
+#include "VulkanRenderDevice.h"
+#include "ParallelFor.h"
+#include "Profiler.h"
+
+#include <glm/gtc/packing.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+// declaration of global variables
+namespace
+{
+	// submissions that can be in flight at once
+	const size_t FRAME_COUNT = 3;
+	// sizes of the texture arrays, as in sceneBlocks.glsl
+	const uint32_t MAX_TEXTURES = 1024;
+	const uint32_t MAX_CUBE_TEXTURES = 64;
+	// object block sets that can be made, one per uniform buffer
+	const uint32_t MAX_OBJECT_SETS = 256;
+	// starting size of the uniform values of a frame
+	const size_t INITIAL_UNIFORM_SIZE = 1 << 20;
+	// fewest draws worth handing to another worker - the
+	// scenes are a few dozen draws, so they still spread over
+	// the workers
+	const size_t MIN_CHUNK_DRAWS = 8;
+	const VkFormat COLOR_FORMAT = VK_FORMAT_B8G8R8A8_UNORM;
+
+	// vertex layout of the basic shapes and text - position,
+	// normal and texture coordinate
+	const int FLOATS_PER_VERTEX = 8;
+
+	const int TOTAL_POINT_LIGHTS = 5;
+
+	// std140 layout of GlobalBlock in sceneBlocks.glsl
+	struct POINT_LIGHT_BLOCK
+	{
+		glm::vec4 position;
+		glm::vec4 ambient;
+		glm::vec4 diffuse;
+		glm::vec4 specular;
+		glm::ivec4 bActive;
+	};
+
+	struct GLOBAL_BLOCK
+	{
+		glm::mat4 model;
+		glm::mat4 view;
+		glm::mat4 projection;
+		glm::vec4 objectColor;
+		glm::vec4 viewPosition;
+		glm::vec4 UVscale;
+		glm::vec4 materialDiffuseColor;
+		glm::vec4 materialSpecularColor;
+		glm::vec4 materialParameters;
+		glm::vec4 directionalDirection;
+		glm::vec4 directionalAmbient;
+		glm::vec4 directionalDiffuse;
+		glm::vec4 directionalSpecular;
+		POINT_LIGHT_BLOCK pointLightBlocks[TOTAL_POINT_LIGHTS];
+		glm::vec4 spotPosition;
+		glm::vec4 spotDirection;
+		glm::vec4 spotAmbient;
+		glm::vec4 spotDiffuse;
+		glm::vec4 spotSpecular;
+		glm::vec4 spotParameters;
+		glm::vec4 scalars;
+		glm::ivec4 switches;
+		glm::ivec4 moreSwitches;
+		glm::ivec4 samplerSlots;
+		glm::ivec4 slotTextures[4];
+	};
+
+	// size of ObjectBlock in sceneBlocks.glsl
+	const size_t OBJECT_BLOCK_SIZE = sizeof(float) * 24;
+
+	// Vulkan formats of the texture formats - the 3 channel
+	// formats are widened to 4 and the floats are packed to
+	// half floats, since those are what every driver samples
+	struct VULKAN_TEXTURE_FORMAT
+	{
+		VkFormat format;
+		int sourceChannels;
+		int channels;
+		bool bHalfFloat;
+	};
+	const VULKAN_TEXTURE_FORMAT g_TextureFormats[] = {
+		{ VK_FORMAT_R8_UNORM, 1, 1, false },
+		{ VK_FORMAT_R8G8B8A8_UNORM, 3, 4, false },
+		{ VK_FORMAT_R8G8B8A8_UNORM, 4, 4, false },
+		{ VK_FORMAT_R16G16_SFLOAT, 2, 2, true },
+		{ VK_FORMAT_R16G16B16A16_SFLOAT, 3, 4, true } };
+
+	// copy pixels into the layout of the Vulkan format
+	void ConvertPixels(const VULKAN_TEXTURE_FORMAT& format, const void* source, size_t pixelCount, unsigned char* destination)
+	{
+		if (format.bHalfFloat)
+		{
+			const float* pSource = (const float*)source;
+			uint16_t* pDestination = (uint16_t*)destination;
+			for (size_t i = 0; i < pixelCount; i++)
+			{
+				for (int c = 0; c < format.channels; c++)
+				{
+					float value = (c < format.sourceChannels) ? pSource[c] : 1.0f;
+					pDestination[c] = glm::packHalf1x16(value);
+				}
+				pSource += format.sourceChannels;
+				pDestination += format.channels;
+			}
+			return;
+		}
+
+		const unsigned char* pSource = (const unsigned char*)source;
+		if (format.sourceChannels == format.channels)
+		{
+			memcpy(destination, pSource, pixelCount * format.channels);
+			return;
+		}
+		for (size_t i = 0; i < pixelCount; i++)
+		{
+			for (int c = 0; c < format.channels; c++)
+			{
+				destination[c] = (c < format.sourceChannels) ? pSource[c] : 255;
+			}
+			pSource += format.sourceChannels;
+			destination += format.channels;
+		}
+	}
+
+	// image layout change of the whole image
+	void TransitionImage(
+		VkCommandBuffer commandBuffer,
+		VkImage image,
+		VkImageAspectFlags aspect,
+		VkImageLayout oldLayout,
+		VkImageLayout newLayout,
+		VkAccessFlags sourceAccess,
+		VkAccessFlags destinationAccess,
+		VkPipelineStageFlags sourceStage,
+		VkPipelineStageFlags destinationStage,
+		uint32_t baseLevel = 0,
+		uint32_t levelCount = VK_REMAINING_MIP_LEVELS)
+	{
+		VkImageMemoryBarrier barrier = {};
+		barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		barrier.srcAccessMask = sourceAccess;
+		barrier.dstAccessMask = destinationAccess;
+		barrier.oldLayout = oldLayout;
+		barrier.newLayout = newLayout;
+		barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		barrier.image = image;
+		barrier.subresourceRange.aspectMask = aspect;
+		barrier.subresourceRange.baseMipLevel = baseLevel;
+		barrier.subresourceRange.levelCount = levelCount;
+		barrier.subresourceRange.baseArrayLayer = 0;
+		barrier.subresourceRange.layerCount = VK_REMAINING_ARRAY_LAYERS;
+		vkCmdPipelineBarrier(commandBuffer, sourceStage, destinationStage, 0, 0, NULL, 0, NULL, 1, &barrier);
+	}
+}
+
+/***********************************************************
+ *  VulkanRenderDevice()
+ *
+ *  The constructor for the class
+ ***********************************************************/
+VulkanRenderDevice::VulkanRenderDevice(int windowWidth, int windowHeight)
+{
+	m_windowWidth = windowWidth;
+	m_windowHeight = windowHeight;
+
+	m_instance = VK_NULL_HANDLE;
+	m_physicalDevice = VK_NULL_HANDLE;
+	m_device = VK_NULL_HANDLE;
+	m_queue = VK_NULL_HANDLE;
+	m_queueFamily = 0;
+	memset(&m_memoryProperties, 0, sizeof(m_memoryProperties));
+	m_uniformBufferAlignment = 256;
+	m_depthFormat = VK_FORMAT_D32_SFLOAT;
+	m_uploadPool = VK_NULL_HANDLE;
+
+	m_clearRenderPass = VK_NULL_HANDLE;
+	m_loadRenderPass = VK_NULL_HANDLE;
+	m_vertexShader = VK_NULL_HANDLE;
+	m_fragmentShader = VK_NULL_HANDLE;
+	m_pipelineLayout = VK_NULL_HANDLE;
+	for (int i = 0; i < 4; i++)
+	{
+		m_samplers[i] = VK_NULL_HANDLE;
+	}
+
+	m_textureSetLayout = VK_NULL_HANDLE;
+	m_globalSetLayout = VK_NULL_HANDLE;
+	m_objectSetLayout = VK_NULL_HANDLE;
+	m_textureDescriptorPool = VK_NULL_HANDLE;
+	m_descriptorPool = VK_NULL_HANDLE;
+	m_textureSet = VK_NULL_HANDLE;
+	m_defaultTextures[0] = 0;
+	m_defaultTextures[1] = 0;
+	m_defaultObjectBuffer = 0;
+	m_windowTarget = 0;
+
+	m_nextHandle = 1;
+	m_frameIndex = 0;
+
+	m_bGlobalValuesChanged = true;
+	m_currentTarget = 0;
+	m_currentPipeline = 0;
+	m_currentObjectSet = VK_NULL_HANDLE;
+	m_currentObjectOffset = 0;
+	m_currentGlobalOffset = 0;
+}
+
+/***********************************************************
+ *  ~VulkanRenderDevice()
+ *
+ *  The destructor for the class
+ ***********************************************************/
+VulkanRenderDevice::~VulkanRenderDevice()
+{
+	if (m_device != VK_NULL_HANDLE)
+	{
+		vkDeviceWaitIdle(m_device);
+
+		// free whatever the users did not destroy themselves
+		while (!m_pipelines.empty())
+		{
+			DestroyPipeline(m_pipelines.begin()->first);
+		}
+		while (!m_textures.empty())
+		{
+			DestroyTexture(m_textures.begin()->first);
+		}
+		while (!m_buffers.empty())
+		{
+			DestroyBuffer(m_buffers.begin()->first);
+		}
+		while (!m_targets.empty())
+		{
+			DestroyRenderTarget(m_targets.begin()->first);
+		}
+
+		for (size_t i = 0; i < m_frames.size(); i++)
+		{
+			FRAME& frame = m_frames[i];
+			for (size_t j = 0; j < frame.chunkPools.size(); j++)
+			{
+				vkDestroyCommandPool(m_device, frame.chunkPools[j], NULL);
+			}
+			// freeing the pool frees its command buffers
+			vkDestroyCommandPool(m_device, frame.commandPool, NULL);
+			vkDestroyFence(m_device, frame.fence, NULL);
+			DestroyBufferObject(frame.uniforms);
+		}
+		m_frames.clear();
+
+		for (int i = 0; i < 4; i++)
+		{
+			vkDestroySampler(m_device, m_samplers[i], NULL);
+		}
+		vkDestroyDescriptorPool(m_device, m_descriptorPool, NULL);
+		vkDestroyDescriptorPool(m_device, m_textureDescriptorPool, NULL);
+		vkDestroyPipelineLayout(m_device, m_pipelineLayout, NULL);
+		vkDestroyDescriptorSetLayout(m_device, m_objectSetLayout, NULL);
+		vkDestroyDescriptorSetLayout(m_device, m_globalSetLayout, NULL);
+		vkDestroyDescriptorSetLayout(m_device, m_textureSetLayout, NULL);
+		vkDestroyShaderModule(m_device, m_fragmentShader, NULL);
+		vkDestroyShaderModule(m_device, m_vertexShader, NULL);
+		vkDestroyRenderPass(m_device, m_loadRenderPass, NULL);
+		vkDestroyRenderPass(m_device, m_clearRenderPass, NULL);
+		vkDestroyCommandPool(m_device, m_uploadPool, NULL);
+		vkDestroyDevice(m_device, NULL);
+		m_device = VK_NULL_HANDLE;
+	}
+	if (m_instance != VK_NULL_HANDLE)
+	{
+		vkDestroyInstance(m_instance, NULL);
+		m_instance = VK_NULL_HANDLE;
+	}
+}
+
+/***********************************************************
+ *  Create()
+ *
+ *  This method is used for creating the Vulkan device, the
+ *  objects every draw shares and the window target.  The
+ *  shader files are SPIR-V compiled from shaders/vulkan.
+ ***********************************************************/
+bool VulkanRenderDevice::Create(const char* vertexShaderFilename, const char* fragmentShaderFilename)
+{
+	if (!CreateDevice() || !CreateRenderPasses() || !CreateDescriptors() || !CreateFrames())
+	{
+		return(false);
+	}
+
+	m_vertexShader = LoadShader(vertexShaderFilename);
+	m_fragmentShader = LoadShader(fragmentShaderFilename);
+	if ((m_vertexShader == VK_NULL_HANDLE) || (m_fragmentShader == VK_NULL_HANDLE))
+	{
+		return(false);
+	}
+
+	// the values a new OpenGL program starts with are 0, the
+	// ones the scene code counts on being set are set here
+	CreateUniformEntries();
+	m_globalValues.assign(sizeof(GLOBAL_BLOCK), 0);
+	GLOBAL_BLOCK* pValues = (GLOBAL_BLOCK*)m_globalValues.data();
+	pValues->objectColor = glm::vec4(1.0f);
+	pValues->UVscale = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+	pValues->scalars.y = 1.0f;
+	m_bGlobalValuesChanged = true;
+
+	// white textures take index 0 of the arrays, so slots
+	// nothing is bound to still sample something
+	const unsigned char white[4] = { 255, 255, 255, 255 };
+	const void* whiteFaces[6] = { white, white, white, white, white, white };
+	TEXTURE_DESC textureDesc = GetTextureDesc(FORMAT_RGBA8, 1, 1);
+	textureDesc.bGenerateMipmaps = false;
+	m_defaultTextures[TEXTURE_2D] = CreateTexture(textureDesc, whiteFaces);
+	textureDesc.type = TEXTURE_CUBE;
+	m_defaultTextures[TEXTURE_CUBE] = CreateTexture(textureDesc, whiteFaces);
+
+	BUFFER_DESC bufferDesc;
+	bufferDesc.type = BUFFER_UNIFORM;
+	bufferDesc.size = OBJECT_BLOCK_SIZE;
+	bufferDesc.bDynamic = false;
+	std::vector<unsigned char> zeros(OBJECT_BLOCK_SIZE, 0);
+	m_defaultObjectBuffer = CreateBuffer(bufferDesc, zeros.data());
+	m_currentObjectSet = GetObjectSet(m_defaultObjectBuffer, OBJECT_BLOCK_SIZE);
+
+	m_windowTarget = CreateRenderTarget(m_windowWidth, m_windowHeight);
+	m_currentTarget = m_windowTarget;
+
+	if ((m_defaultTextures[TEXTURE_2D] == 0) || (m_defaultTextures[TEXTURE_CUBE] == 0) ||
+		(m_currentObjectSet == VK_NULL_HANDLE) || (m_windowTarget == 0))
+	{
+		std::cout << "ERROR: could not create the Vulkan device objects" << std::endl;
+		return(false);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  CreateDevice()
+ *
+ *  This method is used for creating the instance and a
+ *  device with a graphics queue and the descriptor indexing
+ *  features.  No surface is needed, so a GPU or the lavapipe
+ *  CPU driver work the same - a GPU is picked first.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateDevice()
+{
+	VkApplicationInfo appInfo = {};
+	appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+	appInfo.pApplicationName = "7-1 FinalProject and Milestones";
+	appInfo.apiVersion = VK_API_VERSION_1_2;
+
+	VkInstanceCreateInfo instanceInfo = {};
+	instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+	instanceInfo.pApplicationInfo = &appInfo;
+	if (vkCreateInstance(&instanceInfo, NULL, &m_instance) != VK_SUCCESS)
+	{
+		std::cout << "ERROR: could not create a Vulkan 1.2 instance" << std::endl;
+		return(false);
+	}
+
+	uint32_t deviceCount = 0;
+	vkEnumeratePhysicalDevices(m_instance, &deviceCount, NULL);
+	std::vector<VkPhysicalDevice> devices(deviceCount);
+	vkEnumeratePhysicalDevices(m_instance, &deviceCount, devices.data());
+
+	bool bFoundGPU = false;
+	for (uint32_t i = 0; (i < deviceCount) && !bFoundGPU; i++)
+	{
+		VkPhysicalDeviceProperties properties;
+		vkGetPhysicalDeviceProperties(devices[i], &properties);
+		if (properties.apiVersion < VK_API_VERSION_1_2)
+		{
+			continue;
+		}
+
+		VkPhysicalDeviceVulkan12Features features12 = {};
+		features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+		VkPhysicalDeviceFeatures2 features = {};
+		features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		features.pNext = &features12;
+		vkGetPhysicalDeviceFeatures2(devices[i], &features);
+		if (!features12.descriptorBindingPartiallyBound ||
+			!features12.descriptorBindingSampledImageUpdateAfterBind ||
+			!features12.descriptorBindingUpdateUnusedWhilePending ||
+			!features.features.shaderSampledImageArrayDynamicIndexing)
+		{
+			continue;
+		}
+
+		uint32_t familyCount = 0;
+		vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &familyCount, NULL);
+		std::vector<VkQueueFamilyProperties> families(familyCount);
+		vkGetPhysicalDeviceQueueFamilyProperties(devices[i], &familyCount, families.data());
+		for (uint32_t j = 0; j < familyCount; j++)
+		{
+			if ((families[j].queueFlags & VK_QUEUE_GRAPHICS_BIT) == 0)
+			{
+				continue;
+			}
+			// keep the first usable device, unless a GPU comes later
+			bool bGPU = (properties.deviceType != VK_PHYSICAL_DEVICE_TYPE_CPU);
+			if ((m_physicalDevice == VK_NULL_HANDLE) || bGPU)
+			{
+				m_physicalDevice = devices[i];
+				m_queueFamily = j;
+				bFoundGPU = bGPU;
+			}
+			break;
+		}
+	}
+	if (m_physicalDevice == VK_NULL_HANDLE)
+	{
+		std::cout << "ERROR: no Vulkan 1.2 device with descriptor indexing was found" << std::endl;
+		return(false);
+	}
+
+	VkPhysicalDeviceProperties properties;
+	vkGetPhysicalDeviceProperties(m_physicalDevice, &properties);
+	vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+	m_uniformBufferAlignment = (size_t)properties.limits.minUniformBufferOffsetAlignment;
+	std::cout << "INFO: Vulkan device: " << properties.deviceName << std::endl;
+
+	float priority = 1.0f;
+	VkDeviceQueueCreateInfo queueInfo = {};
+	queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+	queueInfo.queueFamilyIndex = m_queueFamily;
+	queueInfo.queueCount = 1;
+	queueInfo.pQueuePriorities = &priority;
+
+	VkPhysicalDeviceVulkan12Features features12 = {};
+	features12.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES;
+	features12.descriptorBindingPartiallyBound = VK_TRUE;
+	features12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+	features12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+	VkPhysicalDeviceFeatures2 features = {};
+	features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+	features.pNext = &features12;
+	features.features.shaderSampledImageArrayDynamicIndexing = VK_TRUE;
+
+	VkDeviceCreateInfo deviceInfo = {};
+	deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+	deviceInfo.pNext = &features;
+	deviceInfo.queueCreateInfoCount = 1;
+	deviceInfo.pQueueCreateInfos = &queueInfo;
+	if (vkCreateDevice(m_physicalDevice, &deviceInfo, NULL, &m_device) != VK_SUCCESS)
+	{
+		std::cout << "ERROR: could not create the Vulkan device" << std::endl;
+		return(false);
+	}
+	vkGetDeviceQueue(m_device, m_queueFamily, 0, &m_queue);
+
+	VkFormatProperties formatProperties;
+	vkGetPhysicalDeviceFormatProperties(m_physicalDevice, VK_FORMAT_D32_SFLOAT, &formatProperties);
+	if ((formatProperties.optimalTilingFeatures & VK_FORMAT_FEATURE_DEPTH_STENCIL_ATTACHMENT_BIT) == 0)
+	{
+		m_depthFormat = VK_FORMAT_D24_UNORM_S8_UINT;
+	}
+
+	VkCommandPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+	poolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+	poolInfo.queueFamilyIndex = m_queueFamily;
+	return(vkCreateCommandPool(m_device, &poolInfo, NULL, &m_uploadPool) == VK_SUCCESS);
+}
+
+/***********************************************************
+ *  CreateRenderPasses()
+ *
+ *  This method is used for creating the render passes of a
+ *  color and depth target - one clears the attachments and
+ *  one keeps what was drawn by the earlier submissions.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateRenderPasses()
+{
+	VkAttachmentReference colorReference = { 0, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL };
+	VkAttachmentReference depthReference = { 1, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL };
+	VkSubpassDescription subpass = {};
+	subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
+	subpass.colorAttachmentCount = 1;
+	subpass.pColorAttachments = &colorReference;
+	subpass.pDepthStencilAttachment = &depthReference;
+
+	// draws of one pass wait for the draws of the pass before
+	VkSubpassDependency dependency = {};
+	dependency.srcSubpass = VK_SUBPASS_EXTERNAL;
+	dependency.dstSubpass = 0;
+	dependency.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT |
+		VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_LATE_FRAGMENT_TESTS_BIT;
+	dependency.dstStageMask = dependency.srcStageMask;
+	dependency.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+	dependency.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT |
+		VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT;
+
+	for (int i = 0; i < 2; i++)
+	{
+		bool bClear = (i == 0);
+
+		VkAttachmentDescription attachments[2] = {};
+		attachments[0].format = COLOR_FORMAT;
+		attachments[1].format = m_depthFormat;
+		for (int j = 0; j < 2; j++)
+		{
+			attachments[j].samples = VK_SAMPLE_COUNT_1_BIT;
+			attachments[j].loadOp = bClear ? VK_ATTACHMENT_LOAD_OP_CLEAR : VK_ATTACHMENT_LOAD_OP_LOAD;
+			attachments[j].storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+			attachments[j].stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
+			attachments[j].stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE;
+		}
+		attachments[0].finalLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		attachments[1].finalLayout = VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL;
+		attachments[0].initialLayout = bClear ? VK_IMAGE_LAYOUT_UNDEFINED : attachments[0].finalLayout;
+		attachments[1].initialLayout = bClear ? VK_IMAGE_LAYOUT_UNDEFINED : attachments[1].finalLayout;
+
+		VkRenderPassCreateInfo renderPassInfo = {};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_CREATE_INFO;
+		renderPassInfo.attachmentCount = 2;
+		renderPassInfo.pAttachments = attachments;
+		renderPassInfo.subpassCount = 1;
+		renderPassInfo.pSubpasses = &subpass;
+		renderPassInfo.dependencyCount = 1;
+		renderPassInfo.pDependencies = &dependency;
+		VkRenderPass& renderPass = bClear ? m_clearRenderPass : m_loadRenderPass;
+		if (vkCreateRenderPass(m_device, &renderPassInfo, NULL, &renderPass) != VK_SUCCESS)
+		{
+			std::cout << "ERROR: could not create the Vulkan render passes" << std::endl;
+			return(false);
+		}
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  CreateDescriptors()
+ *
+ *  This method is used for creating the descriptor set
+ *  layouts and pools, the pipeline layout, the texture
+ *  array set and the samplers.  The texture arrays can be
+ *  written while submissions that do not use the written
+ *  elements are running.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateDescriptors()
+{
+	VkDescriptorSetLayoutBinding textureBindings[2] = {};
+	textureBindings[0].binding = 0;
+	textureBindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	textureBindings[0].descriptorCount = MAX_TEXTURES;
+	textureBindings[0].stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+	textureBindings[1] = textureBindings[0];
+	textureBindings[1].binding = 1;
+	textureBindings[1].descriptorCount = MAX_CUBE_TEXTURES;
+
+	VkDescriptorBindingFlags bindingFlags[2];
+	bindingFlags[0] = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT |
+		VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT |
+		VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+	bindingFlags[1] = bindingFlags[0];
+	VkDescriptorSetLayoutBindingFlagsCreateInfo bindingFlagsInfo = {};
+	bindingFlagsInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+	bindingFlagsInfo.bindingCount = 2;
+	bindingFlagsInfo.pBindingFlags = bindingFlags;
+
+	VkDescriptorSetLayoutCreateInfo layoutInfo = {};
+	layoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+	layoutInfo.pNext = &bindingFlagsInfo;
+	layoutInfo.flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT;
+	layoutInfo.bindingCount = 2;
+	layoutInfo.pBindings = textureBindings;
+	if (vkCreateDescriptorSetLayout(m_device, &layoutInfo, NULL, &m_textureSetLayout) != VK_SUCCESS)
+	{
+		std::cout << "ERROR: could not create the Vulkan texture array layout" << std::endl;
+		return(false);
+	}
+
+	// the uniform values and the object block are bound with
+	// dynamic offsets, so moving to the next draw's values is
+	// not a descriptor change
+	VkDescriptorSetLayoutBinding uniformBinding = {};
+	uniformBinding.binding = 0;
+	uniformBinding.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	uniformBinding.descriptorCount = 1;
+	uniformBinding.stageFlags = VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+	layoutInfo.pNext = NULL;
+	layoutInfo.flags = 0;
+	layoutInfo.bindingCount = 1;
+	layoutInfo.pBindings = &uniformBinding;
+	if ((vkCreateDescriptorSetLayout(m_device, &layoutInfo, NULL, &m_globalSetLayout) != VK_SUCCESS) ||
+		(vkCreateDescriptorSetLayout(m_device, &layoutInfo, NULL, &m_objectSetLayout) != VK_SUCCESS))
+	{
+		std::cout << "ERROR: could not create the Vulkan uniform block layouts" << std::endl;
+		return(false);
+	}
+
+	VkDescriptorSetLayout setLayouts[3] = { m_textureSetLayout, m_globalSetLayout, m_objectSetLayout };
+	VkPipelineLayoutCreateInfo pipelineLayoutInfo = {};
+	pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+	pipelineLayoutInfo.setLayoutCount = 3;
+	pipelineLayoutInfo.pSetLayouts = setLayouts;
+	if (vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, NULL, &m_pipelineLayout) != VK_SUCCESS)
+	{
+		std::cout << "ERROR: could not create the Vulkan pipeline layout" << std::endl;
+		return(false);
+	}
+
+	VkDescriptorPoolSize textureSize = { VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, MAX_TEXTURES + MAX_CUBE_TEXTURES };
+	VkDescriptorPoolCreateInfo poolInfo = {};
+	poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+	poolInfo.maxSets = 1;
+	poolInfo.poolSizeCount = 1;
+	poolInfo.pPoolSizes = &textureSize;
+	if (vkCreateDescriptorPool(m_device, &poolInfo, NULL, &m_textureDescriptorPool) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	VkDescriptorPoolSize uniformSize = { VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, (uint32_t)FRAME_COUNT + MAX_OBJECT_SETS };
+	poolInfo.flags = VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT;
+	poolInfo.maxSets = uniformSize.descriptorCount;
+	poolInfo.pPoolSizes = &uniformSize;
+	if (vkCreateDescriptorPool(m_device, &poolInfo, NULL, &m_descriptorPool) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	VkDescriptorSetAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocateInfo.descriptorPool = m_textureDescriptorPool;
+	allocateInfo.descriptorSetCount = 1;
+	allocateInfo.pSetLayouts = &m_textureSetLayout;
+	if (vkAllocateDescriptorSets(m_device, &allocateInfo, &m_textureSet) != VK_SUCCESS)
+	{
+		return(false);
+	}
+
+	// handed out from the back, so the lowest index goes first
+	for (uint32_t i = MAX_TEXTURES; i > 0; i--)
+	{
+		m_freeTextureIndices[TEXTURE_2D].push_back(i - 1);
+	}
+	for (uint32_t i = MAX_CUBE_TEXTURES; i > 0; i--)
+	{
+		m_freeTextureIndices[TEXTURE_CUBE].push_back(i - 1);
+	}
+
+	for (int i = 0; i < 4; i++)
+	{
+		bool bRepeat = (i & 1) != 0;
+		bool bMipmapFiltering = (i & 2) != 0;
+		VkSamplerAddressMode addressMode = bRepeat ? VK_SAMPLER_ADDRESS_MODE_REPEAT : VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE;
+
+		VkSamplerCreateInfo samplerInfo = {};
+		samplerInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		samplerInfo.magFilter = VK_FILTER_LINEAR;
+		samplerInfo.minFilter = VK_FILTER_LINEAR;
+		samplerInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		samplerInfo.addressModeU = addressMode;
+		samplerInfo.addressModeV = addressMode;
+		samplerInfo.addressModeW = addressMode;
+		// without mipmap filtering only the top level is used
+		samplerInfo.maxLod = bMipmapFiltering ? VK_LOD_CLAMP_NONE : 0.0f;
+		if (vkCreateSampler(m_device, &samplerInfo, NULL, &m_samplers[i]) != VK_SUCCESS)
+		{
+			return(false);
+		}
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  CreateFrames()
+ *
+ *  This method is used for creating the command pools,
+ *  fences and uniform value buffers of the frames that can
+ *  be in flight together.  The command buffers are made as
+ *  the submissions of a frame need them.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateFrames()
+{
+	// cleared first, so the destructor can tell what was made
+	FRAME emptyFrame;
+	emptyFrame.fence = VK_NULL_HANDLE;
+	emptyFrame.commandPool = VK_NULL_HANDLE;
+	emptyFrame.submitCount = 0;
+	emptyFrame.chunkCount = 0;
+	emptyFrame.uniforms.buffer = VK_NULL_HANDLE;
+	emptyFrame.uniforms.memory = VK_NULL_HANDLE;
+	emptyFrame.uniforms.pMapped = NULL;
+	emptyFrame.uniforms.size = 0;
+	emptyFrame.uniforms.objectSet = VK_NULL_HANDLE;
+	emptyFrame.globalSet = VK_NULL_HANDLE;
+	emptyFrame.uniformOffset = 0;
+	m_frames.assign(FRAME_COUNT, emptyFrame);
+
+	for (size_t i = 0; i < FRAME_COUNT; i++)
+	{
+		FRAME& frame = m_frames[i];
+
+		// signaled, so the first wait for the frame returns
+		VkFenceCreateInfo fenceInfo = {};
+		fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		fenceInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT;
+		VkCommandPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.queueFamilyIndex = m_queueFamily;
+		if ((vkCreateFence(m_device, &fenceInfo, NULL, &frame.fence) != VK_SUCCESS) ||
+			(vkCreateCommandPool(m_device, &poolInfo, NULL, &frame.commandPool) != VK_SUCCESS))
+		{
+			return(false);
+		}
+
+		if (!CreateBufferObject(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, INITIAL_UNIFORM_SIZE, frame.uniforms))
+		{
+			return(false);
+		}
+
+		VkDescriptorSetAllocateInfo allocateInfo = {};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		allocateInfo.descriptorPool = m_descriptorPool;
+		allocateInfo.descriptorSetCount = 1;
+		allocateInfo.pSetLayouts = &m_globalSetLayout;
+		if (vkAllocateDescriptorSets(m_device, &allocateInfo, &frame.globalSet) != VK_SUCCESS)
+		{
+			return(false);
+		}
+
+		VkDescriptorBufferInfo bufferInfo = { frame.uniforms.buffer, 0, sizeof(GLOBAL_BLOCK) };
+		VkWriteDescriptorSet write = {};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = frame.globalSet;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		write.pBufferInfo = &bufferInfo;
+		vkUpdateDescriptorSets(m_device, 1, &write, 0, NULL);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  LoadShader()
+ *
+ *  This method is used for loading a SPIR-V shader file.
+ ***********************************************************/
+VkShaderModule VulkanRenderDevice::LoadShader(const char* filename)
+{
+	std::ifstream file(filename, std::ios::binary | std::ios::ate);
+	if (!file.is_open())
+	{
+		std::cout << "ERROR: could not open the Vulkan shader " << filename << std::endl;
+		return(VK_NULL_HANDLE);
+	}
+	size_t size = (size_t)file.tellg();
+	std::vector<uint32_t> code((size + 3) / 4);
+	file.seekg(0);
+	file.read((char*)code.data(), size);
+
+	VkShaderModuleCreateInfo shaderInfo = {};
+	shaderInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+	shaderInfo.codeSize = size;
+	shaderInfo.pCode = code.data();
+	VkShaderModule shader = VK_NULL_HANDLE;
+	if (vkCreateShaderModule(m_device, &shaderInfo, NULL, &shader) != VK_SUCCESS)
+	{
+		std::cout << "ERROR: " << filename << " is not a SPIR-V shader" << std::endl;
+	}
+	return(shader);
+}
+
+/***********************************************************
+ *  CreateUniformEntries()
+ *
+ *  This method is used for mapping the uniform names of the
+ *  OpenGL shader to their place in GlobalBlock.  The values
+ *  the Vulkan shaders pack into a vector get the offset of
+ *  their component.
+ ***********************************************************/
+void VulkanRenderDevice::CreateUniformEntries()
+{
+	struct NAMED_OFFSET
+	{
+		const char* name;
+		size_t offset;
+	};
+	const size_t FLOAT_SIZE = sizeof(float);
+	const NAMED_OFFSET entries[] = {
+		{ "model", offsetof(GLOBAL_BLOCK, model) },
+		{ "view", offsetof(GLOBAL_BLOCK, view) },
+		{ "projection", offsetof(GLOBAL_BLOCK, projection) },
+		{ "objectColor", offsetof(GLOBAL_BLOCK, objectColor) },
+		{ "viewPosition", offsetof(GLOBAL_BLOCK, viewPosition) },
+		{ "UVscale", offsetof(GLOBAL_BLOCK, UVscale) },
+		{ "material.diffuseColor", offsetof(GLOBAL_BLOCK, materialDiffuseColor) },
+		{ "material.specularColor", offsetof(GLOBAL_BLOCK, materialSpecularColor) },
+		{ "material.shininess", offsetof(GLOBAL_BLOCK, materialParameters) },
+		{ "material.metallic", offsetof(GLOBAL_BLOCK, materialParameters) + FLOAT_SIZE },
+		{ "material.roughness", offsetof(GLOBAL_BLOCK, materialParameters) + FLOAT_SIZE * 2 },
+		{ "directionalLight.direction", offsetof(GLOBAL_BLOCK, directionalDirection) },
+		{ "directionalLight.ambient", offsetof(GLOBAL_BLOCK, directionalAmbient) },
+		{ "directionalLight.diffuse", offsetof(GLOBAL_BLOCK, directionalDiffuse) },
+		{ "directionalLight.specular", offsetof(GLOBAL_BLOCK, directionalSpecular) },
+		{ "directionalLight.bActive", offsetof(GLOBAL_BLOCK, moreSwitches) + FLOAT_SIZE * 2 },
+		{ "spotLight.position", offsetof(GLOBAL_BLOCK, spotPosition) },
+		{ "spotLight.direction", offsetof(GLOBAL_BLOCK, spotDirection) },
+		{ "spotLight.ambient", offsetof(GLOBAL_BLOCK, spotAmbient) },
+		{ "spotLight.diffuse", offsetof(GLOBAL_BLOCK, spotDiffuse) },
+		{ "spotLight.specular", offsetof(GLOBAL_BLOCK, spotSpecular) },
+		{ "spotLight.cutOff", offsetof(GLOBAL_BLOCK, spotParameters) },
+		{ "spotLight.outerCutOff", offsetof(GLOBAL_BLOCK, spotParameters) + FLOAT_SIZE },
+		{ "spotLight.constant", offsetof(GLOBAL_BLOCK, spotParameters) + FLOAT_SIZE * 2 },
+		{ "spotLight.linear", offsetof(GLOBAL_BLOCK, spotParameters) + FLOAT_SIZE * 3 },
+		{ "spotLight.quadratic", offsetof(GLOBAL_BLOCK, scalars) },
+		{ "spotLight.bActive", offsetof(GLOBAL_BLOCK, moreSwitches) + FLOAT_SIZE * 3 },
+		{ "prefilterMipLevels", offsetof(GLOBAL_BLOCK, scalars) + FLOAT_SIZE },
+		{ "bUseTexture", offsetof(GLOBAL_BLOCK, switches) },
+		{ "bUseLighting", offsetof(GLOBAL_BLOCK, switches) + FLOAT_SIZE },
+		{ "bUsePBR", offsetof(GLOBAL_BLOCK, switches) + FLOAT_SIZE * 2 },
+		{ "bUseEnvironmentMap", offsetof(GLOBAL_BLOCK, switches) + FLOAT_SIZE * 3 },
+		{ "bUseObjectBlock", offsetof(GLOBAL_BLOCK, moreSwitches) },
+		{ "bUseTextSDF", offsetof(GLOBAL_BLOCK, moreSwitches) + FLOAT_SIZE },
+		{ "objectTexture", offsetof(GLOBAL_BLOCK, samplerSlots) },
+		{ "brdfLUT", offsetof(GLOBAL_BLOCK, samplerSlots) + FLOAT_SIZE },
+		{ "irradianceMap", offsetof(GLOBAL_BLOCK, samplerSlots) + FLOAT_SIZE * 2 },
+		{ "prefilterMap", offsetof(GLOBAL_BLOCK, samplerSlots) + FLOAT_SIZE * 3 } };
+
+	m_uniformEntries.clear();
+	for (size_t i = 0; i < sizeof(entries) / sizeof(entries[0]); i++)
+	{
+		UNIFORM_ENTRY entry;
+		entry.name = entries[i].name;
+		entry.offset = (uint32_t)entries[i].offset;
+		m_uniformEntries.push_back(entry);
+	}
+
+	const char* lightValues[] = { "position", "ambient", "diffuse", "specular", "bActive" };
+	for (int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+	{
+		size_t lightOffset = offsetof(GLOBAL_BLOCK, pointLightBlocks) + sizeof(POINT_LIGHT_BLOCK) * i;
+		for (int j = 0; j < 5; j++)
+		{
+			UNIFORM_ENTRY entry;
+			entry.name = "pointLights[" + std::to_string(i) + "]." + lightValues[j];
+			entry.offset = (uint32_t)(lightOffset + sizeof(glm::vec4) * j);
+			m_uniformEntries.push_back(entry);
+		}
+	}
+
+	std::sort(m_uniformEntries.begin(), m_uniformEntries.end(),
+		[](const UNIFORM_ENTRY& a, const UNIFORM_ENTRY& b) { return(a.name < b.name); });
+}
+
+/***********************************************************
+ *  GetShapeBuffer()
+ *
+ *  This method is used for getting the vertex buffer of the
+ *  parts of a basic shape, made from the ShapeGeometry mesh
+ *  the first time it is asked for.
+ ***********************************************************/
+RENDER_BUFFER VulkanRenderDevice::GetShapeBuffer(uint32_t meshType, uint32_t parts, uint32_t& vertexCount)
+{
+	uint32_t key = (meshType << 16) | (parts & 0xFFFF);
+	std::map<uint32_t, std::pair<RENDER_BUFFER, uint32_t> >::const_iterator it = m_shapeBuffers.find(key);
+	if (it != m_shapeBuffers.end())
+	{
+		vertexCount = it->second.second;
+		return(it->second.first);
+	}
+
+	// the draws are not indexed, so the triangles are spelled
+	// out one vertex at a time
+	const ShapeGeometry::MESH& mesh = m_shapeGeometry.GetMesh(meshType, parts);
+	std::vector<float> vertices;
+	vertices.reserve(mesh.indices.size() * FLOATS_PER_VERTEX);
+	for (size_t i = 0; i < mesh.indices.size(); i++)
+	{
+		const ShapeGeometry::VERTEX& vertex = mesh.vertices[mesh.indices[i]];
+		vertices.push_back(vertex.position.x);
+		vertices.push_back(vertex.position.y);
+		vertices.push_back(vertex.position.z);
+		vertices.push_back(vertex.normal.x);
+		vertices.push_back(vertex.normal.y);
+		vertices.push_back(vertex.normal.z);
+		vertices.push_back(vertex.uv.x);
+		vertices.push_back(vertex.uv.y);
+	}
+
+	RENDER_BUFFER buffer = 0;
+	vertexCount = (uint32_t)mesh.indices.size();
+	if (vertexCount > 0)
+	{
+		BUFFER_DESC desc;
+		desc.type = BUFFER_VERTEX;
+		desc.size = vertices.size() * sizeof(float);
+		desc.bDynamic = false;
+		buffer = CreateBuffer(desc, vertices.data());
+	}
+	m_shapeBuffers[key] = std::make_pair(buffer, vertexCount);
+	return(buffer);
+}
+
+/***********************************************************
+ *  FindMemoryType()
+ *
+ *  This method is used for finding a memory type that a
+ *  resource can use and that has the wanted properties.
+ ***********************************************************/
+bool VulkanRenderDevice::FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t& memoryType) const
+{
+	for (uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++)
+	{
+		if (((typeBits & (1u << i)) != 0) &&
+			((m_memoryProperties.memoryTypes[i].propertyFlags & properties) == properties))
+		{
+			memoryType = i;
+			return(true);
+		}
+	}
+	return(false);
+}
+
+/***********************************************************
+ *  CreateBufferObject()
+ *
+ *  This method is used for creating a buffer in host
+ *  visible memory, which stays mapped until it is destroyed.
+ *  The memory is coherent, so writes need no flushing.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateBufferObject(VkBufferUsageFlags usage, size_t size, BUFFER_OBJECT& buffer)
+{
+	buffer.buffer = VK_NULL_HANDLE;
+	buffer.memory = VK_NULL_HANDLE;
+	buffer.pMapped = NULL;
+	buffer.size = size;
+	buffer.objectSet = VK_NULL_HANDLE;
+
+	VkBufferCreateInfo bufferInfo = {};
+	bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+	bufferInfo.size = std::max(size, (size_t)1);
+	bufferInfo.usage = usage;
+	bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	if (vkCreateBuffer(m_device, &bufferInfo, NULL, &buffer.buffer) != VK_SUCCESS)
+	{
+		std::cout << "ERROR: could not create a Vulkan buffer of " << size << " bytes" << std::endl;
+		return(false);
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetBufferMemoryRequirements(m_device, buffer.buffer, &requirements);
+	VkMemoryAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = requirements.size;
+	if (!FindMemoryType(requirements.memoryTypeBits,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
+			allocateInfo.memoryTypeIndex) ||
+		(vkAllocateMemory(m_device, &allocateInfo, NULL, &buffer.memory) != VK_SUCCESS) ||
+		(vkBindBufferMemory(m_device, buffer.buffer, buffer.memory, 0) != VK_SUCCESS) ||
+		(vkMapMemory(m_device, buffer.memory, 0, VK_WHOLE_SIZE, 0, &buffer.pMapped) != VK_SUCCESS))
+	{
+		std::cout << "ERROR: could not allocate the memory of a Vulkan buffer" << std::endl;
+		DestroyBufferObject(buffer);
+		return(false);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyBufferObject()
+ *
+ *  This method is used for destroying a buffer and freeing
+ *  its memory.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyBufferObject(BUFFER_OBJECT& buffer)
+{
+	if (buffer.objectSet != VK_NULL_HANDLE)
+	{
+		vkFreeDescriptorSets(m_device, m_descriptorPool, 1, &buffer.objectSet);
+	}
+	if (buffer.buffer != VK_NULL_HANDLE)
+	{
+		vkDestroyBuffer(m_device, buffer.buffer, NULL);
+	}
+	if (buffer.memory != VK_NULL_HANDLE)
+	{
+		// freeing the memory unmaps it
+		vkFreeMemory(m_device, buffer.memory, NULL);
+	}
+	buffer.buffer = VK_NULL_HANDLE;
+	buffer.memory = VK_NULL_HANDLE;
+	buffer.pMapped = NULL;
+	buffer.objectSet = VK_NULL_HANDLE;
+}
+
+/***********************************************************
+ *  CreateImage()
+ *
+ *  This method is used for creating an image in device
+ *  local memory.
+ ***********************************************************/
+bool VulkanRenderDevice::CreateImage(VkImageCreateInfo& imageInfo, VkImage& image, VkDeviceMemory& memory)
+{
+	image = VK_NULL_HANDLE;
+	memory = VK_NULL_HANDLE;
+	imageInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+	imageInfo.imageType = VK_IMAGE_TYPE_2D;
+	imageInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+	imageInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+	imageInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+	imageInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+	if (vkCreateImage(m_device, &imageInfo, NULL, &image) != VK_SUCCESS)
+	{
+		std::cout << "ERROR: could not create a Vulkan image of " << imageInfo.extent.width
+			<< "x" << imageInfo.extent.height << std::endl;
+		return(false);
+	}
+
+	VkMemoryRequirements requirements;
+	vkGetImageMemoryRequirements(m_device, image, &requirements);
+	VkMemoryAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+	allocateInfo.allocationSize = requirements.size;
+	if (!FindMemoryType(requirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, allocateInfo.memoryTypeIndex) ||
+		(vkAllocateMemory(m_device, &allocateInfo, NULL, &memory) != VK_SUCCESS) ||
+		(vkBindImageMemory(m_device, image, memory, 0) != VK_SUCCESS))
+	{
+		std::cout << "ERROR: could not allocate the memory of a Vulkan image" << std::endl;
+		vkDestroyImage(m_device, image, NULL);
+		if (memory != VK_NULL_HANDLE)
+		{
+			vkFreeMemory(m_device, memory, NULL);
+		}
+		image = VK_NULL_HANDLE;
+		memory = VK_NULL_HANDLE;
+		return(false);
+	}
+	return(true);
+}
+
+/***********************************************************
+ *  GetObjectSet()
+ *
+ *  This method is used for getting the descriptor set that
+ *  binds a uniform buffer as the object block.  The set is
+ *  made the first time the buffer is bound, and the range
+ *  of each draw is picked with a dynamic offset.
+ ***********************************************************/
+VkDescriptorSet VulkanRenderDevice::GetObjectSet(RENDER_BUFFER buffer, size_t size)
+{
+	std::unordered_map<uint32_t, BUFFER_OBJECT>::iterator it = m_buffers.find(buffer);
+	if (it == m_buffers.end())
+	{
+		return(VK_NULL_HANDLE);
+	}
+	BUFFER_OBJECT& object = it->second;
+	if (object.objectSet != VK_NULL_HANDLE)
+	{
+		return(object.objectSet);
+	}
+
+	VkDescriptorSetAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+	allocateInfo.descriptorPool = m_descriptorPool;
+	allocateInfo.descriptorSetCount = 1;
+	allocateInfo.pSetLayouts = &m_objectSetLayout;
+	if (vkAllocateDescriptorSets(m_device, &allocateInfo, &object.objectSet) != VK_SUCCESS)
+	{
+		std::cout << "ERROR: more than " << MAX_OBJECT_SETS << " object block buffers were bound" << std::endl;
+		object.objectSet = VK_NULL_HANDLE;
+		return(VK_NULL_HANDLE);
+	}
+
+	VkDescriptorBufferInfo bufferInfo = { object.buffer, 0, (VkDeviceSize)std::min(size, object.size) };
+	VkWriteDescriptorSet write = {};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = object.objectSet;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+	write.pBufferInfo = &bufferInfo;
+	vkUpdateDescriptorSets(m_device, 1, &write, 0, NULL);
+	return(object.objectSet);
+}
+
+/***********************************************************
+ *  BeginUpload()
+ *
+ *  This method is used for starting a command buffer that
+ *  is run right away by EndUpload(), for the transfers and
+ *  layout changes of creating and reading objects.
+ ***********************************************************/
+VkCommandBuffer VulkanRenderDevice::BeginUpload()
+{
+	VkCommandBufferAllocateInfo allocateInfo = {};
+	allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+	allocateInfo.commandPool = m_uploadPool;
+	allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+	allocateInfo.commandBufferCount = 1;
+	VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+	vkAllocateCommandBuffers(m_device, &allocateInfo, &commandBuffer);
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	return(commandBuffer);
+}
+
+/***********************************************************
+ *  EndUpload()
+ *
+ *  This method is used for running a command buffer from
+ *  BeginUpload() and waiting for it to finish.
+ ***********************************************************/
+void VulkanRenderDevice::EndUpload(VkCommandBuffer commandBuffer)
+{
+	vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	vkQueueSubmit(m_queue, 1, &submitInfo, VK_NULL_HANDLE);
+	vkQueueWaitIdle(m_queue);
+
+	vkFreeCommandBuffers(m_device, m_uploadPool, 1, &commandBuffer);
+}
+
+/***********************************************************
+ *  WaitForFrames()
+ *
+ *  This method is used for waiting until the submitted
+ *  frames are done, before an object they may use changes.
+ *  The fence of the current frame is only submitted by
+ *  EndFrame(), so the queue is waited for instead.
+ ***********************************************************/
+void VulkanRenderDevice::WaitForFrames()
+{
+	if (m_queue != VK_NULL_HANDLE)
+	{
+		vkQueueWaitIdle(m_queue);
+	}
+}
+
+/***********************************************************
+ *  CreateBuffer()
+ *
+ *  This method is used for creating a buffer.
+ ***********************************************************/
+RENDER_BUFFER VulkanRenderDevice::CreateBuffer(const BUFFER_DESC& desc, const void* data)
+{
+	VkBufferUsageFlags usage = (desc.type == BUFFER_VERTEX) ?
+		VK_BUFFER_USAGE_VERTEX_BUFFER_BIT : VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+
+	BUFFER_OBJECT buffer;
+	if (!CreateBufferObject(usage, desc.size, buffer))
+	{
+		return(0);
+	}
+	if (data != NULL)
+	{
+		memcpy(buffer.pMapped, data, desc.size);
+	}
+
+	RENDER_BUFFER handle = m_nextHandle++;
+	m_buffers[handle] = buffer;
+	return(handle);
+}
+
+/***********************************************************
+ *  UpdateBuffer()
+ *
+ *  This method is used for overwriting a range of a buffer.
+ *  The buffers are not copied for each frame, so this waits
+ *  for the frames that may read the old contents.
+ ***********************************************************/
+void VulkanRenderDevice::UpdateBuffer(RENDER_BUFFER buffer, size_t offset, size_t size, const void* data)
+{
+	std::unordered_map<uint32_t, BUFFER_OBJECT>::iterator it = m_buffers.find(buffer);
+	if ((it == m_buffers.end()) || (offset + size > it->second.size))
+	{
+		return;
+	}
+	WaitForFrames();
+	memcpy((unsigned char*)it->second.pMapped + offset, data, size);
+}
+
+/***********************************************************
+ *  CopyBuffer()
+ *
+ *  This method is used for copying the start of one buffer
+ *  into another.
+ ***********************************************************/
+void VulkanRenderDevice::CopyBuffer(RENDER_BUFFER source, RENDER_BUFFER destination, size_t size)
+{
+	std::unordered_map<uint32_t, BUFFER_OBJECT>::iterator sourceIt = m_buffers.find(source);
+	std::unordered_map<uint32_t, BUFFER_OBJECT>::iterator destinationIt = m_buffers.find(destination);
+	if ((sourceIt == m_buffers.end()) || (destinationIt == m_buffers.end()))
+	{
+		return;
+	}
+	size = std::min(size, std::min(sourceIt->second.size, destinationIt->second.size));
+	WaitForFrames();
+	memcpy(destinationIt->second.pMapped, sourceIt->second.pMapped, size);
+}
+
+/***********************************************************
+ *  DestroyBuffer()
+ *
+ *  This method is used for destroying a buffer.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyBuffer(RENDER_BUFFER buffer)
+{
+	std::unordered_map<uint32_t, BUFFER_OBJECT>::iterator it = m_buffers.find(buffer);
+	if (it == m_buffers.end())
+	{
+		return;
+	}
+	WaitForFrames();
+	if (m_currentObjectSet == it->second.objectSet)
+	{
+		m_currentObjectSet = VK_NULL_HANDLE;
+	}
+	DestroyBufferObject(it->second);
+	m_buffers.erase(it);
+}
+
+/***********************************************************
+ *  GetUniformBufferAlignment()
+ *
+ *  This method is used for getting the alignment of the
+ *  uniform buffer ranges.
+ ***********************************************************/
+size_t VulkanRenderDevice::GetUniformBufferAlignment() const
+{
+	return(m_uniformBufferAlignment);
+}
+
+/***********************************************************
+ *  CreateTexture()
+ *
+ *  This method is used for creating a texture.  The pixels
+ *  go through a staging buffer, the missing mip levels are
+ *  made by blitting each level from the one above, and the
+ *  texture is written into a free element of its array.
+ ***********************************************************/
+RENDER_TEXTURE VulkanRenderDevice::CreateTexture(const TEXTURE_DESC& desc, const void* const* data)
+{
+	if ((desc.format > FORMAT_RGB16F) || (desc.width <= 0) || (desc.height <= 0) ||
+		m_freeTextureIndices[desc.type == TEXTURE_CUBE ? TEXTURE_CUBE : TEXTURE_2D].empty())
+	{
+		std::cout << "ERROR: could not create a Vulkan texture of " << desc.width << "x" << desc.height << std::endl;
+		return(0);
+	}
+	const VULKAN_TEXTURE_FORMAT& format = g_TextureFormats[desc.format];
+	uint32_t type = (desc.type == TEXTURE_CUBE) ? TEXTURE_CUBE : TEXTURE_2D;
+	uint32_t faceCount = (type == TEXTURE_CUBE) ? 6 : 1;
+	uint32_t levelCount = (uint32_t)std::max(desc.mipLevels, 1);
+	uint32_t totalLevels = levelCount;
+	if (desc.bGenerateMipmaps)
+	{
+		totalLevels = 1;
+		for (int size = std::max(desc.width, desc.height); size > 1; size /= 2)
+		{
+			totalLevels++;
+		}
+	}
+
+	TEXTURE_OBJECT texture;
+	texture.type = type;
+	texture.view = VK_NULL_HANDLE;
+	VkImageCreateInfo imageInfo = {};
+	imageInfo.flags = (type == TEXTURE_CUBE) ? VK_IMAGE_CREATE_CUBE_COMPATIBLE_BIT : 0;
+	imageInfo.format = format.format;
+	imageInfo.extent.width = (uint32_t)desc.width;
+	imageInfo.extent.height = (uint32_t)desc.height;
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = totalLevels;
+	imageInfo.arrayLayers = faceCount;
+	imageInfo.usage = VK_IMAGE_USAGE_SAMPLED_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	if (!CreateImage(imageInfo, texture.image, texture.memory))
+	{
+		return(0);
+	}
+
+	// the levels that were passed in, converted to the Vulkan
+	// format - data is level by level, each with every face
+	size_t pixelSize = (format.bHalfFloat ? 2 : 1) * format.channels;
+	size_t stagingSize = 0;
+	for (uint32_t level = 0; level < levelCount; level++)
+	{
+		size_t width = std::max(desc.width >> level, 1);
+		size_t height = std::max(desc.height >> level, 1);
+		stagingSize += width * height * pixelSize * faceCount;
+	}
+	BUFFER_OBJECT staging;
+	bool bStaging = (data != NULL) && CreateBufferObject(VK_BUFFER_USAGE_TRANSFER_SRC_BIT, stagingSize, staging);
+
+	std::vector<VkBufferImageCopy> regions;
+	size_t stagingOffset = 0;
+	for (uint32_t level = 0; bStaging && (level < levelCount); level++)
+	{
+		uint32_t width = (uint32_t)std::max(desc.width >> level, 1);
+		uint32_t height = (uint32_t)std::max(desc.height >> level, 1);
+		for (uint32_t face = 0; face < faceCount; face++)
+		{
+			const void* pixels = data[level * faceCount + face];
+			if (pixels == NULL)
+			{
+				continue;
+			}
+			ConvertPixels(format, pixels, (size_t)width * height, (unsigned char*)staging.pMapped + stagingOffset);
+
+			VkBufferImageCopy region = {};
+			region.bufferOffset = stagingOffset;
+			region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+			region.imageSubresource.mipLevel = level;
+			region.imageSubresource.baseArrayLayer = face;
+			region.imageSubresource.layerCount = 1;
+			region.imageExtent.width = width;
+			region.imageExtent.height = height;
+			region.imageExtent.depth = 1;
+			regions.push_back(region);
+			stagingOffset += (size_t)width * height * pixelSize;
+		}
+	}
+
+	VkCommandBuffer commandBuffer = BeginUpload();
+	TransitionImage(commandBuffer, texture.image, VK_IMAGE_ASPECT_COLOR_BIT,
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+		0, VK_ACCESS_TRANSFER_WRITE_BIT,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	if (!regions.empty())
+	{
+		vkCmdCopyBufferToImage(commandBuffer, staging.buffer, texture.image,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, (uint32_t)regions.size(), regions.data());
+	}
+	// each generated level is blitted from the one above it,
+	// which is then done and moved to the sampled layout
+	for (uint32_t level = levelCount; level < totalLevels; level++)
+	{
+		TransitionImage(commandBuffer, texture.image, VK_IMAGE_ASPECT_COLOR_BIT,
+			VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, level - 1, 1);
+
+		VkImageBlit blit = {};
+		blit.srcSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		blit.srcSubresource.mipLevel = level - 1;
+		blit.srcSubresource.layerCount = faceCount;
+		blit.srcOffsets[1].x = std::max(desc.width >> (level - 1), 1);
+		blit.srcOffsets[1].y = std::max(desc.height >> (level - 1), 1);
+		blit.srcOffsets[1].z = 1;
+		blit.dstSubresource = blit.srcSubresource;
+		blit.dstSubresource.mipLevel = level;
+		blit.dstOffsets[1].x = std::max(desc.width >> level, 1);
+		blit.dstOffsets[1].y = std::max(desc.height >> level, 1);
+		blit.dstOffsets[1].z = 1;
+		vkCmdBlitImage(commandBuffer,
+			texture.image, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+			texture.image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+			1, &blit, VK_FILTER_LINEAR);
+
+		TransitionImage(commandBuffer, texture.image, VK_IMAGE_ASPECT_COLOR_BIT,
+			VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+			VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_SHADER_READ_BIT,
+			VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT, level - 1, 1);
+	}
+	uint32_t firstRemaining = (totalLevels > levelCount) ? totalLevels - 1 : 0;
+	TransitionImage(commandBuffer, texture.image, VK_IMAGE_ASPECT_COLOR_BIT,
+		VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL,
+		VK_ACCESS_TRANSFER_WRITE_BIT, VK_ACCESS_SHADER_READ_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT,
+		firstRemaining, totalLevels - firstRemaining);
+	EndUpload(commandBuffer);
+	if (bStaging)
+	{
+		DestroyBufferObject(staging);
+	}
+
+	VkImageViewCreateInfo viewInfo = {};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.image = texture.image;
+	viewInfo.viewType = (type == TEXTURE_CUBE) ? VK_IMAGE_VIEW_TYPE_CUBE : VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.format = format.format;
+	viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	viewInfo.subresourceRange.levelCount = totalLevels;
+	viewInfo.subresourceRange.layerCount = faceCount;
+	if (vkCreateImageView(m_device, &viewInfo, NULL, &texture.view) != VK_SUCCESS)
+	{
+		vkDestroyImage(m_device, texture.image, NULL);
+		vkFreeMemory(m_device, texture.memory, NULL);
+		return(0);
+	}
+
+	texture.arrayIndex = m_freeTextureIndices[type].back();
+	m_freeTextureIndices[type].pop_back();
+
+	int samplerIndex = (desc.bRepeat ? 1 : 0) | (desc.bMipmapFiltering ? 2 : 0);
+	VkDescriptorImageInfo imageDescriptor = { m_samplers[samplerIndex], texture.view, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL };
+	VkWriteDescriptorSet write = {};
+	write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+	write.dstSet = m_textureSet;
+	write.dstBinding = type;
+	write.dstArrayElement = texture.arrayIndex;
+	write.descriptorCount = 1;
+	write.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+	write.pImageInfo = &imageDescriptor;
+	vkUpdateDescriptorSets(m_device, 1, &write, 0, NULL);
+
+	RENDER_TEXTURE handle = m_nextHandle++;
+	m_textures[handle] = texture;
+	return(handle);
+}
+
+/***********************************************************
+ *  DestroyTexture()
+ *
+ *  This method is used for destroying a texture.  Its array
+ *  element is not read again until a new texture is written
+ *  into it.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyTexture(RENDER_TEXTURE texture)
+{
+	std::unordered_map<uint32_t, TEXTURE_OBJECT>::iterator it = m_textures.find(texture);
+	if (it == m_textures.end())
+	{
+		return;
+	}
+	WaitForFrames();
+	vkDestroyImageView(m_device, it->second.view, NULL);
+	vkDestroyImage(m_device, it->second.image, NULL);
+	vkFreeMemory(m_device, it->second.memory, NULL);
+	m_freeTextureIndices[it->second.type].push_back(it->second.arrayIndex);
+	m_textures.erase(it);
+}
+
+/***********************************************************
+ *  CreateRenderTarget()
+ *
+ *  This method is used for creating an offscreen color and
+ *  depth target, left in the layouts the render passes
+ *  start and end in.
+ ***********************************************************/
+RENDER_TARGET VulkanRenderDevice::CreateRenderTarget(int width, int height)
+{
+	if ((width <= 0) || (height <= 0))
+	{
+		return(0);
+	}
+
+	TARGET_OBJECT target = {};
+	target.width = width;
+	target.height = height;
+
+	VkImageCreateInfo imageInfo = {};
+	imageInfo.format = COLOR_FORMAT;
+	imageInfo.extent.width = (uint32_t)width;
+	imageInfo.extent.height = (uint32_t)height;
+	imageInfo.extent.depth = 1;
+	imageInfo.mipLevels = 1;
+	imageInfo.arrayLayers = 1;
+	imageInfo.usage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+	bool bCreated = CreateImage(imageInfo, target.colorImage, target.colorMemory);
+	imageInfo.format = m_depthFormat;
+	imageInfo.usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT;
+	bCreated = CreateImage(imageInfo, target.depthImage, target.depthMemory) && bCreated;
+
+	VkImageAspectFlags depthAspect = VK_IMAGE_ASPECT_DEPTH_BIT;
+	if (m_depthFormat == VK_FORMAT_D24_UNORM_S8_UINT)
+	{
+		depthAspect |= VK_IMAGE_ASPECT_STENCIL_BIT;
+	}
+
+	VkImageViewCreateInfo viewInfo = {};
+	viewInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+	viewInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+	viewInfo.subresourceRange.levelCount = 1;
+	viewInfo.subresourceRange.layerCount = 1;
+	if (bCreated)
+	{
+		viewInfo.image = target.colorImage;
+		viewInfo.format = COLOR_FORMAT;
+		viewInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+		bCreated = (vkCreateImageView(m_device, &viewInfo, NULL, &target.colorView) == VK_SUCCESS);
+	}
+	if (bCreated)
+	{
+		viewInfo.image = target.depthImage;
+		viewInfo.format = m_depthFormat;
+		viewInfo.subresourceRange.aspectMask = depthAspect;
+		bCreated = (vkCreateImageView(m_device, &viewInfo, NULL, &target.depthView) == VK_SUCCESS);
+	}
+	if (bCreated)
+	{
+		VkImageView attachments[2] = { target.colorView, target.depthView };
+		VkFramebufferCreateInfo framebufferInfo = {};
+		framebufferInfo.sType = VK_STRUCTURE_TYPE_FRAMEBUFFER_CREATE_INFO;
+		framebufferInfo.renderPass = m_loadRenderPass;
+		framebufferInfo.attachmentCount = 2;
+		framebufferInfo.pAttachments = attachments;
+		framebufferInfo.width = (uint32_t)width;
+		framebufferInfo.height = (uint32_t)height;
+		framebufferInfo.layers = 1;
+		bCreated = (vkCreateFramebuffer(m_device, &framebufferInfo, NULL, &target.framebuffer) == VK_SUCCESS);
+	}
+
+	RENDER_TARGET handle = m_nextHandle++;
+	m_targets[handle] = target;
+	if (!bCreated)
+	{
+		std::cout << "ERROR: could not create a Vulkan render target of " << width << "x" << height << std::endl;
+		DestroyRenderTarget(handle);
+		return(0);
+	}
+
+	VkCommandBuffer commandBuffer = BeginUpload();
+	TransitionImage(commandBuffer, target.colorImage, VK_IMAGE_ASPECT_COLOR_BIT,
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+		0, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+	TransitionImage(commandBuffer, target.depthImage, depthAspect,
+		VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL,
+		0, VK_ACCESS_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT,
+		VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_EARLY_FRAGMENT_TESTS_BIT);
+	EndUpload(commandBuffer);
+	return(handle);
+}
+
+/***********************************************************
+ *  ReadPixels()
+ *
+ *  This method is used for reading back the color of a
+ *  target, after the submitted frames are done.  The rows
+ *  are flipped, so the bottom row comes first as it does
+ *  with OpenGL.
+ ***********************************************************/
+bool VulkanRenderDevice::ReadPixels(RENDER_TARGET target, int width, int height, void* pixels)
+{
+	std::unordered_map<uint32_t, TARGET_OBJECT>::const_iterator it =
+		m_targets.find((target == 0) ? m_windowTarget : target);
+	if ((it == m_targets.end()) || (width <= 0) || (height <= 0) ||
+		(width > it->second.width) || (height > it->second.height))
+	{
+		return(false);
+	}
+	const TARGET_OBJECT& object = it->second;
+
+	size_t rowSize = (size_t)width * 4;
+	BUFFER_OBJECT readback;
+	if (!CreateBufferObject(VK_BUFFER_USAGE_TRANSFER_DST_BIT, rowSize * height, readback))
+	{
+		return(false);
+	}
+	WaitForFrames();
+
+	VkCommandBuffer commandBuffer = BeginUpload();
+	TransitionImage(commandBuffer, object.colorImage, VK_IMAGE_ASPECT_COLOR_BIT,
+		VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_TRANSFER_READ_BIT,
+		VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT);
+	VkBufferImageCopy region = {};
+	region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+	region.imageSubresource.layerCount = 1;
+	region.imageExtent.width = (uint32_t)width;
+	region.imageExtent.height = (uint32_t)height;
+	region.imageExtent.depth = 1;
+	vkCmdCopyImageToBuffer(commandBuffer, object.colorImage, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL,
+		readback.buffer, 1, &region);
+	TransitionImage(commandBuffer, object.colorImage, VK_IMAGE_ASPECT_COLOR_BIT,
+		VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+		VK_ACCESS_TRANSFER_READ_BIT, VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+		VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT);
+
+	// make the copied pixels visible to the host
+	VkMemoryBarrier barrier = {};
+	barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+	barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+	barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+	vkCmdPipelineBarrier(commandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_HOST_BIT,
+		0, 1, &barrier, 0, NULL, 0, NULL);
+	EndUpload(commandBuffer);
+
+	const unsigned char* pSource = (const unsigned char*)readback.pMapped;
+	unsigned char* pDestination = (unsigned char*)pixels;
+	for (int y = 0; y < height; y++)
+	{
+		memcpy(pDestination + rowSize * y, pSource + rowSize * (height - 1 - y), rowSize);
+	}
+	DestroyBufferObject(readback);
+	return(true);
+}
+
+/***********************************************************
+ *  DestroyRenderTarget()
+ *
+ *  This method is used for destroying a render target.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyRenderTarget(RENDER_TARGET target)
+{
+	std::unordered_map<uint32_t, TARGET_OBJECT>::iterator it = m_targets.find(target);
+	if (it == m_targets.end())
+	{
+		return;
+	}
+	WaitForFrames();
+	TARGET_OBJECT& object = it->second;
+	vkDestroyFramebuffer(m_device, object.framebuffer, NULL);
+	vkDestroyImageView(m_device, object.colorView, NULL);
+	vkDestroyImageView(m_device, object.depthView, NULL);
+	vkDestroyImage(m_device, object.colorImage, NULL);
+	vkDestroyImage(m_device, object.depthImage, NULL);
+	vkFreeMemory(m_device, object.colorMemory, NULL);
+	vkFreeMemory(m_device, object.depthMemory, NULL);
+	m_targets.erase(it);
+	if (m_currentTarget == target)
+	{
+		m_currentTarget = m_windowTarget;
+	}
+}
+
+/***********************************************************
+ *  GetWindowSize()
+ *
+ *  This method is used for getting the size of the window
+ *  target.
+ ***********************************************************/
+void VulkanRenderDevice::GetWindowSize(int& width, int& height) const
+{
+	width = m_windowWidth;
+	height = m_windowHeight;
+}
+
+/***********************************************************
+ *  CreatePipeline()
+ *
+ *  This method is used for creating a graphics pipeline
+ *  with the scene shaders.  The object block always has its
+ *  own descriptor set, so the uniform block name is not
+ *  needed.
+ ***********************************************************/
+RENDER_PIPELINE VulkanRenderDevice::CreatePipeline(const PIPELINE_DESC& desc)
+{
+	VkPipelineShaderStageCreateInfo stages[2] = {};
+	stages[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+	stages[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+	stages[0].module = m_vertexShader;
+	stages[0].pName = "main";
+	stages[1] = stages[0];
+	stages[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+	stages[1].module = m_fragmentShader;
+
+	VkVertexInputBindingDescription binding = { 0, sizeof(float) * FLOATS_PER_VERTEX, VK_VERTEX_INPUT_RATE_VERTEX };
+	VkVertexInputAttributeDescription attributes[3] = {
+		{ 0, 0, VK_FORMAT_R32G32B32_SFLOAT, 0 },
+		{ 1, 0, VK_FORMAT_R32G32B32_SFLOAT, sizeof(float) * 3 },
+		{ 2, 0, VK_FORMAT_R32G32_SFLOAT, sizeof(float) * 6 } };
+	VkPipelineVertexInputStateCreateInfo vertexInput = {};
+	vertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+	vertexInput.vertexBindingDescriptionCount = 1;
+	vertexInput.pVertexBindingDescriptions = &binding;
+	vertexInput.vertexAttributeDescriptionCount = 3;
+	vertexInput.pVertexAttributeDescriptions = attributes;
+
+	VkPipelineInputAssemblyStateCreateInfo inputAssembly = {};
+	inputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+	inputAssembly.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+	// the viewport and scissor are set for each target
+	VkPipelineViewportStateCreateInfo viewportState = {};
+	viewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+	viewportState.viewportCount = 1;
+	viewportState.scissorCount = 1;
+	VkDynamicState dynamicStates[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+	VkPipelineDynamicStateCreateInfo dynamicState = {};
+	dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+	dynamicState.dynamicStateCount = 2;
+	dynamicState.pDynamicStates = dynamicStates;
+
+	// no face culling, as with the OpenGL defaults the scene
+	// code draws with
+	VkPipelineRasterizationStateCreateInfo rasterization = {};
+	rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+	rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+	rasterization.cullMode = VK_CULL_MODE_NONE;
+	rasterization.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+	rasterization.depthBiasEnable = desc.bPolygonOffset ? VK_TRUE : VK_FALSE;
+	rasterization.depthBiasConstantFactor = -1.0f;
+	rasterization.depthBiasSlopeFactor = -1.0f;
+	rasterization.lineWidth = 1.0f;
+
+	VkPipelineMultisampleStateCreateInfo multisample = {};
+	multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+	multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+
+	VkPipelineDepthStencilStateCreateInfo depthStencil = {};
+	depthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+	depthStencil.depthTestEnable = desc.bDepthTest ? VK_TRUE : VK_FALSE;
+	depthStencil.depthWriteEnable = desc.bDepthWrite ? VK_TRUE : VK_FALSE;
+	depthStencil.depthCompareOp = VK_COMPARE_OP_LESS;
+
+	VkPipelineColorBlendAttachmentState blendAttachment = {};
+	blendAttachment.blendEnable = (desc.blendMode == BLEND_ALPHA) ? VK_TRUE : VK_FALSE;
+	blendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	blendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	blendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+	blendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+	blendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+	blendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+	blendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT |
+		VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+	VkPipelineColorBlendStateCreateInfo colorBlend = {};
+	colorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+	colorBlend.attachmentCount = 1;
+	colorBlend.pAttachments = &blendAttachment;
+
+	VkGraphicsPipelineCreateInfo pipelineInfo = {};
+	pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+	pipelineInfo.stageCount = 2;
+	pipelineInfo.pStages = stages;
+	pipelineInfo.pVertexInputState = &vertexInput;
+	pipelineInfo.pInputAssemblyState = &inputAssembly;
+	pipelineInfo.pViewportState = &viewportState;
+	pipelineInfo.pRasterizationState = &rasterization;
+	pipelineInfo.pMultisampleState = &multisample;
+	pipelineInfo.pDepthStencilState = &depthStencil;
+	pipelineInfo.pColorBlendState = &colorBlend;
+	pipelineInfo.pDynamicState = &dynamicState;
+	pipelineInfo.layout = m_pipelineLayout;
+	pipelineInfo.renderPass = m_loadRenderPass;
+	pipelineInfo.subpass = 0;
+
+	VkPipeline pipeline = VK_NULL_HANDLE;
+	if (vkCreateGraphicsPipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, NULL, &pipeline) != VK_SUCCESS)
+	{
+		std::cout << "ERROR: could not create a Vulkan pipeline" << std::endl;
+		return(0);
+	}
+
+	RENDER_PIPELINE handle = m_nextHandle++;
+	m_pipelines[handle] = pipeline;
+	return(handle);
+}
+
+/***********************************************************
+ *  DestroyPipeline()
+ *
+ *  This method is used for destroying a pipeline.
+ ***********************************************************/
+void VulkanRenderDevice::DestroyPipeline(RENDER_PIPELINE pipeline)
+{
+	std::unordered_map<uint32_t, VkPipeline>::iterator it = m_pipelines.find(pipeline);
+	if (it == m_pipelines.end())
+	{
+		return;
+	}
+	WaitForFrames();
+	vkDestroyPipeline(m_device, it->second, NULL);
+	m_pipelines.erase(it);
+}
+
+/***********************************************************
+ *  ApplyUniform()
+ *
+ *  This method is used for writing the value of a uniform
+ *  command into the uniform values.  Names the shaders do
+ *  not have are ignored, as OpenGL does, and a value that
+ *  does not change leaves the values as they were.
+ ***********************************************************/
+void VulkanRenderDevice::ApplyUniform(const RenderCommandList& commands, const RenderCommandList::COMMAND& command)
+{
+	const char* name = commands.GetName(command);
+	std::vector<UNIFORM_ENTRY>::const_iterator it = std::lower_bound(
+		m_uniformEntries.begin(), m_uniformEntries.end(), name,
+		[](const UNIFORM_ENTRY& entry, const char* value) { return(strcmp(entry.name.c_str(), value) < 0); });
+	if ((it == m_uniformEntries.end()) || (strcmp(it->name.c_str(), name) != 0))
+	{
+		return;
+	}
+
+	size_t size = 0;
+	switch (command.type)
+	{
+	case RenderCommandList::COMMAND_SET_INT:
+	case RenderCommandList::COMMAND_SET_FLOAT:
+		size = 4;
+		break;
+	case RenderCommandList::COMMAND_SET_VEC2:
+		size = 8;
+		break;
+	case RenderCommandList::COMMAND_SET_VEC3:
+		size = 12;
+		break;
+	case RenderCommandList::COMMAND_SET_VEC4:
+		size = 16;
+		break;
+	case RenderCommandList::COMMAND_SET_MAT4:
+		size = 64;
+		break;
+	}
+
+	// the int shares its storage with the first float
+	unsigned char* pValue = &m_globalValues[it->offset];
+	if (memcmp(pValue, command.floatValues, size) != 0)
+	{
+		memcpy(pValue, command.floatValues, size);
+		m_bGlobalValuesChanged = true;
+	}
+}
+
+/***********************************************************
+ *  WriteGlobalValues()
+ *
+ *  This method is used for copying the uniform values into
+ *  the frame's mapped buffer when they changed since the
+ *  last draw, growing the buffer when it is full.
+ ***********************************************************/
+bool VulkanRenderDevice::WriteGlobalValues(FRAME& frame)
+{
+	if (!m_bGlobalValuesChanged)
+	{
+		return(true);
+	}
+
+	size_t alignment = m_uniformBufferAlignment;
+	size_t offset = (frame.uniformOffset + alignment - 1) / alignment * alignment;
+	if (offset + m_globalValues.size() > frame.uniforms.size)
+	{
+		// the earlier submissions of the frame read the buffer,
+		// so they are finished before the values written so far
+		// are moved to a bigger one
+		if (frame.submitCount > 0)
+		{
+			WaitForFrames();
+		}
+		BUFFER_OBJECT uniforms;
+		if (!CreateBufferObject(VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT, frame.uniforms.size * 2, uniforms))
+		{
+			return(false);
+		}
+		memcpy(uniforms.pMapped, frame.uniforms.pMapped, frame.uniformOffset);
+		DestroyBufferObject(frame.uniforms);
+		frame.uniforms = uniforms;
+
+		VkDescriptorBufferInfo bufferInfo = { frame.uniforms.buffer, 0, sizeof(GLOBAL_BLOCK) };
+		VkWriteDescriptorSet write = {};
+		write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		write.dstSet = frame.globalSet;
+		write.descriptorCount = 1;
+		write.descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC;
+		write.pBufferInfo = &bufferInfo;
+		vkUpdateDescriptorSets(m_device, 1, &write, 0, NULL);
+	}
+
+	memcpy((unsigned char*)frame.uniforms.pMapped + offset, m_globalValues.data(), m_globalValues.size());
+	frame.uniformOffset = offset + m_globalValues.size();
+	m_currentGlobalOffset = (uint32_t)offset;
+	m_bGlobalValuesChanged = false;
+	return(true);
+}
+
+/***********************************************************
+ *  StartPass()
+ *
+ *  This method is used for starting a render pass on the
+ *  current target, which the following draws go into.
+ ***********************************************************/
+void VulkanRenderDevice::StartPass(bool bClear, const float* clearColor)
+{
+	PASS pass;
+	pass.target = m_currentTarget;
+	pass.bClear = bClear;
+	for (int i = 0; i < 4; i++)
+	{
+		pass.clearColor[i] = (clearColor != NULL) ? clearColor[i] : 0.0f;
+	}
+	pass.firstDraw = m_draws.size();
+	pass.drawCount = 0;
+	pass.firstChunk = 0;
+	pass.chunkCount = 0;
+	m_passes.push_back(pass);
+}
+
+/***********************************************************
+ *  AddDraw()
+ *
+ *  This method is used for resolving a draw to the state
+ *  it is made with and adding it to the current pass.
+ ***********************************************************/
+void VulkanRenderDevice::AddDraw(VkBuffer vertexBuffer, uint32_t firstVertex, uint32_t vertexCount, FRAME& frame)
+{
+	std::unordered_map<uint32_t, VkPipeline>::const_iterator it = m_pipelines.find(m_currentPipeline);
+	if ((it == m_pipelines.end()) || (vertexCount == 0) || !WriteGlobalValues(frame))
+	{
+		return;
+	}
+	if (m_currentObjectSet == VK_NULL_HANDLE)
+	{
+		m_currentObjectSet = GetObjectSet(m_defaultObjectBuffer, OBJECT_BLOCK_SIZE);
+		m_currentObjectOffset = 0;
+	}
+
+	RESOLVED_DRAW draw;
+	draw.pipeline = it->second;
+	draw.globalOffset = m_currentGlobalOffset;
+	draw.objectSet = m_currentObjectSet;
+	draw.objectOffset = m_currentObjectOffset;
+	draw.vertexBuffer = vertexBuffer;
+	draw.firstVertex = firstVertex;
+	draw.vertexCount = vertexCount;
+	m_draws.push_back(draw);
+	m_passes.back().drawCount++;
+}
+
+/***********************************************************
+ *  RecordChunk()
+ *
+ *  This method is used for recording the draws of a chunk
+ *  into its secondary command buffer.  It is run on the
+ *  worker threads, each with its own command pool, and only
+ *  reads the resolved draws.  Bindings are only recorded
+ *  when they change from the draw before.
+ ***********************************************************/
+void VulkanRenderDevice::RecordChunk(FRAME& frame, size_t chunkIndex)
+{
+	PROFILE_SCOPE("VulkanRenderDevice::RecordChunk");
+	const CHUNK& chunk = m_chunks[chunkIndex];
+	const PASS& pass = m_passes[chunk.passIndex];
+	const TARGET_OBJECT& target = m_targets.find(pass.target)->second;
+	// after the chunks of the frame's earlier submissions
+	size_t slot = frame.chunkCount + chunkIndex;
+	VkCommandBuffer commandBuffer = frame.chunkBuffers[slot];
+
+	vkResetCommandPool(m_device, frame.chunkPools[slot], 0);
+
+	VkCommandBufferInheritanceInfo inheritance = {};
+	inheritance.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO;
+	inheritance.renderPass = m_loadRenderPass;
+	inheritance.subpass = 0;
+	inheritance.framebuffer = target.framebuffer;
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT | VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	beginInfo.pInheritanceInfo = &inheritance;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+
+	VkViewport viewport = { 0.0f, 0.0f, (float)target.width, (float)target.height, 0.0f, 1.0f };
+	VkRect2D scissor = { { 0, 0 }, { (uint32_t)target.width, (uint32_t)target.height } };
+	vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
+	vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
+	vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout,
+		0, 1, &m_textureSet, 0, NULL);
+
+	const RESOLVED_DRAW* pPrevious = NULL;
+	for (size_t i = chunk.firstDraw; i < chunk.firstDraw + chunk.drawCount; i++)
+	{
+		const RESOLVED_DRAW& draw = m_draws[i];
+		if ((pPrevious == NULL) || (draw.pipeline != pPrevious->pipeline))
+		{
+			vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, draw.pipeline);
+		}
+		if ((pPrevious == NULL) || (draw.globalOffset != pPrevious->globalOffset))
+		{
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout,
+				1, 1, &frame.globalSet, 1, &draw.globalOffset);
+		}
+		if ((pPrevious == NULL) || (draw.objectSet != pPrevious->objectSet) ||
+			(draw.objectOffset != pPrevious->objectOffset))
+		{
+			vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_pipelineLayout,
+				2, 1, &draw.objectSet, 1, &draw.objectOffset);
+		}
+		if ((pPrevious == NULL) || (draw.vertexBuffer != pPrevious->vertexBuffer))
+		{
+			VkDeviceSize offset = 0;
+			vkCmdBindVertexBuffers(commandBuffer, 0, 1, &draw.vertexBuffer, &offset);
+		}
+		vkCmdDraw(commandBuffer, draw.vertexCount, 1, draw.firstVertex, 0);
+		pPrevious = &draw;
+	}
+
+	vkEndCommandBuffer(commandBuffer);
+}
+
+/***********************************************************
+ *  Submit()
+ *
+ *  This method is used for running the commands of a list.
+ *  The commands are resolved in order, the draws of each
+ *  pass are recorded in chunks on the worker threads, and
+ *  the primary command buffer runs the chunks inside the
+ *  render passes.  It never waits for the GPU, the buffers
+ *  of the frame are only reused after EndFrame() has waited
+ *  for them.
+ ***********************************************************/
+void VulkanRenderDevice::Submit(const RenderCommandList& commands)
+{
+	PROFILE_SCOPE("VulkanRenderDevice::Submit");
+	FRAME& frame = m_frames[m_frameIndex];
+
+	m_passes.clear();
+	m_draws.clear();
+	m_chunks.clear();
+
+	bool bPassStarted = false;
+	for (size_t i = 0; i < commands.GetCommandCount(); i++)
+	{
+		const RenderCommandList::COMMAND& command = commands.GetCommand(i);
+		switch (command.type)
+		{
+		case RenderCommandList::COMMAND_SET_RENDER_TARGET:
+			m_currentTarget = (command.handle == 0) ? m_windowTarget : command.handle;
+			if (m_targets.find(m_currentTarget) == m_targets.end())
+			{
+				m_currentTarget = m_windowTarget;
+			}
+			bPassStarted = false;
+			break;
+		case RenderCommandList::COMMAND_CLEAR:
+			StartPass(true, command.floatValues);
+			bPassStarted = true;
+			break;
+		case RenderCommandList::COMMAND_SET_PIPELINE:
+			m_currentPipeline = command.handle;
+			break;
+		case RenderCommandList::COMMAND_BIND_TEXTURE:
+		{
+			// the shaders find the texture of a slot by its index
+			// in the texture array
+			uint32_t slot = command.arguments[0];
+			std::unordered_map<uint32_t, TEXTURE_OBJECT>::const_iterator it = m_textures.find(command.handle);
+			int arrayIndex = (it != m_textures.end()) ? (int)it->second.arrayIndex : 0;
+			if (slot < 16)
+			{
+				int* pIndex = (int*)&m_globalValues[offsetof(GLOBAL_BLOCK, slotTextures) + slot * sizeof(int)];
+				if (*pIndex != arrayIndex)
+				{
+					*pIndex = arrayIndex;
+					m_bGlobalValuesChanged = true;
+				}
+			}
+			break;
+		}
+		case RenderCommandList::COMMAND_BIND_UNIFORM_BUFFER:
+			// the object block is the only uniform buffer the
+			// scene code binds
+			m_currentObjectSet = GetObjectSet(command.handle, command.arguments[2]);
+			m_currentObjectOffset = command.arguments[1];
+			break;
+		case RenderCommandList::COMMAND_SET_INT:
+		case RenderCommandList::COMMAND_SET_FLOAT:
+		case RenderCommandList::COMMAND_SET_VEC2:
+		case RenderCommandList::COMMAND_SET_VEC3:
+		case RenderCommandList::COMMAND_SET_VEC4:
+		case RenderCommandList::COMMAND_SET_MAT4:
+			ApplyUniform(commands, command);
+			break;
+		case RenderCommandList::COMMAND_DRAW_SHAPE:
+		{
+			uint32_t vertexCount = 0;
+			RENDER_BUFFER buffer = GetShapeBuffer(command.arguments[0], command.arguments[1], vertexCount);
+			if (buffer != 0)
+			{
+				if (!bPassStarted)
+				{
+					StartPass(false, NULL);
+					bPassStarted = true;
+				}
+				AddDraw(m_buffers[buffer].buffer, 0, vertexCount, frame);
+			}
+			break;
+		}
+		case RenderCommandList::COMMAND_DRAW:
+		{
+			std::unordered_map<uint32_t, BUFFER_OBJECT>::const_iterator it = m_buffers.find(command.handle);
+			if (it != m_buffers.end())
+			{
+				if (!bPassStarted)
+				{
+					StartPass(false, NULL);
+					bPassStarted = true;
+				}
+				AddDraw(it->second.buffer, command.arguments[0], command.arguments[1], frame);
+			}
+			break;
+		}
+		case RenderCommandList::COMMAND_BEGIN_TIMER:
+		case RenderCommandList::COMMAND_END_TIMER:
+			// the draws are recorded out of order on the workers,
+			// so the ranges are not timed on this device
+			break;
+		}
+	}
+
+	// split the draws of each pass between the workers, with
+	// enough draws in each chunk to be worth a command buffer
+	size_t threadCount = (size_t)GetWorkerThreadCount();
+	for (size_t i = 0; i < m_passes.size(); i++)
+	{
+		PASS& pass = m_passes[i];
+		pass.firstChunk = m_chunks.size();
+		pass.chunkCount = std::min(threadCount, (pass.drawCount + MIN_CHUNK_DRAWS - 1) / MIN_CHUNK_DRAWS);
+		for (size_t j = 0; j < pass.chunkCount; j++)
+		{
+			CHUNK chunk;
+			chunk.passIndex = i;
+			chunk.firstDraw = pass.firstDraw + pass.drawCount * j / pass.chunkCount;
+			chunk.drawCount = pass.firstDraw + pass.drawCount * (j + 1) / pass.chunkCount - chunk.firstDraw;
+			m_chunks.push_back(chunk);
+		}
+	}
+
+	while (frame.chunkPools.size() < frame.chunkCount + m_chunks.size())
+	{
+		VkCommandPoolCreateInfo poolInfo = {};
+		poolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		poolInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		poolInfo.queueFamilyIndex = m_queueFamily;
+		VkCommandPool pool = VK_NULL_HANDLE;
+		vkCreateCommandPool(m_device, &poolInfo, NULL, &pool);
+
+		VkCommandBufferAllocateInfo allocateInfo = {};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocateInfo.commandPool = pool;
+		allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_SECONDARY;
+		allocateInfo.commandBufferCount = 1;
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		vkAllocateCommandBuffers(m_device, &allocateInfo, &commandBuffer);
+
+		frame.chunkPools.push_back(pool);
+		frame.chunkBuffers.push_back(commandBuffer);
+	}
+
+	ParallelFor((int)m_chunks.size(), [&](int i) {
+		RecordChunk(frame, (size_t)i);
+	});
+
+	if (frame.submitCount == frame.commandBuffers.size())
+	{
+		VkCommandBufferAllocateInfo allocateInfo = {};
+		allocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		allocateInfo.commandPool = frame.commandPool;
+		allocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		allocateInfo.commandBufferCount = 1;
+		VkCommandBuffer commandBuffer = VK_NULL_HANDLE;
+		vkAllocateCommandBuffers(m_device, &allocateInfo, &commandBuffer);
+		frame.commandBuffers.push_back(commandBuffer);
+	}
+	VkCommandBuffer commandBuffer = frame.commandBuffers[frame.submitCount];
+	VkCommandBuffer* chunkBuffers = frame.chunkBuffers.data() + frame.chunkCount;
+	frame.submitCount++;
+	frame.chunkCount += m_chunks.size();
+
+	VkCommandBufferBeginInfo beginInfo = {};
+	beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+	beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+	vkBeginCommandBuffer(commandBuffer, &beginInfo);
+	for (size_t i = 0; i < m_passes.size(); i++)
+	{
+		const PASS& pass = m_passes[i];
+		const TARGET_OBJECT& target = m_targets[pass.target];
+
+		VkClearValue clearValues[2];
+		memset(clearValues, 0, sizeof(clearValues));
+		memcpy(clearValues[0].color.float32, pass.clearColor, sizeof(pass.clearColor));
+		clearValues[1].depthStencil.depth = 1.0f;
+
+		VkRenderPassBeginInfo renderPassInfo = {};
+		renderPassInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+		renderPassInfo.renderPass = pass.bClear ? m_clearRenderPass : m_loadRenderPass;
+		renderPassInfo.framebuffer = target.framebuffer;
+		renderPassInfo.renderArea.extent.width = (uint32_t)target.width;
+		renderPassInfo.renderArea.extent.height = (uint32_t)target.height;
+		renderPassInfo.clearValueCount = pass.bClear ? 2 : 0;
+		renderPassInfo.pClearValues = clearValues;
+		vkCmdBeginRenderPass(commandBuffer, &renderPassInfo, VK_SUBPASS_CONTENTS_SECONDARY_COMMAND_BUFFERS);
+		if (pass.chunkCount > 0)
+		{
+			vkCmdExecuteCommands(commandBuffer, (uint32_t)pass.chunkCount, chunkBuffers + pass.firstChunk);
+		}
+		vkCmdEndRenderPass(commandBuffer);
+	}
+	vkEndCommandBuffer(commandBuffer);
+
+	VkSubmitInfo submitInfo = {};
+	submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+	submitInfo.commandBufferCount = 1;
+	submitInfo.pCommandBuffers = &commandBuffer;
+	vkQueueSubmit(m_queue, 1, &submitInfo, VK_NULL_HANDLE);
+}
+
+/***********************************************************
+ *  EndFrame()
+ *
+ *  This method is used for ending the frame of the last
+ *  submissions and starting the next one.  The fence of the
+ *  frame is signaled once all of its submissions are done,
+ *  and the CPU only waits for the frame made FRAME_COUNT
+ *  frames ago, whose buffers the next frame reuses.
+ ***********************************************************/
+void VulkanRenderDevice::EndFrame()
+{
+	if (m_frames.empty())
+	{
+		return;
+	}
+
+	// a submission without batches only signals the fence,
+	// after the work submitted before it
+	FRAME& frame = m_frames[m_frameIndex];
+	vkResetFences(m_device, 1, &frame.fence);
+	vkQueueSubmit(m_queue, 0, NULL, frame.fence);
+
+	m_frameIndex = (m_frameIndex + 1) % m_frames.size();
+	FRAME& nextFrame = m_frames[m_frameIndex];
+	vkWaitForFences(m_device, 1, &nextFrame.fence, VK_TRUE, UINT64_MAX);
+	vkResetCommandPool(m_device, nextFrame.commandPool, 0);
+	nextFrame.submitCount = 0;
+	nextFrame.chunkCount = 0;
+	nextFrame.uniformOffset = 0;
+
+	// the values of the last draw are in another frame's buffer
+	m_bGlobalValuesChanged = true;
+}
+
+#endif
@@ -0,0 +1,279 @@
+///////////////////////////////////////////////////////////////////////////////
+// vulkanrenderdevice.h
+// ============
+// run the render device objects and command lists with Vulkan
+///////////////////////////////////////////////////////////////////////////////
+
+#pragma once
+
+// the Vulkan backend is only built with RENDER_DEVICE_VULKAN defined
+// and the Vulkan SDK (vulkan-1.lib) linked in, as the Vulkan
+// configuration of the project does
+#ifdef RENDER_DEVICE_VULKAN
+
+#include "RenderDevice.h"
+#include "ShapeGeometry.h"
+
+#include <vulkan/vulkan.h>
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/***********************************************************
+ *  VulkanRenderDevice
+ *
+ *  This class is the Vulkan render device.  It draws into
+ *  offscreen targets, the window target included, so it
+ *  runs without a window, such as on the Mesa lavapipe CPU
+ *  driver.  A submitted list is run in two steps:
+ *
+ *  - the commands are walked in order on the calling thread,
+ *    and every draw is resolved to the pipeline, uniform
+ *    values and buffers it uses - the uniform values are
+ *    copied into a persistently mapped buffer of the frame
+ *  - the resolved draws are split into chunks that worker
+ *    threads record into secondary command buffers, which
+ *    the render passes of the primary buffer then run
+ *
+ *  The submissions of a frame share its buffers, and
+ *  EndFrame() waits for the frame FRAME_COUNT frames back
+ *  before its buffers are used again, so it has to be called
+ *  once the last submission of every frame is made.
+ *
+ *  The textures are in one descriptor set of texture arrays,
+ *  indexed from the uniform values, so binding a texture is
+ *  not a descriptor change.  The uniform names of the OpenGL
+ *  shader are mapped onto the GlobalBlock of the Vulkan
+ *  shaders in shaders/vulkan.
+ ***********************************************************/
+class VulkanRenderDevice : public RenderDevice
+{
+public:
+	// constructor - the size of the window target
+	VulkanRenderDevice(int windowWidth, int windowHeight);
+	// destructor
+	virtual ~VulkanRenderDevice();
+
+	// create the Vulkan device and load the compiled shaders
+	bool Create(const char* vertexShaderFilename, const char* fragmentShaderFilename);
+
+	virtual RENDER_BUFFER CreateBuffer(const BUFFER_DESC& desc, const void* data);
+	virtual void UpdateBuffer(RENDER_BUFFER buffer, size_t offset, size_t size, const void* data);
+	virtual void CopyBuffer(RENDER_BUFFER source, RENDER_BUFFER destination, size_t size);
+	virtual void DestroyBuffer(RENDER_BUFFER buffer);
+	virtual size_t GetUniformBufferAlignment() const;
+
+	virtual RENDER_TEXTURE CreateTexture(const TEXTURE_DESC& desc, const void* const* data);
+	virtual void DestroyTexture(RENDER_TEXTURE texture);
+
+	virtual RENDER_TARGET CreateRenderTarget(int width, int height);
+	virtual bool ReadPixels(RENDER_TARGET target, int width, int height, void* pixels);
+	virtual void DestroyRenderTarget(RENDER_TARGET target);
+	virtual void GetWindowSize(int& width, int& height) const;
+
+	virtual RENDER_PIPELINE CreatePipeline(const PIPELINE_DESC& desc);
+	virtual void DestroyPipeline(RENDER_PIPELINE pipeline);
+
+	virtual void Submit(const RenderCommandList& commands);
+	virtual void EndFrame();
+
+private:
+	// buffer memory stays mapped for the life of the buffer
+	struct BUFFER_OBJECT
+	{
+		VkBuffer buffer;
+		VkDeviceMemory memory;
+		void* pMapped;
+		size_t size;
+		// descriptor set of a uniform buffer bound as the
+		// object block, made the first time it is bound
+		VkDescriptorSet objectSet;
+	};
+
+	struct TEXTURE_OBJECT
+	{
+		VkImage image;
+		VkDeviceMemory memory;
+		VkImageView view;
+		// index in the 2D or cube texture array
+		uint32_t type;
+		uint32_t arrayIndex;
+	};
+
+	struct TARGET_OBJECT
+	{
+		int width;
+		int height;
+		VkImage colorImage;
+		VkDeviceMemory colorMemory;
+		VkImageView colorView;
+		VkImage depthImage;
+		VkDeviceMemory depthMemory;
+		VkImageView depthView;
+		VkFramebuffer framebuffer;
+	};
+
+	// a draw with everything it uses resolved
+	struct RESOLVED_DRAW
+	{
+		VkPipeline pipeline;
+		uint32_t globalOffset;
+		VkDescriptorSet objectSet;
+		uint32_t objectOffset;
+		VkBuffer vertexBuffer;
+		uint32_t firstVertex;
+		uint32_t vertexCount;
+	};
+
+	// a render pass instance on a target, and its draws
+	struct PASS
+	{
+		RENDER_TARGET target;
+		bool bClear;
+		float clearColor[4];
+		size_t firstDraw;
+		size_t drawCount;
+		size_t firstChunk;
+		size_t chunkCount;
+	};
+
+	// draws of a pass recorded by one worker
+	struct CHUNK
+	{
+		size_t passIndex;
+		size_t firstDraw;
+		size_t drawCount;
+	};
+
+	// what the submissions of a frame need until its fence is
+	// signaled
+	struct FRAME
+	{
+		VkFence fence;
+		VkCommandPool commandPool;
+		// a primary buffer for each submission of the frame, and
+		// the ones used so far
+		std::vector<VkCommandBuffer> commandBuffers;
+		size_t submitCount;
+		// a pool and secondary buffer for each chunk, so the
+		// workers never share a pool, and the ones used so far
+		std::vector<VkCommandPool> chunkPools;
+		std::vector<VkCommandBuffer> chunkBuffers;
+		size_t chunkCount;
+		// persistently mapped uniform values of the draws
+		BUFFER_OBJECT uniforms;
+		VkDescriptorSet globalSet;
+		size_t uniformOffset;
+	};
+
+	// name of a shader value and where it is in GlobalBlock
+	struct UNIFORM_ENTRY
+	{
+		std::string name;
+		uint32_t offset;
+	};
+
+	int m_windowWidth;
+	int m_windowHeight;
+
+	VkInstance m_instance;
+	VkPhysicalDevice m_physicalDevice;
+	VkDevice m_device;
+	VkQueue m_queue;
+	uint32_t m_queueFamily;
+	VkPhysicalDeviceMemoryProperties m_memoryProperties;
+	size_t m_uniformBufferAlignment;
+	VkFormat m_depthFormat;
+	VkCommandPool m_uploadPool;
+
+	// render passes that clear or keep the targets, which are
+	// compatible, so the pipelines work with both
+	VkRenderPass m_clearRenderPass;
+	VkRenderPass m_loadRenderPass;
+	VkShaderModule m_vertexShader;
+	VkShaderModule m_fragmentShader;
+	VkPipelineLayout m_pipelineLayout;
+	// samplers by repeat and mipmap filtering
+	VkSampler m_samplers[4];
+
+	// texture arrays, uniform values and object block sets
+	VkDescriptorSetLayout m_textureSetLayout;
+	VkDescriptorSetLayout m_globalSetLayout;
+	VkDescriptorSetLayout m_objectSetLayout;
+	VkDescriptorPool m_textureDescriptorPool;
+	VkDescriptorPool m_descriptorPool;
+	VkDescriptorSet m_textureSet;
+	// free indices of the 2D and cube texture arrays
+	std::vector<uint32_t> m_freeTextureIndices[2];
+	// textures in index 0 of the arrays, for unbound slots
+	RENDER_TEXTURE m_defaultTextures[2];
+	// object block set used before one is bound
+	RENDER_BUFFER m_defaultObjectBuffer;
+
+	// vertex buffers of the basic shape parts, and their vertex
+	// counts, made the first time each one is drawn
+	ShapeGeometry m_shapeGeometry;
+	std::map<uint32_t, std::pair<RENDER_BUFFER, uint32_t> > m_shapeBuffers;
+	// offscreen target standing in for the window
+	RENDER_TARGET m_windowTarget;
+
+	// created objects by handle
+	uint32_t m_nextHandle;
+	std::unordered_map<uint32_t, BUFFER_OBJECT> m_buffers;
+	std::unordered_map<uint32_t, TEXTURE_OBJECT> m_textures;
+	std::unordered_map<uint32_t, TARGET_OBJECT> m_targets;
+	std::unordered_map<uint32_t, VkPipeline> m_pipelines;
+
+	std::vector<FRAME> m_frames;
+	size_t m_frameIndex;
+
+	// state of the command lists, kept between submissions
+	// like the state of an OpenGL context
+	std::vector<unsigned char> m_globalValues;
+	bool m_bGlobalValuesChanged;
+	std::vector<UNIFORM_ENTRY> m_uniformEntries;
+	RENDER_TARGET m_currentTarget;
+	RENDER_PIPELINE m_currentPipeline;
+	VkDescriptorSet m_currentObjectSet;
+	uint32_t m_currentObjectOffset;
+	uint32_t m_currentGlobalOffset;
+
+	// resolved work of the submission being recorded
+	std::vector<PASS> m_passes;
+	std::vector<RESOLVED_DRAW> m_draws;
+	std::vector<CHUNK> m_chunks;
+
+	// set up the device and the objects everything shares
+	bool CreateDevice();
+	bool CreateRenderPasses();
+	bool CreateDescriptors();
+	bool CreateFrames();
+	VkShaderModule LoadShader(const char* filename);
+	void CreateUniformEntries();
+	// get the vertex buffer of the parts of a basic shape
+	RENDER_BUFFER GetShapeBuffer(uint32_t meshType, uint32_t parts, uint32_t& vertexCount);
+
+	// memory and buffers
+	bool FindMemoryType(uint32_t typeBits, VkMemoryPropertyFlags properties, uint32_t& memoryType) const;
+	bool CreateBufferObject(VkBufferUsageFlags usage, size_t size, BUFFER_OBJECT& buffer);
+	void DestroyBufferObject(BUFFER_OBJECT& buffer);
+	bool CreateImage(VkImageCreateInfo& imageInfo, VkImage& image, VkDeviceMemory& memory);
+	VkDescriptorSet GetObjectSet(RENDER_BUFFER buffer, size_t size);
+
+	// run commands on the queue right away and wait for them
+	VkCommandBuffer BeginUpload();
+	void EndUpload(VkCommandBuffer commandBuffer);
+	// wait for every submission to finish
+	void WaitForFrames();
+
+	// resolve the commands, then record and submit them
+	void ApplyUniform(const RenderCommandList& commands, const RenderCommandList::COMMAND& command);
+	void AddDraw(VkBuffer vertexBuffer, uint32_t firstVertex, uint32_t vertexCount, FRAME& frame);
+	void StartPass(bool bClear, const float* clearColor);
+	bool WriteGlobalValues(FRAME& frame);
+	void RecordChunk(FRAME& frame, size_t chunkIndex);
+};
+
+#endif
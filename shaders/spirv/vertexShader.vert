@@ -0,0 +1,35 @@
+#version 460 core
+// SPIR-V source for vertexShader.glsl - compile with:
+//   glslangValidator -G -o shaders/spirv/vertexShader.spv shaders/spirv/vertexShader.vert
+// every uniform needs an explicit location when targeting SPIR-V
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+layout (location = 0) out vec3 fragmentPosition;
+layout (location = 1) out vec3 fragmentVertexNormal;
+layout (location = 2) out vec2 fragmentTextureCoordinate;
+
+layout (location = 0) uniform mat4 model;
+layout (location = 1) uniform mat4 view;
+layout (location = 2) uniform mat4 projection;
+
+// per-object values of scene file objects, one range of the
+// object buffer is bound for each draw
+layout (std140, binding = 1) uniform ObjectBlock
+{
+   mat4 objectModel;
+   vec4 objectBlockColor;
+   vec4 objectBlockUVScale;
+};
+layout (location = 61) uniform bool bUseObjectBlock;
+
+void main()
+{
+   mat4 modelMatrix = bUseObjectBlock ? objectModel : model;
+   fragmentPosition = vec3(modelMatrix * vec4(inVertexPosition, 1.0));
+   gl_Position = projection * view * modelMatrix * vec4(inVertexPosition, 1.0f);
+   // rotate the normal into world space along with the object
+   fragmentVertexNormal = mat3(transpose(inverse(modelMatrix))) * inVertexNormal;
+   fragmentTextureCoordinate = inTextureCoordinate;
+}
@@ -11,10 +11,22 @@ uniform mat4 model;
 uniform mat4 view;
 uniform mat4 projection;
 
+// per-object values of scene file objects, one range of the
+// object buffer is bound for each draw
+layout (std140) uniform ObjectBlock
+{
+   mat4 objectModel;
+   vec4 objectBlockColor;
+   vec4 objectBlockUVScale;
+};
+uniform bool bUseObjectBlock = false;
+
 void main()
 {
-   fragmentPosition = vec3(model * vec4(inVertexPosition, 1.0));
-   gl_Position = projection * view * model * vec4(inVertexPosition, 1.0f);
-   fragmentVertexNormal = inVertexNormal;
+   mat4 modelMatrix = bUseObjectBlock ? objectModel : model;
+   fragmentPosition = vec3(modelMatrix * vec4(inVertexPosition, 1.0));
+   gl_Position = projection * view * modelMatrix * vec4(inVertexPosition, 1.0f);
+   // rotate the normal into world space along with the object
+   fragmentVertexNormal = mat3(transpose(inverse(modelMatrix))) * inVertexNormal;
    fragmentTextureCoordinate = inTextureCoordinate;
 }
\ No newline at end of file
@@ -0,0 +1,353 @@
+#version 460 core
+#extension GL_GOOGLE_include_directive : require
+// Vulkan source of fragmentShader.glsl, for VulkanRenderDevice - compile with:
+//   glslangValidator -V -o shaders/vulkan/scene.frag.spv shaders/vulkan/scene.frag
+// the lights and material are unpacked from GlobalBlock into the structs
+// of the OpenGL shader, so the lighting functions are the same
+#include "sceneBlocks.glsl"
+
+layout (location = 0) out vec4 fragmentColor;
+
+layout (location = 0) in vec3 fragmentPosition;
+layout (location = 1) in vec3 fragmentVertexNormal;
+layout (location = 2) in vec2 fragmentTextureCoordinate;
+
+// begin shared lighting - the build checks it is the same in every copy
+struct Material {
+    vec3 diffuseColor;
+    vec3 specularColor;
+    float shininess;
+    float metallic;
+    float roughness;
+}; 
+
+struct DirectionalLight {
+    vec3 direction;
+	
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    bool bActive;
+};
+
+struct PointLight {
+    vec3 position;
+    
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    bool bActive;
+};
+
+struct SpotLight {
+    vec3 position;
+    vec3 direction;
+    float cutOff;
+    float outerCutOff;
+  
+    float constant;
+    float linear;
+    float quadratic;
+  
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;       
+
+    bool bActive;
+};
+// end shared lighting
+
+Material material;
+DirectionalLight directionalLight;
+SpotLight spotLight;
+PointLight pointLights[TOTAL_POINT_LIGHTS];
+
+const float PI = 3.14159265359;
+
+// function prototypes
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir, vec3 baseColor);
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor);
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor);
+vec3 CalcPBRLighting(vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor);
+
+// copy the values of GlobalBlock into the structs the lighting uses
+void UnpackLights()
+{
+    material.diffuseColor = materialDiffuseColor.rgb;
+    material.specularColor = materialSpecularColor.rgb;
+    material.shininess = materialParameters.x;
+    material.metallic = materialParameters.y;
+    material.roughness = materialParameters.z;
+
+    directionalLight.direction = directionalDirection.xyz;
+    directionalLight.ambient = directionalAmbient.rgb;
+    directionalLight.diffuse = directionalDiffuse.rgb;
+    directionalLight.specular = directionalSpecular.rgb;
+    directionalLight.bActive = (moreSwitches.z != 0);
+
+    for(int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+    {
+        pointLights[i].position = pointLightBlocks[i].position.xyz;
+        pointLights[i].ambient = pointLightBlocks[i].ambient.rgb;
+        pointLights[i].diffuse = pointLightBlocks[i].diffuse.rgb;
+        pointLights[i].specular = pointLightBlocks[i].specular.rgb;
+        pointLights[i].bActive = (pointLightBlocks[i].bActive.x != 0);
+    }
+
+    spotLight.position = spotPosition.xyz;
+    spotLight.direction = spotDirection.xyz;
+    spotLight.cutOff = spotParameters.x;
+    spotLight.outerCutOff = spotParameters.y;
+    spotLight.constant = spotParameters.z;
+    spotLight.linear = spotParameters.w;
+    spotLight.quadratic = scalars.x;
+    spotLight.ambient = spotAmbient.rgb;
+    spotLight.diffuse = spotDiffuse.rgb;
+    spotLight.specular = spotSpecular.rgb;
+    spotLight.bActive = (moreSwitches.w != 0);
+}
+
+void main()
+{    
+    bool bUseTexture = (switches.x != 0);
+    bool bUseLighting = (switches.y != 0);
+    bool bUsePBR = (switches.z != 0);
+    int objectTexture = GetSlotTexture(samplerSlots.x);
+
+    // scene file objects keep their color and UV scale in the object buffer
+    vec4 baseObjectColor = (moreSwitches.x != 0) ? objectBlockColor : objectColor;
+    vec2 objectUVScale = (moreSwitches.x != 0) ? objectBlockUVScale.xy : UVscale.xy;
+
+    // the glyph edge is where the distance field crosses 0.5, and it is
+    // blended over about one pixel to stay smooth at any size
+    if(moreSwitches.y != 0)
+    {
+        float distance = texture(textures2D[objectTexture], fragmentTextureCoordinate).r - 0.5;
+        float edgeWidth = max(fwidth(distance), 0.0001);
+        baseObjectColor.a *= smoothstep(-edgeWidth, edgeWidth, distance);
+        if(baseObjectColor.a < 0.01)
+        {
+            discard;
+        }
+    }
+
+    if(bUseLighting == true)
+    {
+        UnpackLights();
+
+        vec3 phongResult = vec3(0.0f);
+        // properties
+        vec3 norm = normalize(fragmentVertexNormal);
+        vec3 viewDir = normalize(viewPosition.xyz - fragmentPosition);
+
+        // sample the texture once, every light below reuses the color
+        vec4 baseColor = baseObjectColor;
+        if(bUseTexture == true)
+        {
+            baseColor = texture(textures2D[objectTexture], fragmentTextureCoordinate);
+        }
+
+        if(bUsePBR == true)
+        {
+            fragmentColor = vec4(CalcPBRLighting(norm, fragmentPosition, viewDir, baseColor.rgb), baseColor.a);
+            return;
+        }
+    
+        // phase 1: directional lighting
+        if(directionalLight.bActive == true)
+        {
+            phongResult += CalcDirectionalLight(directionalLight, norm, viewDir, baseColor.rgb);
+        }
+        // phase 2: point lights
+        for(int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+        {
+            if(pointLights[i].bActive == true)
+            {
+                phongResult += CalcPointLight(pointLights[i], norm, fragmentPosition, viewDir, baseColor.rgb);   
+            }
+        } 
+        // phase 3: spot light
+        if(spotLight.bActive == true)
+        {
+            phongResult += CalcSpotLight(spotLight, norm, fragmentPosition, viewDir, baseColor.rgb);    
+        }
+    
+        fragmentColor = vec4(phongResult, baseColor.a);
+    }
+    else
+    {
+        if(bUseTexture == true)
+        {
+            fragmentColor = texture(textures2D[objectTexture], fragmentTextureCoordinate * objectUVScale);
+        }
+        else
+        {
+            fragmentColor = baseObjectColor;
+        }
+    }
+}
+
+// begin shared lighting - the build checks it is the same in every copy
+// calculates the color when using a directional light.
+vec3 CalcDirectionalLight(DirectionalLight light, vec3 normal, vec3 viewDir, vec3 baseColor)
+{
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    vec3 lightDirection = normalize(-light.direction);
+    // diffuse shading
+    float diff = max(dot(normal, lightDirection), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDirection, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    // combine results
+    ambient = light.ambient * baseColor;
+    diffuse = light.diffuse * diff * material.diffuseColor * baseColor;
+    specular = light.specular * spec * material.specularColor * baseColor;
+    
+    return (ambient + diffuse + specular);
+}
+
+// calculates the color when using a point light.
+vec3 CalcPointLight(PointLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor)
+{
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    // Calculate specular component
+    float specularComponent = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+   
+    // combine results
+    ambient = light.ambient * baseColor;
+    diffuse = light.diffuse * diff * material.diffuseColor * baseColor;
+    specular = light.specular * specularComponent * material.specularColor;
+    
+    return (ambient + diffuse + specular);
+}
+
+// calculates the color when using a spot light.
+vec3 CalcSpotLight(SpotLight light, vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor)
+{
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+
+    vec3 lightDir = normalize(light.position - fragPos);
+    // diffuse shading
+    float diff = max(dot(normal, lightDir), 0.0);
+    // specular shading
+    vec3 reflectDir = reflect(-lightDir, normal);
+    float spec = pow(max(dot(viewDir, reflectDir), 0.0), material.shininess);
+    // attenuation
+    float distance = length(light.position - fragPos);
+    float attenuation = 1.0 / (light.constant + light.linear * distance + light.quadratic * (distance * distance));    
+    // spotlight intensity
+    float theta = dot(lightDir, normalize(-light.direction)); 
+    float epsilon = light.cutOff - light.outerCutOff;
+    float intensity = clamp((theta - light.outerCutOff) / epsilon, 0.0, 1.0);
+    // combine results
+    ambient = light.ambient * baseColor;
+    diffuse = light.diffuse * diff * material.diffuseColor * baseColor;
+    specular = light.specular * spec * material.specularColor * baseColor;
+    
+    ambient *= attenuation * intensity;
+    diffuse *= attenuation * intensity;
+    specular *= attenuation * intensity;
+    return (ambient + diffuse + specular);
+}
+
+// calculates the GGX specular and lambert diffuse reflection for one light,
+// with the light intensities in the same units as the phong lights.
+vec3 CalcPBRLight(vec3 lightDir, vec3 radiance, vec3 normal, vec3 viewDir, float NdotV, vec3 F0, vec3 diffuseColor, float alpha)
+{
+    float NdotL = max(dot(normal, lightDir), 0.0);
+    if(NdotL <= 0.0)
+    {
+        return vec3(0.0f);
+    }
+
+    vec3 halfway = normalize(lightDir + viewDir);
+    float NdotH = max(dot(normal, halfway), 0.0);
+    float VdotH = max(dot(viewDir, halfway), 0.0);
+
+    // GGX normal distribution
+    float alpha2 = alpha * alpha;
+    float denominator = NdotH * NdotH * (alpha2 - 1.0) + 1.0;
+    float D = alpha2 / (PI * denominator * denominator);
+    // height correlated Smith visibility
+    float visibilityV = NdotL * sqrt(NdotV * NdotV * (1.0 - alpha2) + alpha2);
+    float visibilityL = NdotV * sqrt(NdotL * NdotL * (1.0 - alpha2) + alpha2);
+    float V = 0.5 / max(visibilityV + visibilityL, 0.0001);
+    // Schlick fresnel, multiplied out instead of calling pow()
+    float oneMinusVdotH = 1.0 - VdotH;
+    float squared = oneMinusVdotH * oneMinusVdotH;
+    vec3 F = F0 + (1.0 - F0) * (squared * squared * oneMinusVdotH);
+
+    return (diffuseColor * (1.0 - F) + PI * D * V * F) * radiance * NdotL;
+}
+// end shared lighting
+
+// calculates the color using the metallic-roughness model. The ambient term
+// uses the split-sum approximation, where the expensive BRDF integral was
+// precomputed on the CPU into brdfLUT, so it costs one texture fetch.
+vec3 CalcPBRLighting(vec3 normal, vec3 fragPos, vec3 viewDir, vec3 baseColor)
+{
+    float NdotV = max(dot(normal, viewDir), 0.0001);
+    float roughness = clamp(material.roughness, 0.04, 1.0);
+    float alpha = roughness * roughness;
+    vec3 F0 = mix(vec3(0.04), baseColor, material.metallic);
+    vec3 diffuseColor = baseColor * (1.0 - material.metallic);
+
+    vec3 result = vec3(0.0f);
+    vec3 ambientLight = vec3(0.0f);
+
+    if(directionalLight.bActive == true)
+    {
+        result += CalcPBRLight(normalize(-directionalLight.direction), directionalLight.diffuse, normal, viewDir, NdotV, F0, diffuseColor, alpha);
+        ambientLight += directionalLight.ambient;
+    }
+    for(int i = 0; i < TOTAL_POINT_LIGHTS; i++)
+    {
+        if(pointLights[i].bActive == true)
+        {
+            result += CalcPBRLight(normalize(pointLights[i].position - fragPos), pointLights[i].diffuse, normal, viewDir, NdotV, F0, diffuseColor, alpha);
+            ambientLight += pointLights[i].ambient;
+        }
+    }
+    if(spotLight.bActive == true)
+    {
+        vec3 lightDir = normalize(spotLight.position - fragPos);
+        float distance = length(spotLight.position - fragPos);
+        float attenuation = 1.0 / (spotLight.constant + spotLight.linear * distance + spotLight.quadratic * (distance * distance));
+        float theta = dot(lightDir, normalize(-spotLight.direction));
+        float intensity = clamp((theta - spotLight.outerCutOff) / (spotLight.cutOff - spotLight.outerCutOff), 0.0, 1.0);
+        result += CalcPBRLight(lightDir, spotLight.diffuse * attenuation * intensity, normal, viewDir, NdotV, F0, diffuseColor, alpha);
+        ambientLight += spotLight.ambient * attenuation * intensity;
+    }
+
+    vec2 environmentBRDF = texture(textures2D[GetSlotTexture(samplerSlots.y)], vec2(NdotV, roughness)).rg;
+    vec3 ambient;
+    if(switches.w != 0)
+    {
+        // image based lighting - both cube maps were prefiltered on the
+        // CPU, so each costs a single lookup
+        vec3 irradiance = texture(texturesCube[GetSlotTexture(samplerSlots.z)], normal).rgb;
+        vec3 reflected = textureLod(texturesCube[GetSlotTexture(samplerSlots.w)], reflect(-viewDir, normal), roughness * (scalars.y - 1.0)).rgb;
+        ambient = irradiance * diffuseColor + reflected * (F0 * environmentBRDF.x + environmentBRDF.y);
+    }
+    else
+    {
+        ambient = ambientLight * (diffuseColor + F0 * environmentBRDF.x + environmentBRDF.y);
+    }
+
+    return ambient + result;
+}
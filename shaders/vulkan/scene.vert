@@ -0,0 +1,27 @@
+#version 460 core
+#extension GL_GOOGLE_include_directive : require
+// Vulkan source of vertexShader.glsl, for VulkanRenderDevice - compile with:
+//   glslangValidator -V -o shaders/vulkan/scene.vert.spv shaders/vulkan/scene.vert
+#include "sceneBlocks.glsl"
+
+layout (location = 0) in vec3 inVertexPosition;
+layout (location = 1) in vec3 inVertexNormal;
+layout (location = 2) in vec2 inTextureCoordinate;
+
+layout (location = 0) out vec3 fragmentPosition;
+layout (location = 1) out vec3 fragmentVertexNormal;
+layout (location = 2) out vec2 fragmentTextureCoordinate;
+
+void main()
+{
+   mat4 modelMatrix = (moreSwitches.x != 0) ? objectModel : model;
+   fragmentPosition = vec3(modelMatrix * vec4(inVertexPosition, 1.0));
+   gl_Position = projection * view * modelMatrix * vec4(inVertexPosition, 1.0f);
+   // the projection is made for OpenGL - Vulkan has the y axis pointing
+   // down and a depth range of 0 to 1
+   gl_Position.y = -gl_Position.y;
+   gl_Position.z = (gl_Position.z + gl_Position.w) * 0.5;
+   // rotate the normal into world space along with the object
+   fragmentVertexNormal = mat3(transpose(inverse(modelMatrix))) * inVertexNormal;
+   fragmentTextureCoordinate = inTextureCoordinate;
+}
@@ -0,0 +1,73 @@
+// uniform blocks and textures of the Vulkan scene shaders, included by
+// scene.vert and scene.frag
+// Vulkan has no uniforms outside of blocks, so every value the scene code
+// sets by name is kept in GlobalBlock - VulkanRenderDevice keeps the same
+// layout in GLOBAL_BLOCK, and maps the names of the OpenGL shader onto it
+
+#define TOTAL_POINT_LIGHTS 5
+#define MAX_TEXTURES 1024
+#define MAX_CUBE_TEXTURES 64
+
+struct PointLightBlock {
+    vec4 position;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    ivec4 bActive;
+};
+
+layout (std140, set = 1, binding = 0) uniform GlobalBlock
+{
+    mat4 model;
+    mat4 view;
+    mat4 projection;
+    vec4 objectColor;
+    vec4 viewPosition;
+    vec4 UVscale;
+    vec4 materialDiffuseColor;
+    vec4 materialSpecularColor;
+    // x shininess, y metallic, z roughness
+    vec4 materialParameters;
+    vec4 directionalDirection;
+    vec4 directionalAmbient;
+    vec4 directionalDiffuse;
+    vec4 directionalSpecular;
+    PointLightBlock pointLightBlocks[TOTAL_POINT_LIGHTS];
+    vec4 spotPosition;
+    vec4 spotDirection;
+    vec4 spotAmbient;
+    vec4 spotDiffuse;
+    vec4 spotSpecular;
+    // x cutOff, y outerCutOff, z constant, w linear
+    vec4 spotParameters;
+    // x spot light quadratic, y prefilterMipLevels
+    vec4 scalars;
+    // x bUseTexture, y bUseLighting, z bUsePBR, w bUseEnvironmentMap
+    ivec4 switches;
+    // x bUseObjectBlock, y bUseTextSDF, z directionalLight.bActive,
+    // w spotLight.bActive
+    ivec4 moreSwitches;
+    // texture slots of x objectTexture, y brdfLUT, z irradianceMap and
+    // w prefilterMap
+    ivec4 samplerSlots;
+    // index into the texture arrays of the texture bound to each slot
+    ivec4 slotTextures[4];
+};
+
+// per-object values of scene file objects, one range of the object
+// buffer is bound for each draw
+layout (std140, set = 2, binding = 0) uniform ObjectBlock
+{
+   mat4 objectModel;
+   vec4 objectBlockColor;
+   vec4 objectBlockUVScale;
+};
+
+// every texture, indexed through slotTextures
+layout (set = 0, binding = 0) uniform sampler2D textures2D[MAX_TEXTURES];
+layout (set = 0, binding = 1) uniform samplerCube texturesCube[MAX_CUBE_TEXTURES];
+
+int GetSlotTexture(int slot)
+{
+    return slotTextures[slot / 4][slot % 4];
+}